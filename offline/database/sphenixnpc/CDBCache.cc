@@ -0,0 +1,353 @@
+#include "CDBCache.h"
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace
+{
+  //! exclusive lock on a file, released when going out of scope
+  class FileLock
+  {
+   public:
+    explicit FileLock(const std::string &filename)
+      : m_fd(open(filename.c_str(), O_RDWR | O_CREAT, 0666))
+    {
+      if (m_fd >= 0 && flock(m_fd, LOCK_EX) != 0)
+      {
+        close(m_fd);
+        m_fd = -1;
+      }
+    }
+    ~FileLock()
+    {
+      if (m_fd >= 0)
+      {
+        flock(m_fd, LOCK_UN);
+        close(m_fd);
+      }
+    }
+    FileLock(const FileLock &) = delete;
+    FileLock &operator=(const FileLock &) = delete;
+
+    bool locked() const { return m_fd >= 0; }
+
+   private:
+    int m_fd{-1};
+  };
+}  // namespace
+
+int CDBCache::SetDirectory(const std::string &directory)
+{
+  if (!directory.empty())
+  {
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    if (!std::filesystem::is_directory(directory))
+    {
+      std::cout << "CDBCache: cannot create cache directory " << directory << std::endl;
+      return -1;
+    }
+  }
+  m_Directory = directory;
+  return 0;
+}
+
+std::string CDBCache::Hash(const std::string &globaltag, const std::string &domain, uint64_t iov)
+{
+  // 64 bit FNV-1a, fields separated by a character which cannot be in a name
+  const std::string key = globaltag + '\n' + domain + '\n' + std::to_string(iov);
+  uint64_t hash = 14695981039346656037ULL;
+  for (const unsigned char c : key)
+  {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  std::ostringstream hex;
+  hex << std::hex << std::setw(16) << std::setfill('0') << hash;
+  return hex.str();
+}
+
+std::string CDBCache::EntryPath(const Key &key) const
+{
+  const std::string hash = Hash(std::get<0>(key), std::get<1>(key), std::get<2>(key));
+  // spread the entries over 256 sub directories
+  return m_Directory + "/" + hash.substr(0, 2) + "/" + hash;
+}
+
+bool CDBCache::ReadEntry(const std::string &path, const Key &key, std::string &url) const
+{
+  std::ifstream entry(path);
+  if (!entry.is_open())
+  {
+    return false;
+  }
+  std::string globaltag;
+  std::string domain;
+  std::string iov;
+  std::string value;
+  if (!std::getline(entry, globaltag) || !std::getline(entry, domain) || !std::getline(entry, iov))
+  {
+    return false;
+  }
+  std::getline(entry, value);  // empty url is a valid entry, until it expires
+  // protect against hash collisions
+  if (globaltag != std::get<0>(key) || domain != std::get<1>(key) || iov != std::to_string(std::get<2>(key)))
+  {
+    if (m_Verbosity > 0)
+    {
+      std::cout << "CDBCache: hash collision for " << path << std::endl;
+    }
+    return false;
+  }
+  if (value.empty())
+  {
+    std::error_code ec;
+    const auto written = std::filesystem::last_write_time(path, ec);
+    if (ec || std::filesystem::file_time_type::clock::now() - written >= m_NoPayloadExpiry)
+    {
+      if (m_Verbosity > 0)
+      {
+        std::cout << "CDBCache: no payload entry " << path << " expired" << std::endl;
+      }
+      return false;
+    }
+  }
+  url = value;
+  return true;
+}
+
+void CDBCache::WriteEntry(const std::string &path, const Key &key, const std::string &url) const
+{
+  // write to a temporary file and rename, readers never see a partial entry
+  const std::string tmpname = path + ".tmp." + std::to_string(getpid());
+  {
+    std::ofstream entry(tmpname);
+    if (!entry.is_open())
+    {
+      std::cout << "CDBCache: cannot write " << tmpname << std::endl;
+      return;
+    }
+    entry << std::get<0>(key) << '\n'
+          << std::get<1>(key) << '\n'
+          << std::get<2>(key) << '\n'
+          << url << '\n';
+  }
+  if (std::rename(tmpname.c_str(), path.c_str()) != 0)
+  {
+    std::cout << "CDBCache: cannot rename " << tmpname << " to " << path << std::endl;
+    std::remove(tmpname.c_str());
+  }
+}
+
+std::string CDBCache::Get(const std::string &globaltag, const std::string &domain, uint64_t iov, const Resolver &resolver)
+{
+  const Key key(globaltag, domain, iov);
+  auto iter = m_Memory.find(key);
+  if (iter != m_Memory.end())
+  {
+    ++m_MemoryHits;
+    return iter->second;
+  }
+  if (auto nopayload = m_NoPayload.find(key); nopayload != m_NoPayload.end())
+  {
+    if (std::chrono::steady_clock::now() - nopayload->second < m_NoPayloadExpiry)
+    {
+      ++m_MemoryHits;
+      return "";
+    }
+    m_NoPayload.erase(nopayload);
+  }
+
+  if (m_Frozen)
+  {
+    if (Covers(globaltag, iov))
+    {
+      // not in the snapshot means no payload
+      ++m_MemoryHits;
+      m_Memory.emplace(key, "");
+      return "";
+    }
+    std::cout << "CDBCache: snapshot is for global tag " << m_SnapshotGlobalTag << ", iov " << m_SnapshotIov
+              << ", cannot look up " << domain << " in " << globaltag << " at iov " << iov << std::endl;
+    ++m_Misses;
+    return "";
+  }
+
+  // a failed lookup (e.g. DB not reachable) is not stored, the next lookup will query the DB again
+  const auto resolve = [this, &domain, iov, &resolver](std::string &value)
+  {
+    ++m_Misses;
+    const std::optional<std::string> result = resolver(domain, iov);
+    if (!result)
+    {
+      ++m_Errors;
+      std::cout << "CDBCache: lookup of " << domain << " at iov " << iov << " failed, not cached" << std::endl;
+      return false;
+    }
+    value = *result;
+    return true;
+  };
+
+  std::string url;
+  if (m_Directory.empty())
+  {
+    if (!resolve(url))
+    {
+      return "";
+    }
+  }
+  else
+  {
+    const std::string path = EntryPath(key);
+    if (ReadEntry(path, key, url))
+    {
+      ++m_DiskHits;
+    }
+    else
+    {
+      std::error_code ec;
+      std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+
+      // other jobs missing the same key wait here and find it on disk afterwards
+      FileLock lock(path + ".lock");
+      if (ReadEntry(path, key, url))
+      {
+        ++m_DiskHits;
+      }
+      else
+      {
+        if (!resolve(url))
+        {
+          return "";
+        }
+        if (!url.empty() || m_NoPayloadExpiry.count() > 0)
+        {
+          WriteEntry(path, key, url);
+        }
+      }
+    }
+  }
+  if (url.empty())
+  {
+    m_NoPayload[key] = std::chrono::steady_clock::now();
+  }
+  else
+  {
+    m_Memory.emplace(key, url);
+  }
+  return url;
+}
+
+int CDBCache::WriteSnapshot(const std::string &filename, const std::string &globaltag, uint64_t iov, const std::map<std::string, std::string> &urls)
+{
+  std::ofstream snapshot(filename);
+  if (!snapshot.is_open())
+  {
+    std::cout << "CDBCache: could not open " << filename << std::endl;
+    return -1;
+  }
+  snapshot << "# frozen conditions DB snapshot" << std::endl;
+  snapshot << "globaltag " << globaltag << std::endl;
+  snapshot << "iov " << iov << std::endl;
+  for (const auto &[domain, url] : urls)
+  {
+    if (!url.empty())
+    {
+      snapshot << domain << " " << url << std::endl;
+    }
+  }
+  return 0;
+}
+
+int CDBCache::ReadSnapshot(const std::string &filename)
+{
+  std::ifstream snapshot(filename);
+  if (!snapshot.is_open())
+  {
+    std::cout << "CDBCache: could not open " << filename << std::endl;
+    return -1;
+  }
+  std::string globaltag;
+  uint64_t iov = 0;
+  bool has_globaltag = false;
+  bool has_iov = false;
+  std::map<std::string, std::string> urls;
+  std::string line;
+  while (std::getline(snapshot, line))
+  {
+    // Skip empty lines and comments
+    if (line.empty() || line[0] == '#')
+    {
+      continue;
+    }
+    std::istringstream iss(line);
+    std::string name;
+    std::string value;
+    if (!(iss >> name >> value))
+    {
+      continue;
+    }
+    if (name == "globaltag")
+    {
+      globaltag = value;
+      has_globaltag = true;
+    }
+    else if (name == "iov")
+    {
+      iov = std::stoull(value);
+      has_iov = true;
+    }
+    else
+    {
+      urls[name] = value;
+    }
+  }
+  if (!has_globaltag || !has_iov)
+  {
+    std::cout << "CDBCache: " << filename << " is not a snapshot (no global tag or iov)" << std::endl;
+    return -1;
+  }
+
+  m_Frozen = true;
+  m_SnapshotGlobalTag = globaltag;
+  m_SnapshotIov = iov;
+  for (const auto &[domain, url] : urls)
+  {
+    m_Memory[Key(globaltag, domain, iov)] = url;
+  }
+  if (m_Verbosity > 0)
+  {
+    std::cout << "CDBCache: read " << urls.size() << " domains of global tag " << globaltag
+              << ", iov " << iov << " from " << filename << std::endl;
+  }
+  return 0;
+}
+
+void CDBCache::Print(std::ostream &os) const
+{
+  const uint64_t lookups = m_MemoryHits + m_DiskHits + m_Misses;
+  os << "CDBCache: " << lookups << " lookups, "
+     << m_MemoryHits << " memory hits, "
+     << m_DiskHits << " disk hits, "
+     << m_Misses << " misses";
+  if (m_Errors > 0)
+  {
+    os << ", " << m_Errors << " failed";
+  }
+  if (m_Frozen)
+  {
+    os << " (frozen snapshot of " << m_SnapshotGlobalTag << ", iov " << m_SnapshotIov << ")";
+  }
+  else if (!m_Directory.empty())
+  {
+    os << " (disk store " << m_Directory << ")";
+  }
+  os << std::endl;
+}
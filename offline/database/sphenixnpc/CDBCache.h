@@ -0,0 +1,109 @@
+#ifndef SPHENIXNPC_CDBCACHE_H
+#define SPHENIXNPC_CDBCACHE_H
+
+#include <chrono>
+#include <cstdint>  // for uint64_t
+#include <functional>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <string>
+#include <tuple>
+
+/**
+ * Read-through cache of conditions DB lookups, keyed by (global tag, domain, iov).
+ *
+ * Lookups are served from memory, then from an optional on-disk store shared
+ * by all jobs on a node, and only then from the DB through the resolver.
+ * The disk store is content addressed: each entry is a small file named by
+ * the hash of its key. Misses take a lock on the entry, so concurrent jobs
+ * asking for the same key query the DB once.
+ * Empty replies (no payload) are cached for a limited time (SetNoPayloadExpiry),
+ * so that a payload added to the DB is found by running jobs. Failed lookups are not cached.
+ *
+ * A frozen snapshot holds every domain of a global tag for one iov in a
+ * single file. Once read, lookups never call the resolver.
+ */
+class CDBCache
+{
+ public:
+  //! DB lookup of the url of a domain at an iov, empty if there is no payload, std::nullopt if the lookup failed
+  using Resolver = std::function<std::optional<std::string>(const std::string &domain, uint64_t iov)>;
+
+  CDBCache() = default;
+  virtual ~CDBCache() = default;
+
+  // delete copy ctor and assignment operator (cppcheck)
+  explicit CDBCache(const CDBCache &) = delete;
+  CDBCache &operator=(const CDBCache &) = delete;
+
+  //! directory of the on-disk store, created if needed. No disk store if empty
+  int SetDirectory(const std::string &directory);
+  const std::string &Directory() const { return m_Directory; }
+
+  //! time after which an empty reply (no payload) is looked up again, in memory and in the disk store. 0 does not cache them
+  void SetNoPayloadExpiry(const std::chrono::seconds &expiry) { m_NoPayloadExpiry = expiry; }
+  const std::chrono::seconds &NoPayloadExpiry() const { return m_NoPayloadExpiry; }
+
+  //! url of domain in globaltag at iov, empty if there is no payload or if the lookup failed
+  std::string Get(const std::string &globaltag, const std::string &domain, uint64_t iov, const Resolver &resolver);
+
+  //!@name frozen snapshot
+  //@{
+  //! write the urls of all domains (domain, url) of globaltag at iov
+  static int WriteSnapshot(const std::string &filename, const std::string &globaltag, uint64_t iov, const std::map<std::string, std::string> &urls);
+
+  //! load a snapshot, afterwards the DB is not contacted anymore
+  int ReadSnapshot(const std::string &filename);
+
+  bool Frozen() const { return m_Frozen; }
+
+  //! true if the snapshot is for this global tag and iov
+  bool Covers(const std::string &globaltag, uint64_t iov) const { return m_Frozen && globaltag == m_SnapshotGlobalTag && iov == m_SnapshotIov; }
+  //@}
+
+  //!@name statistics
+  //@{
+  uint64_t MemoryHits() const { return m_MemoryHits; }
+  uint64_t DiskHits() const { return m_DiskHits; }
+  uint64_t Misses() const { return m_Misses; }
+  uint64_t Errors() const { return m_Errors; }
+  void Print(std::ostream &os = std::cout) const;
+  //@}
+
+  //! content address of a key, 16 hex digits
+  static std::string Hash(const std::string &globaltag, const std::string &domain, uint64_t iov);
+
+  void Verbosity(int i) { m_Verbosity = i; }
+  int Verbosity() const { return m_Verbosity; }
+
+ private:
+  using Key = std::tuple<std::string, std::string, uint64_t>;
+
+  //! file of a key in the disk store
+  std::string EntryPath(const Key &key) const;
+
+  //! read an entry from the disk store, false if not there or if it is an expired empty reply
+  bool ReadEntry(const std::string &path, const Key &key, std::string &url) const;
+
+  //! write an entry to the disk store, atomic for concurrent readers
+  void WriteEntry(const std::string &path, const Key &key, const std::string &url) const;
+
+  int m_Verbosity{0};
+  bool m_Frozen{false};
+  std::string m_Directory;
+  std::string m_SnapshotGlobalTag;
+  uint64_t m_SnapshotIov{0};
+  std::chrono::seconds m_NoPayloadExpiry{600};
+  std::map<Key, std::string> m_Memory;
+
+  //! empty replies from the DB or the disk store, with the time they were read
+  std::map<Key, std::chrono::steady_clock::time_point> m_NoPayload;
+
+  uint64_t m_MemoryHits{0};
+  uint64_t m_DiskHits{0};
+  uint64_t m_Misses{0};
+  uint64_t m_Errors{0};
+};
+
+#endif  // SPHENIXNPC_CDBCACHE_H
@@ -0,0 +1,206 @@
+/**
+ * @file sphenixnpc/CDBCacheTest.cc
+ * @brief checks of CDBCache lookups, disk store and frozen snapshots
+ *
+ * usage: CDBCacheTest
+ *
+ * The conditions DB is replaced by a resolver serving a fixed set of urls and
+ * counting its calls. It can be made to fail, like a DB which cannot be reached.
+ * The disk store and the snapshot are written to a temporary directory, removed at the end.
+ * Expiry of empty replies in the store is checked by moving back the time of the entry file.
+ * Returns non zero if any check fails.
+ */
+#include "CDBCache.h"
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <string>
+
+namespace
+{
+  const std::string globaltag = "TestGlobalTag";
+  const uint64_t iov = 54321;
+
+  //! stand in for the conditions DB
+  class FakeDB
+  {
+   public:
+    std::map<std::string, std::string> urls = {
+        {"CEMC_CALIB", "/cdb/cemc_calib.root"},
+        {"TPC_GAIN", "/cdb/tpc_gain.root"}};
+
+    //! if true, every query fails
+    bool down = false;
+
+    unsigned int queries = 0;
+
+    CDBCache::Resolver resolver()
+    {
+      return [this](const std::string& domain, uint64_t /*iov*/) -> std::optional<std::string>
+      {
+        ++queries;
+        if (down)
+        {
+          return std::nullopt;
+        }
+        auto iter = urls.find(domain);
+        return iter == urls.end() ? std::string() : iter->second;
+      };
+    }
+  };
+
+  int nfailed = 0;
+
+  void check(bool condition, const std::string& what)
+  {
+    if (!condition)
+    {
+      std::cout << "CDBCacheTest - FAILED: " << what << std::endl;
+      ++nfailed;
+    }
+  }
+
+  //! memory layer only
+  void test_memory()
+  {
+    FakeDB db;
+    CDBCache cache;
+    check(cache.Get(globaltag, "CEMC_CALIB", iov, db.resolver()) == "/cdb/cemc_calib.root", "memory: url");
+    check(cache.Get(globaltag, "CEMC_CALIB", iov, db.resolver()) == "/cdb/cemc_calib.root", "memory: cached url");
+    check(db.queries == 1, "memory: one query per key");
+
+    // other iov and other global tag are other keys
+    cache.Get(globaltag, "CEMC_CALIB", iov + 1, db.resolver());
+    cache.Get("OtherGlobalTag", "CEMC_CALIB", iov, db.resolver());
+    check(db.queries == 3, "memory: key includes global tag and iov");
+
+    // no payload is cached
+    check(cache.Get(globaltag, "NO_SUCH_DOMAIN", iov, db.resolver()).empty(), "memory: no payload");
+    check(cache.Get(globaltag, "NO_SUCH_DOMAIN", iov, db.resolver()).empty(), "memory: cached no payload");
+    check(db.queries == 4, "memory: no payload queried once");
+    check(cache.MemoryHits() == 2 && cache.Misses() == 4, "memory: statistics");
+
+    // failed lookups are not cached
+    db.down = true;
+    check(cache.Get(globaltag, "TPC_GAIN", iov, db.resolver()).empty(), "memory: failed lookup");
+    db.down = false;
+    check(cache.Get(globaltag, "TPC_GAIN", iov, db.resolver()) == "/cdb/tpc_gain.root", "memory: lookup after failure");
+    check(db.queries == 6 && cache.Errors() == 1, "memory: failed lookup queried again");
+
+    // empty replies expire, a payload added to the DB is then found
+    db.urls["NO_SUCH_DOMAIN"] = "/cdb/new_domain.root";
+    check(cache.Get(globaltag, "NO_SUCH_DOMAIN", iov, db.resolver()).empty(), "memory: no payload before expiry");
+    cache.SetNoPayloadExpiry(std::chrono::seconds(0));
+    check(cache.Get(globaltag, "NO_SUCH_DOMAIN", iov, db.resolver()) == "/cdb/new_domain.root", "memory: payload after expiry");
+    check(db.queries == 7, "memory: expired no payload queried again");
+  }
+
+  //! disk store shared by several caches, as by several jobs
+  void test_disk(const std::string& directory)
+  {
+    FakeDB db;
+    {
+      CDBCache cache;
+      check(cache.SetDirectory(directory) == 0, "disk: set directory");
+      check(cache.Get(globaltag, "CEMC_CALIB", iov, db.resolver()) == "/cdb/cemc_calib.root", "disk: url");
+      check(cache.Get(globaltag, "NO_SUCH_DOMAIN", iov, db.resolver()).empty(), "disk: no payload");
+
+      // a DB failure must not end up in the disk store
+      db.down = true;
+      check(cache.Get(globaltag, "TPC_GAIN", iov, db.resolver()).empty(), "disk: failed lookup");
+      db.down = false;
+      check(db.queries == 3 && cache.Errors() == 1, "disk: queries of first job");
+    }
+
+    {
+      CDBCache cache;
+      cache.SetDirectory(directory);
+      check(cache.Get(globaltag, "CEMC_CALIB", iov, db.resolver()) == "/cdb/cemc_calib.root", "disk: url from store");
+      check(cache.Get(globaltag, "NO_SUCH_DOMAIN", iov, db.resolver()).empty(), "disk: no payload from store");
+      check(db.queries == 3 && cache.DiskHits() == 2, "disk: second job served from store");
+
+      // the failed lookup was not stored, it is queried again
+      check(cache.Get(globaltag, "TPC_GAIN", iov, db.resolver()) == "/cdb/tpc_gain.root", "disk: lookup after failure");
+      check(db.queries == 4 && cache.Misses() == 1, "disk: failed lookup queried again");
+    }
+
+    {
+      // an empty entry older than the expiry is looked up again, and rewritten
+      const std::string hash = CDBCache::Hash(globaltag, "NO_SUCH_DOMAIN", iov);
+      const std::filesystem::path entry = std::filesystem::path(directory) / hash.substr(0, 2) / hash;
+      std::filesystem::last_write_time(entry, std::filesystem::last_write_time(entry) - std::chrono::hours(1));
+
+      CDBCache cache;
+      cache.SetDirectory(directory);
+      check(cache.Get(globaltag, "NO_SUCH_DOMAIN", iov, db.resolver()).empty(), "disk: expired no payload");
+      check(db.queries == 5 && cache.Misses() == 1 && cache.DiskHits() == 0, "disk: expired no payload queried again");
+
+      CDBCache other;
+      other.SetDirectory(directory);
+      check(other.Get(globaltag, "NO_SUCH_DOMAIN", iov, db.resolver()).empty(), "disk: rewritten no payload");
+      check(db.queries == 5 && other.DiskHits() == 1, "disk: rewritten no payload from store");
+    }
+
+    {
+      // changed payload, a new iov is a new key
+      db.urls["CEMC_CALIB"] = "/cdb/cemc_calib_v2.root";
+      CDBCache cache;
+      cache.SetDirectory(directory);
+      check(cache.Get(globaltag, "CEMC_CALIB", iov + 1, db.resolver()) == "/cdb/cemc_calib_v2.root", "disk: new iov");
+      check(cache.Get(globaltag, "CEMC_CALIB", iov, db.resolver()) == "/cdb/cemc_calib.root", "disk: old iov");
+    }
+  }
+
+  //! write a snapshot, read it back and check that the DB is never queried
+  void test_snapshot(const std::string& filename)
+  {
+    FakeDB db;
+    std::map<std::string, std::string> urls = db.urls;
+    urls["NO_PAYLOAD"] = "";
+    check(CDBCache::WriteSnapshot(filename, globaltag, iov, urls) == 0, "snapshot: write");
+
+    CDBCache cache;
+    check(cache.ReadSnapshot(filename) == 0, "snapshot: read");
+    check(cache.Frozen(), "snapshot: frozen");
+    check(cache.Covers(globaltag, iov), "snapshot: covers global tag and iov");
+    check(!cache.Covers(globaltag, iov + 1) && !cache.Covers("OtherGlobalTag", iov), "snapshot: other global tag or iov");
+
+    db.down = true;
+    for (const auto& [domain, url] : db.urls)
+    {
+      check(cache.Get(globaltag, domain, iov, db.resolver()) == url, "snapshot: url of " + domain);
+    }
+    check(cache.Get(globaltag, "NO_PAYLOAD", iov, db.resolver()).empty(), "snapshot: no payload");
+    check(cache.Get(globaltag, "NO_SUCH_DOMAIN", iov, db.resolver()).empty(), "snapshot: unknown domain");
+    check(cache.Get(globaltag, "CEMC_CALIB", iov + 1, db.resolver()).empty(), "snapshot: other iov");
+    check(db.queries == 0, "snapshot: DB never queried");
+
+    check(CDBCache().ReadSnapshot(filename + ".missing") != 0, "snapshot: missing file");
+  }
+}  // namespace
+
+int main()
+{
+  const std::filesystem::path directory = std::filesystem::temp_directory_path() / ("CDBCacheTest." + std::to_string(getpid()));
+  std::filesystem::create_directories(directory);
+
+  test_memory();
+  test_disk((directory / "store").string());
+  test_snapshot((directory / "snapshot.txt").string());
+
+  std::filesystem::remove_all(directory);
+
+  if (nfailed > 0)
+  {
+    std::cout << "CDBCacheTest - " << nfailed << " checks failed" << std::endl;
+    return 1;
+  }
+  std::cout << "CDBCacheTest - all checks passed" << std::endl;
+  return 0;
+}
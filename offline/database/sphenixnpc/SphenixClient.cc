@@ -146,6 +146,28 @@ std::string SphenixClient::getCalibration(const std::string& pl_type, long long
   return resp["msg"];
 }
 
+int SphenixClient::getCalibration(const std::string& pl_type, long long iov, std::string& url)
+{
+  url.clear();
+  nlohmann::json resp = getPayloadIOVs(iov);
+  if (resp["code"] != 0)
+  {
+    if (m_Verbosity > 0)
+    {
+      std::cout << resp << std::endl;
+    }
+    return -1;
+  }
+  nlohmann::json payload_iovs = resp["msg"];
+  // no valid payload is a valid reply
+  if (!payload_iovs.contains(pl_type) || payload_iovs[pl_type]["minor_iov_end"] <= iov)
+  {
+    return 0;
+  }
+  url = payload_iovs[pl_type]["payload_url"].get<std::string>();
+  return 0;
+}
+
 nlohmann::json SphenixClient::unlockGlobalTag(const std::string& gt_name)
 {
   if (existGlobalTag(gt_name))
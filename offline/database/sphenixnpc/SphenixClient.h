@@ -31,6 +31,8 @@ class SphenixClient : public nopayloadclient::NoPayloadClient
   nlohmann::json insertPayload(const std::string& pl_type, const std::string& file_url, long long major_iov_start, long long minor_iov_start, long long major_iov_end, long long minor_iov_end) override;
   nlohmann::json setGlobalTag(const std::string& name) override;
   std::string getCalibration(const std::string& pl_type, long long iov);
+  //! url of pl_type at iov, empty if there is no valid payload. Returns non zero if the DB query failed
+  int getCalibration(const std::string& pl_type, long long iov, std::string& url);
   nlohmann::json unlockGlobalTag(const std::string& gt_name) override;
   nlohmann::json lockGlobalTag(const std::string& gt_name) override;
   nlohmann::json deletePayloadIOV(const std::string& pl_type, long long iov_start, long long iov_end) override;
@@ -1,5 +1,6 @@
 #include "CDBInterface.h"
 
+#include <sphenixnpc/CDBCache.h>
 #include <sphenixnpc/SphenixClient.h>
 
 #include <ffaobjects/CdbUrlSave.h>
@@ -18,12 +19,17 @@
 #include <phool/phool.h>
 #include <phool/recoConsts.h>
 
+#include <nlohmann/json.hpp>
+
 #include <TSystem.h>
 
+#include <chrono>
 #include <cstdint>  // for uint64_t
 #include <filesystem>
 #include <fstream>
 #include <iostream>  // for operator<<, basic_ostream, endl
+#include <map>
+#include <optional>
 #include <sstream>
 #include <utility>  // for pair
 #include <vector>   // for vector
@@ -43,6 +49,7 @@ CDBInterface *CDBInterface::instance()
 //____________________________________________________________________________..
 CDBInterface::CDBInterface(const std::string &name)
   : SubsysReco(name)
+  , m_Cache(new CDBCache())
 {
   Fun4AllServer *se = Fun4AllServer::instance();
   se->addNewSubsystem(this);
@@ -53,6 +60,7 @@ CDBInterface::CDBInterface(const std::string &name)
 CDBInterface::~CDBInterface()
 {
   delete cdbclient;
+  delete m_Cache;
 }
 
 //____________________________________________________________________________..
@@ -60,6 +68,10 @@ int CDBInterface::End(PHCompositeNode *topNode)
 {
   int iret = UpdateRunNode(topNode);
   PHNodeIterator iter(topNode);
+  if (Verbosity() > 0 || m_Cache->Frozen() || !m_Cache->Directory().empty())
+  {
+    m_Cache->Print();
+  }
   return iret;
 }
 
@@ -153,25 +165,27 @@ std::string CDBInterface::getUrl(const std::string &domain, const std::string &f
     std::cout << "rc->set_uint64Flag(\"TIMESTAMP\",<64 bit timestamp>)" << std::endl;
     gSystem->Exit(1);
   }
-  if (cdbclient == nullptr)
+  uint64_t timestamp = rc->get_uint64Flag("TIMESTAMP");
+  if (m_Cache->Frozen() && !m_Cache->Covers(rc->get_StringFlag("CDB_GLOBALTAG"), timestamp))
   {
-    cdbclient = new SphenixClient(rc->get_StringFlag("CDB_GLOBALTAG"));
+    std::cout << PHWHERE << "snapshot does not cover global tag " << rc->get_StringFlag("CDB_GLOBALTAG")
+              << ", timestamp " << timestamp << std::endl;
+    gSystem->Exit(1);
   }
-  uint64_t timestamp = rc->get_uint64Flag("TIMESTAMP");
   if (Verbosity() > 0)
   {
     std::cout << "Global Tag: " << rc->get_StringFlag("CDB_GLOBALTAG")
               << ", domain: " << domain_noconst
               << ", timestamp: " << timestamp;
   }
-  std::string return_url = cdbclient->getCalibration(domain_noconst, timestamp);
+  std::string return_url = getCalibration(domain_noconst, timestamp);
   if (return_url.empty())
   {
     if (!disable_default)
     {
       std::string domain_copy = domain_noconst;
       domain_noconst = domain_noconst + "_default";
-      return_url = cdbclient->getCalibration(domain_noconst, timestamp);
+      return_url = getCalibration(domain_noconst, timestamp);
       if (return_url.empty())
       {
         if (Verbosity() > 0)
@@ -210,6 +224,94 @@ std::string CDBInterface::getUrl(const std::string &domain, const std::string &f
   return return_url;
 }
 
+std::string CDBInterface::getCalibration(const std::string &domain, uint64_t timestamp)
+{
+  recoConsts *rc = recoConsts::instance();
+  const std::string globaltag = rc->get_StringFlag("CDB_GLOBALTAG");
+  return m_Cache->Get(globaltag, domain, timestamp,
+                      [this, &globaltag](const std::string &pl_type, uint64_t iov)
+                      {
+                        // only created when the DB needs to be contacted
+                        if (cdbclient == nullptr)
+                        {
+                          cdbclient = new SphenixClient(globaltag);
+                        }
+                        std::string url;
+                        if (cdbclient->getCalibration(pl_type, iov, url) != 0)
+                        {
+                          return std::optional<std::string>();
+                        }
+                        return std::optional<std::string>(url);
+                      });
+}
+
+void CDBInterface::SetCacheDirectory(const std::string &directory)
+{
+  if (m_Cache->SetDirectory(directory) != 0)
+  {
+    std::cout << PHWHERE << " cannot use cache directory " << directory << std::endl;
+    gSystem->Exit(1);
+  }
+}
+
+void CDBInterface::SetCacheNoPayloadExpiry(const unsigned int seconds)
+{
+  m_Cache->SetNoPayloadExpiry(std::chrono::seconds(seconds));
+}
+
+void CDBInterface::WriteSnapshot(const std::string &filename)
+{
+  recoConsts *rc = recoConsts::instance();
+  if (!rc->FlagExist("CDB_GLOBALTAG"))
+  {
+    std::cout << PHWHERE << "CDB_GLOBALTAG flag needs to be set via" << std::endl;
+    std::cout << "rc->set_StringFlag(\"CDB_GLOBALTAG\",<global tag>)" << std::endl;
+    gSystem->Exit(1);
+  }
+  if (!rc->FlagExist("TIMESTAMP"))
+  {
+    std::cout << PHWHERE << "TIMESTAMP flag needs to be set via" << std::endl;
+    std::cout << "rc->set_uint64Flag(\"TIMESTAMP\",<64 bit timestamp>)" << std::endl;
+    gSystem->Exit(1);
+  }
+  if (cdbclient == nullptr)
+  {
+    cdbclient = new SphenixClient(rc->get_StringFlag("CDB_GLOBALTAG"));
+  }
+  uint64_t timestamp = rc->get_uint64Flag("TIMESTAMP");
+  // all domains with a valid payload in one query
+  nlohmann::json resp = cdbclient->getUrlDict(timestamp);
+  if (resp["code"] != 0)
+  {
+    std::cout << PHWHERE << " could not get the calibrations for timestamp " << timestamp
+              << ", not writing " << filename << std::endl;
+    return;
+  }
+  std::map<std::string, std::string> urls;
+  for (const auto &piov : resp["msg"].items())
+  {
+    std::string payload_url = piov.value();
+    if (!payload_url.empty() && payload_url.front() == '"' && payload_url.back() == '"')
+    {
+      payload_url = payload_url.substr(1, payload_url.size() - 2);
+    }
+    urls[piov.key()] = payload_url;
+  }
+  if (CDBCache::WriteSnapshot(filename, rc->get_StringFlag("CDB_GLOBALTAG"), timestamp, urls) == 0 && Verbosity() > 0)
+  {
+    std::cout << "wrote " << urls.size() << " calibrations to " << filename << std::endl;
+  }
+}
+
+void CDBInterface::ReadSnapshot(const std::string &filename)
+{
+  if (m_Cache->ReadSnapshot(filename) != 0)
+  {
+    std::cout << PHWHERE << " cannot read snapshot " << filename << std::endl;
+    gSystem->Exit(1);
+  }
+}
+
 void CDBInterface::DumpCalibrations(const std::string &filename)
 {
   recoConsts *rc = recoConsts::instance();
@@ -11,6 +11,7 @@
 #include <string>
 #include <tuple>  // for tuple
 
+class CDBCache;
 class SphenixClient;
 
 class CDBInterface : public SubsysReco
@@ -38,11 +39,27 @@ class CDBInterface : public SubsysReco
   void DumpCalibrations(const std::string &filename);
   void ReadCalibrationsFromFile(const std::string &filename);
 
+  /// share lookups between the jobs on a node through a file based cache in directory
+  void SetCacheDirectory(const std::string &directory);
+
+  /// time in seconds after which a lookup without payload is sent to the DB again (default 600), 0 does not cache them
+  void SetCacheNoPayloadExpiry(const unsigned int seconds);
+
+  /// resolve all domains for the global tag and timestamp into one snapshot file
+  void WriteSnapshot(const std::string &filename);
+
+  /// use a snapshot written by WriteSnapshot, the conditions DB is not contacted anymore
+  void ReadSnapshot(const std::string &filename);
+
  private:
   CDBInterface(const std::string &name = "CDBInterface");
 
+  /// lookup through the cache, the DB is only contacted on a miss
+  std::string getCalibration(const std::string &domain, uint64_t timestamp);
+
   static CDBInterface *__instance;
   SphenixClient *cdbclient{nullptr};
+  CDBCache *m_Cache{nullptr};
   bool disable{false};
   bool disable_default{false};
   bool m_Read_From_File_Flag{false};
@@ -0,0 +1,259 @@
+#include "Fun4AllEventSlot.h"
+
+#include <phool/PHCompositeNode.h>
+#include <phool/PHIODataNode.h>
+#include <phool/PHNode.h>
+#include <phool/PHNodeIterator.h>
+#include <phool/PHNodeReset.h>
+#include <phool/PHObject.h>
+#include <phool/PHPointerListIterator.h>
+
+#include <TBuffer.h>
+#include <TBufferFile.h>
+#include <TClass.h>
+#include <TObject.h>
+
+#include <algorithm>
+#include <typeinfo>
+
+/*
+ * top node of a slot. The shared nodes of the job top node are added to it
+ * without changing their parent, and taken out before it is deleted
+ */
+class Fun4AllEventSlot::SlotTopNode : public PHCompositeNode
+{
+ public:
+  explicit SlotTopNode(const std::string &nodename)
+    : PHCompositeNode(nodename)
+  {
+  }
+
+  ~SlotTopNode() override
+  {
+    for (auto *node : m_SharedNodes)
+    {
+      forgetMe(node);
+    }
+  }
+
+  // no copy
+  SlotTopNode(const SlotTopNode &) = delete;
+  SlotTopNode &operator=(const SlotTopNode &) = delete;
+
+  void addSharedNode(PHNode *node)
+  {
+    PHNode *oldparent = node->getParent();
+    if (addNode(node))
+    {
+      m_SharedNodes.push_back(node);
+    }
+    node->setParent(oldparent);
+  }
+
+ private:
+  std::vector<PHNode *> m_SharedNodes;
+};
+
+namespace
+{
+  PHNode *find_child(PHCompositeNode *parent, const std::string &name)
+  {
+    PHNodeIterator iter(parent);
+    PHPointerListIterator<PHNode> nodeIter(iter.ls());
+    PHNode *node = nullptr;
+    while ((node = nodeIter()))
+    {
+      if (node->getName() == name)
+      {
+        return node;
+      }
+    }
+    return nullptr;
+  }
+
+  // the object can be created and streamed if its dynamic class has a dictionary
+  bool has_dictionary(const TObject *object)
+  {
+    const TClass *cl = TClass::GetClass(typeid(*object));
+    return cl && cl == object->IsA() && cl->GetNew();
+  }
+
+  // copy object content through its streamer, the same way it is written to and read from a DST
+  void copy_object(TObject *source, TObject *dest, TBufferFile &buffer)
+  {
+    if (auto *object = dynamic_cast<PHObject *>(dest))
+    {
+      object->Reset();
+    }
+    buffer.SetWriteMode();
+    buffer.SetBufferOffset(0);
+    buffer.ResetMap();
+    source->Streamer(buffer);
+    buffer.SetReadMode();
+    buffer.SetBufferOffset(0);
+    buffer.ResetMap();
+    dest->Streamer(buffer);
+  }
+
+  // copy all data nodes of the source tree to the destination tree, creating the missing ones
+  // NOLINTNEXTLINE(misc-no-recursion)
+  void copy_nodes(PHCompositeNode *source, PHCompositeNode *dest, TBufferFile &buffer)
+  {
+    PHNodeIterator iter(source);
+    PHPointerListIterator<PHNode> nodeIter(iter.ls());
+    PHNode *node = nullptr;
+    while ((node = nodeIter()))
+    {
+      PHNode *target = find_child(dest, node->getName());
+      if (node->getType() == "PHCompositeNode")
+      {
+        if (!target)
+        {
+          target = new PHCompositeNode(node->getName());
+          dest->addNode(target);
+        }
+        copy_nodes(static_cast<PHCompositeNode *>(node), static_cast<PHCompositeNode *>(target), buffer);
+        continue;
+      }
+
+      // only TObjects can be copied, see UnsupportedNodes
+      if (node->getType() != "PHIODataNode")
+      {
+        continue;
+      }
+      TObject *object = static_cast<PHIODataNode<TObject> *>(node)->getData();
+      if (!object)
+      {
+        continue;
+      }
+
+      auto *targetNode = static_cast<PHIODataNode<TObject> *>(target);
+      if (!targetNode)
+      {
+        targetNode = new PHIODataNode<TObject>(static_cast<TObject *>(object->IsA()->New()), node->getName(), node->getObjectType());
+        dest->addNode(targetNode);
+      }
+      else if (!targetNode->getData() || targetNode->getData()->IsA() != object->IsA())
+      {
+        // the class stored in the node changed (new input file)
+        delete targetNode->getData();
+        targetNode->setData(static_cast<TObject *>(object->IsA()->New()));
+      }
+      copy_object(object, targetNode->getData(), buffer);
+    }
+  }
+
+  // NOLINTNEXTLINE(misc-no-recursion)
+  void find_unsupported_nodes(PHCompositeNode *composite, const std::string &path, std::vector<std::string> &unsupported)
+  {
+    PHNodeIterator iter(composite);
+    PHPointerListIterator<PHNode> nodeIter(iter.ls());
+    PHNode *node = nullptr;
+    while ((node = nodeIter()))
+    {
+      const std::string nodepath = path + "/" + node->getName();
+      if (node->getType() == "PHCompositeNode")
+      {
+        find_unsupported_nodes(static_cast<PHCompositeNode *>(node), nodepath, unsupported);
+      }
+      else if (node->getType() != "PHIODataNode")
+      {
+        unsupported.push_back(nodepath + " (" + node->getType() + ")");
+      }
+      else if (const TObject *object = static_cast<PHIODataNode<TObject> *>(node)->getData(); object && !has_dictionary(object))
+      {
+        unsupported.push_back(nodepath + " (" + node->getClass() + " has no dictionary)");
+      }
+    }
+  }
+}  // namespace
+
+Fun4AllEventSlot::Fun4AllEventSlot(PHCompositeNode *topNode, const std::vector<std::string> &eventnodes)
+  : m_TopNode(topNode)
+  , m_EventNodes(eventnodes)
+  , m_SlotTopNode(std::make_unique<SlotTopNode>(topNode->getName()))
+  , m_Buffer(std::make_unique<TBufferFile>(TBuffer::kWrite))
+{
+  PHNodeIterator iter(m_TopNode);
+  PHPointerListIterator<PHNode> nodeIter(iter.ls());
+  PHNode *node = nullptr;
+  while ((node = nodeIter()))
+  {
+    if (std::find(m_EventNodes.begin(), m_EventNodes.end(), node->getName()) == m_EventNodes.end())
+    {
+      m_SlotTopNode->addSharedNode(node);
+    }
+  }
+}
+
+Fun4AllEventSlot::~Fun4AllEventSlot() = default;
+
+PHCompositeNode *Fun4AllEventSlot::TopNode() const
+{
+  return m_SlotTopNode.get();
+}
+
+void Fun4AllEventSlot::CopyIn()
+{
+  for (const auto &name : m_EventNodes)
+  {
+    auto *source = dynamic_cast<PHCompositeNode *>(find_child(m_TopNode, name));
+    if (!source)
+    {
+      continue;
+    }
+    auto *dest = dynamic_cast<PHCompositeNode *>(find_child(m_SlotTopNode.get(), name));
+    if (!dest)
+    {
+      dest = new PHCompositeNode(name);
+      m_SlotTopNode->addNode(dest);
+    }
+    copy_nodes(source, dest, *m_Buffer);
+  }
+}
+
+void Fun4AllEventSlot::CopyOut()
+{
+  for (const auto &name : m_EventNodes)
+  {
+    auto *source = dynamic_cast<PHCompositeNode *>(find_child(m_SlotTopNode.get(), name));
+    if (!source)
+    {
+      continue;
+    }
+    auto *dest = dynamic_cast<PHCompositeNode *>(find_child(m_TopNode, name));
+    if (!dest)
+    {
+      dest = new PHCompositeNode(name);
+      m_TopNode->addNode(dest);
+    }
+    copy_nodes(source, dest, *m_Buffer);
+  }
+}
+
+void Fun4AllEventSlot::Reset()
+{
+  PHNodeReset reset;
+  PHNodeIterator iter(m_SlotTopNode.get());
+  for (const auto &name : m_EventNodes)
+  {
+    if (iter.cd(name))
+    {
+      iter.forEach(reset);
+      iter.cd();
+    }
+  }
+}
+
+std::vector<std::string> Fun4AllEventSlot::UnsupportedNodes(PHCompositeNode *topNode, const std::vector<std::string> &eventnodes)
+{
+  std::vector<std::string> unsupported;
+  for (const auto &name : eventnodes)
+  {
+    if (auto *composite = dynamic_cast<PHCompositeNode *>(find_child(topNode, name)))
+    {
+      find_unsupported_nodes(composite, topNode->getName() + "/" + name, unsupported);
+    }
+  }
+  return unsupported;
+}
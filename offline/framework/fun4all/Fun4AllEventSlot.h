@@ -0,0 +1,59 @@
+// Tell emacs that this is a C++ source
+//  -*- C++ -*-.
+#ifndef FUN4ALL_FUN4ALLEVENTSLOT_H
+#define FUN4ALL_FUN4ALLEVENTSLOT_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class PHCompositeNode;
+class TBufferFile;
+
+/** Node tree of one event in flight, see Fun4AllServer::SetEventsInFlight().
+ *
+ *  The slot has its own copy of the event nodes of a top node (the nodes which are
+ *  reset after each event, DST by default) and shares all other nodes (RUN, PAR ...)
+ *  with it. Event node objects are copied in and out with their ROOT streamer, as
+ *  when they are written to and read from a DST. The objects of the top node keep
+ *  their address, so that input managers, output managers and modules which cache
+ *  them are not affected. The shared nodes are those of the top node when the slot
+ *  is created, nodes added below them later are not seen by the slot.
+ */
+class Fun4AllEventSlot
+{
+ public:
+  Fun4AllEventSlot(PHCompositeNode *topNode, const std::vector<std::string> &eventnodes);
+  ~Fun4AllEventSlot();
+
+  // no copy
+  Fun4AllEventSlot(const Fun4AllEventSlot &) = delete;
+  Fun4AllEventSlot &operator=(const Fun4AllEventSlot &) = delete;
+
+  //! top node to be passed to the modules processing the slot event
+  PHCompositeNode *TopNode() const;
+
+  //! copy the event nodes from the top node to the slot. Missing nodes are created
+  void CopyIn();
+
+  //! copy the event nodes from the slot back to the top node. Missing nodes are created
+  void CopyOut();
+
+  //! reset the event nodes of the slot, to be called when its event is finished
+  void Reset();
+
+  /** event nodes which cannot be copied: nodes which do not hold a TObject (PHDataNode)
+   *  and objects whose class has no ROOT dictionary
+   */
+  static std::vector<std::string> UnsupportedNodes(PHCompositeNode *topNode, const std::vector<std::string> &eventnodes);
+
+ private:
+  class SlotTopNode;
+
+  PHCompositeNode *m_TopNode{nullptr};
+  std::vector<std::string> m_EventNodes;
+  std::unique_ptr<SlotTopNode> m_SlotTopNode;
+  std::unique_ptr<TBufferFile> m_Buffer;
+};
+
+#endif
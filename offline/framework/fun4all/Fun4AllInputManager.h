@@ -40,6 +40,8 @@ class Fun4AllInputManager : public Fun4AllBase, public InputFileHandler
   virtual int NoSyncPushBackEvents(const int /*nevt*/) { return -1; }
   virtual void setSyncManager(Fun4AllSyncManager *master) { m_MySyncManager = master; }
   virtual int ResetEvent() { return 0; }
+  //! called when Fun4AllServer::run() returns and in End(), input managers reading ahead in other threads wait for them here
+  virtual void FinishRunAhead() {}
   virtual void SetRunNumber(const int runno) { m_MyRunNumber = runno; }
   virtual int RunNumber() const { return m_MyRunNumber; }
 
@@ -1,6 +1,7 @@
 #include "Fun4AllServer.h"
 
 #include "Fun4AllDstOutputManager.h"
+#include "Fun4AllEventSlot.h"
 #include "Fun4AllHistoBinDefs.h"
 #include "Fun4AllHistoManager.h"  // for Fun4AllHistoManager
 #include "Fun4AllInputManager.h"
@@ -9,6 +10,7 @@
 #include "Fun4AllOutputManager.h"
 #include "Fun4AllReturnCodes.h"
 #include "Fun4AllSyncManager.h"
+#include "Fun4AllTaskScheduler.h"
 #include "SubsysReco.h"
 
 #include <phool/PHCompositeNode.h>
@@ -32,11 +34,13 @@
 #include <TSystem.h>
 
 #include <algorithm>
+#include <cstdint>
 #include <cstdlib>
 #include <exception>
 #include <iostream>
 #include <memory>  // for allocator_traits<>::value_type
 #include <sstream>
+#include <string>
 
 // #define FFAMEMTRACKER
 
@@ -64,6 +68,10 @@ Fun4AllServer::Fun4AllServer(const std::string &name)
 
 Fun4AllServer::~Fun4AllServer()
 {
+  // events in flight use the modules and the TOP node tree
+  m_EventsInFlightQueue.clear();
+  m_FreeEventSlots.clear();
+  m_EventSlots.clear();
   Reset();
   delete beginruntimestamp;
   while (Subsystems.begin() != Subsystems.end())
@@ -116,6 +124,7 @@ Fun4AllServer::~Fun4AllServer()
   recoConsts *rc = recoConsts::instance();
   delete rc;
   delete ffamemtracker;
+  delete m_TaskScheduler;
   __instance = nullptr;
   return;
 }
@@ -504,11 +513,27 @@ TNamed *Fun4AllServer::getHisto(const std::string &hname) const
   return (ServerHistoManager->getHisto(hname));
 }
 
+// state of an event processed by the re-entrant modules
+struct Fun4AllServer::EventInFlight
+{
+  explicit EventInFlight(Fun4AllTaskScheduler *scheduler)
+    : group(scheduler)
+  {
+  }
+  Fun4AllEventSlot *slot{nullptr};
+  // re-entrant modules and the index of the first one, the module list can change while the event is in flight
+  std::vector<SubsysReco *> modules;
+  std::size_t begin{0};
+  std::vector<int> retcodes;
+  int eventnumber{0};
+  std::string error;
+  // last member, its destructor waits for the task using the others
+  Fun4AllTaskScheduler::TaskGroup group;
+};
+
 int Fun4AllServer::process_event()
 {
   eventcounter++;
-  unsigned icnt = 0;
-  int eventbad = 0;
   if (ScreamEveryEvent)
   {
     std::cout << "*******************************************************************************" << std::endl;
@@ -528,12 +553,63 @@ int Fun4AllServer::process_event()
   }
   if (unregistersubsystem)
   {
+    // the module indices change, finish the events in flight first
+    if (int iret = DrainEventsInFlight(true))
+    {
+      return iret;
+    }
     unregisterSubsystemsNow();
   }
+  if (m_EventsInFlight > 1)
+  {
+    if (Subsystems.size() != m_NumSubsystemsInFlight)
+    {
+      if (int iret = DrainEventsInFlight(true))
+      {
+        return iret;
+      }
+      InitEventsInFlight();
+    }
+    if (m_EventsInFlight > 1)
+    {
+      return process_event_in_flight();
+    }
+  }
+  int eventbad = 0;
   gROOT->cd(default_Tdirectory.c_str());
   std::string currdir = gDirectory->GetPath();
-  for (auto &Subsystem : Subsystems)
+  int iret = RunSubsystems(0, Subsystems.size(), RetCodes, eventbad);
+  if (iret)
+  {
+    return iret;
+  }
+  if (!eventbad)
   {
+    retcodesmap[Fun4AllReturnCodes::EVENT_OK]++;
+  }
+
+  gROOT->cd(currdir.c_str());
+  //  mainIter.print();
+  WriteEvent(RetCodes, eventbad);
+  ResetEventSubsystems(0, Subsystems.size());
+  for (auto &syncman : SyncManagers)
+  {
+    if (Verbosity() >= VERBOSITY_EVEN_MORE)
+    {
+      std::cout << "Fun4AllServer::process_event Resetting Event for Sync Manager " << syncman->Name() << std::endl;
+    }
+    syncman->ResetEvent();
+  }
+  Fun4AllMonitoring::instance()->Snapshot("Event");
+  ResetNodeTree();
+  return 0;
+}
+
+int Fun4AllServer::RunSubsystems(const std::size_t begin, const std::size_t end, std::vector<int> &retcodes, int &eventbad)
+{
+  for (std::size_t icnt = begin; icnt < end; ++icnt)
+  {
+    auto &Subsystem = Subsystems[icnt];
     if (Verbosity() >= VERBOSITY_MORE)
     {
       std::cout << "Fun4AllServer::process_event processing " << Subsystem.first->Name() << std::endl;
@@ -576,7 +652,9 @@ int Fun4AllServer::process_event()
       ffamemtracker->Start(timer_name, "SubsysReco");
       ffamemtracker->Snapshot("Fun4AllServerProcessEvent");
 #endif
+      const uint64_t lookups_before = PHCompositeNode::getLookupCount();
       int retcode = Subsystem.first->process_event(Subsystem.second);
+      m_NodeLookups[Subsystem.first->Name()] += PHCompositeNode::getLookupCount() - lookups_before;
       std::cout.copyfmt(m_saved_cout_state); // restore cout to default formatting
 #ifdef FFAMEMTRACKER
       ffamemtracker->Snapshot("Fun4AllServerProcessEvent");
@@ -587,12 +665,12 @@ int Fun4AllServer::process_event()
       // exception which will allow us to catch this and print out icnt and the size
       try
       {
-        RetCodes.at(icnt) = retcode;
+        retcodes.at(icnt) = retcode;
       }
       catch (const std::exception &e)
       {
         std::cout << PHWHERE << " caught exception thrown during RetCodes.at(icnt)" << std::endl;
-        std::cout << "RetCodes.size(): " << RetCodes.size() << ", icnt: " << icnt << std::endl;
+        std::cout << "RetCodes.size(): " << retcodes.size() << ", icnt: " << icnt << std::endl;
         std::cout << "error: " << e.what() << std::endl;
         gSystem->Exit(1);
       }
@@ -617,49 +695,14 @@ int Fun4AllServer::process_event()
                 << Subsystem.first->Name() << std::endl;
       exit(1);
     }
-    if (RetCodes[icnt])
+    int iret = HandleReturnCode(retcodes[icnt], Subsystem.first, eventbad);
+    if (iret == Fun4AllReturnCodes::ABORTEVENT)
     {
-      if (RetCodes[icnt] == Fun4AllReturnCodes::DISCARDEVENT)
-      {
-        if (Verbosity() >= VERBOSITY_EVEN_MORE)
-        {
-          std::cout << "Fun4AllServer::Discard Event by " << Subsystem.first->Name() << std::endl;
-        }
-      }
-      else if (RetCodes[icnt] == Fun4AllReturnCodes::ABORTEVENT)
-      {
-        retcodesmap[Fun4AllReturnCodes::ABORTEVENT]++;
-        eventbad = 1;
-        if (Verbosity() >= VERBOSITY_MORE)
-        {
-          std::cout << "Fun4AllServer::Abort Event by " << Subsystem.first->Name() << std::endl;
-        }
-        break;
-      }
-      else if (RetCodes[icnt] == Fun4AllReturnCodes::ABORTRUN)
-      {
-        retcodesmap[Fun4AllReturnCodes::ABORTRUN]++;
-        std::cout << "Fun4AllServer::Abort Run by " << Subsystem.first->Name() << std::endl;
-        return Fun4AllReturnCodes::ABORTRUN;
-      }
-      else if (RetCodes[icnt] == Fun4AllReturnCodes::ABORTPROCESSING)
-      {
-        eventbad = 1;
-        retcodesmap[Fun4AllReturnCodes::ABORTPROCESSING]++;
-        std::cout << "Fun4AllServer::Abort Processing by " << Subsystem.first->Name() << std::endl;
-        return Fun4AllReturnCodes::ABORTPROCESSING;
-      }
-      else
-      {
-        std::cout << "Fun4AllServer::Unknown return code: "
-                  << RetCodes[icnt] << " from process_event method of "
-                  << Subsystem.first->Name() << std::endl;
-        std::cout << "This smells like an uninitialized return code and" << std::endl;
-        std::cout << "it is too dangerous to continue, this Run will be aborted" << std::endl;
-        std::cout << "If you do not know how to fix this please send mail to" << std::endl;
-        std::cout << "phenix-off-l with this message" << std::endl;
-        return Fun4AllReturnCodes::ABORTRUN;
-      }
+      break;
+    }
+    if (iret)
+    {
+      return iret;
     }
     subsystem_timer.stop();
     double TimeSubsystem = subsystem_timer.elapsed();
@@ -668,15 +711,63 @@ int Fun4AllServer::process_event()
       std::cout << "Fun4AllServer::process_event processing " << Subsystem.first->Name()
                 << " processing total time: " << TimeSubsystem << " ms" << std::endl;
     }
-    icnt++;
   }
-  if (!eventbad)
+  return 0;
+}
+
+// returns 0 to continue with the next module, ABORTEVENT to stop processing
+// this event, ABORTRUN or ABORTPROCESSING to stop processing altogether
+int Fun4AllServer::HandleReturnCode(const int retcode, const SubsysReco *subsystem, int &eventbad)
+{
+  if (retcode)
   {
-    retcodesmap[Fun4AllReturnCodes::EVENT_OK]++;
+    if (retcode == Fun4AllReturnCodes::DISCARDEVENT)
+    {
+      if (Verbosity() >= VERBOSITY_EVEN_MORE)
+      {
+        std::cout << "Fun4AllServer::Discard Event by " << subsystem->Name() << std::endl;
+      }
+    }
+    else if (retcode == Fun4AllReturnCodes::ABORTEVENT)
+    {
+      retcodesmap[Fun4AllReturnCodes::ABORTEVENT]++;
+      eventbad = 1;
+      if (Verbosity() >= VERBOSITY_MORE)
+      {
+        std::cout << "Fun4AllServer::Abort Event by " << subsystem->Name() << std::endl;
+      }
+      return Fun4AllReturnCodes::ABORTEVENT;
+    }
+    else if (retcode == Fun4AllReturnCodes::ABORTRUN)
+    {
+      retcodesmap[Fun4AllReturnCodes::ABORTRUN]++;
+      std::cout << "Fun4AllServer::Abort Run by " << subsystem->Name() << std::endl;
+      return Fun4AllReturnCodes::ABORTRUN;
+    }
+    else if (retcode == Fun4AllReturnCodes::ABORTPROCESSING)
+    {
+      eventbad = 1;
+      retcodesmap[Fun4AllReturnCodes::ABORTPROCESSING]++;
+      std::cout << "Fun4AllServer::Abort Processing by " << subsystem->Name() << std::endl;
+      return Fun4AllReturnCodes::ABORTPROCESSING;
+    }
+    else
+    {
+      std::cout << "Fun4AllServer::Unknown return code: "
+                << retcode << " from process_event method of "
+                << subsystem->Name() << std::endl;
+      std::cout << "This smells like an uninitialized return code and" << std::endl;
+      std::cout << "it is too dangerous to continue, this Run will be aborted" << std::endl;
+      std::cout << "If you do not know how to fix this please send mail to" << std::endl;
+      std::cout << "phenix-off-l with this message" << std::endl;
+      return Fun4AllReturnCodes::ABORTRUN;
+    }
   }
+  return 0;
+}
 
-  gROOT->cd(currdir.c_str());
-  //  mainIter.print();
+void Fun4AllServer::WriteEvent(std::vector<int> &retcodes, const int eventbad)
+{
   if (!OutputManager.empty() && !eventbad)  // there are registered IO managers and
   // the event is not flagged bad
   {
@@ -705,7 +796,7 @@ int Fun4AllServer::process_event()
       }
       for (auto *iterOutMan : OutputManager)
       {
-        if (!iterOutMan->DoNotWriteEvent(&RetCodes))
+        if (!iterOutMan->DoNotWriteEvent(&retcodes))
         {
           if (Verbosity() >= VERBOSITY_MORE)
           {
@@ -786,47 +877,298 @@ int Fun4AllServer::process_event()
       }
     }
   }
-  for (auto &Subsystem : Subsystems)
+}
+
+void Fun4AllServer::ResetEventSubsystems(const std::size_t begin, const std::size_t end)
+{
+  for (std::size_t i = begin; i < end; ++i)
   {
     if (Verbosity() >= VERBOSITY_EVEN_MORE)
     {
-      std::cout << "Fun4AllServer::process_event Resetting Event " << Subsystem.first->Name() << std::endl;
+      std::cout << "Fun4AllServer::process_event Resetting Event " << Subsystems[i].first->Name() << std::endl;
     }
-    Subsystem.first->ResetEvent(Subsystem.second);
+    Subsystems[i].first->ResetEvent(Subsystems[i].second);
   }
-  for (auto &syncman : SyncManagers)
+}
+
+void Fun4AllServer::InitEventsInFlight()
+{
+  DrainEventsInFlight(false);
+  m_FreeEventSlots.clear();
+  m_EventSlots.clear();
+  m_EventsInFlight = 1;
+  if (m_RequestedEventsInFlight <= 1)
   {
-    if (Verbosity() >= VERBOSITY_EVEN_MORE)
+    return;
+  }
+  // the first contiguous block of re-entrant modules under TOP
+  auto reentrant = [this](const std::size_t i)
+  { return Subsystems[i].second == TopNode && Subsystems[i].first->HasCapability(SubsysReco::REENTRANT); };
+  m_ReentrantBegin = 0;
+  while (m_ReentrantBegin < Subsystems.size() && !reentrant(m_ReentrantBegin))
+  {
+    ++m_ReentrantBegin;
+  }
+  m_ReentrantEnd = m_ReentrantBegin;
+  while (m_ReentrantEnd < Subsystems.size() && reentrant(m_ReentrantEnd))
+  {
+    ++m_ReentrantEnd;
+  }
+  std::string reason;
+  if (NumThreads() <= 1)
+  {
+    reason = "only one thread, see SetNumThreads()";
+  }
+  else if (m_ReentrantBegin == m_ReentrantEnd)
+  {
+    reason = "no module under TOP declares SubsysReco::REENTRANT";
+  }
+  else
+  {
+    for (const auto &nodename : Fun4AllEventSlot::UnsupportedNodes(TopNode, ResetNodeList))
     {
-      std::cout << "Fun4AllServer::process_event Resetting Event for Sync Manager " << syncman->Name() << std::endl;
+      reason += (reason.empty() ? "event nodes cannot be copied: " : ", ") + nodename;
     }
+  }
+  if (!reason.empty())
+  {
+    std::cout << "Fun4AllServer: " << m_RequestedEventsInFlight << " events in flight requested, processing one event at a time, "
+              << reason << std::endl;
+    return;
+  }
+  for (unsigned int i = 0; i < m_RequestedEventsInFlight; ++i)
+  {
+    m_EventSlots.push_back(std::make_unique<Fun4AllEventSlot>(TopNode, ResetNodeList));
+    m_FreeEventSlots.push_back(m_EventSlots.back().get());
+  }
+  m_EventsInFlight = m_RequestedEventsInFlight;
+  m_NumSubsystemsInFlight = Subsystems.size();
+  // the re-entrant modules fill histograms and create objects from the worker threads
+  ROOT::EnableThreadSafety();
+  if (Verbosity() > 0)
+  {
+    std::cout << "Fun4AllServer: " << m_EventsInFlight << " events in flight, re-entrant modules:";
+    for (std::size_t i = m_ReentrantBegin; i < m_ReentrantEnd; ++i)
+    {
+      std::cout << " " << Subsystems[i].first->Name();
+    }
+    std::cout << std::endl;
+  }
+}
+
+int Fun4AllServer::process_event_in_flight()
+{
+  // there is always a free slot, events are finished as soon as all slots are used
+  auto event = std::make_unique<EventInFlight>(TaskScheduler());
+  event->slot = m_FreeEventSlots.back();
+  m_FreeEventSlots.pop_back();
+  event->retcodes.assign(Subsystems.size(), 0);
+  event->eventnumber = eventnumber;
+
+  // modules before the re-entrant ones work on the TOP node tree
+  int eventbad = 0;
+  gROOT->cd(default_Tdirectory.c_str());
+  std::string currdir = gDirectory->GetPath();
+  int iret = RunSubsystems(0, m_ReentrantBegin, event->retcodes, eventbad);
+  gROOT->cd(currdir.c_str());
+  if (iret)
+  {
+    m_FreeEventSlots.push_back(event->slot);
+    return iret;
+  }
+  if (!eventbad)
+  {
+    event->slot->CopyIn();
+  }
+  ResetEventSubsystems(0, m_ReentrantBegin);
+  for (auto &syncman : SyncManagers)
+  {
     syncman->ResetEvent();
   }
-  Fun4AllMonitoring::instance()->Snapshot("Event");
   ResetNodeTree();
-  return 0;
+  if (eventbad)
+  {
+    m_FreeEventSlots.push_back(event->slot);
+    return 0;
+  }
+
+  for (std::size_t i = m_ReentrantBegin; i < m_ReentrantEnd; ++i)
+  {
+    event->modules.push_back(Subsystems[i].first);
+  }
+  event->begin = m_ReentrantBegin;
+  EventInFlight *current = event.get();
+  current->group.run([current]()
+                     { RunReentrantSubsystems(*current); });
+  m_EventsInFlightQueue.push_back(std::move(event));
+
+  while (m_EventsInFlightQueue.size() >= m_EventsInFlight)
+  {
+    int ret = FinishEventInFlight();
+    if (!iret)
+    {
+      iret = ret;
+    }
+  }
+  Fun4AllMonitoring::instance()->Snapshot("Event");
+  return iret;
 }
 
-int Fun4AllServer::ResetNodeTree()
+// runs on the task scheduler, the return codes are handled by FinishEventInFlight
+void Fun4AllServer::RunReentrantSubsystems(EventInFlight &event)
 {
-  PHNodeReset reset;
-  reset.Verbosity(Verbosity() > 2 ? Verbosity() - 2 : 0);  // one lower verbosity level than Fun4AllServer
-  std::map<std::string, PHCompositeNode *>::const_iterator iter;
-  for (iter = topnodemap.begin(); iter != topnodemap.end(); ++iter)
+  for (std::size_t i = 0; i < event.modules.size(); ++i)
   {
-    PHNodeIterator mainIter((*iter).second);
-    for (const auto &nodename : ResetNodeList)
+    int &retcode = event.retcodes[event.begin + i];
+    try
     {
-      if (mainIter.cd(nodename))
+      retcode = event.modules[i]->process_event(event.slot->TopNode());
+    }
+    catch (const std::exception &e)
+    {
+      event.error = event.modules[i]->Name() + ", error: " + e.what();
+      return;
+    }
+    catch (...)
+    {
+      event.error = event.modules[i]->Name() + ", unknown type exception";
+      return;
+    }
+    if (retcode && retcode != Fun4AllReturnCodes::DISCARDEVENT)
+    {
+      return;
+    }
+  }
+}
+
+// finishes the oldest event in flight: modules after the re-entrant ones, output, reset
+int Fun4AllServer::FinishEventInFlight()
+{
+  std::unique_ptr<EventInFlight> event = std::move(m_EventsInFlightQueue.front());
+  m_EventsInFlightQueue.pop_front();
+  try
+  {
+    event->group.wait();
+  }
+  catch (const std::exception &e)
+  {
+    event->error = e.what();
+  }
+  if (!event->error.empty())
+  {
+    std::cout << PHWHERE << " caught exception thrown during process_event from "
+              << event->error << std::endl;
+    gSystem->Exit(1);
+  }
+
+  int iret = 0;
+  int eventbad = m_DiscardEventsInFlight ? 1 : 0;
+  for (std::size_t i = m_ReentrantBegin; i < m_ReentrantEnd && !eventbad; ++i)
+  {
+    iret = HandleReturnCode(event->retcodes[i], Subsystems[i].first, eventbad);
+    if (iret)
+    {
+      break;
+    }
+  }
+  if (iret == Fun4AllReturnCodes::ABORTEVENT)
+  {
+    iret = 0;
+  }
+  if (!eventbad && !iret)
+  {
+    const int current_eventnumber = eventnumber;
+    eventnumber = event->eventnumber;
+    event->slot->CopyOut();
+    gROOT->cd(default_Tdirectory.c_str());
+    std::string currdir = gDirectory->GetPath();
+    iret = RunSubsystems(m_ReentrantEnd, Subsystems.size(), event->retcodes, eventbad);
+    gROOT->cd(currdir.c_str());
+    if (!iret)
+    {
+      if (!eventbad)
       {
-        mainIter.forEach(reset);
-        mainIter.cd();
+        retcodesmap[Fun4AllReturnCodes::EVENT_OK]++;
+        m_GoodEventsFinished++;
       }
+      WriteEvent(event->retcodes, eventbad);
     }
+    eventnumber = current_eventnumber;
+  }
+  if (iret)
+  {
+    // as for an event processed alone, nothing after it is written
+    m_DiscardEventsInFlight = true;
+  }
+  ResetEventSubsystems(m_ReentrantBegin, Subsystems.size());
+  ResetEventNodes(TopNode);
+  event->slot->Reset();
+  m_FreeEventSlots.push_back(event->slot);
+  RetCodes = event->retcodes;
+  return iret;
+}
+
+// finishes all events in flight. The current event on the TOP node tree is kept
+// aside in a free slot if requested
+int Fun4AllServer::DrainEventsInFlight(const bool keep_current_event)
+{
+  int iret = 0;
+  if (!m_EventsInFlightQueue.empty())
+  {
+    Fun4AllEventSlot *current = nullptr;
+    const int current_eventnumber = eventnumber;
+    if (keep_current_event)
+    {
+      current = m_FreeEventSlots.back();
+      m_FreeEventSlots.pop_back();
+      current->CopyIn();
+      ResetEventNodes(TopNode);
+    }
+    while (!m_EventsInFlightQueue.empty())
+    {
+      int ret = FinishEventInFlight();
+      if (!iret)
+      {
+        iret = ret;
+      }
+    }
+    if (current)
+    {
+      current->CopyOut();
+      current->Reset();
+      m_FreeEventSlots.push_back(current);
+    }
+    eventnumber = current_eventnumber;
+  }
+  m_DiscardEventsInFlight = false;
+  return iret;
+}
+
+int Fun4AllServer::ResetNodeTree()
+{
+  std::map<std::string, PHCompositeNode *>::const_iterator iter;
+  for (iter = topnodemap.begin(); iter != topnodemap.end(); ++iter)
+  {
+    ResetEventNodes((*iter).second);
   }
   return 0;  // anything except 0 would abort the event loop in pmonitor
 }
 
+void Fun4AllServer::ResetEventNodes(PHCompositeNode *topnode)
+{
+  PHNodeReset reset;
+  reset.Verbosity(Verbosity() > 2 ? Verbosity() - 2 : 0);  // one lower verbosity level than Fun4AllServer
+  PHNodeIterator mainIter(topnode);
+  for (const auto &nodename : ResetNodeList)
+  {
+    if (mainIter.cd(nodename))
+    {
+      mainIter.forEach(reset);
+      mainIter.cd();
+    }
+  }
+}
+
 int Fun4AllServer::Reset()
 {
   int i = 0;
@@ -911,6 +1253,7 @@ int Fun4AllServer::BeginRun(const int runno)
   gROOT->cd(currdir.c_str());
   // print out all node trees
   Print("NODETREE");
+  InitEventsInFlight();
 #ifdef FFAMEMTRACKER
   ffamemtracker->Snapshot("Fun4AllServerBeginRun");
 #endif
@@ -1104,6 +1447,11 @@ int Fun4AllServer::EndRun(const int runno)
 
 int Fun4AllServer::End()
 {
+  DrainEventsInFlight(false);
+  for (auto &syncman : SyncManagers)
+  {
+    syncman->FinishRunAhead();
+  }
   recoConsts *rc = recoConsts::instance();
   if (rc->FlagExist("RUNNUMBER"))
   {
@@ -1196,6 +1544,10 @@ int Fun4AllServer::End()
       }
     }
   }
+  if (Verbosity() >= VERBOSITY_SOME)
+  {
+    PrintNodeLookups();
+  }
   if (ScreamEveryEvent)
   {
     std::cout << "*******************************************************************************" << std::endl;
@@ -1446,6 +1798,7 @@ int Fun4AllServer::run(const int nevnts, const bool require_nevents)
   int iret = 0;
   int icnt = 0;
   int icnt_good = 0;
+  m_GoodEventsFinished = 0;
   std::vector<Fun4AllSyncManager *>::const_iterator iter;
   while (!iret)
   {
@@ -1535,6 +1888,12 @@ int Fun4AllServer::run(const int nevnts, const bool require_nevents)
     {
       if (currentrun != runnumber)
       {
+        // the events in flight belong to the previous run
+        iret = DrainEventsInFlight(true);
+        if (iret)
+        {
+          break;
+        }
         EndRun(runnumber);
         runnumber = currentrun;
         setRun(runnumber);
@@ -1567,9 +1926,19 @@ int Fun4AllServer::run(const int nevnts, const bool require_nevents)
 
     if (require_nevents)
     {
-      if (std::find(RetCodes.begin(),
-                    RetCodes.end(),
-                    static_cast<int>(Fun4AllReturnCodes::ABORTEVENT)) == RetCodes.end())
+      if (m_EventsInFlight > 1)
+      {
+        // events in flight can still be aborted, finish them rather than reading more events than needed
+        while (!iret && nevnts > 0 && !m_EventsInFlightQueue.empty() &&
+               m_GoodEventsFinished + static_cast<int>(m_EventsInFlightQueue.size()) >= nevnts)
+        {
+          iret = FinishEventInFlight();
+        }
+        icnt_good = m_GoodEventsFinished;
+      }
+      else if (std::find(RetCodes.begin(),
+                         RetCodes.end(),
+                         static_cast<int>(Fun4AllReturnCodes::ABORTEVENT)) == RetCodes.end())
       {
         icnt_good++;
       }
@@ -1583,6 +1952,16 @@ int Fun4AllServer::run(const int nevnts, const bool require_nevents)
       break;
     }
   }
+  int drainret = DrainEventsInFlight(false);
+  if (!iret)
+  {
+    iret = drainret;
+  }
+  // no input is read in the background once control is back in the macro
+  for (auto &syncman : SyncManagers)
+  {
+    syncman->FinishRunAhead();
+  }
   return iret;
 }
 
@@ -1783,6 +2162,21 @@ void Fun4AllServer::NodeIdentify(const std::string &name)
   return;
 }
 
+void Fun4AllServer::PrintNodeLookups() const
+{
+  std::cout << "Node tree lookups during process_event (" << eventcounter << " events):" << std::endl;
+  for (const auto &iter : m_NodeLookups)
+  {
+    std::cout << "  " << iter.first << ": " << iter.second;
+    if (eventcounter > 0)
+    {
+      std::cout << " (" << static_cast<double>(iter.second) / eventcounter << " per event)";
+    }
+    std::cout << std::endl;
+  }
+  return;
+}
+
 void Fun4AllServer::PrintTimer(const std::string &name)
 {
   std::map<const std::string, PHTimer>::const_iterator iter;
@@ -1833,3 +2227,26 @@ int Fun4AllServer::UpdateRunNode()
   }
   return iret;
 }
+
+void Fun4AllServer::SetNumThreads(const unsigned int nthreads)
+{
+  TaskScheduler()->SetNumThreads(nthreads);
+  if (Verbosity() > 0)
+  {
+    std::cout << "Fun4AllServer::SetNumThreads - using " << m_TaskScheduler->NumThreads() << " threads" << std::endl;
+  }
+}
+
+unsigned int Fun4AllServer::NumThreads()
+{
+  return TaskScheduler()->NumThreads();
+}
+
+Fun4AllTaskScheduler *Fun4AllServer::TaskScheduler()
+{
+  if (!m_TaskScheduler)
+  {
+    m_TaskScheduler = new Fun4AllTaskScheduler(1);
+  }
+  return m_TaskScheduler;
+}
@@ -9,17 +9,23 @@
 
 #include <phool/PHTimer.h>
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <deque>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <string>
 #include <utility>  // for pair
 #include <vector>
 
+class Fun4AllEventSlot;
 class Fun4AllInputManager;
 class Fun4AllMemoryTracker;
 class Fun4AllSyncManager;
 class Fun4AllOutputManager;
+class Fun4AllTaskScheduler;
 class PHCompositeNode;
 class PHTimeStamp;
 class SubsysReco;
@@ -111,6 +117,8 @@ class Fun4AllServer : public Fun4AllBase
   void NodeIdentify(const std::string &name);
   void KeepDBConnection(const int i = 1) { keep_db_connected = i; }
   void PrintTimer(const std::string &name = "");
+  //! number of node tree lookups (findNode::getClass) done by each module in process_event
+  void PrintNodeLookups() const;
   static void PrintMemoryTracker(const std::string &name = "");
   int RunNumber() const { return runnumber; }
   int EventCounter() const { return eventcounter; }
@@ -119,6 +127,30 @@ class Fun4AllServer : public Fun4AllBase
   int UpdateRunNode();
   void AddResetNodeName(const std::string &name) {ResetNodeList.emplace_back(name);}
 
+  /*!
+    \brief number of threads (core budget) shared by all modules of this job. 0 means one per hardware core.
+    The default is 1, no worker threads. The obsolete thread count setters of the modules which used
+    to start their own threads (PHSimpleKFProp::set_num_threads, Tpc_ModuleTrackReco::setMaxThreads,
+    CaloWaveformProcessing::set_nthreads) call this with a deprecation warning.
+    Modules which were parallel by default (TpcClusterizer, PHSimpleKFProp, Tpc_ModuleTrackReco)
+    run serially unless this or one of these setters is called.
+  */
+  void SetNumThreads(const unsigned int nthreads);
+  unsigned int NumThreads();
+  //! task scheduler to be used by modules for parallel work
+  Fun4AllTaskScheduler *TaskScheduler();
+
+  /*!
+    \brief number of events processed at the same time (default 1).
+    The first contiguous block of modules registered under TOP which declare SubsysReco::REENTRANT
+    runs on the task scheduler, each event on its own copy of the TOP event nodes (see Fun4AllEventSlot).
+    The modules before this block, the modules after it and the output managers run on the main
+    thread, in event order. Data under other top nodes is only available to the modules before the block.
+    Needs more than one thread (SetNumThreads), the effective number is set at BeginRun, see EventsInFlight()
+  */
+  void SetEventsInFlight(const unsigned int n) { m_RequestedEventsInFlight = std::max(1U, n); }
+  unsigned int EventsInFlight() const { return m_EventsInFlight; }
+
  protected:
   Fun4AllServer(const std::string &name = "Fun4AllServer");
   static int InitNodeTree(PHCompositeNode *topNode);
@@ -127,6 +159,17 @@ class Fun4AllServer : public Fun4AllBase
   int UpdateEventSelector(Fun4AllOutputManager *manager);
   int unregisterSubsystemsNow();
   int setRun(const int runno);
+  int RunSubsystems(const std::size_t begin, const std::size_t end, std::vector<int> &retcodes, int &eventbad);
+  int HandleReturnCode(const int retcode, const SubsysReco *subsystem, int &eventbad);
+  void WriteEvent(std::vector<int> &retcodes, const int eventbad);
+  void ResetEventSubsystems(const std::size_t begin, const std::size_t end);
+  void ResetEventNodes(PHCompositeNode *topnode);
+  void InitEventsInFlight();
+  int process_event_in_flight();
+  int FinishEventInFlight();
+  int DrainEventsInFlight(const bool keep_current_event);
+  struct EventInFlight;
+  static void RunReentrantSubsystems(EventInFlight &event);
   static Fun4AllServer *__instance;
   TH1 *FrameWorkVars{nullptr};
   Fun4AllMemoryTracker *ffamemtracker{nullptr};
@@ -134,6 +177,7 @@ class Fun4AllServer : public Fun4AllBase
   PHTimeStamp *beginruntimestamp{nullptr};
   PHCompositeNode *TopNode{nullptr};
   Fun4AllSyncManager *defaultSyncManager{nullptr};
+  Fun4AllTaskScheduler *m_TaskScheduler{nullptr};
 
   int OutNodeCount{0};
   int bortime_override{0};
@@ -143,6 +187,13 @@ class Fun4AllServer : public Fun4AllBase
   int eventnumber{0};
   int eventcounter{0};
   int keep_db_connected{0};
+  unsigned int m_RequestedEventsInFlight{1};
+  unsigned int m_EventsInFlight{1};
+  std::size_t m_ReentrantBegin{0};
+  std::size_t m_ReentrantEnd{0};
+  std::size_t m_NumSubsystemsInFlight{0};
+  int m_GoodEventsFinished{0};
+  bool m_DiscardEventsInFlight{false};
   
   std::ios m_saved_cout_state{nullptr};
   std::vector<std::string> ComplaintList;
@@ -158,7 +209,11 @@ class Fun4AllServer : public Fun4AllBase
   std::string default_Tdirectory = "Rint:/";
   std::vector<Fun4AllSyncManager *> SyncManagers;
   std::map<int, int> retcodesmap;
+  std::map<std::string, uint64_t> m_NodeLookups;
   std::map<const std::string, PHTimer> timer_map;
+  std::vector<std::unique_ptr<Fun4AllEventSlot>> m_EventSlots;
+  std::vector<Fun4AllEventSlot *> m_FreeEventSlots;
+  std::deque<std::unique_ptr<EventInFlight>> m_EventsInFlightQueue;
 };
 
 #endif
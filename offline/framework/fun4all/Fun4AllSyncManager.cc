@@ -461,6 +461,15 @@ void Fun4AllSyncManager::PushBackInputMgrsEvents(const int i)
   return;
 }
 
+void Fun4AllSyncManager::FinishRunAhead()
+{
+  for (Fun4AllInputManager *inman : m_InManager)
+  {
+    inman->FinishRunAhead();
+  }
+  return;
+}
+
 int Fun4AllSyncManager::ResetEvent()
 {
   int iret = 0;
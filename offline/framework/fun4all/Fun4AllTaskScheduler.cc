@@ -0,0 +1,268 @@
+#include "Fun4AllTaskScheduler.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+  // scheduler owning the current thread and index of the thread in it
+  thread_local const Fun4AllTaskScheduler *tl_scheduler = nullptr;
+  thread_local unsigned int tl_index = 0;
+}  // namespace
+
+Fun4AllTaskScheduler::Fun4AllTaskScheduler(unsigned int nthreads)
+{
+  SetNumThreads(nthreads);
+}
+
+Fun4AllTaskScheduler::~Fun4AllTaskScheduler()
+{
+  stop_workers();
+}
+
+void Fun4AllTaskScheduler::SetNumThreads(unsigned int nthreads)
+{
+  if (nthreads == 0)
+  {
+    nthreads = std::max(1U, std::thread::hardware_concurrency());
+  }
+  if (nthreads == m_Queues.size())
+  {
+    return;
+  }
+
+  stop_workers();
+  m_Queues.clear();
+  for (unsigned int i = 0; i < nthreads; ++i)
+  {
+    m_Queues.push_back(std::make_unique<Queue>());
+  }
+  start_workers();
+}
+
+unsigned int Fun4AllTaskScheduler::ThreadIndex() const
+{
+  return (tl_scheduler == this) ? tl_index : 0;
+}
+
+void Fun4AllTaskScheduler::start_workers()
+{
+  m_Stop = false;
+  // thread 0 is the calling thread
+  for (unsigned int i = 1; i < m_Queues.size(); ++i)
+  {
+    m_Workers.emplace_back(&Fun4AllTaskScheduler::worker_loop, this, i);
+  }
+}
+
+void Fun4AllTaskScheduler::stop_workers()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_SleepMutex);
+    m_Stop = true;
+  }
+  m_WakeUp.notify_all();
+  for (auto &worker : m_Workers)
+  {
+    worker.join();
+  }
+  m_Workers.clear();
+}
+
+void Fun4AllTaskScheduler::worker_loop(unsigned int index)
+{
+  tl_scheduler = this;
+  tl_index = index;
+
+  Task task;
+  while (true)
+  {
+    if (pop(task))
+    {
+      execute(task);
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(m_SleepMutex);
+    m_WakeUp.wait(lock, [this]
+                  { return m_Stop || m_NumQueued > 0; });
+    if (m_Stop)
+    {
+      return;
+    }
+  }
+}
+
+void Fun4AllTaskScheduler::push(Task &&task)
+{
+  auto &queue = *m_Queues[ThreadIndex()];
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.tasks.push_back(std::move(task));
+    ++m_NumQueued;
+  }
+
+  // taking the lock guarantees that a worker about to sleep sees the new task
+  {
+    std::lock_guard<std::mutex> lock(m_SleepMutex);
+  }
+  m_WakeUp.notify_one();
+}
+
+bool Fun4AllTaskScheduler::pop(Task &task)
+{
+  const unsigned int nqueues = m_Queues.size();
+  const unsigned int self = ThreadIndex();
+
+  // own queue first, most recent task, then steal the oldest task of the others
+  for (unsigned int i = 0; i < nqueues; ++i)
+  {
+    auto &queue = *m_Queues[(self + i) % nqueues];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+    {
+      continue;
+    }
+
+    if (i == 0)
+    {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+    }
+    else
+    {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+    }
+    --m_NumQueued;
+    return true;
+  }
+  return false;
+}
+
+void Fun4AllTaskScheduler::execute(Task &task)
+{
+  TaskGroup *group = task.group;
+  try
+  {
+    task.func();
+  }
+  catch (...)
+  {
+    group->set_exception(std::current_exception());
+  }
+  task.func = nullptr;
+  --group->m_Pending;
+}
+
+void Fun4AllTaskScheduler::parallel_for(std::size_t begin, std::size_t end, const index_task_t &func, std::size_t grain)
+{
+  if (end <= begin)
+  {
+    return;
+  }
+
+  const std::size_t size = end - begin;
+  if (m_Queues.size() == 1 || size == 1)
+  {
+    for (std::size_t i = begin; i < end; ++i)
+    {
+      func(i);
+    }
+    return;
+  }
+
+  if (grain == 0)
+  {
+    // about four chunks per thread, for load balancing
+    grain = std::max<std::size_t>(1, size / (4 * m_Queues.size()));
+  }
+
+  TaskGroup group(this);
+  for (std::size_t first = begin; first < end; first += grain)
+  {
+    const std::size_t last = std::min(end, first + grain);
+    group.run([&func, first, last]
+              {
+                for (std::size_t i = first; i < last; ++i)
+                {
+                  func(i);
+                }
+              });
+  }
+  group.wait();
+}
+
+//_________________________________________________________________
+Fun4AllTaskScheduler::TaskGroup::TaskGroup(Fun4AllTaskScheduler *scheduler)
+  : m_Scheduler(scheduler)
+{
+}
+
+Fun4AllTaskScheduler::TaskGroup::~TaskGroup()
+{
+  // make sure no task refers to this group anymore. Exceptions are dropped here
+  try
+  {
+    wait();
+  }
+  catch (...)
+  {
+  }
+}
+
+void Fun4AllTaskScheduler::TaskGroup::run(task_t task)
+{
+  // single thread: execute right away
+  if (m_Scheduler->NumThreads() == 1)
+  {
+    try
+    {
+      task();
+    }
+    catch (...)
+    {
+      set_exception(std::current_exception());
+    }
+    return;
+  }
+
+  ++m_Pending;
+  m_Scheduler->push({std::move(task), this});
+}
+
+void Fun4AllTaskScheduler::TaskGroup::wait()
+{
+  // help processing tasks while waiting
+  Task task;
+  while (m_Pending > 0)
+  {
+    if (m_Scheduler->pop(task))
+    {
+      execute(task);
+    }
+    else
+    {
+      std::this_thread::yield();
+    }
+  }
+
+  std::exception_ptr exception;
+  {
+    std::lock_guard<std::mutex> lock(m_ExceptionMutex);
+    std::swap(exception, m_Exception);
+  }
+  if (exception)
+  {
+    std::rethrow_exception(exception);
+  }
+}
+
+void Fun4AllTaskScheduler::TaskGroup::set_exception(std::exception_ptr exception)
+{
+  std::lock_guard<std::mutex> lock(m_ExceptionMutex);
+  if (!m_Exception)
+  {
+    m_Exception = std::move(exception);
+  }
+}
@@ -0,0 +1,124 @@
+// Tell emacs that this is a C++ source
+//  -*- C++ -*-.
+#ifndef FUN4ALL_FUN4ALLTASKSCHEDULER_H
+#define FUN4ALL_FUN4ALLTASKSCHEDULER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/** Work stealing task scheduler, shared by all modules of a job.
+ *
+ *  It is owned by the Fun4AllServer and its number of threads (the core
+ *  budget of the whole job) is set with Fun4AllServer::SetNumThreads().
+ *  Modules get it with Fun4AllServer::instance()->TaskScheduler()
+ *  and use either parallel_for() or a TaskGroup to submit work.
+ *  Each thread owns a task queue. Idle threads steal from the others,
+ *  and a thread waiting on a TaskGroup executes pending tasks meanwhile,
+ *  so task groups can be nested to build task graphs.
+ *
+ *  With one thread (the default) no worker thread is started and all
+ *  tasks are executed immediately on the calling thread.
+ */
+
+class Fun4AllTaskScheduler
+{
+ public:
+  using task_t = std::function<void()>;
+  using index_task_t = std::function<void(std::size_t)>;
+
+  //! nthreads is the total number of threads, including the calling thread. 0 means one per hardware core
+  explicit Fun4AllTaskScheduler(unsigned int nthreads = 1);
+  ~Fun4AllTaskScheduler();
+
+  // no copy
+  Fun4AllTaskScheduler(const Fun4AllTaskScheduler &) = delete;
+  Fun4AllTaskScheduler &operator=(const Fun4AllTaskScheduler &) = delete;
+
+  //! change number of threads. Must not be called while tasks are running
+  void SetNumThreads(unsigned int nthreads);
+  unsigned int NumThreads() const { return m_Queues.size(); }
+
+  /** index of the current thread in [0, NumThreads()).
+   *  0 is returned for any thread which is not a worker of this scheduler.
+   *  Useful to address per-thread buffers.
+   */
+  unsigned int ThreadIndex() const;
+
+  //! group of tasks which can be waited for
+  class TaskGroup
+  {
+   public:
+    explicit TaskGroup(Fun4AllTaskScheduler *scheduler);
+
+    //! waits for all pending tasks
+    ~TaskGroup();
+
+    // no copy
+    TaskGroup(const TaskGroup &) = delete;
+    TaskGroup &operator=(const TaskGroup &) = delete;
+
+    //! submit a task
+    void run(task_t task);
+
+    //! wait for all submitted tasks, rethrows the first exception thrown by any of them
+    void wait();
+
+   private:
+    friend class Fun4AllTaskScheduler;
+
+    void set_exception(std::exception_ptr exception);
+
+    Fun4AllTaskScheduler *m_Scheduler{nullptr};
+    std::atomic<std::size_t> m_Pending{0};
+    std::mutex m_ExceptionMutex;
+    std::exception_ptr m_Exception;
+  };
+
+  /** call func(i) for all i in [begin, end), blocks until all calls returned.
+   *  The range is cut in chunks of at least grain indices, by default
+   *  chosen so that every thread gets a few chunks
+   */
+  void parallel_for(std::size_t begin, std::size_t end, const index_task_t &func, std::size_t grain = 0);
+
+ private:
+  struct Task
+  {
+    task_t func;
+    TaskGroup *group{nullptr};
+  };
+
+  struct Queue
+  {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  void start_workers();
+  void stop_workers();
+  void worker_loop(unsigned int index);
+
+  void push(Task &&task);
+  bool pop(Task &task);
+  static void execute(Task &task);
+
+  //! one queue per thread. Queue 0 receives tasks submitted from non-worker threads
+  std::vector<std::unique_ptr<Queue>> m_Queues;
+  std::vector<std::thread> m_Workers;
+
+  //! number of queued tasks, used to put idle workers to sleep
+  std::atomic<std::size_t> m_NumQueued{0};
+
+  std::mutex m_SleepMutex;
+  std::condition_variable m_WakeUp;
+  bool m_Stop{false};
+};
+
+#endif
@@ -63,6 +63,18 @@ class SubsysReco : public Fun4AllBase
   /// For new rollover DSTs - we need to be able to update the Run Node before the End()
   virtual int UpdateRunNode(PHCompositeNode * /*topNode*/) { return 0; }
 
+  /// Capabilities a module can declare to the Fun4AllServer
+  enum Capability
+  {
+    /** process_event() does not modify the module state and gets its event nodes from its
+        topNode argument, it can run on several events at the same time
+        (see Fun4AllServer::SetEventsInFlight) */
+    REENTRANT = 0x1
+  };
+
+  /// true if the module declared the given capability
+  bool HasCapability(const Capability cap) const { return (m_Capabilities & cap); }
+
 protected:
   /** ctor.
       @param name is the reference used inside the Fun4AllServer
@@ -71,6 +83,12 @@ protected:
     : Fun4AllBase(name)
   {
   }
+
+  /// to be called by derived classes (typically in their ctor) to declare capabilities
+  void DeclareCapability(const Capability cap) { m_Capabilities |= cap; }
+
+ private:
+  unsigned int m_Capabilities{0};
 };
 
 #endif
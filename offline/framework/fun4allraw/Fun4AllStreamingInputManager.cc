@@ -6,6 +6,7 @@
 #include "SingleMicromegasPoolInput_v2.h"
 #include "SingleMvtxPoolInput.h"
 #include "SingleStreamingInput.h"
+#include "StreamingInputProducer.h"
 
 #include <ffarawobjects/Gl1Packet.h>
 #include <ffarawobjects/InttRawHit.h>
@@ -37,6 +38,7 @@
 
 #include <TH1.h>
 #include <TH2.h>
+#include <TROOT.h>
 #include <TSystem.h>
 
 #include <algorithm>  // for max
@@ -45,6 +47,7 @@
 #include <cstdlib>
 #include <format>
 #include <iostream>  // for operator<<, basic_ostream, endl
+#include <memory>
 #include <sstream>
 #include <utility>   // for pair
 
@@ -67,6 +70,12 @@ Fun4AllStreamingInputManager::~Fun4AllStreamingInputManager()
     fileclose();
   }
   delete m_SyncObject;
+  // stop the producers before deleting their inputs. Their staged hits are deleted with the maps
+  if (!m_Producers.empty())
+  {
+    WaitForProducers();
+    m_Producers.clear();
+  }
   // clear leftover raw event maps and vectors with poolreaders
   // GL1
   for (auto *iter : m_Gl1InputVector)
@@ -148,10 +157,30 @@ Fun4AllStreamingInputManager::~Fun4AllStreamingInputManager()
 int Fun4AllStreamingInputManager::run(const int /*nevents*/)
 {
   int iret = 0;
+  // hits decoded ahead while the previous event was processed
+  if (!m_Producers.empty())
+  {
+    iret = WaitForProducers();
+    if (iret < 0)
+    {
+      return iret;
+    }
+  }
   if (m_gl1_registered_flag)  // Gl1 first to get the reference
   {
     iret += FillGl1();
   }
+  // decode all inputs in parallel up to the reference, the FillXXXPool calls
+  // below then find their pools filled and only check the run numbers
+  if (!m_Producers.empty())
+  {
+    StartProducers();
+    const int status = WaitForProducers();
+    if (status < 0)
+    {
+      return status;
+    }
+  }
   if (m_intt_registered_flag)
   {
     iret += FillIntt();
@@ -170,6 +199,25 @@ int Fun4AllStreamingInputManager::run(const int /*nevents*/)
     iret += FillMicromegas();
   }
 
+  // the first event is built sequentially, so that the inputs make their database
+  // lookups and create their decoders on the main thread
+  if (m_ThreadedFill && m_Producers.empty())
+  {
+    // decoders met later (e.g. a new TPC packet id) create histograms in their thread
+    ROOT::EnableThreadSafety();
+    for (auto *inputs : {&m_InttInputVector, &m_MicromegasInputVector, &m_MvtxInputVector, &m_TpcInputVector})
+    {
+      for (auto *iter : *inputs)
+      {
+        m_Producers.push_back(std::make_unique<StreamingInputProducer>(iter));
+      }
+    }
+  }
+  if (m_ThreadedFillRunAhead && !m_Producers.empty() && iret == 0)
+  {
+    StartProducers();
+  }
+
   // std::cout << "size  m_InttRawHitMap: " <<  m_InttRawHitMap.size()
   // 	    << std::endl;
   return iret;
@@ -324,6 +372,16 @@ int Fun4AllStreamingInputManager::ResetEvent()
   return 0;
 }
 
+void Fun4AllStreamingInputManager::FinishRunAhead()
+{
+  // the staged hits go to the BCO buffers as if the next run() had waited,
+  // its WaitForProducers() then returns the same status without waiting
+  if (!m_Producers.empty())
+  {
+    WaitForProducers();
+  }
+}
+
 int Fun4AllStreamingInputManager::PushBackEvents(const int /*i*/)
 {
   return 0;
@@ -495,6 +553,12 @@ void Fun4AllStreamingInputManager::AddGl1RawHit(uint64_t bclk, Gl1Packet *hit)
 
 void Fun4AllStreamingInputManager::AddMvtxRawHit(uint64_t bclk, MvtxRawHit *hit)
 {
+  if (auto *producer = StreamingInputProducer::Current())
+  {
+    // decoded in a producer thread, moved to the map by WaitForProducers
+    producer->Staged().MvtxRawHits.emplace_back(bclk, hit);
+    return;
+  }
   if (Verbosity() > 1)
   {
     std::cout << "Adding mvtx hit to bclk 0x"
@@ -505,6 +569,11 @@ void Fun4AllStreamingInputManager::AddMvtxRawHit(uint64_t bclk, MvtxRawHit *hit)
 
 void Fun4AllStreamingInputManager::AddMvtxFeeIdInfo(uint64_t bclk, uint16_t feeid, uint32_t detField)
 {
+  if (auto *producer = StreamingInputProducer::Current())
+  {
+    producer->Staged().MvtxFeeIdInfos.emplace_back(bclk, feeid, detField);
+    return;
+  }
   if (Verbosity() > 1)
   {
     std::cout << "Adding mvtx feeid info to bclk 0x"
@@ -519,6 +588,11 @@ void Fun4AllStreamingInputManager::AddMvtxFeeIdInfo(uint64_t bclk, uint16_t feei
 
 void Fun4AllStreamingInputManager::AddMvtxL1TrgBco(uint64_t bclk, uint64_t lv1Bco)
 {
+  if (auto *producer = StreamingInputProducer::Current())
+  {
+    producer->Staged().MvtxL1TrgBcos.emplace_back(bclk, lv1Bco);
+    return;
+  }
   if (Verbosity() > 1)
   {
     std::cout << "Adding mvtx L1Trg to bclk 0x"
@@ -529,6 +603,11 @@ void Fun4AllStreamingInputManager::AddMvtxL1TrgBco(uint64_t bclk, uint64_t lv1Bc
 
 void Fun4AllStreamingInputManager::AddInttRawHit(uint64_t bclk, InttRawHit *hit)
 {
+  if (auto *producer = StreamingInputProducer::Current())
+  {
+    producer->Staged().InttRawHits.emplace_back(bclk, hit);
+    return;
+  }
   if (Verbosity() > 1)
   {
     std::cout << "Adding intt hit to bclk 0x"
@@ -540,6 +619,11 @@ void Fun4AllStreamingInputManager::AddInttRawHit(uint64_t bclk, InttRawHit *hit)
 
 void Fun4AllStreamingInputManager::AddMicromegasRawHit(uint64_t bclk, MicromegasRawHit *hit)
 {
+  if (auto *producer = StreamingInputProducer::Current())
+  {
+    producer->Staged().MicromegasRawHits.emplace_back(bclk, hit);
+    return;
+  }
   if (Verbosity() > 1)
   {
     std::cout << "Adding micromegas hit to bclk 0x"
@@ -550,6 +634,11 @@ void Fun4AllStreamingInputManager::AddMicromegasRawHit(uint64_t bclk, Micromegas
 
 void Fun4AllStreamingInputManager::AddTpcRawHit(uint64_t bclk, TpcRawHit *hit)
 {
+  if (auto *producer = StreamingInputProducer::Current())
+  {
+    producer->Staged().TpcRawHits.emplace_back(bclk, hit);
+    return;
+  }
   if (Verbosity() > 1)
   {
     std::cout << "Adding tpc hit to bclk 0x"
@@ -1571,6 +1660,77 @@ int Fun4AllStreamingInputManager::FillMvtxPool()
   }
   return 0;
 }
+void Fun4AllStreamingInputManager::StartProducers()
+{
+  // same minimum BCOs as in the FillXXXPool methods
+  const uint64_t intt_bco = m_RefBCO > m_intt_negative_bco ? m_RefBCO - m_intt_negative_bco : 0;
+  const uint64_t micromegas_bco = m_RefBCO > m_micromegas_negative_bco ? m_RefBCO - m_micromegas_negative_bco : 0;
+  const uint64_t mvtx_bco = m_RefBCO < m_mvtx_negative_bco ? m_mvtx_negative_bco : m_RefBCO - m_mvtx_negative_bco;
+  const uint64_t tpc_bco = m_RefBCO > m_tpc_negative_bco ? m_RefBCO - m_tpc_negative_bco : 0;
+
+  // producers are ordered as the input vectors
+  auto producer = m_Producers.begin();
+  for (auto *iter : m_InttInputVector)
+  {
+    if (!m_gl1_registered_flag)
+    {
+      iter->SetStandaloneMode(true);
+    }
+    (*producer++)->Start(intt_bco);
+  }
+  for (size_t i = 0; i < m_MicromegasInputVector.size(); ++i)
+  {
+    (*producer++)->Start(micromegas_bco);
+  }
+  for (size_t i = 0; i < m_MvtxInputVector.size(); ++i)
+  {
+    (*producer++)->Start(mvtx_bco);
+  }
+  for (size_t i = 0; i < m_TpcInputVector.size(); ++i)
+  {
+    (*producer++)->Start(tpc_bco);
+  }
+}
+
+int Fun4AllStreamingInputManager::WaitForProducers()
+{
+  int status = 0;
+  for (auto &producer : m_Producers)
+  {
+    producer->Wait();
+    status = std::min(status, producer->FillPoolStatus());
+
+    // on the main thread, the Add methods fill the maps
+    auto &staged = producer->Staged();
+    for (const auto &[bclk, hit] : staged.InttRawHits)
+    {
+      AddInttRawHit(bclk, hit);
+    }
+    for (const auto &[bclk, hit] : staged.MicromegasRawHits)
+    {
+      AddMicromegasRawHit(bclk, hit);
+    }
+    for (const auto &[bclk, hit] : staged.MvtxRawHits)
+    {
+      AddMvtxRawHit(bclk, hit);
+    }
+    for (const auto &[bclk, feeid, detField] : staged.MvtxFeeIdInfos)
+    {
+      AddMvtxFeeIdInfo(bclk, feeid, detField);
+    }
+    for (const auto &[bclk, lv1Bco] : staged.MvtxL1TrgBcos)
+    {
+      AddMvtxL1TrgBco(bclk, lv1Bco);
+    }
+    for (const auto &[bclk, hit] : staged.TpcRawHits)
+    {
+      AddTpcRawHit(bclk, hit);
+    }
+    staged.clear();
+  }
+  return status;
+}
+
 void Fun4AllStreamingInputManager::createQAHistos()
 {
   auto *hm = QAHistManagerDef::getHistoManager();
@@ -4,10 +4,12 @@
 #define FUN4ALLRAW_FUN4ALLSTREAMINGINPUTMANAGER_H
 
 #include "InputManagerType.h"
+#include "StreamingBcoBuffer.h"
 
 #include <fun4all/Fun4AllInputManager.h>
 
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
@@ -20,6 +22,7 @@ class MicromegasRawHit;
 class MvtxRawHit;
 class MvtxFeeIdInfo;
 class PHCompositeNode;
+class StreamingInputProducer;
 class SyncObject;
 class TpcRawHit;
 class TH1;
@@ -37,6 +40,8 @@ class Fun4AllStreamingInputManager : public Fun4AllInputManager
 
   void Print(const std::string &what = "ALL") const override;
   int ResetEvent() override;
+  //! waits for the fill started ahead by the last run(), so that the producers do not fill the QA histograms while they are saved
+  void FinishRunAhead() override;
   int PushBackEvents(const int i) override;
   int GetSyncObject(SyncObject **mastersync) override;
   int SyncIt(const SyncObject *mastersync) override;
@@ -69,6 +74,12 @@ class Fun4AllStreamingInputManager : public Fun4AllInputManager
   int FillTpcPool();
   void Streaming(bool b = true) { m_StreamingFlag = b; }
 
+  //! decode each streaming input (but the GL1) in its own thread, the BCO matching stays on the main thread
+  void SetThreadedFill(bool b = true) { m_ThreadedFill = b; }
+
+  //! with threaded fill, decode the next crossings while the current event is processed downstream
+  void SetThreadedFillRunAhead(bool b = true) { m_ThreadedFillRunAhead = b; }
+
   void runMvtxTriggered(bool b = true) { m_mvtx_is_triggered = b; }
 
   // configuration for INTT hit carry-over issue mitigation (hit duplication)
@@ -89,34 +100,73 @@ class Fun4AllStreamingInputManager : public Fun4AllInputManager
     std::vector<MvtxFeeIdInfo *> MvtxFeeIdInfoVector;
     std::vector<MvtxRawHit *> MvtxRawHitVector;
     unsigned int EventFoundCounter{0};
+
+    //! reset, keeping the vector storage for reuse by the next BCO in StreamingBcoBuffer
+    void clear()
+    {
+      MvtxL1TrgBco.clear();
+      MvtxFeeIdInfoVector.clear();
+      MvtxRawHitVector.clear();
+      EventFoundCounter = 0;
+    }
   };
 
   struct Gl1RawHitInfo
   {
     std::vector<Gl1Packet *> Gl1RawHitVector;
     unsigned int EventFoundCounter{0};
+
+    void clear()
+    {
+      Gl1RawHitVector.clear();
+      EventFoundCounter = 0;
+    }
   };
 
   struct InttRawHitInfo
   {
     std::vector<InttRawHit *> InttRawHitVector;
     unsigned int EventFoundCounter{0};
+
+    void clear()
+    {
+      InttRawHitVector.clear();
+      EventFoundCounter = 0;
+    }
   };
 
   struct MicromegasRawHitInfo
   {
     std::vector<MicromegasRawHit *> MicromegasRawHitVector;
     unsigned int EventFoundCounter{0};
+
+    void clear()
+    {
+      MicromegasRawHitVector.clear();
+      EventFoundCounter = 0;
+    }
   };
 
   struct TpcRawHitInfo
   {
     std::vector<TpcRawHit *> TpcRawHitVector;
     unsigned int EventFoundCounter{0};
+
+    void clear()
+    {
+      TpcRawHitVector.clear();
+      EventFoundCounter = 0;
+    }
   };
 
   void createQAHistos();
 
+  //! start the producers of all inputs, with the minimum BCO of each subsystem for the current reference
+  void StartProducers();
+
+  //! wait for all producers and move their staged hits to the BCO buffers. Returns the lowest FillPoolStatus
+  int WaitForProducers();
+
   SyncObject *m_SyncObject{nullptr};
   PHCompositeNode *m_topNode{nullptr};
 
@@ -139,19 +189,24 @@ class Fun4AllStreamingInputManager : public Fun4AllInputManager
   bool m_StreamingFlag{false};
   bool m_tpc_registered_flag{false};
   bool m_mvtx_is_triggered{false};
+  bool m_ThreadedFill{false};
+  bool m_ThreadedFillRunAhead{false};
 
   std::vector<SingleStreamingInput *> m_Gl1InputVector;
   std::vector<SingleStreamingInput *> m_InttInputVector;
   std::vector<SingleStreamingInput *> m_MicromegasInputVector;
   std::vector<SingleStreamingInput *> m_MvtxInputVector;
   std::vector<SingleStreamingInput *> m_TpcInputVector;
-  std::map<uint64_t, Gl1RawHitInfo> m_Gl1RawHitMap;
-  std::map<uint64_t, InttRawHitInfo> m_InttRawHitMap;
-  std::map<uint64_t, MicromegasRawHitInfo> m_MicromegasRawHitMap;
-  std::map<uint64_t, MvtxRawHitInfo> m_MvtxRawHitMap;
-  std::map<uint64_t, TpcRawHitInfo> m_TpcRawHitMap;
+  StreamingBcoBuffer<Gl1RawHitInfo> m_Gl1RawHitMap;
+  StreamingBcoBuffer<InttRawHitInfo> m_InttRawHitMap;
+  StreamingBcoBuffer<MicromegasRawHitInfo> m_MicromegasRawHitMap;
+  StreamingBcoBuffer<MvtxRawHitInfo> m_MvtxRawHitMap;
+  StreamingBcoBuffer<TpcRawHitInfo> m_TpcRawHitMap;
   std::map<int, std::map<int, uint64_t>> m_InttPacketFeeBcoMap;
 
+  //! one per INTT, Micromegas, MVTX and TPC input, in this order. Created after the first event
+  std::vector<std::unique_ptr<StreamingInputProducer>> m_Producers;
+
   // QA histos
   TH1 *h_refbco_mvtx[12]{nullptr};
   TH1 *h_taggedAllFelixes_mvtx{nullptr};
@@ -221,8 +221,8 @@ void SingleGl1PoolInput::CleanupUsedPackets(const uint64_t bclk)
   {
     m_FEEBclkMap.erase(iter);
     m_BclkStack.erase(iter);
-    m_Gl1RawHitMap.erase(iter);
   }
+  m_Gl1RawHitMap.erase(m_Gl1RawHitMap.begin(), m_Gl1RawHitMap.upper_bound(bclk));
 }
 
 bool SingleGl1PoolInput::CheckPoolDepth(const uint64_t bclk)
@@ -2,6 +2,7 @@
 #define FUN4ALLRAW_SINGLEINTTPOOLINPUT_H
 
 #include "SingleStreamingInput.h"
+#include "StreamingBcoBuffer.h"
 
 #include <array>
 #include <cstdint>  // for uint64_t
@@ -57,7 +58,7 @@ class SingleInttPoolInput : public SingleStreamingInput
   std::array<uint64_t, 14> m_PreviousClock{};
   std::array<uint64_t, 14> m_Rollover{};
   std::map<uint64_t, std::set<int>> m_BeamClockFEE;
-  std::map<uint64_t, std::vector<InttRawHit *>> m_InttRawHitMap;
+  StreamingBcoBuffer<std::vector<InttRawHit *>> m_InttRawHitMap;
   std::map<int, uint64_t> m_FEEBclkMap;
   std::set<uint64_t> m_BclkStack;
 
@@ -3,6 +3,7 @@
 
 #include "MicromegasBcoMatchingInformation_v1.h"
 #include "SingleStreamingInput.h"
+#include "StreamingBcoBuffer.h"
 
 #include <phool/PHTimer.h>
 
@@ -73,7 +74,7 @@ class SingleMicromegasPoolInput_v1 : public SingleStreamingInput
   std::map<uint64_t, std::set<int>> m_BeamClockFEE;
 
   //! store list of raw hits matching a given bco
-  std::map<uint64_t, std::vector<MicromegasRawHit *>> m_MicromegasRawHitMap;
+  StreamingBcoBuffer<std::vector<MicromegasRawHit *>> m_MicromegasRawHitMap;
 
   //! store current list of BCO on a per fee basis.
   /** only packets for which a given FEE have data are stored */
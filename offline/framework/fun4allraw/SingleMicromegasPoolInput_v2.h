@@ -3,6 +3,7 @@
 
 #include "MicromegasBcoMatchingInformation_v2.h"
 #include "SingleStreamingInput.h"
+#include "StreamingBcoBuffer.h"
 
 #include <phool/PHTimer.h>
 
@@ -157,7 +158,7 @@ class SingleMicromegasPoolInput_v2 : public SingleStreamingInput
   using rawhit_list_t = std::vector<MicromegasRawHit*>;
 
   /// maps list of raw hits on GTM BCO values
-  using rawhit_map_t = std::map<uint64_t, rawhit_list_t>;
+  using rawhit_map_t = StreamingBcoBuffer<rawhit_list_t>;
 
   /// store list of raw hits matching a given GTM bco on a per FEE basis
   std::array<rawhit_map_t,MAX_FEECOUNT> m_MicromegasRawHitMap{};
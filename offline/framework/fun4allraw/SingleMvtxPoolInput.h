@@ -2,6 +2,7 @@
 #define FUN4ALLRAW_SINGLEMVTXPOOLINPUT_H
 
 #include "SingleStreamingInput.h"
+#include "StreamingBcoBuffer.h"
 
 #include <algorithm>
 #include <map>
@@ -45,7 +46,7 @@ class SingleMvtxPoolInput : public SingleStreamingInput
   unsigned int m_NegativeBco{0};
   std::string m_rawEventHeaderName = "MVTXRAWEVTHEADER";
 
-  std::map<uint64_t, std::vector<MvtxRawHit *>> m_MvtxRawHitMap;
+  StreamingBcoBuffer<std::vector<MvtxRawHit *>> m_MvtxRawHitMap;
   std::map<int, uint64_t> m_FEEBclkMap;
   std::map<int, uint64_t> m_FeeStrobeMap;
   std::set<uint64_t> m_BclkStack;
@@ -9,6 +9,7 @@
 
 #include <cstdint>   // for uint64_t
 #include <iostream>  // for operator<<, basic_ostream, endl
+#include <mutex>
 #include <set>
 #include <utility>  // for pair
 
@@ -33,7 +34,13 @@ int SingleStreamingInput::fileopen(const std::string &filenam)
     fileclose();
   }
   FileName(filenam);
-  std::string fname = DBInterface::instance()->location(FileName());
+  std::string fname;
+  {
+    // inputs of the streaming input manager may open files from producer threads
+    static std::mutex location_mutex;
+    std::lock_guard<std::mutex> lock(location_mutex);
+    fname = DBInterface::instance()->location(FileName());
+  }
   if (Verbosity() > 0)
   {
     std::cout << Name() << ": opening file " << FileName() << std::endl;
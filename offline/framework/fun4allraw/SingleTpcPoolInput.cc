@@ -18,6 +18,7 @@
 #include <Event/Eventiterator.h>
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
 #include <set>
 
@@ -167,7 +168,7 @@ void SingleTpcPoolInput::FillPool(const uint64_t minBCO)
       else
       {
         int m_nWaveFormInFrame = packet->iValue(0, "NR_WF");
-        static int once = 0;
+        static std::atomic<int> once{0};
         for (int wf = 0; wf < m_nWaveFormInFrame; wf++)
         {
           if (m_TpcRawHitMap[gtm_bco].size() > 20000)
@@ -350,8 +351,8 @@ void SingleTpcPoolInput::CleanupUsedPackets(const uint64_t bclk)
   {
     m_BclkStack.erase(iter);
     m_BeamClockFEE.erase(iter);
-    m_TpcRawHitMap.erase(iter);
   }
+  m_TpcRawHitMap.erase(m_TpcRawHitMap.begin(), m_TpcRawHitMap.upper_bound(bclk));
 }
 
 bool SingleTpcPoolInput::CheckPoolDepth(const uint64_t bclk)
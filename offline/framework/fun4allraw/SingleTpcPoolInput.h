@@ -2,6 +2,7 @@
 #define FUN4ALLRAW_SINGLETPCPOOLINPUT_H
 
 #include "SingleStreamingInput.h"
+#include "StreamingBcoBuffer.h"
 
 #include <array>
 #include <list>
@@ -42,7 +43,7 @@ class SingleTpcPoolInput : public SingleStreamingInput
   std::map<unsigned int, uint64_t> m_packet_bco;
 
   std::map<uint64_t, std::set<int>> m_BeamClockFEE;
-  std::map<uint64_t, std::vector<TpcRawHit *>> m_TpcRawHitMap;
+  StreamingBcoBuffer<std::vector<TpcRawHit *>> m_TpcRawHitMap;
   std::map<int, uint64_t> m_FEEBclkMap;
   std::set<uint64_t> m_BclkStack;
 };
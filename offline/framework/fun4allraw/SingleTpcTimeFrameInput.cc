@@ -32,9 +32,19 @@
 #include <Event/Eventiterator.h>
 #include <Event/fileEventiterator.h>
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <set>
 
+namespace
+{
+  // with threaded filling each input decodes in its own thread. The builders book
+  // their histograms in the global QA histogram manager and read the bad FEE map
+  // from the conditions DB, so they are created one at a time
+  std::mutex builder_mutex;
+}  // namespace
+
 SingleTpcTimeFrameInput::SingleTpcTimeFrameInput(const std::string &name)
   : SingleStreamingInput(name)
   , plist(new Packet *[NTPCPACKETS])
@@ -118,10 +128,9 @@ void SingleTpcTimeFrameInput::FillPool(const uint64_t targetBCO)
 {
   m_FillPoolStatus = Fun4AllReturnCodes::EVENT_OK;
   {
-    static bool first = true;
-    if (first)
+    static std::atomic<bool> first{true};
+    if (first.exchange(false))
     {
-      first = false;
 
       if (!m_SelectedPacketIDs.empty())
       {
@@ -318,6 +327,7 @@ void SingleTpcTimeFrameInput::FillPool(const uint64_t targetBCO)
 
       if (!m_TpcTimeFrameBuilderMap.contains(packet_id))
       {
+        std::lock_guard<std::mutex> lock(builder_mutex);
         TpcTimeFrameBuilderBase *builder = nullptr;
         if (hit_format == IDTPCFEEV4)
         {
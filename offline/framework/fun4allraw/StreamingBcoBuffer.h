@@ -0,0 +1,332 @@
+// Tell emacs that this is a C++ source
+//  -*- C++ -*-.
+#ifndef FUN4ALLRAW_STREAMINGBCOBUFFER_H
+#define FUN4ALLRAW_STREAMINGBCOBUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+//! time ordered buffer of per beam clock buckets, used to align streaming inputs
+/**
+ * Replaces the std::map<uint64_t, T> used to stage raw hits by BCO, with the same
+ * interface for what the streaming inputs need (operator[], find, bounds, erase, iteration).
+ *
+ * Buckets are stored sorted by BCO in a ring of contiguous slots. Streaming data come
+ * (almost) in BCO order, so that new buckets are appended at the end, and used buckets
+ * are erased from the front, both in constant time and without node allocation.
+ * Erased slots are emptied with T::clear() but keep their storage, so that the hit
+ * vectors of old BCOs are reused by new ones rather than reallocated.
+ * Lookup is a binary search. A BCO older than the last one is inserted by moving the
+ * later buckets by one slot, which only happens for the few out of order packets.
+ *
+ * As for the map, hits in a bucket are owned by the caller and must be deleted before erasing.
+ */
+template <class T>
+class StreamingBcoBuffer
+{
+ public:
+  using key_type = uint64_t;
+  using mapped_type = T;
+  using value_type = std::pair<uint64_t, T>;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+
+  //! random access iterator on buckets, in BCO order
+  template <bool is_const>
+  class Iterator
+  {
+   public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = StreamingBcoBuffer::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<is_const, const value_type *, value_type *>;
+    using reference = std::conditional_t<is_const, const value_type &, value_type &>;
+    using buffer_pointer = std::conditional_t<is_const, const StreamingBcoBuffer *, StreamingBcoBuffer *>;
+
+    Iterator() = default;
+    Iterator(buffer_pointer buffer, size_type index)
+      : m_buffer(buffer)
+      , m_index(index)
+    {
+    }
+
+    //! conversion to const iterator
+    operator Iterator<true>() const { return Iterator<true>(m_buffer, m_index); }
+
+    reference operator*() const { return m_buffer->slot(m_index); }
+    pointer operator->() const { return &m_buffer->slot(m_index); }
+    reference operator[](difference_type n) const { return m_buffer->slot(m_index + n); }
+
+    Iterator &operator++()
+    {
+      ++m_index;
+      return *this;
+    }
+    Iterator operator++(int)
+    {
+      Iterator out(*this);
+      ++m_index;
+      return out;
+    }
+    Iterator &operator--()
+    {
+      --m_index;
+      return *this;
+    }
+    Iterator operator--(int)
+    {
+      Iterator out(*this);
+      --m_index;
+      return out;
+    }
+    Iterator &operator+=(difference_type n)
+    {
+      m_index += n;
+      return *this;
+    }
+    Iterator &operator-=(difference_type n)
+    {
+      m_index -= n;
+      return *this;
+    }
+    Iterator operator+(difference_type n) const { return Iterator(m_buffer, m_index + n); }
+    Iterator operator-(difference_type n) const { return Iterator(m_buffer, m_index - n); }
+    difference_type operator-(const Iterator &other) const { return difference_type(m_index) - difference_type(other.m_index); }
+
+    bool operator==(const Iterator &other) const { return m_index == other.m_index; }
+    bool operator!=(const Iterator &other) const { return m_index != other.m_index; }
+    bool operator<(const Iterator &other) const { return m_index < other.m_index; }
+    bool operator>(const Iterator &other) const { return m_index > other.m_index; }
+    bool operator<=(const Iterator &other) const { return m_index <= other.m_index; }
+    bool operator>=(const Iterator &other) const { return m_index >= other.m_index; }
+
+    //! position of the bucket, from the oldest one
+    size_type index() const { return m_index; }
+
+   private:
+    buffer_pointer m_buffer = nullptr;
+    size_type m_index = 0;
+  };
+
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  //!@name accessors
+  //@{
+  bool empty() const { return m_size == 0; }
+  size_type size() const { return m_size; }
+
+  //! number of allocated slots
+  size_type capacity() const { return m_slots.size(); }
+
+  iterator begin() { return iterator(this, 0); }
+  iterator end() { return iterator(this, m_size); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, m_size); }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+  const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+  const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+  //! first bucket with bco not less than the argument
+  iterator lower_bound(uint64_t bco) { return iterator(this, lower_index(bco)); }
+  const_iterator lower_bound(uint64_t bco) const { return const_iterator(this, lower_index(bco)); }
+
+  //! first bucket with bco greater than the argument
+  iterator upper_bound(uint64_t bco) { return iterator(this, upper_index(bco)); }
+  const_iterator upper_bound(uint64_t bco) const { return const_iterator(this, upper_index(bco)); }
+
+  iterator find(uint64_t bco)
+  {
+    const size_type index = lower_index(bco);
+    return (index < m_size && slot(index).first == bco) ? iterator(this, index) : end();
+  }
+
+  const_iterator find(uint64_t bco) const
+  {
+    const size_type index = lower_index(bco);
+    return (index < m_size && slot(index).first == bco) ? const_iterator(this, index) : end();
+  }
+
+  bool contains(uint64_t bco) const { return find(bco) != end(); }
+  //@}
+
+  //!@name modifiers
+  //@{
+
+  //! bucket for a given bco, created if needed
+  T &operator[](uint64_t bco)
+  {
+    // usual case: bco is the last or a new one
+    if (m_size > 0 && slot(m_size - 1).first == bco)
+    {
+      return slot(m_size - 1).second;
+    }
+
+    if (m_size == 0 || slot(m_size - 1).first < bco)
+    {
+      return append(bco).second;
+    }
+
+    // out of order bco
+    const size_type index = lower_index(bco);
+    if (slot(index).first == bco)
+    {
+      return slot(index).second;
+    }
+
+    // append, and move down to its position
+    append(bco);
+    for (size_type i = m_size - 1; i > index; --i)
+    {
+      std::swap(slot(i), slot(i - 1));
+    }
+    return slot(index).second;
+  }
+
+  //! erase a range of buckets, in constant time per bucket when starting from the oldest one
+  iterator erase(const_iterator first, const_iterator last)
+  {
+    const size_type index = first.index();
+    const size_type count = last.index() - index;
+    if (count == 0)
+    {
+      return iterator(this, index);
+    }
+
+    if (index > 0)
+    {
+      // move later buckets down, erased ones end up at the back
+      for (size_type i = index; i + count < m_size; ++i)
+      {
+        std::swap(slot(i), slot(i + count));
+      }
+      for (size_type i = m_size - count; i < m_size; ++i)
+      {
+        slot(i).second.clear();
+      }
+      m_size -= count;
+      return iterator(this, index);
+    }
+
+    for (size_type i = 0; i < count; ++i)
+    {
+      slot(i).second.clear();
+    }
+    m_head = (m_head + count) & (m_slots.size() - 1);
+    m_size -= count;
+    if (m_size == 0)
+    {
+      m_head = 0;
+    }
+    return begin();
+  }
+
+  iterator erase(const_iterator position) { return erase(position, position + 1); }
+  iterator erase(iterator position) { return erase(const_iterator(position), const_iterator(position) + 1); }
+
+  size_type erase(uint64_t bco)
+  {
+    const auto iter = find(bco);
+    if (iter == end())
+    {
+      return 0;
+    }
+    erase(iter);
+    return 1;
+  }
+
+  void clear() { erase(begin(), end()); }
+
+  //@}
+
+ private:
+  value_type &slot(size_type index) { return m_slots[(m_head + index) & (m_slots.size() - 1)]; }
+  const value_type &slot(size_type index) const { return m_slots[(m_head + index) & (m_slots.size() - 1)]; }
+
+  size_type lower_index(uint64_t bco) const
+  {
+    size_type first = 0;
+    size_type count = m_size;
+    while (count > 0)
+    {
+      const size_type step = count / 2;
+      if (slot(first + step).first < bco)
+      {
+        first += step + 1;
+        count -= step + 1;
+      }
+      else
+      {
+        count = step;
+      }
+    }
+    return first;
+  }
+
+  size_type upper_index(uint64_t bco) const
+  {
+    size_type first = 0;
+    size_type count = m_size;
+    while (count > 0)
+    {
+      const size_type step = count / 2;
+      if (!(bco < slot(first + step).first))
+      {
+        first += step + 1;
+        count -= step + 1;
+      }
+      else
+      {
+        count = step;
+      }
+    }
+    return first;
+  }
+
+  //! new bucket after the last one, reusing the storage of the slot
+  value_type &append(uint64_t bco)
+  {
+    if (m_size == m_slots.size())
+    {
+      grow();
+    }
+    value_type &out = slot(m_size++);
+    out.first = bco;
+    return out;
+  }
+
+  //! double the number of slots. The ring is unrolled so that the oldest bucket comes first
+  void grow()
+  {
+    std::vector<value_type> slots(m_slots.empty() ? kMinSlots : 2 * m_slots.size());
+    for (size_type i = 0; i < m_slots.size(); ++i)
+    {
+      std::swap(slots[i], slot(i));
+    }
+    m_slots.swap(slots);
+    m_head = 0;
+  }
+
+  //! initial number of slots, must be a power of two
+  static constexpr size_type kMinSlots = 16;
+
+  //! bucket storage. Size is a power of two, and slots outside of the live range are empty
+  std::vector<value_type> m_slots;
+
+  //! slot of the oldest bucket
+  size_type m_head = 0;
+
+  //! number of buckets
+  size_type m_size = 0;
+};
+
+#endif
@@ -0,0 +1,215 @@
+/**
+ * @file fun4allraw/StreamingBcoBufferBenchmark.cc
+ * @brief compare std::map and StreamingBcoBuffer for staging streaming raw hits by BCO
+ *
+ * usage: StreamingBcoBufferBenchmark [pool dump] [window]
+ *
+ * Without argument, a synthetic stream is generated: MVTX like strobes every 100 BCOs,
+ * with a few percent of out of order packets, and a variable number of hits per strobe.
+ * With a file, the BCOs and number of hits are replayed from the output of the pool
+ * inputs Print("STORAGE"), where each "Beam clock 0x..." line starts a new BCO, followed
+ * by one line per hit.
+ * Hits are added as they come, and BCOs older than the last one by more than window
+ * are cleaned up, as the streaming input manager does. Both containers must hold
+ * identical content at each cleanup.
+ */
+#include "StreamingBcoBuffer.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <new>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+  // heap allocation counters, disabled while checking content
+  bool count_allocations = true;
+  std::size_t n_allocations = 0;
+  std::size_t allocated_bytes = 0;
+
+  struct Result
+  {
+    double time = 0;
+    std::size_t allocations = 0;
+    std::size_t bytes = 0;
+  };
+
+  struct RawHit
+  {
+    uint64_t bco = 0;
+    uint16_t fee = 0;
+    uint16_t channel = 0;
+  };
+
+  // one BCO of the stream, with its number of hits
+  using Record = std::pair<uint64_t, unsigned int>;
+
+  std::vector<Record> generate()
+  {
+    std::vector<Record> records;
+    std::mt19937_64 rng(12345);
+    std::poisson_distribution<unsigned int> nhits(200);
+    std::uniform_real_distribution<double> uniform(0, 1);
+    uint64_t bco = 0x100000;
+    for (int i = 0; i < 200000; ++i)
+    {
+      bco += 100;
+      // a few packets come late
+      const uint64_t packet_bco = (uniform(rng) < 0.03) ? bco - 100 * (1 + rng() % 4) : bco;
+      records.emplace_back(packet_bco, nhits(rng));
+    }
+    return records;
+  }
+
+  std::vector<Record> read(const std::string& filename)
+  {
+    std::vector<Record> records;
+    std::ifstream in(filename);
+    if (!in)
+    {
+      std::cout << "StreamingBcoBufferBenchmark - cannot open " << filename << std::endl;
+      exit(1);
+    }
+
+    std::string line;
+    while (std::getline(in, line))
+    {
+      const auto position = line.find("Beam clock 0x");
+      if (position != std::string::npos)
+      {
+        records.emplace_back(std::stoull(line.substr(position + 13), nullptr, 16), 0);
+      }
+      else if (!records.empty())
+      {
+        ++records.back().second;
+      }
+    }
+    return records;
+  }
+
+  template <class Container>
+  void fill(Container& container, const Record& record)
+  {
+    auto& hits = container[record.first];
+    for (unsigned int i = 0; i < record.second; ++i)
+    {
+      hits.push_back(new RawHit{record.first, static_cast<uint16_t>(i % 26), static_cast<uint16_t>(i % 256)});
+    }
+  }
+
+  template <class Container>
+  void cleanup(Container& container, uint64_t bco)
+  {
+    for (auto it = container.begin(); it != container.end() && (it->first <= bco); it = container.erase(it))
+    {
+      for (const auto* hit : it->second)
+      {
+        delete hit;
+      }
+    }
+  }
+
+  template <class Container>
+  Result run(Container& container, const std::vector<Record>& records, uint64_t window, std::vector<std::vector<uint64_t>>& snapshots)
+  {
+    const std::size_t allocations_start = n_allocations;
+    const std::size_t bytes_start = allocated_bytes;
+    const auto start = std::chrono::high_resolution_clock::now();
+    uint64_t last_bco = 0;
+    for (const auto& record : records)
+    {
+      fill(container, record);
+      last_bco = std::max(last_bco, record.first);
+      if (last_bco > window && container.begin()->first + 2 * window < last_bco)
+      {
+        cleanup(container, last_bco - window);
+        // keys and hit counts, to check that both containers agree
+        count_allocations = false;
+        std::vector<uint64_t> snapshot;
+        for (const auto& [bco, hits] : container)
+        {
+          snapshot.push_back(bco);
+          snapshot.push_back(hits.size());
+        }
+        snapshots.push_back(std::move(snapshot));
+        count_allocations = true;
+      }
+    }
+    cleanup(container, last_bco);
+    const double time = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    return {time, n_allocations - allocations_start, allocated_bytes - bytes_start};
+  }
+}  // namespace
+
+// count heap allocations. Memory comes from malloc, gcc cannot see that delete matches
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+void* operator new(std::size_t size)
+{
+  if (count_allocations)
+  {
+    ++n_allocations;
+    allocated_bytes += size;
+  }
+  if (void* p = std::malloc(size))
+  {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t /*size*/) noexcept
+{
+  std::free(p);
+}
+
+int main(int argc, char** argv)
+{
+  const auto records = (argc > 1) ? read(argv[1]) : generate();
+  const uint64_t window = (argc > 2) ? std::stoull(argv[2]) : 1000;
+
+  std::size_t nhits = 0;
+  for (const auto& record : records)
+  {
+    nhits += record.second;
+  }
+  std::cout << "StreamingBcoBufferBenchmark - " << records.size() << " BCOs, " << nhits << " hits, window " << window << std::endl;
+
+  std::vector<std::vector<uint64_t>> map_snapshots;
+  std::vector<std::vector<uint64_t>> buffer_snapshots;
+
+  // hit objects are allocated the same way for both, only container allocations differ
+  std::map<uint64_t, std::vector<RawHit*>> map;
+  const auto map_result = run(map, records, window, map_snapshots);
+
+  StreamingBcoBuffer<std::vector<RawHit*>> buffer;
+  const auto buffer_result = run(buffer, records, window, buffer_snapshots);
+
+  const auto print = [nhits](const std::string& name, const Result& result)
+  {
+    std::cout << name << result.time << " ms, " << result.allocations - nhits << " container allocations, "
+              << (result.bytes - nhits * sizeof(RawHit)) / (1024 * 1024) << " MB allocated by containers" << std::endl;
+  };
+  print("std::map:           ", map_result);
+  print("StreamingBcoBuffer: ", buffer_result);
+  std::cout << "speedup " << map_result.time / buffer_result.time << ", " << buffer.capacity() << " slots" << std::endl;
+
+  if (map_snapshots != buffer_snapshots)
+  {
+    std::cout << "StreamingBcoBufferBenchmark - content differs" << std::endl;
+    return 1;
+  }
+  return 0;
+}
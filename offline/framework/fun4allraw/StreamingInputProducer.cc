@@ -0,0 +1,92 @@
+#include "StreamingInputProducer.h"
+
+#include "SingleStreamingInput.h"
+
+namespace
+{
+  // producer of the current thread
+  thread_local StreamingInputProducer *current_producer = nullptr;
+}  // namespace
+
+void StreamingInputProducer::StagedHits::clear()
+{
+  InttRawHits.clear();
+  MicromegasRawHits.clear();
+  MvtxRawHits.clear();
+  MvtxFeeIdInfos.clear();
+  MvtxL1TrgBcos.clear();
+  TpcRawHits.clear();
+}
+
+StreamingInputProducer::StreamingInputProducer(SingleStreamingInput *input)
+  : m_Input(input)
+  , m_Thread(&StreamingInputProducer::Loop, this)
+{
+}
+
+StreamingInputProducer::~StreamingInputProducer()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Stop = true;
+  }
+  m_Condition.notify_all();
+  m_Thread.join();
+}
+
+StreamingInputProducer *StreamingInputProducer::Current()
+{
+  return current_producer;
+}
+
+void StreamingInputProducer::Start(const uint64_t minbco)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_MinBco = minbco;
+    m_Busy = true;
+  }
+  m_Condition.notify_all();
+}
+
+void StreamingInputProducer::Wait()
+{
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  m_Condition.wait(lock, [this]
+                   { return !m_Busy; });
+  if (m_Exception)
+  {
+    std::rethrow_exception(std::exchange(m_Exception, nullptr));
+  }
+}
+
+void StreamingInputProducer::Loop()
+{
+  current_producer = this;
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  while (true)
+  {
+    // a pending fill is done before stopping
+    m_Condition.wait(lock, [this]
+                     { return m_Busy || m_Stop; });
+    if (!m_Busy)
+    {
+      return;
+    }
+
+    const uint64_t minbco = m_MinBco;
+    lock.unlock();
+    try
+    {
+      m_Input->FillPool(minbco);
+      m_FillPoolStatus = m_Input->FillPoolStatus();
+    }
+    catch (...)
+    {
+      m_Exception = std::current_exception();
+    }
+    lock.lock();
+    m_Busy = false;
+    m_Condition.notify_all();
+  }
+}
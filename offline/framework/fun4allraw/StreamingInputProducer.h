@@ -0,0 +1,93 @@
+// Tell emacs that this is a C++ source
+//  -*- C++ -*-.
+#ifndef FUN4ALLRAW_STREAMINGINPUTPRODUCER_H
+#define FUN4ALLRAW_STREAMINGINPUTPRODUCER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+class InttRawHit;
+class MicromegasRawHit;
+class MvtxRawHit;
+class SingleStreamingInput;
+class TpcRawHit;
+
+//! decodes one streaming input in its own thread, for the Fun4AllStreamingInputManager
+/**
+ * The manager starts all producers with the minimum BCO of the current reference.
+ * Each one calls FillPool() of its input and then sleeps until it is started again,
+ * so that an input is only used by its producer while a fill is running, and by the
+ * manager (BCO matching, cleanup of used packets) once it has waited for it.
+ *
+ * Raw hits which the input hands over to the manager during the fill are staged here,
+ * in the order they come. The manager moves them to its BCO buffers on the main thread
+ * after waiting, input by input in registration order, so that the buffers need no
+ * locking and get the same content as with a sequential fill.
+ */
+class StreamingInputProducer
+{
+ public:
+  //! raw hits received from the input during a fill
+  struct StagedHits
+  {
+    std::vector<std::pair<uint64_t, InttRawHit *>> InttRawHits;
+    std::vector<std::pair<uint64_t, MicromegasRawHit *>> MicromegasRawHits;
+    std::vector<std::pair<uint64_t, MvtxRawHit *>> MvtxRawHits;
+    std::vector<std::tuple<uint64_t, uint16_t, uint32_t>> MvtxFeeIdInfos;
+    std::vector<std::pair<uint64_t, uint64_t>> MvtxL1TrgBcos;
+    std::vector<std::pair<uint64_t, TpcRawHit *>> TpcRawHits;
+
+    //! reset, keeping the vector storage for the next fill
+    void clear();
+  };
+
+  explicit StreamingInputProducer(SingleStreamingInput *input);
+
+  //! waits for the running fill, if any, and stops the thread
+  ~StreamingInputProducer();
+
+  // no copy
+  StreamingInputProducer(const StreamingInputProducer &) = delete;
+  StreamingInputProducer &operator=(const StreamingInputProducer &) = delete;
+
+  SingleStreamingInput *Input() const { return m_Input; }
+
+  //! fill the pool of the input in the producer thread, returns immediately
+  void Start(const uint64_t minbco);
+
+  //! wait until the fill is done, rethrows exceptions from the input
+  void Wait();
+
+  //! FillPoolStatus() of the input after the last fill
+  int FillPoolStatus() const { return m_FillPoolStatus; }
+
+  StagedHits &Staged() { return m_Staged; }
+
+  //! producer running on the calling thread, nullptr outside of producer threads
+  static StreamingInputProducer *Current();
+
+ private:
+  void Loop();
+
+  SingleStreamingInput *m_Input{nullptr};
+  StagedHits m_Staged;
+
+  std::mutex m_Mutex;
+  std::condition_variable m_Condition;
+  uint64_t m_MinBco{0};
+  bool m_Busy{false};
+  bool m_Stop{false};
+  int m_FillPoolStatus{0};
+  std::exception_ptr m_Exception;
+
+  // started last, once all members are initialized
+  std::thread m_Thread;
+};
+
+#endif
@@ -24,6 +24,7 @@
 #include <TTree.h>
 #include <TVector3.h>
 
+#include <atomic>
 #include <cassert>
 #include <cstdint>
 #include <limits>
@@ -75,6 +76,8 @@ TpcTimeFrameBuilder::TpcTimeFrameBuilder(const int packet_id)
   m_hNorm->GetXaxis()->SetBinLabel(i++, "GTM_TimeFrame_Matched_Hit_Sum");
   m_hNorm->GetXaxis()->SetBinLabel(i++, "GTM_TimeFrame_Dropped_Hit_Sum");
 
+  m_hNorm->GetXaxis()->SetBinLabel(i++, "DecodedBytes");
+
   assert(i <= 20);
   m_hNorm->GetXaxis()->LabelsOption("v");
   hm->registerHisto(m_hNorm);
@@ -181,6 +184,15 @@ TpcTimeFrameBuilder::~TpcTimeFrameBuilder()
     }
   }
 
+  for (auto* hit : m_hitPool)
+  {
+    delete hit;
+  }
+
+  if (m_verbosity >= 1)
+  {
+    print_packet_stat();
+  }
   delete m_packetTimer;
 
   delete m_digitalCurrentDebugTTree;
@@ -196,6 +208,45 @@ void TpcTimeFrameBuilder::setVerbosity(const int i)
   }
 }
 
+TpcRawHitv3* TpcTimeFrameBuilder::allocate_hit()
+{
+  if (m_hitPool.empty())
+  {
+    return new TpcRawHitv3();
+  }
+
+  // hits in the pool were created by allocate_hit
+  TpcRawHitv3* hit = static_cast<TpcRawHitv3*>(m_hitPool.back());  // NOLINT(cppcoreguidelines-pro-type-static-cast-downcast)
+  m_hitPool.pop_back();
+  return hit;
+}
+
+void TpcTimeFrameBuilder::release_hit(TpcRawHit* hit)
+{
+  if (m_hitPool.size() >= kMaxHitPoolSize)
+  {
+    delete hit;
+    return;
+  }
+
+  // hits passed to the output container were moved from, and have no waveform left to clear
+  hit->Clear("");
+  m_hitPool.push_back(hit);
+}
+
+void TpcTimeFrameBuilder::print_packet_stat() const
+{
+  assert(m_packetTimer);
+  m_packetTimer->print_stat();
+
+  const double time = m_packetTimer->get_accumulated_time();  // ms
+  if (time > 0)
+  {
+    std::cout << m_packetTimer->get_name() << ": decoded data (GB):     " << m_decodedBytes * 1e-9 << std::endl;
+    std::cout << m_packetTimer->get_name() << ": decoding rate (GB/s):  " << m_decodedBytes * 1e-6 / time << std::endl;
+  }
+}
+
 bool TpcTimeFrameBuilder::isMoreDataRequired(const uint64_t& gtm_bco) const
 {
   for (const BcoMatchingInformation& bcoMatchingInformation : m_bcoMatchingInformation_vec)
@@ -269,7 +320,7 @@ std::vector<TpcRawHit*>& TpcTimeFrameBuilder::getTimeFrame(const uint64_t& gtm_b
       h_GTMClockDiff_Dropped->Fill(int64_t(it->first) - int64_t(bclk_rollover_corrected));
       for (const auto& hit : it->second)
       {
-        delete hit;
+        release_hit(hit);
       }
       it = m_timeFrameMap.erase(it);
     }
@@ -368,7 +419,7 @@ void TpcTimeFrameBuilder::CleanupUsedPackets(const uint64_t& bclk)
     {
       while (!it->second.empty())
       {
-        delete it->second.back();
+        release_hit(it->second.back());
         it->second.pop_back();
       }
       m_timeFrameMap.erase(it);
@@ -387,7 +438,7 @@ void TpcTimeFrameBuilder::CleanupUsedPackets(const uint64_t& bclk)
       while (!it->second.empty())
       {
         m_hFEEDataStream->Fill(it->second.back()->get_fee(), "HitUnusedBeforeCleanup", 1);
-        delete it->second.back();
+        release_hit(it->second.back());
         it->second.pop_back();
         ++count;
       }
@@ -413,8 +464,9 @@ void TpcTimeFrameBuilder::CleanupUsedPackets(const uint64_t& bclk)
 
 int TpcTimeFrameBuilder::ProcessPacket(Packet* packet)
 {
-  static size_t call_count = 0;
-  ++call_count;
+  // shared by the builders of all packets, which may run in producer threads
+  static std::atomic<size_t> packet_count{0};
+  const size_t call_count = ++packet_count;
 
   if (m_verbosity > 1)
   {
@@ -497,7 +549,7 @@ int TpcTimeFrameBuilder::ProcessPacket(Packet* packet)
     std::cout << __PRETTY_FUNCTION__ << "\t- : received packet ";
     packet->identify();
 
-    m_packetTimer->print_stat();
+    print_packet_stat();
   }
   m_packetTimer->restart();
 
@@ -607,10 +659,7 @@ int TpcTimeFrameBuilder::ProcessPacket(Packet* packet)
 
       if (fee_id < MAX_FEECOUNT)
       {
-        for (const uint16_t& i : dma_word_data.data)
-        {
-          m_feeData[fee_id].push_back(i);
-        }
+        m_feeData[fee_id].append(dma_word_data.data, DAM_DMA_WORD_LENGTH - 1);
         m_hNorm->Fill("DMA_WORD_FEE", 1);
 
         // immediate fee buffer processing to reduce memory consuption
@@ -651,12 +700,15 @@ int TpcTimeFrameBuilder::ProcessPacket(Packet* packet)
 
       while (!timeframe.second.empty())
       {
-        delete timeframe.second.back();
+        release_hit(timeframe.second.back());
         timeframe.second.pop_back();
       }
     }
   }
 
+  m_decodedBytes += static_cast<uint64_t>(l2) * sizeof(int);
+  m_hNorm->Fill("DecodedBytes", static_cast<double>(l2) * sizeof(int));
+
   m_packetTimer->stop();
   assert(h_ProcessPacket_Time);
   h_ProcessPacket_Time->Fill(call_count, m_packetTimer->elapsed());
@@ -674,7 +726,7 @@ int TpcTimeFrameBuilder::process_fee_data(unsigned int fee)
   }
 
   assert(fee < m_feeData.size());
-  std::deque<uint16_t>& data_buffer = m_feeData[fee];
+  FeeDataBuffer& data_buffer = m_feeData[fee];
 
   while (HEADER_LENGTH <= data_buffer.size())
   {
@@ -703,7 +755,7 @@ int TpcTimeFrameBuilder::process_fee_data(unsigned int fee)
           std::cout << __PRETTY_FUNCTION__ << "\t- : Error : Invalid FEE magic key at position 1 0x" << std::hex << data_buffer[1] << std::dec << std::endl;
         }
         m_hFEEDataStream->Fill(fee, "WordSkipped", 1);
-        data_buffer.pop_front();
+        data_buffer.consume(1);
         continue;
       }
       assert(data_buffer[1] == FEE_PACKET_MAGIC_KEY_1);
@@ -715,7 +767,7 @@ int TpcTimeFrameBuilder::process_fee_data(unsigned int fee)
           std::cout << __PRETTY_FUNCTION__ << "\t- : Error : Invalid FEE magic key at position 2 0x" << std::hex << data_buffer[2] << std::dec << std::endl;
         }
         m_hFEEDataStream->Fill(fee, "WordSkipped", 1);
-        data_buffer.pop_front();
+        data_buffer.consume(1);
         continue;
       }
       assert(data_buffer[2] == FEE_PACKET_MAGIC_KEY_2);
@@ -730,7 +782,7 @@ int TpcTimeFrameBuilder::process_fee_data(unsigned int fee)
         std::cout << __PRETTY_FUNCTION__ << "\t- : Error : Invalid FEE pkt_length " << pkt_length << std::endl;
       }
       m_hFEEDataStream->Fill(fee, "InvalidLength", 1);
-      data_buffer.pop_front();
+      data_buffer.consume(1);
       continue;
     }
 
@@ -749,13 +801,13 @@ int TpcTimeFrameBuilder::process_fee_data(unsigned int fee)
 
     if (is_digital_current)
     {
-      process_fee_data_digital_current(fee, data_buffer);
+      process_fee_data_digital_current(fee, data_buffer.data());
     }
     else
     {
-      process_fee_data_waveform(fee, data_buffer);
+      process_fee_data_waveform(fee, data_buffer.data());
     }
-    data_buffer.erase(data_buffer.begin(), data_buffer.begin() + pkt_length + 1);
+    data_buffer.consume(pkt_length + 1);
     m_hFEEDataStream->Fill(fee, "WordValid", pkt_length + 1);
 
   }  //     while (HEADER_LENGTH < data_buffer.size())
@@ -763,7 +815,7 @@ int TpcTimeFrameBuilder::process_fee_data(unsigned int fee)
   return Fun4AllReturnCodes::EVENT_OK;
 }
 
-void TpcTimeFrameBuilder::process_fee_data_waveform(const unsigned int& fee, std::deque<uint16_t>& data_buffer)
+void TpcTimeFrameBuilder::process_fee_data_waveform(const unsigned int& fee, const uint16_t* data_buffer)
 {
   const uint16_t& pkt_length = data_buffer[0];
 
@@ -782,7 +834,7 @@ void TpcTimeFrameBuilder::process_fee_data_waveform(const unsigned int& fee, std
 
   if (!m_fastBCOSkip)
   {
-    auto crc_parity = crc16_parity(fee, pkt_length);
+    auto crc_parity = crc16_parity(data_buffer, pkt_length);
     payload.calc_crc = crc_parity.first;
     payload.calc_parity = crc_parity.second;
 
@@ -924,16 +976,10 @@ void TpcTimeFrameBuilder::process_fee_data_waveform(const unsigned int& fee, std
 
     // Format is (N sample) (start time), (1st sample)... (Nth sample)
     size_t pos = HEADER_LENGTH;
-    std::deque<uint16_t>::const_iterator data_buffer_iterator = data_buffer.cbegin();
-    std::advance(data_buffer_iterator, pos);
     while (pos + 2 < pkt_length)
     {
-      const uint16_t& nsamp = *data_buffer_iterator;
-      ++pos;
-      ++data_buffer_iterator;
-      const uint16_t& start_t = *data_buffer_iterator;
-      ++pos;
-      ++data_buffer_iterator;
+      const uint16_t& nsamp = data_buffer[pos++];
+      const uint16_t& start_t = data_buffer[pos++];
       if (m_verbosity > 3)
       {
         std::cout << __PRETTY_FUNCTION__ << ": nsamp: " << nsamp
@@ -961,17 +1007,13 @@ void TpcTimeFrameBuilder::process_fee_data_waveform(const unsigned int& fee, std
       }
 
       const unsigned int fee_sampa_address = fee * MAX_SAMPA + payload.sampa_address;
-      std::vector<uint16_t> adc(nsamp);
+      const uint16_t* adc_begin = data_buffer + pos;
+      std::vector<uint16_t> adc(adc_begin, adc_begin + nsamp);
       for (int j = 0; j < nsamp; j++)
       {
-        const uint16_t& adc_value = *data_buffer_iterator;
-
-        adc[j] = adc_value;
-        m_hFEESAMPAADC->Fill(start_t + j, fee_sampa_address, adc_value);
-
-        ++pos;
-        ++data_buffer_iterator;  // data_buffer[pos++];
+        m_hFEESAMPAADC->Fill(start_t + j, fee_sampa_address, adc_begin[j]);
       }
+      pos += nsamp;
       payload.waveforms.emplace_back(start_t, std::move(adc));
 
       //   // an exception to deal with the last sample that is missing in the current hit format
@@ -992,7 +1034,7 @@ void TpcTimeFrameBuilder::process_fee_data_waveform(const unsigned int& fee, std
     // valid packet in the buffer, create a new hit
     if (payload.type != TpcTimeFrameBuilder::BcoMatchingInformation::HEARTBEAT_T)
     {
-      TpcRawHitv3* hit = new TpcRawHitv3();
+      TpcRawHitv3* hit = allocate_hit();
       m_timeFrameMap[payload.gtm_bco].push_back(hit);
 
       hit->set_bco(payload.bx_timestamp);
@@ -1015,7 +1057,7 @@ void TpcTimeFrameBuilder::process_fee_data_waveform(const unsigned int& fee, std
   return;
 }
 
-void TpcTimeFrameBuilder::process_fee_data_digital_current(const unsigned int& fee, std::deque<uint16_t>& data_buffer)
+void TpcTimeFrameBuilder::process_fee_data_digital_current(const unsigned int& fee, const uint16_t* data_buffer)
 {
   if (m_verbosity > 2)
   {
@@ -1068,7 +1110,7 @@ void TpcTimeFrameBuilder::process_fee_data_digital_current(const unsigned int& f
   }
 
   payload.data_crc = data_buffer[pkt_length];
-  auto crc_parity = crc16_parity(fee, pkt_length);
+  auto crc_parity = crc16_parity(data_buffer, pkt_length);
   payload.calc_crc = crc_parity.first;
   // payload.calc_parity = crc_parity.second;
 
@@ -1269,19 +1311,16 @@ uint16_t TpcTimeFrameBuilder::reverseBits(const uint16_t x) const
   return n;
 }
 
-std::pair<uint16_t, uint16_t> TpcTimeFrameBuilder::crc16_parity(const uint32_t fee, const uint16_t l) const
+std::pair<uint16_t, uint16_t> TpcTimeFrameBuilder::crc16_parity(const uint16_t* data_buffer, const uint16_t l) const
 {
-  const std::deque<uint16_t>& data_buffer = m_feeData[fee];
-  assert(l < data_buffer.size());
-
-  std::deque<uint16_t>::const_iterator it = data_buffer.begin();
+  assert(data_buffer);
 
   uint16_t crc = 0xffffU;
   uint16_t data_parity = 0U;
 
-  for (int i = 0; i < l; ++i, ++it)
+  for (int i = 0; i < l; ++i)
   {
-    const uint16_t& x = *it;
+    const uint16_t& x = data_buffer[i];
 
     crc ^= reverseBits(x);
     for (uint16_t k = 0; k < 16U; k++)
@@ -5,7 +5,6 @@
 
 #include <algorithm>
 #include <cstdint>
-#include <deque>
 #include <functional>
 #include <iostream>
 #include <limits>
@@ -20,6 +19,7 @@
 
 class Packet;
 class TpcRawHit;
+class TpcRawHitv3;
 class PHTimer;
 class TH1;
 class TH2;
@@ -75,7 +75,8 @@ class TpcTimeFrameBuilder : public TpcTimeFrameBuilderBase
   int m_hitFormat = -1;
 
   uint16_t reverseBits(const uint16_t x) const;
-  std::pair<uint16_t, uint16_t> crc16_parity(const uint32_t fee, const uint16_t l) const;
+  //! crc and parity of the first l words of a FEE packet
+  std::pair<uint16_t, uint16_t> crc16_parity(const uint16_t *data_buffer, const uint16_t l) const;
 
   //! DMA word structure
   struct dma_word
@@ -86,8 +87,61 @@ class TpcTimeFrameBuilder : public TpcTimeFrameBuilderBase
 
   int decode_gtm_data(const dma_word &gtm_word);
   int process_fee_data(unsigned int fee_id);
-  void process_fee_data_waveform(const unsigned int &fee_id, std::deque<uint16_t> &data_buffer);
-  void process_fee_data_digital_current(const unsigned int &fee_id, std::deque<uint16_t> &data_buffer);
+
+  //!@name FEE packet parsers
+  /**
+   * data_buffer points to a complete FEE packet in the FEE buffer,
+   * with data_buffer[0] + 1 words available
+   */
+  //@{
+  void process_fee_data_waveform(const unsigned int &fee_id, const uint16_t *data_buffer);
+  void process_fee_data_digital_current(const unsigned int &fee_id, const uint16_t *data_buffer);
+  //@}
+
+  //! contiguous buffer of the 16-bit words received from one FEE
+  /**
+   * DMA word payloads are appended in bulk, and decoded packets are consumed
+   * from the front by moving the read position. Remaining words are moved back
+   * to the beginning of the storage only once the consumed part dominates,
+   * so that parsers always see a packet as a contiguous array
+   */
+  class FeeDataBuffer
+  {
+   public:
+    //! pointer to the first unread word
+    const uint16_t *data() const { return m_data.data() + m_begin; }
+
+    //! number of unread words
+    size_t size() const { return m_data.size() - m_begin; }
+
+    const uint16_t &operator[](size_t i) const { return m_data[m_begin + i]; }
+
+    //! append n words
+    void append(const uint16_t *words, size_t n)
+    {
+      if (m_begin > 0 && m_begin >= m_data.size() / 2)
+      {
+        m_data.erase(m_data.begin(), m_data.begin() + m_begin);
+        m_begin = 0;
+      }
+      m_data.insert(m_data.end(), words, words + n);
+    }
+
+    //! drop the first n unread words
+    void consume(size_t n)
+    {
+      m_begin += n;
+      if (m_begin >= m_data.size())
+      {
+        m_data.clear();
+        m_begin = 0;
+      }
+    }
+
+   private:
+    std::vector<uint16_t> m_data;
+    size_t m_begin = 0;
+  };
 
   struct gtm_payload
   {
@@ -374,7 +428,13 @@ class TpcTimeFrameBuilder : public TpcTimeFrameBuilderBase
   };  //   class BcoMatchingInformation
 
  private:
-  std::vector<std::deque<uint16_t>> m_feeData;
+  //! new hit, recycled from the hit pool when available
+  TpcRawHitv3 *allocate_hit();
+
+  //! return a hit to the hit pool once it is no longer used
+  void release_hit(TpcRawHit *);
+
+  std::vector<FeeDataBuffer> m_feeData;
 
   std::map<int, std::set<int>> m_maskedFEEs;
 
@@ -391,6 +451,10 @@ class TpcTimeFrameBuilder : public TpcTimeFrameBuilderBase
   static const size_t kMaxRawHitLimit = 10000;  // 10k hits per event > 256ch/fee * 26fee
   std::queue<uint64_t> m_UsedTimeFrameSet;
 
+  //! released hits, reused by allocate_hit instead of new/delete for every hit
+  std::vector<TpcRawHit *> m_hitPool;
+  static const size_t kMaxHitPoolSize = 4 * kMaxRawHitLimit;
+
   //! fast skip mode when searching for particular GL1 BCO over long segment of files
   bool m_fastBCOSkip = false;
 
@@ -401,6 +465,12 @@ class TpcTimeFrameBuilder : public TpcTimeFrameBuilderBase
 
   PHTimer *m_packetTimer = nullptr;
 
+  //! bytes of packet data decoded by ProcessPacket, for throughput
+  uint64_t m_decodedBytes = 0;
+
+  //! print ProcessPacket timing and decoding throughput
+  void print_packet_stat() const;
+
   TH1 *m_hNorm = nullptr;
   TH2 *m_hFEEDataStream = nullptr;
   TH1 *m_hFEEChannelPacketCount = nullptr;
@@ -24,6 +24,7 @@
 #include <TTree.h>
 #include <TVector3.h>
 
+#include <atomic>
 #include <cassert>
 #include <cstdint>
 #include <limits>
@@ -1260,8 +1261,9 @@ void TpcTimeFrameBuilderRun3::CleanupUsedPackets(const uint64_t& bclk)
 
 int TpcTimeFrameBuilderRun3::ProcessPacket(Packet* packet)
 {
-  static size_t call_count = 0;
-  ++call_count;
+  // shared by the builders of all packets, which may run in producer threads
+  static std::atomic<size_t> packet_count{0};
+  const size_t call_count = ++packet_count;
 
   if (m_verbosity > 1)
   {
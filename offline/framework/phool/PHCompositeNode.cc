@@ -11,7 +11,14 @@
 #include "phool.h"
 #include "phooldefs.h"
 
+#include <atomic>
 #include <iostream>
+#include <iterator>
+
+namespace
+{
+  std::atomic<uint64_t> lookupCount{0};
+}
 
 PHCompositeNode::PHCompositeNode(const std::string& n)
   : PHNode(n, "PHCompositeNode")
@@ -27,6 +34,19 @@ PHCompositeNode::~PHCompositeNode()
   // works but it has to be executed in case the PHCompositeNode is
   // a parent and supposed to stay. Then the deleted node has to take itself
   // out of the node list
+  //
+  // the sub nodes do not update the index while this node is deleted, so
+  // take the whole sub-tree out of the parents index here. This node itself
+  // is removed by the parent's forgetMe
+  if (parent)
+  {
+    auto* parentNode = static_cast<PHCompositeNode*>(parent);
+    for (const auto& [nodename, node] : nodeIndex)
+    {
+      parentNode->unindexNode(nodename, node);
+    }
+  }
+  nodeIndex.clear();
   deleteMe = 1;
   subNodes.clearAndDestroy();
 }
@@ -51,7 +71,113 @@ bool PHCompositeNode::addNode(PHNode* newNode)
   // No conflict, so we can append the new node.
   //
   newNode->setParent(this);
-  return (subNodes.append(newNode));
+  if (!subNodes.append(newNode))
+  {
+    return false;
+  }
+
+  // index the new node and, for a composite node, its sub-tree
+  indexNode(newNode->getName(), newNode);
+  if (newNode->getType() == "PHCompositeNode")
+  {
+    for (const auto& [nodename, node] : static_cast<PHCompositeNode*>(newNode)->nodeIndex)
+    {
+      indexNode(nodename, node);
+    }
+  }
+  return true;
+}
+
+void PHCompositeNode::indexNode(const std::string& nodename, PHNode* node)
+{
+  for (PHCompositeNode* current = this; current; current = static_cast<PHCompositeNode*>(current->getParent()))
+  {
+    current->nodeIndex.emplace(nodename, node);
+    ++current->generation;
+  }
+}
+
+void PHCompositeNode::unindexNode(const std::string& nodename, PHNode* node)
+{
+  for (PHCompositeNode* current = this; current; current = static_cast<PHCompositeNode*>(current->getParent()))
+  {
+    auto range = current->nodeIndex.equal_range(nodename);
+    for (auto iter = range.first; iter != range.second; ++iter)
+    {
+      if (iter->second == node)
+      {
+        current->nodeIndex.erase(iter);
+        break;
+      }
+    }
+    ++current->generation;
+  }
+}
+
+uint64_t PHCompositeNode::getLookupCount()
+{
+  return lookupCount.load(std::memory_order_relaxed);
+}
+
+PHNode* PHCompositeNode::lookupNode(const std::string& nodename)
+{
+  lookupCount.fetch_add(1, std::memory_order_relaxed);
+  auto range = nodeIndex.equal_range(nodename);
+  if (range.first == range.second)
+  {
+    return nullptr;
+  }
+  if (std::next(range.first) == range.second)
+  {
+    return range.first->second;
+  }
+
+  // name is not unique, the first one in the tree wins
+  return findFirstInTree("", nodename);
+}
+
+PHNode* PHCompositeNode::lookupNode(const std::string& nodetype, const std::string& nodename)
+{
+  lookupCount.fetch_add(1, std::memory_order_relaxed);
+  auto range = nodeIndex.equal_range(nodename);
+  PHNode* found = nullptr;
+  for (auto iter = range.first; iter != range.second; ++iter)
+  {
+    if (iter->second->getType() == nodetype)
+    {
+      if (found)
+      {
+        // more than one candidate, the first one in the tree wins
+        return findFirstInTree(nodetype, nodename);
+      }
+      found = iter->second;
+    }
+  }
+  return found;
+}
+
+// NOLINTNEXTLINE(misc-no-recursion)
+PHNode* PHCompositeNode::findFirstInTree(const std::string& nodetype, const std::string& nodename)
+{
+  PHPointerListIterator<PHNode> nodeIter(subNodes);
+  PHNode* thisNode;
+  while ((thisNode = nodeIter()))
+  {
+    if (thisNode->getName() == nodename && (nodetype.empty() || thisNode->getType() == nodetype))
+    {
+      return thisNode;
+    }
+
+    if (thisNode->getType() == "PHCompositeNode")
+    {
+      PHNode* nodeFoundInSubTree = static_cast<PHCompositeNode*>(thisNode)->findFirstInTree(nodetype, nodename);
+      if (nodeFoundInSubTree)
+      {
+        return nodeFoundInSubTree;
+      }
+    }
+  }
+  return nullptr;
 }
 
 void PHCompositeNode::prune()
@@ -83,6 +209,14 @@ void PHCompositeNode::forgetMe(PHNode* child)
   {
     return;
   }
+
+  // the child might already have been taken out of the list (see prune)
+  // but it is still in the index
+  if (child)
+  {
+    unindexNode(child->getName(), child);
+  }
+
   PHPointerListIterator<PHNode> nodeIter(subNodes);
   PHNode* thisNode;
   while (child && (thisNode = nodeIter()))
@@ -95,6 +229,12 @@ void PHCompositeNode::forgetMe(PHNode* child)
   }
 }
 
+void PHCompositeNode::childRenamed(PHNode* child, const std::string& oldname)
+{
+  unindexNode(oldname, child);
+  indexNode(child->getName(), child);
+}
+
 bool PHCompositeNode::write(PHIOManager* IOManager, const std::string& path)
 {
   std::string newPath = name;
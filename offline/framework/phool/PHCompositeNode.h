@@ -7,7 +7,9 @@
 #include "PHNode.h"
 #include "PHPointerList.h"
 
+#include <cstdint>
 #include <string>
+#include <unordered_map>
 
 class PHIOManager;
 
@@ -37,13 +39,44 @@ class PHCompositeNode : public PHNode
   void print(const std::string & = "") override;
   bool write(PHIOManager *, const std::string & = "") override;
 
+  //
+  // Lookup of a node by name (and type) in the full sub-tree, using the
+  // name index maintained by addNode and node removal. Returns the same
+  // node as PHNodeIterator::findFirst (first match, depth first)
+  //
+  PHNode *lookupNode(const std::string &name);
+  PHNode *lookupNode(const std::string &type, const std::string &name);
+
+  //
+  // Incremented each time a node is added to or removed from the sub-tree.
+  // Used by cached lookups (see findNode::Handle) to know when to resolve again
+  //
+  uint64_t getGeneration() const { return generation; }
+
+  //
+  // total number of lookupNode calls, all trees and threads included
+  //
+  static uint64_t getLookupCount();
+
  protected:
   void forgetMe(PHNode *) override;
+  void childRenamed(PHNode *, const std::string &) override;
   PHPointerList<PHNode> subNodes;
   int deleteMe = 0;
 
  private:
   PHCompositeNode() = delete;
+
+  // add/remove a node of the sub-tree to the index of this node and all its parents
+  void indexNode(const std::string &, PHNode *);
+  void unindexNode(const std::string &, PHNode *);
+
+  // depth first search, used when a name is not unique in the sub-tree
+  PHNode *findFirstInTree(const std::string &type, const std::string &name);
+
+  // all nodes of the sub-tree, by name
+  std::unordered_multimap<std::string, PHNode *> nodeIndex;
+  uint64_t generation = 0;
 };
 
 #endif
@@ -54,6 +54,17 @@ PHNode::~PHNode()
   }
 }
 
+void PHNode::setName(const std::string& n)
+{
+  const std::string oldname = name;
+  name = n;
+  // parents keep an index of nodes by name
+  if (parent)
+  {
+    parent->childRenamed(this, oldname);
+  }
+}
+
 // Implementation of external functions.
 std::ostream&
 operator<<(std::ostream& stream, const PHNode& node)
@@ -21,6 +21,7 @@ class PHNode
   virtual void print(const std::string &) = 0;
   virtual void forgetMe(PHNode *) = 0;
   virtual bool write(PHIOManager *, const std::string & = "") = 0;
+  virtual void childRenamed(PHNode *, const std::string & /*oldname*/) {}
 
   virtual void setResetFlag(const bool b) { reset_able = b; }
   virtual bool getResetFlag() const { return reset_able; }
@@ -32,7 +33,7 @@ class PHNode
   const std::string &getName() const { return name; }
   const std::string &getClass() const { return objectclass; }
   void setParent(PHNode *p) { parent = p; }
-  void setName(const std::string &n) { name = n; }
+  void setName(const std::string &n);
   void setObjectType(const std::string &n) { objecttype = n; }
   void makeTransient() { persistent = false; }
 
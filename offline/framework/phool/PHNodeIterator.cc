@@ -42,54 +42,14 @@ void PHNodeIterator::print()
   currentNode->print();
 }
 
-// NOLINTNEXTLINE(misc-no-recursion)
 PHNode* PHNodeIterator::findFirst(const std::string& requiredType, const std::string& requiredName)
 {
-  PHPointerListIterator<PHNode> iter(currentNode->subNodes);
-  PHNode* thisNode;
-  while ((thisNode = iter()))
-  {
-    if (thisNode->getType() == requiredType && thisNode->getName() == requiredName)
-    {
-      return thisNode;
-    }
-
-    if (thisNode->getType() == "PHCompositeNode")
-    {
-      PHNodeIterator nodeIter(dynamic_cast<PHCompositeNode*>(thisNode));
-      PHNode* nodeFoundInSubTree = nodeIter.findFirst(requiredType, requiredName);
-      if (nodeFoundInSubTree)
-      {
-        return nodeFoundInSubTree;
-      }
-    }
-  }
-  return nullptr;
+  return currentNode->lookupNode(requiredType, requiredName);
 }
 
-// NOLINTNEXTLINE(misc-no-recursion)
 PHNode* PHNodeIterator::findFirst(const std::string& requiredName)
 {
-  PHPointerListIterator<PHNode> iter(currentNode->subNodes);
-  PHNode* thisNode;
-  while ((thisNode = iter()))
-  {
-    if (thisNode->getName() == requiredName)
-    {
-      return thisNode;
-    }
-
-    if (thisNode->getType() == "PHCompositeNode")
-    {
-      PHNodeIterator nodeIter(dynamic_cast<PHCompositeNode*>(thisNode));
-      PHNode* nodeFoundInSubTree = nodeIter.findFirst(requiredName);
-      if (nodeFoundInSubTree)
-      {
-        return nodeFoundInSubTree;
-      }
-    }
-  }
-  return nullptr;
+  return currentNode->lookupNode(requiredName);
 }
 
 bool PHNodeIterator::cd(const std::string& pathString)
@@ -1,6 +1,7 @@
 #ifndef PHOOL_GETCLASS_H
 #define PHOOL_GETCLASS_H
 
+#include "PHCompositeNode.h"
 #include "PHDataNode.h"
 #include "PHIODataNode.h"
 #include "PHNode.h"
@@ -8,16 +9,13 @@
 
 #include <TObject.h>
 
+#include <cstdint>
 #include <string>
 
-class PHCompositeNode;
-
 namespace findNode
 {
-  template <class T> T *getClass(PHCompositeNode *top, const std::string &name)
+  template <class T> T *getData(PHNode *FoundNode)
   {
-    PHNodeIterator iter(top);
-    PHNode *FoundNode = iter.findFirst(name);  // returns pointer to PHNode
     if (!FoundNode)
     {
       return nullptr;
@@ -55,12 +53,102 @@ namespace findNode
     return nullptr;
   }
 
+  template <class T> T *getClass(PHCompositeNode *top, const std::string &name)
+  {
+    PHNodeIterator iter(top);
+    PHNode *FoundNode = iter.findFirst(name);  // returns pointer to PHNode
+    return getData<T>(FoundNode);
+  }
+
   template <class T> T *getClass(PHCompositeNode *top, const int packetid)
   {
     std::string name = std::to_string(packetid);
     return findNode::getClass<T>(top,name);
   }
 
+  /*
+   * Typed handle to an object on the node tree.
+   * The node is looked up once and only looked up again when nodes were
+   * added to or removed from the tree below top (node tree resets included).
+   * The object pointer stored in the node is re-read on each access, since
+   * input managers are allowed to replace it.
+   * The handle must not outlive the top node it was created with.
+   */
+  template <class T> class Handle
+  {
+   public:
+    Handle() = default;
+    Handle(PHCompositeNode *top, const std::string &name)
+      : m_Top(top)
+      , m_Name(name)
+    {
+    }
+
+    T *get()
+    {
+      if (!m_Top)
+      {
+        return nullptr;
+      }
+      if (!m_Resolved || m_Generation != m_Top->getGeneration())
+      {
+        resolve();
+      }
+      if (m_DataNode)
+      {
+        return m_DataNode->getData();
+      }
+      if (m_IONode)
+      {
+        TObject *data = m_IONode->getData();
+        if (data != m_LastData)
+        {
+          m_LastData = data;
+          m_Object = dynamic_cast<T *>(data);
+        }
+        return m_Object;
+      }
+      return nullptr;
+    }
+
+    T *operator->() { return get(); }
+    explicit operator bool() { return get() != nullptr; }
+
+   private:
+    void resolve()
+    {
+      m_Resolved = true;
+      m_Generation = m_Top->getGeneration();
+      m_DataNode = nullptr;
+      m_IONode = nullptr;
+      m_LastData = nullptr;
+      m_Object = nullptr;
+
+      PHNode *node = m_Top->lookupNode(m_Name);
+      if (!node)
+      {
+        return;
+      }
+
+      // same logic as getData, decided once for the node
+      m_DataNode = dynamic_cast<PHDataNode<T> *>(node);
+      if (m_DataNode)
+      {
+        return;
+      }
+      m_IONode = static_cast<PHIODataNode<TObject> *>(node);
+    }
+
+    PHCompositeNode *m_Top{nullptr};
+    std::string m_Name;
+    bool m_Resolved{false};
+    uint64_t m_Generation{0};
+    PHDataNode<T> *m_DataNode{nullptr};
+    PHIODataNode<TObject> *m_IONode{nullptr};
+    TObject *m_LastData{nullptr};
+    T *m_Object{nullptr};
+  };
+
 }  // namespace findNode
 
 #endif
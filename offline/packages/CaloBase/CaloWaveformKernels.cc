@@ -0,0 +1,928 @@
+#include "CaloWaveformKernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CALOWAVEFORMKERNELS_X86
+#endif
+
+/*
+ * The vector kernels do the same floating point operations in the same order as the
+ * scalar ones, lane by lane, so the results are bit identical. This requires that
+ * multiply-add are not contracted to FMA (avx512f implies fma for gcc)
+ */
+#if defined(__clang__)
+#pragma clang fp contract(off)
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+namespace
+{
+  //! the nyquist search steps go from 0.5 down to 1/512 sample, all times are on this grid
+  constexpr int nyquist_grid = 512;
+
+  /** sin(pi d) and tan(pi d / N) (sin(pi d / N) for odd N) of the psinc terms, for all
+   *  d = t - n on the nyquist grid, -N < d < N. The index of d is (d + N) * nyquist_grid
+   */
+  class NyquistTable
+  {
+   public:
+    explicit NyquistTable(int N);
+
+    int index(float d) const { return static_cast<int>((d + m_N) * nyquist_grid); }
+
+    //! psinc of the samples at t. t must be on the grid, not an integer, -1 < t < N
+    float psinc(float t, const float *samples) const
+    {
+      float sum = 0;
+      for (int n = 0; n < m_N; n++)
+      {
+        const int i = index(t - n);
+        sum += samples[n] * m_sine[i] / m_denominator[i] / m_N;
+      }
+      return sum;
+    }
+
+    int m_N{0};
+    std::vector<double> m_sine;
+    std::vector<double> m_denominator;
+  };
+
+  NyquistTable::NyquistTable(int N)
+    : m_N(N)
+    , m_sine(2 * N * nyquist_grid + 1, 0)
+    , m_denominator(2 * N * nyquist_grid + 1, 0)
+  {
+    for (std::size_t i = 0; i < m_sine.size(); ++i)
+    {
+      // same operations as psinc, d is exact
+      const float d = static_cast<float>(static_cast<int>(i) - N * nyquist_grid) / nyquist_grid;
+      const double piu = M_PI * d;
+      const double piuN = piu / N;
+      m_sine[i] = std::sin(piu);
+      m_denominator[i] = (N % 2 == 0) ? std::tan(piuN) : std::sin(piuN);
+    }
+  }
+
+  //! tables are built at first use and kept, one per number of samples
+  const NyquistTable &nyquist_table(int N)
+  {
+    static std::mutex mutex;
+    static std::map<int, std::unique_ptr<NyquistTable>> tables;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto &table = tables[N];
+    if (!table)
+    {
+      table = std::make_unique<NyquistTable>(N);
+    }
+    return *table;
+  }
+
+  /** natural cubic spline through (x1-1, y0), (x1, y1), (x1+1, y2), as TSpline3 with "b2e2".
+   *  Interval i is y[i] + dx * (b[i] + dx * (c[i] + dx * d[i])) with dx = x - x[i]
+   */
+  class Spline
+  {
+   public:
+    Spline(float x1, float y0, float y1, float y2)
+      : m_x{x1 - 1., x1, x1 + 1.}
+      , m_y{y0, y1, y2}
+    {
+      // the second derivative on the middle knot is 1.5 s, zero on both ends
+      const double s = m_y[0] - 2 * m_y[1] + m_y[2];
+      const double q = s * 0.25;
+      m_b[0] = (m_y[1] - m_y[0]) - q;
+      m_c[0] = 0;
+      m_d[0] = q;
+      m_b[1] = (m_y[2] - m_y[1]) - s * 0.5;
+      m_c[1] = s * 0.75;
+      m_d[1] = -q;
+    }
+
+    //! a knot belongs to the interval on its right, as in TSpline3::Eval
+    double eval(double x) const
+    {
+      const int k = (x < m_x[1]) ? 0 : 1;
+      const double dx = x - m_x[k];
+      return m_y[k] + dx * (m_b[k] + dx * (m_c[k] + dx * m_d[k]));
+    }
+
+    double m_x[3];
+    double m_y[3];
+    double m_b[2]{};
+    double m_c[2]{};
+    double m_d[2]{};
+  };
+
+  void fast_peak_scalar(const float *v, int N, int &peak_sample, float &time, float &amplitude)
+  {
+    int maxx = 0;
+    float maxy = v[0];
+    for (int n = 1; n < N; n++)
+    {
+      if (v[n] > maxy)
+      {
+        maxy = v[n];
+        maxx = n;
+      }
+    }
+    peak_sample = maxx;
+    if (maxx == 0 || maxx == N - 1)
+    {
+      time = maxx;
+      amplitude = maxy;
+    }
+    else
+    {
+      CaloWaveformKernels::fast_max(maxx, v[maxx - 1], v[maxx], v[maxx + 1], time, amplitude);
+    }
+  }
+
+  void nyquist_peak_scalar(const float *v, const NyquistTable &table, float &time, float &amplitude)
+  {
+    const int N = table.m_N;
+    int maxx = 0;
+    float max = v[0];
+    for (int n = 1; n < N; n++)
+    {
+      if (v[n] > max)
+      {
+        max = v[n];
+        maxx = n;
+      }
+    }
+
+    /*
+     * max is the interpolation at maxpos, look half a step left and right of it.
+     * Left and right are never integers, so the table can be used
+     */
+    float maxpos = maxx;
+    for (float step = 0.5; step > 0.001; step /= 2)
+    {
+      const float center = maxpos;
+      float yval = table.psinc(center - step, v);
+      if (yval > max)
+      {
+        max = yval;
+        maxpos = center - step;
+      }
+      yval = table.psinc(center + step, v);
+      if (yval > max)
+      {
+        max = yval;
+        maxpos = center + step;
+      }
+    }
+    time = maxpos;
+    amplitude = max;
+  }
+
+  /** copy the samples of up to W channels starting at channels[first] to block[n * W + lane].
+   *  Missing lanes repeat the last channel. Returns the number of channels copied
+   */
+  template <unsigned int W>
+  unsigned int transpose(const float *samples, std::size_t stride, unsigned int nsamples,
+                         const unsigned int *channels, std::size_t nchannels, std::size_t first, float *block)
+  {
+    const unsigned int nlanes = std::min<std::size_t>(W, nchannels - first);
+    for (unsigned int lane = 0; lane < W; ++lane)
+    {
+      const float *v = samples + channels[first + std::min(lane, nlanes - 1)] * stride;
+      for (unsigned int n = 0; n < nsamples; ++n)
+      {
+        block[n * W + lane] = v[n];
+      }
+    }
+    return nlanes;
+  }
+
+  //! run a vector kernel on groups of W channels
+  template <unsigned int W, class Kernel>
+  void fast_peak_vector(const float *samples, std::size_t stride, unsigned int nsamples,
+                        const unsigned int *channels, std::size_t nchannels,
+                        int *peak_sample, float *time, float *amplitude, Kernel kernel)
+  {
+    std::vector<float> block(nsamples * W);
+    float lane_sample[W];
+    float lane_time[W];
+    float lane_amplitude[W];
+    for (std::size_t first = 0; first < nchannels; first += W)
+    {
+      const unsigned int nlanes = transpose<W>(samples, stride, nsamples, channels, nchannels, first, block.data());
+      kernel(block.data(), nsamples, lane_sample, lane_time, lane_amplitude);
+      for (unsigned int lane = 0; lane < nlanes; ++lane)
+      {
+        const unsigned int ich = channels[first + lane];
+        peak_sample[ich] = static_cast<int>(lane_sample[lane]);
+        time[ich] = lane_time[lane];
+        amplitude[ich] = lane_amplitude[lane];
+      }
+    }
+  }
+
+  template <unsigned int W, class Kernel>
+  void nyquist_peak_vector(const float *samples, std::size_t stride, const NyquistTable &table,
+                           const unsigned int *channels, std::size_t nchannels,
+                           float *time, float *amplitude, Kernel kernel)
+  {
+    std::vector<float> block(table.m_N * W);
+    float lane_time[W];
+    float lane_amplitude[W];
+    for (std::size_t first = 0; first < nchannels; first += W)
+    {
+      const unsigned int nlanes = transpose<W>(samples, stride, table.m_N, channels, nchannels, first, block.data());
+      kernel(block.data(), table, lane_time, lane_amplitude);
+      for (unsigned int lane = 0; lane < nlanes; ++lane)
+      {
+        const unsigned int ich = channels[first + lane];
+        time[ich] = lane_time[lane];
+        amplitude[ich] = lane_amplitude[lane];
+      }
+    }
+  }
+
+#ifdef CALOWAVEFORMKERNELS_X86
+// gcc warns about the undefined vectors used inside the gather and conversion intrinsics
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+  //!@name AVX2, 8 channels. Double precision parts are done on two halves of 4 channels
+  //@{
+  __attribute__((target("avx2"))) inline __m256d select_avx2(__m256d mask, __m256d a, __m256d b)
+  {
+    return _mm256_blendv_pd(b, a, mask);
+  }
+
+  __attribute__((target("avx2"))) inline __m256d round_to_float_avx2(__m256d x)
+  {
+    return _mm256_cvtps_pd(_mm256_cvtpd_ps(x));
+  }
+
+  //! Spline with one lane per channel
+  struct SplineAvx2
+  {
+    __m256d x[3];
+    __m256d y[3];
+    __m256d b[2];
+    __m256d c[2];
+    __m256d d[2];
+  };
+
+  __attribute__((target("avx2"))) inline __m256d spline_eval_avx2(const SplineAvx2 &sp, __m256d x)
+  {
+    const __m256d left = _mm256_cmp_pd(x, sp.x[1], _CMP_LT_OQ);
+    const __m256d dx = _mm256_sub_pd(x, select_avx2(left, sp.x[0], sp.x[1]));
+    __m256d value = _mm256_mul_pd(dx, select_avx2(left, sp.d[0], sp.d[1]));
+    value = _mm256_mul_pd(dx, _mm256_add_pd(select_avx2(left, sp.c[0], sp.c[1]), value));
+    value = _mm256_mul_pd(dx, _mm256_add_pd(select_avx2(left, sp.b[0], sp.b[1]), value));
+    return _mm256_add_pd(select_avx2(left, sp.y[0], sp.y[1]), value);
+  }
+
+  //! keep the root if valid, in interval i and larger than the current maximum
+  __attribute__((target("avx2"))) inline void spline_candidate_avx2(const SplineAvx2 &sp, int i, __m256d valid, __m256d root, __m256d &xmax, __m256d &ymax)
+  {
+    root = round_to_float_avx2(root);
+    const __m256d inside = _mm256_and_pd(_mm256_cmp_pd(root, sp.x[i], _CMP_GE_OQ), _mm256_cmp_pd(root, sp.x[i + 1], _CMP_LE_OQ));
+    const __m256d yvalue = round_to_float_avx2(spline_eval_avx2(sp, root));
+    const __m256d better = _mm256_and_pd(_mm256_and_pd(valid, inside), _mm256_cmp_pd(yvalue, ymax, _CMP_GT_OQ));
+    xmax = select_avx2(better, root, xmax);
+    ymax = select_avx2(better, yvalue, ymax);
+  }
+
+  //! fast_max of 4 channels
+  __attribute__((target("avx2"))) void fast_max_avx2(__m128 x1f, __m128 y0f, __m128 y1f, __m128 y2f, __m128 &xmaxf, __m128 &ymaxf)
+  {
+    SplineAvx2 sp;
+    const __m256d one = _mm256_set1_pd(1);
+    sp.x[1] = _mm256_cvtps_pd(x1f);
+    sp.x[0] = _mm256_sub_pd(sp.x[1], one);
+    sp.x[2] = _mm256_add_pd(sp.x[1], one);
+    sp.y[0] = _mm256_cvtps_pd(y0f);
+    sp.y[1] = _mm256_cvtps_pd(y1f);
+    sp.y[2] = _mm256_cvtps_pd(y2f);
+    const __m256d s = _mm256_add_pd(_mm256_sub_pd(sp.y[0], _mm256_mul_pd(_mm256_set1_pd(2), sp.y[1])), sp.y[2]);
+    const __m256d q = _mm256_mul_pd(s, _mm256_set1_pd(0.25));
+    sp.b[0] = _mm256_sub_pd(_mm256_sub_pd(sp.y[1], sp.y[0]), q);
+    sp.c[0] = _mm256_setzero_pd();
+    sp.d[0] = q;
+    sp.b[1] = _mm256_sub_pd(_mm256_sub_pd(sp.y[2], sp.y[1]), _mm256_mul_pd(s, _mm256_set1_pd(0.5)));
+    sp.c[1] = _mm256_mul_pd(s, _mm256_set1_pd(0.75));
+    sp.d[1] = _mm256_xor_pd(q, _mm256_set1_pd(-0.));
+
+    // the largest of the three points
+    __m256d ymax = sp.y[1];
+    __m256d xmax = sp.x[1];
+    __m256d larger = _mm256_cmp_pd(sp.y[0], ymax, _CMP_GT_OQ);
+    ymax = select_avx2(larger, sp.y[0], ymax);
+    xmax = select_avx2(larger, round_to_float_avx2(sp.x[0]), xmax);
+    larger = _mm256_cmp_pd(sp.y[2], ymax, _CMP_GT_OQ);
+    ymax = select_avx2(larger, sp.y[2], ymax);
+    xmax = select_avx2(larger, round_to_float_avx2(sp.x[2]), xmax);
+
+    const __m256d zero = _mm256_setzero_pd();
+    for (int i = 0; i <= 1; i++)
+    {
+      // quadratic: -b / (2c) if c < 0
+      const __m256d quadratic = _mm256_cmp_pd(sp.d[i], zero, _CMP_EQ_OQ);
+      const __m256d root = _mm256_add_pd(_mm256_div_pd(_mm256_xor_pd(sp.b[i], _mm256_set1_pd(-0.)), _mm256_mul_pd(_mm256_set1_pd(2), sp.c[i])), sp.x[i]);
+      spline_candidate_avx2(sp, i, _mm256_and_pd(quadratic, _mm256_cmp_pd(sp.c[i], zero, _CMP_LT_OQ)), root, xmax, ymax);
+
+      // cubic: zeros of the derivative
+      const __m256d cubic = _mm256_cmp_pd(sp.d[i], zero, _CMP_NEQ_UQ);
+      const __m256d sqrtdelta = _mm256_sqrt_pd(_mm256_sub_pd(_mm256_mul_pd(_mm256_mul_pd(_mm256_set1_pd(4), sp.c[i]), sp.c[i]),
+                                                             _mm256_mul_pd(_mm256_mul_pd(_mm256_set1_pd(12), sp.b[i]), sp.d[i])));
+      const __m256d minus2c = _mm256_mul_pd(_mm256_set1_pd(-2), sp.c[i]);
+      const __m256d sixd = _mm256_mul_pd(_mm256_set1_pd(6), sp.d[i]);
+      spline_candidate_avx2(sp, i, cubic, _mm256_add_pd(_mm256_div_pd(_mm256_add_pd(minus2c, sqrtdelta), sixd), sp.x[i]), xmax, ymax);
+      spline_candidate_avx2(sp, i, cubic, _mm256_add_pd(_mm256_div_pd(_mm256_sub_pd(minus2c, sqrtdelta), sixd), sp.x[i]), xmax, ymax);
+    }
+    xmaxf = _mm256_cvtpd_ps(xmax);
+    ymaxf = _mm256_cvtpd_ps(ymax);
+  }
+
+  __attribute__((target("avx2"))) void fast_peak_avx2(const float *block, unsigned int nsamples, float *peak_sample, float *time, float *amplitude)
+  {
+    constexpr unsigned int W = 8;
+    __m256 max = _mm256_loadu_ps(block);
+    __m256 maxx = _mm256_setzero_ps();
+    for (unsigned int n = 1; n < nsamples; ++n)
+    {
+      const __m256 v = _mm256_loadu_ps(block + n * W);
+      const __m256 larger = _mm256_cmp_ps(v, max, _CMP_GT_OQ);
+      max = _mm256_blendv_ps(max, v, larger);
+      maxx = _mm256_blendv_ps(maxx, _mm256_set1_ps(n), larger);
+    }
+
+    // neighbours of the maximum
+    const __m256 before = _mm256_sub_ps(maxx, _mm256_set1_ps(1));
+    const __m256 after = _mm256_add_ps(maxx, _mm256_set1_ps(1));
+    __m256 y0 = _mm256_setzero_ps();
+    __m256 y2 = _mm256_setzero_ps();
+    for (unsigned int n = 0; n < nsamples; ++n)
+    {
+      const __m256 v = _mm256_loadu_ps(block + n * W);
+      const __m256 position = _mm256_set1_ps(n);
+      y0 = _mm256_blendv_ps(y0, v, _mm256_cmp_ps(before, position, _CMP_EQ_OQ));
+      y2 = _mm256_blendv_ps(y2, v, _mm256_cmp_ps(after, position, _CMP_EQ_OQ));
+    }
+
+    _mm256_storeu_ps(peak_sample, maxx);
+    __m256 xmax = maxx;
+    __m256 ymax = max;
+
+    // maxima on the first or last sample are not refined
+    const __m256 refine = _mm256_and_ps(_mm256_cmp_ps(maxx, _mm256_setzero_ps(), _CMP_GT_OQ),
+                                        _mm256_cmp_ps(maxx, _mm256_set1_ps(nsamples - 1), _CMP_LT_OQ));
+    if (!_mm256_testz_ps(refine, refine))
+    {
+      __m128 xlow;
+      __m128 ylow;
+      __m128 xhigh;
+      __m128 yhigh;
+      fast_max_avx2(_mm256_castps256_ps128(maxx), _mm256_castps256_ps128(y0), _mm256_castps256_ps128(max), _mm256_castps256_ps128(y2), xlow, ylow);
+      fast_max_avx2(_mm256_extractf128_ps(maxx, 1), _mm256_extractf128_ps(y0, 1), _mm256_extractf128_ps(max, 1), _mm256_extractf128_ps(y2, 1), xhigh, yhigh);
+      xmax = _mm256_blendv_ps(xmax, _mm256_insertf128_ps(_mm256_castps128_ps256(xlow), xhigh, 1), refine);
+      ymax = _mm256_blendv_ps(ymax, _mm256_insertf128_ps(_mm256_castps128_ps256(ylow), yhigh, 1), refine);
+    }
+    _mm256_storeu_ps(time, xmax);
+    _mm256_storeu_ps(amplitude, ymax);
+  }
+
+  //! sum of the psinc terms of 4 channels, index are the table indices of d = t - n
+  __attribute__((target("avx2"))) inline __m128 psinc_term_avx2(__m128 sum, __m128 v, __m128i index, const NyquistTable &table)
+  {
+    const __m256d sine = _mm256_i32gather_pd(table.m_sine.data(), index, 8);
+    const __m256d denominator = _mm256_i32gather_pd(table.m_denominator.data(), index, 8);
+    __m256d term = _mm256_div_pd(_mm256_mul_pd(_mm256_cvtps_pd(v), sine), denominator);
+    term = _mm256_div_pd(term, _mm256_set1_pd(table.m_N));
+    return _mm256_cvtpd_ps(_mm256_add_pd(_mm256_cvtps_pd(sum), term));
+  }
+
+  __attribute__((target("avx2"))) __m256 psinc_avx2(__m256 t, const float *block, const NyquistTable &table)
+  {
+    constexpr int W = 8;
+    const __m256 offset = _mm256_set1_ps(table.m_N);
+    const __m256 grid = _mm256_set1_ps(nyquist_grid);
+    __m128 low = _mm_setzero_ps();
+    __m128 high = _mm_setzero_ps();
+    for (int n = 0; n < table.m_N; n++)
+    {
+      const __m256 d = _mm256_sub_ps(t, _mm256_set1_ps(n));
+      const __m256i index = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_add_ps(d, offset), grid));
+      const __m256 v = _mm256_loadu_ps(block + n * W);
+      low = psinc_term_avx2(low, _mm256_castps256_ps128(v), _mm256_castsi256_si128(index), table);
+      high = psinc_term_avx2(high, _mm256_extractf128_ps(v, 1), _mm256_extracti128_si256(index, 1), table);
+    }
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(low), high, 1);
+  }
+
+  __attribute__((target("avx2"))) void nyquist_peak_avx2(const float *block, const NyquistTable &table, float *time, float *amplitude)
+  {
+    constexpr int W = 8;
+    __m256 max = _mm256_loadu_ps(block);
+    __m256 maxpos = _mm256_setzero_ps();
+    for (int n = 1; n < table.m_N; ++n)
+    {
+      const __m256 v = _mm256_loadu_ps(block + n * W);
+      const __m256 larger = _mm256_cmp_ps(v, max, _CMP_GT_OQ);
+      max = _mm256_blendv_ps(max, v, larger);
+      maxpos = _mm256_blendv_ps(maxpos, _mm256_set1_ps(n), larger);
+    }
+
+    for (float step = 0.5; step > 0.001; step /= 2)
+    {
+      const __m256 center = maxpos;
+      const __m256 left = _mm256_sub_ps(center, _mm256_set1_ps(step));
+      __m256 yval = psinc_avx2(left, block, table);
+      __m256 larger = _mm256_cmp_ps(yval, max, _CMP_GT_OQ);
+      max = _mm256_blendv_ps(max, yval, larger);
+      maxpos = _mm256_blendv_ps(maxpos, left, larger);
+
+      const __m256 right = _mm256_add_ps(center, _mm256_set1_ps(step));
+      yval = psinc_avx2(right, block, table);
+      larger = _mm256_cmp_ps(yval, max, _CMP_GT_OQ);
+      max = _mm256_blendv_ps(max, yval, larger);
+      maxpos = _mm256_blendv_ps(maxpos, right, larger);
+    }
+    _mm256_storeu_ps(time, maxpos);
+    _mm256_storeu_ps(amplitude, max);
+  }
+  //@}
+
+  //!@name AVX-512, 16 channels. Double precision parts are done on two halves of 8 channels
+  //@{
+  __attribute__((target("avx512f"))) inline __m256 low_avx512(__m512 x)
+  {
+    return _mm512_castps512_ps256(x);
+  }
+
+  __attribute__((target("avx512f"))) inline __m256 high_avx512(__m512 x)
+  {
+    return _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(x), 1));
+  }
+
+  __attribute__((target("avx512f"))) inline __m512 combine_avx512(__m256 low, __m256 high)
+  {
+    return _mm512_castpd_ps(_mm512_insertf64x4(_mm512_castps_pd(_mm512_castps256_ps512(low)), _mm256_castps_pd(high), 1));
+  }
+
+  __attribute__((target("avx512f"))) inline __m512d round_to_float_avx512(__m512d x)
+  {
+    return _mm512_cvtps_pd(_mm512_cvtpd_ps(x));
+  }
+
+  struct SplineAvx512
+  {
+    __m512d x[3];
+    __m512d y[3];
+    __m512d b[2];
+    __m512d c[2];
+    __m512d d[2];
+  };
+
+  __attribute__((target("avx512f"))) inline __m512d spline_eval_avx512(const SplineAvx512 &sp, __m512d x)
+  {
+    // mask_blend picks the second operand where the mask is set
+    const __mmask8 right = _mm512_cmp_pd_mask(x, sp.x[1], _CMP_NLT_UQ);
+    const __m512d dx = _mm512_sub_pd(x, _mm512_mask_blend_pd(right, sp.x[0], sp.x[1]));
+    __m512d value = _mm512_mul_pd(dx, _mm512_mask_blend_pd(right, sp.d[0], sp.d[1]));
+    value = _mm512_mul_pd(dx, _mm512_add_pd(_mm512_mask_blend_pd(right, sp.c[0], sp.c[1]), value));
+    value = _mm512_mul_pd(dx, _mm512_add_pd(_mm512_mask_blend_pd(right, sp.b[0], sp.b[1]), value));
+    return _mm512_add_pd(_mm512_mask_blend_pd(right, sp.y[0], sp.y[1]), value);
+  }
+
+  __attribute__((target("avx512f"))) inline void spline_candidate_avx512(const SplineAvx512 &sp, int i, __mmask8 valid, __m512d root, __m512d &xmax, __m512d &ymax)
+  {
+    root = round_to_float_avx512(root);
+    const __mmask8 inside = _mm512_cmp_pd_mask(root, sp.x[i], _CMP_GE_OQ) & _mm512_cmp_pd_mask(root, sp.x[i + 1], _CMP_LE_OQ);
+    const __m512d yvalue = round_to_float_avx512(spline_eval_avx512(sp, root));
+    const __mmask8 better = valid & inside & _mm512_cmp_pd_mask(yvalue, ymax, _CMP_GT_OQ);
+    xmax = _mm512_mask_blend_pd(better, xmax, root);
+    ymax = _mm512_mask_blend_pd(better, ymax, yvalue);
+  }
+
+  //! fast_max of 8 channels
+  __attribute__((target("avx512f"))) void fast_max_avx512(__m256 x1f, __m256 y0f, __m256 y1f, __m256 y2f, __m256 &xmaxf, __m256 &ymaxf)
+  {
+    SplineAvx512 sp;
+    const __m512d one = _mm512_set1_pd(1);
+    sp.x[1] = _mm512_cvtps_pd(x1f);
+    sp.x[0] = _mm512_sub_pd(sp.x[1], one);
+    sp.x[2] = _mm512_add_pd(sp.x[1], one);
+    sp.y[0] = _mm512_cvtps_pd(y0f);
+    sp.y[1] = _mm512_cvtps_pd(y1f);
+    sp.y[2] = _mm512_cvtps_pd(y2f);
+    const __m512d s = _mm512_add_pd(_mm512_sub_pd(sp.y[0], _mm512_mul_pd(_mm512_set1_pd(2), sp.y[1])), sp.y[2]);
+    const __m512d q = _mm512_mul_pd(s, _mm512_set1_pd(0.25));
+    sp.b[0] = _mm512_sub_pd(_mm512_sub_pd(sp.y[1], sp.y[0]), q);
+    sp.c[0] = _mm512_setzero_pd();
+    sp.d[0] = q;
+    sp.b[1] = _mm512_sub_pd(_mm512_sub_pd(sp.y[2], sp.y[1]), _mm512_mul_pd(s, _mm512_set1_pd(0.5)));
+    sp.c[1] = _mm512_mul_pd(s, _mm512_set1_pd(0.75));
+    sp.d[1] = _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(q), _mm512_castpd_si512(_mm512_set1_pd(-0.))));
+
+    __m512d ymax = sp.y[1];
+    __m512d xmax = sp.x[1];
+    __mmask8 larger = _mm512_cmp_pd_mask(sp.y[0], ymax, _CMP_GT_OQ);
+    ymax = _mm512_mask_blend_pd(larger, ymax, sp.y[0]);
+    xmax = _mm512_mask_blend_pd(larger, xmax, round_to_float_avx512(sp.x[0]));
+    larger = _mm512_cmp_pd_mask(sp.y[2], ymax, _CMP_GT_OQ);
+    ymax = _mm512_mask_blend_pd(larger, ymax, sp.y[2]);
+    xmax = _mm512_mask_blend_pd(larger, xmax, round_to_float_avx512(sp.x[2]));
+
+    const __m512d zero = _mm512_setzero_pd();
+    const __m512i sign = _mm512_castpd_si512(_mm512_set1_pd(-0.));
+    for (int i = 0; i <= 1; i++)
+    {
+      // quadratic: -b / (2c) if c < 0
+      const __mmask8 quadratic = _mm512_cmp_pd_mask(sp.d[i], zero, _CMP_EQ_OQ) & _mm512_cmp_pd_mask(sp.c[i], zero, _CMP_LT_OQ);
+      const __m512d minusb = _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(sp.b[i]), sign));
+      const __m512d root = _mm512_add_pd(_mm512_div_pd(minusb, _mm512_mul_pd(_mm512_set1_pd(2), sp.c[i])), sp.x[i]);
+      spline_candidate_avx512(sp, i, quadratic, root, xmax, ymax);
+
+      // cubic: zeros of the derivative
+      const __mmask8 cubic = _mm512_cmp_pd_mask(sp.d[i], zero, _CMP_NEQ_UQ);
+      const __m512d sqrtdelta = _mm512_sqrt_pd(_mm512_sub_pd(_mm512_mul_pd(_mm512_mul_pd(_mm512_set1_pd(4), sp.c[i]), sp.c[i]),
+                                                             _mm512_mul_pd(_mm512_mul_pd(_mm512_set1_pd(12), sp.b[i]), sp.d[i])));
+      const __m512d minus2c = _mm512_mul_pd(_mm512_set1_pd(-2), sp.c[i]);
+      const __m512d sixd = _mm512_mul_pd(_mm512_set1_pd(6), sp.d[i]);
+      spline_candidate_avx512(sp, i, cubic, _mm512_add_pd(_mm512_div_pd(_mm512_add_pd(minus2c, sqrtdelta), sixd), sp.x[i]), xmax, ymax);
+      spline_candidate_avx512(sp, i, cubic, _mm512_add_pd(_mm512_div_pd(_mm512_sub_pd(minus2c, sqrtdelta), sixd), sp.x[i]), xmax, ymax);
+    }
+    xmaxf = _mm512_cvtpd_ps(xmax);
+    ymaxf = _mm512_cvtpd_ps(ymax);
+  }
+
+  __attribute__((target("avx512f"))) void fast_peak_avx512(const float *block, unsigned int nsamples, float *peak_sample, float *time, float *amplitude)
+  {
+    constexpr unsigned int W = 16;
+    __m512 max = _mm512_loadu_ps(block);
+    __m512 maxx = _mm512_setzero_ps();
+    for (unsigned int n = 1; n < nsamples; ++n)
+    {
+      const __m512 v = _mm512_loadu_ps(block + n * W);
+      const __mmask16 larger = _mm512_cmp_ps_mask(v, max, _CMP_GT_OQ);
+      max = _mm512_mask_blend_ps(larger, max, v);
+      maxx = _mm512_mask_blend_ps(larger, maxx, _mm512_set1_ps(n));
+    }
+
+    // neighbours of the maximum
+    const __m512 before = _mm512_sub_ps(maxx, _mm512_set1_ps(1));
+    const __m512 after = _mm512_add_ps(maxx, _mm512_set1_ps(1));
+    __m512 y0 = _mm512_setzero_ps();
+    __m512 y2 = _mm512_setzero_ps();
+    for (unsigned int n = 0; n < nsamples; ++n)
+    {
+      const __m512 v = _mm512_loadu_ps(block + n * W);
+      const __m512 position = _mm512_set1_ps(n);
+      y0 = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(before, position, _CMP_EQ_OQ), y0, v);
+      y2 = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(after, position, _CMP_EQ_OQ), y2, v);
+    }
+
+    _mm512_storeu_ps(peak_sample, maxx);
+    __m512 xmax = maxx;
+    __m512 ymax = max;
+
+    // maxima on the first or last sample are not refined
+    const __mmask16 refine = _mm512_cmp_ps_mask(maxx, _mm512_setzero_ps(), _CMP_GT_OQ) & _mm512_cmp_ps_mask(maxx, _mm512_set1_ps(nsamples - 1), _CMP_LT_OQ);
+    if (refine)
+    {
+      __m256 xlow;
+      __m256 ylow;
+      __m256 xhigh;
+      __m256 yhigh;
+      fast_max_avx512(low_avx512(maxx), low_avx512(y0), low_avx512(max), low_avx512(y2), xlow, ylow);
+      fast_max_avx512(high_avx512(maxx), high_avx512(y0), high_avx512(max), high_avx512(y2), xhigh, yhigh);
+      xmax = _mm512_mask_blend_ps(refine, xmax, combine_avx512(xlow, xhigh));
+      ymax = _mm512_mask_blend_ps(refine, ymax, combine_avx512(ylow, yhigh));
+    }
+    _mm512_storeu_ps(time, xmax);
+    _mm512_storeu_ps(amplitude, ymax);
+  }
+
+  __attribute__((target("avx512f"))) inline __m256 psinc_term_avx512(__m256 sum, __m256 v, __m256i index, const NyquistTable &table)
+  {
+    const __m512d sine = _mm512_i32gather_pd(index, table.m_sine.data(), 8);
+    const __m512d denominator = _mm512_i32gather_pd(index, table.m_denominator.data(), 8);
+    __m512d term = _mm512_div_pd(_mm512_mul_pd(_mm512_cvtps_pd(v), sine), denominator);
+    term = _mm512_div_pd(term, _mm512_set1_pd(table.m_N));
+    return _mm512_cvtpd_ps(_mm512_add_pd(_mm512_cvtps_pd(sum), term));
+  }
+
+  __attribute__((target("avx512f"))) __m512 psinc_avx512(__m512 t, const float *block, const NyquistTable &table)
+  {
+    constexpr int W = 16;
+    const __m512 offset = _mm512_set1_ps(table.m_N);
+    const __m512 grid = _mm512_set1_ps(nyquist_grid);
+    __m256 low = _mm256_setzero_ps();
+    __m256 high = _mm256_setzero_ps();
+    for (int n = 0; n < table.m_N; n++)
+    {
+      const __m512 d = _mm512_sub_ps(t, _mm512_set1_ps(n));
+      const __m512i index = _mm512_cvttps_epi32(_mm512_mul_ps(_mm512_add_ps(d, offset), grid));
+      const __m512 v = _mm512_loadu_ps(block + n * W);
+      low = psinc_term_avx512(low, low_avx512(v), _mm512_castsi512_si256(index), table);
+      high = psinc_term_avx512(high, high_avx512(v), _mm512_extracti64x4_epi64(index, 1), table);
+    }
+    return combine_avx512(low, high);
+  }
+
+  __attribute__((target("avx512f"))) void nyquist_peak_avx512(const float *block, const NyquistTable &table, float *time, float *amplitude)
+  {
+    constexpr int W = 16;
+    __m512 max = _mm512_loadu_ps(block);
+    __m512 maxpos = _mm512_setzero_ps();
+    for (int n = 1; n < table.m_N; ++n)
+    {
+      const __m512 v = _mm512_loadu_ps(block + n * W);
+      const __mmask16 larger = _mm512_cmp_ps_mask(v, max, _CMP_GT_OQ);
+      max = _mm512_mask_blend_ps(larger, max, v);
+      maxpos = _mm512_mask_blend_ps(larger, maxpos, _mm512_set1_ps(n));
+    }
+
+    for (float step = 0.5; step > 0.001; step /= 2)
+    {
+      const __m512 center = maxpos;
+      const __m512 left = _mm512_sub_ps(center, _mm512_set1_ps(step));
+      __m512 yval = psinc_avx512(left, block, table);
+      __mmask16 larger = _mm512_cmp_ps_mask(yval, max, _CMP_GT_OQ);
+      max = _mm512_mask_blend_ps(larger, max, yval);
+      maxpos = _mm512_mask_blend_ps(larger, maxpos, left);
+
+      const __m512 right = _mm512_add_ps(center, _mm512_set1_ps(step));
+      yval = psinc_avx512(right, block, table);
+      larger = _mm512_cmp_ps_mask(yval, max, _CMP_GT_OQ);
+      max = _mm512_mask_blend_ps(larger, max, yval);
+      maxpos = _mm512_mask_blend_ps(larger, maxpos, right);
+    }
+    _mm512_storeu_ps(time, maxpos);
+    _mm512_storeu_ps(amplitude, max);
+  }
+  //@}
+#pragma GCC diagnostic pop
+#endif
+
+  CaloWaveformKernels::Isa detect_isa()
+  {
+#ifdef CALOWAVEFORMKERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+    {
+      return CaloWaveformKernels::Isa::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2"))
+    {
+      return CaloWaveformKernels::Isa::AVX2;
+    }
+#endif
+    return CaloWaveformKernels::Isa::SCALAR;
+  }
+
+  CaloWaveformKernels::Isa supported_isa()
+  {
+    static const CaloWaveformKernels::Isa value = detect_isa();
+    return value;
+  }
+
+  std::atomic<int> &selected_isa()
+  {
+    static std::atomic<int> value{static_cast<int>(supported_isa())};
+    return value;
+  }
+}  // namespace
+
+CaloWaveformKernels::Isa CaloWaveformKernels::isa()
+{
+  return static_cast<Isa>(selected_isa().load(std::memory_order_relaxed));
+}
+
+void CaloWaveformKernels::set_isa(Isa value)
+{
+  selected_isa().store(std::min(static_cast<int>(value), static_cast<int>(supported_isa())), std::memory_order_relaxed);
+}
+
+const char *CaloWaveformKernels::isa_name(Isa value)
+{
+  switch (value)
+  {
+  case Isa::AVX2:
+    return "AVX2";
+  case Isa::AVX512:
+    return "AVX-512";
+  default:
+    return "scalar";
+  }
+}
+
+unsigned int CaloWaveformKernels::lanes(Isa value)
+{
+  switch (value)
+  {
+  case Isa::AVX2:
+    return 8;
+  case Isa::AVX512:
+    return 16;
+  default:
+    return 1;
+  }
+}
+
+void CaloWaveformKernels::fast_peak(const float *samples, std::size_t stride, unsigned int nsamples,
+                                    const unsigned int *channels, std::size_t nchannels,
+                                    int *peak_sample, float *time, float *amplitude)
+{
+  if (nchannels == 0)
+  {
+    return;
+  }
+#ifdef CALOWAVEFORMKERNELS_X86
+  switch (isa())
+  {
+  case Isa::AVX512:
+    fast_peak_vector<16>(samples, stride, nsamples, channels, nchannels, peak_sample, time, amplitude, fast_peak_avx512);
+    return;
+  case Isa::AVX2:
+    fast_peak_vector<8>(samples, stride, nsamples, channels, nchannels, peak_sample, time, amplitude, fast_peak_avx2);
+    return;
+  default:
+    break;
+  }
+#endif
+  for (std::size_t i = 0; i < nchannels; ++i)
+  {
+    const unsigned int ich = channels[i];
+    fast_peak_scalar(samples + ich * stride, nsamples, peak_sample[ich], time[ich], amplitude[ich]);
+  }
+}
+
+void CaloWaveformKernels::fast_max(float x1, float y0, float y1, float y2, float &xmax, float &ymax)
+{
+  const Spline sp(x1, y0, y1, y2);
+  ymax = y1;
+  xmax = x1;
+  if (y0 > ymax)
+  {
+    ymax = y0;
+    xmax = sp.m_x[0];
+  }
+  if (y2 > ymax)
+  {
+    ymax = y2;
+    xmax = sp.m_x[2];
+  }
+
+  auto candidate = [&](int i, float root)
+  {
+    if (root >= sp.m_x[i] && root <= sp.m_x[i + 1])
+    {
+      const float yvalue = sp.eval(root);
+      if (yvalue > ymax)
+      {
+        ymax = yvalue;
+        xmax = root;
+      }
+    }
+  };
+
+  for (int i = 0; i <= 1; i++)
+  {
+    const double B = sp.m_b[i];
+    const double C = sp.m_c[i];
+    const double D = sp.m_d[i];
+    const double X = sp.m_x[i];
+    if (D == 0)
+    {
+      if (C < 0)
+      {
+        // the spline is a quadratic equation
+        candidate(i, (-B / (2 * C)) + X);
+      }
+    }
+    else
+    {
+      // find x when derivative = 0
+      candidate(i, ((-2 * C + std::sqrt((4 * C * C) - (12 * B * D))) / (6 * D)) + X);
+      candidate(i, ((-2 * C - std::sqrt((4 * C * C) - (12 * B * D))) / (6 * D)) + X);
+    }
+  }
+}
+
+void CaloWaveformKernels::nyquist_peak(const float *samples, std::size_t stride, unsigned int nsamples,
+                                       const unsigned int *channels, std::size_t nchannels,
+                                       float *time, float *amplitude)
+{
+  if (nchannels == 0)
+  {
+    return;
+  }
+  const NyquistTable &table = nyquist_table(nsamples);
+#ifdef CALOWAVEFORMKERNELS_X86
+  switch (isa())
+  {
+  case Isa::AVX512:
+    nyquist_peak_vector<16>(samples, stride, table, channels, nchannels, time, amplitude, nyquist_peak_avx512);
+    return;
+  case Isa::AVX2:
+    nyquist_peak_vector<8>(samples, stride, table, channels, nchannels, time, amplitude, nyquist_peak_avx2);
+    return;
+  default:
+    break;
+  }
+#endif
+  for (std::size_t i = 0; i < nchannels; ++i)
+  {
+    const unsigned int ich = channels[i];
+    nyquist_peak_scalar(samples + ich * stride, table, time[ich], amplitude[ich]);
+  }
+}
+
+// for odd N
+double CaloWaveformKernels::Dkernelodd(double x, int N)
+{
+  double sum = 0;
+  for (int k = 0; k < (N + 1) / 2; k++)
+  {
+    sum += 2 * std::cos(2 * M_PI * k * x / N);
+  }
+  sum -= 1;
+  sum = sum / N;
+  return sum;
+}
+
+// for even N
+double CaloWaveformKernels::Dkernel(double x, int N)
+{
+  double sum = 0;
+  for (int k = 0; k < N / 2; k++)
+  {
+    sum += 2 * std::cos(2 * M_PI * k * x / N);
+  }
+  sum -= 1;
+  sum += std::cos(M_PI * x);
+  sum = sum / N;
+  return sum;
+}
+
+float CaloWaveformKernels::stablepsinc(float time, const float *vec_signal_samples, int N)
+{
+  float sum = 0;
+  if (N % 2 == 0)
+  {
+    for (int n = 0; n < N; n++)
+    {
+      sum += vec_signal_samples[n] * Dkernel(time - n, N);
+    }
+  }
+  else
+  {
+    for (int n = 0; n < N; n++)
+    {
+      sum += vec_signal_samples[n] * Dkernelodd(time - n, N);
+    }
+  }
+  return sum;
+}
+
+float CaloWaveformKernels::psinc(float time, const float *vec_signal_samples, int N)
+{
+  if (std::abs(std::round(time) - time) < 1e-6)
+  {
+    if (time < 0 || time >= N)
+    {
+      return stablepsinc(time, vec_signal_samples, N);
+    }
+
+    return vec_signal_samples[(int) std::round(time)];
+  }
+
+  float sum = 0;
+  if (N % 2 == 0)
+  {
+    for (int n = 0; n < N; n++)
+    {
+      double piu = M_PI * (time - n);
+      double piuN = piu / N;
+      sum += vec_signal_samples[n] * std::sin(piu) / (std::tan(piuN)) / N;
+    }
+  }
+  else
+  {
+    for (int n = 0; n < N; n++)
+    {
+      double piu = M_PI * (time - n);
+      double piuN = piu / N;
+      sum += vec_signal_samples[n] * std::sin(piu) / (std::sin(piuN)) / N;
+    }
+  }
+
+  return sum;
+}
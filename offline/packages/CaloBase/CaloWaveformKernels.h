@@ -0,0 +1,70 @@
+#ifndef CALOBASE_CALOWAVEFORMKERNELS_H
+#define CALOBASE_CALOWAVEFORMKERNELS_H
+
+#include <cstddef>
+
+/** Peak finding of sampled waveforms, shared by the calorimeter (CaloWaveformFitting)
+ *  and MBD (MbdSig) waveform processing.
+ *
+ *  The batched kernels process a list of channels of a sample matrix (one row of
+ *  stride floats per channel), all with the same number of samples. Depending on
+ *  the cpu, 8 (AVX2) or 16 (AVX-512) channels are processed together, with a scalar
+ *  fallback. All implementations give bit identical results.
+ *  Results are stored at the channel index, i.e. output arrays must hold the largest
+ *  listed channel index.
+ */
+namespace CaloWaveformKernels
+{
+  enum class Isa
+  {
+    SCALAR = 0,
+    AVX2 = 1,
+    AVX512 = 2
+  };
+
+  //! instruction set used by the batched kernels, the best supported by the cpu unless lowered with set_isa
+  Isa isa();
+
+  //! select the instruction set, e.g. to compare with the scalar kernels. Lowered to what the cpu supports
+  void set_isa(Isa value);
+
+  const char *isa_name(Isa value);
+
+  //! number of channels processed together
+  unsigned int lanes(Isa value);
+
+  /** maximum sample (first one on ties), refined by the natural cubic spline through the
+   *  maximum and its two neighbours when the maximum is not on the first or last sample.
+   *  nsamples must be at least 3
+   */
+  void fast_peak(const float *samples, std::size_t stride, unsigned int nsamples,
+                 const unsigned int *channels, std::size_t nchannels,
+                 int *peak_sample, float *time, float *amplitude);
+
+  /** maximum of the natural cubic spline through (x1-1, y0), (x1, y1), (x1+1, y2),
+   *  or the largest of the three points if larger
+   */
+  void fast_max(float x1, float y0, float y1, float y2, float &xmax, float &ymax);
+
+  /** maximum of the periodic sinc interpolation of the samples, found by bisection
+   *  around the maximum sample down to 1/512 sample.
+   *  nsamples must be at least 3
+   */
+  void nyquist_peak(const float *samples, std::size_t stride, unsigned int nsamples,
+                    const unsigned int *channels, std::size_t nchannels,
+                    float *time, float *amplitude);
+
+  //! periodic sinc (Whittaker-Shannon) interpolation of N samples at time t
+  float psinc(float t, const float *samples, int N);
+
+  //! same as psinc using the Dirichlet kernel, stable for integer t
+  float stablepsinc(float t, const float *samples, int N);
+
+  //! Dirichlet kernel for even N
+  double Dkernel(double x, int N);
+
+  //! Dirichlet kernel for odd N
+  double Dkernelodd(double x, int N);
+}  // namespace CaloWaveformKernels
+
+#endif
@@ -0,0 +1,139 @@
+/**
+ * @file CaloBase/CaloWaveformKernelsBenchmark.cc
+ * @brief throughput of the CaloWaveformKernels peak finding for each supported instruction set
+ *
+ * usage: CaloWaveformKernelsBenchmark [samples per channel] [channels per event] [events]
+ * Waveforms are generated (pulse on a pedestal with noise), 12 samples and
+ * 24576 channels (EMCal) by default. Results of the vector kernels are compared
+ * bit by bit with the scalar ones
+ */
+#include "CaloWaveformKernels.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+  using clock_type = std::chrono::high_resolution_clock;
+
+  struct Results
+  {
+    std::vector<int> peak_sample;
+    std::vector<float> fast_time;
+    std::vector<float> fast_amplitude;
+    std::vector<float> nyquist_time;
+    std::vector<float> nyquist_amplitude;
+  };
+
+  std::vector<float> generate(unsigned int nsamples, std::size_t nchannels)
+  {
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> uniform(0, 1);
+    std::normal_distribution<float> noise(0, 3);
+    std::vector<float> samples(nsamples * nchannels);
+    for (std::size_t ich = 0; ich < nchannels; ++ich)
+    {
+      const float t0 = 2 + uniform(generator) * (nsamples - 6);
+      const float amplitude = 2000 * uniform(generator);
+      for (unsigned int n = 0; n < nsamples; ++n)
+      {
+        const float x = n - t0;
+        const float signal = (x > 0) ? amplitude * std::pow(x, 4) * std::exp(-1.5 * x) / 20 : 0;
+        samples[ich * nsamples + n] = std::round(1500 + signal + noise(generator));
+      }
+    }
+    return samples;
+  }
+
+  // run both kernels on all events, returns the time spent in each, in s
+  void run(const std::vector<float> &samples, unsigned int nsamples, const std::vector<unsigned int> &channels, int nevents, Results &results, double &fast, double &nyquist)
+  {
+    const std::size_t nchannels = channels.size();
+    results.peak_sample.assign(nchannels, 0);
+    results.fast_time.assign(nchannels, 0);
+    results.fast_amplitude.assign(nchannels, 0);
+    results.nyquist_time.assign(nchannels, 0);
+    results.nyquist_amplitude.assign(nchannels, 0);
+
+    auto start = clock_type::now();
+    for (int ievent = 0; ievent < nevents; ++ievent)
+    {
+      CaloWaveformKernels::fast_peak(samples.data(), nsamples, nsamples, channels.data(), nchannels,
+                                     results.peak_sample.data(), results.fast_time.data(), results.fast_amplitude.data());
+    }
+    fast = std::chrono::duration<double>(clock_type::now() - start).count();
+
+    start = clock_type::now();
+    for (int ievent = 0; ievent < nevents; ++ievent)
+    {
+      CaloWaveformKernels::nyquist_peak(samples.data(), nsamples, nsamples, channels.data(), nchannels,
+                                        results.nyquist_time.data(), results.nyquist_amplitude.data());
+    }
+    nyquist = std::chrono::duration<double>(clock_type::now() - start).count();
+  }
+
+  template <class T>
+  bool identical(const std::vector<T> &a, const std::vector<T> &b)
+  {
+    return std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0;
+  }
+}  // namespace
+
+int main(int argc, char **argv)
+{
+  const unsigned int nsamples = (argc > 1) ? std::atoi(argv[1]) : 12;
+  const std::size_t nchannels = (argc > 2) ? std::atoi(argv[2]) : 24576;
+  const int nevents = (argc > 3) ? std::atoi(argv[3]) : 20;
+  if (nsamples < 7 || nchannels == 0 || nevents <= 0)
+  {
+    std::cout << "usage: CaloWaveformKernelsBenchmark [samples per channel (>= 7)] [channels per event] [events]" << std::endl;
+    return 1;
+  }
+
+  const auto samples = generate(nsamples, nchannels);
+  std::vector<unsigned int> channels(nchannels);
+  for (std::size_t ich = 0; ich < nchannels; ++ich)
+  {
+    channels[ich] = ich;
+  }
+
+  std::cout << "CaloWaveformKernelsBenchmark - " << nsamples << " samples, " << nchannels << " channels, " << nevents << " events" << std::endl;
+  const auto best = CaloWaveformKernels::isa();
+  Results reference;
+  for (int value = 0; value <= static_cast<int>(best); ++value)
+  {
+    const auto isa = static_cast<CaloWaveformKernels::Isa>(value);
+    CaloWaveformKernels::set_isa(isa);
+
+    Results results;
+    double fast = 0;
+    double nyquist = 0;
+    run(samples, nsamples, channels, nevents, results, fast, nyquist);
+
+    const double nprocessed = static_cast<double>(nchannels) * nevents;
+    std::cout << CaloWaveformKernels::isa_name(isa) << " (" << CaloWaveformKernels::lanes(isa) << " channels per instruction):"
+              << " fast " << nprocessed / fast << " channels/s,"
+              << " nyquist " << nprocessed / nyquist << " channels/s";
+    if (isa == CaloWaveformKernels::Isa::SCALAR)
+    {
+      reference = results;
+    }
+    else
+    {
+      const bool same = identical(results.peak_sample, reference.peak_sample) &&
+                        identical(results.fast_time, reference.fast_time) &&
+                        identical(results.fast_amplitude, reference.fast_amplitude) &&
+                        identical(results.nyquist_time, reference.nyquist_time) &&
+                        identical(results.nyquist_amplitude, reference.nyquist_amplitude);
+      std::cout << (same ? ", identical to scalar" : ", DIFFERENT from scalar");
+    }
+    std::cout << std::endl;
+  }
+  CaloWaveformKernels::set_isa(best);
+  return 0;
+}
@@ -34,6 +34,7 @@
 
 #include <TSystem.h>
 
+#include <algorithm>
 #include <climits>
 #include <iostream>  // for operator<<, endl, basic...
 #include <memory>    // for allocator_traits<>::val...
@@ -184,13 +185,12 @@ int CaloTowerBuilder::InitRun(PHCompositeNode *topNode)
 
 int CaloTowerBuilder::process_sim()
 {
-  std::vector<std::vector<float>> waveforms;
+  CaloWaveformBatch &waveforms = m_waveforms;
+  waveforms.clear(m_nsamples);
 
   for (int ich = 0; ich < (int) m_CalowaveformContainer->size(); ich++)
   {
     TowerInfo *towerinfo = m_CalowaveformContainer->get_tower_at_channel(ich);
-    std::vector<float> waveform;
-    waveform.reserve(m_nsamples);
     bool fillwaveform = true;
     // get key
     if (m_dotbtszs)
@@ -204,64 +204,56 @@ int CaloTowerBuilder::process_sim()
       {
         // zero suppressed
         fillwaveform = false;
-        waveform.push_back(pre);
-        waveform.push_back(post);
+        float *waveform = waveforms.add_channel(2);
+        waveform[0] = pre;
+        waveform[1] = post;
       }
     }
     if (fillwaveform)
     {
+      float *waveform = waveforms.add_channel(m_nsamples);
       for (int samp = 0; samp < m_nsamples; samp++)
       {
-        waveform.push_back(towerinfo->get_waveform_value(samp));
+        waveform[samp] = towerinfo->get_waveform_value(samp);
       }
     }
-    waveforms.push_back(waveform);
-    waveform.clear();
   }
 
-  std::vector<std::vector<float>> processed_waveforms = WaveformProcessing->process_waveform(waveforms);
-  int n_channels = processed_waveforms.size();
+  WaveformProcessing->process_waveform(waveforms);
+  int n_channels = waveforms.size();
   for (int i = 0; i < n_channels; i++)
   {
     // this is for copying the truth info to the downstream object
     TowerInfo *towerwaveform = m_CalowaveformContainer->get_tower_at_channel(i);
     TowerInfo *towerinfo = m_CaloInfoContainer->get_tower_at_channel(i);
     towerinfo->copy_tower(towerwaveform);
-    towerinfo->set_time(processed_waveforms.at(i).at(1));
-    towerinfo->set_energy(processed_waveforms.at(i).at(0));
-    towerinfo->set_time(processed_waveforms.at(i).at(1));
-    towerinfo->set_pedestal(processed_waveforms.at(i).at(2));
-    towerinfo->set_chi2(processed_waveforms.at(i).at(3));
-    bool SZS = isSZS(processed_waveforms.at(i).at(1), processed_waveforms.at(i).at(3));
-    if (processed_waveforms.at(i).at(4) == 0)
-    {
-      towerinfo->set_isRecovered(false);
-    }
-    else
-    {
-      towerinfo->set_isRecovered(true);
-    }
-    towerinfo->set_FitStatus(static_cast<bool>(processed_waveforms.at(i).at(5)));
-    int n_samples = waveforms.at(i).size();
+    towerinfo->set_energy(waveforms.amplitude(i));
+    towerinfo->set_time(waveforms.time(i));
+    towerinfo->set_pedestal(waveforms.pedestal(i));
+    towerinfo->set_chi2(waveforms.chi2(i));
+    bool SZS = isSZS(waveforms.time(i), waveforms.chi2(i));
+    towerinfo->set_isRecovered(waveforms.recovered(i));
+    towerinfo->set_FitStatus(static_cast<bool>(waveforms.status(i)));
+    int n_samples = waveforms.nsamples(i);
     if (n_samples == m_nzerosuppsamples || SZS)
     {
       towerinfo->set_isZS(true);
     }
+    const float *samples = waveforms.samples(i);
     for (int j = 0; j < n_samples; j++)
     {
-      towerinfo->set_waveform_value(j, waveforms.at(i).at(j));
-      if (std::round(waveforms.at(i).at(j)) >= m_saturation)
+      towerinfo->set_waveform_value(j, samples[j]);
+      if (std::round(samples[j]) >= m_saturation)
       {
         towerinfo->set_isSaturated(true);
       }
     }
   }
-  waveforms.clear();
 
   return Fun4AllReturnCodes::EVENT_OK;
 }
 
-int CaloTowerBuilder::process_data(PHCompositeNode *topNode, std::vector<std::vector<float>> &waveforms)
+int CaloTowerBuilder::process_data(PHCompositeNode *topNode, CaloWaveformBatch &waveforms)
 {
   std::variant<CaloPacketContainer *, Event *> event;
   if (m_UseOfflinePacketFlag)
@@ -317,13 +309,7 @@ int CaloTowerBuilder::process_data(PHCompositeNode *topNode, std::vector<std::ve
           {
             continue;
           }
-          std::vector<float> waveform;
-          waveform.reserve(m_nzerosuppsamples);
-          for (int samp = 0; samp < m_nzerosuppsamples; samp++)
-          {
-            waveform.push_back(-1);
-          }
-          waveforms.push_back(waveform);
+          std::fill_n(waveforms.add_channel(m_nzerosuppsamples), m_nzerosuppsamples, -1);
         }
         return Fun4AllReturnCodes::EVENT_OK;
       }
@@ -358,36 +344,26 @@ int CaloTowerBuilder::process_data(PHCompositeNode *topNode, std::vector<std::ve
               for (int iskip = 0; iskip < 64; iskip++)
               {
                 n_pad_skip_mask++;
-                std::vector<float> waveform;
-                waveform.reserve(m_nsamples);
-
-                for (int samp = 0; samp < m_nzerosuppsamples; samp++)
-                {
-                  waveform.push_back(0);
-                }
-                waveforms.push_back(waveform);
-                waveform.clear();
+                std::fill_n(waveforms.add_channel(m_nzerosuppsamples), m_nzerosuppsamples, 0);
               }
             }
           }
         }
 
-        std::vector<float> waveform;
-        waveform.reserve(m_nsamples);
         if (packet->iValue(channel, "SUPPRESSED"))
         {
-          waveform.push_back(packet->iValue(channel, "PRE"));
-          waveform.push_back(packet->iValue(channel, "POST"));
+          float *waveform = waveforms.add_channel(2);
+          waveform[0] = packet->iValue(channel, "PRE");
+          waveform[1] = packet->iValue(channel, "POST");
         }
         else
         {
+          float *waveform = waveforms.add_channel(m_nsamples);
           for (int samp = 0; samp < m_nsamples; samp++)
           {
-            waveform.push_back(packet->iValue(samp, channel));
+            waveform[samp] = packet->iValue(samp, channel);
           }
         }
-        waveforms.push_back(waveform);
-        waveform.clear();
       }
 
       int nch_padded = nchannels;
@@ -403,15 +379,7 @@ int CaloTowerBuilder::process_data(PHCompositeNode *topNode, std::vector<std::ve
           {
             continue;
           }
-          std::vector<float> waveform;
-          waveform.reserve(m_nsamples);
-
-          for (int samp = 0; samp < m_nzerosuppsamples; samp++)
-          {
-            waveform.push_back(0);
-          }
-          waveforms.push_back(waveform);
-          waveform.clear();
+          std::fill_n(waveforms.add_channel(m_nzerosuppsamples), m_nzerosuppsamples, 0);
         }
       }
     }
@@ -423,14 +391,8 @@ int CaloTowerBuilder::process_data(PHCompositeNode *topNode, std::vector<std::ve
         {
           continue;
         }
-        std::vector<float> waveform;
-        waveform.reserve(2);
-        for (int samp = 0; samp < m_nzerosuppsamples; samp++)
-        {
-          waveform.push_back(-1);  // push back -1 for missing packets
-        }
-        waveforms.push_back(waveform);
-        waveform.clear();
+        // -1 for missing packets
+        std::fill_n(waveforms.add_channel(m_nzerosuppsamples), m_nzerosuppsamples, -1);
       }
     }
     return Fun4AllReturnCodes::EVENT_OK;
@@ -476,7 +438,8 @@ int CaloTowerBuilder::process_event(PHCompositeNode *topNode)
   {
     return process_sim();
   }
-  std::vector<std::vector<float>> waveforms;
+  CaloWaveformBatch &waveforms = m_waveforms;
+  waveforms.clear(m_nsamples);
   if (process_data(topNode, waveforms) == Fun4AllReturnCodes::ABORTEVENT)
   {
     return Fun4AllReturnCodes::ABORTEVENT;
@@ -487,9 +450,9 @@ int CaloTowerBuilder::process_event(PHCompositeNode *topNode)
   }
   // waveform vector is filled here, now fill our output. methods from the base class make sure
   // we only fill what the chosen container version supports
-  std::vector<std::vector<float>> processed_waveforms = WaveformProcessing->process_waveform(waveforms);
+  WaveformProcessing->process_waveform(waveforms);
 
-  int n_channels = processed_waveforms.size();
+  int n_channels = waveforms.size();
   for (int i = 0; i < n_channels; i++)
   {
     int idx = i;
@@ -499,26 +462,19 @@ int CaloTowerBuilder::process_event(PHCompositeNode *topNode)
       idx = cdbttree_sepd_map->GetIntValue(i, m_fieldname);
     }
     TowerInfo *towerinfo = m_CaloInfoContainer->get_tower_at_channel(i);
-    towerinfo->set_time(processed_waveforms.at(idx).at(1));
-    towerinfo->set_energy(processed_waveforms.at(idx).at(0));
-    towerinfo->set_time(processed_waveforms.at(idx).at(1));
-    towerinfo->set_pedestal(processed_waveforms.at(idx).at(2));
-    towerinfo->set_chi2(processed_waveforms.at(idx).at(3));
-    bool SZS = isSZS(processed_waveforms.at(idx).at(1), processed_waveforms.at(idx).at(3));
-
-    if (processed_waveforms.at(idx).at(4) == 0)
-    {
-      towerinfo->set_isRecovered(false);
-    }
-    else
-    {
-      towerinfo->set_isRecovered(true);
-    }
-    towerinfo->set_FitStatus(static_cast<bool>(processed_waveforms.at(idx).at(5)));
-    int n_samples = waveforms.at(idx).size();
+    towerinfo->set_energy(waveforms.amplitude(idx));
+    towerinfo->set_time(waveforms.time(idx));
+    towerinfo->set_pedestal(waveforms.pedestal(idx));
+    towerinfo->set_chi2(waveforms.chi2(idx));
+    bool SZS = isSZS(waveforms.time(idx), waveforms.chi2(idx));
+
+    towerinfo->set_isRecovered(waveforms.recovered(idx));
+    towerinfo->set_FitStatus(static_cast<bool>(waveforms.status(idx)));
+    int n_samples = waveforms.nsamples(idx);
+    const float *samples = waveforms.samples(idx);
     if (n_samples == m_nzerosuppsamples || SZS)
     {
-      if (waveforms.at(idx).at(0) == -1)
+      if (samples[0] == -1)
       {
         towerinfo->set_isNotInstr(true);
       }
@@ -530,14 +486,13 @@ int CaloTowerBuilder::process_event(PHCompositeNode *topNode)
 
     for (int j = 0; j < n_samples; j++)
     {
-      if (std::round(waveforms.at(idx).at(j)) >= m_saturation)
+      if (std::round(samples[j]) >= m_saturation)
       {
         towerinfo->set_isSaturated(true);
       }
-      towerinfo->set_waveform_value(j, waveforms.at(idx).at(j));
+      towerinfo->set_waveform_value(j, samples[j]);
     }
   }
-  waveforms.clear();
 
   return Fun4AllReturnCodes::EVENT_OK;
 }
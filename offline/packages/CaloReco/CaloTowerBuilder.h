@@ -4,6 +4,7 @@
 #define CALORECO_CALOTOWERBUILDER_H
 
 #include "CaloTowerDefs.h"
+#include "CaloWaveformBatch.h"
 #include "CaloWaveformProcessing.h"
 
 #include <cdbobjects/CDBTTree.h>  // for CDBTTree
@@ -29,7 +30,7 @@ public:
 
   void CreateNodeTree(PHCompositeNode *topNode);
 
-  int process_data(PHCompositeNode *topNode, std::vector<std::vector<float>> &waveforms);
+  int process_data(PHCompositeNode *topNode, CaloWaveformBatch &waveforms);
 
   void set_detector_type(CaloTowerDefs::DetectorSystem dettype)
   {
@@ -134,6 +135,7 @@ private:
   bool skipChannel(int ich, int pid);
   static bool isSZS(float time, float chi2);
   CaloWaveformProcessing *WaveformProcessing{nullptr};
+  CaloWaveformBatch m_waveforms;  // reused every event
   TowerInfoContainer *m_CaloInfoContainer{nullptr};      //! Calo info
   TowerInfoContainer *m_CalowaveformContainer{nullptr};  // waveform from simulation
   CDBTTree *cdbttree = nullptr;
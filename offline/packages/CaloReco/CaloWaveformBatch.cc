@@ -0,0 +1,75 @@
+#include "CaloWaveformBatch.h"
+
+#include <algorithm>
+#include <limits>
+
+void CaloWaveformBatch::clear(unsigned int max_samples)
+{
+  m_max_samples = max_samples;
+  m_samples.clear();
+  m_nsamples.clear();
+  m_amplitude.clear();
+  m_time.clear();
+  m_pedestal.clear();
+  m_chi2.clear();
+  m_recovered.clear();
+  m_status.clear();
+}
+
+float *CaloWaveformBatch::add_channel(unsigned int nsamples)
+{
+  if (nsamples > m_max_samples)
+  {
+    restride(nsamples);
+  }
+
+  const std::size_t ich = m_nsamples.size();
+  m_nsamples.push_back(nsamples);
+  m_samples.resize((ich + 1) * m_max_samples, 0);
+
+  // results are set by the processing, default to "not processed"
+  m_amplitude.push_back(0);
+  m_time.push_back(std::numeric_limits<float>::quiet_NaN());
+  m_pedestal.push_back(0);
+  m_chi2.push_back(std::numeric_limits<float>::quiet_NaN());
+  m_recovered.push_back(0);
+  m_status.push_back(0);
+  return samples(ich);
+}
+
+void CaloWaveformBatch::restride(unsigned int max_samples)
+{
+  std::vector<float> samples(m_nsamples.size() * max_samples, 0);
+  for (std::size_t ich = 0; ich < m_nsamples.size(); ++ich)
+  {
+    std::copy_n(m_samples.begin() + ich * m_max_samples, m_nsamples[ich], samples.begin() + ich * max_samples);
+  }
+  m_samples.swap(samples);
+  m_max_samples = max_samples;
+}
+
+void CaloWaveformBatch::fill(const std::vector<std::vector<float>> &waveforms)
+{
+  unsigned int max_samples = 0;
+  for (const auto &waveform : waveforms)
+  {
+    max_samples = std::max<unsigned int>(max_samples, waveform.size());
+  }
+
+  clear(max_samples);
+  for (const auto &waveform : waveforms)
+  {
+    std::copy(waveform.begin(), waveform.end(), add_channel(waveform.size()));
+  }
+}
+
+std::vector<std::vector<float>> CaloWaveformBatch::results() const
+{
+  std::vector<std::vector<float>> results;
+  results.reserve(size());
+  for (std::size_t ich = 0; ich < size(); ++ich)
+  {
+    results.push_back({m_amplitude[ich], m_time[ich], m_pedestal[ich], m_chi2[ich], static_cast<float>(m_recovered[ich]), static_cast<float>(m_status[ich])});
+  }
+  return results;
+}
@@ -0,0 +1,98 @@
+#ifndef CALORECO_CALOWAVEFORMBATCH_H
+#define CALORECO_CALOWAVEFORMBATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/** Waveforms of one event and their processing results, as structure of arrays.
+ *
+ *  Samples are stored in a contiguous n_channels x max_samples matrix, one row
+ *  per channel. Channels can have less samples than max_samples (zero suppressed
+ *  channels only have the pre and post samples), nsamples() gives the number
+ *  of valid samples of a row.
+ *  Results (amplitude, time, pedestal, chi2, bit flip recovery flag and fit
+ *  status) are stored in one array per quantity and filled by the
+ *  CaloWaveformProcessing back ends.
+ *
+ *  Memory is kept by clear(), so a batch reused event after event does not allocate.
+ */
+class CaloWaveformBatch
+{
+ public:
+  CaloWaveformBatch() = default;
+
+  //! remove all channels, set the row length of the sample matrix
+  void clear(unsigned int max_samples);
+
+  //! append a channel with nsamples samples, returns its samples to be filled
+  float *add_channel(unsigned int nsamples);
+
+  //! number of channels
+  std::size_t size() const { return m_nsamples.size(); }
+
+  bool empty() const { return m_nsamples.empty(); }
+
+  //! row length of the sample matrix
+  unsigned int max_samples() const { return m_max_samples; }
+
+  //! number of valid samples of a channel
+  unsigned int nsamples(std::size_t ich) const { return m_nsamples[ich]; }
+
+  //!@name samples of a channel
+  //@{
+  float *samples(std::size_t ich) { return m_samples.data() + ich * m_max_samples; }
+  const float *samples(std::size_t ich) const { return m_samples.data() + ich * m_max_samples; }
+  //@}
+
+  //!@name results
+  //@{
+  float amplitude(std::size_t ich) const { return m_amplitude[ich]; }
+  float time(std::size_t ich) const { return m_time[ich]; }
+  float pedestal(std::size_t ich) const { return m_pedestal[ich]; }
+  float chi2(std::size_t ich) const { return m_chi2[ich]; }
+  bool recovered(std::size_t ich) const { return m_recovered[ich]; }
+  int status(std::size_t ich) const { return m_status[ich]; }
+
+  //! store results of a channel. Different channels can be set concurrently
+  void set_result(std::size_t ich, float amplitude, float time, float pedestal, float chi2, bool recovered = false, int status = 0)
+  {
+    m_amplitude[ich] = amplitude;
+    m_time[ich] = time;
+    m_pedestal[ich] = pedestal;
+    m_chi2[ich] = chi2;
+    m_recovered[ich] = recovered;
+    m_status[ich] = status;
+  }
+  //@}
+
+  //!@name conversion from and to the per channel vectors used by the former interface
+  //@{
+  void fill(const std::vector<std::vector<float>> &waveforms);
+
+  //! amplitude, time, pedestal, chi2, recovered, status of each channel
+  std::vector<std::vector<float>> results() const;
+  //@}
+
+ private:
+  //! change the row length, keeping the stored samples
+  void restride(unsigned int max_samples);
+
+  unsigned int m_max_samples{0};
+
+  //! sample matrix
+  std::vector<float> m_samples;
+
+  //! valid samples per channel
+  std::vector<unsigned int> m_nsamples;
+
+  //! results
+  std::vector<float> m_amplitude;
+  std::vector<float> m_time;
+  std::vector<float> m_pedestal;
+  std::vector<float> m_chi2;
+  std::vector<uint8_t> m_recovered;
+  std::vector<int> m_status;
+};
+
+#endif
@@ -4,7 +4,6 @@
 #include <TFile.h>
 #include <TH1F.h>
 #include <TProfile.h>
-#include <TSpline.h>
 #include <TFitResult.h>
 
 #include <Fit/BinData.h>
@@ -14,16 +13,43 @@
 #include <HFitInterface.h>
 #include <Math/WrappedMultiTF1.h>
 #include <Math/WrappedTF1.h>
-#include <ROOT/TThreadExecutor.hxx>
-#include <ROOT/TThreadedObject.hxx>
 
-#include <pthread.h>
+#include <calobase/CaloWaveformKernels.h>
+
+#include <fun4all/Fun4AllServer.h>
+#include <fun4all/Fun4AllTaskScheduler.h>
+
+#include <TROOT.h>
+
 #include <algorithm>
+#include <cstddef>
 #include <iostream>
 #include <limits>
 #include <string>
+#include <vector>
+
+namespace
+{
+  /** channels with at least 3 samples, indexed by number of samples.
+   *  The vector kernels process channels with the same number of samples
+   */
+  void group_channels(const CaloWaveformBatch &batch, std::vector<std::vector<unsigned int>> &groups)
+  {
+    groups.resize(batch.max_samples() + 1);
+    for (auto &group : groups)
+    {
+      group.clear();
+    }
+    for (std::size_t m = 0; m < batch.size(); m++)
+    {
+      if (batch.nsamples(m) >= 3)
+      {
+        groups[batch.nsamples(m)].push_back(m);
+      }
+    }
+  }
+}  // namespace
 
-static ROOT::TThreadExecutor *t = new ROOT::TThreadExecutor(1);  // NOLINT(misc-use-anonymous-namespace)
 double CaloWaveformFitting::template_function(double *x, double *par)
 {
   Double_t v1 = (par[0] * h_template->Interpolate(x[0] - par[1])) + par[2];
@@ -45,41 +71,29 @@ void CaloWaveformFitting::initialize_processing(const std::string &templatefile)
   fin->Close();
   delete fin;
   m_peakTimeTemp = h_template->GetBinCenter(h_template->GetMaximumBin());
-  t = new ROOT::TThreadExecutor(_nthreads);
+  m_template_table = std::make_shared<CaloWaveformTemplateFitter::Table>(h_template);
 }
 
-std::vector<std::vector<float>> CaloWaveformFitting::process_waveform(std::vector<std::vector<float>> waveformvector)
+std::vector<std::vector<float>> CaloWaveformFitting::process_waveform(const std::vector<std::vector<float>> &waveformvector)
 {
-  int size1 = waveformvector.size();
-  std::vector<std::vector<float>> fitresults;
-  for (int i = 0; i < size1; i++)
-  {
-    waveformvector.at(i).push_back(i);
-  }
-  fitresults = calo_processing_templatefit(waveformvector);
-  return fitresults;
+  CaloWaveformBatch batch;
+  batch.fill(waveformvector);
+  calo_processing_templatefit(batch);
+  return batch.results();
 }
 
-std::vector<std::vector<float>> CaloWaveformFitting::calo_processing_templatefit(std::vector<std::vector<float>> chnlvector)
+void CaloWaveformFitting::calo_processing_templatefit(CaloWaveformBatch &batch)
 {
-  auto func = [&](std::vector<float> &v)
+  auto func = [&](std::size_t ich)
   {
-    int size1 = v.size() - 1;
+    const float *v = batch.samples(ich);
+    int size1 = batch.nsamples(ich);
     if (size1 == _nzerosuppresssamples)
     {
-      v.push_back(v.at(1) - v.at(0));                        // returns peak sample - pedestal sample
-      v.push_back(std::numeric_limits<float>::quiet_NaN());  // set time to qnan for ZS
-      v.push_back(v.at(0));
-      if (v.at(0) != 0 && v.at(1) == 0)  // check if post-sample is 0, if so set high chi2
-      {
-        v.push_back(1000000);
-      }
-      else
-      {
-        v.push_back(std::numeric_limits<float>::quiet_NaN());
-      }
-      v.push_back(0);
-      v.push_back(0);
+      // returns peak sample - pedestal sample, time is qnan for ZS
+      // check if post-sample is 0, if so set high chi2
+      const float chi2 = (v[0] != 0 && v[1] == 0) ? 1000000 : std::numeric_limits<float>::quiet_NaN();
+      batch.set_result(ich, v[1] - v[0], std::numeric_limits<float>::quiet_NaN(), v[0], chi2);
     }
     else
     {
@@ -87,111 +101,74 @@ std::vector<std::vector<float>> CaloWaveformFitting::calo_processing_templatefit
       int maxbin = 0;
       for (int i = 0; i < size1; i++)
       {
-        if (v.at(i) > maxheight)
+        if (v[i] > maxheight)
         {
-          maxheight = v.at(i);
+          maxheight = v[i];
           maxbin = i;
         }
       }
       float pedestal = 1500;
       if (maxbin > 4)
       {
-        pedestal = 0.5 * (v.at(maxbin - 4) + v.at(maxbin - 5));
+        pedestal = 0.5 * (v[maxbin - 4] + v[maxbin - 5]);
       }
       else if (maxbin > 3)
       {
-        pedestal = (v.at(maxbin - 4));
+        pedestal = (v[maxbin - 4]);
       }
       else
       {
-        pedestal = 0.5 * (v.at(size1 - 3) + v.at(size1 - 2));
+        pedestal = 0.5 * (v[size1 - 3] + v[size1 - 2]);
       }
 
-      if ((_bdosoftwarezerosuppression && v.at(6) - v.at(0) < _nsoftwarezerosuppression) || (_maxsoftwarezerosuppression && maxheight - pedestal < _nsoftwarezerosuppression))
+      if ((_bdosoftwarezerosuppression && v[6] - v[0] < _nsoftwarezerosuppression) || (_maxsoftwarezerosuppression && maxheight - pedestal < _nsoftwarezerosuppression))
       {
-        v.push_back(v.at(6) - v.at(0));
-        v.push_back(std::numeric_limits<float>::quiet_NaN());
-        v.push_back(v.at(0));
-        if (v.at(0) != 0 && v.at(1) == 0)  // check if post-sample is 0, if so set high chi2
-        {
-          v.push_back(1000000);
-        }
-        else
-        {
-          v.push_back(std::numeric_limits<float>::quiet_NaN());
-        }
-        v.push_back(0);
-        v.push_back(0);
+        // check if post-sample is 0, if so set high chi2
+        const float chi2 = (v[0] != 0 && v[1] == 0) ? 1000000 : std::numeric_limits<float>::quiet_NaN();
+        batch.set_result(ich, v[6] - v[0], std::numeric_limits<float>::quiet_NaN(), v[0], chi2);
       }
       else
       {
-        auto *h = new TH1F(std::string("h_" + std::to_string((int) round(v.at(size1)))).c_str(), "", size1, -0.5, size1 - 0.5);
-
-        int ndata = 0;
+        CaloWaveformTemplateFitter &fitter = *m_template_fitters[Fun4AllServer::instance()->TaskScheduler()->ThreadIndex()];
+        fitter.clear_data();
         for (int i = 0; i < size1; ++i)
         {
-          if ((v.at(i) == 16383) && _handleSaturation)
+          if ((v[i] == 16383) && _handleSaturation)
           {
             continue;
           }
-
-          h->SetBinContent(i + 1, v.at(i));
-          h->SetBinError(i + 1, 1);
-          ndata++;
+          fitter.add_data(i, v[i]);
         }
+        int ndata = fitter.ndata();
         // if too many are saturated don't do the saturation recovery need enough ndf
         if (ndata < (size1 - 4))
         {
           ndata = size1;
+          fitter.clear_data();
           for (int i = 0; i < size1; ++i)
           {
-            h->SetBinContent(i + 1, v.at(i));
-            h->SetBinError(i + 1, 1);
+            fitter.add_data(i, v[i]);
           }
         }
 
-        auto *f = new TF1(std::string("f_" + std::to_string((int) round(v.at(size1)))).c_str(), this, &CaloWaveformFitting::template_function, 0, 31, 3, "CaloWaveformFitting", "template_function");
-        ROOT::Math::WrappedMultiTF1 *fitFunction = new ROOT::Math::WrappedMultiTF1(*f, 3);
-        ROOT::Fit::BinData data(v.size() - 1, 1);
-        ROOT::Fit::FillData(data, h);
-        ROOT::Fit::Chi2Function *EPChi2 = new ROOT::Fit::Chi2Function(data, *fitFunction);
-        ROOT::Fit::Fitter *fitter = new ROOT::Fit::Fitter();
-        fitter->Config().MinimizerOptions().SetMinimizerType("GSLMultiFit");
-        fitter->Config().MinimizerOptions().SetPrintLevel(-1);
         double params[] = {static_cast<double>(maxheight - pedestal), static_cast<double>(maxbin - m_peakTimeTemp), static_cast<double>(pedestal)};
         // double params[] = {static_cast<double>(maxheight - pedestal), 0, static_cast<double>(pedestal)};
-        fitter->Config().SetParamsSettings(3, params);
-        fitter->Config().ParSettings(1).SetLimits(-1 * m_peakTimeTemp, size1 - m_peakTimeTemp);  // set lim on time par
+        double tmin = -1 * m_peakTimeTemp;  // set lim on time par
+        double tmax = size1 - m_peakTimeTemp;
         if (m_setTimeLim)
         {
-          fitter->Config().ParSettings(1).SetLimits(m_timeLim_low, m_timeLim_high);
+          tmin = m_timeLim_low;
+          tmax = m_timeLim_high;
         }
-        fitter->FitFCN(*EPChi2, nullptr, data.Size(), true);
-        ROOT::Fit::FitResult fitres = fitter->Result();
+        double chi2min = 0;
         // get the fit status code (0 means successful fit)
-        int validfit = fitres.Status();
-        /*
-        if(validfit != 0)
-        {
-          std::cout<<"invalid fit status in waveform fitting: " << validfit <<std::endl;
-          for (int i = 0; i < size1; ++i)
-        {
-          std::cout<<v.at(i) << " ";
-        }
-        std::cout<<std::endl;
-        }
-        */
-        double chi2min = fitres.MinFcnValue();
+        int validfit = fit_template(fitter, params, tmin, tmax, chi2min);
         // chi2min /= size1 - 3;  // divide by the number of dof
         chi2min /= ndata - 3;  // divide by the number of dof
-        if (chi2min > _chi2threshold && (f->GetParameter(2) < _bfr_highpedestalthreshold || pedestal < _bfr_highpedestalthreshold) && (f->GetParameter(2) > _bfr_lowpedestalthreshold || pedestal > _bfr_lowpedestalthreshold) && _dobitfliprecovery)
+        if (chi2min > _chi2threshold && (params[2] < _bfr_highpedestalthreshold || pedestal < _bfr_highpedestalthreshold) && (params[2] > _bfr_lowpedestalthreshold || pedestal > _bfr_lowpedestalthreshold) && _dobitfliprecovery)
         {
-          std::vector<float> rv;  // temporary recovered waveform
-          rv.reserve(size1);
-          for (int i = 0; i < size1; i++)
-          {
-            rv.push_back(v.at(i));
-          }
+          // temporary recovered waveform. The stored samples are not modified
+          std::vector<float> rv(v, v + size1);
           unsigned int bits[3] = {8192, 4096, 2048};
           for (auto bit : bits)
           {
@@ -203,10 +180,10 @@ std::vector<std::vector<float>> CaloWaveformFitting::calo_processing_templatefit
               }
             }
           }
+          fitter.clear_data();
           for (int i = 0; i < size1; i++)
           {
-            h->SetBinContent(i + 1, rv.at(i));
-            h->SetBinError(i + 1, 1);
+            fitter.add_data(i, rv.at(i));
           }
 
           maxheight = 0;
@@ -232,280 +209,181 @@ std::vector<std::vector<float>> CaloWaveformFitting::calo_processing_templatefit
             pedestal = 0.5 * (rv.at(size1 - 3) + rv.at(size1 - 2));
           }
 
-          auto *recover_f = new TF1(std::string("recover_f_" + std::to_string((int) round(v.at(size1)))).c_str(), this, &CaloWaveformFitting::template_function, 0, 31, 3, "CaloWaveformFitting", "template_function");
-          ROOT::Math::WrappedMultiTF1 *recoverFitFunction = new ROOT::Math::WrappedMultiTF1(*recover_f, 3);
-          ROOT::Fit::BinData recoverData(rv.size() - 1, 1);
-          ROOT::Fit::FillData(recoverData, h);
-          ROOT::Fit::Chi2Function *recoverEPChi2 = new ROOT::Fit::Chi2Function(recoverData, *recoverFitFunction);
-          ROOT::Fit::Fitter *recoverFitter = new ROOT::Fit::Fitter();
-          recoverFitter->Config().MinimizerOptions().SetMinimizerType("GSLMultiFit");
           double recover_params[] = {static_cast<double>(maxheight - pedestal), 0, static_cast<double>(pedestal)};
-          recoverFitter->Config().SetParamsSettings(3, recover_params);
-          recoverFitter->Config().ParSettings(1).SetLimits(-1 * m_peakTimeTemp, size1 - m_peakTimeTemp);  // set lim on time par
-          recoverFitter->FitFCN(*recoverEPChi2, nullptr, recoverData.Size(), true);
-          ROOT::Fit::FitResult recover_fitres = recoverFitter->Result();
-          int recover_validfit = recover_fitres.Status();
-          double recover_chi2min = recover_fitres.MinFcnValue();
+          double recover_chi2min = 0;
+          int recover_validfit = fit_template(fitter, recover_params, -1 * m_peakTimeTemp, size1 - m_peakTimeTemp, recover_chi2min);
           recover_chi2min /= size1 - 3;  // divide by the number of dof
-          if (recover_chi2min < _chi2lowthreshold && recover_f->GetParameter(2) < _bfr_highpedestalthreshold && recover_f->GetParameter(2) > _bfr_lowpedestalthreshold)
+          if (recover_chi2min < _chi2lowthreshold && recover_params[2] < _bfr_highpedestalthreshold && recover_params[2] > _bfr_lowpedestalthreshold)
           {
-            for (int i = 0; i < size1; i++)
-            {
-              v.at(i) = rv.at(i);
-            }
-            for (int i = 0; i < 3; i++)
-            {
-              v.push_back(recover_f->GetParameter(i));
-            }
-            v.push_back(recover_chi2min);
-            v.push_back(1);
-            v.push_back(recover_validfit);
+            batch.set_result(ich, recover_params[0], recover_params[1], recover_params[2], recover_chi2min, true, recover_validfit);
           }
           else
           {
-            for (int i = 0; i < 3; i++)
-            {
-              v.push_back(f->GetParameter(i));
-            }
-            v.push_back(chi2min);
-            v.push_back(0);
-            v.push_back(validfit);
+            batch.set_result(ich, params[0], params[1], params[2], chi2min, false, validfit);
           }
-          recover_f->Delete();
-          delete recoverFitFunction;
-          delete recoverFitter;
-          delete recoverEPChi2;
         }
         else
         {
-          for (int i = 0; i < 3; i++)
-          {
-            v.push_back(f->GetParameter(i));
-          }
-          v.push_back(chi2min);
-          v.push_back(0);
-          v.push_back(validfit);
+          batch.set_result(ich, params[0], params[1], params[2], chi2min, false, validfit);
         }
-        h->Delete();
-        f->Delete();
-        delete fitFunction;
-        delete fitter;
-        delete EPChi2;
       }
     }
   };
 
-  t->Foreach(func, chnlvector);
-  int size3 = chnlvector.size();
-  std::vector<std::vector<float>> fit_params;
-  std::vector<float> fit_params_tmp;
-  for (int i = 0; i < size3; i++)
+  // one fitter per thread, created once. The number of threads may change between events
+  Fun4AllTaskScheduler *scheduler = Fun4AllServer::instance()->TaskScheduler();
+  if (scheduler->NumThreads() > 1 && !m_root_thread_safety)
   {
-    const std::vector<float> &tv = chnlvector.at(i);
-    int size2 = tv.size();
-    for (int q = 6; q > 0; q--)
-    {
-      fit_params_tmp.push_back(tv.at(size2 - q));
-    }
-    fit_params.push_back(fit_params_tmp);
-    fit_params_tmp.clear();
+    // channels are fitted in parallel, the ROOT fits create objects from the worker threads
+    ROOT::EnableThreadSafety();
+    m_root_thread_safety = true;
+  }
+  while (m_template_fitters.size() < scheduler->NumThreads())
+  {
+    m_template_fitters.push_back(std::make_unique<CaloWaveformTemplateFitter>(m_template_table));
   }
-  chnlvector.clear();
-  return fit_params;
+
+  scheduler->parallel_for(0, batch.size(), func);
 }
 
-void CaloWaveformFitting::FastMax(float x0, float x1, float x2, float y0, float y1, float y2, float &xmax, float &ymax)
+int CaloWaveformFitting::fit_template(CaloWaveformTemplateFitter &fitter, double *par, double tmin, double tmax, double &chi2)
 {
-  int n = 3;
-  double xp[3] = {x0, x1, x2};
-  double yp[3] = {y0, y1, y2};
-  TSpline3 *sp = new TSpline3("", xp, yp, n, "b2e2", 0, 0);
-  double X;
-  double Y;
-  double B;
-  double C;
-  double D;
-  ymax = y1;
-  xmax = x1;
-  if (y0 > ymax)
+  if (!m_root_templatefit)
   {
-    ymax = y0;
-    xmax = x0;
+    int status = fitter.fit(par, tmin, tmax);
+    chi2 = fitter.chi2();
+    return status;
   }
-  if (y2 > ymax)
+
+  // reference implementation, same data points minimized with ROOT
+  // not registered in the global list of functions, fits run concurrently
+  TF1 f("f_template", this, &CaloWaveformFitting::template_function, 0, 31, 3, "CaloWaveformFitting", "template_function", TF1::EAddToList::kNo);
+  ROOT::Math::WrappedMultiTF1 fitFunction(f, 3);
+  ROOT::Fit::BinData data(fitter.ndata(), 1);
+  for (std::size_t i = 0; i < fitter.ndata(); ++i)
   {
-    ymax = y2;
-    xmax = x2;
+    data.Add(fitter.x()[i], fitter.y()[i], 1);
   }
-  for (int i = 0; i <= 1; i++)
+  ROOT::Fit::Chi2Function EPChi2(data, fitFunction);
+  ROOT::Fit::Fitter fitter_root;
+  fitter_root.Config().MinimizerOptions().SetMinimizerType("GSLMultiFit");
+  fitter_root.Config().MinimizerOptions().SetPrintLevel(-1);
+  fitter_root.Config().SetParamsSettings(3, par);
+  fitter_root.Config().ParSettings(1).SetLimits(tmin, tmax);
+  fitter_root.FitFCN(EPChi2, nullptr, data.Size(), true);
+  const ROOT::Fit::FitResult &fitres = fitter_root.Result();
+  for (int i = 0; i < 3; ++i)
   {
-    sp->GetCoeff(i, X, Y, B, C, D);
-    if (D == 0)
-    {
-      if (C < 0)
-      {
-        // TSpline is a quadratic equation
-
-        float root = (-B / (2 * C)) + X;
-        if (root >= xp[i] && root <= xp[i + 1])
-        {
-          float yvalue = sp->Eval(root);
-          if (yvalue > ymax)
-          {
-            ymax = yvalue;
-            xmax = root;
-          }
-        }
-      }
-    }
-    else
-    {
-      // find x when derivative = 0
-      float root = ((-2 * C + sqrt((4 * C * C) - (12 * B * D))) / (6 * D)) + X;
-      if (root >= xp[i] && root <= xp[i + 1])
-      {
-        float yvalue = sp->Eval(root);
-        if (yvalue > ymax)
-        {
-          ymax = yvalue;
-          xmax = root;
-        }
-      }
-      root = (-2 * C - sqrt((4 * C * C) - (12 * B * D))) / (6 * D) + X;
-      if (root >= xp[i] && root <= xp[i + 1])
-      {
-        float yvalue = sp->Eval(root);
-        if (yvalue > ymax)
-        {
-          ymax = yvalue;
-          xmax = root;
-        }
-      }
-    }
+    par[i] = fitres.Parameter(i);
   }
-  delete sp;
-  return;
+  chi2 = fitres.MinFcnValue();
+  return fitres.Status();
 }
-std::vector<std::vector<float>> CaloWaveformFitting::calo_processing_fast(const std::vector<std::vector<float>> &chnlvector)
+
+void CaloWaveformFitting::calo_processing_fast(CaloWaveformBatch &batch)
 {
-  std::vector<std::vector<float>> fit_values;
-  int nchnls = chnlvector.size();
-  for (int m = 0; m < nchnls; m++)
+  if (batch.empty())
+  {
+    return;
+  }
+
+  // peak of all channels with at least 3 samples
+  std::vector<std::vector<unsigned int>> groups;
+  group_channels(batch, groups);
+  std::vector<int> peak_sample(batch.size(), 0);
+  std::vector<float> peak_time(batch.size(), 0);
+  std::vector<float> peak_amplitude(batch.size(), 0);
+  for (std::size_t nsamples = 3; nsamples < groups.size(); ++nsamples)
+  {
+    CaloWaveformKernels::fast_peak(batch.samples(0), batch.max_samples(), nsamples, groups[nsamples].data(), groups[nsamples].size(),
+                                   peak_sample.data(), peak_time.data(), peak_amplitude.data());
+  }
+
+  for (std::size_t m = 0; m < batch.size(); m++)
   {
-    const std::vector<float> &v = chnlvector.at(m);
-    int nsamples = v.size();
+    const float *v = batch.samples(m);
+    int nsamples = batch.nsamples(m);
 
-    double maxy = v.at(0);
     float amp = 0;
     float time = 0;
     float ped = 0;
     float chi2 = std::numeric_limits<float>::quiet_NaN();
     if (nsamples == 2)
     {
-      amp = v.at(1);
+      amp = v[1];
       time = std::numeric_limits<float>::quiet_NaN();
-      ped = v.at(0);
-      if (v.at(0) != 0 && v.at(1) == 0)  // check if post-sample is 0, if so set high chi2
+      ped = v[0];
+      if (v[0] != 0 && v[1] == 0)  // check if post-sample is 0, if so set high chi2
       {
         chi2 = 1000000;
       }
     }
     else if (nsamples >= 3)
     {
-      int maxx = 0;
-      for (int i = 0; i < nsamples; i++)
+      for (int i = 0; i < 3; i++)
       {
-        if (i < 3)
-        {
-          ped += v.at(i);
-        }
-        if (v.at(i) > maxy)
-        {
-          maxy = v.at(i);
-          maxx = i;
-        }
+        ped += v[i];
       }
       ped /= 3;
       // if maxx <=5 nsample >=10 use the last two sample for pedestal(for HCal TP)
-      if (maxx <= 5 && nsamples >= 10)
-      {
-        ped = 0.5 * (v.at(nsamples - 2) + v.at(nsamples - 1));
-      }
-      if (maxx == 0 || maxx == nsamples - 1)
+      if (peak_sample[m] <= 5 && nsamples >= 10)
       {
-        amp = maxy;
-        time = maxx;
-      }
-      else
-      {
-        FastMax(maxx - 1, maxx, maxx + 1, v.at(maxx - 1), v.at(maxx), v.at(maxx + 1), time, amp);
+        ped = 0.5 * (v[nsamples - 2] + v[nsamples - 1]);
       }
+      amp = peak_amplitude[m];
+      time = peak_time[m];
     }
     amp -= ped;
-    std::vector<float> val = {amp, time, ped, chi2, 0, 0};
-    fit_values.push_back(val);
-    val.clear();
+    batch.set_result(m, amp, time, ped, chi2);
   }
-  return fit_values;
 }
 
-std::vector<std::vector<float>> CaloWaveformFitting::calo_processing_nyquist(const std::vector<std::vector<float>> &chnlvector)
+void CaloWaveformFitting::calo_processing_nyquist(CaloWaveformBatch &batch)
 {
-  std::vector<std::vector<float>> fit_values;
-  int nchnls = chnlvector.size();
-  for (int m = 0; m < nchnls; m++)
+  if (batch.empty())
   {
-    std::vector<float> v = chnlvector.at(m);
-    int nsamples = (int) v.size();
+    return;
+  }
+
+  // peak of all channels with at least 3 samples
+  std::vector<std::vector<unsigned int>> groups;
+  group_channels(batch, groups);
+  std::vector<float> peak_time(batch.size(), 0);
+  std::vector<float> peak_amplitude(batch.size(), 0);
+  for (std::size_t nsamples = 3; nsamples < groups.size(); ++nsamples)
+  {
+    CaloWaveformKernels::nyquist_peak(batch.samples(0), batch.max_samples(), nsamples, groups[nsamples].data(), groups[nsamples].size(),
+                                      peak_time.data(), peak_amplitude.data());
+  }
+
+  for (std::size_t m = 0; m < batch.size(); m++)
+  {
+    const float *v = batch.samples(m);
+    int nsamples = batch.nsamples(m);
 
     if (nsamples == 2)
     {
       float chi2 = std::numeric_limits<float>::quiet_NaN();
-      if (v.at(0) != 0 && v.at(1) == 0)  // check if post-sample is 0, if so set high chi2
+      if (v[0] != 0 && v[1] == 0)  // check if post-sample is 0, if so set high chi2
       {
         chi2 = 1000000;
       }
-      fit_values.push_back({v.at(1) - v.at(0), std::numeric_limits<float>::quiet_NaN(), v.at(0), chi2, 0, 0});
+      batch.set_result(m, v[1] - v[0], std::numeric_limits<float>::quiet_NaN(), v[0], chi2);
+      continue;
+    }
+    if (nsamples < 3)
+    {
       continue;
     }
 
-    std::vector<float> result = NyquistInterpolation(v);
-    fit_values.push_back(result);
+    NyquistInterpolation(batch, m, peak_amplitude[m], peak_time[m]);
   }
-  return fit_values;
 }
-// mabye I can find a way to make it thread safe
-std::vector<float> CaloWaveformFitting::NyquistInterpolation(std::vector<float> &vec_signal_samples)
-{
-  // int N = (int) vec_signal_samples.size();
-  auto max_elem_iter = std::max_element(vec_signal_samples.begin(), vec_signal_samples.end());
-  int maxx = std::distance(vec_signal_samples.begin(), max_elem_iter);
-  float max = *max_elem_iter;
-
-  float maxpos = maxx;
-  float steplength = 0.5;
-
-  while (steplength > 0.001)
-  {
-    // use 1.5 instead of 1 to avoid the floating point error...
-    float starttime = maxpos - (1 * steplength);
-    float endtime = maxpos + (1.5 * steplength);
 
-    for (float i = starttime; i < endtime; i += steplength)
-    {
-      float yval = max;
-      if (i != maxpos)
-      {
-        yval = psinc(i, vec_signal_samples);
-      }
-      if (yval > max)
-      {
-        max = yval;
-        maxpos = i;
-      }
-    }
-    steplength /= 2;
-  }
+void CaloWaveformFitting::NyquistInterpolation(CaloWaveformBatch &batch, std::size_t ich, float max, float maxpos)
+{
+  const float *vec_signal_samples = batch.samples(ich);
+  int N = batch.nsamples(ich);
 
   float pedestal = 0;
 
@@ -527,106 +405,20 @@ std::vector<float> CaloWaveformFitting::NyquistInterpolation(std::vector<float>
     pedestal = max;
     for (float i = maxpos - 5; i < maxpos; i += 0.1)
     {
-      float yval = psinc(i, vec_signal_samples);
+      float yval = CaloWaveformKernels::psinc(i, vec_signal_samples, N);
       pedestal = std::min(yval, pedestal);
     }
   }
   // calculate chi2 using the tempalte
   float chi2 = 0;
   double par[3] = {max - pedestal, maxpos - m_peakTimeTemp, pedestal};
-  for (int i = 0; i < (int) vec_signal_samples.size(); i++)
+  for (int i = 0; i < N; i++)
   {
     double xval[1] = {(double) i};
     float diff = vec_signal_samples[i] - template_function(xval, par);
     chi2 += diff * diff;
   }
-  std::vector<float> val = {max - pedestal, maxpos, pedestal, chi2, 0, 0};
-  return val;
-}
-
-// for odd N
-double CaloWaveformFitting::Dkernelodd(double x, int N)
-{
-  double sum = 0;
-  for (int k = 0; k < (N + 1) / 2; k++)
-  {
-    sum += 2 * std::cos(2 * M_PI * k * x / N);
-  }
-  sum -= 1;
-  sum = sum / N;
-  return sum;
-}
-
-// for even N
-double CaloWaveformFitting::Dkernel(double x, int N)
-{
-  double sum = 0;
-  for (int k = 0; k < N / 2; k++)
-  {
-    sum += 2 * std::cos(2 * M_PI * k * x / N);
-  }
-  sum -= 1;
-  sum += std::cos(M_PI * x);
-  sum = sum / N;
-  return sum;
-}
-
-float CaloWaveformFitting::stablepsinc(float time, std::vector<float> &vec_signal_samples)
-{
-  int N = (int) vec_signal_samples.size();
-  float sum = 0;
-  if (N % 2 == 0)
-  {
-    for (int n = 0; n < N; n++)
-    {
-      sum += vec_signal_samples[n] * Dkernel(time - n, N);
-    }
-  }
-  else
-  {
-    for (int n = 0; n < N; n++)
-    {
-      sum += vec_signal_samples[n] * Dkernelodd(time - n, N);
-    }
-  }
-  return sum;
-}
-
-float CaloWaveformFitting::psinc(float time, std::vector<float> &vec_signal_samples)
-{
-  int N = (int) vec_signal_samples.size();
-
-  if (std::abs(std::round(time) - time) < 1e-6)
-  {
-    if (time < 0 || time >= N)
-    {
-      return stablepsinc(time, vec_signal_samples);
-    }
-
-    return vec_signal_samples.at(std::round(time));
-  }
-
-  float sum = 0;
-  if (N % 2 == 0)
-  {
-    for (int n = 0; n < N; n++)
-    {
-      double piu = M_PI * (time - n);
-      double piuN = piu / N;
-      sum += vec_signal_samples[n] * std::sin(piu) / (std::tan(piuN)) / N;
-    }
-  }
-  else
-  {
-    for (int n = 0; n < N; n++)
-    {
-      double piu = M_PI * (time - n);
-      double piuN = piu / N;
-      sum += vec_signal_samples[n] * std::sin(piu) / (std::sin(piuN)) / N;
-    }
-  }
-
-  return sum;
+  batch.set_result(ich, max - pedestal, maxpos, pedestal, chi2);
 }
 
 double CaloWaveformFitting::SignalShape_PowerLawExp(double *x, double *par)
@@ -703,15 +495,12 @@ double CaloWaveformFitting::SignalShape_FermiExp(double *x, double *par) //NOLIN
 }
 
 
-std::vector<std::vector<float>> CaloWaveformFitting::calo_processing_funcfit(const std::vector<std::vector<float>> &chnlvector)
+void CaloWaveformFitting::calo_processing_funcfit(CaloWaveformBatch &batch)
 {
-  std::vector<std::vector<float>> fit_values;
-  int nchnls = chnlvector.size();
-
-  for (int m = 0; m < nchnls; m++)
+  for (std::size_t m = 0; m < batch.size(); m++)
   {
-    const std::vector<float> &v = chnlvector.at(m);
-    int nsamples = v.size();
+    const float *v = batch.samples(m);
+    int nsamples = batch.nsamples(m);
 
     float amp = 0;
     float time = 0;
@@ -721,14 +510,14 @@ std::vector<std::vector<float>> CaloWaveformFitting::calo_processing_funcfit(con
     // Handle zero-suppressed samples (2-sample case)
     if (nsamples == _nzerosuppresssamples)
     {
-      amp = v.at(1) - v.at(0);
+      amp = v[1] - v[0];
       time = std::numeric_limits<float>::quiet_NaN();
-      ped = v.at(0);
-      if (v.at(0) != 0 && v.at(1) == 0)
+      ped = v[0];
+      if (v[0] != 0 && v[1] == 0)
       {
         chi2 = 1000000;
       }
-      fit_values.push_back({amp, time, ped, chi2, 0, 0});
+      batch.set_result(m, amp, time, ped, chi2);
       continue;
     }
 
@@ -737,9 +526,9 @@ std::vector<std::vector<float>> CaloWaveformFitting::calo_processing_funcfit(con
     int maxbin = 0;
     for (int i = 0; i < nsamples; i++)
     {
-      if (v.at(i) > maxheight)
+      if (v[i] > maxheight)
       {
-        maxheight = v.at(i);
+        maxheight = v[i];
         maxbin = i;
       }
     }
@@ -747,29 +536,29 @@ std::vector<std::vector<float>> CaloWaveformFitting::calo_processing_funcfit(con
     float pedestal = 1500;
     if (maxbin > 4)
     {
-      pedestal = 0.5 * (v.at(maxbin - 4) + v.at(maxbin - 5));
+      pedestal = 0.5 * (v[maxbin - 4] + v[maxbin - 5]);
     }
     else if (maxbin > 3)
     {
-      pedestal = v.at(maxbin - 4);
+      pedestal = v[maxbin - 4];
     }
     else
     {
-      pedestal = 0.5 * (v.at(nsamples - 3) + v.at(nsamples - 2));
+      pedestal = 0.5 * (v[nsamples - 3] + v[nsamples - 2]);
     }
 
     // Software zero suppression check
-    if ((_bdosoftwarezerosuppression && v.at(6) - v.at(0) < _nsoftwarezerosuppression) ||
+    if ((_bdosoftwarezerosuppression && v[6] - v[0] < _nsoftwarezerosuppression) ||
         (_maxsoftwarezerosuppression && maxheight - pedestal < _nsoftwarezerosuppression))
     {
-      amp = v.at(6) - v.at(0);
+      amp = v[6] - v[0];
       time = std::numeric_limits<float>::quiet_NaN();
-      ped = v.at(0);
-      if (v.at(0) != 0 && v.at(1) == 0)
+      ped = v[0];
+      if (v[0] != 0 && v[1] == 0)
       {
         chi2 = 1000000;
       }
-      fit_values.push_back({amp, time, ped, chi2, 0, 0});
+      batch.set_result(m, amp, time, ped, chi2);
       continue;
     }
 
@@ -778,11 +567,11 @@ std::vector<std::vector<float>> CaloWaveformFitting::calo_processing_funcfit(con
     int ndata = 0;
     for (int i = 0; i < nsamples; ++i)
     {
-      if ((v.at(i) == 16383) && _handleSaturation)
+      if ((v[i] == 16383) && _handleSaturation)
       {
         continue;
       }
-      h.SetBinContent(i + 1, v.at(i));
+      h.SetBinContent(i + 1, v[i]);
       h.SetBinError(i + 1, 1);
       ndata++;
     }
@@ -793,7 +582,7 @@ std::vector<std::vector<float>> CaloWaveformFitting::calo_processing_funcfit(con
       ndata = nsamples;
       for (int i = 0; i < nsamples; ++i)
       {
-        h.SetBinContent(i + 1, v.at(i));
+        h.SetBinContent(i + 1, v[i]);
         h.SetBinError(i + 1, 1);
       }
     }
@@ -950,9 +739,6 @@ std::vector<std::vector<float>> CaloWaveformFitting::calo_processing_funcfit(con
       chi2val = std::numeric_limits<double>::quiet_NaN();
     }
 
-    fit_values.push_back({static_cast<float>(fit_amp), static_cast<float>(fit_time),
-                          static_cast<float>(fit_ped), static_cast<float>(chi2val), 0, static_cast<float>(validfit)});
+    batch.set_result(m, fit_amp, fit_time, fit_ped, chi2val, false, validfit);
   }
-
-  return fit_values;
 }
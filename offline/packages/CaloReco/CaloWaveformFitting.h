@@ -1,6 +1,11 @@
 #ifndef CALORECO_CALOWAVEFORMFITTING_H
 #define CALORECO_CALOWAVEFORMFITTING_H
 
+#include "CaloWaveformBatch.h"
+#include "CaloWaveformTemplateFitter.h"
+
+#include <cstddef>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -25,7 +30,8 @@ class CaloWaveformFitting
     return;
   }
 
-  void set_nthreads(int nthreads)
+  //! obsolete, the number of threads is set with Fun4AllServer::SetNumThreads
+  [[deprecated("the number of threads is set with Fun4AllServer::SetNumThreads")]] void set_nthreads(int nthreads)
   {
     _nthreads = nthreads;
     return;
@@ -42,7 +48,8 @@ class CaloWaveformFitting
     _maxsoftwarezerosuppression = usezerosuppression;
   }
 
-  int get_nthreads()
+  //! obsolete, returns the value passed to set_nthreads
+  [[deprecated("the number of threads is set with Fun4AllServer::SetNumThreads")]] int get_nthreads()
   {
     return _nthreads;
   }
@@ -64,11 +71,22 @@ class CaloWaveformFitting
     _handleSaturation = handleSaturation;
   }
 
-  std::vector<std::vector<float>> process_waveform(std::vector<std::vector<float>> waveformvector);
-  std::vector<std::vector<float>> calo_processing_templatefit(std::vector<std::vector<float>> chnlvector);
-  static std::vector<std::vector<float>> calo_processing_fast(const std::vector<std::vector<float>> &chnlvector);
-  std::vector<std::vector<float>> calo_processing_nyquist(const std::vector<std::vector<float>> &chnlvector);
-  std::vector<std::vector<float>> calo_processing_funcfit(const std::vector<std::vector<float>> &chnlvector);
+  //! minimize the template fit with ROOT (GSLMultiFit) instead of CaloWaveformTemplateFitter. Much slower, kept for validation
+  void set_root_templatefit(bool value = true)
+  {
+    m_root_templatefit = value;
+  }
+
+  //! template fit of one waveform per channel, returns amplitude, time, pedestal, chi2, recovered, status per channel
+  std::vector<std::vector<float>> process_waveform(const std::vector<std::vector<float>> &waveformvector);
+
+  //!@name back ends, results are stored in the batch
+  //@{
+  void calo_processing_templatefit(CaloWaveformBatch &batch);
+  static void calo_processing_fast(CaloWaveformBatch &batch);
+  void calo_processing_nyquist(CaloWaveformBatch &batch);
+  void calo_processing_funcfit(CaloWaveformBatch &batch);
+  //@}
 
   void initialize_processing(const std::string &templatefile);
 
@@ -98,16 +116,14 @@ class CaloWaveformFitting
   }
 
  private:
-  static void FastMax(float x0, float x1, float x2, float y0, float y1, float y2, float &xmax, float &ymax);
-  std::vector<float> NyquistInterpolation(std::vector<float> &vec_signal_samples);
-  static double Dkernelodd(double x, int N);
-  static double Dkernel(double x, int N);
-
-  static float stablepsinc(float t, std::vector<float> &vec_signal_samples);
+  //! pedestal and chi2 of a channel from the peak of its sinc interpolation (CaloWaveformKernels::nyquist_peak)
+  void NyquistInterpolation(CaloWaveformBatch &batch, std::size_t ich, float max, float maxpos);
 
-  static float psinc(float t, std::vector<float> &vec_signal_samples);
   double template_function(double *x, double *par);
 
+  //! fit the data points of fitter, returns the fit status and the unnormalized chi2
+  int fit_template(CaloWaveformTemplateFitter &fitter, double *par, double tmin, double tmax, double &chi2);
+
   TProfile *h_template{nullptr};
   double m_peakTimeTemp{0};
   int _nthreads{1};
@@ -125,6 +141,12 @@ class CaloWaveformFitting
   bool m_setTimeLim{false};
   bool _dobitfliprecovery{false};
   bool _handleSaturation{true};
+  bool m_root_templatefit{false};
+  bool m_root_thread_safety{false};
+
+  //! sampled template, shared by the per-thread fitters
+  std::shared_ptr<const CaloWaveformTemplateFitter::Table> m_template_table;
+  std::vector<std::unique_ptr<CaloWaveformTemplateFitter>> m_template_fitters;
 
   std::string m_template_input_file;
   std::string url_template;
@@ -0,0 +1,135 @@
+/**
+ * @file CaloReco/CaloWaveformFittingBenchmark.cc
+ * @brief compare speed and results of the ROOT and CaloWaveformTemplateFitter template fits
+ *
+ * usage: CaloWaveformFittingBenchmark <template file> <waveform file> [channels per event]
+ * The waveform file is a text file with one recorded waveform per line (adc samples
+ * separated by spaces). Waveforms are processed in groups of [channels per event],
+ * 24576 by default (EMCal), as done by CaloTowerBuilder
+ */
+#include "CaloWaveformBatch.h"
+#include "CaloWaveformFitting.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+  using clock_type = std::chrono::high_resolution_clock;
+
+  std::vector<std::vector<float>> read_waveforms(const std::string& filename)
+  {
+    std::vector<std::vector<float>> waveforms;
+    std::ifstream in(filename);
+    std::string line;
+    while (std::getline(in, line))
+    {
+      std::istringstream stream(line);
+      std::vector<float> waveform;
+      float sample;
+      while (stream >> sample)
+      {
+        waveform.push_back(sample);
+      }
+      if (!waveform.empty())
+      {
+        waveforms.push_back(waveform);
+      }
+    }
+    return waveforms;
+  }
+
+  // fit all waveforms, returns the time spent in ms
+  double run(CaloWaveformFitting& fitting, const std::vector<std::vector<float>>& waveforms, const std::size_t nchannels, std::vector<std::vector<float>>& results)
+  {
+    results.clear();
+    CaloWaveformBatch batch;
+    double elapsed = 0;
+    for (std::size_t first = 0; first < waveforms.size(); first += nchannels)
+    {
+      const std::size_t last = std::min(waveforms.size(), first + nchannels);
+      batch.fill(std::vector<std::vector<float>>(waveforms.begin() + first, waveforms.begin() + last));
+
+      const auto start = clock_type::now();
+      fitting.calo_processing_templatefit(batch);
+      elapsed += std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+
+      const auto fitresults = batch.results();
+      results.insert(results.end(), fitresults.begin(), fitresults.end());
+    }
+    return elapsed;
+  }
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  if (argc < 3)
+  {
+    std::cout << "usage: CaloWaveformFittingBenchmark <template file> <waveform file> [channels per event]" << std::endl;
+    return 1;
+  }
+
+  const std::size_t nchannels = (argc > 3) ? std::atoi(argv[3]) : 24576;
+  const auto waveforms = read_waveforms(argv[2]);
+  if (waveforms.empty())
+  {
+    std::cout << "CaloWaveformFittingBenchmark - no waveform found in " << argv[2] << std::endl;
+    return 1;
+  }
+
+  CaloWaveformFitting fitting_root;
+  fitting_root.initialize_processing(argv[1]);
+  fitting_root.set_root_templatefit(true);
+
+  CaloWaveformFitting fitting;
+  fitting.initialize_processing(argv[1]);
+
+  std::vector<std::vector<float>> results_root;
+  std::vector<std::vector<float>> results;
+  const double time_root = run(fitting_root, waveforms, nchannels, results_root);
+  const double time = run(fitting, waveforms, nchannels, results);
+
+  std::cout << "CaloWaveformFittingBenchmark - " << waveforms.size() << " waveforms" << std::endl;
+  std::cout << "ROOT fit: " << 1e3 * time_root / waveforms.size() << " us/channel" << std::endl;
+  std::cout << "CaloWaveformTemplateFitter: " << 1e3 * time / waveforms.size() << " us/channel" << std::endl;
+
+  // compare fitted amplitude, time, pedestal and chi2 of the channels which were fitted by both
+  double max_amplitude = 0;
+  double max_time = 0;
+  double max_pedestal = 0;
+  double max_chi2 = 0;
+  int nstatus = 0;
+  int ncompared = 0;
+  for (std::size_t i = 0; i < results.size(); ++i)
+  {
+    const auto& ref = results_root[i];
+    const auto& res = results[i];
+    if (ref[5] != res[5])
+    {
+      ++nstatus;
+    }
+    if (std::isnan(ref[1]) || std::isnan(res[1]) || ref[5] != 0 || res[5] != 0)
+    {
+      continue;
+    }
+    ++ncompared;
+    max_amplitude = std::max<double>(max_amplitude, std::abs(res[0] - ref[0]) / std::max<double>(std::abs(ref[0]), 1));
+    max_time = std::max<double>(max_time, std::abs(res[1] - ref[1]));
+    max_pedestal = std::max<double>(max_pedestal, std::abs(res[2] - ref[2]));
+    max_chi2 = std::max<double>(max_chi2, std::abs(res[3] - ref[3]) / std::max<double>(ref[3], 1));
+  }
+
+  std::cout << "compared " << ncompared << " fitted channels, " << nstatus << " with different fit status" << std::endl;
+  std::cout << "max relative amplitude difference: " << max_amplitude << std::endl;
+  std::cout << "max time difference: " << max_time << " samples" << std::endl;
+  std::cout << "max pedestal difference: " << max_pedestal << " adc" << std::endl;
+  std::cout << "max relative chi2 difference: " << max_chi2 << std::endl;
+  return 0;
+}
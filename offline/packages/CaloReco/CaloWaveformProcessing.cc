@@ -1,8 +1,11 @@
 #include "CaloWaveformProcessing.h"
+#include "CaloWaveformBatch.h"
 #include "CaloWaveformFitting.h"
 
 #include <ffamodules/CDBInterface.h>
 
+#include <fun4all/Fun4AllServer.h>
+
 #include <phool/onnxlib.h>
 
 #include <algorithm>  // for max
@@ -37,7 +40,6 @@ void CaloWaveformProcessing::initialize_processing()
     {
       m_Fitter->set_handleSaturation(false);
     }
-    m_Fitter->set_nthreads(get_nthreads());
     if (m_setTimeLim)
     {
       m_Fitter->set_timeFitLim(m_timeLim_low, m_timeLim_high);
@@ -80,63 +82,49 @@ void CaloWaveformProcessing::initialize_processing()
   }
 }
 
-std::vector<std::vector<float>> CaloWaveformProcessing::process_waveform(std::vector<std::vector<float>> waveformvector)
+std::vector<std::vector<float>> CaloWaveformProcessing::process_waveform(const std::vector<std::vector<float>> &waveformvector)
+{
+  CaloWaveformBatch batch;
+  batch.fill(waveformvector);
+  process_waveform(batch);
+  return batch.results();
+}
+
+void CaloWaveformProcessing::process_waveform(CaloWaveformBatch &batch)
 {
-  unsigned int size1 = waveformvector.size();
-  std::vector<std::vector<float>> fitresults;
   if (m_processingtype == CaloWaveformProcessing::TEMPLATE || m_processingtype == CaloWaveformProcessing::TEMPLATE_NOSAT)
   {
-    for (unsigned int i = 0; i < size1; i++)
-    {
-      waveformvector.at(i).push_back((float) i);
-    }
-    fitresults = m_Fitter->calo_processing_templatefit(waveformvector);
+    m_Fitter->calo_processing_templatefit(batch);
   }
   if (m_processingtype == CaloWaveformProcessing::ONNX)
   {
-    fitresults = CaloWaveformProcessing::calo_processing_ONNX(waveformvector);
+    CaloWaveformProcessing::calo_processing_ONNX(batch);
   }
   if (m_processingtype == CaloWaveformProcessing::FAST)
   {
-    fitresults = CaloWaveformFitting::calo_processing_fast(waveformvector);
+    CaloWaveformFitting::calo_processing_fast(batch);
   }
   if (m_processingtype == CaloWaveformProcessing::NYQUIST)
   {
-    fitresults = m_Fitter->calo_processing_nyquist(waveformvector);
+    m_Fitter->calo_processing_nyquist(batch);
   }
   if (m_processingtype == CaloWaveformProcessing::FUNCFIT)
   {
-    fitresults = m_Fitter->calo_processing_funcfit(waveformvector);
+    m_Fitter->calo_processing_funcfit(batch);
   }
-  return fitresults;
 }
 
-std::vector<std::vector<float>> CaloWaveformProcessing::calo_processing_ONNX(const std::vector<std::vector<float>> &chnlvector)
+void CaloWaveformProcessing::calo_processing_ONNX(CaloWaveformBatch &batch)
 {
-  std::vector<std::vector<float>> fit_values;
-  std::vector<float> val;  // single row to return
-  unsigned int nchnls = chnlvector.size();
-  for (unsigned int m = 0; m < nchnls; m++)
+  for (std::size_t m = 0; m < batch.size(); m++)
   {
-    val.clear();
-    const std::vector<float> &v = chnlvector.at(m);
-    int size1 = v.size();
+    const float *v = batch.samples(m);
+    int size1 = batch.nsamples(m);
     if (size1 == _nzerosuppresssamples)
     {
-      val.push_back(v.at(1) - v.at(0));
-      val.push_back(std::numeric_limits<float>::quiet_NaN());
-      val.push_back(v.at(0));
-      if (v.at(0) != 0 && v.at(1) == 0)  // check if post-sample is 0, if so set high chi2
-      {
-        val.push_back(1000000);
-      }
-      else
-      {
-        val.push_back(std::numeric_limits<float>::quiet_NaN());
-      }
-      val.push_back(0);
-      val.push_back(0);
-      fit_values.push_back(val);
+      // check if post-sample is 0, if so set high chi2
+      const float chi2 = (v[0] != 0 && v[1] == 0) ? 1000000 : std::numeric_limits<float>::quiet_NaN();
+      batch.set_result(m, v[1] - v[0], std::numeric_limits<float>::quiet_NaN(), v[0], chi2);
     }
     else
     {
@@ -144,88 +132,64 @@ std::vector<std::vector<float>> CaloWaveformProcessing::calo_processing_ONNX(con
       int maxbin = 0;
       for (int i = 0; i < size1; i++)
       {
-        if (v.at(i) > maxheight)
+        if (v[i] > maxheight)
         {
-          maxheight = v.at(i);
+          maxheight = v[i];
           maxbin = i;
         }
       }
       float pedestal = 1500;
       if (maxbin > 4)
       {
-        pedestal = 0.5 * (v.at(maxbin - 4) + v.at(maxbin - 5));
+        pedestal = 0.5 * (v[maxbin - 4] + v[maxbin - 5]);
       }
       else if (maxbin > 3)
       {
-        pedestal = (v.at(maxbin - 4));
+        pedestal = (v[maxbin - 4]);
       }
       else
       {
-        pedestal = 0.5 * (v.at(size1 - 3) + v.at(size1 - 2));
+        pedestal = 0.5 * (v[size1 - 3] + v[size1 - 2]);
       }
 
-      if ((_bdosoftwarezerosuppression && v.at(6) - v.at(0) < _nsoftwarezerosuppression) || (_maxsoftwarezerosuppression && maxheight - pedestal < _nsoftwarezerosuppression))
+      if ((_bdosoftwarezerosuppression && v[6] - v[0] < _nsoftwarezerosuppression) || (_maxsoftwarezerosuppression && maxheight - pedestal < _nsoftwarezerosuppression))
       {
-        val.push_back(v.at(6) - v.at(0));
-        val.push_back(std::numeric_limits<float>::quiet_NaN());
-        val.push_back(v.at(0));
-        if (v.at(0) != 0 && v.at(1) == 0)  // check if post-sample is 0, if so set high chi2
-        {
-          val.push_back(1000000);
-        }
-        else
-        {
-          val.push_back(std::numeric_limits<float>::quiet_NaN());
-        }
-        val.push_back(0);
-        val.push_back(0);
-        fit_values.push_back(val);
+        // check if post-sample is 0, if so set high chi2
+        const float chi2 = (v[0] != 0 && v[1] == 0) ? 1000000 : std::numeric_limits<float>::quiet_NaN();
+        batch.set_result(m, v[6] - v[0], std::numeric_limits<float>::quiet_NaN(), v[0], chi2);
       }
       else
       {
-        unsigned int nsamples = v.size();
-        if (nsamples == 12)
+        if (size1 == 12)
         {
           // downstream onnx does not have a static input vector API,
-          // so we need to make a copy
-          std::vector<float> vtmp(v);  // NOLINT(performance-unnecessary-copy-initialization)
-          val = onnxInference(onnxmodule, vtmp, 1, onnxlib::n_input, onnxlib::n_output);
+          // so the samples are copied to a reused buffer
+          m_onnx_input.assign(v, v + size1);
+          std::vector<float> val = onnxInference(onnxmodule, m_onnx_input, 1, onnxlib::n_input, onnxlib::n_output);
           unsigned int nvals = val.size();
           for (unsigned int i = 0; i < nvals; i++)
           {
             val.at(i) = val.at(i) * m_Onnx_factor.at(i) + m_Onnx_offset.at(i);
           }
-          val.push_back(2000);
-          val.push_back(0);
-          val.push_back(0);
-          fit_values.push_back(val);
+          batch.set_result(m, val.at(0), val.at(1), val.at(2), 2000);
         }
         else
         {
-          float v_diff = v[1] - v[0];
-          std::vector<float> val1{v_diff, std::numeric_limits<float>::quiet_NaN(), v[1], std::numeric_limits<float>::quiet_NaN(), 0, 0};
-          fit_values.push_back(val1);
+          batch.set_result(m, v[1] - v[0], std::numeric_limits<float>::quiet_NaN(), v[1], std::numeric_limits<float>::quiet_NaN());
         }
       }
     }
   }
-  return fit_values;
 }
 
 int CaloWaveformProcessing::get_nthreads()
 {
-  if (m_Fitter)
-  {
-    return m_Fitter->get_nthreads();
-  }
-  return _nthreads;
+  return Fun4AllServer::instance()->NumThreads();
 }
 void CaloWaveformProcessing::set_nthreads(int nthreads)
 {
-  _nthreads = nthreads;
-  if (m_Fitter)
-  {
-    m_Fitter->set_nthreads(nthreads);
-  }
+  const unsigned int n = std::max(1, nthreads);
+  std::cout << "CaloWaveformProcessing::set_nthreads - deprecated, use Fun4AllServer::SetNumThreads. Setting the number of threads of the job to " << n << std::endl;
+  Fun4AllServer::instance()->SetNumThreads(n);
   return;
 }
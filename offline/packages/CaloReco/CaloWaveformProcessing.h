@@ -7,6 +7,7 @@
 #include <string>
 #include <vector>
 
+class CaloWaveformBatch;
 class CaloWaveformFitting;
 
 class CaloWaveformProcessing : public SubsysReco
@@ -54,6 +55,7 @@ class CaloWaveformProcessing : public SubsysReco
     return;
   }
 
+  //! obsolete, sets the number of threads of the job with Fun4AllServer::SetNumThreads
   void set_nthreads(int nthreads);
 
   int get_nthreads();
@@ -96,8 +98,13 @@ class CaloWaveformProcessing : public SubsysReco
     _doubleexp_ratio = ratio;
   }
 
-  std::vector<std::vector<float>> process_waveform(std::vector<std::vector<float>> waveformvector);
-  std::vector<std::vector<float>> calo_processing_ONNX(const std::vector<std::vector<float>> &chnlvector);
+  //! process all channels of the batch with the selected back end, results are stored in the batch
+  void process_waveform(CaloWaveformBatch &batch);
+
+  //! same with one waveform per channel, returns amplitude, time, pedestal, chi2, recovered, status per channel
+  std::vector<std::vector<float>> process_waveform(const std::vector<std::vector<float>> &waveformvector);
+
+  void calo_processing_ONNX(CaloWaveformBatch &batch);
 
   void initialize_processing();
 
@@ -109,7 +116,6 @@ class CaloWaveformProcessing : public SubsysReco
   CaloWaveformFitting *m_Fitter{nullptr};
 
   CaloWaveformProcessing::process m_processingtype{CaloWaveformProcessing::TEMPLATE};
-  int _nthreads{1};
   int _nzerosuppresssamples{2};
 
   int _nsoftwarezerosuppression{40};
@@ -130,6 +136,9 @@ class CaloWaveformProcessing : public SubsysReco
   std::array<double, 4> m_Onnx_factor{std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN()};
   std::array<double, 4> m_Onnx_offset{std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN()};
 
+  //! onnx input buffer, reused for all channels
+  std::vector<float> m_onnx_input;
+
   // Functional fit parameters
   int _funcfit_type{1};  // 0 = PowerLawExp, 1 = PowerLawDoubleExp
   double _powerlaw_power{4.0};
@@ -0,0 +1,264 @@
+#include "CaloWaveformTemplateFitter.h"
+
+#include <TAxis.h>
+#include <TProfile.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+  constexpr int npar = 3;
+
+  //! index of the time parameter
+  constexpr int itime = 1;
+
+  //! damping limits. When the damping grows beyond max_lambda no better point can be found
+  constexpr double initial_lambda = 1e-3;
+  constexpr double max_lambda = 1e10;
+
+  //! number of grid points per bin for templates with variable bin size
+  constexpr int oversampling = 4;
+
+  /** solve (alpha + diag(alpha) * lambda) x = beta by Cholesky decomposition.
+   *  alpha is symmetric, only the lower triangle is used.
+   *  A small regularization keeps degenerate directions (e.g. time at zero amplitude) frozen.
+   */
+  bool solve(const double *alpha, const double *beta, double lambda, double *x)
+  {
+    double maxdiag = 0;
+    for (int i = 0; i < npar; ++i)
+    {
+      maxdiag = std::max(maxdiag, alpha[i * npar + i]);
+    }
+    const double epsilon = 1e-12 * maxdiag + 1e-30;
+
+    double l[npar * npar] = {0};
+    for (int i = 0; i < npar; ++i)
+    {
+      for (int j = 0; j <= i; ++j)
+      {
+        double sum = alpha[i * npar + j];
+        if (i == j)
+        {
+          sum = sum * (1. + lambda) + epsilon;
+        }
+        for (int k = 0; k < j; ++k)
+        {
+          sum -= l[i * npar + k] * l[j * npar + k];
+        }
+        if (i == j)
+        {
+          if (sum <= 0)
+          {
+            return false;
+          }
+          l[i * npar + i] = std::sqrt(sum);
+        }
+        else
+        {
+          l[i * npar + j] = sum / l[j * npar + j];
+        }
+      }
+    }
+
+    // forward and backward substitution
+    double z[npar];
+    for (int i = 0; i < npar; ++i)
+    {
+      double sum = beta[i];
+      for (int k = 0; k < i; ++k)
+      {
+        sum -= l[i * npar + k] * z[k];
+      }
+      z[i] = sum / l[i * npar + i];
+    }
+    for (int i = npar - 1; i >= 0; --i)
+    {
+      double sum = z[i];
+      for (int k = i + 1; k < npar; ++k)
+      {
+        sum -= l[k * npar + i] * x[k];
+      }
+      x[i] = sum / l[i * npar + i];
+    }
+    return true;
+  }
+
+  /** keep the time parameter fixed when it sits on a limit and the fit pulls it outside.
+   *  beta is the descent direction (minus half the chi2 gradient)
+   */
+  void freeze_time(const double *par, double tmin, double tmax, double *alpha, double *beta)
+  {
+    if ((par[itime] <= tmin && beta[itime] < 0) || (par[itime] >= tmax && beta[itime] > 0))
+    {
+      for (int i = 0; i < npar; ++i)
+      {
+        alpha[itime * npar + i] = 0;
+        alpha[i * npar + itime] = 0;
+      }
+      alpha[itime * npar + itime] = 1;
+      beta[itime] = 0;
+    }
+  }
+}  // namespace
+
+CaloWaveformTemplateFitter::Table::Table(const TProfile *h_template)
+{
+  const int nbins = h_template->GetNbinsX();
+  m_xmin = h_template->GetBinCenter(1);
+  if (!h_template->GetXaxis()->IsVariableBinSize())
+  {
+    // the bin centers are the interpolation nodes of TH1::Interpolate
+    m_invstep = 1. / h_template->GetBinWidth(1);
+    m_values.reserve(nbins);
+    for (int i = 1; i <= nbins; ++i)
+    {
+      m_values.push_back(h_template->GetBinContent(i));
+    }
+    return;
+  }
+
+  // variable bin size: resample finer than the smallest bin
+  double minwidth = h_template->GetBinWidth(1);
+  for (int i = 2; i <= nbins; ++i)
+  {
+    minwidth = std::min(minwidth, h_template->GetBinWidth(i));
+  }
+  const double step = minwidth / oversampling;
+  const double xmax = h_template->GetBinCenter(nbins);
+  const auto npoints = static_cast<std::size_t>(std::ceil((xmax - m_xmin) / step)) + 1;
+  m_invstep = 1. / step;
+  m_values.reserve(npoints);
+  for (std::size_t i = 0; i < npoints; ++i)
+  {
+    m_values.push_back(h_template->Interpolate(m_xmin + i * step));
+  }
+}
+
+double CaloWaveformTemplateFitter::compute_chi2(const double *par) const
+{
+  double chi2 = 0;
+  for (std::size_t i = 0; i < m_x.size(); ++i)
+  {
+    double value;
+    double derivative;
+    m_table->eval(m_x[i] - par[1], value, derivative);
+    const double residual = m_y[i] - (par[0] * value + par[2]);
+    chi2 += residual * residual;
+  }
+  return chi2;
+}
+
+double CaloWaveformTemplateFitter::compute_normal(const double *par, double *alpha, double *beta) const
+{
+  std::fill(alpha, alpha + npar * npar, 0.);
+  std::fill(beta, beta + npar, 0.);
+
+  double chi2 = 0;
+  for (std::size_t i = 0; i < m_x.size(); ++i)
+  {
+    double value;
+    double derivative;
+    m_table->eval(m_x[i] - par[1], value, derivative);
+    const double residual = m_y[i] - (par[0] * value + par[2]);
+    chi2 += residual * residual;
+
+    // derivatives of the model with respect to amplitude, time and pedestal
+    const double jacobian[npar] = {value, -par[0] * derivative, 1.};
+    for (int j = 0; j < npar; ++j)
+    {
+      beta[j] += jacobian[j] * residual;
+      for (int k = 0; k <= j; ++k)
+      {
+        alpha[j * npar + k] += jacobian[j] * jacobian[k];
+      }
+    }
+  }
+
+  // symmetrize
+  for (int j = 0; j < npar; ++j)
+  {
+    for (int k = j + 1; k < npar; ++k)
+    {
+      alpha[j * npar + k] = alpha[k * npar + j];
+    }
+  }
+  return chi2;
+}
+
+int CaloWaveformTemplateFitter::fit(double *par, double tmin, double tmax)
+{
+  m_niterations = 0;
+  par[itime] = std::clamp(par[itime], tmin, tmax);
+  if (m_x.size() < static_cast<std::size_t>(npar))
+  {
+    m_chi2 = compute_chi2(par);
+    return 1;
+  }
+
+  double alpha[npar * npar];
+  double beta[npar];
+  double step[npar];
+  double trial[npar];
+
+  double chi2 = compute_normal(par, alpha, beta);
+  freeze_time(par, tmin, tmax, alpha, beta);
+
+  double lambda = initial_lambda;
+  int status = 1;
+  for (; m_niterations < m_max_iterations; ++m_niterations)
+  {
+    /*
+     * converged when the Gauss-Newton step would not reduce the chi2 significantly anymore.
+     * The expected reduction is beta.step
+     */
+    if (solve(alpha, beta, 0, step))
+    {
+      double expected = 0;
+      for (int i = 0; i < npar; ++i)
+      {
+        expected += beta[i] * step[i];
+      }
+      if (expected <= m_tolerance * chi2 + 1e-12)
+      {
+        status = 0;
+        break;
+      }
+    }
+
+    if (!solve(alpha, beta, lambda, step))
+    {
+      lambda *= 10;
+      continue;
+    }
+
+    for (int i = 0; i < npar; ++i)
+    {
+      trial[i] = par[i] + step[i];
+    }
+    trial[itime] = std::clamp(trial[itime], tmin, tmax);
+
+    const double trial_chi2 = compute_chi2(trial);
+    if (trial_chi2 <= chi2)
+    {
+      std::copy(trial, trial + npar, par);
+      chi2 = compute_normal(par, alpha, beta);
+      freeze_time(par, tmin, tmax, alpha, beta);
+      lambda = std::max(lambda * 0.1, 1e-12);
+    }
+    else
+    {
+      lambda *= 10;
+      if (lambda > max_lambda)
+      {
+        // no direction left which decreases the chi2, e.g. the minimum is on a template node
+        status = 0;
+        break;
+      }
+    }
+  }
+
+  m_chi2 = chi2;
+  return status;
+}
@@ -0,0 +1,124 @@
+#ifndef CALORECO_CALOWAVEFORMTEMPLATEFITTER_H
+#define CALORECO_CALOWAVEFORMTEMPLATEFITTER_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+class TProfile;
+
+/** Levenberg-Marquardt fit of a waveform template to calorimeter samples.
+ *
+ *  The model is f(x) = par[0] * T(x - par[1]) + par[2], with T the pulse
+ *  template and unit errors on all samples, same as the ROOT based template
+ *  fit of CaloWaveformFitting. The template is sampled once into a flat
+ *  table (see Table) and the three parameters are solved with analytic
+ *  derivatives, so a fit does not allocate anything.
+ *
+ *  A fitter keeps its data and work buffers between fits and is therefore
+ *  not thread safe: use one per thread. The table is read only and shared.
+ */
+class CaloWaveformTemplateFitter
+{
+ public:
+  /** template sampled on a uniform grid.
+   *
+   *  Values are linearly interpolated between grid points and kept constant
+   *  beyond the first and last bin centers, which is what TH1::Interpolate does.
+   *  For a template with fixed bin width the grid points are the bin centers
+   *  and the result is identical to TProfile::Interpolate.
+   */
+  class Table
+  {
+   public:
+    explicit Table(const TProfile *h_template);
+
+    //! template value and derivative at x
+    void eval(double x, double &value, double &derivative) const
+    {
+      const double u = (x - m_xmin) * m_invstep;
+      if (u <= 0)
+      {
+        value = m_values.front();
+        derivative = 0;
+        return;
+      }
+      const std::size_t i = static_cast<std::size_t>(u);
+      if (i + 1 >= m_values.size())
+      {
+        value = m_values.back();
+        derivative = 0;
+        return;
+      }
+      const double slope = m_values[i + 1] - m_values[i];
+      value = m_values[i] + (u - i) * slope;
+      derivative = slope * m_invstep;
+    }
+
+   private:
+    double m_xmin{0};
+    double m_invstep{1};
+    std::vector<double> m_values;
+  };
+
+  explicit CaloWaveformTemplateFitter(std::shared_ptr<const Table> table)
+    : m_table(std::move(table))
+  {
+  }
+
+  //! remove all data points
+  void clear_data()
+  {
+    m_x.clear();
+    m_y.clear();
+  }
+
+  //! add a data point (sample time, adc)
+  void add_data(double x, double y)
+  {
+    m_x.push_back(x);
+    m_y.push_back(y);
+  }
+
+  std::size_t ndata() const { return m_x.size(); }
+  const std::vector<double> &x() const { return m_x; }
+  const std::vector<double> &y() const { return m_y; }
+
+  /** fit amplitude, time and pedestal.
+   *  par holds the starting values on input and the result on output.
+   *  The time parameter is kept within [tmin, tmax].
+   *  Returns 0 if the fit converged, same convention as ROOT::Fit::FitResult::Status()
+   */
+  int fit(double *par, double tmin, double tmax);
+
+  //! sum of squared residuals of the last fit
+  double chi2() const { return m_chi2; }
+
+  //! number of iterations of the last fit
+  int niterations() const { return m_niterations; }
+
+  void set_max_iterations(int value) { m_max_iterations = value; }
+  void set_tolerance(double value) { m_tolerance = value; }
+
+ private:
+  //! sum of squared residuals for a given set of parameters
+  double compute_chi2(const double *par) const;
+
+  //! sum of squared residuals, normal matrix (lower triangle) and gradient
+  double compute_normal(const double *par, double *alpha, double *beta) const;
+
+  std::shared_ptr<const Table> m_table;
+
+  std::vector<double> m_x;
+  std::vector<double> m_y;
+
+  int m_max_iterations{200};
+
+  //! relative chi2 decrease below which the fit is considered converged
+  double m_tolerance{1e-9};
+
+  double m_chi2{0};
+  int m_niterations{0};
+};
+
+#endif
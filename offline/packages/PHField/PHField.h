@@ -3,6 +3,10 @@
 
 // units of this class. To convert internal value to Geant4/CLHEP units for fast access
 
+#include <cstddef>
+
+class PHFieldCache;
+
 //! \brief transient object for field storage and access
 class PHField
 {
@@ -30,6 +34,22 @@ class PHField
       double *Bfield) const
   { return GetFieldValue( Point, Bfield ); }
 
+  //! field values at npoints points
+  /* Points holds x, y, z, t of each point, Bfield receives Bx, By, Bz of each point,
+     in the units of GetFieldValue. The cache is owned by the caller (one per thread), it may be nullptr.
+     Field maps on a grid interpolate the points together, by default GetFieldValue_nocache is called for each point */
+  virtual void GetFieldValues(
+      const std::size_t npoints,
+      const double *Points,
+      double *Bfield,
+      PHFieldCache * /*cache*/ = nullptr) const
+  {
+    for (std::size_t i = 0; i < npoints; ++i)
+    {
+      GetFieldValue_nocache(Points + 4 * i, Bfield + 3 * i);
+    }
+  }
+
   //! verbosity
   void Verbosity(const int i) { m_Verbosity = i; }
 
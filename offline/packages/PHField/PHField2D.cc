@@ -12,16 +12,12 @@
 #include <cmath>
 #include <cstdlib>
 #include <iostream>
-#include <iterator>
 #include <set>
 #include <utility>
+#include <vector>
 
 PHField2D::PHField2D(const std::string &filename, const int verb, const float magfield_rescale)
   : PHField(verb)
-  , r_index0_cache(0)
-  , r_index1_cache(0)
-  , z_index0_cache(0)
-  , z_index1_cache(0)
 {
   if (Verbosity() > 0)
   {
@@ -141,26 +137,13 @@ PHField2D::PHField2D(const std::string &filename, const int verb, const float ma
 
   // grab the minimum and maximum z values
   minz_ = *(z_set.begin());
-  std::set<float>::iterator ziter = z_set.end();
-  --ziter;
-  maxz_ = *ziter;
-
-  // initialize maps
-  nz = z_set.size();
-  nr = r_set.size();
-  r_map_.resize(nr, 0);
-  z_map_.resize(nz, 0);
-
-  std::copy(z_set.begin(), z_set.end(), z_map_.begin());
-  std::copy(r_set.begin(), r_set.end(), r_map_.begin());
-
-  // initialize the field map vectors to the correct sizes
-  BFieldR_.resize(nz, std::vector<float>(nr, 0));
-  BFieldZ_.resize(nz, std::vector<float>(nr, 0));
-
-  // all of this assumes that  z_prev < z , i.e. the table is ordered (as of right now)
-  unsigned int ir = 0;
-  unsigned int iz = 0;  // useful indexes to keep track of
+  maxz_ = *(z_set.rbegin());
+
+  // the z, r grid is a grid with a single point on the third axis
+  m_Grid.SetAxes(std::vector<double>(z_set.begin(), z_set.end()),
+                 std::vector<double>(r_set.begin(), r_set.end()),
+                 std::vector<double>(1, 0.));
+
   std::map<trio, trio>::iterator iter = sorted_map.begin();
   for (; iter != sorted_map.end(); ++iter)
   {
@@ -170,41 +153,25 @@ PHField2D::PHField2D(const std::string &filename, const int verb, const float ma
     float Bz = std::get<0>(iter->second) * magfield_unit;
     float Br = std::get<1>(iter->second) * magfield_unit;
 
-    maxz_ = std::max(z, maxz_);
-    minz_ = std::min(z, minz_);
-
-    // check for change in z value, when z changes we have a ton of updates to do
-    if (z != z_map_[iz])
-    {
-      ++iz;
-      ir = 0;
-    }
-    else if (r != r_map_[ir])  // check for change in r value
-    {
-      ++ir;
-    }
-
-    // shouldn't happen
-    if (iz > 0 && z < z_map_[iz - 1])
-    {
-      std::cout << "!!!!!!!!! Your map isn't ordered.... z: " << z << " zprev: " << z_map_[iz - 1] << std::endl;
-    }
-
-    BFieldR_[iz][ir] = Br * magfield_rescale;
-    BFieldZ_[iz][ir] = Bz * magfield_rescale;
+    const std::size_t iz = m_Grid.Index(0, z);
+    const std::size_t ir = m_Grid.Index(1, r);
+    float *bf = m_Grid.Field(iz, ir, 0);
+    bf[0] = Bz * magfield_rescale;
+    bf[1] = Br * magfield_rescale;
+    bf[2] = 0;
 
     // you can change this to check table values for correctness
     // print_map prints the values in the root table, and the
-    // std::couts print the values entered into the vectors
+    // std::couts print the values entered into the grid
     if (std::fabs(z) < 10 && ir < 10 /*&& iphi==2*/ && Verbosity() > 3)
     {
       print_map(iter);
 
       std::cout << " B("
-                << r_map_[ir] << ", "
-                << z_map_[iz] << "):  ("
-                << BFieldR_[iz][ir] << ", "
-                << BFieldZ_[iz][ir] << ")" << std::endl;
+                << m_Grid.Axis(1)[ir] << ", "
+                << m_Grid.Axis(0)[iz] << "):  ("
+                << bf[1] << ", "
+                << bf[0] << ")" << std::endl;
     }
 
   }  // end loop over root field map file
@@ -217,7 +184,7 @@ PHField2D::PHField2D(const std::string &filename, const int verb, const float ma
   }
   if (Verbosity() > 0)
   {
-    std::cout << "  Mag field r max boundary: " << r_map_.back() / cm << " cm" << std::endl;
+    std::cout << "  Mag field r max boundary: " << m_Grid.Axis(1).back() / cm << " cm" << std::endl;
   }
 
   if (Verbosity() > 0)
@@ -282,60 +249,27 @@ void PHField2D::GetFieldValue(const double point[4], double *Bfield) const
   return;
 }
 
-void PHField2D::GetFieldValue_nocache(const double point[4], double *Bfield) const
+bool PHField2D::inside(const float z, const float r) const
 {
-  if (Verbosity() > 2)
-  {
-    std::cout << "\nPHField2D::GetFieldValue" << std::endl;
-  }
-  double x = point[0];
-  double y = point[1];
-  double z = point[2];
-  double r = sqrt(x * x + y * y);
-  double phi;
-  phi = atan2(y, x);
-  if (phi < 0)
-  {
-    phi += 2 * M_PI;  // normalize phi to be over the range [0,2*pi]
-  }
-
-  // Check that the point is within the defined z region (check r in a second)
-  if ((z >= minz_) && (z <= maxz_))
-  {
-    double BFieldCyl[3];
-    double cylpoint[4] = {z, r, phi, 0};
-
-    // take <z,r,phi> location and return a vector of <Bz, Br, Bphi>
-    GetFieldCyl_nocache(cylpoint, BFieldCyl);
-
-    // X direction of B-field ( Bx = Br*cos(phi) - Bphi*sin(phi)
-    Bfield[0] = cos(phi) * BFieldCyl[1] - sin(phi) * BFieldCyl[2];  // unit vector transformations
-
-    // Y direction of B-field ( By = Br*sin(phi) + Bphi*cos(phi)
-    Bfield[1] = sin(phi) * BFieldCyl[1] + cos(phi) * BFieldCyl[2];
-
-    // Z direction of B-field
-    Bfield[2] = BFieldCyl[0];
-  }
-  else  // x,y,z is outside of z range of the field map
+  const std::vector<double> &z_axis = m_Grid.Axis(0);
+  const std::vector<double> &r_axis = m_Grid.Axis(1);
+  if (z < z_axis.front() || z >= z_axis.back())
   {
-    Bfield[0] = 0.0;
-    Bfield[1] = 0.0;
-    Bfield[2] = 0.0;
     if (Verbosity() > 2)
     {
-      std::cout << "!!!!!!!!!! Field point not in defined region (outside of z bounds)" << std::endl;
+      std::cout << "!!!! Point not in defined region (|z| too large)" << std::endl;
     }
+    return false;
   }
-
-  if (Verbosity() > 2)
+  if (r < r_axis.front() || r >= r_axis.back())
   {
-    std::cout << "END PHField2D::GetFieldValue\n"
-              << "  --->  {Bx, By, Bz} : "
-              << "< " << Bfield[0] << ", " << Bfield[1] << ", " << Bfield[2] << " >" << std::endl;
+    if (Verbosity() > 2)
+    {
+      std::cout << "!!!! Point not in defined region (radius too large in specific z-plane)" << std::endl;
+    }
+    return false;
   }
-
-  return;
+  return true;
 }
 
 void PHField2D::GetFieldCyl(const double CylPoint[4], double *BfieldCyl) const
@@ -352,107 +286,14 @@ void PHField2D::GetFieldCyl(const double CylPoint[4], double *BfieldCyl) const
     std::cout << "GetFieldCyl@ <z,r>: {" << z << "," << r << "}" << std::endl;
   }
 
-  if (z < z_map_[0] || z > z_map_[z_map_.size() - 1])
+  if (!inside(z, r))
   {
-    if (Verbosity() > 2)
-    {
-      std::cout << "!!!! Point not in defined region (radius too large in specific z-plane)" << std::endl;
-    }
     return;
   }
 
-  // since GEANT4 looks up the field ~95% of the time in the same voxel
-  // between subsequent calls, we can save on the expense of the upper_bound
-  // lookup (~10-15% of central event run time) with some caching between calls
-  unsigned int r_index0 = r_index0_cache;
-  unsigned int r_index1 = r_index1_cache;
-
-  if (!((r > r_map_[r_index0]) && (r < r_map_[r_index1])))
-  {
-    // if miss cached r values, search through the lookup table
-    std::vector<float>::const_iterator riter = upper_bound(r_map_.begin(), r_map_.end(), r);
-    r_index0 = distance(r_map_.begin(), riter) - 1;
-    if (r_index0 >= r_map_.size())
-    {
-      if (Verbosity() > 2)
-      {
-        std::cout << "!!!! Point not in defined region (radius too large in specific z-plane)" << std::endl;
-      }
-      return;
-    }
-
-    r_index1 = r_index0 + 1;
-    if (r_index1 >= r_map_.size())
-    {
-      if (Verbosity() > 2)
-      {
-        std::cout << "!!!! Point not in defined region (radius too large in specific z-plane)" << std::endl;
-      }
-      return;
-    }
-
-    // update cache
-    r_index0_cache = r_index0;
-    r_index1_cache = r_index1;
-  }
-
-  unsigned int z_index0 = z_index0_cache;
-  unsigned int z_index1 = z_index1_cache;
-
-  if (!((z > z_map_[z_index0]) && (z < z_map_[z_index1])))
-  {
-    // if miss cached z values, search through the lookup table
-    std::vector<float>::const_iterator ziter = upper_bound(z_map_.begin(), z_map_.end(), z);
-    z_index0 = distance(z_map_.begin(), ziter) - 1;
-    z_index1 = z_index0 + 1;
-    if (z_index1 >= z_map_.size())
-    {
-      if (Verbosity() > 2)
-      {
-        std::cout << "!!!! Point not in defined region (z too large in specific r-plane)" << std::endl;
-      }
-      return;
-    }
-
-    // update cache
-    z_index0_cache = z_index0;
-    z_index1_cache = z_index1;
-  }
-
-  double Br000 = BFieldR_[z_index0][r_index0];
-  double Br010 = BFieldR_[z_index0][r_index1];
-  double Br100 = BFieldR_[z_index1][r_index0];
-  double Br110 = BFieldR_[z_index1][r_index1];
-
-  double Bz000 = BFieldZ_[z_index0][r_index0];
-  double Bz100 = BFieldZ_[z_index1][r_index0];
-  double Bz010 = BFieldZ_[z_index0][r_index1];
-  double Bz110 = BFieldZ_[z_index1][r_index1];
-
-  double zweight = z - z_map_[z_index0];
-  double zspacing = z_map_[z_index1] - z_map_[z_index0];
-  zweight /= zspacing;
-
-  double rweight = r - r_map_[r_index0];
-  double rspacing = r_map_[r_index1] - r_map_[r_index0];
-  rweight /= rspacing;
-
-  // Z direction of B-field
-  BfieldCyl[0] =
-      (1 - zweight) * ((1 - rweight) * Bz000 +
-                       rweight * Bz010) +
-      zweight * ((1 - rweight) * Bz100 +
-                 rweight * Bz110);
-
-  // R direction of B-field
-  BfieldCyl[1] =
-      (1 - zweight) * ((1 - rweight) * Br000 +
-                       rweight * Br010) +
-      zweight * ((1 - rweight) * Br100 +
-                 rweight * Br110);
-
-  // PHI Direction of B-field
-  BfieldCyl[2] = 0;
+  // bilinear interpolation of <Bz, Br>, Bphi is 0
+  const double u[3] = {z, r, 0};
+  m_Grid.Interpolate(u, BfieldCyl);
 
   if (Verbosity() > 2)
   {
@@ -464,112 +305,48 @@ void PHField2D::GetFieldCyl(const double CylPoint[4], double *BfieldCyl) const
   return;
 }
 
-
-void PHField2D::GetFieldCyl_nocache(const double CylPoint[4], double *BfieldCyl) const
+void PHField2D::GetFieldValues(const std::size_t npoints, const double *points, double *Bfield, PHFieldCache *cache) const
 {
-  float z = CylPoint[0];
-  float r = CylPoint[1];
-
-  BfieldCyl[0] = 0.0;
-  BfieldCyl[1] = 0.0;
-  BfieldCyl[2] = 0.0;
-
-  if (Verbosity() > 2)
-  {
-    std::cout << "GetFieldCyl@ <z,r>: {" << z << "," << r << "}" << std::endl;
-  }
-
-  if (z < z_map_[0] || z > z_map_[z_map_.size() - 1])
-  {
-    if (Verbosity() > 2)
+  PHFieldGrid::Block block;
+  bool valid[PHFieldGrid::kBlockSize];
+  double cosphi[PHFieldGrid::kBlockSize];
+  double sinphi[PHFieldGrid::kBlockSize];
+  for (std::size_t start = 0; start < npoints; start += PHFieldGrid::kBlockSize)
+  {
+    block.size = std::min(PHFieldGrid::kBlockSize, npoints - start);
+    for (std::size_t k = 0; k < block.size; k++)
     {
-      std::cout << "!!!! Point not in defined region (radius too large in specific z-plane)" << std::endl;
+      // same coordinates and boundaries as GetFieldValue
+      const double *point = points + 4 * (start + k);
+      const double r = std::sqrt(point[0] * point[0] + point[1] * point[1]);
+      double phi = std::atan2(point[1], point[0]);
+      if (phi < 0)
+      {
+        phi += 2 * M_PI;
+      }
+      cosphi[k] = std::cos(phi);
+      sinphi[k] = std::sin(phi);
+      const float zf = point[2];
+      const float rf = r;
+      valid[k] = point[2] >= minz_ && point[2] <= maxz_ && inside(zf, rf);
+      // points outside of the map are interpolated at the grid corner and dropped
+      block.u[0][k] = valid[k] ? zf : m_Grid.Axis(0).front();
+      block.u[1][k] = valid[k] ? rf : m_Grid.Axis(1).front();
+      block.u[2][k] = 0;
     }
-    return;
-  }
 
-  // since GEANT4 looks up the field ~95% of the time in the same voxel
-  // between subsequent calls, we can save on the expense of the upper_bound
-  // lookup (~10-15% of central event run time) with some caching between calls
+    m_Grid.Interpolate(block, cache);
 
-  // if miss cached r values, search through the lookup table
-  std::vector<float>::const_iterator riter = upper_bound(r_map_.begin(), r_map_.end(), r);
-  const unsigned int r_index0 = distance(r_map_.begin(), riter) - 1;
-  if (r_index0 >= r_map_.size())
-  {
-    if (Verbosity() > 2)
+    for (std::size_t k = 0; k < block.size; k++)
     {
-      std::cout << "!!!! Point not in defined region (radius too large in specific z-plane)" << std::endl;
+      double *bf = Bfield + 3 * (start + k);
+      const double bz = valid[k] ? block.b[0][k] : 0.0;
+      const double br = valid[k] ? block.b[1][k] : 0.0;
+      bf[0] = cosphi[k] * br;
+      bf[1] = sinphi[k] * br;
+      bf[2] = bz;
     }
-    return;
   }
-
-  const unsigned int r_index1 = r_index0 + 1;
-  if (r_index1 >= r_map_.size())
-  {
-    if (Verbosity() > 2)
-    {
-      std::cout << "!!!! Point not in defined region (radius too large in specific z-plane)" << std::endl;
-    }
-    return;
-  }
-
-  // if miss cached z values, search through the lookup table
-  std::vector<float>::const_iterator ziter = upper_bound(z_map_.begin(), z_map_.end(), z);
-  const unsigned int z_index0 = distance(z_map_.begin(), ziter) - 1;
-  const unsigned int z_index1 = z_index0 + 1;
-  if (z_index1 >= z_map_.size())
-  {
-    if (Verbosity() > 2)
-    {
-      std::cout << "!!!! Point not in defined region (z too large in specific r-plane)" << std::endl;
-    }
-    return;
-  }
-
-  double Br000 = BFieldR_[z_index0][r_index0];
-  double Br010 = BFieldR_[z_index0][r_index1];
-  double Br100 = BFieldR_[z_index1][r_index0];
-  double Br110 = BFieldR_[z_index1][r_index1];
-
-  double Bz000 = BFieldZ_[z_index0][r_index0];
-  double Bz100 = BFieldZ_[z_index1][r_index0];
-  double Bz010 = BFieldZ_[z_index0][r_index1];
-  double Bz110 = BFieldZ_[z_index1][r_index1];
-
-  double zweight = z - z_map_[z_index0];
-  double zspacing = z_map_[z_index1] - z_map_[z_index0];
-  zweight /= zspacing;
-
-  double rweight = r - r_map_[r_index0];
-  double rspacing = r_map_[r_index1] - r_map_[r_index0];
-  rweight /= rspacing;
-
-  // Z direction of B-field
-  BfieldCyl[0] =
-      (1 - zweight) * ((1 - rweight) * Bz000 +
-                       rweight * Bz010) +
-      zweight * ((1 - rweight) * Bz100 +
-                 rweight * Bz110);
-
-  // R direction of B-field
-  BfieldCyl[1] =
-      (1 - zweight) * ((1 - rweight) * Br000 +
-                       rweight * Br010) +
-      zweight * ((1 - rweight) * Br100 +
-                 rweight * Br110);
-
-  // PHI Direction of B-field
-  BfieldCyl[2] = 0;
-
-  if (Verbosity() > 2)
-  {
-    std::cout << "End GFCyl Call: <bz,br,bphi> : {"
-              << BfieldCyl[0] / gauss << "," << BfieldCyl[1] / gauss << "," << BfieldCyl[2] / gauss << "}"
-              << std::endl;
-  }
-
-  return;
 }
 
 // debug function to print key/value pairs in map
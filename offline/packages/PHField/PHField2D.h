@@ -3,11 +3,11 @@
 #define PHFIELD_PHFIELD2D_H
 
 #include "PHField.h"
+#include "PHFieldGrid.h"
 
 #include <map>
 #include <string>
 #include <tuple>
-#include <vector>
 
 class PHField2D : public PHField
 {
@@ -22,40 +22,31 @@ class PHField2D : public PHField
   //! @param[out] Bfield  field value. In the case of magnetic field, the order is Bx, By, Bz in in Geant4/CLHEP units
   void GetFieldValue(const double Point[4], double *Bfield) const override;
 
-  //! access field value
-  void GetFieldValue_nocache(const double Point[4], double *Bfield) const override;
+  //! access field value, no internal cache, same as GetFieldValue
+  void GetFieldValue_nocache(const double Point[4], double *Bfield) const override
+  { GetFieldValue(Point, Bfield); }
+
+  //! field values at npoints points, see PHField
+  void GetFieldValues(const std::size_t npoints, const double *Points, double *Bfield, PHFieldCache *cache = nullptr) const override;
 
   void GetFieldCyl(const double CylPoint[4], double *Bfield) const;
 
-  void GetFieldCyl_nocache(const double CylPoint[4], double *Bfield) const;
+  //! same as GetFieldCyl
+  void GetFieldCyl_nocache(const double CylPoint[4], double *Bfield) const
+  { GetFieldCyl(CylPoint, Bfield); }
 
   protected:
-  // < i, j, k > , this allows i and i+1 to be neighbors ( <i,j,k>=<z,r,phi> )
-  std::vector<std::vector<float> > BFieldZ_;
-  std::vector<std::vector<float> > BFieldR_;
-  std::vector<std::vector<float> > BFieldPHI_;
-
-  // maps indices to values z_map[i] = z_value that corresponds to ith index
-  std::vector<float> z_map_;    // < i >
-  std::vector<float> r_map_;    // < j >
-  std::vector<float> phi_map_;  // < k >
+  //! z, r grid of bz, br, 0 (the third axis has a single value)
+  PHFieldGrid m_Grid;
 
   float maxz_, minz_;  // boundaries of magnetic field map cyl
   double magfield_unit;
 
  private:
+  //! true if (z, r) is inside of the map
+  bool inside(const float z, const float r) const;
+
   void print_map(std::map<trio, trio>::iterator &it) const;
-  // mutable allows to change internal data even in const methods
-  // I don't like this too much but these are cached values to speed up
-  // the field lookup by a lot
-  // I want them to be data members so we can run 2 fieldmaps in parallel
-  // and still have caching. Putting those as static variables into
-  // the implementation will prevent this
-
-  mutable unsigned int r_index0_cache;
-  mutable unsigned int r_index1_cache;
-  mutable unsigned int z_index0_cache;
-  mutable unsigned int z_index1_cache;
 };
 
 #endif
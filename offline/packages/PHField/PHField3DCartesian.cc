@@ -11,32 +11,21 @@
 
 #include <boost/stacktrace.hpp>
 
-#include <cassert>
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cmath>
 #include <cstdlib>
 #include <iostream>
-#include <iterator>
+#include <limits>
 #include <set>
-#include <utility>
+#include <vector>
 
 PHField3DCartesian::PHField3DCartesian(const std::string &fname, const float magfield_rescale, const float innerradius, const float outerradius, const float size_z)
   : filename(fname)
 {
   std::cout << "PHField3DCartesian::PHField3DCartesian" << std::endl;
 
-  for (int i = 0; i < 2; i++) // NOLINT (modernize-loop-convert)
-  {
-    for (int j = 0; j < 2; j++)
-    {
-      for (int k = 0; k < 2; k++)
-      {
-        for (int l = 0; l < 3; l++)
-        {
-          bf[i][j][k][l] = {std::numeric_limits<double>::quiet_NaN()};
-        }
-      }
-    }
-  }
   std::cout << "\n================ Begin Construct Mag Field =====================" << std::endl;
   std::cout << "\n-----------------------------------------------------------"
             << "\n      Magnetic field Module - Verbosity:"
@@ -76,11 +65,15 @@ PHField3DCartesian::PHField3DCartesian(const std::string &fname, const float mag
   field_map->SetBranchAddress("bx", &ROOT_BX);
   field_map->SetBranchAddress("by", &ROOT_BY);
   field_map->SetBranchAddress("bz", &ROOT_BZ);
+
+  // grid points inside the selection, x, y, z, bx, by, bz
+  std::vector<std::array<float, 6>> entries;
+  std::set<float> xvals;
+  std::set<float> yvals;
+  std::set<float> zvals;
   for (int i = 0; i < field_map->GetEntries(); i++)
   {
     field_map->GetEntry(i);
-    trio coord_key(ROOT_X * cm, ROOT_Y * cm, ROOT_Z * cm);
-    trio field_val(ROOT_BX * tesla * magfield_rescale, ROOT_BY * tesla * magfield_rescale, ROOT_BZ * tesla * magfield_rescale);
     xvals.insert(ROOT_X * cm);
     yvals.insert(ROOT_Y * cm);
     zvals.insert(ROOT_Z * cm);
@@ -88,7 +81,10 @@ PHField3DCartesian::PHField3DCartesian(const std::string &fname, const float mag
          std::sqrt(ROOT_X * cm * ROOT_X * cm + ROOT_Y * cm * ROOT_Y * cm) <= outerradius) ||
         std::abs(ROOT_Z * cm) > size_z)
     {
-      fieldmap[coord_key] = field_val;
+      entries.push_back({static_cast<float>(ROOT_X * cm), static_cast<float>(ROOT_Y * cm), static_cast<float>(ROOT_Z * cm),
+                         static_cast<float>(ROOT_BX * tesla * magfield_rescale),
+                         static_cast<float>(ROOT_BY * tesla * magfield_rescale),
+                         static_cast<float>(ROOT_BZ * tesla * magfield_rescale)});
     }
   }
   xmin = *(xvals.begin());
@@ -106,9 +102,18 @@ PHField3DCartesian::PHField3DCartesian(const std::string &fname, const float mag
   zmin = *(zvals.begin());
   zmax = *(zvals.rbegin());
 
-  xstepsize = (xmax - xmin) / (xvals.size() - 1);
-  ystepsize = (ymax - ymin) / (yvals.size() - 1);
-  zstepsize = (zmax - zmin) / (zvals.size() - 1);
+  // grid points which are not in the map stay NaN, lookups using them return zero field
+  m_Grid.SetAxes(std::vector<double>(xvals.begin(), xvals.end()),
+                 std::vector<double>(yvals.begin(), yvals.end()),
+                 std::vector<double>(zvals.begin(), zvals.end()),
+                 std::numeric_limits<float>::quiet_NaN());
+  for (const auto &entry : entries)
+  {
+    float *bf = m_Grid.Field(m_Grid.Index(0, entry[0]), m_Grid.Index(1, entry[1]), m_Grid.Index(2, entry[2]));
+    bf[0] = entry[3];
+    bf[1] = entry[4];
+    bf[2] = entry[5];
+  }
 
   delete field_map;
   delete rootinput;
@@ -116,366 +121,108 @@ PHField3DCartesian::PHField3DCartesian(const std::string &fname, const float mag
             << std::endl;
 }
 
-PHField3DCartesian::~PHField3DCartesian()
+bool PHField3DCartesian::inside(const double point[4]) const
 {
-  if (Verbosity() > 0)
-  {
-    std::cout << "PHField3DCartesian: cache hits: " << cache_hits
-              << " cache misses: " << cache_misses
+  return point[0] >= xmin && point[0] <= xmax &&
+         point[1] >= ymin && point[1] <= ymax &&
+         point[2] >= zmin && point[2] <= zmax;
+}
+
+void PHField3DCartesian::report_invalid(const double point[4]) const
+{
+  static std::atomic<int> ifirst = 0;
+  if (ifirst++ < 10)
+  {
+    std::cout << "PHField3DCartesian::GetFieldValue: "
+              << "Invalid coordinates: "
+              << "x: " << point[0] / cm
+              << ", y: " << point[1] / cm
+              << ", z: " << point[2] / cm
+              << " bailing out returning zero bfield"
               << std::endl;
+    std::cout << "Here is the stacktrace: " << std::endl;
+    std::cout << boost::stacktrace::stacktrace();
+    std::cout << "This is not a segfault. Check the stacktrace for the guilty party (typically #2)" << std::endl;
   }
 }
 
-void PHField3DCartesian::GetFieldValue(const double point[4], double *Bfield) const
+void PHField3DCartesian::report_missing(const double point[4]) const
 {
+  std::cout << PHWHERE << " grid point missing in " << filename
+            << " for x: " << point[0] / cm
+            << ", y: " << point[1] / cm
+            << ", z: " << point[2] / cm << std::endl;
+}
 
-  static double xsav = -1000000.;
-  static double ysav = -1000000.;
-  static double zsav = -1000000.;
-
-  const double& x = point[0];
-  const double& y = point[1];
-  const double& z = point[2];
-
+void PHField3DCartesian::GetFieldValue(const double point[4], double *Bfield) const
+{
   Bfield[0] = 0.0;
   Bfield[1] = 0.0;
   Bfield[2] = 0.0;
-  if (!std::isfinite(x) || !std::isfinite(y) || !std::isfinite(z))
+  if (!std::isfinite(point[0]) || !std::isfinite(point[1]) || !std::isfinite(point[2]))
   {
-    static int ifirst = 0;
-    if (ifirst < 10)
-    {
-      std::cout << "PHField3DCartesian::GetFieldValue: "
-        << "Invalid coordinates: "
-        << "x: " << x / cm
-        << ", y: " << y / cm
-        << ", z: " << z / cm
-        << " bailing out returning zero bfield"
-        << std::endl;
-      std::cout << "previous point: "
-        << "x: " << xsav / cm
-        << ", y: " << ysav / cm
-        << ", z: " << zsav / cm
-        << std::endl;
-      std::cout << "Here is the stacktrace: " << std::endl;
-      std::cout << boost::stacktrace::stacktrace();
-      std::cout << "This is not a segfault. Check the stacktrace for the guilty party (typically #2)" << std::endl;
-      ifirst++;
-    }
+    report_invalid(point);
     return;
   }
-
-  xsav = x;
-  ysav = y;
-  zsav = z;
-
-  if (point[0] < xmin || point[0] > xmax ||
-      point[1] < ymin || point[1] > ymax ||
-      point[2] < zmin || point[2] > zmax)
+  if (!inside(point))
   {
     return;
   }
 
-  double xkey[2];
-  std::set<float>::const_iterator it = xvals.lower_bound(x);
-  xkey[0] = *it;
-  if (it == xvals.begin())
-  {
-    xkey[1] = *it;
-    if (x < xkey[0])
-    {
-      std::cout << PHWHERE << ": This should not happen! x too small - outside range: " << x / cm << std::endl;
-      return;
-    }
-  }
-  else
-  {
-    --it;
-    xkey[1] = *it;
-  }
-
-  double ykey[2];
-  it = yvals.lower_bound(y);
-  ykey[0] = *it;
-  if (it == yvals.begin())
+  // trilinear interpolation in the grid cell
+  double bf[3];
+  m_Grid.Interpolate(point, bf);
+  if (std::isnan(bf[0]) || std::isnan(bf[1]) || std::isnan(bf[2]))
   {
-    ykey[1] = *it;
-    if (y < ykey[0])
-    {
-      std::cout << PHWHERE << ": This should not happen! y too small - outside range: " << y / cm << std::endl;
-      return;
-    }
-  }
-  else
-  {
-    --it;
-    ykey[1] = *it;
-  }
-  double zkey[2];
-  it = zvals.lower_bound(z);
-  zkey[0] = *it;
-  if (it == zvals.begin())
-  {
-    zkey[1] = *it;
-    if (z < zkey[0])
-    {
-      std::cout << PHWHERE << ": This should not happen! z too small - outside range: " << z / cm << std::endl;
-      return;
-    }
-  }
-  else
-  {
-    --it;
-    zkey[1] = *it;
-  }
-
-  if (xkey_save != xkey[0] ||
-      ykey_save != ykey[0] ||
-      zkey_save != zkey[0])
-  {
-    cache_misses++;
-    xkey_save = xkey[0];
-    ykey_save = ykey[0];
-    zkey_save = zkey[0];
-
-    std::map<std::tuple<float, float, float>, std::tuple<float, float, float> >::const_iterator magval;
-    trio key;
-    for (int i = 0; i < 2; i++)
-    {
-      for (int j = 0; j < 2; j++)
-      {
-        for (int k = 0; k < 2; k++)
-        {
-          key = std::make_tuple(xkey[i], ykey[j], zkey[k]);
-          magval = fieldmap.find(key);
-          if (magval == fieldmap.end())
-          {
-            std::cout << PHWHERE << " could not locate key in " << filename
-                      << " value: x: " << xkey[i] / cm
-                      << ", y: " << ykey[j] / cm
-                      << ", z: " << zkey[k] / cm << std::endl;
-            return;
-          }
-          bf[i][j][k][0] = std::get<0>(magval->second);
-          bf[i][j][k][1] = std::get<1>(magval->second);
-          bf[i][j][k][2] = std::get<2>(magval->second);
-          if (Verbosity() > 0)
-          {
-            const double x_loc = std::get<0>(magval->first);
-            const double y_loc = std::get<1>(magval->first);
-            const double z_loc = std::get<2>(magval->first);
-
-            std::cout << "read x/y/z: " << x_loc / cm << "/"
-              << y_loc / cm << "/"
-              << z_loc / cm << " bx/by/bz: "
-              << bf[i][j][k][0] / tesla << "/"
-              << bf[i][j][k][1] / tesla << "/"
-              << bf[i][j][k][2] / tesla << std::endl;
-          }
-        }
-      }
-    }
-  }
-  else
-  {
-    cache_hits++;
+    report_missing(point);
+    return;
   }
-
-  // how far are we away from the reference point
-  double xinblock = point[0] - xkey[1];
-  double yinblock = point[1] - ykey[1];
-  double zinblock = point[2] - zkey[1];
-  // normalize distance to step size
-  double fractionx = xinblock / xstepsize;
-  double fractiony = yinblock / ystepsize;
-  double fractionz = zinblock / zstepsize;
   if (Verbosity() > 0)
   {
-    std::cout << "x/y/z stepsize: " << xstepsize / cm << "/" << ystepsize / cm << "/" << zstepsize / cm << std::endl;
-    std::cout << "x/y/z inblock: " << xinblock / cm << "/" << yinblock / cm << "/" << zinblock / cm << std::endl;
-    std::cout << "x/y/z fraction: " << fractionx << "/" << fractiony << "/" << fractionz << std::endl;
+    std::cout << "x/y/z: " << point[0] / cm << "/" << point[1] / cm << "/" << point[2] / cm
+              << " bx/by/bz: " << bf[0] / tesla << "/" << bf[1] / tesla << "/" << bf[2] / tesla << std::endl;
   }
-
-  // linear extrapolation in cube:
-
-  // Vxyz =
-  // V000 * x * y * z +
-  // V100 * (1 - x) * y * z +
-  // V010 * x * (1 - y) * z +
-  // V001 * x y * (1 - z) +
-  // V101 * (1 - x) * y * (1 - z) +
-  // V011 * x * (1 - y) * (1 - z) +
-  // V110 * (1 - x) * (1 - y) * z +
-  // V111 * (1 - x) * (1 - y) * (1 - z)
-
-  for (int i = 0; i < 3; i++)
-  {
-    Bfield[i] = bf[0][0][0][i] * fractionx * fractiony * fractionz +
-                bf[1][0][0][i] * (1. - fractionx) * fractiony * fractionz +
-                bf[0][1][0][i] * fractionx * (1. - fractiony) * fractionz +
-                bf[0][0][1][i] * fractionx * fractiony * (1. - fractionz) +
-                bf[1][0][1][i] * (1. - fractionx) * fractiony * (1. - fractionz) +
-                bf[0][1][1][i] * fractionx * (1. - fractiony) * (1. - fractionz) +
-                bf[1][1][0][i] * (1. - fractionx) * (1. - fractiony) * fractionz +
-                bf[1][1][1][i] * (1. - fractionx) * (1. - fractiony) * (1. - fractionz);
-  }
-
-  return;
+  Bfield[0] = bf[0];
+  Bfield[1] = bf[1];
+  Bfield[2] = bf[2];
 }
 
 //_____________________________________________________________
-void PHField3DCartesian::GetFieldValue_nocache(const double point[4], double *Bfield) const
+void PHField3DCartesian::GetFieldValues(const std::size_t npoints, const double *points, double *Bfield, PHFieldCache *cache) const
 {
-
-  const double& x = point[0];
-  const double& y = point[1];
-  const double& z = point[2];
-
-  Bfield[0] = 0.0;
-  Bfield[1] = 0.0;
-  Bfield[2] = 0.0;
-  if (!std::isfinite(x) || !std::isfinite(y) || !std::isfinite(z))
-  { return; }
-
-  if (point[0] < xmin || point[0] > xmax ||
-      point[1] < ymin || point[1] > ymax ||
-      point[2] < zmin || point[2] > zmax)
-  { return; }
-
-  double xkey[2];
-  std::set<float>::const_iterator it = xvals.lower_bound(x);
-  xkey[0] = *it;
-  if (it == xvals.begin())
-  {
-    xkey[1] = *it;
-    if (x < xkey[0])
-    {
-      std::cout << PHWHERE << ": This should not happen! x too small - outside range: " << x / cm << std::endl;
-      return;
-    }
-  }
-  else
-  {
-    --it;
-    xkey[1] = *it;
-  }
-
-  double ykey[2];
-  it = yvals.lower_bound(y);
-  ykey[0] = *it;
-  if (it == yvals.begin())
+  PHFieldGrid::Block block;
+  bool valid[PHFieldGrid::kBlockSize];
+  for (std::size_t start = 0; start < npoints; start += PHFieldGrid::kBlockSize)
   {
-    ykey[1] = *it;
-    if (y < ykey[0])
+    block.size = std::min(PHFieldGrid::kBlockSize, npoints - start);
+    for (std::size_t k = 0; k < block.size; k++)
     {
-      std::cout << PHWHERE << ": This should not happen! y too small - outside range: " << y / cm << std::endl;
-      return;
-    }
-  }
-  else
-  {
-    --it;
-    ykey[1] = *it;
-  }
-  double zkey[2];
-  it = zvals.lower_bound(z);
-  zkey[0] = *it;
-  if (it == zvals.begin())
-  {
-    zkey[1] = *it;
-    if (z < zkey[0])
-    {
-      std::cout << PHWHERE << ": This should not happen! z too small - outside range: " << z / cm << std::endl;
-      return;
+      const double *point = points + 4 * (start + k);
+      valid[k] = std::isfinite(point[0]) && std::isfinite(point[1]) && std::isfinite(point[2]);
+      if (!valid[k])
+      {
+        report_invalid(point);
+      }
+      valid[k] = valid[k] && inside(point);
+      // points outside of the grid are interpolated at its corner and dropped
+      block.u[0][k] = valid[k] ? point[0] : xmin;
+      block.u[1][k] = valid[k] ? point[1] : ymin;
+      block.u[2][k] = valid[k] ? point[2] : zmin;
     }
-  }
-  else
-  {
-    --it;
-    zkey[1] = *it;
-  }
 
-  // local xyz and field
-  double bf_loc[2][2][2][3]{};
+    m_Grid.Interpolate(block, cache);
 
-  std::map<std::tuple<float, float, float>, std::tuple<float, float, float> >::const_iterator magval;
-  trio key;
-  for (int i = 0; i < 2; i++)
-  {
-    for (int j = 0; j < 2; j++)
+    for (std::size_t k = 0; k < block.size; k++)
     {
-      for (int k = 0; k < 2; k++)
+      double *bf = Bfield + 3 * (start + k);
+      if (valid[k] && (std::isnan(block.b[0][k]) || std::isnan(block.b[1][k]) || std::isnan(block.b[2][k])))
       {
-        key = std::make_tuple(xkey[i], ykey[j], zkey[k]);
-        magval = fieldmap.find(key);
-        if (magval == fieldmap.end())
-        {
-          std::cout << PHWHERE << " could not locate key in " << filename
-            << " value: x: " << xkey[i] / cm
-            << ", y: " << ykey[j] / cm
-            << ", z: " << zkey[k] / cm << std::endl;
-          return;
-        }
-
-        bf_loc[i][j][k][0] = std::get<0>(magval->second);
-        bf_loc[i][j][k][1] = std::get<1>(magval->second);
-        bf_loc[i][j][k][2] = std::get<2>(magval->second);
-        if (Verbosity() > 0)
-        {
-
-          const double x_loc = std::get<0>(magval->first);
-          const double y_loc = std::get<1>(magval->first);
-          const double z_loc = std::get<2>(magval->first);
-
-          std::cout << "read x/y/z: " << x_loc / cm << "/"
-            << y_loc / cm << "/"
-            << z_loc / cm << " bx/by/bz: "
-            << bf_loc[i][j][k][0] / tesla << "/"
-            << bf_loc[i][j][k][1] / tesla << "/"
-            << bf_loc[i][j][k][2] / tesla << std::endl;
-        }
+        report_missing(points + 4 * (start + k));
+        valid[k] = false;
       }
+      bf[0] = valid[k] ? block.b[0][k] : 0.0;
+      bf[1] = valid[k] ? block.b[1][k] : 0.0;
+      bf[2] = valid[k] ? block.b[2][k] : 0.0;
     }
   }
-
-  // how far are we away from the reference point
-  double xinblock = point[0] - xkey[1];
-  double yinblock = point[1] - ykey[1];
-  double zinblock = point[2] - zkey[1];
-  // normalize distance to step size
-  double fractionx = xinblock / xstepsize;
-  double fractiony = yinblock / ystepsize;
-  double fractionz = zinblock / zstepsize;
-  if (Verbosity() > 0)
-  {
-    std::cout << "x/y/z stepsize: " << xstepsize / cm << "/" << ystepsize / cm << "/" << zstepsize / cm << std::endl;
-    std::cout << "x/y/z inblock: " << xinblock / cm << "/" << yinblock / cm << "/" << zinblock / cm << std::endl;
-    std::cout << "x/y/z fraction: " << fractionx << "/" << fractiony << "/" << fractionz << std::endl;
-  }
-
-  // linear extrapolation in cube:
-
-  // Vxyz =
-  // V000 * x * y * z +
-  // V100 * (1 - x) * y * z +
-  // V010 * x * (1 - y) * z +
-  // V001 * x y * (1 - z) +
-  // V101 * (1 - x) * y * (1 - z) +
-  // V011 * x * (1 - y) * (1 - z) +
-  // V110 * (1 - x) * (1 - y) * z +
-  // V111 * (1 - x) * (1 - y) * (1 - z)
-
-  for (int i = 0; i < 3; i++)
-  {
-    Bfield[i] = bf_loc[0][0][0][i] * fractionx * fractiony * fractionz +
-                bf_loc[1][0][0][i] * (1. - fractionx) * fractiony * fractionz +
-                bf_loc[0][1][0][i] * fractionx * (1. - fractiony) * fractionz +
-                bf_loc[0][0][1][i] * fractionx * fractiony * (1. - fractionz) +
-                bf_loc[1][0][1][i] * (1. - fractionx) * fractiony * (1. - fractionz) +
-                bf_loc[0][1][1][i] * fractionx * (1. - fractiony) * (1. - fractionz) +
-                bf_loc[1][1][0][i] * (1. - fractionx) * (1. - fractiony) * fractionz +
-                bf_loc[1][1][1][i] * (1. - fractionx) * (1. - fractiony) * (1. - fractionz);
-  }
-
-  return;
 }
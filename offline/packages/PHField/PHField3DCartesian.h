@@ -2,12 +2,9 @@
 #define PHFIELD_PHFIELD3DCARTESIAN_H
 
 #include "PHField.h"
+#include "PHFieldGrid.h"
 
-#include <limits>
-#include <map>
-#include <set>
 #include <string>
-#include <tuple>
 
 class PHField3DCartesian : public PHField
 {
@@ -17,7 +14,7 @@ class PHField3DCartesian : public PHField
   explicit PHField3DCartesian(const std::string &fname, const float magfield_rescale = 1.0, const float innerradius = 0, const float outerradius = 1.e10, const float size_z = 1.e10);
 
   //! destructor
-  ~PHField3DCartesian() override;
+  ~PHField3DCartesian() override = default;
 
   //! access field value
   //! Follow the convention of G4ElectroMagneticField
@@ -25,9 +22,23 @@ class PHField3DCartesian : public PHField
   //! @param[out] Bfield  field value. In the case of magnetic field, the order is Bx, By, Bz in in Geant4/CLHEP units
   void GetFieldValue(const double Point[4], double *Bfield) const override;
 
-  void GetFieldValue_nocache(const double Point[4], double *Bfield) const override;
+  //! no internal cache, same as GetFieldValue
+  void GetFieldValue_nocache(const double Point[4], double *Bfield) const override
+  { GetFieldValue(Point, Bfield); }
+
+  //! field values at npoints points, see PHField
+  void GetFieldValues(const std::size_t npoints, const double *Points, double *Bfield, PHFieldCache *cache = nullptr) const override;
 
   private:
+  //! true if the point is inside the grid
+  bool inside(const double Point[4]) const;
+
+  //! complain about a non finite point
+  void report_invalid(const double Point[4]) const;
+
+  //! complain about an interpolation using grid points outside of the innerradius/outerradius/size_z selection
+  void report_missing(const double Point[4]) const;
+
   std::string filename;
   double xmin {1000000};
   double xmax {-1000000};
@@ -35,24 +46,9 @@ class PHField3DCartesian : public PHField
   double ymax {-1000000};
   double zmin {1000000};
   double zmax {-1000000};
-  double xstepsize {std::numeric_limits<double>::quiet_NaN()};
-  double ystepsize {std::numeric_limits<double>::quiet_NaN()};
-  double zstepsize {std::numeric_limits<double>::quiet_NaN()};
-
-  // these are updated in a const method
-  // to cache previous values
-  mutable double bf[2][2][2][3]{};
-  mutable double xkey_save {std::numeric_limits<double>::quiet_NaN()};
-  mutable double ykey_save {std::numeric_limits<double>::quiet_NaN()};
-  mutable double zkey_save {std::numeric_limits<double>::quiet_NaN()};
-  mutable int cache_hits {0};
-  mutable int cache_misses {0};
-
-  typedef std::tuple<float, float, float> trio;
-  std::map<std::tuple<float, float, float>, std::tuple<float, float, float> > fieldmap;
-  std::set<float> xvals;
-  std::set<float> yvals;
-  std::set<float> zvals;
+
+  //! x, y, z grid, grid points outside of the selection are NaN
+  PHFieldGrid m_Grid;
 };
 
 #endif
@@ -7,13 +7,12 @@
 #include <Geant4/G4SystemOfUnits.hh>
 
 #include <algorithm>
-#include <cassert>
 #include <cmath>
 #include <cstdlib>
 #include <iostream>
-#include <iterator>
 #include <set>
 #include <utility>
+#include <vector>
 
 PHField3DCylindrical::PHField3DCylindrical(const std::string &filename, const int verb, const float magfield_rescale)
   : PHField(verb)
@@ -126,31 +125,21 @@ PHField3DCylindrical::PHField3DCylindrical(const std::string &filename, const in
 
   // grab the minimum and maximum z values
   minz_ = *(z_set.begin());
-  std::set<float>::iterator ziter = z_set.end();
-  --ziter;
-  maxz_ = *ziter;
-
-  // initialize maps
-  nz = z_set.size();
-  nr = r_set.size();
-  nphi = phi_set.size();
-  r_map_.resize(nr, 0);
-  z_map_.resize(nz, 0);
-  phi_map_.resize(nphi, 0);
-
-  std::copy(z_set.begin(), z_set.end(), z_map_.begin());
-  std::copy(phi_set.begin(), phi_set.end(), phi_map_.begin());
-  std::copy(r_set.begin(), r_set.end(), r_map_.begin());
-
-  // initialize the field map vectors to the correct sizes
-  BFieldR_.resize(nz, std::vector<std::vector<float> >(nr, std::vector<float>(nphi, 0)));
-  BFieldPHI_.resize(nz, std::vector<std::vector<float> >(nr, std::vector<float>(nphi, 0)));
-  BFieldZ_.resize(nz, std::vector<std::vector<float> >(nr, std::vector<float>(nphi, 0)));
-
-  // all of this assumes that  z_prev < z , i.e. the table is ordered (as of right now)
-  unsigned int ir = 0;
-  unsigned int iphi = 0;
-  unsigned int iz = 0;  // useful indexes to keep track of
+  maxz_ = *(z_set.rbegin());
+
+  // z, r, phi grid, the first phi plane is repeated after the last one at +2pi,
+  // unless the map already has it (e.g. both 0 and 360 degrees)
+  std::vector<double> phi_axis(phi_set.begin(), phi_set.end());
+  static constexpr double phi_tolerance = 1e-4;
+  const bool wrap_phi = phi_axis.back() < phi_axis.front() + 2 * M_PI - phi_tolerance;
+  if (wrap_phi)
+  {
+    phi_axis.push_back(phi_axis.front() + 2 * M_PI);
+  }
+  m_Grid.SetAxes(std::vector<double>(z_set.begin(), z_set.end()),
+                 std::vector<double>(r_set.begin(), r_set.end()),
+                 phi_axis);
+
   std::map<trio, trio>::iterator iter = sorted_map.begin();
   for (; iter != sorted_map.end(); ++iter)
   {
@@ -162,50 +151,32 @@ PHField3DCylindrical::PHField3DCylindrical(const std::string &filename, const in
     float Br = std::get<1>(iter->second) * gauss;
     float Bphi = std::get<2>(iter->second) * gauss;
 
-    maxz_ = std::max(z, maxz_);
-    minz_ = std::min(z, minz_);
-
-    // check for change in z value, when z changes we have a ton of updates to do
-    if (z != z_map_[iz])
+    const std::size_t iz = m_Grid.Index(0, z);
+    const std::size_t ir = m_Grid.Index(1, r);
+    const std::size_t iphi = m_Grid.Index(2, phi);
+    float *bf = m_Grid.Field(iz, ir, iphi);
+    bf[0] = Bz * magfield_rescale;
+    bf[1] = Br * magfield_rescale;
+    bf[2] = Bphi * magfield_rescale;
+    if (wrap_phi && iphi == 0)
     {
-      ++iz;
-      ir = 0;
-      iphi = 0;  // reset indices
-    }
-    else if (r != r_map_[ir])
-    {  // check for change in r value
-      ++ir;
-      iphi = 0;
-    }
-    else if (phi != phi_map_[iphi])
-    {  // change in phi value? (should be every time)
-      ++iphi;
+      std::copy(bf, bf + 3, m_Grid.Field(iz, ir, phi_set.size()));
     }
 
-    // shouldn't happen
-    if (iz > 0 && z < z_map_[iz - 1])
-    {
-      std::cout << "!!!!!!!!! Your map isn't ordered.... z: " << z << " zprev: " << z_map_[iz - 1] << std::endl;
-    }
-
-    BFieldR_[iz][ir][iphi] = Br * magfield_rescale;
-    BFieldPHI_[iz][ir][iphi] = Bphi * magfield_rescale;
-    BFieldZ_[iz][ir][iphi] = Bz * magfield_rescale;
-
     // you can change this to check table values for correctness
     // print_map prints the values in the root table, and the
-    // std::couts print the values entered into the vectors
+    // std::couts print the values entered into the grid
     if (std::fabs(z) < 10 && ir < 10 /*&& iphi==2*/ && Verbosity() > 3)
     {
       print_map(iter);
 
       std::cout << " B("
-                << r_map_[ir] << ", "
-                << phi_map_[iphi] << ", "
-                << z_map_[iz] << "):  ("
-                << BFieldR_[iz][ir][iphi] << ", "
-                << BFieldPHI_[iz][ir][iphi] << ", "
-                << BFieldZ_[iz][ir][iphi] << ")" << std::endl;
+                << m_Grid.Axis(1)[ir] << ", "
+                << m_Grid.Axis(2)[iphi] << ", "
+                << m_Grid.Axis(0)[iz] << "):  ("
+                << bf[1] << ", "
+                << bf[2] << ", "
+                << bf[0] << ")" << std::endl;
     }
 
   }  // end loop over root field map file
@@ -284,166 +255,61 @@ void PHField3DCylindrical::GetFieldValue(const double point[4], double *Bfield)
   return;
 }
 
-void PHField3DCylindrical::GetFieldCyl(const double CylPoint[4], double *BfieldCyl) const
+bool PHField3DCylindrical::grid_point(float z, float r, float phi, double u[3]) const
 {
-  float z = CylPoint[0];
-  float r = CylPoint[1];
-  float phi = CylPoint[2];
-
-  BfieldCyl[0] = 0.0;
-  BfieldCyl[1] = 0.0;
-  BfieldCyl[2] = 0.0;
-
-  if (Verbosity() > 2)
-  {
-    std::cout << "GetFieldCyl@ <z,r,phi>: {" << z << "," << r << "," << phi << "}" << std::endl;
-  }
-
-  if (z <= z_map_[0] || z >= z_map_[z_map_.size() - 1])
+  const std::vector<double> &z_axis = m_Grid.Axis(0);
+  const std::vector<double> &r_axis = m_Grid.Axis(1);
+  const std::vector<double> &phi_axis = m_Grid.Axis(2);
+  if (z <= z_axis.front() || z >= z_axis.back())
   {
     if (Verbosity() > 2)
     {
       std::cout << "!!!! Point not in defined region (|z| too large)" << std::endl;
     }
-    return;
+    return false;
   }
-  if (r < r_map_[0])
+  if (r < r_axis.front())
   {
-    r = r_map_[0];
+    r = r_axis.front();
     if (Verbosity() > 2)
     {
       std::cout << "!!!! Point not in defined region (radius too small in specific z-plane). Use min radius" << std::endl;
     }
-    //    return;
   }
-  if (r > r_map_[r_map_.size() - 1])
+  if (r >= r_axis.back())
   {
     if (Verbosity() > 2)
     {
       std::cout << "!!!! Point not in defined region (radius too large in specific z-plane)" << std::endl;
     }
-    return;
+    return false;
   }
+  // the grid covers [phi0, phi0 + 2pi]
+  u[0] = z;
+  u[1] = r;
+  u[2] = (phi < phi_axis.front()) ? phi + 2 * M_PI : phi;
+  return true;
+}
 
-  std::vector<float>::const_iterator ziter = upper_bound(z_map_.begin(), z_map_.end(), z);
-  int z_index0 = distance(z_map_.begin(), ziter) - 1;
-  int z_index1 = z_index0 + 1;
-
-  assert(z_index0 >= 0);
-  assert(z_index1 >= 0);
-  assert(z_index0 < (int) z_map_.size());
-  assert(z_index1 < (int) z_map_.size());
+void PHField3DCylindrical::GetFieldCyl(const double CylPoint[4], double *BfieldCyl) const
+{
+  BfieldCyl[0] = 0.0;
+  BfieldCyl[1] = 0.0;
+  BfieldCyl[2] = 0.0;
 
-  std::vector<float>::const_iterator riter = upper_bound(r_map_.begin(), r_map_.end(), r);
-  int r_index0 = distance(r_map_.begin(), riter) - 1;
-  if (r_index0 >= (int) r_map_.size())
+  if (Verbosity() > 2)
   {
-    if (Verbosity() > 2)
-    {
-      std::cout << "!!!! Point not in defined region (radius too large in specific z-plane)" << std::endl;
-    }
-    return;
+    std::cout << "GetFieldCyl@ <z,r,phi>: {" << CylPoint[0] << "," << CylPoint[1] << "," << CylPoint[2] << "}" << std::endl;
   }
 
-  int r_index1 = r_index0 + 1;
-  if (r_index1 >= (int) r_map_.size())
+  double u[3];
+  if (!grid_point(CylPoint[0], CylPoint[1], CylPoint[2], u))
   {
-    if (Verbosity() > 2)
-    {
-      std::cout << "!!!! Point not in defined region (radius too large in specific z-plane)" << std::endl;
-    }
     return;
   }
 
-  assert(r_index0 >= 0);
-  assert(r_index1 >= 0);
-
-  std::vector<float>::const_iterator phiiter = upper_bound(phi_map_.begin(), phi_map_.end(), phi);
-  int phi_index0 = distance(phi_map_.begin(), phiiter) - 1;
-  int phi_index1 = phi_index0 + 1;
-  if (phi_index1 >= (int) phi_map_.size())
-  {
-    phi_index1 = 0;
-  }
-
-  assert(phi_index0 >= 0);
-  assert(phi_index0 < (int) phi_map_.size());
-  assert(phi_index1 >= 0);
-
-  double Br000 = BFieldR_[z_index0][r_index0][phi_index0];
-  double Br001 = BFieldR_[z_index0][r_index0][phi_index1];
-  double Br010 = BFieldR_[z_index0][r_index1][phi_index0];
-  double Br011 = BFieldR_[z_index0][r_index1][phi_index1];
-  double Br100 = BFieldR_[z_index1][r_index0][phi_index0];
-  double Br101 = BFieldR_[z_index1][r_index0][phi_index1];
-  double Br110 = BFieldR_[z_index1][r_index1][phi_index0];
-  double Br111 = BFieldR_[z_index1][r_index1][phi_index1];
-
-  double Bphi000 = BFieldPHI_[z_index0][r_index0][phi_index0];
-  double Bphi001 = BFieldPHI_[z_index0][r_index0][phi_index1];
-  double Bphi010 = BFieldPHI_[z_index0][r_index1][phi_index0];
-  double Bphi011 = BFieldPHI_[z_index0][r_index1][phi_index1];
-  double Bphi100 = BFieldPHI_[z_index1][r_index0][phi_index0];
-  double Bphi101 = BFieldPHI_[z_index1][r_index0][phi_index1];
-  double Bphi110 = BFieldPHI_[z_index1][r_index1][phi_index0];
-  double Bphi111 = BFieldPHI_[z_index1][r_index1][phi_index1];
-
-  double Bz000 = BFieldZ_[z_index0][r_index0][phi_index0];
-  double Bz001 = BFieldZ_[z_index0][r_index0][phi_index1];
-  double Bz100 = BFieldZ_[z_index1][r_index0][phi_index0];
-  double Bz101 = BFieldZ_[z_index1][r_index0][phi_index1];
-  double Bz010 = BFieldZ_[z_index0][r_index1][phi_index0];
-  double Bz110 = BFieldZ_[z_index1][r_index1][phi_index0];
-  double Bz011 = BFieldZ_[z_index0][r_index1][phi_index1];
-  double Bz111 = BFieldZ_[z_index1][r_index1][phi_index1];
-
-  double zweight = z - z_map_[z_index0];
-  double zspacing = z_map_[z_index1] - z_map_[z_index0];
-  zweight /= zspacing;
-
-  double rweight = r - r_map_[r_index0];
-  double rspacing = r_map_[r_index1] - r_map_[r_index0];
-  rweight /= rspacing;
-
-  double phiweight = phi - phi_map_[phi_index0];
-  double phispacing = phi_map_[phi_index1] - phi_map_[phi_index0];
-  if (phi_index1 == 0)
-  {
-    phispacing += 2 * M_PI;
-  }
-  phiweight /= phispacing;
-
-  // Z direction of B-field
-  BfieldCyl[0] =
-      (1 - zweight) * ((1 - rweight) * ((1 - phiweight) * Bz000 + phiweight * Bz001) +
-                       rweight * ((1 - phiweight) * Bz010 + phiweight * Bz011)) +
-      zweight * ((1 - rweight) * ((1 - phiweight) * Bz100 + phiweight * Bz101) +
-                 rweight * ((1 - phiweight) * Bz110 + phiweight * Bz111));
-
-  // R direction of B-field
-  BfieldCyl[1] =
-      (1 - zweight) * ((1 - rweight) * ((1 - phiweight) * Br000 + phiweight * Br001) +
-                       rweight * ((1 - phiweight) * Br010 + phiweight * Br011)) +
-      zweight * ((1 - rweight) * ((1 - phiweight) * Br100 + phiweight * Br101) +
-                 rweight * ((1 - phiweight) * Br110 + phiweight * Br111));
-
-  // PHI Direction of B-field
-  BfieldCyl[2] =
-      (1 - zweight) * ((1 - rweight) * ((1 - phiweight) * Bphi000 + phiweight * Bphi001) +
-                       rweight * ((1 - phiweight) * Bphi010 + phiweight * Bphi011)) +
-      zweight * ((1 - rweight) * ((1 - phiweight) * Bphi100 + phiweight * Bphi101) +
-                 rweight * ((1 - phiweight) * Bphi110 + phiweight * Bphi111));
-
-  //     std::cout << "wr: " << rweight << " wz: " << zweight << " wphi: " << phiweight << std::endl;
-  //     std::cout << "Bz000: " << Bz000 << std::endl
-  //          << "Bz001: " << Bz001 << std::endl
-  //          << "Bz010: " << Bz010 << std::endl
-  //          << "Bz011: " << Bz011 << std::endl
-  //          << "Bz100: " << Bz100 << std::endl
-  //          << "Bz101: " << Bz101 << std::endl
-  //          << "Bz110: " << Bz110 << std::endl
-  //          << "Bz111: " << Bz111 << std::endl
-  //          << "Bz:    " << BfieldCyl[0] << std::endl << std::endl;
+  // trilinear interpolation of <Bz, Br, Bphi>
+  m_Grid.Interpolate(u, BfieldCyl);
 
   if (Verbosity() > 2)
   {
@@ -455,31 +321,49 @@ void PHField3DCylindrical::GetFieldCyl(const double CylPoint[4], double *BfieldC
   return;
 }
 
-// a binary search algorithm that puts the location that "key" would be, into index...
-// it returns true if key was found, and false if not.
-bool PHField3DCylindrical::bin_search(const std::vector<float> &vec, unsigned start, unsigned end, const float &key, unsigned &index) const
+void PHField3DCylindrical::GetFieldValues(const std::size_t npoints, const double *points, double *Bfield, PHFieldCache *cache) const
 {
-  // Termination condition: start index greater than end index
-  if (start > end)
+  PHFieldGrid::Block block;
+  bool valid[PHFieldGrid::kBlockSize];
+  double cosphi[PHFieldGrid::kBlockSize];
+  double sinphi[PHFieldGrid::kBlockSize];
+  for (std::size_t start = 0; start < npoints; start += PHFieldGrid::kBlockSize)
   {
-    index = start;
-    return false;
-  }
+    block.size = std::min(PHFieldGrid::kBlockSize, npoints - start);
+    for (std::size_t k = 0; k < block.size; k++)
+    {
+      // same coordinates and boundaries as GetFieldValue
+      const double *point = points + 4 * (start + k);
+      const double r = std::sqrt(point[0] * point[0] + point[1] * point[1]);
+      double phi = std::atan2(point[1], (point[0] == 0) ? 0.00000000001 : point[0]);
+      if (phi < 0)
+      {
+        phi += 2 * M_PI;
+      }
+      cosphi[k] = std::cos(phi);
+      sinphi[k] = std::sin(phi);
+      double u[3];
+      valid[k] = point[2] >= minz_ && point[2] <= maxz_ && grid_point(point[2], r, phi, u);
+      // points outside of the map are interpolated at the grid corner and dropped
+      for (int i = 0; i < 3; i++)
+      {
+        block.u[i][k] = valid[k] ? u[i] : m_Grid.Axis(i).front();
+      }
+    }
 
-  // Find the middle element of the vector and use that for splitting
-  // the array into two pieces.
-  unsigned middle = start + ((end - start) / 2);
+    m_Grid.Interpolate(block, cache);
 
-  if (vec[middle] == key)
-  {
-    index = middle;
-    return true;
-  }
-  if (vec[middle] > key)
-  {
-    return bin_search(vec, start, middle - 1, key, index);
+    for (std::size_t k = 0; k < block.size; k++)
+    {
+      double *bf = Bfield + 3 * (start + k);
+      const double bz = valid[k] ? block.b[0][k] : 0.0;
+      const double br = valid[k] ? block.b[1][k] : 0.0;
+      const double bphi = valid[k] ? block.b[2][k] : 0.0;
+      bf[0] = cosphi[k] * br - sinphi[k] * bphi;
+      bf[1] = sinphi[k] * br + cosphi[k] * bphi;
+      bf[2] = bz;
+    }
   }
-  return bin_search(vec, middle + 1, end, key, index);
 }
 
 // debug function to print key/value pairs in map
@@ -21,11 +21,11 @@
 #define PHFIELD_PHFIELD3DCYLINDRICAL_H
 
 #include "PHField.h"
+#include "PHFieldGrid.h"
 
 #include <map>
 #include <string>
 #include <tuple>
-#include <vector>
 
 class PHField3DCylindrical : public PHField
 {
@@ -37,21 +37,19 @@ class PHField3DCylindrical : public PHField
   void GetFieldValue(const double Point[4], double* Bfield) const override;
   void GetFieldCyl(const double CylPoint[4], double* Bfield) const;
 
- protected:
-  // < i, j, k > , this allows i and i+1 to be neighbors ( <i,j,k>=<z,r,phi> )
-  std::vector<std::vector<std::vector<float> > > BFieldZ_;
-  std::vector<std::vector<std::vector<float> > > BFieldR_;
-  std::vector<std::vector<std::vector<float> > > BFieldPHI_;
+  //! field values at npoints points, see PHField
+  void GetFieldValues(const std::size_t npoints, const double* Points, double* Bfield, PHFieldCache* cache = nullptr) const override;
 
-  // maps indices to values z_map[i] = z_value that corresponds to ith index
-  std::vector<float> z_map_;    // < i >
-  std::vector<float> r_map_;    // < j >
-  std::vector<float> phi_map_;  // < k >
+ protected:
+  //! z, r, phi grid of bz, br, bphi. The first phi value is repeated at the end (+2pi) for the interpolation across 2pi
+  PHFieldGrid m_Grid;
 
   float maxz_, minz_;  // boundaries of magnetic field map cyl
 
  private:
-  bool bin_search(const std::vector<float>& vec, unsigned start, unsigned end, const float& key, unsigned& index) const;
+  //! grid coordinates of (z, r, phi), false if the point is outside of the map
+  bool grid_point(float z, float r, float phi, double u[3]) const;
+
   void print_map(std::map<trio, trio>::iterator& it) const;
 };
 
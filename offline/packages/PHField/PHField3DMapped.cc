@@ -0,0 +1,347 @@
+#include "PHField3DMapped.h"
+
+#include <phool/phool.h>
+
+#include <TSystem.h>
+
+#include <Geant4/G4SystemOfUnits.hh>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+PHField3DMapped::PHField3DMapped(const std::string &filename, const int verb, const float magfield_rescale,
+                                 const float innerradius, const float outerradius, const float size_z)
+  : PHField(verb)
+  , m_Filename(filename)
+  , m_Rescale(magfield_rescale)
+  , m_InnerRadius(innerradius)
+  , m_OuterRadius(outerradius)
+  , m_SizeZ(size_z)
+  , m_Restricted(innerradius > 0 || outerradius < 1.e10 || size_z < 1.e10)
+{
+  std::cout << "PHField3DMapped: mapping the field grid from " << m_Filename << std::endl;
+
+  const int fd = open(m_Filename.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    std::cout << PHWHERE << " could not open " << m_Filename << " exiting now" << std::endl;
+    gSystem->Exit(1);
+    exit(1);
+  }
+  struct stat status{};
+  if (fstat(fd, &status) != 0 || status.st_size < static_cast<off_t>(sizeof(Header)))
+  {
+    std::cout << PHWHERE << " " << m_Filename << " is too short for a binary field map, exiting now" << std::endl;
+    close(fd);
+    gSystem->Exit(1);
+    exit(1);
+  }
+  m_MappingSize = status.st_size;
+  // shared read only mapping, the pages are shared by all processes using this file
+  m_Mapping = mmap(nullptr, m_MappingSize, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (m_Mapping == MAP_FAILED)
+  {
+    m_Mapping = nullptr;
+    std::cout << PHWHERE << " could not map " << m_Filename << " exiting now" << std::endl;
+    gSystem->Exit(1);
+    exit(1);
+  }
+  const char *base = static_cast<const char *>(m_Mapping);
+
+  Header header;
+  std::memcpy(&header, base, sizeof(Header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0)
+  {
+    std::cout << PHWHERE << " " << m_Filename << " is not a binary field map, exiting now" << std::endl;
+    gSystem->Exit(1);
+    exit(1);
+  }
+  if (header.version != kVersion)
+  {
+    std::cout << PHWHERE << " " << m_Filename << " has version " << header.version
+              << ", this version reads version " << kVersion << " only, exiting now" << std::endl;
+    gSystem->Exit(1);
+    exit(1);
+  }
+
+  const uint64_t npoints = static_cast<uint64_t>(header.n[0]) * header.n[1] * header.n[2];
+  const uint64_t naxis = static_cast<uint64_t>(header.n[0]) + header.n[1] + header.n[2];
+  if ((header.grid != kCartesian && header.grid != kCylindrical) ||
+      header.ncomponents != 3 ||
+      header.n[0] < 2 || header.n[1] < 2 || header.n[2] < 2 ||
+      header.file_size != m_MappingSize ||
+      header.axis_offset < sizeof(Header) ||
+      header.axis_offset + naxis * sizeof(double) > header.field_offset ||
+      header.field_offset % alignof(float) != 0 ||
+      header.field_offset + npoints * 3 * sizeof(float) > m_MappingSize)
+  {
+    std::cout << PHWHERE << " " << m_Filename << " has an inconsistent header, exiting now" << std::endl;
+    gSystem->Exit(1);
+    exit(1);
+  }
+  m_Grid = static_cast<GridType>(header.grid);
+
+  const char *axis_values = base + header.axis_offset;
+  for (int i = 0; i < 3; i++)
+  {
+    Axis &axis = m_Axis[i];
+    axis.values.resize(header.n[i]);
+    std::memcpy(axis.values.data(), axis_values, header.n[i] * sizeof(double));
+    axis_values += header.n[i] * sizeof(double);
+    if (!std::is_sorted(axis.values.begin(), axis.values.end()) ||
+        std::adjacent_find(axis.values.begin(), axis.values.end()) != axis.values.end())
+    {
+      std::cout << PHWHERE << " " << m_Filename << " axis " << i << " is not strictly increasing, exiting now" << std::endl;
+      gSystem->Exit(1);
+      exit(1);
+    }
+    // equidistant axes are indexed directly, others by binary search
+    const double step = (axis.values.back() - axis.values.front()) / (axis.values.size() - 1);
+    bool equidistant = true;
+    for (std::size_t k = 0; k < axis.values.size(); k++)
+    {
+      if (std::abs(axis.values[k] - (axis.values.front() + k * step)) > 1e-3 * step)
+      {
+        equidistant = false;
+        break;
+      }
+    }
+    axis.step = equidistant ? step : 0;
+  }
+  m_Field = reinterpret_cast<const float *>(base + header.field_offset);
+
+  std::cout << "PHField3DMapped: " << (m_Grid == kCartesian ? "Cartesian" : "cylindrical")
+            << " grid of " << header.n[0] << " x " << header.n[1] << " x " << header.n[2]
+            << " points converted from " << std::string(header.source, strnlen(header.source, sizeof(header.source)))
+            << std::endl;
+}
+
+PHField3DMapped::~PHField3DMapped()
+{
+  if (m_Mapping)
+  {
+    munmap(m_Mapping, m_MappingSize);
+  }
+}
+
+std::size_t PHField3DMapped::cell(const Axis &axis, const double x)
+{
+  const std::vector<double> &values = axis.values;
+  const std::size_t last = values.size() - 2;
+  std::size_t i = 0;
+  if (axis.step > 0)
+  {
+    const double index = (x - values.front()) / axis.step;
+    i = (index > 0) ? std::min(static_cast<std::size_t>(index), last) : 0;
+    // the axis is only nearly equidistant, step to the right cell
+    while (i > 0 && x < values[i])
+    {
+      --i;
+    }
+    while (i < last && x >= values[i + 1])
+    {
+      ++i;
+    }
+  }
+  else
+  {
+    const auto iter = std::upper_bound(values.begin(), values.end(), x);
+    i = (iter == values.begin()) ? 0 : std::min(static_cast<std::size_t>(std::distance(values.begin(), iter) - 1), last);
+  }
+  return i;
+}
+
+void PHField3DMapped::GetFieldValue(const double point[4], double *Bfield) const
+{
+  Bfield[0] = 0.0;
+  Bfield[1] = 0.0;
+  Bfield[2] = 0.0;
+  if (!std::isfinite(point[0]) || !std::isfinite(point[1]) || !std::isfinite(point[2]))
+  {
+    static std::atomic<int> ifirst = 0;
+    if (ifirst++ < 10)
+    {
+      std::cout << "PHField3DMapped::GetFieldValue: "
+                << "Invalid coordinates: "
+                << "x: " << point[0] / cm
+                << ", y: " << point[1] / cm
+                << ", z: " << point[2] / cm
+                << " bailing out returning zero bfield"
+                << std::endl;
+    }
+    return;
+  }
+  if (m_Grid == kCartesian)
+  {
+    GetFieldCartesian(point, Bfield);
+  }
+  else
+  {
+    GetFieldCylindrical(point, Bfield);
+  }
+}
+
+bool PHField3DMapped::in_region(const std::size_t i, const std::size_t j, const std::size_t k) const
+{
+  const double x = m_Axis[0].values[i];
+  const double y = m_Axis[1].values[j];
+  const double z = m_Axis[2].values[k];
+  const double r = std::sqrt(x * x + y * y);
+  return (r >= m_InnerRadius && r <= m_OuterRadius) || std::abs(z) > m_SizeZ;
+}
+
+void PHField3DMapped::GetFieldCartesian(const double point[4], double *Bfield) const
+{
+  for (int n = 0; n < 3; n++)
+  {
+    if (point[n] < m_Axis[n].values.front() || point[n] > m_Axis[n].values.back())
+    {
+      return;
+    }
+  }
+
+  std::size_t index[3];
+  double fraction[3];
+  for (int n = 0; n < 3; n++)
+  {
+    const std::vector<double> &values = m_Axis[n].values;
+    index[n] = cell(m_Axis[n], point[n]);
+    fraction[n] = (point[n] - values[index[n]]) / (values[index[n] + 1] - values[index[n]]);
+  }
+
+  // grid points outside of the selected region are not part of the map
+  if (m_Restricted)
+  {
+    for (int i = 0; i < 2; i++)
+    {
+      for (int j = 0; j < 2; j++)
+      {
+        for (int k = 0; k < 2; k++)
+        {
+          if (!in_region(index[0] + i, index[1] + j, index[2] + k))
+          {
+            if (Verbosity() > 0)
+            {
+              std::cout << PHWHERE << " grid point outside of the selected region in " << m_Filename
+                        << " x: " << m_Axis[0].values[index[0] + i] / cm
+                        << ", y: " << m_Axis[1].values[index[1] + j] / cm
+                        << ", z: " << m_Axis[2].values[index[2] + k] / cm << std::endl;
+            }
+            return;
+          }
+        }
+      }
+    }
+  }
+
+  // trilinear interpolation in the cell
+  for (int i = 0; i < 2; i++)
+  {
+    const double wx = i ? fraction[0] : 1. - fraction[0];
+    for (int j = 0; j < 2; j++)
+    {
+      const double wy = j ? fraction[1] : 1. - fraction[1];
+      for (int k = 0; k < 2; k++)
+      {
+        const double w = wx * wy * (k ? fraction[2] : 1. - fraction[2]);
+        const float *b = field(index[0] + i, index[1] + j, index[2] + k);
+        Bfield[0] += w * b[0];
+        Bfield[1] += w * b[1];
+        Bfield[2] += w * b[2];
+      }
+    }
+  }
+  for (int n = 0; n < 3; n++)
+  {
+    Bfield[n] *= m_Rescale;
+  }
+}
+
+void PHField3DMapped::GetFieldCylindrical(const double point[4], double *Bfield) const
+{
+  // same boundaries and interpolation as PHField3DCylindrical
+  const std::vector<double> &zaxis = m_Axis[0].values;
+  const std::vector<double> &raxis = m_Axis[1].values;
+  const std::vector<double> &phiaxis = m_Axis[2].values;
+
+  float z = point[2];
+  if (z <= zaxis.front() || z >= zaxis.back())
+  {
+    return;
+  }
+  float r = std::sqrt(point[0] * point[0] + point[1] * point[1]);
+  if (r < raxis.front())
+  {
+    r = raxis.front();
+  }
+  if (r >= raxis.back())
+  {
+    return;
+  }
+  double phi = std::atan2(point[1], (point[0] == 0) ? 0.00000000001 : point[0]);
+  if (phi < 0)
+  {
+    phi += 2 * M_PI;  // normalize phi to be over the range [0,2*pi]
+  }
+  const float fphi = phi;
+
+  const std::size_t iz = cell(m_Axis[0], z);
+  const std::size_t ir = cell(m_Axis[1], r);
+  // phi is periodic, the last grid point is followed by the first one
+  std::size_t iphi0 = phiaxis.size() - 1;
+  std::size_t iphi1 = 0;
+  double phiweight = 0;
+  if (fphi >= phiaxis.front() && fphi < phiaxis.back())
+  {
+    iphi0 = cell(m_Axis[2], fphi);
+    iphi1 = iphi0 + 1;
+    phiweight = (fphi - phiaxis[iphi0]) / (phiaxis[iphi1] - phiaxis[iphi0]);
+  }
+  else
+  {
+    // no wrap cell when the map already has the first phi plane at +2pi (e.g. both 0 and 360 degrees),
+    // phi is then on that plane, up to rounding. Same tolerance as PHField3DCylindrical
+    static constexpr double phi_tolerance = 1e-4;
+    const double spacing = phiaxis.front() + 2 * M_PI - phiaxis.back();
+    if (spacing > phi_tolerance)
+    {
+      phiweight = ((fphi >= phiaxis.back()) ? fphi - phiaxis.back() : fphi + 2 * M_PI - phiaxis.back()) / spacing;
+    }
+  }
+  const double zweight = (z - zaxis[iz]) / (zaxis[iz + 1] - zaxis[iz]);
+  const double rweight = (r - raxis[ir]) / (raxis[ir + 1] - raxis[ir]);
+
+  // bz, br, bphi
+  double BfieldCyl[3];
+  for (int n = 0; n < 3; n++)
+  {
+    BfieldCyl[n] =
+        (1 - zweight) * ((1 - rweight) * ((1 - phiweight) * field(iz, ir, iphi0)[n] + phiweight * field(iz, ir, iphi1)[n]) +
+                         rweight * ((1 - phiweight) * field(iz, ir + 1, iphi0)[n] + phiweight * field(iz, ir + 1, iphi1)[n])) +
+        zweight * ((1 - rweight) * ((1 - phiweight) * field(iz + 1, ir, iphi0)[n] + phiweight * field(iz + 1, ir, iphi1)[n]) +
+                   rweight * ((1 - phiweight) * field(iz + 1, ir + 1, iphi0)[n] + phiweight * field(iz + 1, ir + 1, iphi1)[n]));
+    BfieldCyl[n] *= m_Rescale;
+  }
+
+  // Bx = Br*cos(phi) - Bphi*sin(phi), By = Br*sin(phi) + Bphi*cos(phi)
+  Bfield[0] = std::cos(phi) * BfieldCyl[1] - std::sin(phi) * BfieldCyl[2];
+  Bfield[1] = std::sin(phi) * BfieldCyl[1] + std::cos(phi) * BfieldCyl[2];
+  Bfield[2] = BfieldCyl[0];
+
+  if (Verbosity() > 2)
+  {
+    std::cout << "PHField3DMapped::GetFieldValue <bz,br,bphi> : {"
+              << BfieldCyl[0] / gauss << "," << BfieldCyl[1] / gauss << "," << BfieldCyl[2] / gauss << "}"
+              << std::endl;
+  }
+}
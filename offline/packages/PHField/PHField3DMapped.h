@@ -0,0 +1,119 @@
+#ifndef PHFIELD_PHFIELD3DMAPPED_H
+#define PHFIELD_PHFIELD3DMAPPED_H
+
+#include "PHField.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*!
+ * \brief 3D field map read from a memory mapped binary file
+ *
+ * The binary map (see Header) holds the grid axes and the field on the grid
+ * as one flat array of floats, in the units used by Geant4 (CLHEP). The file
+ * is mapped read only, all processes on a node using the same map share the
+ * page cached copy and nothing is parsed at startup.
+ * Binary maps are made from the ROOT maps of PHField3DCartesian and
+ * PHField3DCylindrical with PHFieldMapConverter (or the phfield_convert_map
+ * program), lookups reproduce the interpolation of the respective class.
+ */
+class PHField3DMapped : public PHField
+{
+ public:
+  //! grid of the binary map
+  enum GridType : uint32_t
+  {
+    //! axes x, y, z, field bx, by, bz
+    kCartesian = 0,
+    //! axes z, r, phi, field bz, br, bphi
+    kCylindrical = 1
+  };
+
+  //! file header, followed by the axes (double) and the field (float [n0][n1][n2][3])
+  struct Header
+  {
+    char magic[8]{};
+    uint32_t version{0};
+    uint32_t grid{kCartesian};
+    uint32_t n[3]{};
+    uint32_t ncomponents{3};
+    //! position of the axis values, in bytes from the start of the file
+    uint64_t axis_offset{0};
+    //! position of the field values, in bytes from the start of the file
+    uint64_t field_offset{0};
+    uint64_t file_size{0};
+    //! map the binary file was converted from
+    char source[256]{};
+  };
+
+  //! file identification, the version is checked on reading
+  static constexpr char kMagic[8] = {'P', 'H', 'F', 'M', 'A', 'P', '\0', '\0'};
+  static constexpr uint32_t kVersion = 1;
+
+  //! innerradius, outerradius and size_z restrict the Cartesian map as in PHField3DCartesian
+  explicit PHField3DMapped(const std::string &filename, const int verb = 0, const float magfield_rescale = 1.0,
+                           const float innerradius = 0, const float outerradius = 1.e10, const float size_z = 1.e10);
+
+  ~PHField3DMapped() override;
+
+  // the mapping is owned
+  PHField3DMapped(const PHField3DMapped &) = delete;
+  PHField3DMapped &operator=(const PHField3DMapped &) = delete;
+
+  //! access field value
+  //! Follow the convention of G4ElectroMagneticField
+  //! @param[in]  Point   space time coordinate. x, y, z, t in Geant4/CLHEP units
+  //! @param[out] Bfield  field value. In the case of magnetic field, the order is Bx, By, Bz in in Geant4/CLHEP units
+  void GetFieldValue(const double Point[4], double *Bfield) const override;
+
+  //! no internal cache, safe to call from several threads
+  void GetFieldValue_nocache(const double Point[4], double *Bfield) const override
+  {
+    GetFieldValue(Point, Bfield);
+  }
+
+  GridType grid() const { return m_Grid; }
+  const std::vector<double> &axis(const int i) const { return m_Axis[i].values; }
+
+ private:
+  struct Axis
+  {
+    std::vector<double> values;
+    //! grid spacing if equidistant, 0 otherwise
+    double step{0};
+  };
+
+  //! index i of the cell [values[i], values[i+1]] holding x, with x inside the axis range
+  static std::size_t cell(const Axis &axis, const double x);
+
+  //! field components at grid point (i, j, k)
+  const float *field(const std::size_t i, const std::size_t j, const std::size_t k) const
+  {
+    return m_Field + ((i * m_Axis[1].values.size() + j) * m_Axis[2].values.size() + k) * 3;
+  }
+
+  void GetFieldCartesian(const double Point[4], double *Bfield) const;
+  void GetFieldCylindrical(const double Point[4], double *Bfield) const;
+
+  //! true if the Cartesian grid point is kept by the innerradius/outerradius/size_z selection
+  bool in_region(const std::size_t i, const std::size_t j, const std::size_t k) const;
+
+  std::string m_Filename;
+  GridType m_Grid{kCartesian};
+  double m_Rescale{1.};
+  double m_InnerRadius{0};
+  double m_OuterRadius{1.e10};
+  double m_SizeZ{1.e10};
+  bool m_Restricted{false};
+
+  std::array<Axis, 3> m_Axis;
+
+  void *m_Mapping{nullptr};
+  std::size_t m_MappingSize{0};
+  const float *m_Field{nullptr};
+};
+
+#endif
@@ -0,0 +1,138 @@
+/**
+ * @file PHField/PHFieldBenchmark.cc
+ * @brief throughput of the field map lookups, one point at a time and in batches
+ *
+ * usage: PHFieldBenchmark [cartesian|cylindrical|2d|mapped] [field map] [points]
+ * The points follow straight tracks from the origin in 1 cm steps, as in a track
+ * propagation. Default is the Cartesian tracking map in $CALIBRATIONROOT.
+ * Batch results are compared with the ones of GetFieldValue
+ */
+#include "PHField.h"
+#include "PHField2D.h"
+#include "PHField3DCartesian.h"
+#include "PHField3DCylindrical.h"
+#include "PHField3DMapped.h"
+#include "PHFieldCache.h"
+#include "PHFieldGrid.h"
+
+#include <Geant4/G4SystemOfUnits.hh>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+  using clock_type = std::chrono::high_resolution_clock;
+
+  //! x, y, z, t of npoints points on tracks of 100 steps of 1 cm
+  std::vector<double> generate(std::size_t npoints)
+  {
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> uniform(-1, 1);
+    std::vector<double> points(4 * npoints, 0);
+    double direction[3] = {0, 0, 0};
+    for (std::size_t i = 0; i < npoints; ++i)
+    {
+      if (i % 100 == 0)
+      {
+        const double cost = uniform(generator);
+        const double sint = std::sqrt(1 - cost * cost);
+        const double phi = M_PI * uniform(generator);
+        direction[0] = sint * std::cos(phi);
+        direction[1] = sint * std::sin(phi);
+        direction[2] = cost;
+      }
+      for (int n = 0; n < 3; ++n)
+      {
+        points[4 * i + n] = (i % 100) * cm * direction[n];
+      }
+    }
+    return points;
+  }
+
+  double seconds(const clock_type::time_point &start)
+  {
+    return std::chrono::duration<double>(clock_type::now() - start).count();
+  }
+}  // namespace
+
+int main(int argc, char **argv)
+{
+  const std::string type = (argc > 1) ? argv[1] : "cartesian";
+  std::string filename = (argc > 2) ? argv[2] : "";
+  const std::size_t npoints = (argc > 3) ? std::atol(argv[3]) : 2000000;
+  if (filename.empty())
+  {
+    const char *calibrationroot = std::getenv("CALIBRATIONROOT");
+    filename = std::string(calibrationroot ? calibrationroot : ".") + "/Field/Map/sphenix3dtrackingmapxyz.root";
+  }
+
+  std::unique_ptr<PHField> field;
+  if (type == "cartesian")
+  {
+    field = std::make_unique<PHField3DCartesian>(filename);
+  }
+  else if (type == "cylindrical")
+  {
+    field = std::make_unique<PHField3DCylindrical>(filename);
+  }
+  else if (type == "2d")
+  {
+    field = std::make_unique<PHField2D>(filename);
+  }
+  else if (type == "mapped")
+  {
+    field = std::make_unique<PHField3DMapped>(filename);
+  }
+  else
+  {
+    std::cout << "usage: PHFieldBenchmark [cartesian|cylindrical|2d|mapped] [field map] [points]" << std::endl;
+    return 1;
+  }
+
+  const auto points = generate(npoints);
+  std::vector<double> single(3 * npoints);
+  std::vector<double> batch(3 * npoints);
+
+  std::cout << "PHFieldBenchmark - " << type << " field map " << filename << ", " << npoints << " points" << std::endl;
+
+  auto start = clock_type::now();
+  for (std::size_t i = 0; i < npoints; ++i)
+  {
+    field->GetFieldValue(&points[4 * i], &single[3 * i]);
+  }
+  std::cout << "GetFieldValue: " << npoints / seconds(start) << " points/s" << std::endl;
+
+  const bool vectorized = PHFieldGrid::Vectorized();
+  for (const bool vectorize : {false, true})
+  {
+    if (vectorize && !PHFieldGrid::Vectorize(true))
+    {
+      continue;
+    }
+    PHFieldGrid::Vectorize(vectorize);
+    PHFieldCache cache;
+    std::fill(batch.begin(), batch.end(), 0);
+    start = clock_type::now();
+    field->GetFieldValues(npoints, points.data(), batch.data(), &cache);
+    const double elapsed = seconds(start);
+
+    double maxdiff = 0;
+    for (std::size_t i = 0; i < batch.size(); ++i)
+    {
+      maxdiff = std::max(maxdiff, std::abs(batch[i] - single[i]));
+    }
+    std::cout << "GetFieldValues (" << (vectorize ? "AVX2" : "scalar") << "): "
+              << npoints / elapsed << " points/s, cache hits " << cache.hits() << ", misses " << cache.misses()
+              << ", max difference to GetFieldValue " << maxdiff / tesla << " T" << std::endl;
+  }
+  PHFieldGrid::Vectorize(vectorized);
+  return 0;
+}
@@ -0,0 +1,52 @@
+#ifndef PHFIELD_PHFIELDCACHE_H
+#define PHFIELD_PHFIELDCACHE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+class PHFieldGrid;
+
+/*!
+ * \brief field lookup cache owned by the caller
+ *
+ * Remembers the grid cell of the previous lookup. Points in the same cell
+ * (most of the steps of a track) skip the binary search of the cell on axes
+ * which are not equidistant, equidistant axes find the cell arithmetically.
+ * Pass one cache per thread (or per propagator) to PHField::GetFieldValues,
+ * a cache must not be shared between threads. It can be used with several
+ * field maps, it is reset when the field map changes.
+ */
+class PHFieldCache
+{
+ public:
+  PHFieldCache() = default;
+
+  //! lookups in the cell of the previous lookup
+  uint64_t hits() const { return m_Hits; }
+
+  //! lookups which needed a cell search
+  uint64_t misses() const { return m_Misses; }
+
+  void Reset()
+  {
+    m_Grid = nullptr;
+    m_Hits = 0;
+    m_Misses = 0;
+  }
+
+ private:
+  friend class PHFieldGrid;
+
+  //! grid of the cached cell
+  const PHFieldGrid *m_Grid{nullptr};
+  //! cell of the previous lookup along each axis
+  std::array<std::size_t, 3> m_Cell{};
+  //! offset of the previous cell in the field array
+  int64_t m_Offset{-1};
+
+  uint64_t m_Hits{0};
+  uint64_t m_Misses{0};
+};
+
+#endif
@@ -38,6 +38,9 @@ std::string PHFieldConfig::get_field_config_description() const
   case FieldInterpolated:
 	return "3D field map interpolated to O(3)";
 	break;
+  case kField3DMapped:
+    return "3D field map in memory mapped binary format";
+    break;
   default:
     return "Invalid Field";
   }
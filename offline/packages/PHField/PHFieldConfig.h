@@ -43,6 +43,8 @@ class PHFieldConfig : public PHObject
     Field3DCartesian = 1,
     //! Interpolation of the 3D field map (Cartesian coordinates)
     FieldInterpolated = 6,
+    //! 3D field map in the memory mapped binary format of PHField3DMapped
+    kField3DMapped = 7,
 
     //! invalid value
     kFieldInvalid = 9999
@@ -0,0 +1,294 @@
+#include "PHFieldGrid.h"
+
+#include "PHFieldCache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PHFIELDGRID_X86
+#endif
+
+/*
+ * The AVX2 interpolation does the same floating point operations in the same
+ * order as the scalar one, lane by lane, so the results are bit identical.
+ * This requires that multiply-add are not contracted to FMA
+ */
+#if defined(__clang__)
+#pragma clang fp contract(off)
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+namespace
+{
+  //! weights of the 8 corners, corner bits are (axis0, axis1, axis2)
+  inline double weight(const int corner, const double f0, const double f1, const double f2)
+  {
+    const double w0 = (corner & 4) ? f0 : 1. - f0;
+    const double w1 = (corner & 2) ? f1 : 1. - f1;
+    const double w2 = (corner & 1) ? f2 : 1. - f2;
+    return w0 * w1 * w2;
+  }
+
+  inline void interpolate_scalar(const float *field, const int32_t *corner, const int32_t offset,
+                                 const double f0, const double f1, const double f2,
+                                 double &b0, double &b1, double &b2)
+  {
+    b0 = 0;
+    b1 = 0;
+    b2 = 0;
+    for (int c = 0; c < 8; c++)
+    {
+      const double w = weight(c, f0, f1, f2);
+      const float *value = field + offset + corner[c];
+      b0 += w * value[0];
+      b1 += w * value[1];
+      b2 += w * value[2];
+    }
+  }
+
+#ifdef PHFIELDGRID_X86
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+  //! 4 points of a block, lane by lane the same operations as interpolate_scalar
+  __attribute__((target("avx2"))) void interpolate_avx2(const float *field, const int32_t *corner, const int32_t *offset,
+                                                        const double *f0, const double *f1, const double *f2,
+                                                        double *b0, double *b1, double *b2)
+  {
+    const __m256d one = _mm256_set1_pd(1.);
+    const __m256d x0 = _mm256_loadu_pd(f0);
+    const __m256d x1 = _mm256_loadu_pd(f1);
+    const __m256d x2 = _mm256_loadu_pd(f2);
+    const __m256d y0 = _mm256_sub_pd(one, x0);
+    const __m256d y1 = _mm256_sub_pd(one, x1);
+    const __m256d y2 = _mm256_sub_pd(one, x2);
+    const __m128i base = _mm_loadu_si128(reinterpret_cast<const __m128i *>(offset));
+
+    __m256d sum0 = _mm256_setzero_pd();
+    __m256d sum1 = _mm256_setzero_pd();
+    __m256d sum2 = _mm256_setzero_pd();
+    for (int c = 0; c < 8; c++)
+    {
+      const __m256d w = _mm256_mul_pd(_mm256_mul_pd((c & 4) ? x0 : y0, (c & 2) ? x1 : y1), (c & 1) ? x2 : y2);
+      const __m128i index = _mm_add_epi32(base, _mm_set1_epi32(corner[c]));
+      const __m256d v0 = _mm256_cvtps_pd(_mm_i32gather_ps(field, index, 4));
+      const __m256d v1 = _mm256_cvtps_pd(_mm_i32gather_ps(field + 1, index, 4));
+      const __m256d v2 = _mm256_cvtps_pd(_mm_i32gather_ps(field + 2, index, 4));
+      sum0 = _mm256_add_pd(sum0, _mm256_mul_pd(w, v0));
+      sum1 = _mm256_add_pd(sum1, _mm256_mul_pd(w, v1));
+      sum2 = _mm256_add_pd(sum2, _mm256_mul_pd(w, v2));
+    }
+    _mm256_storeu_pd(b0, sum0);
+    _mm256_storeu_pd(b1, sum1);
+    _mm256_storeu_pd(b2, sum2);
+  }
+
+#pragma GCC diagnostic pop
+#endif
+
+  bool avx2_supported()
+  {
+#ifdef PHFIELDGRID_X86
+    __builtin_cpu_init();
+    static const bool value = __builtin_cpu_supports("avx2");
+    return value;
+#else
+    return false;
+#endif
+  }
+
+  std::atomic<bool> &use_avx2()
+  {
+    static std::atomic<bool> value{avx2_supported()};
+    return value;
+  }
+}  // namespace
+
+bool PHFieldGrid::Vectorize(const bool value)
+{
+  use_avx2().store(value && avx2_supported(), std::memory_order_relaxed);
+  return Vectorized();
+}
+
+bool PHFieldGrid::Vectorized()
+{
+  return use_avx2().load(std::memory_order_relaxed);
+}
+
+void PHFieldGrid::SetAxes(const std::vector<double> &axis0, const std::vector<double> &axis1, const std::vector<double> &axis2, const float fill)
+{
+  m_Axis[0].values = axis0;
+  m_Axis[1].values = axis1;
+  m_Axis[2].values = axis2;
+  m_Axis[2].stride = 3;
+  m_Axis[1].stride = m_Axis[2].stride * axis2.size();
+  m_Axis[0].stride = m_Axis[1].stride * axis1.size();
+  const std::size_t size = m_Axis[0].stride * axis0.size();
+  // the AVX2 gathers use 32 bit offsets
+  if (size > static_cast<std::size_t>(std::numeric_limits<int32_t>::max()))
+  {
+    std::cout << "PHFieldGrid: " << axis0.size() << " x " << axis1.size() << " x " << axis2.size()
+              << " grid points are too many, exiting now" << std::endl;
+    exit(1);
+  }
+  m_Field.assign(size, fill);
+
+  for (auto &axis : m_Axis)
+  {
+    axis.step = 0;
+    axis.inverse_step = 0;
+    if (axis.values.size() < 2)
+    {
+      continue;
+    }
+    const double step = (axis.values.back() - axis.values.front()) / (axis.values.size() - 1);
+    bool equidistant = true;
+    for (std::size_t k = 0; k < axis.values.size(); k++)
+    {
+      if (std::abs(axis.values[k] - (axis.values.front() + k * step)) > 1e-3 * step)
+      {
+        equidistant = false;
+        break;
+      }
+    }
+    axis.step = equidistant ? step : 0;
+    axis.inverse_step = equidistant ? 1. / step : 0;
+  }
+
+  // an axis with a single value has no upper neighbour
+  for (int c = 0; c < 8; c++)
+  {
+    m_Corner[c] = 0;
+    for (int i = 0; i < 3; i++)
+    {
+      if ((c & (4 >> i)) && m_Axis[i].values.size() > 1)
+      {
+        m_Corner[c] += m_Axis[i].stride;
+      }
+    }
+  }
+}
+
+std::size_t PHFieldGrid::Index(const int i, const double x) const
+{
+  const std::vector<double> &values = m_Axis[i].values;
+  return std::distance(values.begin(), std::lower_bound(values.begin(), values.end(), x));
+}
+
+void PHFieldGrid::locate(const int i, const std::size_t n, const double *x, int32_t *offset, double *fraction, PHFieldCache *cache) const
+{
+  const GridAxis &axis = m_Axis[i];
+  const std::vector<double> &values = axis.values;
+  if (values.size() < 2)
+  {
+    std::fill(fraction, fraction + n, 0.);
+    return;
+  }
+  const double *v = values.data();
+  const std::size_t last = values.size() - 2;
+  const int32_t stride = axis.stride;
+  if (axis.step > 0)
+  {
+    for (std::size_t k = 0; k < n; k++)
+    {
+      const double guess = (x[k] - v[0]) * axis.inverse_step;
+      std::size_t index = (guess > 0) ? std::min(static_cast<std::size_t>(guess), last) : 0;
+      // the axis is only nearly equidistant, the cell is at most one off
+      index -= (index > 0 && x[k] < v[index]);
+      index += (index < last && x[k] >= v[index + 1]);
+      fraction[k] = (x[k] - v[index]) / (v[index + 1] - v[index]);
+      offset[k] += index * stride;
+    }
+    return;
+  }
+
+  // binary search, unless the point is in the same cell as the previous one
+  std::size_t index = cache ? cache->m_Cell[i] : 0;
+  for (std::size_t k = 0; k < n; k++)
+  {
+    if (!(x[k] >= v[index] && (x[k] < v[index + 1] || (index == last && x[k] <= v[index + 1]))))
+    {
+      const auto iter = std::upper_bound(values.begin(), values.end(), x[k]);
+      index = (iter == values.begin()) ? 0 : std::min(static_cast<std::size_t>(std::distance(values.begin(), iter) - 1), last);
+    }
+    fraction[k] = (x[k] - v[index]) / (v[index + 1] - v[index]);
+    offset[k] += index * stride;
+  }
+  if (cache)
+  {
+    cache->m_Cell[i] = index;
+  }
+}
+
+void PHFieldGrid::locate(const std::size_t n, const double *const u[3], int32_t *offset, double *const fraction[3], PHFieldCache *cache) const
+{
+  if (cache && cache->m_Grid != this)
+  {
+    cache->m_Grid = this;
+    cache->m_Cell = {0, 0, 0};
+    cache->m_Offset = -1;
+  }
+  std::fill(offset, offset + n, 0);
+  for (int i = 0; i < 3; i++)
+  {
+    locate(i, n, u[i], offset, fraction[i], cache);
+  }
+  if (cache)
+  {
+    uint64_t hits = 0;
+    int64_t previous = cache->m_Offset;
+    for (std::size_t k = 0; k < n; k++)
+    {
+      hits += (offset[k] == previous);
+      previous = offset[k];
+    }
+    cache->m_Offset = previous;
+    cache->m_Hits += hits;
+    cache->m_Misses += n - hits;
+  }
+}
+
+void PHFieldGrid::Interpolate(const double u[3], double b[3], PHFieldCache *cache) const
+{
+  const double *const coordinates[3] = {&u[0], &u[1], &u[2]};
+  double fraction[3];
+  double *const fractions[3] = {&fraction[0], &fraction[1], &fraction[2]};
+  int32_t offset;
+  locate(1, coordinates, &offset, fractions, cache);
+  interpolate_scalar(m_Field.data(), m_Corner.data(), offset, fraction[0], fraction[1], fraction[2], b[0], b[1], b[2]);
+}
+
+void PHFieldGrid::Interpolate(Block &block, PHFieldCache *cache) const
+{
+  int32_t offset[kBlockSize];
+  double fraction[3][kBlockSize];
+  const double *const coordinates[3] = {block.u[0], block.u[1], block.u[2]};
+  double *const fractions[3] = {fraction[0], fraction[1], fraction[2]};
+  locate(block.size, coordinates, offset, fractions, cache);
+
+  std::size_t k = 0;
+#ifdef PHFIELDGRID_X86
+  if (Vectorized())
+  {
+    for (; k + 4 <= block.size; k += 4)
+    {
+      interpolate_avx2(m_Field.data(), m_Corner.data(), offset + k,
+                       fraction[0] + k, fraction[1] + k, fraction[2] + k,
+                       block.b[0] + k, block.b[1] + k, block.b[2] + k);
+    }
+  }
+#endif
+  for (; k < block.size; k++)
+  {
+    interpolate_scalar(m_Field.data(), m_Corner.data(), offset[k], fraction[0][k], fraction[1][k], fraction[2][k],
+                       block.b[0][k], block.b[1][k], block.b[2][k]);
+  }
+}
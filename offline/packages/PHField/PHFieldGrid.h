@@ -0,0 +1,93 @@
+#ifndef PHFIELD_PHFIELDGRID_H
+#define PHFIELD_PHFIELDGRID_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class PHFieldCache;
+
+/*!
+ * \brief field values on a 3D grid stored as one flat array
+ *
+ * The three field components of each grid point are stored next to each
+ * other, last axis fastest. Lookups are trilinear interpolations in the
+ * cell holding the point. Equidistant axes find the cell arithmetically,
+ * others by binary search. An axis with a single value (2D maps) is not
+ * interpolated.
+ *
+ * Blocks of points are interpolated together, 4 points per instruction with
+ * AVX2 when the cpu supports it. The vector and scalar code give bit
+ * identical results.
+ */
+class PHFieldGrid
+{
+ public:
+  //! number of points interpolated together
+  static constexpr std::size_t kBlockSize = 64;
+
+  //! batch of points, in grid coordinates
+  struct Block
+  {
+    std::size_t size{0};
+    //! grid coordinates, must be inside the axis ranges
+    double u[3][kBlockSize]{};
+    //! interpolated field components
+    double b[3][kBlockSize]{};
+  };
+
+  //! set the axis values (strictly increasing). All field values are set to fill
+  void SetAxes(const std::vector<double> &axis0, const std::vector<double> &axis1, const std::vector<double> &axis2, const float fill = 0);
+
+  const std::vector<double> &Axis(const int i) const { return m_Axis[i].values; }
+
+  //! field components at grid point (i, j, k)
+  float *Field(const std::size_t i, const std::size_t j, const std::size_t k)
+  {
+    return m_Field.data() + i * m_Axis[0].stride + j * m_Axis[1].stride + k * m_Axis[2].stride;
+  }
+  const float *Field(const std::size_t i, const std::size_t j, const std::size_t k) const
+  {
+    return m_Field.data() + i * m_Axis[0].stride + j * m_Axis[1].stride + k * m_Axis[2].stride;
+  }
+
+  //! index of the grid value of axis i closest to x
+  std::size_t Index(const int i, const double x) const;
+
+  //! field at grid coordinates u, which must be inside the axis ranges
+  void Interpolate(const double u[3], double b[3], PHFieldCache *cache = nullptr) const;
+
+  //! field at all points of the block
+  void Interpolate(Block &block, PHFieldCache *cache = nullptr) const;
+
+  //! use AVX2 for blocks if the cpu supports it (default). Returns if it is used
+  static bool Vectorize(const bool value);
+  static bool Vectorized();
+
+ private:
+  struct GridAxis
+  {
+    std::vector<double> values;
+    //! grid spacing if equidistant, 0 otherwise
+    double step{0};
+    double inverse_step{0};
+    //! distance of neighbouring grid points in the field array
+    std::size_t stride{0};
+  };
+
+  //! add the offset of the cells holding the n coordinates x along axis i, and set their fractions in the cells
+  void locate(const int i, const std::size_t n, const double *x, int32_t *offset, double *fraction, PHFieldCache *cache) const;
+
+  //! cell offsets and fractions of n points
+  void locate(const std::size_t n, const double *const u[3], int32_t *offset, double *const fraction[3], PHFieldCache *cache) const;
+
+  std::array<GridAxis, 3> m_Axis;
+
+  //! offsets of the 8 corners of a cell relative to the lower corner
+  std::array<int32_t, 8> m_Corner{};
+
+  std::vector<float> m_Field;
+};
+
+#endif
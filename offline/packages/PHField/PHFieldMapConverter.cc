@@ -0,0 +1,210 @@
+#include "PHFieldMapConverter.h"
+
+#include <phool/phool.h>
+
+#include <TFile.h>
+#include <TNtuple.h>
+
+#include <Geant4/G4SystemOfUnits.hh>
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <set>
+
+namespace
+{
+  //! offsets in the binary map are aligned to cache lines
+  uint64_t align(const uint64_t offset)
+  {
+    return (offset + 63) / 64 * 64;
+  }
+
+  //! read the six float columns of a ROOT map ntuple
+  bool read_ntuple(const std::string &rootfile, const std::string &name, const std::array<const char *, 6> &columns,
+                   std::vector<std::array<float, 6>> &rows)
+  {
+    std::unique_ptr<TFile> rootinput(TFile::Open(rootfile.c_str()));
+    if (!rootinput)
+    {
+      std::cout << PHWHERE << " could not open " << rootfile << std::endl;
+      return false;
+    }
+    TNtuple *field_map = nullptr;
+    rootinput->GetObject(name.c_str(), field_map);
+    if (field_map == nullptr)
+    {
+      std::cout << PHWHERE << " Could not load " << name << " ntuple from " << rootfile << std::endl;
+      return false;
+    }
+    std::array<Float_t, 6> row{};
+    for (int i = 0; i < 6; i++)
+    {
+      field_map->SetBranchAddress(columns[i], &row[i]);
+    }
+    rows.reserve(field_map->GetEntries());
+    for (Long64_t i = 0; i < field_map->GetEntries(); i++)
+    {
+      field_map->GetEntry(i);
+      rows.push_back(row);
+    }
+    delete field_map;
+    return true;
+  }
+}  // namespace
+
+int PHFieldMapConverter::ConvertCartesian(const std::string &rootfile, const std::string &binaryfile, const int verbosity)
+{
+  std::vector<std::array<float, 6>> rows;
+  if (!read_ntuple(rootfile, "fieldmap", {"x", "y", "z", "bx", "by", "bz"}, rows))
+  {
+    return -1;
+  }
+  // same unit conversions as PHField3DCartesian
+  std::vector<Point> points(rows.size());
+  for (std::size_t i = 0; i < rows.size(); i++)
+  {
+    for (int n = 0; n < 3; n++)
+    {
+      points[i].coordinate[n] = rows[i][n] * cm;
+      points[i].field[n] = rows[i][n + 3] * tesla;
+    }
+  }
+  return Fill(binaryfile, PHField3DMapped::kCartesian, points, rootfile, verbosity);
+}
+
+int PHFieldMapConverter::ConvertCylindrical(const std::string &rootfile, const std::string &binaryfile, const int verbosity)
+{
+  std::vector<std::array<float, 6>> rows;
+  if (!read_ntuple(rootfile, "map", {"z", "r", "phi", "bz", "br", "bphi"}, rows))
+  {
+    return -1;
+  }
+  // same unit conversions as PHField3DCylindrical
+  std::vector<Point> points(rows.size());
+  for (std::size_t i = 0; i < rows.size(); i++)
+  {
+    points[i].coordinate[0] = rows[i][0] * cm;
+    points[i].coordinate[1] = rows[i][1] * cm;
+    points[i].coordinate[2] = rows[i][2] * deg;
+    for (int n = 0; n < 3; n++)
+    {
+      points[i].field[n] = rows[i][n + 3] * gauss;
+    }
+  }
+  return Fill(binaryfile, PHField3DMapped::kCylindrical, points, rootfile, verbosity);
+}
+
+int PHFieldMapConverter::Fill(const std::string &binaryfile, PHField3DMapped::GridType grid,
+                              const std::vector<Point> &points, const std::string &source, const int verbosity)
+{
+  std::array<std::vector<double>, 3> axes;
+  for (int n = 0; n < 3; n++)
+  {
+    std::set<float> values;
+    for (const auto &point : points)
+    {
+      values.insert(point.coordinate[n]);
+    }
+    axes[n].assign(values.begin(), values.end());
+    if (axes[n].size() < 2)
+    {
+      std::cout << PHWHERE << " axis " << n << " of " << source << " has less than 2 values" << std::endl;
+      return -1;
+    }
+  }
+
+  const std::size_t npoints = axes[0].size() * axes[1].size() * axes[2].size();
+  std::vector<float> field(npoints * 3, 0);
+  std::vector<bool> filled(npoints, false);
+  for (const auto &point : points)
+  {
+    std::size_t index = 0;
+    for (int n = 0; n < 3; n++)
+    {
+      const auto iter = std::lower_bound(axes[n].begin(), axes[n].end(), point.coordinate[n]);
+      index = index * axes[n].size() + std::distance(axes[n].begin(), iter);
+    }
+    filled[index] = true;
+    std::copy(point.field, point.field + 3, field.begin() + index * 3);
+  }
+  const std::size_t nmissing = std::count(filled.begin(), filled.end(), false);
+  if (nmissing > 0)
+  {
+    std::cout << "PHFieldMapConverter: " << nmissing << " of " << npoints << " grid points are not in "
+              << source << ", their field is set to 0" << std::endl;
+  }
+  if (verbosity > 0)
+  {
+    std::cout << "PHFieldMapConverter: " << points.size() << " entries of " << source << " on a grid of "
+              << axes[0].size() << " x " << axes[1].size() << " x " << axes[2].size() << " points" << std::endl;
+  }
+  return Write(binaryfile, grid, axes, field, source);
+}
+
+int PHFieldMapConverter::Write(const std::string &binaryfile, PHField3DMapped::GridType grid,
+                               const std::array<std::vector<double>, 3> &axes, const std::vector<float> &field,
+                               const std::string &source)
+{
+  PHField3DMapped::Header header;
+  std::memcpy(header.magic, PHField3DMapped::kMagic, sizeof(header.magic));
+  header.version = PHField3DMapped::kVersion;
+  header.grid = grid;
+  uint64_t naxis = 0;
+  for (int n = 0; n < 3; n++)
+  {
+    header.n[n] = axes[n].size();
+    naxis += axes[n].size();
+  }
+  const uint64_t npoints = static_cast<uint64_t>(header.n[0]) * header.n[1] * header.n[2];
+  if (field.size() != npoints * 3)
+  {
+    std::cout << PHWHERE << " " << field.size() << " field values for " << npoints << " grid points" << std::endl;
+    return -1;
+  }
+  header.axis_offset = align(sizeof(header));
+  header.field_offset = align(header.axis_offset + naxis * sizeof(double));
+  header.file_size = header.field_offset + npoints * 3 * sizeof(float);
+  std::strncpy(header.source, source.c_str(), sizeof(header.source) - 1);
+
+  // write to a temporary file and rename, running jobs never map a partial file
+  const std::string tmpname = binaryfile + ".tmp." + std::to_string(getpid());
+  {
+    std::ofstream output(tmpname, std::ios::binary);
+    if (!output.is_open())
+    {
+      std::cout << PHWHERE << " could not open " << tmpname << std::endl;
+      return -1;
+    }
+    const std::vector<char> padding(64, 0);
+    output.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    output.write(padding.data(), header.axis_offset - sizeof(header));
+    for (const auto &axis : axes)
+    {
+      output.write(reinterpret_cast<const char *>(axis.data()), axis.size() * sizeof(double));
+    }
+    output.write(padding.data(), header.field_offset - (header.axis_offset + naxis * sizeof(double)));
+    output.write(reinterpret_cast<const char *>(field.data()), field.size() * sizeof(float));
+    if (!output.good())
+    {
+      std::cout << PHWHERE << " could not write " << tmpname << std::endl;
+      output.close();
+      std::remove(tmpname.c_str());
+      return -1;
+    }
+  }
+  if (std::rename(tmpname.c_str(), binaryfile.c_str()) != 0)
+  {
+    std::cout << PHWHERE << " could not rename " << tmpname << " to " << binaryfile << std::endl;
+    std::remove(tmpname.c_str());
+    return -1;
+  }
+  std::cout << "PHFieldMapConverter: wrote " << binaryfile << " (" << header.file_size << " bytes)" << std::endl;
+  return 0;
+}
@@ -0,0 +1,42 @@
+#ifndef PHFIELD_PHFIELDMAPCONVERTER_H
+#define PHFIELD_PHFIELDMAPCONVERTER_H
+
+#include "PHField3DMapped.h"
+
+#include <array>
+#include <string>
+#include <vector>
+
+//! Writes binary field maps for PHField3DMapped
+class PHFieldMapConverter
+{
+ public:
+  //! convert the ROOT map read by PHField3DCartesian (ntuple fieldmap: x, y, z [cm], bx, by, bz [T])
+  static int ConvertCartesian(const std::string &rootfile, const std::string &binaryfile, const int verbosity = 0);
+
+  //! convert the ROOT map read by PHField3DCylindrical (ntuple map: z, r [cm], phi [deg], bz, br, bphi [G])
+  static int ConvertCylindrical(const std::string &rootfile, const std::string &binaryfile, const int verbosity = 0);
+
+  //! write a binary map. Axes in mm (rad for phi), field (3 floats per grid point, last axis fastest) in Geant4/CLHEP units
+  static int Write(const std::string &binaryfile, PHField3DMapped::GridType grid,
+                   const std::array<std::vector<double>, 3> &axes, const std::vector<float> &field,
+                   const std::string &source);
+
+ private:
+  //! one entry of a ROOT map, coordinates and field in Geant4/CLHEP units
+  struct Point
+  {
+    float coordinate[3];
+    float field[3];
+  };
+
+  //! sort the points into the grid spanned by their coordinates and write it
+  static int Fill(const std::string &binaryfile, PHField3DMapped::GridType grid,
+                  const std::vector<Point> &points, const std::string &source, const int verbosity);
+
+  // static tool sets only
+  PHFieldMapConverter() = delete;
+  ~PHFieldMapConverter() = delete;
+};
+
+#endif
@@ -4,6 +4,7 @@
 #include "PHField2D.h"
 #include "PHField3DCartesian.h"
 #include "PHField3DCylindrical.h"
+#include "PHField3DMapped.h"
 #include "PHFieldInterpolated.h"
 #include "PHFieldConfig.h"
 #include "PHFieldConfigv1.h"
@@ -74,6 +75,17 @@ PHFieldUtility::BuildFieldMap(const PHFieldConfig *field_config, float inner_rad
         outer_radius,
         size_z);
     break;
+
+  case PHFieldConfig::kField3DMapped:
+    //    return "3D field map in memory mapped binary format";
+    field = new PHField3DMapped(
+        field_config->get_filename(),
+        verbosity,
+        field_config->get_magfield_rescale(),
+        inner_radius,
+        outer_radius,
+        size_z);
+    break;
   case PHFieldConfig::FieldInterpolated:
 	//    return "3d interpolated fieldmap"
     field = new PHFieldInterpolated;
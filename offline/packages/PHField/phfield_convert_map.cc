@@ -0,0 +1,24 @@
+#include "PHFieldMapConverter.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main(int argc, const char* const argv[])
+{
+  const std::vector<std::string> args(argv, argv + argc);
+
+  if (args.size() != 4 || (args[1] != "cartesian" && args[1] != "cylindrical"))
+  {
+    std::cerr << "usage: " << args[0] << " <cartesian|cylindrical> <root field map> <binary field map>" << std::endl;
+    std::cerr << "  cartesian: map read by PHField3DCartesian" << std::endl;
+    std::cerr << "  cylindrical: map read by PHField3DCylindrical" << std::endl;
+    std::cerr << "  the binary field map is read by PHField3DMapped (PHFieldConfig::kField3DMapped)" << std::endl;
+    return 1;
+  }
+
+  const int ret = (args[1] == "cartesian")
+                      ? PHFieldMapConverter::ConvertCartesian(args[2], args[3], 1)
+                      : PHFieldMapConverter::ConvertCylindrical(args[2], args[3], 1);
+  return (ret == 0) ? 0 : 1;
+}
@@ -10,6 +10,7 @@
 #include <TLegend.h>
 #include <TProfile.h>
 
+#include <algorithm>
 #include <cmath>
 #include <filesystem>
 #include <format>
@@ -417,13 +418,35 @@ void INTTXYvtx::ProcessEvt(
 
   //-------------------------------
   // tracklet reconstruction accumulated multiple events
-  for (const auto& inner_i : temp_sPH_inner_nocolumn_vec)
+  if (m_fast_pairing)
   {
-    for (const auto& outer_i : temp_sPH_outer_nocolumn_vec)
+    // note : the outer clusters passing the pre phi cut are contiguous once sorted in phi.
+    // note : they are found by binary search, then put back in the original order,
+    // note : so that the pairs are the same, in the same order, as with the full loop below
+    outer_phi_sorted.clear();
+    for (unsigned int outer_i = 0; outer_i < temp_sPH_outer_nocolumn_vec.size(); outer_i++)
+    {
+      outer_phi_sorted.emplace_back(temp_sPH_outer_nocolumn_vec[outer_i].phi, outer_i);
+    }
+    std::sort(outer_phi_sorted.begin(), outer_phi_sorted.end());
+
+    for (const auto& inner_i : temp_sPH_inner_nocolumn_vec)
     {
-      // note : try to ease the analysis and also make it quick.
-      if (fabs(inner_i.phi - outer_i.phi) < 7)  // todo : the pre phi cut is here, can be optimized
+      // note : same expression as the cut, (inner - outer) decreases along the sorted outer phi
+      auto outer_it = std::partition_point(outer_phi_sorted.begin(), outer_phi_sorted.end(),
+                                           [&inner_i](const std::pair<double, unsigned int>& outer)
+                                           { return inner_i.phi - outer.first >= 7; });
+
+      pair_candidates.clear();
+      for (; outer_it != outer_phi_sorted.end() && inner_i.phi - outer_it->first > -7; ++outer_it)
+      {
+        pair_candidates.push_back(outer_it->second);
+      }
+      std::sort(pair_candidates.begin(), pair_candidates.end());
+
+      for (const auto& outer_index : pair_candidates)
       {
+        const auto& outer_i = temp_sPH_outer_nocolumn_vec[outer_index];
         cluster_pair_vec.push_back({{inner_i.x,
                                      inner_i.y},
                                     {outer_i.x,
@@ -431,6 +454,23 @@ void INTTXYvtx::ProcessEvt(
       }
     }
   }
+  else
+  {
+    for (const auto& inner_i : temp_sPH_inner_nocolumn_vec)
+    {
+      for (const auto& outer_i : temp_sPH_outer_nocolumn_vec)
+      {
+        // note : try to ease the analysis and also make it quick.
+        if (fabs(inner_i.phi - outer_i.phi) < 7)  // todo : the pre phi cut is here, can be optimized
+        {
+          cluster_pair_vec.push_back({{inner_i.x,
+                                       inner_i.y},
+                                      {outer_i.x,
+                                       outer_i.y}});
+        }
+      }
+    }
+  }
 
   //-------------------------------
   // QA histogram
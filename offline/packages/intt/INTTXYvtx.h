@@ -74,6 +74,8 @@ class INTTXYvtx
   virtual void SetSaveHisto(const bool save) { m_savehist = save; }
   virtual void EnableDrawHisto(const bool enable) { m_enable_drawhist = enable; }
   virtual void EnableQA(const bool enable) { m_enable_qa = enable; }
+  //! pair clusters from a phi sorted window instead of all inner x outer combinations, same pairs in the same order
+  virtual void EnableFastPairing(const bool enable) { m_fast_pairing = enable; }
   virtual void PrintMessageOpt(const bool flag) { print_message_opt = flag; }
 
   //////////////////////////////////////////////////////
@@ -138,6 +140,7 @@ class INTTXYvtx
   bool m_savehist{false};
   bool m_enable_drawhist{false};
   bool m_enable_qa{false};
+  bool m_fast_pairing{true};
 
   bool m_initialized{false};
   std::string m_quad_pdfname{"New_Trial_square.pdf"};
@@ -249,6 +252,10 @@ class INTTXYvtx
   // note : this is the vector for the whole run, not event by event
   std::vector<std::pair<type_pos, type_pos>> cluster_pair_vec{};
 
+  // note : for the fast pairing, {phi, index} of the outer clusters sorted by phi, and the outer clusters paired to one inner cluster
+  std::vector<std::pair<double, unsigned int>> outer_phi_sorted{};
+  std::vector<unsigned int> pair_candidates{};
+
   double Clus_InnerPhi_Offset{0};
   double Clus_OuterPhi_Offset{0};
   double current_vtxX{0};
@@ -66,6 +66,8 @@ INTTZvtx::INTTZvtx(const std::string& runType,
   outer_clu_phi_map.clear();
   inner_clu_phi_map = std::vector<std::vector<std::pair<bool, clu_info>>>(360);
   outer_clu_phi_map = std::vector<std::vector<std::pair<bool, clu_info>>>(360);
+  inner_clu_phi_offset_map = std::vector<std::vector<double>>(360);
+  outer_clu_phi_offset_map = std::vector<std::vector<double>>(360);
 
   ///////////
   //    Init();
@@ -642,6 +644,10 @@ bool INTTZvtx::ProcessEvt(
     // std::cout<<" ("<<Clus_InnerPhi_Offset<<", "<< temp_sPH_inner_nocolumn_vec[inner_i].phi<<")" <<std::endl;
     //
     inner_clu_phi_map[int(Clus_InnerPhi_Offset)].emplace_back(false, inner_i);
+    if (m_fast_pairing)
+    {
+      inner_clu_phi_offset_map[int(Clus_InnerPhi_Offset)].push_back(Clus_InnerPhi_Offset);
+    }
 
     if (inner_i.z > 0)
     {
@@ -665,6 +671,10 @@ bool INTTZvtx::ProcessEvt(
                                      (180. / M_PI);
 
     outer_clu_phi_map[int(Clus_OuterPhi_Offset)].emplace_back(false, outer_i);
+    if (m_fast_pairing)
+    {
+      outer_clu_phi_offset_map[int(Clus_OuterPhi_Offset)].push_back(Clus_OuterPhi_Offset);
+    }
 
     if (outer_i.z > 0)
     {
@@ -681,6 +691,12 @@ bool INTTZvtx::ProcessEvt(
   // tracklet reconstruction from inner and outer clusters
   int good_pair_count = 0;
 
+  if (m_fast_pairing)
+  {
+    evt_possible_z_content.assign(evt_possible_z->GetNbinsX() + 2, 0);
+    line_breakdown_diff.assign(line_breakdown_hist->GetNbinsX() + 3, 0);
+  }
+
   for (int inner_phi_i = 0; inner_phi_i < 360; inner_phi_i++)  // note : each phi cell (1 degree)
   {
     // note : N cluster in this phi cell
@@ -691,14 +707,21 @@ bool INTTZvtx::ProcessEvt(
         continue;
       }
 
-      Clus_InnerPhi_Offset = (inner_clu_phi_map[inner_phi_i][inner_phi_clu_i].second.y - beam_origin.second < 0)
-                                 ? atan2(inner_clu_phi_map[inner_phi_i][inner_phi_clu_i].second.y - beam_origin.second,
-                                         inner_clu_phi_map[inner_phi_i][inner_phi_clu_i].second.x - beam_origin.first) *
-                                           (180. / M_PI) +
-                                       360
-                                 : atan2(inner_clu_phi_map[inner_phi_i][inner_phi_clu_i].second.y - beam_origin.second,
-                                         inner_clu_phi_map[inner_phi_i][inner_phi_clu_i].second.x - beam_origin.first) *
-                                       (180. / M_PI);
+      if (m_fast_pairing)
+      {
+        Clus_InnerPhi_Offset = inner_clu_phi_offset_map[inner_phi_i][inner_phi_clu_i];
+      }
+      else
+      {
+        Clus_InnerPhi_Offset = (inner_clu_phi_map[inner_phi_i][inner_phi_clu_i].second.y - beam_origin.second < 0)
+                                   ? atan2(inner_clu_phi_map[inner_phi_i][inner_phi_clu_i].second.y - beam_origin.second,
+                                           inner_clu_phi_map[inner_phi_i][inner_phi_clu_i].second.x - beam_origin.first) *
+                                             (180. / M_PI) +
+                                         360
+                                   : atan2(inner_clu_phi_map[inner_phi_i][inner_phi_clu_i].second.y - beam_origin.second,
+                                           inner_clu_phi_map[inner_phi_i][inner_phi_clu_i].second.x - beam_origin.first) *
+                                         (180. / M_PI);
+      }
 
       // todo: change the outer phi scan range
       // note : the outer phi index, -1, 0, 1
@@ -732,14 +755,21 @@ bool INTTZvtx::ProcessEvt(
             continue;
           }
 
-          Clus_OuterPhi_Offset = (outer_clu_phi_map[true_scan_i][outer_phi_clu_i].second.y - beam_origin.second < 0)
-                                     ? atan2(outer_clu_phi_map[true_scan_i][outer_phi_clu_i].second.y - beam_origin.second,
-                                             outer_clu_phi_map[true_scan_i][outer_phi_clu_i].second.x - beam_origin.first) *
-                                               (180. / M_PI) +
-                                           360
-                                     : atan2(outer_clu_phi_map[true_scan_i][outer_phi_clu_i].second.y - beam_origin.second,
-                                             outer_clu_phi_map[true_scan_i][outer_phi_clu_i].second.x - beam_origin.first) *
-                                           (180. / M_PI);
+          if (m_fast_pairing)
+          {
+            Clus_OuterPhi_Offset = outer_clu_phi_offset_map[true_scan_i][outer_phi_clu_i];
+          }
+          else
+          {
+            Clus_OuterPhi_Offset = (outer_clu_phi_map[true_scan_i][outer_phi_clu_i].second.y - beam_origin.second < 0)
+                                       ? atan2(outer_clu_phi_map[true_scan_i][outer_phi_clu_i].second.y - beam_origin.second,
+                                               outer_clu_phi_map[true_scan_i][outer_phi_clu_i].second.x - beam_origin.first) *
+                                                 (180. / M_PI) +
+                                             360
+                                       : atan2(outer_clu_phi_map[true_scan_i][outer_phi_clu_i].second.y - beam_origin.second,
+                                               outer_clu_phi_map[true_scan_i][outer_phi_clu_i].second.x - beam_origin.first) *
+                                             (180. / M_PI);
+          }
 
           double delta_phi = get_delta_phi(Clus_InnerPhi_Offset, Clus_OuterPhi_Offset);
 
@@ -771,15 +801,30 @@ bool INTTZvtx::ProcessEvt(
               // note : we basically transform the coordinate from cartesian to cylinder
               // note : we should set the offset first, otherwise it provides the bias
               // todo : which point should be used, DCA point or vertex xy ? Has to be studied
-              std::pair<double, double> z_range_info = Get_possible_zvtx(
-                  0.,  // get_radius(beam_origin.first,beam_origin.second),
-                  {get_radius(inner_clu_phi_map[inner_phi_i][inner_phi_clu_i].second.x - beam_origin.first,
-                              inner_clu_phi_map[inner_phi_i][inner_phi_clu_i].second.y - beam_origin.second),
-                   inner_clu_phi_map[inner_phi_i][inner_phi_clu_i].second.z},  // note : unsign radius
-                  {get_radius(outer_clu_phi_map[true_scan_i][outer_phi_clu_i].second.x - beam_origin.first,
-                              outer_clu_phi_map[true_scan_i][outer_phi_clu_i].second.y - beam_origin.second),
-                   outer_clu_phi_map[true_scan_i][outer_phi_clu_i].second.z}  // note : unsign radius
-              );
+              std::pair<double, double> z_range_info;
+              if (m_fast_pairing)
+              {
+                z_range_info = Get_possible_zvtx(
+                    0.,
+                    get_radius(inner_clu_phi_map[inner_phi_i][inner_phi_clu_i].second.x - beam_origin.first,
+                               inner_clu_phi_map[inner_phi_i][inner_phi_clu_i].second.y - beam_origin.second),
+                    inner_clu_phi_map[inner_phi_i][inner_phi_clu_i].second.z,
+                    get_radius(outer_clu_phi_map[true_scan_i][outer_phi_clu_i].second.x - beam_origin.first,
+                               outer_clu_phi_map[true_scan_i][outer_phi_clu_i].second.y - beam_origin.second),
+                    outer_clu_phi_map[true_scan_i][outer_phi_clu_i].second.z);
+              }
+              else
+              {
+                z_range_info = Get_possible_zvtx(
+                    0.,  // get_radius(beam_origin.first,beam_origin.second),
+                    {get_radius(inner_clu_phi_map[inner_phi_i][inner_phi_clu_i].second.x - beam_origin.first,
+                                inner_clu_phi_map[inner_phi_i][inner_phi_clu_i].second.y - beam_origin.second),
+                     inner_clu_phi_map[inner_phi_i][inner_phi_clu_i].second.z},  // note : unsign radius
+                    {get_radius(outer_clu_phi_map[true_scan_i][outer_phi_clu_i].second.x - beam_origin.first,
+                                outer_clu_phi_map[true_scan_i][outer_phi_clu_i].second.y - beam_origin.second),
+                     outer_clu_phi_map[true_scan_i][outer_phi_clu_i].second.z}  // note : unsign radius
+                );
+              }
 
               // note : try to remove some crazy background candidates. Can be a todo
               if (evt_possible_z_range.first < z_range_info.first && z_range_info.first < evt_possible_z_range.second)
@@ -790,12 +835,23 @@ bool INTTZvtx::ProcessEvt(
                 z_mid.push_back(z_range_info.first);
                 z_range.push_back(z_range_info.second);
 
-                evt_possible_z->Fill(z_range_info.first);  // used for calculation
+                if (m_fast_pairing)
+                {
+                  evt_possible_z_content[evt_possible_z->GetXaxis()->FindFixBin(z_range_info.first)] += 1;
+
+                  line_breakdown(line_breakdown_diff, line_breakdown_hist,
+                                 {z_range_info.first - z_range_info.second,
+                                  z_range_info.first + z_range_info.second});
+                }
+                else
+                {
+                  evt_possible_z->Fill(z_range_info.first);  // used for calculation
 
-                // note : fill the line_breakdwon histogram as well as a vector for the width determination
-                line_breakdown(line_breakdown_hist,  // used for calculation
-                               {z_range_info.first - z_range_info.second,
-                                z_range_info.first + z_range_info.second});
+                  // note : fill the line_breakdwon histogram as well as a vector for the width determination
+                  line_breakdown(line_breakdown_hist,  // used for calculation
+                                 {z_range_info.first - z_range_info.second,
+                                  z_range_info.first + z_range_info.second});
+                }
 
                 good_comb_id += 1;
               }
@@ -808,6 +864,28 @@ bool INTTZvtx::ProcessEvt(
   }  // note : end of inner clu loop
   //--std::cout<<"--4--"<<std::endl;
 
+  if (m_fast_pairing)
+  {
+    // note : move the accumulated entries to the histograms, used by the fits and the group finding
+    for (unsigned int bin = 0; bin < evt_possible_z_content.size(); bin++)
+    {
+      if (evt_possible_z_content[bin] != 0)
+      {
+        evt_possible_z->SetBinContent(bin, evt_possible_z_content[bin]);
+      }
+    }
+
+    int line_breakdown_content = 0;
+    for (unsigned int bin = 0; bin + 1 < line_breakdown_diff.size(); bin++)
+    {
+      line_breakdown_content += line_breakdown_diff[bin];
+      if (line_breakdown_content != 0)
+      {
+        line_breakdown_hist->SetBinContent(bin, line_breakdown_content);
+      }
+    }
+  }
+
   // if (event_i == 906) {
   //     for (int hist_i = 0; hist_i < line_breakdown_hist->GetNbinsX(); hist_i++){
   //         std::cout<<line_breakdown_hist->GetBinContent(hist_i+1)<<","<<std::endl;
@@ -881,43 +959,49 @@ bool INTTZvtx::ProcessEvt(
     // additional QA below
     // note : eff sigma method, relatively sensitive to the background
     // note : use z-mid to do the effi_sig, because that line_breakdown takes too long time
-    temp_event_zvtx_info = InttVertexUtil::sigmaEff_avg(z_mid, Integrate_portion);
-
     std::vector<double> eff_N_comb;    // QA
     std::vector<double> eff_N_comb_e;  // QA
     std::vector<double> eff_z_mid;     // QA
     std::vector<double> eff_z_range;   // QA note : eff_sig
-    for (unsigned int track_i = 0; track_i < N_comb.size(); track_i++)
+    double width_density_par = -1;     // QA
+
+    // note : only used for QA and the event display, the fast pairing skips it otherwise
+    if (!m_fast_pairing || m_enable_qa || draw_event_display)
     {
-      if (N_group_info[2] <= z_mid[track_i] && z_mid[track_i] <= N_group_info[3])
-      {
-        eff_N_comb.push_back(N_comb[track_i]);
-        eff_N_comb_e.push_back(N_comb_e[track_i]);
-        eff_z_mid.push_back(z_mid[track_i]);
-        eff_z_range.push_back(z_range[track_i]);
-      }
+      temp_event_zvtx_info = InttVertexUtil::sigmaEff_avg(z_mid, Integrate_portion);
 
-      if (draw_event_display)
+      for (unsigned int track_i = 0; track_i < N_comb.size(); track_i++)
       {
-        if (final_selection_widthD <= z_mid[track_i] && z_mid[track_i] <= final_selection_widthU)
+        if (N_group_info[2] <= z_mid[track_i] && z_mid[track_i] <= N_group_info[3])
+        {
+          eff_N_comb.push_back(N_comb[track_i]);
+          eff_N_comb_e.push_back(N_comb_e[track_i]);
+          eff_z_mid.push_back(z_mid[track_i]);
+          eff_z_range.push_back(z_range[track_i]);
+        }
+
+        if (draw_event_display)
         {
-          // note : for monitoring the the phi distribution that is used for the z vertex determination.
-          // note : in principle, I expect it should be something uniform.
-          evt_select_track_phi->Fill(N_comb_phi[track_i]);  // QA
+          if (final_selection_widthD <= z_mid[track_i] && z_mid[track_i] <= final_selection_widthU)
+          {
+            // note : for monitoring the the phi distribution that is used for the z vertex determination.
+            // note : in principle, I expect it should be something uniform.
+            evt_select_track_phi->Fill(N_comb_phi[track_i]);  // QA
+          }
         }
       }
-    }
 
-    //--std::cout<<"--6--"<<std::endl;
+      //--std::cout<<"--6--"<<std::endl;
 
-    delete z_range_gr;
+      delete z_range_gr;
 
-    z_range_gr = new TGraphErrors(eff_N_comb.size(),
-                                  eff_N_comb.data(), eff_z_mid.data(),
-                                  eff_N_comb_e.data(), eff_z_range.data());
+      z_range_gr = new TGraphErrors(eff_N_comb.size(),
+                                    eff_N_comb.data(), eff_z_mid.data(),
+                                    eff_N_comb_e.data(), eff_z_range.data());
 
-    z_range_gr->Fit(zvtx_finder, "NQ", "", 0, N_comb[N_comb.size() - 1]);
-    double width_density_par = (double(eff_N_comb.size()) / fabs(temp_event_zvtx_info[2] - temp_event_zvtx_info[1]));
+      z_range_gr->Fit(zvtx_finder, "NQ", "", 0, N_comb[N_comb.size() - 1]);
+      width_density_par = (double(eff_N_comb.size()) / fabs(temp_event_zvtx_info[2] - temp_event_zvtx_info[1]));
+    }
 
     if (zvtx_QA_width.first < tight_offset_width &&
         tight_offset_width < zvtx_QA_width.second &&
@@ -1291,10 +1375,24 @@ void INTTZvtx::ClearEvt()
     evt_phi_diff_inner_phi->Reset("ICESM");
   }
 
-  inner_clu_phi_map.clear();
-  outer_clu_phi_map.clear();
-  inner_clu_phi_map = std::vector<std::vector<std::pair<bool, clu_info>>>(360);
-  outer_clu_phi_map = std::vector<std::vector<std::pair<bool, clu_info>>>(360);
+  if (m_fast_pairing)
+  {
+    // note : keep the cell storage for the next event
+    for (int phi_i = 0; phi_i < 360; phi_i++)
+    {
+      inner_clu_phi_map[phi_i].clear();
+      outer_clu_phi_map[phi_i].clear();
+      inner_clu_phi_offset_map[phi_i].clear();
+      outer_clu_phi_offset_map[phi_i].clear();
+    }
+  }
+  else
+  {
+    inner_clu_phi_map.clear();
+    outer_clu_phi_map.clear();
+    inner_clu_phi_map = std::vector<std::vector<std::pair<bool, clu_info>>>(360);
+    outer_clu_phi_map = std::vector<std::vector<std::pair<bool, clu_info>>>(360);
+  }
 
   // note : this is the distribution for full run
   // line_breakdown_gaus_ratio_hist -> Reset("ICESM");
@@ -1668,11 +1766,16 @@ double INTTZvtx::Get_extrapolation(double given_y, double p0x, double p0y, doubl
 
 std::pair<double, double> INTTZvtx::Get_possible_zvtx(double rvtx, std::vector<double> p0, std::vector<double> p1)  // note : inner p0, outer p1, vector {r,z}, -> {y,x}
 {
-  std::vector<double> p0_z_edge = {(fabs(p0[1]) < 130) ? p0[1] - 8. : p0[1] - 10., (fabs(p0[1]) < 130) ? p0[1] + 8. : p0[1] + 10.};  // note : vector {left edge, right edge}
-  std::vector<double> p1_z_edge = {(fabs(p1[1]) < 130) ? p1[1] - 8. : p1[1] - 10., (fabs(p1[1]) < 130) ? p1[1] + 8. : p1[1] + 10.};  // note : vector {left edge, right edge}
+  return Get_possible_zvtx(rvtx, p0[0], p0[1], p1[0], p1[1]);
+}
+
+std::pair<double, double> INTTZvtx::Get_possible_zvtx(double rvtx, double p0r, double p0z, double p1r, double p1z)  // note : inner p0, outer p1
+{
+  std::pair<double, double> p0_z_edge = {(fabs(p0z) < 130) ? p0z - 8. : p0z - 10., (fabs(p0z) < 130) ? p0z + 8. : p0z + 10.};  // note : {left edge, right edge}
+  std::pair<double, double> p1_z_edge = {(fabs(p1z) < 130) ? p1z - 8. : p1z - 10., (fabs(p1z) < 130) ? p1z + 8. : p1z + 10.};  // note : {left edge, right edge}
 
-  double edge_first = Get_extrapolation(rvtx, p0_z_edge[0], p0[0], p1_z_edge[1], p1[0]);
-  double edge_second = Get_extrapolation(rvtx, p0_z_edge[1], p0[0], p1_z_edge[0], p1[0]);
+  double edge_first = Get_extrapolation(rvtx, p0_z_edge.first, p0r, p1_z_edge.second, p1r);
+  double edge_second = Get_extrapolation(rvtx, p0_z_edge.second, p0r, p1_z_edge.first, p1r);
 
   double mid_point = (edge_first + edge_second) / 2.;
   double possible_width = fabs(edge_first - edge_second) / 2.;
@@ -1681,6 +1784,27 @@ std::pair<double, double> INTTZvtx::Get_possible_zvtx(double rvtx, std::vector<d
 }
 
 void INTTZvtx::line_breakdown(TH1* hist_in, std::pair<double, double> line_range)
+{
+  const auto [first_bin, last_bin] = line_breakdown_bins(hist_in, line_range);
+
+  // note : if first:last = (0:0) or (N+1:N+1) -> the subtraction of them euqals to zero.
+  for (int i = 0; i < (last_bin - first_bin) + 1; i++)
+  {
+    hist_in->SetBinContent(first_bin + i, hist_in->GetBinContent(first_bin + i) + 1);
+  }
+}
+
+// note : same bins as above, but the entry is added to the bin to bin differences, the contents are their running sum
+void INTTZvtx::line_breakdown(std::vector<int>& diff_in, TH1* hist_in, std::pair<double, double> line_range)
+{
+  const auto [first_bin, last_bin] = line_breakdown_bins(hist_in, line_range);
+
+  diff_in[first_bin] += 1;
+  diff_in[last_bin + 1] -= 1;
+}
+
+// note : {first bin, last bin} covered by the line, under/overflow bin if outside of the histogram
+std::pair<int, int> INTTZvtx::line_breakdown_bins(TH1* hist_in, std::pair<double, double> line_range)
 {
   int first_bin = int((line_range.first - hist_in->GetXaxis()->GetXmin()) / hist_in->GetBinWidth(1)) + 1;
   int last_bin = int((line_range.second - hist_in->GetXaxis()->GetXmin()) / hist_in->GetBinWidth(1)) + 1;
@@ -1705,11 +1829,7 @@ void INTTZvtx::line_breakdown(TH1* hist_in, std::pair<double, double> line_range
 
   // std::cout<<"Digitize the bin : "<<first_bin<<" "<<last_bin<<std::endl;
 
-  // note : if first:last = (0:0) or (N+1:N+1) -> the subtraction of them euqals to zero.
-  for (int i = 0; i < (last_bin - first_bin) + 1; i++)
-  {
-    hist_in->SetBinContent(first_bin + i, hist_in->GetBinContent(first_bin + i) + 1);
-  }
+  return {first_bin, last_bin};
 }
 
 // note : search_range : should be the gaus fit range
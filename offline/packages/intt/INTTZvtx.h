@@ -103,6 +103,8 @@ class INTTZvtx
 
   void EnableEventDisplay(const bool enableEvtDisp) { draw_event_display = enableEvtDisp; }
   void EnableQA(const bool enableQA) { m_enable_qa = enableQA; }
+  //! cluster phi computed once, z histograms accumulated in plain arrays, QA only fits skipped. Same vertex as the default path
+  void EnableFastPairing(const bool enable) { m_fast_pairing = enable; }
 
   double GetZdiffPeakMC();
   double GetZdiffWidthMC();
@@ -128,6 +130,7 @@ class INTTZvtx
   std::pair<double, double> zvtx_QA_width;  // note : for the zvtx range Quality check, check the width
   bool draw_event_display{false};
   bool m_enable_qa{false};
+  bool m_fast_pairing{true};
   bool print_message_opt;
 
   std::pair<double, double> evt_possible_z_range = {-700, 700};
@@ -142,6 +145,12 @@ class INTTZvtx
 
   std::vector<std::vector<std::pair<bool, clu_info>>> inner_clu_phi_map{};  // note: phi
   std::vector<std::vector<std::pair<bool, clu_info>>> outer_clu_phi_map{};  // note: phi
+  std::vector<std::vector<double>> inner_clu_phi_offset_map{};               // note: phi w.r.t. beam origin of the clusters in inner_clu_phi_map, fast pairing
+  std::vector<std::vector<double>> outer_clu_phi_offset_map{};               // note: phi w.r.t. beam origin of the clusters in outer_clu_phi_map, fast pairing
+
+  // note : fast pairing, bin contents of evt_possible_z, and bin to bin differences of line_breakdown_hist (including under/overflow)
+  std::vector<int> evt_possible_z_content{};
+  std::vector<int> line_breakdown_diff{};
 
   ZvtxInfo m_zvtxinfo;
 
@@ -280,11 +289,14 @@ class INTTZvtx
 
   // function for analysis
   std::pair<double, double> Get_possible_zvtx(double rvtx, std::vector<double> p0, std::vector<double> p1);
+  std::pair<double, double> Get_possible_zvtx(double rvtx, double p0r, double p0z, double p1r, double p1z);
   std::vector<double> find_Ngroup(TH1* hist_in);
   double get_radius(double x, double y);
   double calculateAngleBetweenVectors(double x1, double y1, double x2, double y2, double targetX, double targetY);
   double Get_extrapolation(double given_y, double p0x, double p0y, double p1x, double p1y);
   void line_breakdown(TH1* hist_in, std::pair<double, double> line_range);
+  void line_breakdown(std::vector<int>& diff_in, TH1* hist_in, std::pair<double, double> line_range);
+  std::pair<int, int> line_breakdown_bins(TH1* hist_in, std::pair<double, double> line_range);
 
   // tracklet reco
   double get_delta_phi(double angle_1, double angle_2);
@@ -6,6 +6,7 @@
 #include <trackbase/TrkrClusterCrossingAssocv1.h>
 #include <trackbase/TrkrClusterHitAssocv3.h>
 #include <trackbase/TrkrClusterv5.h>
+#include <trackbase/TrkrGridClustering.h>
 #include <trackbase/TrkrHit.h>
 #include <trackbase/TrkrHitSet.h>
 #include <trackbase/TrkrHitSetContainer.h>
@@ -210,6 +211,7 @@ int InttClusterizer::InitRun(PHCompositeNode* topNode)
     {
       std::cout << " Energy weighting clusters in Layer #" << _make_e_weight.first << " = " << std::boolalpha << _make_e_weight.second << std::noboolalpha << std::endl;
     }
+    std::cout << " Graph clustering = " << std::boolalpha << m_graph_clustering << std::noboolalpha << std::endl;
     std::cout << "===========================================================================" << std::endl;
   }
 
@@ -401,29 +403,44 @@ void InttClusterizer::ClusterLadderCells(PHCompositeNode* topNode)
       std::cout << "hitvec.size(): " << hitvec.size() << std::endl;
     }
 
-    using Graph = boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS>;
-    Graph G;
-
-    // Find adjacent strips
-    for (unsigned int i = 0; i < hitvec.size(); i++)
+    std::vector<int> component;
+    if (m_graph_clustering)
     {
-      for (unsigned int j = i + 1; j < hitvec.size(); j++)
+      using Graph = boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS>;
+      Graph G;
+
+      // Find adjacent strips
+      for (unsigned int i = 0; i < hitvec.size(); i++)
       {
-        if (ladder_are_adjacent(hitvec[i], hitvec[j], layer))
+        for (unsigned int j = i + 1; j < hitvec.size(); j++)
         {
-          add_edge(i, j, G);
+          if (ladder_are_adjacent(hitvec[i], hitvec[j], layer))
+          {
+            add_edge(i, j, G);
+          }
         }
-      }
 
-      add_edge(i, i, G);
-    }
+        add_edge(i, i, G);
+      }
 
-    // Find the connections between the vertices of the graph (vertices are the rawhits,
-    // connections are made when they are adjacent to one another)
-    std::vector<int> component(num_vertices(G));
+      // Find the connections between the vertices of the graph (vertices are the rawhits,
+      // connections are made when they are adjacent to one another)
+      component.resize(num_vertices(G));
 
-    // this is the actual clustering, performed by boost
-    connected_components(G, component.data());
+      // this is the actual clustering, performed by boost
+      connected_components(G, component.data());
+    }
+    else
+    {
+      // strip scan along each column, same clusters as the graph in linear time
+      std::vector<TrkrGridClustering::Cell> cells;
+      cells.reserve(hitvec.size());
+      for (const auto& hit : hitvec)
+      {
+        cells.push_back({InttDefs::getCol(hit.first), InttDefs::getRow(hit.first)});
+      }
+      TrkrGridClustering::find_clusters(cells, get_z_clustering(layer) ? 1 : 0, 1, component);
+    }
 
     // Loop over the components(hit cells) compiling a list of the
     // unique connected groups (ie. clusters).
@@ -670,29 +687,44 @@ void InttClusterizer::ClusterLadderCellsRaw(PHCompositeNode* topNode)
       std::cout << "hitvec.size(): " << hitvec.size() << std::endl;
     }
 
-    using Graph = boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS>;
-    Graph G;
-
-    // Find adjacent strips
-    for (unsigned int i = 0; i < hitvec.size(); i++)
+    std::vector<int> component;
+    if (m_graph_clustering)
     {
-      for (unsigned int j = i + 1; j < hitvec.size(); j++)
+      using Graph = boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS>;
+      Graph G;
+
+      // Find adjacent strips
+      for (unsigned int i = 0; i < hitvec.size(); i++)
       {
-        if (ladder_are_adjacent(hitvec[i], hitvec[j], layer))
+        for (unsigned int j = i + 1; j < hitvec.size(); j++)
         {
-          add_edge(i, j, G);
+          if (ladder_are_adjacent(hitvec[i], hitvec[j], layer))
+          {
+            add_edge(i, j, G);
+          }
         }
-      }
 
-      add_edge(i, i, G);
-    }
+        add_edge(i, i, G);
+      }
 
-    // Find the connections between the vertices of the graph (vertices are the rawhits,
-    // connections are made when they are adjacent to one another)
-    std::vector<int> component(num_vertices(G));
+      // Find the connections between the vertices of the graph (vertices are the rawhits,
+      // connections are made when they are adjacent to one another)
+      component.resize(num_vertices(G));
 
-    // this is the actual clustering, performed by boost
-    connected_components(G, component.data());
+      // this is the actual clustering, performed by boost
+      connected_components(G, component.data());
+    }
+    else
+    {
+      // strip scan along phi for each time bin, same clusters as the graph in linear time
+      std::vector<TrkrGridClustering::Cell> cells;
+      cells.reserve(hitvec.size());
+      for (auto* hit : hitvec)
+      {
+        cells.push_back({hit->getTBin(), hit->getPhiBin()});
+      }
+      TrkrGridClustering::find_clusters(cells, get_z_clustering(layer) ? 1 : 0, 1, component);
+    }
 
     // Loop over the components(hit cells) compiling a list of the
     // unique connected groups (ie. clusters).
@@ -69,6 +69,17 @@ class InttClusterizer : public SubsysReco
     return _make_e_weights.find(layer)->second;
   }
 
+  //! option to cluster with the boost graph of all adjacent strip pairs, rather than the linear time strip scan. Both give identical clusters
+  void set_graph_clustering(const bool graph_clustering)
+  {
+    m_graph_clustering = graph_clustering;
+  }
+
+  bool get_graph_clustering() const
+  {
+    return m_graph_clustering;
+  }
+
   void set_do_hit_association(bool do_assoc) { do_hit_assoc = do_assoc; }
   void set_read_raw(bool read_raw) { do_read_raw = read_raw; }
 
@@ -100,6 +111,7 @@ class InttClusterizer : public SubsysReco
   std::map<int, bool> _make_e_weights;        // layer->energy_weighting_option
   bool do_hit_assoc = true;
   bool do_read_raw = false;
+  bool m_graph_clustering = false;
 };
 
 #endif
@@ -0,0 +1,219 @@
+/**
+ * @file intt/InttVertexPairingBenchmark.cc
+ * @brief compare the fast and the original cluster pairing of INTTXYvtx and INTTZvtx
+ *
+ * usage: InttVertexPairingBenchmark [events per multiplicity]
+ *
+ * Events are generated with straight tracks from a vertex smeared around the beam spot,
+ * crossing the two inner and the two outer INTT layers, plus a fraction of random clusters.
+ * The number of tracks is scanned from peripheral to central like multiplicities.
+ * For each multiplicity, the same events go through both pairing modes:
+ * - INTTZvtx: the z vertex and the InttVertexMap information must be identical event by event,
+ * - INTTXYvtx: the accumulated cluster pairs must give the identical quadrant scan result.
+ */
+#include "INTTXYvtx.h"
+#include "INTTZvtx.h"
+
+#include <TH1.h>
+
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+  // note : units are mm and degree, as in the vertex finders
+  const std::pair<double, double> beam_origin = {-0.23, 2.6};
+  const std::vector<double> layer_radius = {71.9, 77.7, 96.8, 102.6};
+
+  struct Event
+  {
+    std::vector<INTTZvtx::clu_info> inner_z;
+    std::vector<INTTZvtx::clu_info> outer_z;
+    std::vector<INTTXYvtx::clu_info> inner_xy;
+    std::vector<INTTXYvtx::clu_info> outer_xy;
+    std::vector<std::vector<double>> nocolumn_vec{2};
+    std::vector<std::vector<double>> nocolumn_rz_vec{2};
+  };
+
+  void add_cluster(Event& event, double x, double y, double z, int layer)
+  {
+    const double phi = (y < 0) ? atan2(y, x) * (180. / M_PI) + 360 : atan2(y, x) * (180. / M_PI);
+    const INTTZvtx::clu_info clu_z{.column = -1, .avg_chan = 0, .sum_adc = 100, .sum_adc_conv = 100, .size = 1, .x = x, .y = y, .z = z, .layer = layer, .phi = phi};
+    const INTTXYvtx::clu_info clu_xy{.column = -1, .avg_chan = 0, .sum_adc = 100, .sum_adc_conv = 100, .size = 1, .x = x, .y = y, .z = z, .layer = layer, .phi = phi};
+    if (layer < 2)
+    {
+      event.inner_z.push_back(clu_z);
+      event.inner_xy.push_back(clu_xy);
+    }
+    else
+    {
+      event.outer_z.push_back(clu_z);
+      event.outer_xy.push_back(clu_xy);
+    }
+    event.nocolumn_vec[0].push_back(x);
+    event.nocolumn_vec[1].push_back(y);
+    event.nocolumn_rz_vec[0].push_back(z);
+    event.nocolumn_rz_vec[1].push_back((phi > 180) ? -std::hypot(x, y) : std::hypot(x, y));
+  }
+
+  Event generate(std::mt19937_64& rng, int ntracks)
+  {
+    std::normal_distribution<double> beam_spot(0, 0.1);
+    std::normal_distribution<double> vertex_z(-100, 80);
+    std::uniform_real_distribution<double> track_phi(-M_PI, M_PI);
+    std::uniform_real_distribution<double> track_eta(-1.2, 1.2);
+    std::uniform_real_distribution<double> strip(-8, 8);
+    std::uniform_real_distribution<double> uniform(0, 1);
+
+    Event event;
+    const double xv = beam_origin.first + beam_spot(rng);
+    const double yv = beam_origin.second + beam_spot(rng);
+    const double zv = vertex_z(rng);
+    for (int track_i = 0; track_i < ntracks; track_i++)
+    {
+      const double phi = track_phi(rng);
+      const double cot_theta = std::sinh(track_eta(rng));
+      for (int layer = 0; layer < 4; layer++)
+      {
+        // note : about one cluster out of ten is missing
+        if (uniform(rng) < 0.1)
+        {
+          continue;
+        }
+        // note : distance along the track to the layer radius
+        const double bx = xv * cos(phi) + yv * sin(phi);
+        const double length = -bx + std::sqrt(bx * bx - (xv * xv + yv * yv) + layer_radius[layer] * layer_radius[layer]);
+        add_cluster(event, xv + length * cos(phi), yv + length * sin(phi), zv + length * cot_theta + strip(rng), layer);
+      }
+    }
+
+    // note : random clusters, 10% of the tracks
+    for (int noise_i = 0; noise_i < ntracks / 10; noise_i++)
+    {
+      const int layer = rng() % 4;
+      const double phi = track_phi(rng);
+      add_cluster(event, layer_radius[layer] * cos(phi), layer_radius[layer] * sin(phi), 200 * track_eta(rng), layer);
+    }
+    return event;
+  }
+
+  bool same(double a, double b)
+  {
+    return a == b || (std::isnan(a) && std::isnan(b));
+  }
+
+  bool same(const INTTZvtx::ZvtxInfo& a, const INTTZvtx::ZvtxInfo& b)
+  {
+    return same(a.zvtx, b.zvtx) && same(a.zvtx_err, b.zvtx_err) && same(a.chi2ndf, b.chi2ndf) && same(a.width, b.width) &&
+           a.good == b.good && a.nclus == b.nclus && a.ntracklets == b.ntracklets && a.ngroup == b.ngroup &&
+           same(a.peakratio, b.peakratio) && same(a.peakwidth, b.peakwidth);
+  }
+
+  // one vertex finder of each kind, for a given pairing mode
+  struct Finders
+  {
+    INTTZvtx zvtx;
+    INTTXYvtx xyvtx;
+    double z_time = 0;
+    double xy_time = 0;
+
+    Finders(const std::string& out_folder, bool fast_pairing)
+      // note : same settings as InttZVertexFinder, no cluster limit for INTTXYvtx to scan all multiplicities
+      : zvtx("data", out_folder, beam_origin, 1, {-3, 3}, 4, 10000, 3, {40, 70}, false, false, false)
+      , xyvtx("data", out_folder, {0, 0}, 0.35, {-1, 1}, 20, 100000, 0.0, 3, 3.32405, false)
+    {
+      zvtx.EnableFastPairing(fast_pairing);
+      xyvtx.EnableFastPairing(fast_pairing);
+      zvtx.Init();
+      xyvtx.Init();
+    }
+
+    INTTZvtx::ZvtxInfo process(int event_i, Event& event)
+    {
+      auto start = std::chrono::high_resolution_clock::now();
+      zvtx.ProcessEvt(event_i, event.inner_z, event.outer_z, event.nocolumn_vec, event.nocolumn_rz_vec, 1, 0, true, 0, 0);
+      INTTZvtx::ZvtxInfo out = zvtx.GetZvtxInfo();
+      zvtx.ClearEvt();
+      z_time += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+      start = std::chrono::high_resolution_clock::now();
+      xyvtx.ProcessEvt(event_i, event.inner_xy, event.outer_xy, event.nocolumn_vec, event.nocolumn_rz_vec, 1, 0, true, 0);
+      xyvtx.ClearEvt();
+      xy_time += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+      return out;
+    }
+  };
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  const int nevents = (argc > 1) ? std::stoi(argv[1]) : 20;
+  const std::string out_folder = (std::filesystem::temp_directory_path() / "InttVertexPairingBenchmark").string();
+
+  // note : the finders of each multiplicity create histograms with the same names
+  TH1::AddDirectory(false);
+
+  std::cout << "InttVertexPairingBenchmark - " << nevents << " events per multiplicity, times in ms per event" << std::endl;
+  std::cout << "ntracks  nclusters  z original  z fast  speedup  xy original  xy fast  speedup  pairs" << std::endl;
+
+  bool identical = true;
+  std::mt19937_64 rng(12345);
+  for (const int ntracks : {25, 100, 300, 1000, 2000})
+  {
+    Finders original(out_folder, false);
+    Finders fast(out_folder, true);
+
+    long nclusters = 0;
+    for (int event_i = 0; event_i < nevents; event_i++)
+    {
+      Event event = generate(rng, ntracks);
+      nclusters += event.inner_z.size() + event.outer_z.size();
+
+      // note : the z finder prints for every event
+      std::ostringstream discard;
+      auto* cout_buffer = std::cout.rdbuf(discard.rdbuf());
+      const auto original_info = original.process(event_i, event);
+      const auto fast_info = fast.process(event_i, event);
+      std::cout.rdbuf(cout_buffer);
+
+      if (!same(original_info, fast_info))
+      {
+        std::cout << "InttVertexPairingBenchmark - ntracks " << ntracks << " event " << event_i << ": z vertex differs, "
+                  << original_info.zvtx << " " << fast_info.zvtx << std::endl;
+        identical = false;
+      }
+    }
+
+    std::ostringstream discard;
+    auto* cout_buffer = std::cout.rdbuf(discard.rdbuf());
+    const auto original_xy = original.xyvtx.MacroVTXSquare(4, 10);
+    const auto fast_xy = fast.xyvtx.MacroVTXSquare(4, 10);
+    std::cout.rdbuf(cout_buffer);
+    if (original.xyvtx.GetVecNele() != fast.xyvtx.GetVecNele() || original_xy != fast_xy)
+    {
+      std::cout << "InttVertexPairingBenchmark - ntracks " << ntracks << ": xy vertex differs, "
+                << original_xy[0].first << " " << original_xy[0].second << " " << fast_xy[0].first << " " << fast_xy[0].second << std::endl;
+      identical = false;
+    }
+
+    std::cout << ntracks << "  " << nclusters / nevents
+              << "  " << original.z_time / nevents << "  " << fast.z_time / nevents << "  " << original.z_time / fast.z_time
+              << "  " << original.xy_time / nevents << "  " << fast.xy_time / nevents << "  " << original.xy_time / fast.xy_time
+              << "  " << fast.xyvtx.GetVecNele() / nevents << std::endl;
+  }
+
+  std::filesystem::remove_all(out_folder);
+  if (!identical)
+  {
+    std::cout << "InttVertexPairingBenchmark - results differ" << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -396,3 +396,11 @@ void InttXYVertexFinder::EnableQA(const bool enable)
     m_inttxyvtx->EnableQA(enable);
   }
 }
+
+void InttXYVertexFinder::EnableFastPairing(const bool enable)
+{
+  if (m_inttxyvtx != nullptr)
+  {
+    m_inttxyvtx->EnableFastPairing(enable);
+  }
+}
@@ -39,6 +39,9 @@ class InttXYVertexFinder : public SubsysReco
   void EnableDrawHisto(const bool enable);
   void EnableQA(const bool enable);
 
+  //! phi window pairing (default), false for the loop over all inner x outer cluster pairs
+  void EnableFastPairing(const bool enable);
+
  private:
   int createNodes(PHCompositeNode *topNode);
 
@@ -379,3 +379,11 @@ void InttZVertexFinder::EnableEventDisplay(const bool enableEvtDisp)
     m_inttzvtx->EnableEventDisplay(enableEvtDisp);
   }
 }
+
+void InttZVertexFinder::EnableFastPairing(const bool enable)
+{
+  if (m_inttzvtx != nullptr)
+  {
+    m_inttzvtx->EnableFastPairing(enable);
+  }
+}
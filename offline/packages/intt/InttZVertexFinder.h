@@ -36,6 +36,9 @@ class InttZVertexFinder : public SubsysReco
   void EnableQA(const bool enableQA);
   void EnableEventDisplay(const bool enableEvtDisp);
 
+  //! cluster phi computed once and z histograms accumulated in arrays (default), false for the original path
+  void EnableFastPairing(const bool enable);
+
  private:
   int createNodes(PHCompositeNode *topNode);
 
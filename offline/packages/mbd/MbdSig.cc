@@ -1,6 +1,8 @@
 #include "MbdSig.h"
 #include "MbdCalib.h"
 
+#include <calobase/CaloWaveformKernels.h>
+
 #include <phool/phool.h>
 
 #include <TF1.h>
@@ -21,6 +23,7 @@
 #include <iostream>
 #include <iomanip>
 #include <limits>
+#include <map>
 
 MbdSig::MbdSig(const int chnum, const int nsamp)
   : _ch{chnum}
@@ -514,6 +517,65 @@ Double_t MbdSig::GetSplineAmpl()
   return f_ampl;
 }
 
+Double_t MbdSig::GetFastAmpl()
+{
+  PeakFind(this, 1, false);
+  return f_ampl;
+}
+
+Double_t MbdSig::GetNyquistAmpl()
+{
+  PeakFind(this, 1, true);
+  return f_ampl;
+}
+
+void MbdSig::PeakFind(MbdSig *sigs, const std::size_t nsigs, const bool nyquist)
+{
+  // subtracted pulses as a float matrix, one row per channel
+  std::size_t stride = 0;
+  for (std::size_t isig = 0; isig < nsigs; isig++)
+  {
+    if (sigs[isig].gSubPulse != nullptr)
+    {
+      stride = std::max<std::size_t>(stride, sigs[isig].gSubPulse->GetN());
+    }
+  }
+
+  // the kernels process channels with the same number of samples together
+  std::vector<float> samples(nsigs * stride);
+  std::map<int, std::vector<unsigned int>> channels;
+  for (std::size_t isig = 0; isig < nsigs; isig++)
+  {
+    const TGraphErrors *g = sigs[isig].gSubPulse;
+    if (g == nullptr || g->GetN() < 3)
+    {
+      continue;
+    }
+    std::copy(g->GetY(), g->GetY() + g->GetN(), samples.begin() + isig * stride);
+    channels[g->GetN()].push_back(isig);
+  }
+
+  std::vector<int> peak_sample(nsigs);
+  std::vector<float> time(nsigs);
+  std::vector<float> ampl(nsigs);
+  for (const auto &[n, list] : channels)
+  {
+    if (nyquist)
+    {
+      CaloWaveformKernels::nyquist_peak(samples.data(), stride, n, list.data(), list.size(), time.data(), ampl.data());
+    }
+    else
+    {
+      CaloWaveformKernels::fast_peak(samples.data(), stride, n, list.data(), list.size(), peak_sample.data(), time.data(), ampl.data());
+    }
+    for (const auto isig : list)
+    {
+      sigs[isig].f_ampl = ampl[isig];
+      sigs[isig].f_time = sigs[isig].gSubPulse->GetX()[0] + time[isig];
+    }
+  }
+}
+
 void MbdSig::WriteChi2Hist()
 {
   h_chi2ndf->Write();
@@ -5,6 +5,7 @@
 
 #include <Rtypes.h>
 
+#include <cstddef>
 #include <fstream>
 #include <limits>
 #include <vector>
@@ -98,6 +99,18 @@ class MbdSig
   /** Get pulse amplitude with spline fit */
   Double_t GetSplineAmpl();
 
+  /** Get pulse amplitude and time (in sample number) from the cubic spline through the
+   *  maximum sample and its neighbours, as in the fast calorimeter waveform processing */
+  Double_t GetFastAmpl();
+
+  /** Get pulse amplitude and time (in sample number) from the maximum of the sinc interpolation */
+  Double_t GetNyquistAmpl();
+
+  /** GetFastAmpl and GetNyquistAmpl of all channels at once, several channels are processed
+   *  together by the vector kernels (CaloWaveformKernels) */
+  static void CalcFastAmpl(std::vector<MbdSig> &sigs) { PeakFind(sigs.data(), sigs.size(), false); }
+  static void CalcNyquistAmpl(std::vector<MbdSig> &sigs) { PeakFind(sigs.data(), sigs.size(), true); }
+
   /** Simple integral to get total charge, etc */
   Double_t Integral(const Double_t xmin, const Double_t xmax);
 
@@ -138,6 +151,9 @@ class MbdSig
  private:
   void Init();
 
+  /** fill f_ampl and f_time from the peak of the subtracted pulse of nsigs channels */
+  static void PeakFind(MbdSig *sigs, const std::size_t nsigs, const bool nyquist);
+
   int _ch;
   int _nsamples;
   int _status{0};
@@ -18,6 +18,7 @@
 #include <trackbase/TrkrClusterv4.h>
 #include <trackbase/TrkrClusterv5.h>
 #include <trackbase/TrkrDefs.h>  // for hitkey, getLayer
+#include <trackbase/TrkrGridClustering.h>
 #include <trackbase/TrkrHitSet.h>
 #include <trackbase/TrkrHitSetContainer.h>
 #include <trackbase/TrkrHitv2.h>
@@ -211,6 +212,8 @@ int MvtxClusterizer::InitRun(PHCompositeNode *topNode)
               << std::endl;
     std::cout << " Z-dimension Clustering = " << std::boolalpha << m_makeZClustering
               << std::noboolalpha << std::endl;
+    std::cout << " Graph Clustering = " << std::boolalpha << m_graphClustering
+              << std::noboolalpha << std::endl;
     std::cout << "=================================================================="
                  "========="
               << std::endl;
@@ -353,28 +356,43 @@ void MvtxClusterizer::ClusterMvtx(PHCompositeNode *topNode)
     }
 
     // do the clustering
-    using Graph = boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS>;
-    Graph G;
-
-    // loop over hits in this chip
-    for (unsigned int i = 0; i < hitvec.size(); i++)
+    std::vector<int> component;
+    if (m_graphClustering)
     {
-      for (unsigned int j = 0; j < hitvec.size(); j++)
+      using Graph = boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS>;
+      Graph G;
+
+      // loop over hits in this chip
+      for (unsigned int i = 0; i < hitvec.size(); i++)
       {
-        if (are_adjacent(hitvec[i], hitvec[j]))
+        for (unsigned int j = 0; j < hitvec.size(); j++)
         {
-          add_edge(i, j, G);
+          if (are_adjacent(hitvec[i], hitvec[j]))
+          {
+            add_edge(i, j, G);
+          }
         }
       }
-    }
 
-    // Find the connections between the vertices of the graph (vertices are the
-    // rawhits,
-    // connections are made when they are adjacent to one another)
-    std::vector<int> component(num_vertices(G));
+      // Find the connections between the vertices of the graph (vertices are the
+      // rawhits,
+      // connections are made when they are adjacent to one another)
+      component.resize(num_vertices(G));
 
-    // this is the actual clustering, performed by boost
-    boost::connected_components(G, component.data());
+      // this is the actual clustering, performed by boost
+      boost::connected_components(G, component.data());
+    }
+    else
+    {
+      // column by column scan, same clusters as the graph in linear time
+      std::vector<TrkrGridClustering::Cell> cells;
+      cells.reserve(hitvec.size());
+      for (const auto &hit : hitvec)
+      {
+        cells.push_back({MvtxDefs::getCol(hit.first), MvtxDefs::getRow(hit.first)});
+      }
+      TrkrGridClustering::find_clusters(cells, GetZClustering() ? 1 : 0, 1, component);
+    }
 
     // Loop over the components(hits) compiling a list of the
     // unique connected groups (ie. clusters).
@@ -655,28 +673,43 @@ void MvtxClusterizer::ClusterMvtxRaw(PHCompositeNode *topNode)
     }
 
     // do the clustering
-    using Graph = boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS>;
-    Graph G;
-
-    // loop over hits in this chip
-    for (unsigned int i = 0; i < hitvec.size(); i++)
+    std::vector<int> component;
+    if (m_graphClustering)
     {
-      for (unsigned int j = 0; j < hitvec.size(); j++)
+      using Graph = boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS>;
+      Graph G;
+
+      // loop over hits in this chip
+      for (unsigned int i = 0; i < hitvec.size(); i++)
       {
-        if (are_adjacent(hitvec[i], hitvec[j]))
+        for (unsigned int j = 0; j < hitvec.size(); j++)
         {
-          add_edge(i, j, G);
+          if (are_adjacent(hitvec[i], hitvec[j]))
+          {
+            add_edge(i, j, G);
+          }
         }
       }
-    }
 
-    // Find the connections between the vertices of the graph (vertices are the
-    // rawhits,
-    // connections are made when they are adjacent to one another)
-    std::vector<int> component(num_vertices(G));
+      // Find the connections between the vertices of the graph (vertices are the
+      // rawhits,
+      // connections are made when they are adjacent to one another)
+      component.resize(num_vertices(G));
 
-    // this is the actual clustering, performed by boost
-    boost::connected_components(G, component.data());
+      // this is the actual clustering, performed by boost
+      boost::connected_components(G, component.data());
+    }
+    else
+    {
+      // column by column scan, same clusters as the graph in linear time
+      std::vector<TrkrGridClustering::Cell> cells;
+      cells.reserve(hitvec.size());
+      for (auto *hit : hitvec)
+      {
+        cells.push_back({hit->getPhiBin(), hit->getTBin()});
+      }
+      TrkrGridClustering::find_clusters(cells, GetZClustering() ? 1 : 0, 1, component);
+    }
 
     // Loop over the components(hits) compiling a list of the
     // unique connected groups (ie. clusters).
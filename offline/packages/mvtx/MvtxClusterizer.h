@@ -57,6 +57,16 @@ class MvtxClusterizer : public SubsysReco
     return m_makeZClustering;
   }
 
+  //! use the boost graph of all adjacent hit pairs for clustering, rather than the linear time column scan. Both give identical clusters
+  void SetGraphClustering(const bool graph_clustering)
+  {
+    m_graphClustering = graph_clustering;
+  }
+  bool GetGraphClustering() const
+  {
+    return m_graphClustering;
+  }
+
   void set_do_hit_association(bool do_assoc) { do_hit_assoc = do_assoc; }
   void set_read_raw(bool read_raw) { do_read_raw = read_raw; }
   void set_ClusHitsVerbose(bool set = true) { record_ClusHitsVerbose = set; };
@@ -81,6 +91,7 @@ class MvtxClusterizer : public SubsysReco
 
   // settings
   bool m_makeZClustering {true};  // z_clustering_option
+  bool m_graphClustering {false};
   bool do_hit_assoc {true};
   bool do_read_raw {false};
 };
@@ -103,7 +103,8 @@ std::vector<std::pair<TrkrDefs::cluskey, Acts::Vector3>> TpcClusterMover::proces
     }
   }
 
-  auto surfMaps = _tGeometry->maps();
+  // reference, the surface maps are large
+  const auto& surfMaps = _tGeometry->maps();
 
   std::vector<std::pair<TrkrDefs::cluskey, Acts::Vector3>> global_moved;
 
@@ -230,7 +231,7 @@ std::vector<std::pair<TrkrDefs::cluskey, Acts::Vector3>> TpcClusterMover::proces
 
 bool TpcClusterMover::get_moved_position(TrkrDefs::cluskey cluskey, TrkrCluster* cluster, std::vector<float>& fitpars, Acts::Vector3& global, Acts::Vector3& global_new, TrkrDefs::subsurfkey& new_subsurfkey) const
 {
-  auto surfMaps = _tGeometry->maps();
+  const auto& surfMaps = _tGeometry->maps();
   auto surface = surfMaps.getSurface(cluskey, cluster);
   if (!surface)
   {
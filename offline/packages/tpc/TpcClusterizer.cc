@@ -28,6 +28,8 @@
 #include <trackbase/RawHitSetContainer.h>
 
 #include <fun4all/Fun4AllReturnCodes.h>
+#include <fun4all/Fun4AllServer.h>
+#include <fun4all/Fun4AllTaskScheduler.h>
 #include <fun4all/SubsysReco.h>  // for SubsysReco
 
 #include <g4detectors/PHG4TpcGeom.h>
@@ -64,8 +66,8 @@
 #include <utility>  // for pair
 #include <vector>
 #include <unordered_set>
-// Terra incognita....
-#include <pthread.h>
+#include <chrono>
+#include <cstddef>
 
 namespace
 {
@@ -170,9 +172,10 @@ namespace
     bool fillClusHitsVerbose = false;
     vec_dVerbose phivec_ClusHitsVerbose;  // only fill if fillClusHitsVerbose
     vec_dVerbose zvec_ClusHitsVerbose;    // only fill if fillClusHitsVerbose
-  };
 
-  pthread_mutex_t mythreadlock;
+    // wall time spent processing this hitset (ms)
+    double time_ms = 0;
+  };
 
   void remove_hit(double adc, int phibin, int tbin, int edge, std::multimap<unsigned short, ihit> &all_hit_map, std::vector<std::vector<unsigned short>> &adcval)
   {
@@ -1381,14 +1384,12 @@ namespace
                 << std::endl;
     }
     */
-    // pthread_exit(nullptr);
   }
 
-  void *ProcessSector(void *threadarg)
+  // index in per-sector timing array
+  constexpr std::size_t sector_index(int side, unsigned int sector)
   {
-    auto *my_data = static_cast<thread_data *>(threadarg);
-    ProcessSectorData(my_data);
-    pthread_exit(nullptr);
+    return side * 12 + sector;
   }
 }  // namespace
 
@@ -1685,28 +1686,10 @@ int TpcClusterizer::process_event(PHCompositeNode *topNode)
       rawhitsetrange = m_rawhits->getHitSets(TrkrDefs::TrkrId::tpcId);
       num_hitsets = std::distance(rawhitsetrange.first, rawhitsetrange.second);
     }
-  // create structure to store given thread and associated data
-  struct thread_pair_t
-  {
-    pthread_t thread{};
-    thread_data data;
-  };
-
-  // create vector of thread pairs and reserve the right size upfront to avoid reallocation
-  std::vector<thread_pair_t> threads;
-  threads.reserve(num_hitsets);
-
-  pthread_attr_t attr;
-  pthread_attr_init(&attr);
-  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-
-  if (pthread_mutex_init(&mythreadlock, nullptr) != 0)
-  {
-    std::cout << std::endl
-              << " mutex init failed" << std::endl;
-    return 1;
-  }
-//  int count = 0;
+  // one thread_data per hitset. Each holds its own cluster, association and training hits buffers
+  // which are filled independently by the workers and merged here, in hitset order, once all are done
+  std::vector<thread_data> sector_data(num_hitsets);
+  std::size_t ihitset = 0;
 
   if (!do_read_raw)
   {
@@ -1714,47 +1697,45 @@ int TpcClusterizer::process_event(PHCompositeNode *topNode)
          hitsetitr != hitsetrange.second;
          ++hitsetitr)
     {
-      // if(count>0)continue;
       TrkrHitSet *hitset = hitsetitr->second;
       unsigned int layer = TrkrDefs::getLayer(hitsetitr->first);
       int side = TpcDefs::getSide(hitsetitr->first);
       unsigned int sector = TpcDefs::getSectorId(hitsetitr->first);
       PHG4TpcGeom *layergeom = geom_container->GetLayerCellGeom(layer);
 
-      // instanciate new thread pair, at the end of thread vector
-      thread_pair_t &thread_pair = threads.emplace_back();
+      thread_data &data = sector_data[ihitset++];
       if (mClusHitsVerbose)
       {
-        thread_pair.data.fillClusHitsVerbose = true;
+        data.fillClusHitsVerbose = true;
       };
 
-      thread_pair.data.layergeom = layergeom;
-      thread_pair.data.hitset = hitset;
-      thread_pair.data.rawhitset = nullptr;
-      thread_pair.data.layer = layer;
-      thread_pair.data.pedestal = pedestal;
-      thread_pair.data.seed_threshold = seed_threshold;
-      thread_pair.data.edge_threshold = edge_threshold;
-      thread_pair.data.sector = sector;
-      thread_pair.data.side = side;
-      thread_pair.data.do_assoc = do_hit_assoc;
-      thread_pair.data.do_wedge_emulation = do_wedge_emulation;
-      thread_pair.data.do_singles = do_singles;
-      thread_pair.data.tGeometry = m_tGeometry;
-      thread_pair.data.maxHalfSizeT = MaxClusterHalfSizeT;
-      thread_pair.data.maxHalfSizePhi = MaxClusterHalfSizePhi;
-      thread_pair.data.verbosity = Verbosity();
-      thread_pair.data.do_split = do_split;
-      thread_pair.data.FixedWindow = do_fixed_window;
-      thread_pair.data.min_err_squared = min_err_squared;
-      thread_pair.data.min_clus_size = min_clus_size;
-      thread_pair.data.min_adc_sum = min_adc_sum;
+      data.layergeom = layergeom;
+      data.hitset = hitset;
+      data.rawhitset = nullptr;
+      data.layer = layer;
+      data.pedestal = pedestal;
+      data.seed_threshold = seed_threshold;
+      data.edge_threshold = edge_threshold;
+      data.sector = sector;
+      data.side = side;
+      data.do_assoc = do_hit_assoc;
+      data.do_wedge_emulation = do_wedge_emulation;
+      data.do_singles = do_singles;
+      data.tGeometry = m_tGeometry;
+      data.maxHalfSizeT = MaxClusterHalfSizeT;
+      data.maxHalfSizePhi = MaxClusterHalfSizePhi;
+      data.verbosity = Verbosity();
+      data.do_split = do_split;
+      data.FixedWindow = do_fixed_window;
+      data.min_err_squared = min_err_squared;
+      data.min_clus_size = min_clus_size;
+      data.min_adc_sum = min_adc_sum;
 
       // --- pass dead/hot map info ---
-      thread_pair.data.deadMap  = &m_deadChannelMap;
-      thread_pair.data.hotMap   = &m_hotChannelMap;
-      thread_pair.data.maskDead = m_maskDeadChannels;
-      thread_pair.data.maskHot  = m_maskHotChannels;
+      data.deadMap  = &m_deadChannelMap;
+      data.hotMap   = &m_hotChannelMap;
+      data.maskDead = m_maskDeadChannels;
+      data.maskHot  = m_maskHotChannels;
 
       unsigned short NPhiBins = (unsigned short) layergeom->get_phibins();
       unsigned short NPhiBinsSector = NPhiBins / 12;
@@ -1774,73 +1755,17 @@ int TpcClusterizer::process_event(PHCompositeNode *topNode)
 
       m_tdriftmax = layergeom->get_max_driftlength() / m_tGeometry->get_drift_velocity(); 
       //  std::cout << "     m_tdriftmax " << m_tdriftmax << " drift velocity reco " << m_tGeometry->get_drift_velocity() << std::endl;
-      thread_pair.data.m_tdriftmax = m_tdriftmax;
-
-      thread_pair.data.phibins = NPhiBinsSector;
-      thread_pair.data.phioffset = PhiOffset;
-      thread_pair.data.tbins = NTBinsSide;
-      thread_pair.data.toffset = TOffset;
-      thread_pair.data.debug = m_debug;
-      thread_pair.data.radius = layergeom->get_radius();
-      thread_pair.data.drift_velocity = m_tGeometry->get_drift_velocity();
-      thread_pair.data.pads_per_sector = 0;
-      thread_pair.data.phistep = 0;
-      int rc;
-      rc = pthread_create(&thread_pair.thread, &attr, ProcessSector, (void *) &thread_pair.data);
-
-      if (rc)
-      {
-        std::cout << "Error:unable to create thread," << rc << std::endl;
-      }
-      if (do_sequential)
-      {
-        int rc2 = pthread_join(thread_pair.thread, nullptr);
-        if (rc2)
-        {
-          std::cout << "Error:unable to join," << rc2 << std::endl;
-        }
-
-        // get the hitsetkey from thread data
-        const auto &data(thread_pair.data);
-        const auto hitsetkey = TpcDefs::genHitSetKey(data.layer, data.sector, data.side);
-
-        // copy clusters to map
-        for (uint32_t index = 0; index < data.cluster_vector.size(); ++index)
-        {
-          // generate cluster key
-          const auto ckey = TrkrDefs::genClusKey(hitsetkey, index);
-
-          // get cluster
-          auto *cluster = data.cluster_vector[index];
-
-          // insert in map
-          m_clusterlist->addClusterSpecifyKey(ckey, cluster);
-
-          if (mClusHitsVerbose)
-          {
-            for (const auto &hit : data.phivec_ClusHitsVerbose[index])
-            {
-              mClusHitsVerbose->addPhiHit(hit.first, hit.second);
-            }
-            for (const auto &hit : data.zvec_ClusHitsVerbose[index])
-            {
-              mClusHitsVerbose->addZHit(hit.first, hit.second);
-            }
-            mClusHitsVerbose->push_hits(ckey);
-          }
-        }
-
-        // copy hit associations to map
-        for (const auto &[index, hkey] : thread_pair.data.association_vector)
-        {
-          // generate cluster key
-          const auto ckey = TrkrDefs::genClusKey(hitsetkey, index);
-
-          // add to association table
-          m_clusterhitassoc->addAssoc(ckey, hkey);
-        }
-      }
-//      count++;
+      data.m_tdriftmax = m_tdriftmax;
+
+      data.phibins = NPhiBinsSector;
+      data.phioffset = PhiOffset;
+      data.tbins = NTBinsSide;
+      data.toffset = TOffset;
+      data.debug = m_debug;
+      data.radius = layergeom->get_radius();
+      data.drift_velocity = m_tGeometry->get_drift_velocity();
+      data.pads_per_sector = 0;
+      data.phistep = 0;
     }
   }
   else
@@ -1849,39 +1774,34 @@ int TpcClusterizer::process_event(PHCompositeNode *topNode)
          hitsetitr != rawhitsetrange.second;
          ++hitsetitr)
     {
-      //	if(count>0)continue;
-      //    const auto hitsetid = hitsetitr->first;
-      //	std::cout << " starting thread # " << count << std::endl;
-
       RawHitSet *hitset = hitsetitr->second;
       unsigned int layer = TrkrDefs::getLayer(hitsetitr->first);
       int side = TpcDefs::getSide(hitsetitr->first);
       unsigned int sector = TpcDefs::getSectorId(hitsetitr->first);
       PHG4TpcGeom *layergeom = geom_container->GetLayerCellGeom(layer);
 
-      // instanciate new thread pair, at the end of thread vector
-      thread_pair_t &thread_pair = threads.emplace_back();
-
-      thread_pair.data.layergeom = layergeom;
-      thread_pair.data.hitset = nullptr;
-      thread_pair.data.rawhitset = hitset;
-      thread_pair.data.layer = layer;
-      thread_pair.data.pedestal = pedestal;
-      thread_pair.data.sector = sector;
-      thread_pair.data.side = side;
-      thread_pair.data.debug = m_debug;
-      thread_pair.data.do_assoc = do_hit_assoc;
-      thread_pair.data.do_wedge_emulation = do_wedge_emulation;
-      thread_pair.data.tGeometry = m_tGeometry;
-      thread_pair.data.maxHalfSizeT = MaxClusterHalfSizeT;
-      thread_pair.data.maxHalfSizePhi = MaxClusterHalfSizePhi;
-      thread_pair.data.verbosity = Verbosity();
+      thread_data &data = sector_data[ihitset++];
+
+      data.layergeom = layergeom;
+      data.hitset = nullptr;
+      data.rawhitset = hitset;
+      data.layer = layer;
+      data.pedestal = pedestal;
+      data.sector = sector;
+      data.side = side;
+      data.debug = m_debug;
+      data.do_assoc = do_hit_assoc;
+      data.do_wedge_emulation = do_wedge_emulation;
+      data.tGeometry = m_tGeometry;
+      data.maxHalfSizeT = MaxClusterHalfSizeT;
+      data.maxHalfSizePhi = MaxClusterHalfSizePhi;
+      data.verbosity = Verbosity();
 
       // --- pass dead/hot map info ---
-      thread_pair.data.deadMap  = &m_deadChannelMap;
-      thread_pair.data.hotMap   = &m_hotChannelMap;
-      thread_pair.data.maskDead = m_maskDeadChannels;
-      thread_pair.data.maskHot  = m_maskHotChannels;
+      data.deadMap  = &m_deadChannelMap;
+      data.hotMap   = &m_hotChannelMap;
+      data.maskDead = m_maskDeadChannels;
+      data.maskHot  = m_maskHotChannels;
 
       unsigned short NPhiBins = (unsigned short) layergeom->get_phibins();
       unsigned short NPhiBinsSector = NPhiBins / 12;
@@ -1893,148 +1813,93 @@ int TpcClusterizer::process_event(PHCompositeNode *topNode)
 
       m_tdriftmax = layergeom->get_max_driftlength() / m_tGeometry->get_drift_velocity(); 
       //      std::cout << "     m_tdriftmax " << m_tdriftmax << " drift velocity reco " << m_tGeometry->get_drift_velocity() << std::endl;
-      thread_pair.data.m_tdriftmax = m_tdriftmax;
-
-      thread_pair.data.phibins = NPhiBinsSector;
-      thread_pair.data.phioffset = PhiOffset;
-      thread_pair.data.tbins = NTBinsSide;
-      thread_pair.data.toffset = TOffset;
-      
-      /*
-      PHG4TpcGeom *testlayergeom = geom_container->GetLayerCellGeom(32);
-      for( double iphi = 1408; iphi < 1408+ 128;iphi+=0.1){
-        double clusiphi = iphi;
-        double clusphi = testlayergeom->get_phi(clusiphi);
-        double radius = layergeom->get_radius();
-        double clusx = radius * cos(clusphi);
-        double clusy = radius * sin(clusphi);
-        double clusz  = -37.524;
-
-        TrkrDefs::hitsetkey tpcHitSetKey = TpcDefs::genHitSetKey( 32,11, 0 );
-        Acts::Vector3 global(clusx, clusy, clusz);
-        TrkrDefs::subsurfkey subsurfkey = 0;
-
-        Surface surface = m_tGeometry->get_tpc_surface_from_coords(
-                                                                   tpcHitSetKey,
-                                                                   global,
-                                                                   subsurfkey);
-        std::cout << " iphi: " << iphi << " clusphi: " << clusphi << " surfkey " << subsurfkey << std::endl;
-        //	std::cout << "surfkey" << subsurfkey << std::endl;
-      }
-      continue;
-      */
-      int rc = 0;
-      //      if(layer==32)
-      rc = pthread_create(&thread_pair.thread, &attr, ProcessSector, (void *) &thread_pair.data);
-      //      else
-      // continue;
-
-      if (rc)
-      {
-        std::cout << "Error:unable to create thread," << rc << std::endl;
-      }
-
-      if (do_sequential)
-      {
-        int rc2 = pthread_join(thread_pair.thread, nullptr);
-        if (rc2)
-        {
-          std::cout << "Error:unable to join," << rc2 << std::endl;
-        }
-
-        // get the hitsetkey from thread data
-        const auto &data(thread_pair.data);
-        const auto hitsetkey = TpcDefs::genHitSetKey(data.layer, data.sector, data.side);
-
-        // copy clusters to map
-        for (uint32_t index = 0; index < data.cluster_vector.size(); ++index)
-        {
-          // generate cluster key
-          const auto ckey = TrkrDefs::genClusKey(hitsetkey, index);
-
-          // get cluster
-          auto *cluster = data.cluster_vector[index];
+      data.m_tdriftmax = m_tdriftmax;
 
-          // insert in map
-          m_clusterlist->addClusterSpecifyKey(ckey, cluster);
-        }
+      data.phibins = NPhiBinsSector;
+      data.phioffset = PhiOffset;
+      data.tbins = NTBinsSide;
+      data.toffset = TOffset;
+    }
+  }
 
-        // copy hit associations to map
-        for (const auto &[index, hkey] : thread_pair.data.association_vector)
-        {
-          // generate cluster key
-          const auto ckey = TrkrDefs::genClusKey(hitsetkey, index);
+  // process all hitsets
+  auto process_sector = [&sector_data](std::size_t index)
+  {
+    auto &data = sector_data[index];
+    const auto start = std::chrono::steady_clock::now();
+    ProcessSectorData(&data);
+    data.time_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  };
 
-          // add to association table
-          m_clusterhitassoc->addAssoc(ckey, hkey);
-        }
-      }
-//      count++;
+  if (do_sequential)
+  {
+    for (std::size_t index = 0; index < sector_data.size(); ++index)
+    {
+      process_sector(index);
     }
   }
+  else
+  {
+    // one task per hitset, spread over the threads of the job wide scheduler
+    Fun4AllServer::instance()->TaskScheduler()->parallel_for(0, sector_data.size(), process_sector, 1);
+  }
 
-  pthread_attr_destroy(&attr);
-//  count = 0;
-  // wait for completion of all threads
-  if (!do_sequential)
+  // merge worker outputs into the node tree
+  for (const auto &data : sector_data)
   {
-    for (const auto &thread_pair : threads)
-    {
-      int rc2 = pthread_join(thread_pair.thread, nullptr);
-      if (rc2)
-      {
-        std::cout << "Error:unable to join," << rc2 << std::endl;
-      }
+    // get the hitsetkey from thread data
+    const auto hitsetkey = TpcDefs::genHitSetKey(data.layer, data.sector, data.side);
 
-      // get the hitsetkey from thread data
-      const auto &data(thread_pair.data);
-      const auto hitsetkey = TpcDefs::genHitSetKey(data.layer, data.sector, data.side);
+    // update per-sector timing
+    auto &timing = m_sector_timing[sector_index(data.side, data.sector)];
+    timing.time_ms += data.time_ms;
+    timing.max_time_ms = std::max(timing.max_time_ms, data.time_ms);
+    ++timing.nhitsets;
 
-      // copy clusters to map
-      for (uint32_t index = 0; index < data.cluster_vector.size(); ++index)
-      {
-        // generate cluster key
-        const auto ckey = TrkrDefs::genClusKey(hitsetkey, index);
+    // copy clusters to map
+    for (uint32_t index = 0; index < data.cluster_vector.size(); ++index)
+    {
+      // generate cluster key
+      const auto ckey = TrkrDefs::genClusKey(hitsetkey, index);
 
-        // get cluster
-        auto *cluster = data.cluster_vector[index];
+      // get cluster
+      auto *cluster = data.cluster_vector[index];
 
-        // insert in map
-        // std::cout << "X: " << cluster->getLocalX() << "Y: " << cluster->getLocalY() << std::endl;
-        m_clusterlist->addClusterSpecifyKey(ckey, cluster);
+      // insert in map
+      // std::cout << "X: " << cluster->getLocalX() << "Y: " << cluster->getLocalY() << std::endl;
+      m_clusterlist->addClusterSpecifyKey(ckey, cluster);
 
-        if (mClusHitsVerbose)
+      if (mClusHitsVerbose)
+      {
+        for (const auto &hit : data.phivec_ClusHitsVerbose[index])
         {
-          for (const auto &hit : data.phivec_ClusHitsVerbose[index])
-          {
-            mClusHitsVerbose->addPhiHit(hit.first, (double) hit.second);
-          }
-          for (const auto &hit : data.zvec_ClusHitsVerbose[index])
-          {
-            mClusHitsVerbose->addZHit(hit.first, (double) hit.second);
-          }
-          mClusHitsVerbose->push_hits(ckey);
+          mClusHitsVerbose->addPhiHit(hit.first, (double) hit.second);
         }
+        for (const auto &hit : data.zvec_ClusHitsVerbose[index])
+        {
+          mClusHitsVerbose->addZHit(hit.first, (double) hit.second);
+        }
+        mClusHitsVerbose->push_hits(ckey);
       }
+    }
 
-      // copy hit associations to map
-      for (const auto &[index, hkey] : thread_pair.data.association_vector)
-      {
-        // generate cluster key
-        const auto ckey = TrkrDefs::genClusKey(hitsetkey, index);
+    // copy hit associations to map
+    for (const auto &[index, hkey] : data.association_vector)
+    {
+      // generate cluster key
+      const auto ckey = TrkrDefs::genClusKey(hitsetkey, index);
 
-        // add to association table
-        m_clusterhitassoc->addAssoc(ckey, hkey);
-      }
+      // add to association table
+      m_clusterhitassoc->addAssoc(ckey, hkey);
+    }
 
-      for (auto *v_hit : thread_pair.data.v_hits)
+    for (auto *v_hit : data.v_hits)
+    {
+      if (_store_hits)
       {
-        if (_store_hits)
-        {
-          m_training->v_hits.emplace_back(*v_hit);
-        }
-        delete v_hit;
+        m_training->v_hits.emplace_back(*v_hit);
       }
+      delete v_hit;
     }
   }
 
@@ -2066,6 +1931,39 @@ int TpcClusterizer::process_event(PHCompositeNode *topNode)
 
 int TpcClusterizer::End(PHCompositeNode * /*topNode*/)
 {
+  if (Verbosity() > 0)
+  {
+    // per sector timing, summed over layers and events, to monitor load imbalance between sectors
+    double total_time = 0;
+    double max_time = 0;
+    for (const auto &timing : m_sector_timing)
+    {
+      total_time += timing.time_ms;
+      max_time = std::max(max_time, timing.time_ms);
+    }
+
+    std::cout << "TpcClusterizer::End - per sector timing" << std::endl;
+    for (int side = 0; side < 2; ++side)
+    {
+      for (unsigned int sector = 0; sector < 12; ++sector)
+      {
+        const auto &timing = m_sector_timing[sector_index(side, sector)];
+        std::cout << "  side " << side
+                  << " sector " << sector
+                  << " hitsets: " << timing.nhitsets
+                  << " total: " << timing.time_ms << " ms"
+                  << " max per hitset: " << timing.max_time_ms << " ms"
+                  << std::endl;
+      }
+    }
+
+    const double mean_time = total_time / m_sector_timing.size();
+    if (mean_time > 0)
+    {
+      std::cout << "  max/mean sector time: " << max_time / mean_time << std::endl;
+    }
+  }
+
   return Fun4AllReturnCodes::EVENT_OK;
 }
 
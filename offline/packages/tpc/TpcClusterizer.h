@@ -6,6 +6,7 @@
 #include <trackbase/TrkrCluster.h>
 #include <trackbase/TrkrDefs.h>
 
+#include <array>
 #include <map>
 #include <string>
 #include <unordered_set>
@@ -143,6 +144,15 @@ public:
   bool m_debug{false};
   std::string m_deadChannelMapName; 
   std::string m_hotChannelMapName;
+
+  //! processing time accumulated per side and sector
+  struct SectorTiming
+  {
+    double time_ms = 0;
+    double max_time_ms = 0;
+    unsigned long nhitsets = 0;
+  };
+  std::array<SectorTiming, 24> m_sector_timing{};
 };
 
 #endif
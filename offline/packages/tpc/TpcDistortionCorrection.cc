@@ -6,10 +6,12 @@
 
 #include "TpcDistortionCorrection.h"
 #include "TpcDistortionCorrectionContainer.h"
+#include "TpcDistortionCorrectionGrid.h"
 
 #include <TH1.h>
 #include <cmath>
 
+#include <array>
 #include <iostream>
 
 namespace
@@ -42,26 +44,66 @@ namespace
     return check_boundaries(h->GetXaxis(), r) && check_boundaries(h->GetYaxis(), phi);
   }
 
-}  // namespace
+  // corrections from packed grid values, with the same units and z dependence as when interpolating the histograms
+  inline void grid_corrections(unsigned int valid, const double* values, double r, double z, const TpcDistortionCorrectionContainer* dcc, double* corrections)
+  {
+    // if the phi correction hist units are cm, we must divide by r to get the dPhi in radians
+    const double divisor = dcc->m_phi_hist_in_radians ? 1.0 : r;
+    const double zterm = (dcc->m_dimensions == 2 && dcc->m_interpolate_z) ? (1. - std::abs(z) / 102.605) : 1.0;
+    corrections[0] = 0;
+    corrections[1] = 0;
+    corrections[2] = 0;
+    if (dcc->m_dimensions == 3)
+    {
+      if (valid & TpcDistortionCorrection::COORD_PHI)
+      {
+        corrections[0] = values[0] / divisor;
+      }
+      if (valid & TpcDistortionCorrection::COORD_R)
+      {
+        corrections[1] = values[1];
+      }
+      if (valid & TpcDistortionCorrection::COORD_Z)
+      {
+        corrections[2] = values[2];
+      }
+    }
+    else
+    {
+      if (valid & TpcDistortionCorrection::COORD_PHI)
+      {
+        corrections[0] = values[0] * zterm / divisor;
+      }
+      if (valid & TpcDistortionCorrection::COORD_R)
+      {
+        corrections[1] = values[1] * zterm;
+      }
+      if (valid & TpcDistortionCorrection::COORD_Z)
+      {
+        corrections[2] = values[2] * zterm;
+      }
+    }
+  }
 
-//________________________________________________________
-Acts::Vector3 TpcDistortionCorrection::get_corrected_position(const Acts::Vector3& source, const TpcDistortionCorrectionContainer* dcc, unsigned int mask) const
-{
-  // get cluster radius, phi and z
-  const auto r = std::sqrt(square(source.x()) + square(source.y()));
-  auto phi = std::atan2(source.y(), source.x());
-  if (phi < 0)
+  // apply corrections to a position given in cylindrical coordinates
+  inline Acts::Vector3 corrected_position(double phi, double r, double z, const double* corrections)
   {
-    phi += 2 * M_PI;
+    const auto phi_new = phi - corrections[0];
+    const auto r_new = r - corrections[1];
+    const auto z_new = z - corrections[2];
+
+    const auto x_new = r_new * std::cos(phi_new);
+    const auto y_new = r_new * std::sin(phi_new);
+
+    return {x_new, y_new, z_new};
   }
 
-  const auto z = source.z();
-  const int index = z > 0 ? 1 : 0;
+}  // namespace
 
-  // apply corrections
-  auto phi_new = phi;
-  auto r_new = r;
-  auto z_new = z;
+//________________________________________________________
+void TpcDistortionCorrection::get_corrections(double phi, double r, double z, const TpcDistortionCorrectionContainer* dcc, unsigned int mask, double* corrections) const
+{
+  const int index = z > 0 ? 1 : 0;
 
   // if the phi correction hist units are cm, we must divide by r to get the dPhi in radians
   auto divisor = r;
@@ -73,17 +115,23 @@ Acts::Vector3 TpcDistortionCorrection::get_corrected_position(const Acts::Vector
   }
 
   //set our default corrections to be zero:
-  //first inherit the same type
-  auto dphi=phi;
-  auto dr=r;
-  auto dz=z;
-  //then set them to zero:
+  auto& dphi = corrections[0];
+  auto& dr = corrections[1];
+  auto& dz = corrections[2];
   dphi=0;
   dr=0;
   dz=0;
-  
+
+  // get the corrections from the packed grid, if any. It gives the same values as the histograms
+  if (const auto* grid = dcc->grid(index))
+  {
+    double values[3];
+    const auto valid = grid->interpolate(phi, r, z, mask, values);
+    grid_corrections(valid, values, r, z, dcc, corrections);
+  }
+
   //get the corrections from the histograms
-  if (dcc->m_dimensions == 3)
+  else if (dcc->m_dimensions == 3)
   {
     if (dcc->m_hDPint[index] && (mask & COORD_PHI) && check_boundaries(dcc->m_hDPint[index], phi, r, z))
     {
@@ -127,14 +175,103 @@ if(dcc->m_use_scalefactor)
     dr *= dcc->m_scalefactor;
     dz *= dcc->m_scalefactor;
   }
+}
 
-  phi_new=phi-dphi;
-  r_new=r-dr;
-  z_new=z-dz;
+//________________________________________________________
+Acts::Vector3 TpcDistortionCorrection::get_corrected_position(const Acts::Vector3& source, const TpcDistortionCorrectionContainer* dcc, unsigned int mask) const
+{
+  // get cluster radius, phi and z
+  const auto r = std::sqrt(square(source.x()) + square(source.y()));
+  auto phi = std::atan2(source.y(), source.x());
+  if (phi < 0)
+  {
+    phi += 2 * M_PI;
+  }
+
+  const auto z = source.z();
+
+  // get corrections
+  double corrections[3];
+  get_corrections(phi, r, z, dcc, mask, corrections);
+
+  // apply corrections
+  return corrected_position(phi, r, z, corrections);
+}
+
+//________________________________________________________
+void TpcDistortionCorrection::get_corrected_positions(std::vector<Acts::Vector3>& positions, const TpcDistortionCorrectionContainer* dcc, unsigned int mask) const
+{
+  const std::array<const TpcDistortionCorrectionGrid*, 2> grids = {{dcc->grid(0), dcc->grid(1)}};
+  if (!grids[0] && !grids[1])
+  {
+    // no packed grids, corrections are interpolated from the histograms
+    for (auto& position : positions)
+    {
+      position = get_corrected_position(position, dcc, mask);
+    }
+    return;
+  }
 
-  // update cluster
-  const auto x_new = r_new * std::cos(phi_new);
-  const auto y_new = r_new * std::sin(phi_new);
+  // cylindrical coordinates of all positions, grouped by side
+  struct Side
+  {
+    std::vector<std::size_t> index;
+    std::vector<double> phi;
+    std::vector<double> r;
+    std::vector<double> z;
+  };
+  std::array<Side, 2> sides;
+  for (std::size_t k = 0; k < positions.size(); ++k)
+  {
+    const auto& source = positions[k];
+    const auto z = source.z();
+    const int index = z > 0 ? 1 : 0;
+    if (!grids[index])
+    {
+      positions[k] = get_corrected_position(source, dcc, mask);
+      continue;
+    }
+
+    auto phi = std::atan2(source.y(), source.x());
+    if (phi < 0)
+    {
+      phi += 2 * M_PI;
+    }
+
+    auto& side = sides[index];
+    side.index.push_back(k);
+    side.phi.push_back(phi);
+    side.r.push_back(std::sqrt(square(source.x()) + square(source.y())));
+    side.z.push_back(z);
+  }
 
-  return {x_new, y_new, z_new};
+  // interpolate the three corrections of all positions of a side in one pass, then apply them
+  std::vector<double> values;
+  std::vector<unsigned int> valid;
+  for (int index = 0; index < 2; ++index)
+  {
+    const auto& side = sides[index];
+    const auto npositions = side.index.size();
+    if (npositions == 0)
+    {
+      continue;
+    }
+
+    values.resize(3 * npositions);
+    valid.resize(npositions);
+    grids[index]->interpolate(npositions, side.phi.data(), side.r.data(), side.z.data(), mask, values.data(), valid.data());
+
+    for (std::size_t k = 0; k < npositions; ++k)
+    {
+      double corrections[3];
+      grid_corrections(valid[k], &values[3 * k], side.r[k], side.z[k], dcc, corrections);
+      if (dcc->m_use_scalefactor)
+      {
+        corrections[0] *= dcc->m_scalefactor;
+        corrections[1] *= dcc->m_scalefactor;
+        corrections[2] *= dcc->m_scalefactor;
+      }
+      positions[side.index[k]] = corrected_position(side.phi[k], side.r[k], side.z[k], corrections);
+    }
+  }
 }
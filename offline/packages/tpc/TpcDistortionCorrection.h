@@ -9,6 +9,8 @@
 
 #include <Acts/Definitions/Algebra.hpp>
 
+#include <vector>
+
 class TpcDistortionCorrectionContainer;
 
 class TpcDistortionCorrection
@@ -45,6 +47,20 @@ class TpcDistortionCorrection
   Acts::Vector3 get_corrected_position(const Acts::Vector3&, const TpcDistortionCorrectionContainer*,
                                        unsigned int mask = COORD_ALL) const;
 
+  //! correct 3D positions in place, for instance all clusters of a hitset, using given DistortionCorrectionObject
+  /**
+   * gives the same result as calling get_corrected_position on each position.
+   * With packed grids, positions are converted to cylindrical coordinates, then the three
+   * corrections of all positions of a side are interpolated in a single pass.
+   * The container is only read, so this can be called from several threads.
+   */
+  void get_corrected_positions(std::vector<Acts::Vector3>&, const TpcDistortionCorrectionContainer*,
+                               unsigned int mask = COORD_ALL) const;
+
+ private:
+  //! (dphi, dr, dz) corrections at given phi, r, z, from packed grids if built, from histograms otherwise
+  void get_corrections(double phi, double r, double z, const TpcDistortionCorrectionContainer*,
+                       unsigned int mask, double* /*corrections*/) const;
 };
 
 #endif
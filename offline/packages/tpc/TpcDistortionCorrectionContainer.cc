@@ -6,6 +6,7 @@
  */
 
 #include "TpcDistortionCorrectionContainer.h"
+#include "TpcDistortionCorrectionGrid.h"
 
 #include <TFile.h>
 #include <TH1.h>
@@ -14,10 +15,20 @@
 #include <iostream>
 #include <memory>
 
+//_______________________________________________________________
+TpcDistortionCorrectionContainer::TpcDistortionCorrectionContainer() = default;
+
+//_______________________________________________________________
+TpcDistortionCorrectionContainer::~TpcDistortionCorrectionContainer() = default;
+
 //_______________________________________________________________
 void TpcDistortionCorrectionContainer::load_histograms( const std::string& source )
 {
   std::cout << "TpcDistortionCorrectionContainer::load_histograms - reading corrections from " << source << std::endl;
+
+  // grids of the previous histograms are obsolete
+  clear_grids();
+
   auto *distortion_tfile = TFile::Open(source.c_str());
   if (!distortion_tfile)
   {
@@ -59,3 +70,41 @@ void TpcDistortionCorrectionContainer::save_histograms( const std::string& desti
   // close TFile
   outputfile->Close();
 }
+
+//_______________________________________________________________
+void TpcDistortionCorrectionContainer::build_grids()
+{
+  for (int j = 0; j < 2; ++j)
+  {
+    m_grid[j] = TpcDistortionCorrectionGrid::create(m_hDPint[j], m_hDRint[j], m_hDZint[j]);
+    if (m_grid[j] && m_grid[j]->dimension() != m_dimensions)
+    {
+      std::cout << "TpcDistortionCorrectionContainer::build_grids - histogram dimension " << m_grid[j]->dimension() << " does not match " << m_dimensions << ", not packing" << std::endl;
+      m_grid[j].reset();
+    }
+    m_grid_source[j] = {{m_hDPint[j], m_hDRint[j], m_hDZint[j]}};
+  }
+  m_grid_dimensions = m_dimensions;
+}
+
+//_______________________________________________________________
+void TpcDistortionCorrectionContainer::clear_grids()
+{
+  for (auto& grid : m_grid)
+  {
+    grid.reset();
+  }
+  m_grid_source = {};
+}
+
+//_______________________________________________________________
+const TpcDistortionCorrectionGrid* TpcDistortionCorrectionContainer::grid(int side) const
+{
+  // histograms replaced since the grid was built, interpolate from the histograms
+  const auto& source = m_grid_source[side];
+  if (m_dimensions != m_grid_dimensions || source[0] != m_hDPint[side] || source[1] != m_hDRint[side] || source[2] != m_hDZint[side])
+  {
+    return nullptr;
+  }
+  return m_grid[side].get();
+}
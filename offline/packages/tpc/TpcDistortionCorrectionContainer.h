@@ -8,19 +8,34 @@
  */
 
 #include <array>
+#include <memory>
 #include <string>
 
 class TH1;
+class TpcDistortionCorrectionGrid;
 
 class TpcDistortionCorrectionContainer
 {
  public:
   //! constructor
-  TpcDistortionCorrectionContainer() = default;
+  TpcDistortionCorrectionContainer();
+
+  //! destructor
+  ~TpcDistortionCorrectionContainer();
 
   //! load histograms from input file
   void load_histograms( const std::string& /*source*/ );
 
+  //! pack the correction histograms into grids, used by TpcDistortionCorrection in place of TH1::Interpolate
+  /**
+   * Grids are ignored once histograms are replaced or m_dimensions is changed,
+   * until this is called again. It must also be called again if histogram contents are modified in place
+   */
+  void build_grids();
+
+  //! delete packed grids, corrections are interpolated from the histograms
+  void clear_grids();
+
   //! save histograms to out file
   void save_histograms( const std::string& /*destination*/ ) const;
 
@@ -48,6 +63,22 @@ class TpcDistortionCorrectionContainer
    */
   std::array<TH1*, 2> m_hentries = {{nullptr, nullptr}};
   //@}
+
+  //! packed (dphi, dr, dz) corrections for negative (0) or positive (1) z
+  /**
+   * nullptr if not built, or if the histograms or m_dimensions changed since build_grids
+   */
+  const TpcDistortionCorrectionGrid* grid(int side) const;
+
+ private:
+  //! packed (dphi, dr, dz) corrections for negative and positive z, if built
+  std::array<std::unique_ptr<TpcDistortionCorrectionGrid>, 2> m_grid;
+
+  //! (dphi, dr, dz) histograms of each side the grids were built from
+  std::array<std::array<const TH1*, 3>, 2> m_grid_source = {};
+
+  //! dimension the grids were built with
+  int m_grid_dimensions = 0;
 };
 
 #endif
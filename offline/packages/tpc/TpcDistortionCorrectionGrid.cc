@@ -0,0 +1,308 @@
+/*!
+ * \file TpcDistortionCorrectionGrid.cc
+ * \brief distortion corrections of one TPC side packed in a regular grid, for fast interpolation
+ */
+
+#include "TpcDistortionCorrectionGrid.h"
+
+#include <TAxis.h>
+#include <TH1.h>
+
+#include <algorithm>
+#include <iostream>
+
+//_______________________________________________________________
+void TpcDistortionCorrectionGrid::Axis::set(const TAxis* axis)
+{
+  m_nbins = axis->GetNbins();
+  m_min = axis->GetXmin();
+  m_max = axis->GetXmax();
+
+  const auto* edges = axis->GetXbins();
+  if (edges->fN)
+  {
+    m_edges.assign(edges->GetArray(), edges->GetArray() + edges->fN);
+  }
+  else
+  {
+    m_edges.clear();
+  }
+
+  m_center.resize(m_nbins + 2);
+  m_up_edge.resize(m_nbins + 2);
+  m_width.resize(m_nbins + 2);
+  for (int bin = 0; bin < m_nbins + 2; ++bin)
+  {
+    m_center[bin] = axis->GetBinCenter(bin);
+    m_up_edge[bin] = axis->GetBinUpEdge(bin);
+    m_width[bin] = axis->GetBinWidth(bin);
+  }
+}
+
+//_______________________________________________________________
+int TpcDistortionCorrectionGrid::Axis::find_bin(double x) const
+{
+  if (x < m_min)
+  {
+    return 0;
+  }
+
+  if (!(x < m_max))
+  {
+    return m_nbins + 1;
+  }
+
+  if (m_edges.empty())
+  {
+    return 1 + int(m_nbins * (x - m_min) / (m_max - m_min));
+  }
+
+  return std::distance(m_edges.begin(), std::upper_bound(m_edges.begin(), m_edges.end(), x));
+}
+
+//_______________________________________________________________
+bool TpcDistortionCorrectionGrid::Axis::operator==(const Axis& other) const
+{
+  return m_nbins == other.m_nbins && m_min == other.m_min && m_max == other.m_max && m_edges == other.m_edges;
+}
+
+//_______________________________________________________________
+std::unique_ptr<TpcDistortionCorrectionGrid> TpcDistortionCorrectionGrid::create(const TH1* hdphi, const TH1* hdr, const TH1* hdz)
+{
+  const std::array<const TH1*, 3> histograms = {{hdphi, hdr, hdz}};
+
+  std::unique_ptr<TpcDistortionCorrectionGrid> grid(new TpcDistortionCorrectionGrid);
+  bool first = true;
+  for (int i = 0; i < 3; ++i)
+  {
+    const auto* h = histograms[i];
+    if (!h)
+    {
+      continue;
+    }
+
+    grid->m_valid[i] = true;
+    std::array<Axis, 3> axis;
+    axis[0].set(h->GetXaxis());
+    axis[1].set(h->GetYaxis());
+    axis[2].set(h->GetZaxis());
+
+    if (first)
+    {
+      grid->m_dimension = h->GetDimension();
+      grid->m_axis = axis;
+      first = false;
+      continue;
+    }
+
+    if (h->GetDimension() != grid->m_dimension || !(axis[0] == grid->m_axis[0]) || !(axis[1] == grid->m_axis[1]) || !(axis[2] == grid->m_axis[2]))
+    {
+      std::cout << "TpcDistortionCorrectionGrid::create - histograms " << histograms[0]->GetName() << " and " << h->GetName() << " have different binning, not packing" << std::endl;
+      return nullptr;
+    }
+  }
+
+  if (first || (grid->m_dimension != 2 && grid->m_dimension != 3))
+  {
+    return nullptr;
+  }
+
+  const int nx = grid->m_axis[0].m_nbins + 2;
+  const int ny = grid->m_axis[1].m_nbins + 2;
+  const int nz = grid->m_axis[2].m_nbins + 2;
+  grid->m_values.assign(3 * static_cast<std::size_t>(nx) * ny * nz, 0);
+  for (int i = 0; i < 3; ++i)
+  {
+    const auto* h = histograms[i];
+    if (!h)
+    {
+      continue;
+    }
+
+    for (int ix = 0; ix < nx; ++ix)
+    {
+      for (int iy = 0; iy < ny; ++iy)
+      {
+        for (int iz = 0; iz < nz; ++iz)
+        {
+          grid->m_values[grid->offset(ix, iy, iz) + i] = (grid->m_dimension == 3) ? h->GetBinContent(ix, iy, iz) : h->GetBinContent(ix, iy);
+        }
+      }
+    }
+  }
+
+  return grid;
+}
+
+//_______________________________________________________________
+unsigned int TpcDistortionCorrectionGrid::enabled(unsigned int mask) const
+{
+  unsigned int components = 0;
+  for (int i = 0; i < 3; ++i)
+  {
+    if (m_valid[i] && (mask & (1U << i)))
+    {
+      components |= (1U << i);
+    }
+  }
+  return components;
+}
+
+//_______________________________________________________________
+bool TpcDistortionCorrectionGrid::interpolate_point(double phi, double r, double z, double* values) const
+{
+  // for the interpolation to work, the value must be within the range of the provided axis, and not into the first and last bin
+  const int binphi = m_axis[0].find_bin(phi);
+  const int binr = m_axis[1].find_bin(r);
+  if (!(m_axis[0].inside(binphi) && m_axis[1].inside(binr)))
+  {
+    return false;
+  }
+
+  if (m_dimension == 3)
+  {
+    const int binz = m_axis[2].find_bin(z);
+    if (!m_axis[2].inside(binz))
+    {
+      return false;
+    }
+    interpolate3d(phi, r, z, binphi, binr, binz, values);
+  }
+  else
+  {
+    interpolate2d(phi, r, binphi, binr, values);
+  }
+  return true;
+}
+
+//_______________________________________________________________
+unsigned int TpcDistortionCorrectionGrid::interpolate(double phi, double r, double z, unsigned int mask, double* correction) const
+{
+  correction[0] = 0;
+  correction[1] = 0;
+  correction[2] = 0;
+
+  const unsigned int components = enabled(mask);
+  double values[3];
+  if (!components || !interpolate_point(phi, r, z, values))
+  {
+    return 0;
+  }
+
+  for (int i = 0; i < 3; ++i)
+  {
+    if (components & (1U << i))
+    {
+      correction[i] = values[i];
+    }
+  }
+  return components;
+}
+
+//_______________________________________________________________
+void TpcDistortionCorrectionGrid::interpolate(std::size_t n, const double* phi, const double* r, const double* z, unsigned int mask, double* corrections, unsigned int* valid) const
+{
+  std::fill(corrections, corrections + 3 * n, 0.);
+  const unsigned int components = enabled(mask);
+  if (!components)
+  {
+    std::fill(valid, valid + n, 0U);
+    return;
+  }
+
+  for (std::size_t k = 0; k < n; ++k)
+  {
+    double values[3];
+    if (!interpolate_point(phi[k], r[k], z[k], values))
+    {
+      valid[k] = 0;
+      continue;
+    }
+
+    valid[k] = components;
+    for (int i = 0; i < 3; ++i)
+    {
+      if (components & (1U << i))
+      {
+        corrections[3 * k + i] = values[i];
+      }
+    }
+  }
+}
+
+//_______________________________________________________________
+void TpcDistortionCorrectionGrid::interpolate3d(double x, double y, double z, int binx, int biny, int binz, double* result) const
+{
+  const auto& xaxis = m_axis[0];
+  const auto& yaxis = m_axis[1];
+  const auto& zaxis = m_axis[2];
+
+  // lower and upper bins, bin boundaries guarantee that both are valid
+  const int ubx = (x < xaxis.m_center[binx]) ? binx - 1 : binx;
+  const int uby = (y < yaxis.m_center[biny]) ? biny - 1 : biny;
+  const int ubz = (z < zaxis.m_center[binz]) ? binz - 1 : binz;
+  const int obx = ubx + 1;
+  const int oby = uby + 1;
+  const int obz = ubz + 1;
+
+  const double xw = xaxis.m_center[obx] - xaxis.m_center[ubx];
+  const double yw = yaxis.m_center[oby] - yaxis.m_center[uby];
+  const double zw = zaxis.m_center[obz] - zaxis.m_center[ubz];
+
+  const double xd = (x - xaxis.m_center[ubx]) / xw;
+  const double yd = (y - yaxis.m_center[uby]) / yw;
+  const double zd = (z - zaxis.m_center[ubz]) / zw;
+
+  const double* v[] = {
+      &m_values[offset(ubx, uby, ubz)], &m_values[offset(ubx, uby, obz)],
+      &m_values[offset(ubx, oby, ubz)], &m_values[offset(ubx, oby, obz)],
+      &m_values[offset(obx, uby, ubz)], &m_values[offset(obx, uby, obz)],
+      &m_values[offset(obx, oby, ubz)], &m_values[offset(obx, oby, obz)]};
+
+  // same operations as TH3::Interpolate, for each component
+  for (int i = 0; i < 3; ++i)
+  {
+    const double i1 = v[0][i] * (1 - zd) + v[1][i] * zd;
+    const double i2 = v[2][i] * (1 - zd) + v[3][i] * zd;
+    const double j1 = v[4][i] * (1 - zd) + v[5][i] * zd;
+    const double j2 = v[6][i] * (1 - zd) + v[7][i] * zd;
+
+    const double w1 = i1 * (1 - yd) + i2 * yd;
+    const double w2 = j1 * (1 - yd) + j2 * yd;
+
+    result[i] = w1 * (1 - xd) + w2 * xd;
+  }
+}
+
+//_______________________________________________________________
+void TpcDistortionCorrectionGrid::interpolate2d(double x, double y, int binx, int biny, double* result) const
+{
+  const auto& xaxis = m_axis[0];
+  const auto& yaxis = m_axis[1];
+
+  // which quadrant of the bin the point is in
+  const bool left = (xaxis.m_up_edge[binx] - x) > xaxis.m_width[binx] / 2;
+  const bool low = (yaxis.m_up_edge[biny] - y) > yaxis.m_width[biny] / 2;
+
+  const double x1 = xaxis.m_center[left ? binx - 1 : binx];
+  const double x2 = xaxis.m_center[left ? binx : binx + 1];
+  const double y1 = yaxis.m_center[low ? biny - 1 : biny];
+  const double y2 = yaxis.m_center[low ? biny : biny + 1];
+
+  const int binx1 = std::max(xaxis.find_bin(x1), 1);
+  const int binx2 = std::min(xaxis.find_bin(x2), xaxis.m_nbins);
+  const int biny1 = std::max(yaxis.find_bin(y1), 1);
+  const int biny2 = std::min(yaxis.find_bin(y2), yaxis.m_nbins);
+
+  const double* q11 = &m_values[offset(binx1, biny1, 0)];
+  const double* q12 = &m_values[offset(binx1, biny2, 0)];
+  const double* q21 = &m_values[offset(binx2, biny1, 0)];
+  const double* q22 = &m_values[offset(binx2, biny2, 0)];
+
+  // same operations as TH2::Interpolate, for each component
+  const double d = 1.0 * (x2 - x1) * (y2 - y1);
+  for (int i = 0; i < 3; ++i)
+  {
+    result[i] = 1.0 * q11[i] / d * (x2 - x) * (y2 - y) + 1.0 * q21[i] / d * (x - x1) * (y2 - y) + 1.0 * q12[i] / d * (x2 - x) * (y - y1) + 1.0 * q22[i] / d * (x - x1) * (y - y1);
+  }
+}
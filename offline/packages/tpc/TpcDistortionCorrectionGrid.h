@@ -0,0 +1,125 @@
+#ifndef TPC_TPCDISTORTIONCORRECTIONGRID_H
+#define TPC_TPCDISTORTIONCORRECTIONGRID_H
+
+/*!
+ * \file TpcDistortionCorrectionGrid.h
+ * \brief distortion corrections of one TPC side packed in a regular grid, for fast interpolation
+ */
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+class TAxis;
+class TH1;
+
+/*!
+ * \brief distortion corrections of one TPC side packed in a regular grid
+ *
+ * The (dphi, dr, dz) corrections of each histogram bin are stored next to
+ * each other, so that the three corrections of a point come from one bin
+ * search and one trilinear interpolation, rather than three TH1::Interpolate calls.
+ * Interpolation reproduces TH3::Interpolate (TH2::Interpolate for 2D
+ * corrections) operation by operation, including the boundary checks of
+ * TpcDistortionCorrection. Phi wrapping is handled by the guard bins of the
+ * histograms, which are copied as is.
+ *
+ * The grid is immutable once created, and can be used from several threads.
+ */
+class TpcDistortionCorrectionGrid
+{
+ public:
+  //! create from the phi, r and z correction histograms of one side
+  /**
+   * Missing histograms (nullptr) give zero corrections.
+   * Returns nullptr if the histograms do not have the same binning or dimension,
+   * in which case corrections must be interpolated from the histograms
+   */
+  static std::unique_ptr<TpcDistortionCorrectionGrid> create(const TH1* /*dphi*/, const TH1* /*dr*/, const TH1* /*dz*/);
+
+  //! interpolated (dphi, dr, dz) corrections at (phi, r, z)
+  /**
+   * bit i of mask enables component i, with the same values as TpcDistortionCorrection::CoordMask.
+   * Disabled or missing components, and points outside of the grid, get zero correction.
+   * z is ignored for 2D corrections. Returns the mask of the interpolated components
+   */
+  unsigned int interpolate(double phi, double r, double z, unsigned int mask, double* /*correction*/) const;
+
+  //! interpolated (dphi, dr, dz) corrections of n points, same as calling interpolate on each point
+  /**
+   * corrections receives 3 values per point, valid the mask of interpolated components of each point
+   */
+  void interpolate(std::size_t n, const double* /*phi*/, const double* /*r*/, const double* /*z*/, unsigned int mask,
+                   double* /*corrections*/, unsigned int* /*valid*/) const;
+
+  //! histogram dimension
+  int dimension() const { return m_dimension; }
+
+ private:
+  //! histogram axis, bins are numbered as in TAxis, 1 to nbins
+  class Axis
+  {
+   public:
+    //! copy binning from TAxis
+    void set(const TAxis*);
+
+    //! same as TAxis::FindFixBin
+    int find_bin(double) const;
+
+    //! true if the bin is neither in the first nor in the last bin, as required for interpolation
+    bool inside(int bin) const
+    {
+      return bin >= 2 && bin < m_nbins;
+    }
+
+    //! true if binning is identical
+    bool operator==(const Axis&) const;
+
+    int m_nbins = 0;
+    double m_min = 0;
+    double m_max = 0;
+
+    //! bin edges, for variable binning only
+    std::vector<double> m_edges;
+
+    //!@name per bin quantities, from 0 (underflow) to nbins+1 (overflow)
+    //@{
+    std::vector<double> m_center;
+    std::vector<double> m_up_edge;
+    std::vector<double> m_width;
+    //@}
+  };
+
+  //! offset of the corrections of bin (ix, iy, iz) in the value array
+  std::size_t offset(int ix, int iy, int iz) const
+  {
+    return 3 * ((static_cast<std::size_t>(ix) * (m_axis[1].m_nbins + 2) + iy) * (m_axis[2].m_nbins + 2) + iz);
+  }
+
+  //! components of mask which have a histogram
+  unsigned int enabled(unsigned int mask) const;
+
+  //! all three corrections at one point, false if outside of the grid
+  bool interpolate_point(double phi, double r, double z, double* /*values*/) const;
+
+  //! same as TH3::Interpolate
+  void interpolate3d(double phi, double r, double z, int binphi, int binr, int binz, double* /*correction*/) const;
+
+  //! same as TH2::Interpolate
+  void interpolate2d(double phi, double r, int binphi, int binr, double* /*correction*/) const;
+
+  //! histogram dimension, 2 or 3
+  int m_dimension = 3;
+
+  //! phi, r and z axes. z has a single bin for 2D corrections
+  std::array<Axis, 3> m_axis;
+
+  //! true for components with a histogram
+  std::array<bool, 3> m_valid = {{false, false, false}};
+
+  //! (dphi, dr, dz) for all bins including under and overflow, z bin fastest
+  std::vector<double> m_values;
+};
+
+#endif
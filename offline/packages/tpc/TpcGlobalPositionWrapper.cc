@@ -72,6 +72,31 @@ Acts::Vector3 TpcGlobalPositionWrapper::applyDistortionCorrections(Acts::Vector3
   return global;
 }
 
+//____________________________________________________________________________________________________________________
+void TpcGlobalPositionWrapper::applyDistortionCorrections(std::vector<Acts::Vector3>& positions) const
+{
+  // apply distortion corrections
+  if (m_enable_module_edge_corr && m_dcc_module_edge)
+  {
+    m_distortionCorrection.get_corrected_positions(positions, m_dcc_module_edge);
+  }
+
+  if (m_enable_static_corr && m_dcc_static)
+  {
+    m_distortionCorrection.get_corrected_positions(positions, m_dcc_static);
+  }
+
+  if (m_enable_average_corr && m_dcc_average)
+  {
+    m_distortionCorrection.get_corrected_positions(positions, m_dcc_average);
+  }
+
+  if (m_enable_fluctuation_corr && m_dcc_fluctuation)
+  {
+    m_distortionCorrection.get_corrected_positions(positions, m_dcc_fluctuation);
+  }
+}
+
 //____________________________________________________________________________________________________________________
 Acts::Vector3 TpcGlobalPositionWrapper::getGlobalPositionDistortionCorrected(const TrkrDefs::cluskey& key, TrkrCluster* cluster, short int crossing ) const
 {
@@ -110,3 +135,61 @@ Acts::Vector3 TpcGlobalPositionWrapper::getGlobalPositionDistortionCorrected(con
 
   return global;
 }
+
+//____________________________________________________________________________________________________________________
+std::vector<Acts::Vector3> TpcGlobalPositionWrapper::getGlobalPositionsDistortionCorrected(const std::vector<std::pair<TrkrDefs::cluskey, TrkrCluster*>>& clusters, short int crossing ) const
+{
+
+  if( !m_tGeometry )
+  {
+    std::cout << "TpcGlobalPositionWrapper::getGlobalPositionsDistortionCorrected - m_tGeometry not set" << std::endl;
+    return std::vector<Acts::Vector3>(clusters.size(), Acts::Vector3(0,0,0));
+  }
+
+  // get global positions from acts, and collect the TPC ones
+  std::vector<Acts::Vector3> positions;
+  positions.reserve(clusters.size());
+  std::vector<std::size_t> tpc_index;
+  for( const auto& [key, cluster]:clusters )
+  {
+    if( TrkrDefs::getTrkrId(key) == TrkrDefs::TrkrId::tpcId )
+    {
+      tpc_index.push_back(positions.size());
+    }
+    positions.push_back(m_tGeometry->getGlobalPosition(key, cluster));
+  }
+
+  if( tpc_index.empty() )
+  {
+    return positions;
+  }
+
+  // verify crossing validity
+  if(crossing == SHRT_MAX)
+  {
+    if(!m_suppressCrossing)
+    {
+      std::cout << "TpcGlobalPositionWrapper::getGlobalPositionsDistortionCorrected - invalid crossing." << std::endl;
+    }
+    return positions;
+  }
+
+  // apply crossing correction
+  std::vector<Acts::Vector3> tpc_positions;
+  tpc_positions.reserve(tpc_index.size());
+  for( const auto& index:tpc_index )
+  {
+    auto global = positions[index];
+    global.z() = TpcClusterZCrossingCorrection::correctZ(global.z(), TpcDefs::getSide(clusters[index].first), crossing);
+    tpc_positions.push_back(global);
+  }
+
+  // apply distortion corrections
+  applyDistortionCorrections(tpc_positions);
+  for( std::size_t i = 0; i < tpc_index.size(); ++i )
+  {
+    positions[tpc_index[i]] = tpc_positions[i];
+  }
+
+  return positions;
+}
@@ -10,6 +10,9 @@
 
 #include <trackbase/TrkrDefs.h>
 
+#include <utility>
+#include <vector>
+
 
 class ActsGeometry;
 class PHCompositeNode;
@@ -51,6 +54,9 @@ class TpcGlobalPositionWrapper
   //! apply all loaded distortion corrections to a given position
   Acts::Vector3 applyDistortionCorrections( Acts::Vector3 /*source*/ ) const;
 
+  //! apply all loaded distortion corrections to positions, in place
+  void applyDistortionCorrections( std::vector<Acts::Vector3>& /*positions*/ ) const;
+
   //! get distortion corrected global position from cluster
   /**
    * first converts cluster position local coordinate to global coordinates
@@ -58,6 +64,13 @@ class TpcGlobalPositionWrapper
    */
   Acts::Vector3 getGlobalPositionDistortionCorrected(const TrkrDefs::cluskey&, TrkrCluster*, short int /*crossing*/ ) const;
 
+  //! get distortion corrected global positions of many clusters from the same crossing
+  /**
+   * same as getGlobalPositionDistortionCorrected, with the distortion corrections
+   * of all TPC clusters applied in one batch
+   */
+  std::vector<Acts::Vector3> getGlobalPositionsDistortionCorrected(const std::vector<std::pair<TrkrDefs::cluskey, TrkrCluster*>>&, short int /*crossing*/ ) const;
+
   private:
 
   //! verbosity
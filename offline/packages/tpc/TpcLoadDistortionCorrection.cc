@@ -102,6 +102,8 @@ int TpcLoadDistortionCorrection::InitRun(PHCompositeNode* topNode)
     distortion_correction_object->m_use_scalefactor = m_use_scalefactor[i];
     distortion_correction_object->m_scalefactor = m_scalefactor[i];
 
+    // pack histograms for fast, thread safe interpolation
+    distortion_correction_object->build_grids();
 
     if (Verbosity())
     {
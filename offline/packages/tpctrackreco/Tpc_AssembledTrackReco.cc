@@ -11,6 +11,8 @@
 #include "Tpc_ModuleTrackContainer.h"
 
 #include <fun4all/Fun4AllReturnCodes.h>
+#include <fun4all/Fun4AllServer.h>
+#include <fun4all/Fun4AllTaskScheduler.h>
 
 #include <phool/PHCompositeNode.h>
 #include <phool/PHIODataNode.h>
@@ -31,11 +33,11 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <format>
 #include <functional>
 #include <iostream>
 #include <limits>
-#include <thread>
 #include <utility>
 #include <vector>
 
@@ -1410,21 +1412,13 @@ int Tpc_AssembledTrackReco::process_event(PHCompositeNode* /*unused*/)
     }
   }
 
+  // one task per side and sector, run on the job wide task scheduler
   std::vector<std::vector<Candidate> > sector_outputs(24);
-  std::vector<std::thread> workers;
-  workers.reserve(24);
-  for (int side = 0; side < 2; ++side)
-  {
-    for (unsigned int sector = 0; sector < 12; ++sector)
-    {
-      const unsigned int index = static_cast<unsigned int>(side) * 12 + sector;
-      workers.emplace_back(&Tpc_AssembledTrackReco::connect_sector_pieces, this, std::cref(pieces), side, sector, std::ref(sector_outputs[index]));
-    }
-  }
-  for (std::thread& worker : workers)
-  {
-    worker.join();
-  }
+  Fun4AllServer::instance()->TaskScheduler()->parallel_for(0, sector_outputs.size(), [this, &pieces, &sector_outputs](std::size_t index)
+                                                           {
+                                                             const int side = index / 12;
+                                                             const unsigned int sector = index % 12;
+                                                             connect_sector_pieces(pieces, side, sector, sector_outputs[index]); }, 1);
 
   std::vector<Candidate> sector_tracks;
   for (auto& sector_output : sector_outputs)
@@ -2,6 +2,8 @@
 #include "Tpc_FittingTools.h"
 
 #include <fun4all/Fun4AllReturnCodes.h>
+#include <fun4all/Fun4AllServer.h>
+#include <fun4all/Fun4AllTaskScheduler.h>
 
 #include <phool/PHCompositeNode.h>
 #include <phool/PHIODataNode.h>
@@ -23,10 +25,9 @@
 #include <trackbase/TrkrHitSet.h>
 #include <trackbase/TrkrHitSetContainer.h>
 
-#include <pthread.h>
-
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <deque>
 #include <iostream>
@@ -796,12 +797,11 @@ namespace
     }
   }
 
-  void* ProcessModule(void* arg)
+  void ProcessModule(InModuleThreadData* d)
   {
-    InModuleThreadData* d = static_cast<InModuleThreadData*>(arg);
     if (!d)
     {
-      return nullptr;
+      return;
     }
 
     collect_raw_hits(d);
@@ -818,8 +818,6 @@ namespace
                 << " blobs=" << d->blobs.size()
                 << " tracks=" << d->tracks.size() << std::endl;
     }
-
-    return nullptr;
   }
 
 }  // anonymous namespace
@@ -904,7 +902,6 @@ Tpc_ModuleTrackReco::Tpc_ModuleTrackReco(const std::string& name,
   , m_hits(nullptr)
   , m_tpcModuleTrackContainer(nullptr)
   , m_event(0)
-  , m_maxThreads(72)
   , m_pedestal(0.0)
   , m_noiseMaxConsecutiveTimebins(10)
   , m_noiseKeepFirstTimebins(3)
@@ -935,7 +932,9 @@ Tpc_ModuleTrackReco::~Tpc_ModuleTrackReco()
 
 void Tpc_ModuleTrackReco::setMaxThreads(unsigned int n)
 {
-  m_maxThreads = (n == 0) ? 1 : n;
+  n = std::max(1U, n);
+  std::cout << Name() << "::setMaxThreads - deprecated, use Fun4AllServer::SetNumThreads. Setting the number of threads of the job to " << n << std::endl;
+  Fun4AllServer::instance()->SetNumThreads(n);
 }
 
 int Tpc_ModuleTrackReco::Init(PHCompositeNode* /*unused*/)
@@ -1145,44 +1144,9 @@ int Tpc_ModuleTrackReco::process_event(PHCompositeNode* /*unused*/)
   std::cout << Name() << "::process_event - event " << m_event
             << " has " << tdata.size() << " non-empty modules" << std::endl;
 
-  const unsigned int maxLive = std::max(1U,
-                                        std::min(m_maxThreads, static_cast<unsigned int>(tdata.size())));
-
-  for (unsigned int start = 0; start < static_cast<unsigned int>(tdata.size()); start += maxLive)
-  {
-    const unsigned int end = std::min(start + maxLive,
-                                      static_cast<unsigned int>(tdata.size()));
-    const unsigned int nLive = end - start;
-
-    std::vector<pthread_t> threads(nLive);
-    std::vector<int> thread_ok(nLive, 0);
-
-    for (unsigned int i = 0; i < nLive; ++i)
-    {
-      const unsigned int idx = start + i;
-      const int rc = pthread_create(&threads[i], nullptr, ProcessModule,
-                                    static_cast<void*>(&tdata[idx]));
-      if (rc != 0)
-      {
-        std::cerr << Name() << "::process_event - pthread_create failed for"
-                  << " region=" << tdata[idx].region
-                  << " sector=" << tdata[idx].sector
-                  << " side=" << tdata[idx].side << std::endl;
-      }
-      else
-      {
-        thread_ok[i] = 1;
-      }
-    }
-
-    for (unsigned int i = 0; i < nLive; ++i)
-    {
-      if (thread_ok[i])
-      {
-        pthread_join(threads[i], nullptr);
-      }
-    }
-  }
+  // one task per module, run on the job wide task scheduler
+  Fun4AllServer::instance()->TaskScheduler()->parallel_for(0, tdata.size(), [&tdata](std::size_t idx)
+                                                           { ProcessModule(&tdata[idx]); }, 1);
 
   // Harvest results from all modules
   for (const auto& td : tdata)
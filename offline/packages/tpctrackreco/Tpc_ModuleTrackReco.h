@@ -148,6 +148,7 @@ class Tpc_ModuleTrackReco : public SubsysReco
   int process_event(PHCompositeNode*);
   int End(PHCompositeNode*);
 
+  //! obsolete, sets the number of threads of the job with Fun4AllServer::SetNumThreads
   void setMaxThreads(unsigned int n);
 
   void setPedestal(double p)
@@ -213,7 +214,6 @@ class Tpc_ModuleTrackReco : public SubsysReco
 
   Tpc_ModuleTrackContainer* m_tpcModuleTrackContainer;
   int m_event;
-  unsigned int m_maxThreads;
 
   // General configuration
   double m_pedestal;
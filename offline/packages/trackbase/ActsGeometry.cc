@@ -2,6 +2,7 @@
 #include "TpcDefs.h"
 #include "TrkrCluster.h"
 #include "alignmentTransformationContainer.h"
+#include "sPHENIXActsDetectorElement.h"
 
 #include <phool/sphenix_constants.h>
 
@@ -209,13 +210,26 @@ Surface ActsGeometry::get_tpc_surface_from_coords(
       
       Acts::Vector3 local = this_surf->localToGlobalTransform(m_tGeometry.getGeoContext()).inverse() * (cluster);
       // transform local to unaligned geometry (simulation) global
-      bool align_flag = alignmentTransformationContainer::use_alignment;
-      alignmentTransformationContainer::use_alignment = false;
-      Acts::Vector3 cluster_noalign = this_surf->localToGlobalTransform(m_tGeometry.getGeoContext()) * (local);   
-      auto surf_center_noalign = this_surf->center(m_tGeometry.getGeoContext());
-      if(align_flag)
+      // The construction transform of the detector element is used when available, rather than switching off
+      // the alignment globally, so that track fits running in other threads are not affected
+      Acts::Vector3 cluster_noalign;
+      Acts::Vector3 surf_center_noalign;
+      if (const auto* element = dynamic_cast<const sPHENIXActsDetectorElement*>(this_surf->surfacePlacement()))
 	{
-	  alignmentTransformationContainer::use_alignment = true;
+	  const auto& nominal = element->nominalLocalToGlobalTransform();
+	  cluster_noalign = nominal * local;
+	  surf_center_noalign = nominal.translation();
+	}
+      else
+	{
+	  bool align_flag = alignmentTransformationContainer::use_alignment;
+	  alignmentTransformationContainer::use_alignment = false;
+	  cluster_noalign = this_surf->localToGlobalTransform(m_tGeometry.getGeoContext()) * (local);
+	  surf_center_noalign = this_surf->center(m_tGeometry.getGeoContext());
+	  if(align_flag)
+	    {
+	      alignmentTransformationContainer::use_alignment = true;
+	    }
 	}
       
       // transform simulation geometry global to envelope coords
@@ -0,0 +1,146 @@
+/**
+ * @file trackbase/TrkrClusterContainerBenchmark.cc
+ * @brief compare fill, lookup and reset times of TrkrClusterContainerv4 and TrkrClusterContainerv5
+ *
+ * usage: TrkrClusterContainerBenchmark [nevents] [clusters per TPC hitset]
+ * The default corresponds to a central Au+Au event, about 170k TPC clusters
+ */
+#include "TpcDefs.h"
+#include "TrkrClusterContainer.h"
+#include "TrkrClusterContainerv4.h"
+#include "TrkrClusterContainerv5.h"
+#include "TrkrClusterv5.h"
+#include "TrkrDefs.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+  using clock_type = std::chrono::high_resolution_clock;
+
+  struct Timing
+  {
+    double fill = 0;
+    double lookup = 0;
+    double iterate = 0;
+    double reset = 0;
+  };
+
+  double elapsed_ms(const clock_type::time_point& start)
+  {
+    return std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+  }
+
+  // process a number of events, filling clusters hitset by hitset as clusterizers do
+  Timing run(TrkrClusterContainer* container, const int nevents, const unsigned int nclusters)
+  {
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<float> local(-10, 10);
+
+    Timing timing;
+    std::vector<TrkrDefs::cluskey> keys;
+    for (int ievent = 0; ievent < nevents; ++ievent)
+    {
+      // fill
+      keys.clear();
+      auto start = clock_type::now();
+      for (uint8_t layer = 7; layer < 55; ++layer)
+      {
+        for (uint8_t sector = 0; sector < 12; ++sector)
+        {
+          for (uint8_t side = 0; side < 2; ++side)
+          {
+            const auto hitsetkey = TpcDefs::genHitSetKey(layer, sector, side);
+            for (unsigned int index = 0; index < nclusters; ++index)
+            {
+              auto* cluster = new TrkrClusterv5;
+              cluster->setLocalX(local(rng));
+              cluster->setLocalY(local(rng));
+              cluster->setAdc(index);
+              const auto ckey = TrkrDefs::genClusKey(hitsetkey, index);
+              container->addClusterSpecifyKey(ckey, cluster);
+              keys.push_back(ckey);
+            }
+          }
+        }
+      }
+      timing.fill += elapsed_ms(start);
+
+      // random access by cluster key, as done by track fitting
+      std::shuffle(keys.begin(), keys.end(), rng);
+      start = clock_type::now();
+      double sum = 0;
+      for (const auto& ckey : keys)
+      {
+        sum += container->findCluster(ckey)->getLocalX();
+      }
+      timing.lookup += elapsed_ms(start);
+
+      // layer by layer iteration, as done by seeding
+      start = clock_type::now();
+      for (uint8_t layer = 7; layer < 55; ++layer)
+      {
+        for (const auto& hitsetkey : container->getHitSetKeys(TrkrDefs::tpcId, layer))
+        {
+          const auto range = container->getClusters(hitsetkey);
+          for (auto iter = range.first; iter != range.second; ++iter)
+          {
+            sum += iter->second->getLocalY();
+          }
+        }
+      }
+      timing.iterate += elapsed_ms(start);
+
+      // reset
+      start = clock_type::now();
+      container->Reset();
+      timing.reset += elapsed_ms(start);
+
+      // prevent the compiler from optimizing the loops away
+      if (sum == 0)
+      {
+        std::cout << " ";
+      }
+    }
+
+    timing.fill /= nevents;
+    timing.lookup /= nevents;
+    timing.iterate /= nevents;
+    timing.reset /= nevents;
+    return timing;
+  }
+
+  void print(const std::string& name, const Timing& timing)
+  {
+    std::cout << name
+              << " fill: " << timing.fill << " ms"
+              << " lookup: " << timing.lookup << " ms"
+              << " iterate: " << timing.iterate << " ms"
+              << " reset: " << timing.reset << " ms"
+              << std::endl;
+  }
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  const int nevents = (argc > 1) ? std::atoi(argv[1]) : 20;
+  const unsigned int nclusters = (argc > 2) ? std::atoi(argv[2]) : 150;
+
+  std::cout << "TrkrClusterContainerBenchmark - " << nevents << " events, "
+            << nclusters * 48 * 12 * 2 << " clusters per event" << std::endl;
+
+  TrkrClusterContainerv4 v4;
+  TrkrClusterContainerv5 v5;
+
+  // first event warms up the arena, it is included in the average on purpose
+  print("TrkrClusterContainerv4", run(&v4, nevents, nclusters));
+  print("TrkrClusterContainerv5", run(&v5, nevents, nclusters));
+
+  return 0;
+}
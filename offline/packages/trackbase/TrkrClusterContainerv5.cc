@@ -0,0 +1,363 @@
+/**
+ * @file trackbase/TrkrClusterContainerv5.cc
+ * @brief Implementation of TrkrClusterContainerv5
+ */
+#include "TrkrClusterContainerv5.h"
+#include "TrkrCluster.h"
+#include "TrkrClusterv5.h"
+#include "TrkrDefs.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace
+{
+  TrkrClusterContainer::Map dummy_map;
+
+  //! initial number of slots in the arena
+  constexpr int default_size = 20000;
+
+  //! stale hitset blocks are purged when there are more than this number
+  constexpr std::size_t max_stale_blocks = 4096;
+}  // namespace
+
+//_________________________________________________________________
+TrkrClusterContainerv5::TrkrClusterContainerv5()
+  : m_clusters("TrkrClusterv5", default_size)
+{
+}
+
+//_________________________________________________________________
+void TrkrClusterContainerv5::Reset()
+{
+  /*
+   * hitset keys contain strobe and crossing information, so blocks of past events
+   * are not necessarily reused. Purge them once in a while to bound memory
+   */
+  if (m_blocks.size() > m_hitsetkeys.size() + max_stale_blocks)
+  {
+    for (auto iter = m_blocks.begin(); iter != m_blocks.end();)
+    {
+      if (iter->second.generation != m_generation)
+      {
+        iter = m_blocks.erase(iter);
+      }
+      else
+      {
+        ++iter;
+      }
+    }
+  }
+
+  // invalidate all blocks at once
+  ++m_generation;
+  m_lastblock = nullptr;
+  m_nindexed = 0;
+  m_nremoved = 0;
+  m_hitsetkeys.clear();
+  m_hitsetkeys_sorted = true;
+
+  // rewind the arena. Clusters are kept for reuse, no destructor is called
+  m_clusters.Clear();
+  m_keys.clear();
+
+  // also clear temporary map
+  {
+    Map empty;
+    m_tmpmap.swap(empty);
+  }
+}
+
+//_________________________________________________________________
+void TrkrClusterContainerv5::identify(std::ostream& os) const
+{
+  os << "-----TrkrClusterContainerv5-----" << std::endl;
+  os << "Number of clusters: " << size() << std::endl;
+
+  for (const auto& hitsetkey : sortedHitSetKeys())
+  {
+    const unsigned int layer = TrkrDefs::getLayer(hitsetkey);
+    os << "layer: " << layer << " hitsetkey: " << hitsetkey << std::endl;
+
+    for (const auto& slot : findBlock(hitsetkey)->slots)
+    {
+      if (slot)
+      {
+        static_cast<TrkrCluster*>(m_clusters.UncheckedAt(slot - 1))->identify(os);
+      }
+    }
+  }
+
+  os << "------------------------------" << std::endl;
+}
+
+//_________________________________________________________________
+void TrkrClusterContainerv5::updateIndex() const
+{
+  // more slots indexed than stored means the arrays were read again without Reset
+  if (m_nindexed > m_keys.size())
+  {
+    ++m_generation;
+    m_lastblock = nullptr;
+    m_nindexed = 0;
+    m_nremoved = 0;
+    m_hitsetkeys.clear();
+  }
+
+  for (; m_nindexed < m_keys.size(); ++m_nindexed)
+  {
+    indexSlot(m_nindexed);
+  }
+}
+
+//_________________________________________________________________
+void TrkrClusterContainerv5::indexSlot(std::size_t slot) const
+{
+  const TrkrDefs::cluskey key = m_keys[slot];
+  if (key == TrkrDefs::CLUSKEYMAX)
+  {
+    ++m_nremoved;
+    return;
+  }
+
+  auto& slots = getBlock(TrkrDefs::getHitSetKeyFromClusKey(key)).slots;
+  const auto index = TrkrDefs::getClusIndex(key);
+  if (index >= slots.size())
+  {
+    slots.resize(index + 1, 0);
+  }
+  slots[index] = slot + 1;
+}
+
+//_________________________________________________________________
+TrkrClusterContainerv5::Block& TrkrClusterContainerv5::getBlock(TrkrDefs::hitsetkey hitsetkey) const
+{
+  if (m_lastblock && m_lastkey == hitsetkey && m_lastblock->generation == m_generation)
+  {
+    return *m_lastblock;
+  }
+
+  // unordered_map elements are not moved by insertions
+  auto& block = m_blocks[hitsetkey];
+  m_lastkey = hitsetkey;
+  m_lastblock = &block;
+  if (block.generation != m_generation)
+  {
+    // block from a previous event, reuse its memory
+    block.generation = m_generation;
+    block.slots.clear();
+    m_hitsetkeys.push_back(hitsetkey);
+    m_hitsetkeys_sorted = false;
+  }
+  return block;
+}
+
+//_________________________________________________________________
+const TrkrClusterContainerv5::Block* TrkrClusterContainerv5::findBlock(TrkrDefs::hitsetkey hitsetkey) const
+{
+  if (m_lastblock && m_lastkey == hitsetkey)
+  {
+    return (m_lastblock->generation == m_generation) ? m_lastblock : nullptr;
+  }
+
+  const auto iter = m_blocks.find(hitsetkey);
+  if (iter == m_blocks.end())
+  {
+    return nullptr;
+  }
+
+  m_lastkey = hitsetkey;
+  m_lastblock = &iter->second;
+  return (iter->second.generation == m_generation) ? &iter->second : nullptr;
+}
+
+//_________________________________________________________________
+const TrkrClusterContainer::HitSetKeyList& TrkrClusterContainerv5::sortedHitSetKeys() const
+{
+  updateIndex();
+  if (!m_hitsetkeys_sorted)
+  {
+    std::sort(m_hitsetkeys.begin(), m_hitsetkeys.end());
+    m_hitsetkeys_sorted = true;
+  }
+  return m_hitsetkeys;
+}
+
+//_________________________________________________________________
+void TrkrClusterContainerv5::removeCluster(TrkrDefs::cluskey key)
+{
+  updateIndex();
+
+  // find relevant block if any
+  auto iter = m_blocks.find(TrkrDefs::getHitSetKeyFromClusKey(key));
+  if (iter == m_blocks.end() || iter->second.generation != m_generation)
+  {
+    return;
+  }
+
+  auto& slots = iter->second.slots;
+  const auto index = TrkrDefs::getClusIndex(key);
+  if (index < slots.size() && slots[index])
+  {
+    // the slot stays in the arena, flagged as removed
+    m_keys[slots[index] - 1] = TrkrDefs::CLUSKEYMAX;
+    slots[index] = 0;
+    ++m_nremoved;
+  }
+}
+
+//_________________________________________________________________
+void TrkrClusterContainerv5::removeClusters(TrkrDefs::hitsetkey hitsetkey)
+{
+  updateIndex();
+
+  // do nothing if not found
+  auto iter = m_blocks.find(hitsetkey);
+  if (iter == m_blocks.end() || iter->second.generation != m_generation)
+  {
+    return;
+  }
+
+  for (const auto& slot : iter->second.slots)
+  {
+    if (slot)
+    {
+      m_keys[slot - 1] = TrkrDefs::CLUSKEYMAX;
+      ++m_nremoved;
+    }
+  }
+
+  // invalidate block and remove from the hitset list
+  iter->second.generation = 0;
+  iter->second.slots.clear();
+  m_hitsetkeys.erase(std::find(m_hitsetkeys.begin(), m_hitsetkeys.end(), hitsetkey));
+}
+
+//_________________________________________________________________
+void TrkrClusterContainerv5::addClusterSpecifyKey(const TrkrDefs::cluskey key, TrkrCluster* newclus)
+{
+  updateIndex();
+
+  // check for duplicates
+  const Block* block = findBlock(TrkrDefs::getHitSetKeyFromClusKey(key));
+  const auto index = TrkrDefs::getClusIndex(key);
+  if (block && index < block->slots.size() && block->slots[index])
+  {
+    std::cout << "TrkrClusterContainerv5::AddClusterSpecifyKey: duplicate key: " << key << " exiting now" << std::endl;
+    exit(1);
+  }
+
+  // copy into next arena slot. Slots from previous events are reused without construction
+  const std::size_t slot = m_keys.size();
+  auto* cluster = static_cast<TrkrClusterv5*>(m_clusters.ConstructedAt(slot));
+  if (auto* source = dynamic_cast<TrkrClusterv5*>(newclus))
+  {
+    *cluster = *source;
+  }
+  else
+  {
+    cluster->CopyFrom(*newclus);
+  }
+  delete newclus;
+
+  m_keys.push_back(key);
+  updateIndex();
+}
+
+//_________________________________________________________________
+TrkrClusterContainerv5::ConstRange
+TrkrClusterContainerv5::getClusters() const
+{
+  std::cout << "deprecated function in TrkrClusterContainerv5, user getClusters(TrkrDefs:hitsetkey)"
+            << std::endl;
+  return std::make_pair(dummy_map.begin(), dummy_map.begin());
+}
+
+//_________________________________________________________________
+TrkrClusterContainerv5::ConstRange
+TrkrClusterContainerv5::getClusters(TrkrDefs::hitsetkey hitsetkey)
+{
+  updateIndex();
+
+  // clear temporary map
+  {
+    Map empty;
+    m_tmpmap.swap(empty);
+  }
+
+  // copy content in temporary map
+  if (const Block* block = findBlock(hitsetkey))
+  {
+    for (std::size_t index = 0; index < block->slots.size(); ++index)
+    {
+      const auto slot = block->slots[index];
+      if (slot)
+      {
+        const auto ckey = TrkrDefs::genClusKey(hitsetkey, index);
+        m_tmpmap.insert(m_tmpmap.end(), std::make_pair(ckey, static_cast<TrkrCluster*>(m_clusters.UncheckedAt(slot - 1))));
+      }
+    }
+  }
+
+  // return temporary map range
+  return std::make_pair(m_tmpmap.cbegin(), m_tmpmap.cend());
+}
+
+//_________________________________________________________________
+TrkrCluster* TrkrClusterContainerv5::findCluster(TrkrDefs::cluskey key) const
+{
+  updateIndex();
+
+  const Block* block = findBlock(TrkrDefs::getHitSetKeyFromClusKey(key));
+  if (!block)
+  {
+    return nullptr;
+  }
+
+  const auto index = TrkrDefs::getClusIndex(key);
+  if (index >= block->slots.size() || !block->slots[index])
+  {
+    return nullptr;
+  }
+
+  return static_cast<TrkrCluster*>(m_clusters.UncheckedAt(block->slots[index] - 1));
+}
+
+//_________________________________________________________________
+TrkrClusterContainer::HitSetKeyList TrkrClusterContainerv5::getHitSetKeys() const
+{
+  return sortedHitSetKeys();
+}
+
+//_________________________________________________________________
+TrkrClusterContainer::HitSetKeyList TrkrClusterContainerv5::getHitSetKeys(const TrkrDefs::TrkrId trackerid) const
+{
+  /* copy the logic from TrkrHitSetContainerv1::getHitSets */
+  const TrkrDefs::hitsetkey keylo = TrkrDefs::getHitSetKeyLo(trackerid);
+  const TrkrDefs::hitsetkey keyhi = TrkrDefs::getHitSetKeyHi(trackerid);
+
+  const auto& keys = sortedHitSetKeys();
+  return HitSetKeyList(
+      std::lower_bound(keys.begin(), keys.end(), keylo),
+      std::upper_bound(keys.begin(), keys.end(), keyhi));
+}
+
+//_________________________________________________________________
+TrkrClusterContainer::HitSetKeyList TrkrClusterContainerv5::getHitSetKeys(const TrkrDefs::TrkrId trackerid, const uint8_t layer) const
+{
+  /* copy the logic from TrkrHitSetContainerv1::getHitSets */
+  const TrkrDefs::hitsetkey keylo = TrkrDefs::getHitSetKeyLo(trackerid, layer);
+  const TrkrDefs::hitsetkey keyhi = TrkrDefs::getHitSetKeyHi(trackerid, layer);
+
+  const auto& keys = sortedHitSetKeys();
+  return HitSetKeyList(
+      std::lower_bound(keys.begin(), keys.end(), keylo),
+      std::upper_bound(keys.begin(), keys.end(), keyhi));
+}
+
+//_________________________________________________________________
+unsigned int TrkrClusterContainerv5::size() const
+{
+  updateIndex();
+  return m_keys.size() - m_nremoved;
+}
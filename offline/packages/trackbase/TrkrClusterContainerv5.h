@@ -0,0 +1,127 @@
+#ifndef TRACKBASE_TRKRCLUSTERCONTAINERV5_H
+#define TRACKBASE_TRKRCLUSTERCONTAINERV5_H
+
+/**
+ * @file trackbase/TrkrClusterContainerv5.h
+ * @brief Cluster container object with arena storage
+ */
+
+#include "TrkrClusterContainer.h"
+
+#include <phool/PHObject.h>
+
+#include <TClonesArray.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class TrkrCluster;
+
+/**
+ * @brief Cluster container object with arena storage
+ *
+ * Clusters are stored by value as TrkrClusterv5 in a TClonesArray, which
+ * acts as an event arena: clusters added to the container are copied into
+ * the next free slot and the passed cluster is deleted. Slots are neither
+ * destructed nor freed by Reset(), but reused for the next event, and
+ * clusters of a given hitset, usually added in one go, end up contiguous.
+ *
+ * The cluster key of each slot is stored alongside. The cluster key to slot
+ * index is transient, built while filling or after DST readback, and
+ * invalidated by Reset() with a generation counter, so that Reset() does
+ * not depend on the number of clusters or hitsets.
+ */
+class TrkrClusterContainerv5 : public TrkrClusterContainer
+{
+ public:
+  TrkrClusterContainerv5();
+
+  //! rewind the arena, effectively leaving the container empty
+  void Reset() override;
+
+  void identify(std::ostream& os = std::cout) const override;
+
+  //! the cluster is copied into the container and deleted
+  void addClusterSpecifyKey(const TrkrDefs::cluskey, TrkrCluster*) override;
+
+  //! remove cluster matching a given cluster key
+  void removeCluster(TrkrDefs::cluskey) override;
+
+  //! remove all the clusters matching a given key
+  void removeClusters(TrkrDefs::hitsetkey) override;
+
+  ConstRange getClusters() const override;  // deprecated
+
+  ConstRange getClusters(TrkrDefs::hitsetkey) override;
+
+  TrkrCluster* findCluster(TrkrDefs::cluskey) const override;
+
+  HitSetKeyList getHitSetKeys() const override;
+
+  HitSetKeyList getHitSetKeys(const TrkrDefs::TrkrId) const override;
+
+  HitSetKeyList getHitSetKeys(const TrkrDefs::TrkrId, const uint8_t /* layer */) const override;
+
+  unsigned int size(void) const override;
+
+ private:
+  //! slots of the clusters of one hitset, indexed by cluster index
+  struct Block
+  {
+    //! block is only valid if it matches the container generation
+    uint64_t generation = 0;
+
+    //! arena slot + 1 for each cluster index, 0 if there is no such cluster
+    std::vector<uint32_t> slots;
+  };
+
+  //! index clusters added to the arena since last call (new clusters, DST readback)
+  void updateIndex() const;
+
+  //! index one arena slot
+  void indexSlot(std::size_t slot) const;
+
+  //! block for a given hitset, created if needed
+  Block& getBlock(TrkrDefs::hitsetkey) const;
+
+  //! block for a given hitset, nullptr if not found
+  const Block* findBlock(TrkrDefs::hitsetkey) const;
+
+  //! sorted list of hitsets in the current event
+  const HitSetKeyList& sortedHitSetKeys() const;
+
+  //! cluster storage
+  TClonesArray m_clusters;
+
+  //! cluster key of each slot, TrkrDefs::CLUSKEYMAX for removed clusters
+  std::vector<TrkrDefs::cluskey> m_keys;
+
+  //! hitset index
+  mutable std::unordered_map<TrkrDefs::hitsetkey, Block> m_blocks;  //!
+
+  //! current generation. Incremented at each Reset
+  mutable uint64_t m_generation = 1;  //!
+
+  //! number of slots already indexed
+  mutable std::size_t m_nindexed = 0;  //!
+
+  //! number of removed clusters
+  mutable std::size_t m_nremoved = 0;  //!
+
+  //! last accessed block. Clusters are usually added and accessed hitset by hitset
+  mutable TrkrDefs::hitsetkey m_lastkey = TrkrDefs::HITSETKEYMAX;  //!
+  mutable Block* m_lastblock = nullptr;  //!
+
+  //! hitsets in the current event
+  mutable HitSetKeyList m_hitsetkeys;  //!
+  mutable bool m_hitsetkeys_sorted = true;  //!
+
+  //! temporary map, see TrkrClusterContainerv4
+  Map m_tmpmap;  //!
+
+  ClassDefOverride(TrkrClusterContainerv5, 1)
+};
+
+#endif  // TRACKBASE_TRKRCLUSTERCONTAINERV5_H
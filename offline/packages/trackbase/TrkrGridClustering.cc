@@ -0,0 +1,129 @@
+/**
+ * @file trackbase/TrkrGridClustering.cc
+ * @brief connected components of hits on a pixel or strip grid, in linear time
+ */
+#include "TrkrGridClustering.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace
+{
+  /// union-find forest, roots are the smallest index of the set
+  class DisjointSets
+  {
+   public:
+    explicit DisjointSets(std::size_t size)
+      : m_parent(size)
+    {
+      std::iota(m_parent.begin(), m_parent.end(), 0);
+    }
+
+    uint32_t find(uint32_t i)
+    {
+      while (m_parent[i] != i)
+      {
+        // path halving
+        m_parent[i] = m_parent[m_parent[i]];
+        i = m_parent[i];
+      }
+      return i;
+    }
+
+    void merge(uint32_t i, uint32_t j)
+    {
+      i = find(i);
+      j = find(j);
+      if (i < j)
+      {
+        m_parent[j] = i;
+      }
+      else if (j < i)
+      {
+        m_parent[i] = j;
+      }
+    }
+
+   private:
+    std::vector<uint32_t> m_parent;
+  };
+}  // namespace
+
+//_________________________________________________________________
+unsigned int TrkrGridClustering::find_clusters(const std::vector<Cell>& cells, unsigned int du, unsigned int dv, std::vector<int>& component)
+{
+  const std::size_t nhits = cells.size();
+
+  // order hits along u, then v
+  std::vector<uint32_t> order(nhits);
+  std::iota(order.begin(), order.end(), 0);
+  const auto less = [&cells](uint32_t lhs, uint32_t rhs)
+  { return cells[lhs].u < cells[rhs].u || (cells[lhs].u == cells[rhs].u && cells[lhs].v < cells[rhs].v); };
+  if (!std::is_sorted(order.begin(), order.end(), less))
+  {
+    std::sort(order.begin(), order.end(), less);
+  }
+
+  DisjointSets sets(nhits);
+
+  // range of the hits at u-1 in order, and of the hits at u
+  std::size_t previous_begin = 0;
+  std::size_t previous_end = 0;
+  std::size_t current_begin = 0;
+
+  // first hit at u-1 which can be adjacent to the current hit. Increases along the scan
+  std::size_t first = 0;
+
+  for (std::size_t k = 0; k < nhits; ++k)
+  {
+    const auto& cell = cells[order[k]];
+    if (k > 0 && cells[order[k - 1]].u != cell.u)
+    {
+      // new u, hits of the previous u are candidates if adjacent
+      if (du > 0 && cells[order[k - 1]].u + 1 == cell.u)
+      {
+        previous_begin = current_begin;
+        previous_end = k;
+      }
+      else
+      {
+        previous_begin = 0;
+        previous_end = 0;
+      }
+      current_begin = k;
+      first = previous_begin;
+    }
+
+    // same u. Hits are ordered in v so that the hit before is the closest one
+    if (k > current_begin && cell.v - cells[order[k - 1]].v <= dv)
+    {
+      sets.merge(order[k], order[k - 1]);
+    }
+
+    // previous u
+    while (first < previous_end && cells[order[first]].v + dv < cell.v)
+    {
+      ++first;
+    }
+    for (std::size_t j = first; j < previous_end && cells[order[j]].v <= cell.v + dv; ++j)
+    {
+      sets.merge(order[k], order[j]);
+    }
+  }
+
+  // number clusters in order of their first hit
+  component.assign(nhits, -1);
+  std::vector<int> index(nhits, -1);
+  int nclusters = 0;
+  for (uint32_t i = 0; i < nhits; ++i)
+  {
+    auto& cluster = index[sets.find(i)];
+    if (cluster < 0)
+    {
+      cluster = nclusters++;
+    }
+    component[i] = cluster;
+  }
+
+  return nclusters;
+}
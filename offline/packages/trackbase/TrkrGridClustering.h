@@ -0,0 +1,39 @@
+#ifndef TRACKBASE_TRKRGRIDCLUSTERING_H
+#define TRACKBASE_TRKRGRIDCLUSTERING_H
+
+/**
+ * @file trackbase/TrkrGridClustering.h
+ * @brief connected components of hits on a pixel or strip grid, in linear time
+ *
+ * Replaces filling a boost::adjacency_list with all adjacent hit pairs, which is
+ * quadratic in the number of hits, followed by boost::connected_components.
+ * Hits are scanned ordered along u then v, and each hit is merged (union-find)
+ * with the adjacent hits of the same and of the previous u. Hits from a TrkrHitSet
+ * are already ordered by hitkey, other inputs are sorted first.
+ */
+
+#include <cstdint>
+#include <vector>
+
+namespace TrkrGridClustering
+{
+  /// hit position on the grid
+  struct Cell
+  {
+    uint32_t u = 0;
+    uint32_t v = 0;
+  };
+
+  /**
+   * Group hits into clusters. Two hits are adjacent if |u1-u2| <= du and |v1-v2| <= dv,
+   * with du either 0 or 1.
+   * component is filled with the cluster index of each hit. Clusters are numbered in
+   * order of their first hit, as boost::connected_components does for the same graph,
+   * so that the result is identical.
+   * Returns the number of clusters
+   */
+  unsigned int find_clusters(const std::vector<Cell>& /*cells*/, unsigned int du, unsigned int dv, std::vector<int>& /*component*/);
+
+}  // namespace TrkrGridClustering
+
+#endif
@@ -0,0 +1,156 @@
+/**
+ * @file trackbase/TrkrGridClusteringBenchmark.cc
+ * @brief compare boost graph and grid scan clustering of MVTX and INTT hits, on noisy sensors
+ *
+ * usage: TrkrGridClusteringBenchmark [nsensors]
+ * For each occupancy, hits are generated at random on an ALPIDE chip (1024 columns x 512 rows)
+ * with a few hot columns, and on an INTT ladder (5 columns x 256 strips), then clustered
+ * with and without z clustering. Cluster indices of both methods must be identical.
+ */
+#include "TrkrGridClustering.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#include <boost/graph/adjacency_list.hpp>
+#pragma GCC diagnostic pop
+
+#include <boost/graph/connected_components.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+  using clock_type = std::chrono::high_resolution_clock;
+
+  double elapsed_ms(const clock_type::time_point& start)
+  {
+    return std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+  }
+
+  // sensor geometry and occupancy
+  struct Sensor
+  {
+    std::string name;
+    uint32_t ncolumns = 0;
+    uint32_t nrows = 0;
+    double occupancy = 0;
+    uint32_t hot_columns = 0;
+  };
+
+  // random hits, ordered by column then row as in a TrkrHitSet
+  std::vector<TrkrGridClustering::Cell> generate(const Sensor& sensor, std::mt19937& rng)
+  {
+    std::set<std::pair<uint32_t, uint32_t>> hits;
+    std::uniform_real_distribution<double> uniform(0, 1);
+    std::uniform_int_distribution<uint32_t> column(0, sensor.ncolumns - 1);
+    std::set<uint32_t> hot;
+    for (uint32_t i = 0; i < sensor.hot_columns; ++i)
+    {
+      hot.insert(column(rng));
+    }
+
+    for (uint32_t col = 0; col < sensor.ncolumns; ++col)
+    {
+      // hot columns fire half of their pixels
+      const double occupancy = hot.count(col) ? 0.5 : sensor.occupancy;
+      for (uint32_t row = 0; row < sensor.nrows; ++row)
+      {
+        if (uniform(rng) < occupancy)
+        {
+          hits.emplace(col, row);
+        }
+      }
+    }
+
+    std::vector<TrkrGridClustering::Cell> cells;
+    for (const auto& [col, row] : hits)
+    {
+      cells.push_back({col, row});
+    }
+    return cells;
+  }
+
+  // same as the clusterizers: all adjacent pairs in a graph, then connected components
+  std::vector<int> graph_clusters(const std::vector<TrkrGridClustering::Cell>& cells, uint32_t du, uint32_t dv)
+  {
+    using Graph = boost::adjacency_list<boost::vecS, boost::vecS, boost::undirectedS>;
+    Graph G;
+    const auto adjacent = [](uint32_t a, uint32_t b, uint32_t d)
+    { return (a > b) ? a - b <= d : b - a <= d; };
+    for (unsigned int i = 0; i < cells.size(); i++)
+    {
+      for (unsigned int j = i + 1; j < cells.size(); j++)
+      {
+        if (adjacent(cells[i].u, cells[j].u, du) && adjacent(cells[i].v, cells[j].v, dv))
+        {
+          add_edge(i, j, G);
+        }
+      }
+      add_edge(i, i, G);
+    }
+    std::vector<int> component(num_vertices(G));
+    boost::connected_components(G, component.data());
+    return component;
+  }
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  const int nsensors = (argc > 1) ? std::atoi(argv[1]) : 20;
+
+  std::vector<Sensor> sensors;
+  for (const double occupancy : {1e-4, 1e-3, 1e-2, 5e-2})
+  {
+    sensors.push_back({"mvtx", 1024, 512, occupancy, 4});
+    sensors.push_back({"intt", 5, 256, 10 * occupancy, 0});
+  }
+
+  std::mt19937 rng(12345);
+  bool identical = true;
+  for (const auto& sensor : sensors)
+  {
+    for (const uint32_t du : {0U, 1U})
+    {
+      double graph_time = 0;
+      double grid_time = 0;
+      std::size_t nhits = 0;
+      std::size_t nclusters = 0;
+      std::vector<int> component;
+      for (int isensor = 0; isensor < nsensors; ++isensor)
+      {
+        const auto cells = generate(sensor, rng);
+        nhits += cells.size();
+
+        auto start = clock_type::now();
+        const auto reference = graph_clusters(cells, du, 1);
+        graph_time += elapsed_ms(start);
+
+        start = clock_type::now();
+        nclusters += TrkrGridClustering::find_clusters(cells, du, 1, component);
+        grid_time += elapsed_ms(start);
+
+        if (component != reference)
+        {
+          identical = false;
+          std::cout << "TrkrGridClusteringBenchmark - " << sensor.name << " occupancy " << sensor.occupancy
+                    << " du " << du << ": cluster indices differ" << std::endl;
+        }
+      }
+
+      std::cout << sensor.name << " occupancy " << sensor.occupancy << " z clustering " << du
+                << " hits/sensor " << nhits / nsensors << " clusters/sensor " << nclusters / nsensors
+                << " graph " << graph_time / nsensors << " ms/sensor"
+                << " grid " << grid_time / nsensors << " ms/sensor"
+                << " speedup " << graph_time / grid_time << std::endl;
+    }
+  }
+
+  return identical ? 0 : 1;
+}
@@ -67,6 +67,8 @@ class TrkrHitSet : public PHObject
    *
    * NOTE: This TrkrHitSet takes ownership of the passed TrkrHit pointer
    * and will delete it in the Reset() method.
+   * Implementations with flat storage (TrkrHitSetv2) copy and delete it right away,
+   * so the hit returned by the iterator should be used afterwards.
    */
   virtual ConstIterator addHitSpecificKey(const TrkrDefs::hitkey, TrkrHit*);
 
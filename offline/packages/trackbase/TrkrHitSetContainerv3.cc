@@ -0,0 +1,165 @@
+/**
+ * @file trackbase/TrkrHitSetContainerv3.cc
+ * @brief Implementation for TrkrHitSetContainerv3
+ */
+#include "TrkrHitSetContainerv3.h"
+
+#include "TrkrDefs.h"
+#include "TrkrHit.h"
+#include "TrkrHitSetv2.h"
+
+#include <cassert>
+#include <cstdlib>
+
+namespace
+{
+  //! initial number of hitsets in the TClonesArray
+  constexpr int default_size = 1024;
+}  // namespace
+
+TrkrHitSetContainerv3::TrkrHitSetContainerv3()
+  : m_hitArray("TrkrHitSetv2", default_size)
+{
+}
+
+void TrkrHitSetContainerv3::Reset()
+{
+  m_hitmap.clear();
+
+  // calls TrkrHitSetv2::Clear on all hitsets, which are kept for reuse by findOrAddHitSet
+  m_hitArray.Clear("C");
+}
+
+void TrkrHitSetContainerv3::identify(std::ostream& os) const
+{
+  syncMapArray();
+
+  os << "TrkrHitSetContainerv3: Number of hitsets: " << size() << std::endl;
+  for (const auto& pair : m_hitmap)
+  {
+    int layer = TrkrDefs::getLayer(pair.first);
+    os << "hitsetkey " << pair.first << " layer " << layer << std::endl;
+    pair.second->identify(os);
+  }
+  return;
+}
+
+TrkrHitSetContainerv3::ConstIterator
+TrkrHitSetContainerv3::addHitSet(TrkrHitSet* newhit)
+{
+  return addHitSetSpecifyKey(newhit->getHitSetKey(), newhit);
+}
+
+TrkrHitSetContainerv3::ConstIterator
+TrkrHitSetContainerv3::addHitSetSpecifyKey(const TrkrDefs::hitsetkey key, TrkrHitSet* newhit)
+{
+  syncMapArray();
+  if (m_hitmap.find(key) != m_hitmap.end())
+  {
+    std::cout << "TrkrHitSetContainerv3::AddHitSpecifyKey: duplicate key: " << key << " exiting now" << std::endl;
+    exit(1);
+  }
+
+  auto it = findOrAddHitSet(key);
+  auto* hitset = static_cast<TrkrHitSetv2*>(it->second);
+  hitset->reserve(newhit->size());
+  const auto range = newhit->getHits();
+  for (auto hititer = range.first; hititer != range.second; ++hititer)
+  {
+    hitset->setAdc(hititer->first, hititer->second->getAdc());
+  }
+  delete newhit;
+  return it;
+}
+
+void TrkrHitSetContainerv3::removeHitSet(TrkrDefs::hitsetkey key)
+{
+  syncMapArray();
+  auto iter = m_hitmap.find(key);
+  if (iter == m_hitmap.end())
+  {
+    return;
+  }
+
+  // the removed slot is destructed, remaining hitsets are not moved in memory
+  m_hitArray.Remove(iter->second);
+  m_hitArray.Compress();
+  m_hitmap.erase(iter);
+}
+
+void TrkrHitSetContainerv3::removeHitSet(TrkrHitSet* hitset)
+{
+  removeHitSet(hitset->getHitSetKey());
+}
+
+TrkrHitSetContainerv3::ConstRange
+TrkrHitSetContainerv3::getHitSets(const TrkrDefs::TrkrId trackerid) const
+{
+  syncMapArray();
+  const TrkrDefs::hitsetkey keylo = TrkrDefs::getHitSetKeyLo(trackerid);
+  const TrkrDefs::hitsetkey keyhi = TrkrDefs::getHitSetKeyHi(trackerid);
+  return std::make_pair(m_hitmap.lower_bound(keylo), m_hitmap.upper_bound(keyhi));
+}
+
+TrkrHitSetContainerv3::ConstRange
+TrkrHitSetContainerv3::getHitSets(const TrkrDefs::TrkrId trackerid, const uint8_t layer) const
+{
+  syncMapArray();
+  TrkrDefs::hitsetkey keylo = TrkrDefs::getHitSetKeyLo(trackerid, layer);
+  TrkrDefs::hitsetkey keyhi = TrkrDefs::getHitSetKeyHi(trackerid, layer);
+  return std::make_pair(m_hitmap.lower_bound(keylo), m_hitmap.upper_bound(keyhi));
+}
+
+TrkrHitSetContainerv3::ConstRange
+TrkrHitSetContainerv3::getHitSets() const
+{
+  syncMapArray();
+  return std::make_pair(m_hitmap.cbegin(), m_hitmap.cend());
+}
+
+TrkrHitSetContainerv3::Iterator
+TrkrHitSetContainerv3::findOrAddHitSet(TrkrDefs::hitsetkey key)
+{
+  syncMapArray();
+  auto it = m_hitmap.lower_bound(key);
+  if (it == m_hitmap.end() || (key < it->first))
+  {
+    // reuses a hitset from a previous event if available
+    auto* hitset = static_cast<TrkrHitSet*>(m_hitArray.ConstructedAt(m_hitArray.GetEntriesFast(), "C"));
+    assert(hitset);
+    hitset->setHitSetKey(key);
+    it = m_hitmap.insert(it, std::make_pair(key, hitset));
+  }
+  return it;
+}
+
+TrkrHitSet*
+TrkrHitSetContainerv3::findHitSet(TrkrDefs::hitsetkey key)
+{
+  syncMapArray();
+  auto it = m_hitmap.find(key);
+  if (it != m_hitmap.end())
+  {
+    return it->second;
+  }
+  else
+  {
+    return nullptr;
+  }
+}
+
+void TrkrHitSetContainerv3::syncMapArray() const
+{
+  if (m_hitmap.size() == (size_t) size())
+  {
+    return;
+  }
+
+  m_hitmap.clear();
+  for (unsigned int i = 0; i < size(); ++i)
+  {
+    auto* hitset = static_cast<TrkrHitSet*>(m_hitArray.UncheckedAt(i));
+    assert(hitset);
+    m_hitmap[hitset->getHitSetKey()] = hitset;
+  }
+}
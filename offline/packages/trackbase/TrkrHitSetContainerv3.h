@@ -0,0 +1,74 @@
+#ifndef TRACKBASE_TrkrHitSetContainerv3_H
+#define TRACKBASE_TrkrHitSetContainerv3_H
+
+#include "TrkrDefs.h"
+#include "TrkrHitSetContainer.h"
+
+#include <TClonesArray.h>
+
+#include <cstddef>
+#include <iostream>  // for cout, ostream
+#include <map>
+#include <utility>  // for pair
+
+class TrkrHitSet;
+
+/**
+ * Container for TrkrHitSetv2 objects
+ *
+ * Hitsets are kept in a TClonesArray which acts as an arena: Reset() clears
+ * the hitsets but keeps them, and their hit arrays, allocated for the next
+ * event. Together with the flat hit storage of TrkrHitSetv2 there are no
+ * per hit allocations once the first events have been processed.
+ * The key to hitset map is transient and rebuilt after DST readback.
+ */
+class TrkrHitSetContainerv3 final : public TrkrHitSetContainer
+{
+ public:
+  TrkrHitSetContainerv3();
+
+  ~TrkrHitSetContainerv3() override = default;
+
+  void Reset() override;
+
+  void identify(std::ostream& = std::cout) const override;
+
+  //! hits of newhit are copied to a TrkrHitSetv2, newhit is deleted
+  ConstIterator addHitSet(TrkrHitSet*) override;
+
+  //! hits of newhit are copied to a TrkrHitSetv2, newhit is deleted
+  ConstIterator addHitSetSpecifyKey(const TrkrDefs::hitsetkey, TrkrHitSet*) override;
+
+  void removeHitSet(TrkrDefs::hitsetkey) override;
+
+  void removeHitSet(TrkrHitSet*) override;
+
+  Iterator findOrAddHitSet(TrkrDefs::hitsetkey key) override;
+
+  ConstRange getHitSets(const TrkrDefs::TrkrId trackerid) const override;
+
+  ConstRange getHitSets(const TrkrDefs::TrkrId trackerid, const uint8_t layer) const override;
+
+  ConstRange getHitSets() const override;
+
+  TrkrHitSet* findHitSet(TrkrDefs::hitsetkey key) override;
+
+  unsigned int size() const override
+  {
+    return m_hitArray.GetEntriesFast();
+  }
+
+ private:
+  //! make sure m_hitmap indexes all hitsets of m_hitArray, needed after DST readback
+  void syncMapArray() const;
+
+  //! used for indexing only, not used in storage
+  mutable Map m_hitmap;  //!
+
+  //! hitset storage
+  TClonesArray m_hitArray;
+
+  ClassDefOverride(TrkrHitSetContainerv3, 1)
+};
+
+#endif  // TRACKBASE_TrkrHitSetContainerv3_H
@@ -0,0 +1,299 @@
+/**
+ * @file trackbase/TrkrHitSetv2.cc
+ * @brief Implementation of TrkrHitSetv2
+ */
+#include "TrkrHitSetv2.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>  // for exit
+#include <iostream>
+
+namespace
+{
+  //! hash of a hit key, for the open addressing index
+  inline std::size_t hash_key(const TrkrDefs::hitkey key)
+  {
+    uint32_t h = key * 0x9E3779B1U;
+    h ^= h >> 15U;
+    return h;
+  }
+
+  //! minimum number of slots in the hash index
+  constexpr std::size_t min_index_size = 64;
+}  // namespace
+
+void TrkrHitSetv2::Reset()
+{
+  m_hitSetKey = TrkrDefs::HITSETKEYMAX;
+  m_keys.clear();
+  m_adcs.clear();
+  m_sorted = true;
+  m_index_valid = false;
+  m_hitmap.clear();
+  m_hitmap_valid = false;
+  m_nhitrefs = 0;
+}
+
+void TrkrHitSetv2::identify(std::ostream& os) const
+{
+  const unsigned int layer = TrkrDefs::getLayer(m_hitSetKey);
+  const unsigned int trkrid = TrkrDefs::getTrkrId(m_hitSetKey);
+  os
+      << "TrkrHitSetv2: "
+      << "       hitsetkey " << getHitSetKey()
+      << " TrkrId " << trkrid
+      << " layer " << layer
+      << " nhits: " << m_keys.size()
+      << std::endl;
+
+  sort();
+  for (std::size_t i = 0; i < m_keys.size(); ++i)
+  {
+    os << " hitkey " << m_keys[i] << " adc " << m_adcs[i] << std::endl;
+  }
+}
+
+void TrkrHitSetv2::reserve(const std::size_t nhits)
+{
+  m_keys.reserve(nhits);
+  m_adcs.reserve(nhits);
+}
+
+std::size_t TrkrHitSetv2::find(const TrkrDefs::hitkey key) const
+{
+  if (m_keys.empty())
+  {
+    return npos;
+  }
+
+  // sorted arrays (typically after DST readback or once filling is done) are searched directly
+  if (m_sorted)
+  {
+    const auto iter = std::lower_bound(m_keys.begin(), m_keys.end(), key);
+    return (iter != m_keys.end() && *iter == key) ? static_cast<std::size_t>(iter - m_keys.begin()) : npos;
+  }
+
+  if (!indexValid())
+  {
+    rebuildIndex(m_keys.size());
+  }
+
+  const std::size_t mask = m_index.size() - 1;
+  for (std::size_t slot = hash_key(key) & mask;; slot = (slot + 1) & mask)
+  {
+    const unsigned int entry = m_index[slot];
+    if (entry == 0)
+    {
+      return npos;
+    }
+    if (m_keys[entry - 1] == key)
+    {
+      return entry - 1;
+    }
+  }
+}
+
+void TrkrHitSetv2::rebuildIndex(std::size_t capacity) const
+{
+  // keep the load factor below one half
+  std::size_t nslots = min_index_size;
+  while (nslots < 2 * capacity)
+  {
+    nslots *= 2;
+  }
+  m_index.assign(nslots, 0);
+  m_index_valid = true;
+  for (std::size_t i = 0; i < m_keys.size(); ++i)
+  {
+    insertIndex(i);
+  }
+}
+
+void TrkrHitSetv2::insertIndex(const std::size_t i) const
+{
+  const std::size_t mask = m_index.size() - 1;
+  std::size_t slot = hash_key(m_keys[i]) & mask;
+  while (m_index[slot] != 0)
+  {
+    slot = (slot + 1) & mask;
+  }
+  m_index[slot] = i + 1;
+}
+
+std::size_t TrkrHitSetv2::append(const TrkrDefs::hitkey key, const unsigned short adc)
+{
+  // hits added in order keep the arrays sorted, no index needed then
+  const bool in_order = m_sorted && (m_keys.empty() || key > m_keys.back());
+  if (!in_order && m_sorted)
+  {
+    m_sorted = false;
+    m_index_valid = false;
+  }
+
+  m_keys.push_back(key);
+  m_adcs.push_back(adc);
+  const std::size_t i = m_keys.size() - 1;
+
+  if (!m_sorted)
+  {
+    if (!indexValid() || 2 * m_keys.size() > m_index.size())
+    {
+      rebuildIndex(2 * m_keys.size());
+    }
+    else
+    {
+      insertIndex(i);
+    }
+  }
+
+  if (m_hitmap_valid)
+  {
+    m_hitmap.insert(std::make_pair(key, makeHitRef(key)));
+  }
+  return i;
+}
+
+std::size_t TrkrHitSetv2::findOrAppend(const TrkrDefs::hitkey key)
+{
+  const std::size_t i = find(key);
+  return (i == npos) ? append(key, 0) : i;
+}
+
+void TrkrHitSetv2::sort() const
+{
+  if (m_sorted)
+  {
+    return;
+  }
+
+  m_sortbuffer.clear();
+  m_sortbuffer.reserve(m_keys.size());
+  for (std::size_t i = 0; i < m_keys.size(); ++i)
+  {
+    m_sortbuffer.emplace_back(m_keys[i], m_adcs[i]);
+  }
+  std::sort(m_sortbuffer.begin(), m_sortbuffer.end());
+  for (std::size_t i = 0; i < m_sortbuffer.size(); ++i)
+  {
+    m_keys[i] = m_sortbuffer[i].first;
+    m_adcs[i] = m_sortbuffer[i].second;
+  }
+
+  // array positions changed. Sorted arrays are searched without index
+  m_sorted = true;
+  m_index_valid = false;
+}
+
+unsigned int TrkrHitSetv2::getAdc(const TrkrDefs::hitkey key) const
+{
+  const std::size_t i = find(key);
+  return (i == npos) ? 0 : m_adcs[i];
+}
+
+void TrkrHitSetv2::setAdc(const TrkrDefs::hitkey key, const unsigned int adc)
+{
+  const std::size_t i = findOrAppend(key);
+  m_adcs[i] = std::min<unsigned int>(adc, USHRT_MAX);
+}
+
+void TrkrHitSetv2::addEnergy(const TrkrDefs::hitkey key, const double edep)
+{
+  const std::size_t i = findOrAppend(key);
+
+  // same as TrkrHitv2::addEnergy
+  const double ein = edep * TrkrDefs::EdepScaleFactor;
+  if ((double) m_adcs[i] + ein > (double) USHRT_MAX)
+  {
+    m_adcs[i] = USHRT_MAX;
+  }
+  else
+  {
+    m_adcs[i] += (unsigned short) (ein);
+  }
+}
+
+TrkrHit* TrkrHitSetv2::makeHitRef(const TrkrDefs::hitkey key) const
+{
+  if (m_nhitrefs == m_hitrefs.size())
+  {
+    m_hitrefs.push_back(std::make_unique<HitRef>());
+  }
+  HitRef* hit = m_hitrefs[m_nhitrefs++].get();
+  hit->m_hitset = const_cast<TrkrHitSetv2*>(this);
+  hit->m_key = key;
+  return hit;
+}
+
+void TrkrHitSetv2::buildHitMap() const
+{
+  if (m_hitmap_valid)
+  {
+    return;
+  }
+
+  m_hitmap.clear();
+  m_nhitrefs = 0;
+  sort();
+  for (const auto& key : m_keys)
+  {
+    m_hitmap.emplace_hint(m_hitmap.end(), key, makeHitRef(key));
+  }
+  m_hitmap_valid = true;
+}
+
+void TrkrHitSetv2::removeHit(TrkrDefs::hitkey key)
+{
+  const std::size_t i = find(key);
+  if (i == npos)
+  {
+    identify();
+    std::cout << "TrkrHitSetv2::removeHit: deleting a nonexist key: " << key << " exiting now" << std::endl;
+    exit(1);
+  }
+
+  // erasing keeps the order of the remaining hits, but moves them
+  m_keys.erase(m_keys.begin() + i);
+  m_adcs.erase(m_adcs.begin() + i);
+  m_index_valid = false;
+
+  // the TrkrHit view itself stays in the pool until Reset()
+  m_hitmap.erase(key);
+}
+
+TrkrHitSetv2::ConstIterator
+TrkrHitSetv2::addHitSpecificKey(const TrkrDefs::hitkey key, TrkrHit* hit)
+{
+  if (find(key) != npos)
+  {
+    std::cout << "TrkrHitSetv2::AddHitSpecificKey: duplicate key: " << key << " exiting now" << std::endl;
+    exit(1);
+  }
+
+  // only the adc is stored, the passed hit is not needed anymore
+  const unsigned int adc = std::min<unsigned int>(hit->getAdc(), USHRT_MAX);
+  delete hit;
+
+  buildHitMap();
+  append(key, adc);
+  return m_hitmap.find(key);
+}
+
+TrkrHit*
+TrkrHitSetv2::getHit(const TrkrDefs::hitkey key) const
+{
+  if (find(key) == npos)
+  {
+    return nullptr;
+  }
+
+  buildHitMap();
+  return m_hitmap.find(key)->second;
+}
+
+TrkrHitSetv2::ConstRange
+TrkrHitSetv2::getHits() const
+{
+  buildHitMap();
+  return std::make_pair(m_hitmap.cbegin(), m_hitmap.cend());
+}
@@ -0,0 +1,192 @@
+#ifndef TRACKBASE_TRKRHITSETV2_H
+#define TRACKBASE_TRKRHITSETV2_H
+
+/**
+ * @file trackbase/TrkrHitSetv2.h
+ * @brief Flat storage of TrkrHit's
+ */
+#include "TrkrDefs.h"
+#include "TrkrHit.h"
+#include "TrkrHitSet.h"
+
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <utility>  // for pair
+#include <vector>
+
+/**
+ * @brief Flat container for storing TrkrHit's
+ *
+ * Hits are stored as two contiguous arrays of hit keys and adc values,
+ * which is all the information a TrkrHitv2 carries, instead of one heap
+ * allocated TrkrHit per hit. The arrays are sorted by hit key whenever they
+ * are accessed in order (getHits(), getHitKeys(), getHitAdcs()). While
+ * filling, hits are appended and found through a transient hash index.
+ * Memory is kept across Reset(), so a hitset reused event after event
+ * (see TrkrHitSetContainerv3) does not allocate anymore.
+ *
+ * The TrkrHit based interface is still supported: TrkrHit objects
+ * returned by getHit(), getHits() and addHitSpecificKey() are transient
+ * views on the arrays, taken from a pool owned by the hitset. They stay
+ * valid until the hitset is reset.
+ * Note that, unlike TrkrHitSetv1, addHitSpecificKey() copies the adc of the
+ * passed hit and deletes it. The hit returned by the iterator must be used
+ * afterwards.
+ */
+class TrkrHitSetv2 : public TrkrHitSet
+{
+ public:
+  TrkrHitSetv2() = default;
+
+  ~TrkrHitSetv2() override = default;
+
+  void identify(std::ostream& os = std::cout) const override;
+
+  //! clear hits, allocated memory is kept for reuse
+  void Reset() override;
+
+  //! called by TClonesArray::Clear("C"), same as Reset()
+  void Clear(Option_t* /*option*/ = "") override { Reset(); }
+
+  void setHitSetKey(const TrkrDefs::hitsetkey key) override
+  {
+    m_hitSetKey = key;
+  }
+
+  TrkrDefs::hitsetkey getHitSetKey() const override
+  {
+    return m_hitSetKey;
+  }
+
+  ConstIterator addHitSpecificKey(const TrkrDefs::hitkey, TrkrHit*) override;
+
+  void removeHit(TrkrDefs::hitkey) override;
+
+  TrkrHit* getHit(const TrkrDefs::hitkey) const override;
+
+  ConstRange getHits() const override;
+
+  unsigned int size() const override
+  {
+    return m_keys.size();
+  }
+
+  //!@name flat interface, no TrkrHit objects involved
+  //@{
+
+  //! true if a hit with this key exists
+  bool hasHit(const TrkrDefs::hitkey key) const
+  {
+    return find(key) != npos;
+  }
+
+  //! adc of a given hit, 0 if the hit does not exist
+  unsigned int getAdc(const TrkrDefs::hitkey key) const;
+
+  //! set adc of a given hit, the hit is created if needed
+  void setAdc(const TrkrDefs::hitkey key, const unsigned int adc);
+
+  //! add energy to a given hit (same conversion as TrkrHitv2), the hit is created if needed
+  void addEnergy(const TrkrDefs::hitkey key, const double edep);
+
+  //! hit keys, sorted
+  const std::vector<TrkrDefs::hitkey>& getHitKeys() const
+  {
+    sort();
+    return m_keys;
+  }
+
+  //! adc values, in the same order as getHitKeys()
+  const std::vector<unsigned short>& getHitAdcs() const
+  {
+    sort();
+    return m_adcs;
+  }
+
+  //! reserve memory for a given number of hits
+  void reserve(const std::size_t nhits);
+  //@}
+
+ private:
+  //! transient TrkrHit view on one of the hits, forwards to the hitset arrays
+  class HitRef : public TrkrHit
+  {
+   public:
+    HitRef() = default;
+    ~HitRef() override = default;
+
+    void identify(std::ostream& os = std::cout) const override
+    {
+      os << "TrkrHitSetv2::HitRef with adc = " << getAdc() << std::endl;
+    }
+
+    using TrkrHit::CopyFrom;
+    void CopyFrom(const TrkrHit& source) override { setAdc(source.getAdc()); }
+    void CopyFrom(TrkrHit* source) override { CopyFrom(*source); }
+
+    void addEnergy(const double edep) override { m_hitset->addEnergy(m_key, edep); }
+    double getEnergy() const override { return getAdc() / TrkrDefs::EdepScaleFactor; }
+    void setAdc(const unsigned int adc) override { m_hitset->setAdc(m_key, adc); }
+    unsigned int getAdc() const override { return m_hitset->getAdc(m_key); }
+
+    TrkrHitSetv2* m_hitset = nullptr;
+    TrkrDefs::hitkey m_key = TrkrDefs::HITKEYMAX;
+  };
+
+  static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+  //! index of a given hit in the arrays, npos if not found
+  std::size_t find(const TrkrDefs::hitkey key) const;
+
+  //! append a new hit, the key must not exist yet
+  std::size_t append(const TrkrDefs::hitkey key, const unsigned short adc);
+
+  //! find or append a hit
+  std::size_t findOrAppend(const TrkrDefs::hitkey key);
+
+  //! hash index management
+  void rebuildIndex(std::size_t capacity) const;
+  void insertIndex(const std::size_t i) const;
+  bool indexValid() const { return m_index_valid && !m_index.empty(); }
+
+  //! sort arrays by hit key
+  void sort() const;
+
+  //! make sure the TrkrHit map is up to date, used by the TrkrHit interface
+  void buildHitMap() const;
+  TrkrHit* makeHitRef(const TrkrDefs::hitkey key) const;
+
+  /// unique key for this object
+  TrkrDefs::hitsetkey m_hitSetKey = TrkrDefs::HITSETKEYMAX;
+
+  /// true if the arrays below are sorted by hit key
+  mutable bool m_sorted = true;
+
+  /// hit keys
+  mutable std::vector<TrkrDefs::hitkey> m_keys;
+
+  /// adc values
+  mutable std::vector<unsigned short> m_adcs;
+
+  /// open addressing hash index: array position + 1 of the hits, 0 for empty slots
+  mutable std::vector<unsigned int> m_index;  //!
+
+  /// true if m_index matches the arrays
+  mutable bool m_index_valid = false;  //!
+
+  /// TrkrHit views, only filled when the TrkrHit interface is used
+  mutable Map m_hitmap;  //!
+  mutable bool m_hitmap_valid = false;  //!
+
+  /// pool of TrkrHit views, reused after Reset()
+  mutable std::vector<std::unique_ptr<HitRef>> m_hitrefs;  //!
+  mutable std::size_t m_nhitrefs = 0;  //!
+
+  /// scratch space for sorting
+  mutable std::vector<std::pair<TrkrDefs::hitkey, unsigned short>> m_sortbuffer;  //!
+
+  ClassDefOverride(TrkrHitSetv2, 1);
+};
+
+#endif  // TRACKBASE_TRKRHITSETV2_H
@@ -73,6 +73,15 @@ class TrkrHitTruthAssoc : public PHObject
   {
   }
 
+  /**
+   * @brief Get all associations of a hitset, in insertion order
+   * @param[in] hset TrkrHitSet key
+   */
+  virtual ConstRange getHitSetG4Hits(const TrkrDefs::hitsetkey /*hitsetkey*/) const
+  {
+    return ConstRange();
+  }
+
  protected:
   //! ctor
   TrkrHitTruthAssoc() = default;
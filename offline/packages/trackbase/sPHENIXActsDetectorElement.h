@@ -54,11 +54,14 @@ class sPHENIXActsDetectorElement : public ActsPlugins::TGeoDetectorElement
 
   const Acts::Transform3& localToGlobalTransform(const Acts::GeometryContext& ctxt) const override;
 
+  //! construction transform, without alignment, independently of alignmentTransformationContainer::use_alignment
+  const Acts::Transform3& nominalLocalToGlobalTransform() const { return TGeoDetectorElement::nominalTransform(); }
+
  private:
   std::map<unsigned int, unsigned int> base_layer_map = {{10, 0}, {12, 3}, {14, 7}, {16, 55}};
 };
 
-std::shared_ptr<sPHENIXActsDetectorElement> sPHENIXElementFactory(
+inline std::shared_ptr<sPHENIXActsDetectorElement> sPHENIXElementFactory(
     const sPHENIXActsDetectorElement::Identifier& identifier, const TGeoNode& tGeoNode,
     const TGeoMatrix& tGeoMatrix, const std::string& axes, double scalor,
     std::shared_ptr<const Acts::ISurfaceMaterial> material)
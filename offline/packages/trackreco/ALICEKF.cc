@@ -8,6 +8,9 @@
 #include <trackbase/TrkrCluster.h>
 #include <trackbase_historic/ActsTransformations.h>
 
+#include <fun4all/Fun4AllServer.h>
+#include <fun4all/Fun4AllTaskScheduler.h>
+
 #include <Geant4/G4SystemOfUnits.hh>
 #include <cmath>
 
@@ -15,8 +18,6 @@
 #include <TMatrixT.h>
 #include <TMatrixTUtils.h>
 
-#include <omp.h>
-
 //#define _DEBUG_
 
 #if defined(_DEBUG_)
@@ -79,7 +80,7 @@ double ALICEKF::get_Bz(double x, double y, double z) const
     double bfield[3];
 
     // check thread number. Use uncached field accessor for all but thread 0.
-    if( omp_get_thread_num() == 0 )
+    if( Fun4AllServer::instance()->TaskScheduler()->ThreadIndex() == 0 )
     {
       _B->GetFieldValue(&p[0], bfield);
     } else {
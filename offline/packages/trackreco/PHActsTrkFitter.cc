@@ -39,6 +39,8 @@
 #include <ffamodules/CDBInterface.h>
 
 #include <fun4all/Fun4AllReturnCodes.h>
+#include <fun4all/Fun4AllServer.h>
+#include <fun4all/Fun4AllTaskScheduler.h>
 
 #include <phool/PHCompositeNode.h>
 #include <phool/PHDataNode.h>
@@ -62,9 +64,12 @@
 #include <Eigen/Dense>
 #include <Eigen/Geometry>
 
+#include <algorithm>
 #include <cmath>
 #include <filesystem>
 #include <iostream>
+#include <numeric>
+#include <unordered_map>
 #include <vector>
 
 namespace
@@ -241,11 +246,38 @@ namespace
 
 }  // namespace
 
+//___________________________________________________________________________
+struct PHActsTrkFitter::FitContext
+{
+  //! source link maker, with the cluster mover geometry
+  MakeSourceLinks makeSourceLinks;
+
+  //! measurement calibrator
+  Calibrator calibrator;
+
+  //! fitted tracks and track states, cleared before each fit so that the storage is reused
+  std::shared_ptr<Acts::VectorTrackContainer> trackContainer = std::make_shared<Acts::VectorTrackContainer>();
+  std::shared_ptr<Acts::VectorMultiTrajectory> trackStateContainer = std::make_shared<Acts::VectorMultiTrajectory>();
+};
+
+//___________________________________________________________________________
+struct PHActsTrkFitter::SeedFitOutput
+{
+  //! fitted tracks, to be inserted in the track map
+  std::vector<SvtxTrack_v4> tracks;
+
+  //! number of fits which returned an error
+  int nBadFits = 0;
+};
+
 //___________________________________________________________________________
 PHActsTrkFitter::PHActsTrkFitter(const std::string& name)
   : SubsysReco(name)
 {}
 
+//___________________________________________________________________________
+PHActsTrkFitter::~PHActsTrkFitter() = default;
+
 //___________________________________________________________________________
 int PHActsTrkFitter::InitRun(PHCompositeNode* topNode)
 {
@@ -343,6 +375,9 @@ int PHActsTrkFitter::InitRun(PHCompositeNode* topNode)
 
   _topNode = topNode;
 
+  // fit contexts are created with the new geometry at the first event
+  m_fitContexts.clear();
+
   if (Verbosity() > 1)
   {
     std::cout << "Finish PHActsTrkFitter Setup" << std::endl;
@@ -458,147 +493,303 @@ void PHActsTrkFitter::loopTracks(Acts::Logging::Level logLevel)
 {
   auto logger = Acts::getDefaultLogger("PHActsTrkFitter", logLevel);
 
-  for (auto track : *m_seedMap)
+  // one fit context per thread, created once. The number of threads may change between events
+  Fun4AllTaskScheduler* scheduler = Fun4AllServer::instance()->TaskScheduler();
+  while (m_fitContexts.size() < scheduler->NumThreads())
   {
-    if (!track)
+    auto context = std::make_unique<FitContext>();
+    context->makeSourceLinks.initialize(_tpccellgeo, m_tGeometry, _topNode);
+    context->makeSourceLinks.setVerbosity(Verbosity());
+    context->makeSourceLinks.set_pp_mode(m_pp_mode);
+    context->makeSourceLinks.set_cluster_edge_rejection(m_cluster_edge_rejection);
+    for (const auto& layer : m_ignoreLayer)
     {
-      continue;
+      context->makeSourceLinks.ignoreLayer(layer);
     }
-    
-    unsigned int tpcid = track->get_tpc_seed_index();
-    unsigned int siid = track->get_silicon_seed_index();
-    auto *siseed = m_siliconSeeds->get(siid);
-    auto *tpcseed = m_tpcSeeds->get(tpcid);
+    m_fitContexts.push_back(std::move(context));
+  }
 
-    short int best_crossing = track->get_crossing();  // best crossing between INTT clusters and TPC seed
+  if (!m_parallelFit || !canFitInParallel())
+  {
+    // seeds are fitted in sequence, and tracks inserted after each seed
+    SeedFitOutput output;
+    for (std::size_t iseed = 0; iseed < m_seedMap->size(); ++iseed)
+    {
+      fitSeed(iseed, *m_fitContexts.front(), output);
+      insertTracks(output);
+    }
+    return;
+  }
 
-    if(Verbosity() > 2 && siseed && tpcseed)
-	  {
-	    std::cout << "tpc and si id " << tpcid << ", " << siid << " silicon_crossing " << siseed->get_crossing()
-		      << " tpc crossing " << tpcseed->get_crossing()
-		      << " best crossing " << best_crossing << " crossing estimate " << track->get_crossing_estimate() << std::endl;
-	  }
-    
-    // capture the input crossing value, and set crossing parameters
-    //==============================
+  // seeds are fitted in parallel on the job wide task scheduler, by groups of seeds sharing TPC clusters.
+  // Each seed has its own output slot, merged in seed order afterwards, which keeps the output independent of the number of threads
+  const auto groups = groupSeeds();
+  std::vector<SeedFitOutput> outputs(m_seedMap->size());
+  scheduler->parallel_for(0, groups.size(), [&](std::size_t igroup)
+  {
+    auto& context = *m_fitContexts[scheduler->ThreadIndex()];
+    for (const auto& iseed : groups[igroup])
+    {
+      fitSeed(iseed, context, outputs[iseed]);
+    }
+  });
+
+  for (auto& output : outputs)
+  {
+    insertTracks(output);
+  }
+}
+
+//___________________________________________________________________________
+bool PHActsTrkFitter::canFitInParallel() const
+{
+  // the transient transforms used without cluster mover are shared by all tracks,
+  // as are the alignment states, the evaluator, the outlier finder and the timing histograms
+  return m_use_clustermover && !m_commissioning && !m_actsEvaluator && !m_useOutlierFinder && !m_timeAnalysis;
+}
 
-    short int crossing = best_crossing;
-    short int crossing_estimate = crossing;
+//___________________________________________________________________________
+std::vector<std::vector<std::size_t>> PHActsTrkFitter::groupSeeds() const
+{
+  // union find, each seed is linked to the first seed using one of its TPC clusters
+  const std::size_t nseeds = m_seedMap->size();
+  std::vector<std::size_t> parent(nseeds);
+  std::iota(parent.begin(), parent.end(), 0);
+  const auto find_root = [&parent](std::size_t iseed)
+  {
+    while (parent[iseed] != iseed)
+    {
+      parent[iseed] = parent[parent[iseed]];
+      iseed = parent[iseed];
+    }
+    return iseed;
+  };
 
-    if (m_enable_crossing_estimate)
+  std::unordered_map<TrkrDefs::cluskey, std::size_t> first_seed;
+  for (std::size_t iseed = 0; iseed < nseeds; ++iseed)
+  {
+    const auto* track = m_seedMap->get(iseed);
+    const auto* tpcseed = track ? m_tpcSeeds->get(track->get_tpc_seed_index()) : nullptr;
+    if (!tpcseed)
     {
-      crossing_estimate = track->get_crossing_estimate();  // geometric crossing estimate from matcher
+      continue;
     }
-    //===============================
 
-    // must have silicon seed with valid crossing if we are doing a SC calibration fit
-    if (m_fitSiliconMMs)
+    for (auto key_iter = tpcseed->begin_cluster_keys(); key_iter != tpcseed->end_cluster_keys(); ++key_iter)
     {
-      if ((siid == std::numeric_limits<unsigned int>::max()) || (crossing == SHRT_MAX))
+      if (TrkrDefs::getTrkrId(*key_iter) != TrkrDefs::tpcId)
       {
         continue;
       }
+
+      const auto [iter, inserted] = first_seed.try_emplace(*key_iter, iseed);
+      if (!inserted)
+      {
+        // the root of a group is its first seed
+        const auto first = find_root(iter->second);
+        const auto second = find_root(iseed);
+        parent[std::max(first, second)] = std::min(first, second);
+      }
     }
+  }
 
-    // do not skip TPC only tracks, just set crossing to the nominal zero
-    if (!siseed)
+  // groups are ordered by first seed, and seeds in a group are in seed order
+  std::vector<std::vector<std::size_t>> groups;
+  std::vector<std::size_t> group_index(nseeds, nseeds);
+  for (std::size_t iseed = 0; iseed < nseeds; ++iseed)
+  {
+    const auto root = find_root(iseed);
+    if (group_index[root] == nseeds)
     {
-      crossing = 0;
+      group_index[root] = groups.size();
+      groups.emplace_back();
     }
+    groups[group_index[root]].push_back(iseed);
+  }
 
-    // no path forward in this case, move on
-    if(crossing == SHRT_MAX && crossing_estimate == SHRT_MAX) { continue; }
-	
-    /// Need to also check that the tpc seed wasn't removed by the ghost finder
-    if (!tpcseed)
+  return groups;
+}
+
+//___________________________________________________________________________
+void PHActsTrkFitter::insertTracks(SeedFitOutput& output)
+{
+  // track ids follow the insertion order
+  auto* trackMap = m_fitSiliconMMs ? m_directedTrackMap : m_trackMap;
+  for (const auto& track : output.tracks)
+  {
+    trackMap->insertWithKey(&track, trackMap->size());
+  }
+  m_nBadFits += output.nBadFits;
+
+  output.tracks.clear();
+  output.nBadFits = 0;
+}
+
+//___________________________________________________________________________
+void PHActsTrkFitter::fitSeed(std::size_t iseed, FitContext& context, SeedFitOutput& output)
+{
+  auto* track = m_seedMap->get(iseed);
+  if (!track)
+  {
+    return;
+  }
+  
+  unsigned int tpcid = track->get_tpc_seed_index();
+  unsigned int siid = track->get_silicon_seed_index();
+  auto *siseed = m_siliconSeeds->get(siid);
+  auto *tpcseed = m_tpcSeeds->get(tpcid);
+
+  short int best_crossing = track->get_crossing();  // best crossing between INTT clusters and TPC seed
+
+  if(Verbosity() > 2 && siseed && tpcseed)
+	  {
+	    std::cout << "tpc and si id " << tpcid << ", " << siid << " silicon_crossing " << siseed->get_crossing()
+		      << " tpc crossing " << tpcseed->get_crossing()
+		      << " best crossing " << best_crossing << " crossing estimate " << track->get_crossing_estimate() << std::endl;
+	  }
+  
+  // capture the input crossing value, and set crossing parameters
+  //==============================
+
+  short int crossing = best_crossing;
+  short int crossing_estimate = crossing;
+
+  if (m_enable_crossing_estimate)
+  {
+    crossing_estimate = track->get_crossing_estimate();  // geometric crossing estimate from matcher
+  }
+  //===============================
+
+  // must have silicon seed with valid crossing if we are doing a SC calibration fit
+  if (m_fitSiliconMMs)
+  {
+    if ((siid == std::numeric_limits<unsigned int>::max()) || (crossing == SHRT_MAX))
     {
-      std::cout << "no tpc seed" << std::endl;
-      continue;
+      return;
     }
+  }
+
+  // do not skip TPC only tracks, just set crossing to the nominal zero
+  if (!siseed)
+  {
+    crossing = 0;
+  }
+
+  // no path forward in this case, move on
+  if(crossing == SHRT_MAX && crossing_estimate == SHRT_MAX) { return; }
 	
-    if (Verbosity() > 0)
-      {
+  /// Need to also check that the tpc seed wasn't removed by the ghost finder
+  if (!tpcseed)
+  {
+    std::cout << "no tpc seed" << std::endl;
+    return;
+  }
+	
+  if (Verbosity() > 0)
+    {
 	if (siseed)
-      {
-        const auto si_position = TrackSeedHelper::get_xyz(siseed);
-        const auto tpc_position = TrackSeedHelper::get_xyz(tpcseed);
-        std::cout << "    silicon seed position is (x,y,z) = " << si_position.x() << "  " << si_position.y() << "  " << si_position.z() << std::endl;
-        std::cout << "    tpc seed position is (x,y,z) = " << tpc_position.x() << "  " << tpc_position.y() << "  " << tpc_position.z() << std::endl;
-      }
+    {
+      const auto si_position = TrackSeedHelper::get_xyz(siseed);
+      const auto tpc_position = TrackSeedHelper::get_xyz(tpcseed);
+      std::cout << "    silicon seed position is (x,y,z) = " << si_position.x() << "  " << si_position.y() << "  " << si_position.z() << std::endl;
+      std::cout << "    tpc seed position is (x,y,z) = " << tpc_position.x() << "  " << tpc_position.y() << "  " << tpc_position.z() << std::endl;
     }
+  }
 
-    PHTimer trackTimer("TrackTimer");
-    trackTimer.stop();
-    trackTimer.restart();
+  PHTimer trackTimer("TrackTimer");
+  trackTimer.stop();
+  trackTimer.restart();
 
-    if (Verbosity() > 1 && siseed)
-    {
-      std::cout << " m_pp_mode " << m_pp_mode << " m_enable_crossing_estimate " << m_enable_crossing_estimate
-                << " best crossing " << crossing << " crossing_estimate " << crossing_estimate << std::endl;
-    }
+  if (Verbosity() > 1 && siseed)
+  {
+    std::cout << " m_pp_mode " << m_pp_mode << " m_enable_crossing_estimate " << m_enable_crossing_estimate
+              << " best crossing " << crossing << " crossing_estimate " << crossing_estimate << std::endl;
+  }
 
-    short int this_crossing = crossing;
-    bool use_estimate = false;
-    short int nvary = 0;
-    std::vector<float> chisq_ndf;
-    std::vector<SvtxTrack_v4> svtx_vec;
+  short int this_crossing = crossing;
+  bool use_estimate = false;
+  short int nvary = 0;
+  std::vector<float> chisq_ndf;
+  std::vector<SvtxTrack_v4> svtx_vec;
 
-    if (m_pp_mode)
+  if (m_pp_mode)
+  {
+    if (m_enable_crossing_estimate && crossing == SHRT_MAX)
     {
-      if (m_enable_crossing_estimate && crossing == SHRT_MAX)
-      {
-        // this only happens if there is a silicon seed but no assigned INTT crossing, and only in pp_mode
-        // If there is no INTT crossing, start with the crossing_estimate value, vary up and down, fit, and choose the best chisq/ndf
-        use_estimate = true;
-        nvary = max_bunch_search;
-        if (Verbosity() > 1)
-        {
-          std::cout << " No INTT crossing: use crossing_estimate " << crossing_estimate << " with nvary " << nvary << std::endl;
-        }
-      }
-      else
+      // this only happens if there is a silicon seed but no assigned INTT crossing, and only in pp_mode
+      // If there is no INTT crossing, start with the crossing_estimate value, vary up and down, fit, and choose the best chisq/ndf
+      use_estimate = true;
+      nvary = max_bunch_search;
+      if (Verbosity() > 1)
       {
-        // use best crossing
-        crossing_estimate = crossing;
+        std::cout << " No INTT crossing: use crossing_estimate " << crossing_estimate << " with nvary " << nvary << std::endl;
       }
     }
     else
     {
-      // non pp mode, we want only crossing zero, veto others
-      if (siseed && best_crossing != 0)
-      {
-        crossing = 0;
-        // continue;
-      }
+      // use best crossing
       crossing_estimate = crossing;
     }
+  }
+  else
+  {
+    // non pp mode, we want only crossing zero, veto others
+    if (siseed && best_crossing != 0)
+    {
+      crossing = 0;
+      // continue;
+    }
+    crossing_estimate = crossing;
+  }
 	
-    // Fit this track assuming either:
-    //    crossing = best crossing value, if it exists (uses nvary = 0)
-    //    crossing = crossing_estimate +/- max_bunch_search, if no INTT value exists and m_enable_crossing_estimate flag is set.
+  // Fit this track assuming either:
+  //    crossing = best crossing value, if it exists (uses nvary = 0)
+  //    crossing = crossing_estimate +/- max_bunch_search, if no INTT value exists and m_enable_crossing_estimate flag is set.
+
+  for (short int ivary = -nvary; ivary <= nvary; ++ivary)
+  {
+    this_crossing = crossing_estimate + ivary;
 
-    for (short int ivary = -nvary; ivary <= nvary; ++ivary)
+    if (Verbosity() > 1)
     {
-      this_crossing = crossing_estimate + ivary;
+      std::cout << "   nvary " << nvary << " trial fit with ivary " << ivary << " this_crossing = " << this_crossing << std::endl;
+    }
 
-      if (Verbosity() > 1)
-      {
-        std::cout << "   nvary " << nvary << " trial fit with ivary " << ivary << " this_crossing = " << this_crossing << std::endl;
-      }
+    ActsTrackFittingAlgorithm::MeasurementContainer measurements;
 
-      ActsTrackFittingAlgorithm::MeasurementContainer measurements;
+    SourceLinkVec sourceLinks;
 
-      SourceLinkVec sourceLinks;
+    auto& makeSourceLinks = context.makeSourceLinks;
 
-      MakeSourceLinks makeSourceLinks;
-      makeSourceLinks.initialize(_tpccellgeo, m_tGeometry, _topNode);
-      makeSourceLinks.setVerbosity(Verbosity());
-      makeSourceLinks.set_pp_mode(m_pp_mode);
-      makeSourceLinks.set_cluster_edge_rejection(m_cluster_edge_rejection);
-      for (const auto& layer : m_ignoreLayer)
+    if (m_use_clustermover)
+    {
+      // make source links using cluster mover after making distortion correction
+      if (siseed && !m_ignoreSilicon)
       {
-        makeSourceLinks.ignoreLayer(layer);
+        // silicon source links
+        sourceLinks = makeSourceLinks.getSourceLinksClusterMover(
+            siseed,
+            measurements,
+            m_clusterContainer,
+            m_tGeometry,
+            m_globalPositionWrapper,
+            this_crossing);
       }
+
+      // tpc source links
+      const auto tpcSourceLinks = makeSourceLinks.getSourceLinksClusterMover(
+          tpcseed,
+          measurements,
+          m_clusterContainer,
+          m_tGeometry,
+          m_globalPositionWrapper,
+          this_crossing);
+
+      // add tpc sourcelinks to silicon source links
+      sourceLinks.insert(sourceLinks.end(), tpcSourceLinks.begin(), tpcSourceLinks.end());
+    }
+    else
+    {
       // loop over modifiedTransformSet and replace transient elements modified for the previous track with the default transforms
       // does nothing if m_transient_id_set is empty
       makeSourceLinks.resetTransientTransformMap(
@@ -606,63 +797,17 @@ void PHActsTrkFitter::loopTracks(Acts::Logging::Level logLevel)
           m_transient_id_set,
           m_tGeometry);
 
-      if (m_use_clustermover)
+      // make source links using transient transforms for distortion corrections
+      if (Verbosity() > 1)
       {
-        // make source links using cluster mover after making distortion correction
-        if (siseed && !m_ignoreSilicon)
-        {
-          // silicon source links
-          sourceLinks = makeSourceLinks.getSourceLinksClusterMover(
-              siseed,
-              measurements,
-              m_clusterContainer,
-              m_tGeometry,
-              m_globalPositionWrapper,
-              this_crossing);
-        }
-
-        // tpc source links
-        const auto tpcSourceLinks = makeSourceLinks.getSourceLinksClusterMover(
-            tpcseed,
-            measurements,
-            m_clusterContainer,
-            m_tGeometry,
-            m_globalPositionWrapper,
-            this_crossing);
-
-        // add tpc sourcelinks to silicon source links
-        sourceLinks.insert(sourceLinks.end(), tpcSourceLinks.begin(), tpcSourceLinks.end());
+        std::cout << "Calling getSourceLinks for si seed, siid " << siid << " and tpcid " << tpcid << std::endl;
       }
-      else
-      {
-        // make source links using transient transforms for distortion corrections
-        if (Verbosity() > 1)
-        {
-          std::cout << "Calling getSourceLinks for si seed, siid " << siid << " and tpcid " << tpcid << std::endl;
-        }
 
-        if (siseed && !m_ignoreSilicon)
-        {
-          // silicon source links
-          sourceLinks = makeSourceLinks.getSourceLinks(
-              siseed,
-              measurements,
-              m_clusterContainer,
-              m_tGeometry,
-              m_globalPositionWrapper,
-              m_alignmentTransformationMapTransient,
-              m_transient_id_set,
-              this_crossing);
-        }
-
-        if (Verbosity() > 1)
-        {
-          std::cout << "Calling getSourceLinks for tpc seed, siid " << siid << " and tpcid " << tpcid << std::endl;
-        }
-
-        // tpc source links
-        const auto tpcSourceLinks = makeSourceLinks.getSourceLinks(
-            tpcseed,
+      if (siseed && !m_ignoreSilicon)
+      {
+        // silicon source links
+        sourceLinks = makeSourceLinks.getSourceLinks(
+            siseed,
             measurements,
             m_clusterContainer,
             m_tGeometry,
@@ -670,372 +815,369 @@ void PHActsTrkFitter::loopTracks(Acts::Logging::Level logLevel)
             m_alignmentTransformationMapTransient,
             m_transient_id_set,
             this_crossing);
+      }
 
-        // add tpc sourcelinks to silicon source links
-        sourceLinks.insert(sourceLinks.end(), tpcSourceLinks.begin(), tpcSourceLinks.end());
+      if (Verbosity() > 1)
+      {
+        std::cout << "Calling getSourceLinks for tpc seed, siid " << siid << " and tpcid " << tpcid << std::endl;
       }
 
-      Acts::GeometryContext geoContext{m_alignmentTransformationMapTransient};
+      // tpc source links
+      const auto tpcSourceLinks = makeSourceLinks.getSourceLinks(
+          tpcseed,
+          measurements,
+          m_clusterContainer,
+          m_tGeometry,
+          m_globalPositionWrapper,
+          m_alignmentTransformationMapTransient,
+          m_transient_id_set,
+          this_crossing);
 
-      // copy transient map for this track into transient geoContext
-      m_transient_geocontext = geoContext;
+      // add tpc sourcelinks to silicon source links
+      sourceLinks.insert(sourceLinks.end(), tpcSourceLinks.begin(), tpcSourceLinks.end());
+    }
 
-      // position comes from the silicon seed, unless there is no silicon seed
-      Acts::Vector3 position(0, 0, 0);
-      if (siseed && !m_ignoreSilicon)
-      {
-        position = TrackSeedHelper::get_xyz(siseed) * Acts::UnitConstants::cm;
-      }
-      if (!siseed || !is_valid(position) || m_forceTpcOnlyFit)
-      {
-        position = TrackSeedHelper::get_xyz(tpcseed) * Acts::UnitConstants::cm;
-      }
-      if (!is_valid(position))
+    // transient map for this track. Without cluster mover, it holds the transient transforms set above
+    const Acts::GeometryContext geoContext{m_alignmentTransformationMapTransient};
+
+    // position comes from the silicon seed, unless there is no silicon seed
+    Acts::Vector3 position(0, 0, 0);
+    if (siseed && !m_ignoreSilicon)
+    {
+      position = TrackSeedHelper::get_xyz(siseed) * Acts::UnitConstants::cm;
+    }
+    if (!siseed || !is_valid(position) || m_forceTpcOnlyFit)
+    {
+      position = TrackSeedHelper::get_xyz(tpcseed) * Acts::UnitConstants::cm;
+    }
+    if (!is_valid(position))
+    {
+      if (Verbosity() > 4)
       {
-        if (Verbosity() > 4)
-        {
-          std::cout << "Invalid position of " << position.transpose() << std::endl;
-        }
-        continue;
+        std::cout << "Invalid position of " << position.transpose() << std::endl;
       }
+      continue;
+    }
+
+    // filter sourcelinks to remove detectors that we don't want to include in the fit
+    sourceLinks = filterSourceLinks( sourceLinks );
+
+    if (sourceLinks.empty())
+    {
+      continue;
+    }
 
-      // filter sourcelinks to remove detectors that we don't want to include in the fit
-      sourceLinks = filterSourceLinks( sourceLinks );
+    /// If using directed navigation, collect surface list to navigate
+    SurfacePtrVec surfaces;
+    if (m_fitSiliconMMs || m_directNavigation)
+    {
 
-      if (sourceLinks.empty())
+      // get surfaces matching source links
+      const auto surfaces_tmp = getSurfaceVector(sourceLinks);
+
+      // skip if there is no surfaces
+      if (surfaces_tmp.empty())
       {
         continue;
       }
 
-      /// If using directed navigation, collect surface list to navigate
-      SurfacePtrVec surfaces;
-      if (m_fitSiliconMMs || m_directNavigation)
+      for (const auto& surface_apr : m_materialSurfaces)
       {
-
-        // get surfaces matching source links
-        const auto surfaces_tmp = getSurfaceVector(sourceLinks);
-
-        // skip if there is no surfaces
-        if (surfaces_tmp.empty())
+        if (m_forceSiOnlyFit)
         {
-          continue;
+          if (surface_apr->geometryId().volume() > 12)
+          {
+            continue;
+          }
         }
-
-        for (const auto& surface_apr : m_materialSurfaces)
+        //else if (m_forceTpcOnlyFit)
+        //{
+        //  if (surface_apr->geometryId().volume() < 14)
+        //  {
+        //    continue;
+        //  }
+        //}
+        bool pop_flag = false;
+        if (surface_apr->geometryId().approach() == 1)
+        {
+          surfaces.push_back(surface_apr);
+        }
+        else
         {
-          if (m_forceSiOnlyFit)
+          pop_flag = true;
+          for (const auto& surface_sns : surfaces_tmp)
           {
-            if (surface_apr->geometryId().volume() > 12)
+            if (surface_apr->geometryId().volume() == surface_sns->geometryId().volume())
             {
-              continue;
+              if (surface_apr->geometryId().layer() == surface_sns->geometryId().layer())
+              {
+                pop_flag = false;
+                surfaces.push_back(surface_sns);
+              }
             }
           }
-          //else if (m_forceTpcOnlyFit)
-          //{
-          //  if (surface_apr->geometryId().volume() < 14)
-          //  {
-          //    continue;
-          //  }
-          //}
-          bool pop_flag = false;
-          if (surface_apr->geometryId().approach() == 1)
+          if (!pop_flag)
           {
             surfaces.push_back(surface_apr);
           }
           else
           {
-            pop_flag = true;
+            surfaces.pop_back();
+            pop_flag = false;
+          }
+          if (surface_apr->geometryId().volume() == 12 && surface_apr->geometryId().layer() == 8)
+          {
             for (const auto& surface_sns : surfaces_tmp)
             {
-              if (surface_apr->geometryId().volume() == surface_sns->geometryId().volume())
-              {
-                if (surface_apr->geometryId().layer() == surface_sns->geometryId().layer())
-                {
-                  pop_flag = false;
-                  surfaces.push_back(surface_sns);
-                }
-              }
-            }
-            if (!pop_flag)
-            {
-              surfaces.push_back(surface_apr);
-            }
-            else
-            {
-              surfaces.pop_back();
-              pop_flag = false;
-            }
-            if (surface_apr->geometryId().volume() == 12 && surface_apr->geometryId().layer() == 8)
-            {
-              for (const auto& surface_sns : surfaces_tmp)
+              if (14 == surface_sns->geometryId().volume())
               {
-                if (14 == surface_sns->geometryId().volume())
-                {
-                  surfaces.push_back(surface_sns);
-                }
+                surfaces.push_back(surface_sns);
               }
             }
           }
         }
-        // With an empty ACTS material map, m_materialSurfaces is empty.
-        // Use the measurement surfaces directly for directed navigation.
-        if (surfaces.empty())
-        {
-          surfaces = surfaces_tmp;
-        }
+      }
+      // With an empty ACTS material map, m_materialSurfaces is empty.
+      // Use the measurement surfaces directly for directed navigation.
+      if (surfaces.empty())
+      {
+        surfaces = surfaces_tmp;
+      }
 
-        checkSurfaceVec(surfaces);
-        if (Verbosity() > 1)
+      checkSurfaceVec(surfaces);
+      if (Verbosity() > 1)
+      {
+        for (const auto& surf : surfaces)
         {
-          for (const auto& surf : surfaces)
-          {
-            std::cout << "Surface vector : " << surf->geometryId() << std::endl;
-          }
+          std::cout << "Surface vector : " << surf->geometryId() << std::endl;
         }
+      }
 
-        if (m_fitSiliconMMs)
+      if (m_fitSiliconMMs)
+      {
+        // make sure micromegas are in the tracks, if required
+        if (m_useMicromegas &&
+            std::none_of(surfaces.begin(), surfaces.end(), [this](const auto& surface)
+                         { return m_tGeometry->maps().isMicromegasSurface(surface); }))
         {
-          // make sure micromegas are in the tracks, if required
-          if (m_useMicromegas &&
-              std::none_of(surfaces.begin(), surfaces.end(), [this](const auto& surface)
-                           { return m_tGeometry->maps().isMicromegasSurface(surface); }))
-          {
-            continue;
-          }
+          continue;
         }
       }
+    }
 
-      float px = std::numeric_limits<float>::quiet_NaN();
-      float py = std::numeric_limits<float>::quiet_NaN();
-      float pz = std::numeric_limits<float>::quiet_NaN();
+    float px = std::numeric_limits<float>::quiet_NaN();
+    float py = std::numeric_limits<float>::quiet_NaN();
+    float pz = std::numeric_limits<float>::quiet_NaN();
 
-      // get phi and theta from the silicon seed, momentum from the TPC seed
-      float seedphi = 0;
-      float seedtheta = 0;
-      float seedeta = 0;
-      if (siseed && !m_forceTpcOnlyFit)
-      {
-        seedphi = siseed->get_phi();
-        seedtheta = siseed->get_theta();
-        seedeta = siseed->get_eta();
-      }
-      else
-      {
-        seedphi = tpcseed->get_phi();
-        seedtheta = tpcseed->get_theta();
-        seedeta = tpcseed->get_eta();
-      }
+    // get phi and theta from the silicon seed, momentum from the TPC seed
+    float seedphi = 0;
+    float seedtheta = 0;
+    float seedeta = 0;
+    if (siseed && !m_forceTpcOnlyFit)
+    {
+      seedphi = siseed->get_phi();
+      seedtheta = siseed->get_theta();
+      seedeta = siseed->get_eta();
+    }
+    else
+    {
+      seedphi = tpcseed->get_phi();
+      seedtheta = tpcseed->get_theta();
+      seedeta = tpcseed->get_eta();
+    }
 
-      float seedpt = tpcseed->get_pt();
+    float seedpt = tpcseed->get_pt();
 
-      if (m_ConstField)
-      {
-        float pt = fabs(1. / tpcseed->get_qOverR()) * (0.3 / 100) * fieldstrength;
-        float phi = seedphi;
-        float eta = seedeta;
-        float theta = seedtheta;
-        px = pt * std::cos(phi);
-        py = pt * std::sin(phi);
-        pz = pt * std::cosh(eta) * std::cos(theta);
-      }
-      else
-      {
-        px = seedpt * std::cos(seedphi);
-        py = seedpt * std::sin(seedphi);
-        pz = seedpt * std::cosh(seedeta) * std::cos(seedtheta);
-      }
+    if (m_ConstField)
+    {
+      float pt = fabs(1. / tpcseed->get_qOverR()) * (0.3 / 100) * fieldstrength;
+      float phi = seedphi;
+      float eta = seedeta;
+      float theta = seedtheta;
+      px = pt * std::cos(phi);
+      py = pt * std::sin(phi);
+      pz = pt * std::cosh(eta) * std::cos(theta);
+    }
+    else
+    {
+      px = seedpt * std::cos(seedphi);
+      py = seedpt * std::sin(seedphi);
+      pz = seedpt * std::cosh(seedeta) * std::cos(seedtheta);
+    }
 
-      Acts::Vector3 momentum(px, py, pz);
-      if (!is_valid(momentum))
+    Acts::Vector3 momentum(px, py, pz);
+    if (!is_valid(momentum))
+    {
+      if (Verbosity() > 4)
       {
-        if (Verbosity() > 4)
-        {
-          std::cout << "Invalid momentum of " << momentum.transpose() << std::endl;
-        }
-        continue;
+        std::cout << "Invalid momentum of " << momentum.transpose() << std::endl;
       }
+      continue;
+    }
 
-      auto pSurface = Acts::Surface::makeShared<Acts::PerigeeSurface>(position);
+    auto pSurface = Acts::Surface::makeShared<Acts::PerigeeSurface>(position);
 
-      Acts::Vector4 actsFourPos(position(0), position(1), position(2), 10 * Acts::UnitConstants::ns);
-      Acts::BoundSquareMatrix cov = setDefaultCovariance();
+    Acts::Vector4 actsFourPos(position(0), position(1), position(2), 10 * Acts::UnitConstants::ns);
+    Acts::BoundSquareMatrix cov = setDefaultCovariance();
 
-      int charge = tpcseed->get_charge();
+    int charge = tpcseed->get_charge();
 
-      /// Reset the track seed with the dummy covariance
-      auto seed = ActsTrackFittingAlgorithm::TrackParameters::create(
-                      m_transient_geocontext,
-                      pSurface,
-                      actsFourPos,
-                      momentum,
-                      charge / momentum.norm(),
-                      cov,
-                      Acts::ParticleHypothesis::pion())
-                      .value();
+    /// Reset the track seed with the dummy covariance
+    auto seed = ActsTrackFittingAlgorithm::TrackParameters::create(
+                    geoContext,
+                    pSurface,
+                    actsFourPos,
+                    momentum,
+                    charge / momentum.norm(),
+                    cov,
+                    Acts::ParticleHypothesis::pion())
+                    .value();
 
-      if (Verbosity() > 2)
-      {
-        printTrackSeed(seed);
-      }
+    if (Verbosity() > 2)
+    {
+      printTrackSeed(seed, geoContext);
+    }
 
-      /// Set host of propagator options for Acts to do e.g. material integration
-      auto calibptr = std::make_unique<Calibrator>();
-      CalibratorAdapter calibrator{*calibptr, measurements};
+    /// Set host of propagator options for Acts to do e.g. material integration
+    CalibratorAdapter calibrator{context.calibrator, measurements};
 
-      auto magcontext = m_tGeometry->geometry().magFieldContext;
-      auto calibcontext = m_tGeometry->geometry().calibContext;
-      auto ppPlainOptions = Acts::PropagatorPlainOptions(m_transient_geocontext, magcontext);
+    const auto& magcontext = m_tGeometry->geometry().magFieldContext;
+    const auto& calibcontext = m_tGeometry->geometry().calibContext;
+    auto ppPlainOptions = Acts::PropagatorPlainOptions(geoContext, magcontext);
 
-      ActsTrackFittingAlgorithm::GeneralFitterOptions
-          kfOptions{
-              m_transient_geocontext,
-              magcontext,
-              calibcontext,
-              pSurface.get(),
-              ppPlainOptions};
+    ActsTrackFittingAlgorithm::GeneralFitterOptions
+        kfOptions{
+            geoContext,
+            magcontext,
+            calibcontext,
+            pSurface.get(),
+            ppPlainOptions};
 
-      PHTimer fitTimer("FitTimer");
-      fitTimer.stop();
-      fitTimer.restart();
+    PHTimer fitTimer("FitTimer");
+    fitTimer.stop();
+    fitTimer.restart();
 
-      auto trackContainer = std::make_shared<Acts::VectorTrackContainer>();
-      auto trackStateContainer = std::make_shared<Acts::VectorMultiTrajectory>();
-      ActsTrackFittingAlgorithm::TrackContainer tracks(trackContainer, trackStateContainer);
+    // reuse the storage of the previous fits of this context
+    context.trackContainer->clear();
+    context.trackStateContainer->clear();
+    ActsTrackFittingAlgorithm::TrackContainer tracks(context.trackContainer, context.trackStateContainer);
 
-      if (Verbosity() > 1)
-      {
-        std::cout << "Calling fitTrack for track with siid " << siid << " tpcid " << tpcid << " crossing " << crossing << std::endl;
-        std::cout << "surfaces size " << surfaces.size() << " and source links size " << sourceLinks.size() << std::endl;
-      }
+    if (Verbosity() > 1)
+    {
+      std::cout << "Calling fitTrack for track with siid " << siid << " tpcid " << tpcid << " crossing " << crossing << std::endl;
+      std::cout << "surfaces size " << surfaces.size() << " and source links size " << sourceLinks.size() << std::endl;
+    }
 
-      auto result = fitTrack(sourceLinks, seed, kfOptions, surfaces, calibrator, tracks);
-      fitTimer.stop();
+    auto result = fitTrack(sourceLinks, seed, kfOptions, surfaces, calibrator, tracks);
+    fitTimer.stop();
 
-      if (Verbosity() > 1)
-      {
-        const auto fitTime = fitTimer.get_accumulated_time();
-        std::cout << "PHActsTrkFitter Acts fit time " << fitTime << std::endl;
-      }
+    if (Verbosity() > 1)
+    {
+      const auto fitTime = fitTimer.get_accumulated_time();
+      std::cout << "PHActsTrkFitter Acts fit time " << fitTime << std::endl;
+    }
 
-      /// Check that the track fit result did not return an error
-      if (result.ok())
+    /// Check that the track fit result did not return an error
+    if (result.ok())
+    {
+      if (use_estimate)  // trial variation case
       {
-        if (use_estimate)  // trial variation case
-        {
-          // this is a trial variation of the crossing estimate for this track
-          // Capture the chisq/ndf so we can choose the best one after all trials
+        // this is a trial variation of the crossing estimate for this track
+        // Capture the chisq/ndf so we can choose the best one after all trials
 
-          SvtxTrack_v4 newTrack;
-          newTrack.set_tpc_seed(tpcseed);
-          newTrack.set_crossing(this_crossing);
-          newTrack.set_silicon_seed(siseed);
+        SvtxTrack_v4 newTrack;
+        newTrack.set_tpc_seed(tpcseed);
+        newTrack.set_crossing(this_crossing);
+        newTrack.set_silicon_seed(siseed);
 
-          if (getTrackFitResult(result, track, &newTrack, tracks, measurements))
+        if (getTrackFitResult(result, track, &newTrack, tracks, measurements, geoContext))
+        {
+          float chi2ndf = newTrack.get_quality();
+          chisq_ndf.push_back(chi2ndf);
+          svtx_vec.push_back(newTrack);
+          if (Verbosity() > 1)
           {
-            float chi2ndf = newTrack.get_quality();
-            chisq_ndf.push_back(chi2ndf);
-            svtx_vec.push_back(newTrack);
-            if (Verbosity() > 1)
-            {
-              std::cout << "   tpcid " << tpcid << " siid " << siid << " ivary " << ivary << " this_crossing " << this_crossing << " chi2ndf " << chi2ndf << std::endl;
-            }
+            std::cout << "   tpcid " << tpcid << " siid " << siid << " ivary " << ivary << " this_crossing " << this_crossing << " chi2ndf " << chi2ndf << std::endl;
           }
+        }
 
-          if (ivary != nvary)
+        if (ivary != nvary)
+        {
+          if (Verbosity() > 3)
           {
-            if (Verbosity() > 3)
-            {
-              std::cout << "Skipping track fit for trial variation" << std::endl;
-            }
-            continue;
+            std::cout << "Skipping track fit for trial variation" << std::endl;
           }
+          continue;
+        }
 
-          // if we are here this is the last crossing iteration, evaluate the results
-          if (Verbosity() > 1)
+        // if we are here this is the last crossing iteration, evaluate the results
+        if (Verbosity() > 1)
+        {
+          std::cout << "Finished with trial fits, chisq_ndf size is " << chisq_ndf.size() << " chisq_ndf values are:" << std::endl;
+        }
+        float best_chisq = 1000.0;
+        short int best_ivary = 0;
+        for (unsigned int i = 0; i < chisq_ndf.size(); ++i)
+        {
+          if (chisq_ndf[i] < best_chisq)
           {
-            std::cout << "Finished with trial fits, chisq_ndf size is " << chisq_ndf.size() << " chisq_ndf values are:" << std::endl;
+            best_chisq = chisq_ndf[i];
+            best_ivary = i;
           }
-          float best_chisq = 1000.0;
-          short int best_ivary = 0;
-          for (unsigned int i = 0; i < chisq_ndf.size(); ++i)
+          if (Verbosity() > 1)
           {
-            if (chisq_ndf[i] < best_chisq)
-            {
-              best_chisq = chisq_ndf[i];
-              best_ivary = i;
-            }
-            if (Verbosity() > 1)
-            {
-              std::cout << "  trial " << i << " chisq_ndf " << chisq_ndf[i] << " best_chisq " << best_chisq << " best_ivary " << best_ivary << std::endl;
-            }
+            std::cout << "  trial " << i << " chisq_ndf " << chisq_ndf[i] << " best_chisq " << best_chisq << " best_ivary " << best_ivary << std::endl;
           }
-          unsigned int trid = m_trackMap->size();
-          svtx_vec[best_ivary].set_id(trid);
-
-          m_trackMap->insertWithKey(&svtx_vec[best_ivary], trid);
         }
-        else  // case where crossing is known
-        {
-          SvtxTrack_v4 newTrack;
-          newTrack.set_tpc_seed(tpcseed);
-          newTrack.set_crossing(this_crossing);
-          newTrack.set_silicon_seed(siseed);
-
-          if (m_fitSiliconMMs)
-          {
-            unsigned int trid = m_directedTrackMap->size();
-            newTrack.set_id(trid);
-
-            if (getTrackFitResult(result, track, &newTrack, tracks, measurements))
-            {
-              // insert in dedicated map
-              m_directedTrackMap->insertWithKey(&newTrack, trid);
-            }
-
-          }  // end insert track for SC calib fit
-          else
-          {
-            unsigned int trid = m_trackMap->size();
-            newTrack.set_id(trid);
-
-            if (getTrackFitResult(result, track, &newTrack, tracks, measurements))
-            {
-              m_trackMap->insertWithKey(&newTrack, trid);
-            }
-          }  // end insert track for normal fit
-        }  // end case where crossing is known
+        output.tracks.push_back(svtx_vec[best_ivary]);
       }
-      else if (!m_fitSiliconMMs)
+      else  // case where crossing is known
       {
-        /// Track fit failed, get rid of the track from the map
-        m_nBadFits++;
-        if (Verbosity() > 1)
+        SvtxTrack_v4 newTrack;
+        newTrack.set_tpc_seed(tpcseed);
+        newTrack.set_crossing(this_crossing);
+        newTrack.set_silicon_seed(siseed);
+
+        // tracks for SC calib fit go to a dedicated map
+        // the id is the final one when seeds are fitted in sequence, otherwise it is updated on insertion
+        const auto* trackMap = m_fitSiliconMMs ? m_directedTrackMap : m_trackMap;
+        newTrack.set_id(trackMap->size());
+
+        if (getTrackFitResult(result, track, &newTrack, tracks, measurements, geoContext))
         {
-          std::cout << "Track fit failed for track " << m_seedMap->find(track)
-                    << " with Acts error message "
-                    << result.error() << ", " << result.error().message()
-                    << std::endl;
+          output.tracks.push_back(newTrack);
         }
-      }  // end fit failed case
-    }  // end ivary loop
+      }  // end case where crossing is known
+    }
+    else if (!m_fitSiliconMMs)
+    {
+      /// Track fit failed, get rid of the track from the map
+      ++output.nBadFits;
+      if (Verbosity() > 1)
+      {
+        std::cout << "Track fit failed for track " << iseed
+                  << " with Acts error message "
+                  << result.error() << ", " << result.error().message()
+                  << std::endl;
+      }
+    }  // end fit failed case
+  }  // end ivary loop
 
-    trackTimer.stop();
-    auto trackTime = trackTimer.get_accumulated_time();
+  trackTimer.stop();
+  auto trackTime = trackTimer.get_accumulated_time();
 
-    if (Verbosity() > 1)
-    {
-      std::cout << "PHActsTrkFitter total single track time " << trackTime << std::endl;
-    }
+  if (Verbosity() > 1)
+  {
+    std::cout << "PHActsTrkFitter total single track time " << trackTime << std::endl;
   }
-
-  return;
 }
 
 bool PHActsTrkFitter::getTrackFitResult(
     const FitResult& fitOutput,
     TrackSeed* seed, SvtxTrack* track,
     const ActsTrackFittingAlgorithm::TrackContainer& tracks,
-    const ActsTrackFittingAlgorithm::MeasurementContainer& measurements)
+    const ActsTrackFittingAlgorithm::MeasurementContainer& measurements,
+    const Acts::GeometryContext& geoContext)
 {
   /// Make a trajectory state for storage, which conforms to Acts track fit
   /// analysis tool
@@ -1059,7 +1201,7 @@ bool PHActsTrkFitter::getTrackFitResult(
     if (Verbosity() > 2)
     {
       std::cout << "Fitted parameters for track" << std::endl;
-      std::cout << " position : " << outtrack.referenceSurface().localToGlobal(m_transient_geocontext, Acts::Vector2(outtrack.loc0(), outtrack.loc1()), Acts::Vector3(1, 1, 1)).transpose()
+      std::cout << " position : " << outtrack.referenceSurface().localToGlobal(geoContext, Acts::Vector2(outtrack.loc0(), outtrack.loc1()), Acts::Vector3(1, 1, 1)).transpose()
 
                 << std::endl;
       int otcharge = outtrack.qOverP() > 0 ? 1 : -1;
@@ -1074,7 +1216,7 @@ bool PHActsTrkFitter::getTrackFitResult(
     PHTimer updateTrackTimer("UpdateTrackTimer");
     updateTrackTimer.stop();
     updateTrackTimer.restart();
-    updateSvtxTrack(trackTips, indexedParams, tracks, track);
+    updateSvtxTrack(trackTips, indexedParams, tracks, track, geoContext);
 
     if (m_commissioning)
     {
@@ -1256,7 +1398,8 @@ void PHActsTrkFitter::updateSvtxTrack(
     const std::vector<Acts::TrackIndexType>& tips,
     const Trajectory::IndexedParameters& paramsMap,
     const ActsTrackFittingAlgorithm::TrackContainer& tracks,
-    SvtxTrack* track)
+    SvtxTrack* track,
+    const Acts::GeometryContext& geoContext)
 {
   const auto& mj = tracks.trackStateContainer();
 
@@ -1289,9 +1432,9 @@ void PHActsTrkFitter::updateSvtxTrack(
   const auto& params = paramsMap.find(trackTip)->second;
 
   /// Acts default unit is mm. So convert to cm
-  track->set_x(params.position(m_transient_geocontext)(0) / Acts::UnitConstants::cm);
-  track->set_y(params.position(m_transient_geocontext)(1) / Acts::UnitConstants::cm);
-  track->set_z(params.position(m_transient_geocontext)(2) / Acts::UnitConstants::cm);
+  track->set_x(params.position(geoContext)(0) / Acts::UnitConstants::cm);
+  track->set_y(params.position(geoContext)(1) / Acts::UnitConstants::cm);
+  track->set_z(params.position(geoContext)(2) / Acts::UnitConstants::cm);
 
   auto* seed = track->get_tpc_seed();
 
@@ -1336,7 +1479,7 @@ void PHActsTrkFitter::updateSvtxTrack(
 
   if (m_fillSvtxTrackStates)
   {
-    transformer.fillSvtxTrackStates(mj, trackTip, track, m_transient_geocontext);
+    transformer.fillSvtxTrackStates(mj, trackTip, track, geoContext);
   }
 
   // in using silicon mm fit also extrapolate track parameters to all TPC surfaces with clusters
@@ -1369,7 +1512,7 @@ void PHActsTrkFitter::updateSvtxTrack(
         if( result.ok() )
         {
           const auto& [pathLength, trackStateParams] = result.value();
-          transformer.addTrackState(track, cluskey, (source_pathlength+pathLength)/Acts::UnitConstants::cm, trackStateParams, m_transient_geocontext);
+          transformer.addTrackState(track, cluskey, (source_pathlength+pathLength)/Acts::UnitConstants::cm, trackStateParams, geoContext);
         }
       };
 
@@ -1416,7 +1559,7 @@ void PHActsTrkFitter::updateSvtxTrack(
               const auto averaged_param = calculateAverageParameters( result_forward.value().second, result_backward.value().second );
 
               // assign
-              transformer.addTrackState(track, cluskey, pathlength/Acts::UnitConstants::cm, averaged_param, m_transient_geocontext);
+              transformer.addTrackState(track, cluskey, pathlength/Acts::UnitConstants::cm, averaged_param, geoContext);
             }
 
           } else if( nearest_params_forward ) {
@@ -1474,7 +1617,7 @@ void PHActsTrkFitter::updateSvtxTrack(
         if( result.ok() )
         {
           const auto& [pathLength, trackStateParams] = result.value();
-          transformer.addTrackState(track, cluskey, (source_pathlength+pathLength)/Acts::UnitConstants::cm, trackStateParams, m_transient_geocontext);
+          transformer.addTrackState(track, cluskey, (source_pathlength+pathLength)/Acts::UnitConstants::cm, trackStateParams, geoContext);
         }
       };
 
@@ -1583,7 +1726,7 @@ Acts::BoundSquareMatrix PHActsTrkFitter::setDefaultCovariance() const
   return cov;
 }
 
-void PHActsTrkFitter::printTrackSeed(const ActsTrackFittingAlgorithm::TrackParameters& seed) const
+void PHActsTrkFitter::printTrackSeed(const ActsTrackFittingAlgorithm::TrackParameters& seed, const Acts::GeometryContext& geoContext) const
 {
   std::cout
       << PHWHERE
@@ -1591,7 +1734,7 @@ void PHActsTrkFitter::printTrackSeed(const ActsTrackFittingAlgorithm::TrackParam
       << std::endl;
 
   std::cout
-      << "position: " << seed.position(m_transient_geocontext).transpose()
+      << "position: " << seed.position(geoContext).transpose()
       << std::endl
       << "momentum: " << seed.momentum().transpose()
       << std::endl;
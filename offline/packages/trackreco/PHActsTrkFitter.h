@@ -29,8 +29,10 @@
 #include <TFile.h>
 #include <TH1.h>
 #include <TH2.h>
+#include <cstddef>
 #include <memory>
 #include <string>
+#include <vector>
 
 class alignmentTransformationContainer;
 class ActsGeometry;
@@ -56,7 +58,7 @@ class PHActsTrkFitter : public SubsysReco
   PHActsTrkFitter(const std::string& name = "PHActsTrkFitter");
 
   /// Destructor
-  ~PHActsTrkFitter() override = default;
+  ~PHActsTrkFitter() override;
 
   /// End, write and close files
   int End(PHCompositeNode* topNode) override;
@@ -157,6 +159,12 @@ class PHActsTrkFitter : public SubsysReco
   void setDirectNavigation(bool flag) { m_directNavigation = flag; }
   void setClusterEdgeRejection(int edge ) { m_cluster_edge_rejection = edge; }
 
+  /// fit seeds in parallel on the Fun4All task scheduler (see Fun4AllServer::SetNumThreads).
+  /// Seeds sharing TPC clusters are fitted in sequence and tracks are inserted in seed order,
+  /// so that the output does not depend on the number of threads.
+  /// Fits are sequential anyway with the evaluator, the outlier finder, commissioning, time analysis or without cluster mover
+  void setParallelFit(bool value) { m_parallelFit = value; }
+
   /// extrapolation mode
   enum class ExtrapolationMode
   {
@@ -177,14 +185,33 @@ class PHActsTrkFitter : public SubsysReco
   /// Create new nodes
   int createNodes(PHCompositeNode* topNode);
 
+  /// per thread fit state, reused for all the seeds fitted by the thread
+  struct FitContext;
+
+  /// tracks fitted from one seed
+  struct SeedFitOutput;
+
   void loopTracks(Acts::Logging::Level logLevel);
 
+  /// true if seeds can be fitted concurrently with the current configuration
+  bool canFitInParallel() const;
+
+  /// groups of seeds sharing TPC clusters, in seed order. The cluster mover updates the surface of these clusters
+  std::vector<std::vector<std::size_t>> groupSeeds() const;
+
+  /// fit one seed, with all the crossing variations if needed
+  void fitSeed(std::size_t iseed, FitContext& context, SeedFitOutput& output);
+
+  /// insert the tracks fitted from one seed in the track map, and reset the output
+  void insertTracks(SeedFitOutput& output);
+
   /// Convert the acts track fit result to an svtx track
   void updateSvtxTrack(
       const std::vector<Acts::TrackIndexType>& tips,
       const Trajectory::IndexedParameters& paramsMap,
       const ActsTrackFittingAlgorithm::TrackContainer& tracks,
-      SvtxTrack* track);
+      SvtxTrack* track,
+      const Acts::GeometryContext& geoContext);
 
   /// Helper function to call either the regular navigation or direct
   /// navigation, depending on m_fitSiliconMMs
@@ -208,10 +235,11 @@ class PHActsTrkFitter : public SubsysReco
   bool getTrackFitResult(const FitResult& fitOutput, TrackSeed* seed,
                          SvtxTrack* track,
                          const ActsTrackFittingAlgorithm::TrackContainer& tracks,
-                         const ActsTrackFittingAlgorithm::MeasurementContainer& measurements);
+                         const ActsTrackFittingAlgorithm::MeasurementContainer& measurements,
+                         const Acts::GeometryContext& geoContext);
 
   Acts::BoundSquareMatrix setDefaultCovariance() const;
-  void printTrackSeed(const ActsTrackFittingAlgorithm::TrackParameters& seed) const;
+  void printTrackSeed(const ActsTrackFittingAlgorithm::TrackParameters& seed, const Acts::GeometryContext& geoContext) const;
 
   /// Event counter
   int m_event = 0;
@@ -226,7 +254,6 @@ class PHActsTrkFitter : public SubsysReco
   alignmentTransformationContainer* m_alignmentTransformationMap = nullptr;  // added for testing purposes
   alignmentTransformationContainer* m_alignmentTransformationMapTransient = nullptr;
   std::set<Acts::GeometryIdentifier> m_transient_id_set;
-  Acts::GeometryContext m_transient_geocontext = Acts::GeometryContext::dangerouslyDefaultConstruct();
   SvtxTrackMap* m_trackMap = nullptr;
   SvtxTrackMap* m_directedTrackMap = nullptr;
   TrkrClusterContainer* m_clusterContainer = nullptr;
@@ -298,6 +325,12 @@ class PHActsTrkFitter : public SubsysReco
 
   bool m_use_clustermover = true;
 
+  /// parallel fit of the seeds
+  bool m_parallelFit = true;
+
+  /// fit contexts, one per thread
+  std::vector<std::unique_ptr<FitContext>> m_fitContexts;
+
   std::string m_fieldMap;
 
   int _n_iteration = 0;
@@ -0,0 +1,262 @@
+/**
+ * @file trackreco/PHActsTrkFitterBenchmark.cc
+ * @brief compare the PHActsTrkFitter output and timing for different numbers of threads
+ *
+ * usage: PHActsTrkFitterBenchmark <input DST> <global tag> [events] [max threads]
+ *
+ * The track fit needs the full tracking geometry, so events are read from a DST with
+ * the geometry and the TPC geometry container on the run node, and the clusters and
+ * track seeds (SvtxTrackSeedContainer, TpcTrackSeedContainer, SiliconTrackSeedContainer)
+ * on the DST node, as written by the seeding stage of a tracking job.
+ * The run number used for the conditions DB is taken from the file name.
+ *
+ * Each event is fitted by a sequential fitter (setParallelFit(false)), which is the reference,
+ * then by parallel fitters, with 1, 2, 4 ... up to max threads (default is one per core).
+ * Every fitter writes its own track map. Tracks (parameters, covariance, states and seeds)
+ * must be identical to the reference, event by event.
+ */
+#include "MakeActsGeometry.h"
+#include "PHActsTrkFitter.h"
+
+#include <trackbase_historic/SvtxTrack.h>
+#include <trackbase_historic/SvtxTrackMap.h>
+#include <trackbase_historic/SvtxTrackState.h>
+
+#include <fun4all/Fun4AllDstInputManager.h>
+#include <fun4all/Fun4AllReturnCodes.h>
+#include <fun4all/Fun4AllServer.h>
+#include <fun4all/Fun4AllUtils.h>
+#include <fun4all/SubsysReco.h>
+
+#include <phool/PHCompositeNode.h>
+#include <phool/getClass.h>
+#include <phool/recoConsts.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+  // track map content, in map order
+  using Result = std::vector<double>;
+
+  Result get_result(PHCompositeNode* topNode, const std::string& track_map_name)
+  {
+    Result result;
+    auto* track_map = findNode::getClass<SvtxTrackMap>(topNode, track_map_name);
+    if (!track_map)
+    {
+      return result;
+    }
+
+    for (const auto& [key, track] : *track_map)
+    {
+      result.push_back(key);
+      result.push_back(track->get_crossing());
+      result.push_back(track->get_charge());
+      result.push_back(track->get_chisq());
+      result.push_back(track->get_ndf());
+      for (unsigned int i = 0; i < 3; ++i)
+      {
+        result.push_back(track->get_pos(i));
+        result.push_back(track->get_mom(i));
+      }
+      for (int i = 0; i < 6; ++i)
+      {
+        for (int j = 0; j < 6; ++j)
+        {
+          result.push_back(track->get_error(i, j));
+        }
+      }
+
+      // seeds are compared by address, they belong to the same seed containers for all fitters
+      result.push_back(static_cast<double>(reinterpret_cast<std::uintptr_t>(track->get_silicon_seed())));
+      result.push_back(static_cast<double>(reinterpret_cast<std::uintptr_t>(track->get_tpc_seed())));
+
+      result.push_back(track->size_states());
+      for (auto iter = track->begin_states(); iter != track->end_states(); ++iter)
+      {
+        const auto* state = iter->second;
+        result.push_back(iter->first);
+        result.push_back(state->get_cluskey());
+        for (unsigned int i = 0; i < 3; ++i)
+        {
+          result.push_back(state->get_pos(i));
+        }
+        result.push_back(state->get_px());
+        result.push_back(state->get_py());
+        result.push_back(state->get_pz());
+        for (unsigned int i = 0; i < 6; ++i)
+        {
+          for (unsigned int j = 0; j < 6; ++j)
+          {
+            result.push_back(state->get_error(i, j));
+          }
+        }
+      }
+    }
+    return result;
+  }
+
+  // runs the fitters one after the other on each event, with their own number of threads
+  class FitterComparison : public SubsysReco
+  {
+   public:
+    explicit FitterComparison(unsigned int max_threads)
+      : SubsysReco("FitterComparison")
+    {
+      add_fitter(0);
+      for (unsigned int nthreads = 1; nthreads < max_threads; nthreads *= 2)
+      {
+        add_fitter(nthreads);
+      }
+      add_fitter(max_threads);
+    }
+
+    int InitRun(PHCompositeNode* topNode) override
+    {
+      for (auto& fitter : m_fitters)
+      {
+        const int iret = fitter.fitter->InitRun(topNode);
+        if (iret != Fun4AllReturnCodes::EVENT_OK)
+        {
+          return iret;
+        }
+      }
+      return Fun4AllReturnCodes::EVENT_OK;
+    }
+
+    int process_event(PHCompositeNode* topNode) override
+    {
+      Fun4AllServer* se = Fun4AllServer::instance();
+      Result reference;
+      for (auto& fitter : m_fitters)
+      {
+        se->SetNumThreads(std::max(1U, fitter.nthreads));
+
+        const auto start = std::chrono::high_resolution_clock::now();
+        fitter.fitter->process_event(topNode);
+        fitter.time += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+        auto result = get_result(topNode, fitter.track_map_name);
+        if (fitter.nthreads == 0)
+        {
+          if (auto* track_map = findNode::getClass<SvtxTrackMap>(topNode, fitter.track_map_name))
+          {
+            m_ntracks += track_map->size();
+          }
+          reference = std::move(result);
+        }
+        else if (result != reference)
+        {
+          std::cout << "FitterComparison - event " << m_nevents << ": " << fitter.nthreads
+                    << " threads output differs from the sequential fit" << std::endl;
+          ++fitter.mismatches;
+        }
+      }
+      ++m_nevents;
+      return Fun4AllReturnCodes::EVENT_OK;
+    }
+
+    int End(PHCompositeNode* topNode) override
+    {
+      for (auto& fitter : m_fitters)
+      {
+        fitter.fitter->End(topNode);
+      }
+      return Fun4AllReturnCodes::EVENT_OK;
+    }
+
+    //! print timing and return the number of events with a different output
+    int summary() const
+    {
+      std::cout << "PHActsTrkFitterBenchmark - " << m_nevents << " events, " << m_ntracks << " tracks, times in ms per event" << std::endl;
+      int mismatches = 0;
+      const double reference_time = m_fitters.front().time;
+      for (const auto& fitter : m_fitters)
+      {
+        const double time = m_nevents ? fitter.time / m_nevents : 0;
+        std::cout << "  " << (fitter.nthreads ? std::to_string(fitter.nthreads) + " threads" : std::string("sequential"))
+                  << " time: " << time
+                  << " speedup: " << (fitter.time > 0 ? reference_time / fitter.time : 0)
+                  << " mismatches: " << fitter.mismatches << std::endl;
+        mismatches += fitter.mismatches;
+      }
+      return mismatches;
+    }
+
+   private:
+    struct Fitter
+    {
+      //! 0 for the sequential reference
+      unsigned int nthreads = 0;
+      std::string track_map_name;
+      std::unique_ptr<PHActsTrkFitter> fitter;
+      double time = 0;
+      int mismatches = 0;
+    };
+
+    void add_fitter(unsigned int nthreads)
+    {
+      Fitter fitter;
+      fitter.nthreads = nthreads;
+      fitter.track_map_name = nthreads ? "SvtxTrackMap_" + std::to_string(nthreads) + "threads" : "SvtxTrackMap_sequential";
+      fitter.fitter = std::make_unique<PHActsTrkFitter>("PHActsTrkFitter_" + fitter.track_map_name);
+      fitter.fitter->set_track_map_name(fitter.track_map_name);
+      fitter.fitter->setParallelFit(nthreads > 0);
+      m_fitters.push_back(std::move(fitter));
+    }
+
+    std::vector<Fitter> m_fitters;
+    int m_nevents = 0;
+    std::size_t m_ntracks = 0;
+  };
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  if (argc < 3)
+  {
+    std::cout << "usage: PHActsTrkFitterBenchmark <input DST> <global tag> [events] [max threads]" << std::endl;
+    return 1;
+  }
+  const std::string filename = argv[1];
+  const int nevents = (argc > 3) ? std::stoi(argv[3]) : 10;
+  const unsigned int max_threads = (argc > 4) ? std::stoul(argv[4]) : std::max(1U, std::thread::hardware_concurrency());
+
+  recoConsts* rc = recoConsts::instance();
+  rc->set_StringFlag("CDB_GLOBALTAG", argv[2]);
+  rc->set_uint64Flag("TIMESTAMP", Fun4AllUtils::GetRunSegment(filename).first);
+
+  Fun4AllServer* se = Fun4AllServer::instance();
+
+  auto* geometry = new MakeActsGeometry;
+  se->registerSubsystem(geometry);
+
+  auto* comparison = new FitterComparison(max_threads);
+  se->registerSubsystem(comparison);
+
+  auto* in = new Fun4AllDstInputManager("DSTin");
+  in->fileopen(filename);
+  se->registerInputManager(in);
+
+  se->run(nevents);
+  se->End();
+
+  const int mismatches = comparison->summary();
+  delete se;
+
+  if (mismatches > 0)
+  {
+    std::cout << "PHActsTrkFitterBenchmark - output depends on the number of threads" << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -93,8 +93,8 @@ class PHSimpleKFProp : public SubsysReco
   void set_ghost_y_cut(double d) { _ghost_y_cut = d; }
   void set_ghost_z_cut(double d) { _ghost_z_cut = d; }
 
-  // number of threads
-  void set_num_threads(int value) { m_num_threads = value; }
+  //! obsolete, sets the number of threads of the job with Fun4AllServer::SetNumThreads (0 means one per core)
+  void set_num_threads(int value);
 
  private:
   bool _use_truth_clusters = false;
@@ -240,15 +240,6 @@ class PHSimpleKFProp : public SubsysReco
   double _ghost_z_cut = std::numeric_limits<double>::max();
   //@}
 
-  //! number of threads
-  /**
-   * default is 0. This corresponds to allocating as many threads as available on the host
-   * on CONDOR, by default, this results in only one thread allocated
-   * being allocated unless several cores are allocated to the job
-   * via request_cpus directive in the jdf
-   */
-  int m_num_threads = 0;
-
 };
 
 #endif
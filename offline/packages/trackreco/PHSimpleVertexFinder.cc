@@ -24,16 +24,19 @@
 #include <Acts/Surfaces/PerigeeSurface.hpp>
 
 #include <cmath>  // for sqrt, fabs, atan2, cos
+#include <cstdint>
 #include <iomanip>
 #include <iostream>  // for operator<<, basic_ostream
-#include <map>       // for map
 #include <set>       // for _Rb_tree_const_iterator
 #include <utility>   // for pair, make_pair
 
 #include <algorithm>
 #include <cassert>
 #include <functional>
+#include <limits>
 #include <numeric>
+#include <queue>
+#include <string>
 #include <vector>
 
 #include <Eigen/Dense>
@@ -112,13 +115,11 @@ int PHSimpleVertexFinder::process_event(PHCompositeNode * /*topNode*/)
 
   for (auto cross : crossings)
   {
-    // reset maps for each crossing
-    _vertex_track_map.clear();
-    _track_pair_map.clear();
-    _track_pair_pca_map.clear();
-    _vertex_position_map.clear();
-    _vertex_covariance_map.clear();
-    _vertex_set.clear();
+    // reset containers for each crossing
+    _track_pairs.clear();
+    _vertex_tracks.clear();
+    _vertex_positions.clear();
+    _vertex_covariances.clear();
 
     if (Verbosity() > 0)
     {
@@ -140,7 +141,7 @@ int PHSimpleVertexFinder::process_event(PHCompositeNode * /*topNode*/)
     }
 
     // Find all instances where two tracks have a dca of < _dcacut,  and capture the pair details
-    // Fills _track_pair_map and _track_pair_pca_map
+    // Fills _track_pairs
     if(_zero_field)
       {
 	checkDCAsZF(crossing_tracks);
@@ -151,7 +152,7 @@ int PHSimpleVertexFinder::process_event(PHCompositeNode * /*topNode*/)
       }
 
     /// If we didn't find any matches, try again with a slightly larger DCA cut
-    if (_track_pair_map.empty())
+    if (_track_pairs.empty())
     {
       _active_dcacut = 3.0 * _base_dcacut;
       if(_zero_field)
@@ -166,11 +167,11 @@ int PHSimpleVertexFinder::process_event(PHCompositeNode * /*topNode*/)
     
     if (Verbosity() > 0)
     {
-      std::cout << "crossing " << cross << " track pair map size " << _track_pair_map.size() << std::endl;
+      std::cout << "crossing " << cross << " track pair map size " << _track_pairs.size() << std::endl;
     }
 
-    // get all connected pairs of tracks by looping over the track_pair map
-    std::vector<std::set<unsigned int>> connected_tracks = findConnectedTracks();
+    // get all connected pairs of tracks by looping over the track pairs
+    std::vector<std::vector<unsigned int>> connected_tracks = findConnectedTracks();
 
     // we want the biggest vertex first, sort the vector of connected track sets by size
     for (unsigned int ivtx = 0; ivtx < connected_tracks.size(); ++ivtx)
@@ -192,47 +193,30 @@ int PHSimpleVertexFinder::process_event(PHCompositeNode * /*topNode*/)
       }
     
     // make vertices - each set of connected tracks is a vertex
-    for (unsigned int ivtx = 0; ivtx < connected_tracks.size(); ++ivtx)
+    _vertex_tracks = std::move(connected_tracks);
+    if (Verbosity() > 0)
     {
-      if (Verbosity() > 0)
+      for (unsigned int ivtx = 0; ivtx < _vertex_tracks.size(); ++ivtx)
       {
         std::cout << "process vertex " << ivtx + vertex_id << std::endl;
-      }
-
-      for (auto it : connected_tracks[ivtx])
-      {
-        unsigned int id = it;
-        _vertex_track_map.insert(std::make_pair(ivtx, id));
-        if (Verbosity() > 0)
+        for (auto id : _vertex_tracks[ivtx])
         {
           std::cout << "  adding track " << id << " to vertex " << ivtx + vertex_id << std::endl;
         }
       }
     }
 
-    // make a list of vertices
-    for (auto it : _vertex_track_map)
-    {
-      if (Verbosity() > 1)
-      {
-        std::cout << " vertex " << it.first + vertex_id << " track " << it.second << std::endl;
-      }
-      _vertex_set.insert(it.first);
-    }
-
     // this finds average vertex positions after removal of outlying track pairs
     removeOutlierTrackPairs();
 
     // average covariance for accepted tracks
-    for (auto it : _vertex_set)
+    for (unsigned int it = 0; it < _vertex_tracks.size(); ++it)
     {
       matrix_t avgCov = matrix_t::Zero();
       double cov_wt = 0.0;
 
-      auto ret = _vertex_track_map.equal_range(it);
-      for (auto cit = ret.first; cit != ret.second; ++cit)
+      for (auto trid : _vertex_tracks[it])
       {
-        unsigned int trid = cit->second;
         matrix_t cov;
         auto *track = _track_map->get(trid);
         for (int i = 0; i < 3; ++i)
@@ -253,13 +237,13 @@ int PHSimpleVertexFinder::process_event(PHCompositeNode * /*topNode*/)
         std::cout << "Average covariance for vertex " << it << " is:" << std::endl;
         std::cout << std::setprecision(8) << avgCov << std::endl;
       }
-      _vertex_covariance_map.insert(std::make_pair(it, avgCov));
+      _vertex_covariances.push_back(avgCov);
     }
 
     // Write the vertices to the vertex map on the node tree
     //==============================================
 
-    for (auto it : _vertex_set)
+    for (unsigned int it = 0; it < _vertex_tracks.size(); ++it)
     {
       unsigned int thisid = it + vertex_id;  // the address of the vertex in the event
 
@@ -271,11 +255,8 @@ int PHSimpleVertexFinder::process_event(PHCompositeNode * /*topNode*/)
       svtxVertex->set_id(thisid);
       svtxVertex->set_beam_crossing(cross);
 
-      auto ret = _vertex_track_map.equal_range(it);
-      for (auto cit = ret.first; cit != ret.second; ++cit)
+      for (auto trid : _vertex_tracks[it])
       {
-        unsigned int trid = cit->second;
-
 	if (Verbosity() > 1)
         {
           std::cout << "   vertex " << thisid << " insert track " << trid << std::endl;
@@ -300,7 +281,7 @@ int PHSimpleVertexFinder::process_event(PHCompositeNode * /*topNode*/)
         _track_map->get(trid)->set_vertex_id(thisid);
       }
 
-      Eigen::Vector3d pos = _vertex_position_map.find(it)->second;
+      const Eigen::Vector3d &pos = _vertex_positions[it];
       svtxVertex->set_x(pos.x());
       svtxVertex->set_y(pos.y());
       svtxVertex->set_z(pos.z());
@@ -309,7 +290,7 @@ int PHSimpleVertexFinder::process_event(PHCompositeNode * /*topNode*/)
         std::cout << "   vertex " << thisid << " insert pos.x " << pos.x() << " pos.y " << pos.y() << " pos.z " << pos.z() << std::endl;
       }
 
-      auto vtxCov = _vertex_covariance_map.find(it)->second;
+      const auto &vtxCov = _vertex_covariances[it];
       for (int i = 0; i < 3; ++i)
       {
         for (int j = 0; j < 3; ++j)
@@ -321,7 +302,7 @@ int PHSimpleVertexFinder::process_event(PHCompositeNode * /*topNode*/)
       _svtx_vertex_map->insert(svtxVertex.release());
     }
 
-    vertex_id += _vertex_set.size();
+    vertex_id += _vertex_tracks.size();
 
     /// Iterate through the tracks and assign the closest vtx id to
     /// the track position for propagating back to the vtx. Catches any
@@ -346,9 +327,9 @@ int PHSimpleVertexFinder::process_event(PHCompositeNode * /*topNode*/)
       float maxdz = std::numeric_limits<float>::max();
       unsigned int newvtxid = std::numeric_limits<unsigned int>::max();
 
-      for (auto it : _vertex_set)
+      for (unsigned int it = 0; it < _vertex_tracks.size(); ++it)
       {
-        unsigned int thisid = it + vertex_id - _vertex_set.size();
+        unsigned int thisid = it + vertex_id - _vertex_tracks.size();
 
         if (Verbosity() > 1)
         {
@@ -506,51 +487,37 @@ int PHSimpleVertexFinder::GetNodes(PHCompositeNode *topNode)
 
 void PHSimpleVertexFinder::checkDCAs(SvtxTrackMap *track_map)
 {
-  // Loop over tracks and check for close DCA match with all other tracks
-  for (auto tr1_it = track_map->begin(); tr1_it != track_map->end(); ++tr1_it)
+  // the track selection only depends on the track, apply it once rather than for each pair
+  _track_lines.clear();
+  for (const auto &[id, track] : *track_map)
   {
-    auto id1 = tr1_it->first;
-    auto *tr1 = tr1_it->second;
-    if (tr1->get_quality() > _qual_cut)
+    if (track->get_quality() > _qual_cut)
     {
       continue;
     }
-    if (_require_mvtx && !passClusterRequirement(tr1, "MVTX"))
+    if (_require_mvtx && !passClusterRequirement(track, "MVTX"))
     {
       continue;
     }
-    if (_require_intt && !passClusterRequirement(tr1, "INTT"))
+    if (_require_intt && !passClusterRequirement(track, "INTT"))
     {
       continue;
     }
-
-    // look for close DCA matches with all other such tracks
-    for (auto tr2_it = std::next(tr1_it); tr2_it != track_map->end(); ++tr2_it)
+    if (track->get_pt() < _track_pt_cut)
     {
-      auto id2 = tr2_it->first;
-      auto *tr2 = tr2_it->second;
-      if (tr2->get_quality() > _qual_cut)
-      {
-        continue;
-      }
-      if (_require_mvtx && !passClusterRequirement(tr2, "MVTX"))
-      {
-        continue;
-      }
-      if (_require_intt && !passClusterRequirement(tr2, "INTT"))
-      {
-        continue;
-      }
-
-      // find DCA of these two tracks
-      if (Verbosity() > 3)
-      {
-        std::cout << "Check DCA for tracks " << id1 << " and  " << id2 << std::endl;
-      }
-
-      findDcaTwoTracks(tr1, tr2);
+      continue;
     }
+
+    // get the line equation for the track
+    TrackLine line;
+    line.id = id;
+    line.a = Eigen::Vector3d(track->get_x(), track->get_y(), track->get_z());
+    line.b = Eigen::Vector3d(track->get_px() / track->get_p(), track->get_py() / track->get_p(), track->get_pz() / track->get_p());
+    _track_lines.push_back(line);
   }
+
+  // look for close DCA matches between all such tracks
+  findTrackPairs();
 }
 
 void PHSimpleVertexFinder::checkDCAsZF(SvtxTrackMap *track_map)
@@ -660,55 +627,22 @@ void PHSimpleVertexFinder::checkDCAsZF(SvtxTrackMap *track_map)
     cumulative_fitpars_vec.push_back(fitpars);
   }
 
+  _track_lines.clear();
   for(unsigned int i1 = 0; i1 < cumulative_trackid_vec.size(); ++i1)
     {
-      if(cumulative_fitpars_vec[i1].empty()) { continue; }
-
-      for(unsigned int i2 = i1; i2 < cumulative_trackid_vec.size(); ++i2)
-	{
-	  if(cumulative_fitpars_vec[i2].empty()) { continue; }
-
-	  //  For straight line: fitpars[4] = { xyslope, y0, xzslope, z0 }
-	  Eigen::Vector3d a1(0.0, cumulative_fitpars_vec[i1][1],cumulative_fitpars_vec[i1][3]);      // point on track 1 at x = 0
-	  Eigen::Vector3d a2(0.0, cumulative_fitpars_vec[i2][1],cumulative_fitpars_vec[i2][3]);      // point on track 2 at x = 0
-	  // direction vectors made from dy/dx = xyslope and dz/dx = xzslope
-	  Eigen::Vector3d b1(1.0, cumulative_fitpars_vec[i1][0],cumulative_fitpars_vec[i1][2]);      // direction vector of track 1
-	  Eigen::Vector3d b2(1.0, cumulative_fitpars_vec[i2][0],cumulative_fitpars_vec[i2][2]);      // direction vector of track 2
-	  	  
-	  Eigen::Vector3d PCA1(0, 0, 0);
-	  Eigen::Vector3d PCA2(0, 0, 0);
-	  double dca = dcaTwoLines(a1, b1, a2, b2, PCA1, PCA2);
-
-
-	  // check dca cut is satisfied, and that PCA is close to beam line
-	  if (fabs(dca) < _active_dcacut
-	      && (PCA1.x() > _beamline_x_cut_lo && PCA1.x() < _beamline_x_cut_hi)
-	      && (PCA1.y() > _beamline_y_cut_lo && PCA1.y() < _beamline_y_cut_hi)
-	      && (PCA2.x() > _beamline_x_cut_lo && PCA2.x() < _beamline_x_cut_hi)
-	      && (PCA2.y() > _beamline_y_cut_lo && PCA2.y() < _beamline_y_cut_hi)
-	      )
-	    {
-	      int id1 = cumulative_trackid_vec[i1];
-	      int id2 = cumulative_trackid_vec[i2];
-
-	      if (Verbosity() > 3)
-		{
-		  std::cout << " good match for tracks " << id1 << " and " << id2 << std::endl;
-		  std::cout << "    a1.x " << a1.x() << " a1.y " << a1.y() << " a1.z " << a1.z() << std::endl;
-		  std::cout << "    a2.x  " << a2.x() << " a2.y " << a2.y() << " a2.z " << a2.z() << std::endl;
-		  std::cout << "    PCA1.x() " << PCA1.x() << " PCA1.y " << PCA1.y() << " PCA1.z " << PCA1.z() << std::endl;
-		  std::cout << "    PCA2.x() " << PCA2.x() << " PCA2.y " << PCA2.y() << " PCA2.z " << PCA2.z() << std::endl;
-		  std::cout << "    dca " << dca << std::endl;
-		}
-	      
-	      // capture the results for successful matches
-	      _track_pair_map.insert(std::make_pair(id1, std::make_pair(id2, dca)));
-	      _track_pair_pca_map.insert(std::make_pair(id1, std::make_pair(id2, std::make_pair(PCA1, PCA2))));
-	    }	  	  
-	}
+      const auto& fitpars = cumulative_fitpars_vec[i1];
+      if(fitpars.empty()) { continue; }
+
+      //  For straight line: fitpars[4] = { xyslope, y0, xzslope, z0 }
+      TrackLine line;
+      line.id = cumulative_trackid_vec[i1];
+      line.a = Eigen::Vector3d(0.0, fitpars[1], fitpars[3]);      // point on track at x = 0
+      // direction vector made from dy/dx = xyslope and dz/dx = xzslope
+      line.b = Eigen::Vector3d(1.0, fitpars[0], fitpars[2]);
+      _track_lines.push_back(line);
     }
 
-  return; 
+  findTrackPairs();
 }
 
 void PHSimpleVertexFinder::getTrackletClusterList(TrackSeed* tracklet, std::vector<TrkrDefs::cluskey>& cluskey_vec)
@@ -751,78 +685,130 @@ void PHSimpleVertexFinder::getTrackletClusterList(TrackSeed* tracklet, std::vect
   }  // end loop over clusters for this track
 }
 
-void PHSimpleVertexFinder::checkDCAs()
+void PHSimpleVertexFinder::findTrackPairs()
 {
-  // Loop over tracks and check for close DCA match with all other tracks
-  for (auto tr1_it = _track_map->begin(); tr1_it != _track_map->end(); ++tr1_it)
+  if (!_fast_pairing)
   {
-    auto id1 = tr1_it->first;
-    auto *tr1 = tr1_it->second;
-    if (tr1->get_quality() > _qual_cut)
+    for (auto line1 = _track_lines.begin(); line1 != _track_lines.end(); ++line1)
     {
-      continue;
+      for (auto line2 = std::next(line1); line2 != _track_lines.end(); ++line2)
+      {
+        findDcaTwoTracks(*line1, *line2);
+      }
     }
-    if (_require_mvtx && !passClusterRequirement(tr1, "MVTX"))
+    return;
+  }
+
+  // Both points of closest approach of an accepted pair are inside the beam spot box,
+  // and they are no more than the dca apart. So only the lines which cross the box
+  // at z values closer than the dca cut can pair up.
+  // Lines are sorted by the start of their z range, and each of them is tested against
+  // the next ones, until they start beyond its z range.
+  struct ZRange
+  {
+    double zmin = 0;
+    double zmax = 0;
+    unsigned int index = 0;
+  };
+
+  std::vector<ZRange> ranges;
+  ranges.reserve(_track_lines.size());
+  for (unsigned int index = 0; index < _track_lines.size(); ++index)
+  {
+    ZRange range;
+    range.index = index;
+    if (zRangeInBeamSpot(_track_lines[index], range.zmin, range.zmax))
     {
-      continue;
+      ranges.push_back(range);
     }
-    if (_require_intt && !passClusterRequirement(tr1, "INTT"))
+  }
+  std::sort(ranges.begin(), ranges.end(), [](const ZRange &lhs, const ZRange &rhs)
+            { return lhs.zmin < rhs.zmin; });
+
+  // candidate pairs, as (first line index, second line index) in the upper and lower 32 bits
+  std::vector<uint64_t> candidates;
+  const double zcut = _active_dcacut + _pairing_margin;
+  for (auto range1 = ranges.begin(); range1 != ranges.end(); ++range1)
+  {
+    for (auto range2 = std::next(range1); range2 != ranges.end() && range2->zmin <= range1->zmax + zcut; ++range2)
     {
-      continue;
+      const uint64_t index1 = std::min(range1->index, range2->index);
+      const uint64_t index2 = std::max(range1->index, range2->index);
+      candidates.push_back((index1 << 32U) | index2);
     }
+  }
+
+  // test them in the order of the all pairs loop, so that pairs are stored in the same order
+  std::sort(candidates.begin(), candidates.end());
+  for (const auto candidate : candidates)
+  {
+    findDcaTwoTracks(_track_lines[candidate >> 32U], _track_lines[candidate & 0xFFFFFFFFU]);
+  }
+}
 
-    // look for close DCA matches with all other such tracks
-    for (auto tr2_it = std::next(tr1_it); tr2_it != _track_map->end(); ++tr2_it)
+bool PHSimpleVertexFinder::zRangeInBeamSpot(const TrackLine &line, double &zmin, double &zmax) const
+{
+  // lines with undefined parameters never pass the dca cut
+  if (!line.a.allFinite() || !line.b.allFinite())
+  {
+    return false;
+  }
+
+  // range of the line parameter for which the line is inside the beam spot box
+  // the box is extended by a margin, to cover the rounding of the points of closest approach
+  double tmin = -std::numeric_limits<double>::infinity();
+  double tmax = std::numeric_limits<double>::infinity();
+  const auto clip = [&tmin, &tmax](double a, double b, double lo, double hi)
+  {
+    if (b == 0)
     {
-      auto id2 = tr2_it->first;
-      auto *tr2 = tr2_it->second;
-      if (tr2->get_quality() > _qual_cut)
-      {
-        continue;
-      }
-      if (_require_mvtx && !passClusterRequirement(tr2, "MVTX"))
-      {
-        continue;
-      }
-      if (_require_intt && !passClusterRequirement(tr2, "INTT"))
-      {
-        continue;
-      }
-      // find DCA of these two tracks
-      if (Verbosity() > 3)
+      if (a < lo || a > hi)
       {
-        std::cout << "Check DCA for tracks " << id1 << " and  " << id2 << std::endl;
+        // parallel to the box side, and outside of it
+        tmin = std::numeric_limits<double>::infinity();
+        tmax = -std::numeric_limits<double>::infinity();
       }
-
-      findDcaTwoTracks(tr1, tr2);
+      return;
     }
+    const double t1 = (lo - a) / b;
+    const double t2 = (hi - a) / b;
+    tmin = std::max(tmin, std::min(t1, t2));
+    tmax = std::min(tmax, std::max(t1, t2));
+  };
+  clip(line.a.x(), line.b.x(), _beamline_x_cut_lo - _pairing_margin, _beamline_x_cut_hi + _pairing_margin);
+  clip(line.a.y(), line.b.y(), _beamline_y_cut_lo - _pairing_margin, _beamline_y_cut_hi + _pairing_margin);
+  if (tmin > tmax)
+  {
+    return false;
   }
-}
 
-void PHSimpleVertexFinder::findDcaTwoTracks(SvtxTrack *tr1, SvtxTrack *tr2)
-{
-  if (tr1->get_pt() < _track_pt_cut)
+  if (line.b.z() == 0)
   {
-    return;
+    zmin = zmax = line.a.z();
   }
-  if (tr2->get_pt() < _track_pt_cut)
+  else
   {
-    return;
+    const double z1 = line.a.z() + tmin * line.b.z();
+    const double z2 = line.a.z() + tmax * line.b.z();
+    zmin = std::min(z1, z2);
+    zmax = std::max(z1, z2);
   }
+  return true;
+}
 
-  unsigned int id1 = tr1->get_id();
-  unsigned int id2 = tr2->get_id();
-
-  // get the line equations for the tracks
+void PHSimpleVertexFinder::findDcaTwoTracks(const TrackLine &line1, const TrackLine &line2)
+{
+  if (Verbosity() > 3)
+  {
+    std::cout << "Check DCA for tracks " << line1.id << " and  " << line2.id << std::endl;
+  }
 
-  Eigen::Vector3d a1(tr1->get_x(), tr1->get_y(), tr1->get_z());
-  Eigen::Vector3d b1(tr1->get_px() / tr1->get_p(), tr1->get_py() / tr1->get_p(), tr1->get_pz() / tr1->get_p());
-  Eigen::Vector3d a2(tr2->get_x(), tr2->get_y(), tr2->get_z());
-  Eigen::Vector3d b2(tr2->get_px() / tr2->get_p(), tr2->get_py() / tr2->get_p(), tr2->get_pz() / tr2->get_p());
+  const Eigen::Vector3d &a1 = line1.a;
+  const Eigen::Vector3d &a2 = line2.a;
 
   Eigen::Vector3d PCA1(0, 0, 0);
   Eigen::Vector3d PCA2(0, 0, 0);
-  double dca = dcaTwoLines(a1, b1, a2, b2, PCA1, PCA2);
+  double dca = dcaTwoLines(a1, line1.b, a2, line2.b, PCA1, PCA2);
 
   if (Verbosity() > 3)
     {
@@ -840,7 +826,7 @@ void PHSimpleVertexFinder::findDcaTwoTracks(SvtxTrack *tr1, SvtxTrack *tr2)
     {
       if (Verbosity() > 3)
 	{
-	  std::cout << " good match for tracks " << tr1->get_id() << " and " << tr2->get_id() << " with pT " << tr1->get_pt() << " and " << tr2->get_pt() << std::endl;
+	  std::cout << " good match for tracks " << line1.id << " and " << line2.id << std::endl;
 	  std::cout << "    a1.x " << a1.x() << " a1.y " << a1.y() << " a1.z " << a1.z() << std::endl;
 	  std::cout << "    a2.x  " << a2.x() << " a2.y " << a2.y() << " a2.z " << a2.z() << std::endl;
 	  std::cout << "    PCA1.x() " << PCA1.x() << " PCA1.y " << PCA1.y() << " PCA1.z " << PCA1.z() << std::endl;
@@ -849,8 +835,7 @@ void PHSimpleVertexFinder::findDcaTwoTracks(SvtxTrack *tr1, SvtxTrack *tr2)
 	}
       
       // capture the results for successful matches
-      _track_pair_map.insert(std::make_pair(id1, std::make_pair(id2, dca)));
-      _track_pair_pca_map.insert(std::make_pair(id1, std::make_pair(id2, std::make_pair(PCA1, PCA2))));
+      _track_pairs.push_back({line1.id, line2.id, dca, PCA1, PCA2});
     }
   
   return;
@@ -916,127 +901,198 @@ double PHSimpleVertexFinder::dcaTwoLines(const Eigen::Vector3d &a1, const Eigen:
   return dca;
 }
 
-std::vector<std::set<unsigned int>> PHSimpleVertexFinder::findConnectedTracks()
+std::vector<std::vector<unsigned int>> PHSimpleVertexFinder::findConnectedTracks()
 {
-  std::vector<std::set<unsigned int>> connected_tracks;
-  std::set<unsigned int> connected;
-  std::set<unsigned int> used;
-  for (auto it : _track_pair_map)
+  // A pair of tracks which are both unused starts a new connected set, a pair with one
+  // used track adds to the current set. Each time, the pairs touching the set are then
+  // added in pair order, including those touching tracks added on the way.
+  // Tracks get a dense index, with the list of their pairs in pair order, so that the
+  // fast mode only visits the pairs touching the set, in the same order.
+  std::vector<unsigned int> ids;
+  ids.reserve(2 * _track_pairs.size());
+  for (const auto &pair : _track_pairs)
   {
-    unsigned int id1 = it.first;
-    unsigned int id2 = it.second.first;
-    double dca12 = it.second.second;
-    
-    if(Verbosity() > 2)
+    ids.push_back(pair.id1);
+    ids.push_back(pair.id2);
+  }
+  std::sort(ids.begin(), ids.end());
+  ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+  const auto index = [&ids](unsigned int id)
+  { return static_cast<unsigned int>(std::lower_bound(ids.begin(), ids.end(), id) - ids.begin()); };
+
+  const unsigned int npairs = _track_pairs.size();
+  std::vector<std::pair<unsigned int, unsigned int>> pair_tracks;
+  pair_tracks.reserve(npairs);
+  std::vector<unsigned int> first_pair(ids.size() + 1, 0);
+  for (const auto &pair : _track_pairs)
+  {
+    pair_tracks.emplace_back(index(pair.id1), index(pair.id2));
+    ++first_pair[pair_tracks.back().first + 1];
+    ++first_pair[pair_tracks.back().second + 1];
+  }
+  std::partial_sum(first_pair.begin(), first_pair.end(), first_pair.begin());
+
+  std::vector<unsigned int> track_pairs(first_pair.back());
+  {
+    std::vector<unsigned int> next(first_pair.begin(), first_pair.end() - 1);
+    for (unsigned int ipair = 0; ipair < npairs; ++ipair)
+    {
+      track_pairs[next[pair_tracks[ipair].first]++] = ipair;
+      track_pairs[next[pair_tracks[ipair].second]++] = ipair;
+    }
+  }
+
+  std::vector<std::vector<unsigned int>> connected_tracks;
+  std::vector<unsigned int> connected;
+  std::vector<char> in_connected(ids.size(), 0);
+  std::vector<char> used(ids.size(), 0);
+
+  // number of pairs touching the tracks of the set, counting twice those inside it
+  unsigned int connected_pairs = 0;
+
+  const auto add = [&](unsigned int track)
+  {
+    if (in_connected[track])
+    {
+      return false;
+    }
+    in_connected[track] = 1;
+    used[track] = 1;
+    connected.push_back(track);
+    connected_pairs += first_pair[track + 1] - first_pair[track];
+    return true;
+  };
+
+  const auto close_set = [&]()
+  {
+    if (connected.empty())
+    {
+      return;
+    }
+    if (Verbosity() > 2)
+    {
+      std::cout << "           closing out set with size " << connected.size() << std::endl;
+    }
+    std::vector<unsigned int> set;
+    set.reserve(connected.size());
+    for (auto track : connected)
+    {
+      set.push_back(ids[track]);
+      in_connected[track] = 0;
+    }
+    std::sort(set.begin(), set.end());
+    connected_tracks.push_back(std::move(set));
+    connected.clear();
+    connected_pairs = 0;
+  };
+
+  const auto print_pair = [this](const std::string &what, const TrackPair &pair)
+  {
+    std::cout << what << pair.id1 << " and " << pair.id2 << " dca = " << pair.dca
+              << " pca dz = " << pair.pca1.z() - pair.pca2.z() << std::endl;
+    std::cout << "       id1 " << pair.id1 << " pca1 " << pair.pca1.x() << "  " << pair.pca1.y() << "  " << pair.pca1.z() << std::endl;
+    std::cout << "       id2 " << pair.id2 << " pca2 " << pair.pca2.x() << "  " << pair.pca2.y() << "  " << pair.pca2.z() << std::endl;
+  };
+
+  // pairs waiting to be visited, smallest first
+  std::priority_queue<unsigned int, std::vector<unsigned int>, std::greater<>> pending;
+
+  for (unsigned int ipair = 0; ipair < npairs; ++ipair)
+  {
+    const auto [track1, track2] = pair_tracks[ipair];
+    if (Verbosity() > 2)
+    {
+      print_pair("Begin search on tracks ", _track_pairs[ipair]);
+    }
+
+    if (used[track1] && used[track2])
+    {
+      if (Verbosity() > 2)
       {
-	auto rt = _track_pair_pca_map.equal_range(id1);
-	for (auto ct = rt.first; ct != rt.second; ++ct)
-	  {
-	    unsigned int idb = ct->second.first;
-	    if(idb==id2)
-	      {
-		auto pca1=ct->second.second.first;
-		auto pca2=ct->second.second.second;
-		std::cout << "Begin search on id1 = " << id1 << " and id2 = " << id2 << " dca12 = " << dca12 << std::endl;
-		std::cout << "       id1 " << id1 << " pca1 " << pca1.x() << "  " << pca1.y() << "  " << pca1.z() << std::endl;
-		std::cout << "       id2 " << id2 << " pca1 " << pca2.x() << "  " << pca2.y() << "  " << pca2.z() << std::endl;
-	      }
-	  }
+        std::cout << " tracks " << ids[track1] << " and " << ids[track2] << " are both in used , skip them" << std::endl;
       }
-    
-    if ((used.contains(id1)) && (used.contains(id2)))
+      continue;
+    }
+    if (!used[track1] && !used[track2])
+    {
+      // close out and start a new connected set
+      close_set();
+    }
+
+    // get everything connected to track1 and track2
+    add(track1);
+    add(track2);
+
+    const auto connect = [&](unsigned int jpair, bool queue_pairs)
+    {
+      if (Verbosity() > 2)
       {
-	if (Verbosity() > 2)
-	  {
-	    std::cout << " tracks " << id1 << " and " << id2 << " are both in used , skip them" << std::endl;
-	  }
-	continue;
+        print_pair("         found connection to ", _track_pairs[jpair]);
       }
-    if ((!used.contains(id1)) && (!used.contains(id2)))
+      for (auto track : {pair_tracks[jpair].first, pair_tracks[jpair].second})
       {
-	if (Verbosity() > 2)
-	  {
-	    auto rt1 = _track_pair_pca_map.equal_range(id1);
-	    for (auto ct = rt1.first; ct != rt1.second; ++ct)
-	      {
-		unsigned int ida = ct->first;
-		unsigned int idb = ct->second.first;
-		
-		if(idb==id2)
-		  {
-		    auto pcaa=ct->second.second.first;
-		    auto pcab=ct->second.second.second;
-		    std::cout << " tracks " << id1 << " and " << id2 << " dca = " << dca12
-			      << " are both not in used, start a new connected set" << std::endl;
-		    std::cout << "       ida " << ida << " pcaa " << pcaa.x() << "  " << pcaa.y() << "  " << pcaa.z() << std::endl;
-		    std::cout << "       idb " << idb << " pcab " << pcab.x() << "  " << pcab.y() << "  " << pcab.z() << std::endl;
-		  }
-	      }
-	  }
-	// close out and start a new connected set
-	if (!connected.empty())
-	  {
-	    if (Verbosity() > 2)
-	      {
-		std::cout << "           closing out set with size " << connected.size() << std::endl;
-	      }
-	    connected_tracks.push_back(connected);
-	    connected.clear();
-	  }
+        if (add(track) && queue_pairs)
+        {
+          // a track added on the way only brings its pairs which come later
+          const auto begin = track_pairs.begin() + first_pair[track];
+          const auto end = track_pairs.begin() + first_pair[track + 1];
+          for (auto it = std::upper_bound(begin, end, jpair); it != end; ++it)
+          {
+            pending.push(*it);
+          }
+        }
       }
-    
-    // get everything connected to id1 and id2
-    connected.insert(id1);
-    used.insert(id1);
-    connected.insert(id2);
-    used.insert(id2);
-    for (auto cit : _track_pair_map)
+    };
+
+    // Pairs are visited in order from the first one. In the fast mode, only those touching
+    // the set are visited, as long as they are a small part of all pairs. The scan then goes
+    // on over all pairs, from the next pending one.
+    unsigned int scan_start = 0;
+    if (_fast_pairing && 32 * connected_pairs <= npairs)
     {
-      unsigned int id3 = cit.first;
-      unsigned int id4 = cit.second.first;
-      double dca34 = cit.second.second;
+      for (auto track : connected)
+      {
+        for (unsigned int i = first_pair[track]; i < first_pair[track + 1]; ++i)
+        {
+          pending.push(track_pairs[i]);
+        }
+      }
 
-      if ((connected.contains(id3)) || (connected.contains(id4)))
+      scan_start = npairs;
+      unsigned int last = npairs;
+      while (!pending.empty())
       {
-        if (Verbosity() > 2)
-	  {
+        const unsigned int jpair = pending.top();
+        if (32 * connected_pairs > npairs)
+        {
+          scan_start = jpair;
+          pending = {};
+          break;
+        }
 
-	    auto rt2 = _track_pair_pca_map.equal_range(id3);
-	    for (auto ct = rt2.first; ct != rt2.second; ++ct)
-	      {
-		unsigned int ida = ct->first;
-		unsigned int idb = ct->second.first;
-		
-		if(idb==id4)
-		  {
-		    auto pcaa=ct->second.second.first;
-		    auto pcab=ct->second.second.second;
-		    std::cout << "         found connection to " << id3 << " and " << id4 << " dca34 = " << dca34
-			      << " pca dz = " << pcaa.z() - pcab.z() << std::endl;
-		    std::cout << "       id3 " << ida << " pca3 " << pcaa.x() << "  " << pcaa.y() << "  " << pcaa.z() << std::endl;
-		    std::cout << "       id4 " << idb << " pca4 " << pcab.x() << "  " << pcab.y() << "  " << pcab.z() << std::endl;
-		}
-	      }
-	  }
-        connected.insert(id3);
-        used.insert(id3);
-        connected.insert(id4);
-        used.insert(id4);
+        pending.pop();
+        if (jpair != last)
+        {
+          last = jpair;
+          connect(jpair, true);
+        }
       }
     }
-  }
 
-  // close out the last set
-  if (!connected.empty())
+    for (unsigned int jpair = scan_start; jpair < npairs; ++jpair)
     {
-      if (Verbosity() > 2)
-	{
-	  std::cout << "           closing out last connected set with size " << connected.size() << std::endl;
-	}
-      connected_tracks.push_back(connected);
-      connected.clear();
+      const auto [track3, track4] = pair_tracks[jpair];
+      if (in_connected[track3] || in_connected[track4])
+      {
+        connect(jpair, false);
+      }
     }
-  
+  }
+
+  // close out the last set
+  close_set();
+
   if (Verbosity() > 2)
     {
       std::cout << "connected_tracks size " << connected_tracks.size() << std::endl;
@@ -1047,11 +1103,18 @@ std::vector<std::set<unsigned int>> PHSimpleVertexFinder::findConnectedTracks()
 
 void PHSimpleVertexFinder::removeOutlierTrackPairs()
 {
-  //  Note: std::multimap<unsigned int, std::pair<unsigned int, std::pair<Eigen::Vector3d,  Eigen::Vector3d>>>  _track_pair_pca_map
-
-  for (auto it : _vertex_set)
+  // pairs are sorted by the first track id, get those of a given track
+  const auto pairs_of_track = [this](unsigned int id)
+  {
+    const auto first = std::lower_bound(_track_pairs.cbegin(), _track_pairs.cend(), id, [](const TrackPair &pair, unsigned int value)
+                                        { return pair.id1 < value; });
+    const auto last = std::upper_bound(first, _track_pairs.cend(), id, [](unsigned int value, const TrackPair &pair)
+                                       { return value < pair.id1; });
+    return std::make_pair(first, last);
+  };
+
+  for (unsigned int vtxid = 0; vtxid < _vertex_tracks.size(); ++vtxid)
   {
-    unsigned int vtxid = it;
     if (Verbosity() > 1)
     {
       std::cout << "calculate average position for vertex " << vtxid << std::endl;
@@ -1069,25 +1132,22 @@ void PHSimpleVertexFinder::removeOutlierTrackPairs()
     Eigen::Vector3d new_pca_avge(0., 0., 0.);
     double new_wt = 0.0;
 
-    auto ret = _vertex_track_map.equal_range(vtxid);
-
     // Start by getting the positions for this vertex into vectors for the median calculation
-    for (auto cit = ret.first; cit != ret.second; ++cit)
+    for (auto tr1id : _vertex_tracks[vtxid])
     {
-      unsigned int tr1id = cit->second;
       if (Verbosity() > 2)
       {
         std::cout << "   vectors: get entries for track " << tr1id << " for vertex " << vtxid << std::endl;
       }
 
       // find all pairs for this vertex with tr1id
-      auto pca_range = _track_pair_pca_map.equal_range(tr1id);
+      auto pca_range = pairs_of_track(tr1id);
       for (auto pit = pca_range.first; pit != pca_range.second; ++pit)
       {
-        unsigned int tr2id = pit->second.first;
+        unsigned int tr2id = pit->id2;
 
-        Eigen::Vector3d PCA1 = pit->second.second.first;
-        Eigen::Vector3d PCA2 = pit->second.second.second;
+        const Eigen::Vector3d &PCA1 = pit->pca1;
+        const Eigen::Vector3d &PCA2 = pit->pca2;
 
         if (Verbosity() > 2)
         {
@@ -1113,7 +1173,7 @@ void PHSimpleVertexFinder::removeOutlierTrackPairs()
       new_pca_avge.x() = getAverage(vx);
       new_pca_avge.y() = getAverage(vy);
       new_pca_avge.z() = getAverage(vz);
-      _vertex_position_map.insert(std::make_pair(vtxid, new_pca_avge));
+      _vertex_positions.push_back(new_pca_avge);
       if (Verbosity() > 1)
       {
         std::cout << " Vertex has only 2 tracks, use average for PCA: " << new_pca_avge.x() << "  " << new_pca_avge.y() << "  " << new_pca_avge.z() << std::endl;
@@ -1132,22 +1192,21 @@ void PHSimpleVertexFinder::removeOutlierTrackPairs()
     }
 
     // Make the average vertex position with outlier rejection wrt the median
-    for (auto cit = ret.first; cit != ret.second; ++cit)
+    for (auto tr1id : _vertex_tracks[vtxid])
     {
-      unsigned int tr1id = cit->second;
       if (Verbosity() > 2)
       {
         std::cout << "   average: get entries for track " << tr1id << " for vertex " << vtxid << std::endl;
       }
 
       // find all pairs for this vertex with tr1id
-      auto pca_range = _track_pair_pca_map.equal_range(tr1id);
+      auto pca_range = pairs_of_track(tr1id);
       for (auto pit = pca_range.first; pit != pca_range.second; ++pit)
       {
-        unsigned int tr2id = pit->second.first;
+        unsigned int tr2id = pit->id2;
 
-        Eigen::Vector3d PCA1 = pit->second.second.first;
-        Eigen::Vector3d PCA2 = pit->second.second.second;
+        const Eigen::Vector3d &PCA1 = pit->pca1;
+        const Eigen::Vector3d &PCA2 = pit->pca2;
 
         if (
             fabs(PCA1.x() - pca_median_x) < _outlier_cut &&
@@ -1183,7 +1242,7 @@ void PHSimpleVertexFinder::removeOutlierTrackPairs()
       new_pca_avge.z() = pca_median_z;
     }
 
-    _vertex_position_map.insert(std::make_pair(vtxid, new_pca_avge));
+    _vertex_positions.push_back(new_pca_avge);
   }
 
   return;
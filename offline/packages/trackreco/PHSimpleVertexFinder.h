@@ -14,8 +14,6 @@
 #include <trackbase/TrkrDefs.h>
 #include <trackbase/ActsGeometry.h>
 
-#include <map>
-#include <set>
 #include <string>
 #include <vector>
 
@@ -59,21 +57,45 @@ class PHSimpleVertexFinder : public SubsysReco
   void setTrkrClusterContainerName(const std::string &name){ m_clusterContainerName = name; }
   void set_pp_mode(bool mode = true) { _pp_mode = mode; }
 
+  //! only test track pairs which cross the beam spot box at compatible z, rather than all pairs,
+  //! and only visit the pairs touching a vertex when collecting its tracks. Vertices are unchanged
+  void setFastPairing(bool flag = true) { _fast_pairing = flag; }
+
  private:
   int GetNodes(PHCompositeNode *topNode);
   int CreateNodes(PHCompositeNode *topNode);
 
+  //! straight line approximation of a track, a + t*b
+  struct TrackLine
+  {
+    unsigned int id = 0;
+    Eigen::Vector3d a = Eigen::Vector3d::Zero();
+    Eigen::Vector3d b = Eigen::Vector3d::Zero();
+  };
+
+  //! track pair passing the dca and beam spot cuts, with the points of closest approach
+  struct TrackPair
+  {
+    unsigned int id1 = 0;
+    unsigned int id2 = 0;
+    double dca = 0;
+    Eigen::Vector3d pca1 = Eigen::Vector3d::Zero();
+    Eigen::Vector3d pca2 = Eigen::Vector3d::Zero();
+  };
+
   void checkDCAs(SvtxTrackMap *track_map);
   void checkDCAsZF(SvtxTrackMap *track_map);
-  void checkDCAs();
 
   void getTrackletClusterList(TrackSeed* tracklet, std::vector<TrkrDefs::cluskey>& cluskey_vec);
-  
-  void findDcaTwoTracks(SvtxTrack *tr1, SvtxTrack *tr2);
+
+  //! fills _track_pairs from _track_lines, sorted by track ids
+  void findTrackPairs();
+  bool zRangeInBeamSpot(const TrackLine &line, double &zmin, double &zmax) const;
+  void findDcaTwoTracks(const TrackLine &line1, const TrackLine &line2);
   double dcaTwoLines(const Eigen::Vector3d &a1, const Eigen::Vector3d &b1,
                      const Eigen::Vector3d &a2, const Eigen::Vector3d &b2,
                      Eigen::Vector3d &PCA1, Eigen::Vector3d &PCA2);
-  std::vector<std::set<unsigned int>> findConnectedTracks();
+  std::vector<std::vector<unsigned int>> findConnectedTracks();
   void removeOutlierTrackPairs();
   double getMedian(std::vector<double> &v);
   double getAverage(std::vector<double> &v);
@@ -107,16 +129,18 @@ class PHSimpleVertexFinder : public SubsysReco
 
   std::string _track_map_name = "SvtxTrackMap";
   std::string _vertex_map_name = "SvtxVertexMap";
-  std::multimap<unsigned int, unsigned int> _vertex_track_map;
+
+  bool _fast_pairing = true;
+  double _pairing_margin = 0.01;  // cm, added to the beam spot box and dca cut when selecting pairs to test
+
+  // per crossing containers, indexed by vertex number in the crossing
+  // storage is kept from one crossing to the next
   using matrix_t = Eigen::Matrix<double, 3, 3>;
-  std::multimap<unsigned int, std::pair<unsigned int, double>> _track_pair_map;
-  // Eigen::Vector3d is an Eigen::Matrix<double,3,1>
-  std::multimap<unsigned int, std::pair<unsigned int, std::pair<Eigen::Vector3d,
-                                                                Eigen::Vector3d>>>
-      _track_pair_pca_map;
-  std::map<unsigned int, Eigen::Vector3d> _vertex_position_map;
-  std::map<unsigned int, matrix_t> _vertex_covariance_map;
-  std::set<unsigned int> _vertex_set;
+  std::vector<TrackLine> _track_lines;
+  std::vector<TrackPair> _track_pairs;
+  std::vector<std::vector<unsigned int>> _vertex_tracks;
+  std::vector<Eigen::Vector3d> _vertex_positions;
+  std::vector<matrix_t> _vertex_covariances;
 
   TrackVertexCrossingAssoc *_track_vertex_crossing_map{nullptr};
 
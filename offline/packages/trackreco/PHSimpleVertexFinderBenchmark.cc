@@ -0,0 +1,238 @@
+/**
+ * @file trackreco/PHSimpleVertexFinderBenchmark.cc
+ * @brief compare the fast and the all pairs track pairing of PHSimpleVertexFinder
+ *
+ * usage: PHSimpleVertexFinderBenchmark [events per configuration]
+ *
+ * Events are generated with straight tracks from vertices smeared around the beam spot,
+ * with a fraction of badly measured tracks which only pair by chance. The configurations
+ * go from a few pp crossings with pileup up to central Au+Au like multiplicities.
+ * For each configuration, the same events go through both pairing modes, with separate
+ * vertex maps. Vertices (position, covariance, tracks) and the vertex id of every track
+ * must be identical event by event.
+ */
+#include "PHSimpleVertexFinder.h"
+
+#include <globalvertex/SvtxVertex.h>
+#include <globalvertex/SvtxVertexMap.h>
+
+#include <trackbase/ActsGeometry.h>
+#include <trackbase/MvtxDefs.h>
+#include <trackbase/TrkrClusterContainerv4.h>
+#include <trackbase/TrkrDefs.h>
+
+#include <trackbase_historic/SvtxTrack.h>
+#include <trackbase_historic/SvtxTrackMap_v2.h>
+#include <trackbase_historic/SvtxTrack_v4.h>
+#include <trackbase_historic/TrackSeed_v2.h>
+
+#include <phool/PHCompositeNode.h>
+#include <phool/PHDataNode.h>
+#include <phool/PHIODataNode.h>
+#include <phool/PHObject.h>
+#include <phool/getClass.h>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+  // note : units are cm and GeV, as in the track map
+  struct Configuration
+  {
+    int crossings = 1;
+    int vertices = 1;
+    int tracks = 10;
+  };
+
+  // vertex map content and track vertex ids, in map order
+  struct Result
+  {
+    std::vector<double> vertices;
+    std::vector<unsigned int> track_vertex;
+  };
+
+  class Event
+  {
+   public:
+    Event()
+    {
+      // silicon seed with enough MVTX clusters for the default cluster requirement
+      for (uint8_t layer = 0; layer < 3; ++layer)
+      {
+        m_seed.insert_cluster_key(TrkrDefs::genClusKey(MvtxDefs::genHitSetKey(layer, 0, 0, 0), 0));
+      }
+    }
+
+    void generate(std::mt19937_64& rng, const Configuration& config, SvtxTrackMap* track_map)
+    {
+      std::normal_distribution<double> gauss(0, 1);
+      std::uniform_real_distribution<double> uniform(0, 1);
+
+      track_map->Reset();
+      unsigned int key = 0;
+      for (int crossing = 1; crossing <= config.crossings; ++crossing)
+      {
+        for (int vertex = 0; vertex < config.vertices; ++vertex)
+        {
+          const double xv = 0.01 * gauss(rng);
+          const double yv = 0.01 * gauss(rng);
+          const double zv = 10 * gauss(rng);
+          for (int track_i = 0; track_i < config.tracks; ++track_i)
+          {
+            const double phi = 2 * M_PI * uniform(rng);
+            const double eta = 2.2 * uniform(rng) - 1.1;
+            const double pt = 0.2 + 2 * uniform(rng);
+
+            // note : position given at some distance from the vertex along the track,
+            // 30 microns resolution for good tracks, 3 mm for bad ones
+            const double length = 2 * gauss(rng);
+            const double resolution = (uniform(rng) < 0.1) ? 0.3 : 0.003;
+
+            SvtxTrack_v4 track;
+            track.set_crossing(crossing);
+            track.set_px(pt * std::cos(phi));
+            track.set_py(pt * std::sin(phi));
+            track.set_pz(pt * std::sinh(eta));
+            track.set_x(xv + length * std::cos(phi) + resolution * gauss(rng));
+            track.set_y(yv + length * std::sin(phi) + resolution * gauss(rng));
+            track.set_z(zv + length * std::sinh(eta) + 3 * resolution * gauss(rng));
+            track.set_chisq(15 * uniform(rng));
+            track.set_ndf(1);
+            for (int i = 0; i < 3; ++i)
+            {
+              for (int j = 0; j < 3; ++j)
+              {
+                track.set_error(i, j, (i == j ? 1 : 0.1) * resolution * resolution);
+              }
+            }
+            if (uniform(rng) < 0.95)
+            {
+              track.set_silicon_seed(&m_seed);
+            }
+
+            // note : track keys are not contiguous, as after ghost rejection
+            key += 1 + rng() % 3;
+            track_map->insertWithKey(&track, key);
+          }
+        }
+      }
+    }
+
+   private:
+    TrackSeed_v2 m_seed;
+  };
+
+  Result process(PHSimpleVertexFinder& finder, PHCompositeNode* topNode, SvtxTrackMap* track_map, const std::string& vertex_map_name, double& time)
+  {
+    for (const auto& [key, track] : *track_map)
+    {
+      track->set_vertex_id(std::numeric_limits<unsigned int>::max());
+    }
+
+    const auto start = std::chrono::high_resolution_clock::now();
+    finder.process_event(topNode);
+    time += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+    Result result;
+    auto* vertex_map = findNode::getClass<SvtxVertexMap>(topNode, vertex_map_name);
+    for (const auto& [key, vertex] : *vertex_map)
+    {
+      result.vertices.push_back(key);
+      result.vertices.push_back(vertex->get_beam_crossing());
+      result.vertices.push_back(vertex->get_x());
+      result.vertices.push_back(vertex->get_y());
+      result.vertices.push_back(vertex->get_z());
+      for (unsigned int i = 0; i < 3; ++i)
+      {
+        for (unsigned int j = 0; j < 3; ++j)
+        {
+          result.vertices.push_back(vertex->get_error(i, j));
+        }
+      }
+      result.vertices.push_back(vertex->size_tracks());
+      for (auto iter = vertex->begin_tracks(); iter != vertex->end_tracks(); ++iter)
+      {
+        result.vertices.push_back(*iter);
+      }
+    }
+    for (const auto& [key, track] : *track_map)
+    {
+      result.track_vertex.push_back(track->get_vertex_id());
+    }
+    return result;
+  }
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  const int nevents = (argc > 1) ? std::stoi(argv[1]) : 20;
+
+  // node tree with what the vertex finder needs. The cluster container and geometry
+  // are only used in zero field mode
+  PHCompositeNode topNode("TOP");
+  auto* dstNode = new PHCompositeNode("DST");
+  topNode.addNode(dstNode);
+  auto* svtxNode = new PHCompositeNode("SVTX");
+  dstNode->addNode(svtxNode);
+
+  auto* track_map = new SvtxTrackMap_v2;
+  svtxNode->addNode(new PHIODataNode<PHObject>(track_map, "SvtxTrackMap", "PHObject"));
+  svtxNode->addNode(new PHIODataNode<PHObject>(new TrkrClusterContainerv4, "TRKR_CLUSTER", "PHObject"));
+  topNode.addNode(new PHDataNode<ActsGeometry>(new ActsGeometry, "ActsGeometry"));
+
+  PHSimpleVertexFinder original("PHSimpleVertexFinderOriginal");
+  original.setFastPairing(false);
+  original.setVertexMapName("SvtxVertexMapOriginal");
+  original.InitRun(&topNode);
+
+  PHSimpleVertexFinder fast("PHSimpleVertexFinderFast");
+  fast.setFastPairing(true);
+  fast.setVertexMapName("SvtxVertexMapFast");
+  fast.InitRun(&topNode);
+
+  std::cout << "PHSimpleVertexFinderBenchmark - " << nevents << " events per configuration, times in ms per event" << std::endl;
+  std::cout << "crossings  vertices/crossing  tracks/vertex  original  fast  speedup  vertices" << std::endl;
+
+  bool identical = true;
+  std::mt19937_64 rng(12345);
+  Event event;
+  for (const auto& config : {Configuration{1, 1, 20}, Configuration{10, 5, 15}, Configuration{1, 50, 20},
+                             Configuration{1, 200, 20}, Configuration{1, 1, 500}, Configuration{1, 1, 2000}})
+  {
+    double original_time = 0;
+    double fast_time = 0;
+    std::size_t nvertices = 0;
+    for (int event_i = 0; event_i < nevents; event_i++)
+    {
+      event.generate(rng, config, track_map);
+      const auto original_result = process(original, &topNode, track_map, "SvtxVertexMapOriginal", original_time);
+      const auto fast_result = process(fast, &topNode, track_map, "SvtxVertexMapFast", fast_time);
+      nvertices += findNode::getClass<SvtxVertexMap>(&topNode, "SvtxVertexMapFast")->size();
+
+      if (original_result.vertices != fast_result.vertices || original_result.track_vertex != fast_result.track_vertex)
+      {
+        std::cout << "PHSimpleVertexFinderBenchmark - " << config.crossings << " crossings, " << config.vertices << " vertices, "
+                  << config.tracks << " tracks, event " << event_i << ": vertices differ" << std::endl;
+        identical = false;
+      }
+    }
+
+    std::cout << config.crossings << "  " << config.vertices << "  " << config.tracks
+              << "  " << original_time / nevents << "  " << fast_time / nevents << "  " << original_time / fast_time
+              << "  " << nvertices / nevents << std::endl;
+  }
+
+  if (!identical)
+  {
+    std::cout << "PHSimpleVertexFinderBenchmark - results differ" << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -11,6 +11,7 @@
 #include <g4main/PHG4DisplayAction.h>  // for PHG4DisplayAction
 #include <g4main/PHG4HitContainer.h>
 #include <g4main/PHG4SteppingAction.h>  // for PHG4SteppingAction
+#include <g4main/PHG4WorkerEventAction.h>
 
 #include <phool/PHCompositeNode.h>
 #include <phool/PHIODataNode.h>    // for PHIODataNode
@@ -101,15 +102,29 @@ int PHG4BlockSubsystem::InitRunSubsystem(PHCompositeNode *topNode)
                                               GetParams()->get_double_param("place_z"),
                                               GetParams()->get_double_param("rot_z"));
     geocont->AddLayerGeom(GetLayer(), geom);
-
-    m_SteppingAction = new PHG4BlockSteppingAction(m_Detector, GetParams());
   }
-  else if (GetParams()->get_int_param("blackhole"))
+  m_SteppingAction = CreateSteppingAction();
+
+  return 0;
+}
+
+//_______________________________________________________________________
+PHG4SteppingAction *PHG4BlockSubsystem::CreateSteppingAction()
+{
+  if (!GetParams()->get_int_param("active") && !GetParams()->get_int_param("blackhole"))
   {
-    m_SteppingAction = new PHG4BlockSteppingAction(m_Detector, GetParams());
+    return nullptr;
   }
+  return new PHG4BlockSteppingAction(m_Detector, GetParams());
+}
 
-  return 0;
+//_______________________________________________________________________
+void PHG4BlockSubsystem::CreateWorkerActions(PHG4WorkerEventAction *worker)
+{
+  if (PHG4SteppingAction *action = CreateSteppingAction())
+  {
+    worker->AddSteppingAction(action);
+  }
 }
 
 //_______________________________________________________________________
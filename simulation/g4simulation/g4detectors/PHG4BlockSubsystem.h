@@ -13,6 +13,7 @@ class PHG4Detector;
 class PHG4BlockDetector;
 class PHG4DisplayAction;
 class PHG4SteppingAction;
+class PHG4WorkerEventAction;
 
 class PHG4BlockSubsystem : public PHG4DetectorSubsystem
 {
@@ -43,6 +44,10 @@ class PHG4BlockSubsystem : public PHG4DetectorSubsystem
 
   PHG4SteppingAction* GetSteppingAction() const override { return m_SteppingAction; }
 
+  //! multithreading support, each worker thread gets its own stepping action
+  bool SupportsMultiThreading() const override { return true; }
+  void CreateWorkerActions(PHG4WorkerEventAction* worker) override;
+
   PHG4DisplayAction* GetDisplayAction() const override { return m_DisplayAction; }
 
   void set_color(const double red, const double green, const double blue, const double alpha = 1.)
@@ -60,6 +65,9 @@ class PHG4BlockSubsystem : public PHG4DetectorSubsystem
  private:
   void SetDefaultParameters() override;
 
+  //! create the stepping action for active or black hole blocks, nullptr otherwise
+  PHG4SteppingAction* CreateSteppingAction();
+
   //! detector geometry
   /*! defines from PHG4Detector */
   PHG4BlockDetector* m_Detector{nullptr};
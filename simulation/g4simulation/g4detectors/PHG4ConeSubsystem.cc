@@ -9,6 +9,7 @@
 #include <g4main/PHG4DisplayAction.h>  // for PHG4DisplayAction
 #include <g4main/PHG4HitContainer.h>
 #include <g4main/PHG4SteppingAction.h>
+#include <g4main/PHG4WorkerEventAction.h>
 
 #include <phool/PHCompositeNode.h>
 #include <phool/PHIODataNode.h>    // for PHIODataNode
@@ -108,6 +109,15 @@ int PHG4ConeSubsystem::process_event(PHCompositeNode *topNode)
   return 0;
 }
 
+//_______________________________________________________________________
+void PHG4ConeSubsystem::CreateWorkerActions(PHG4WorkerEventAction *worker)
+{
+  if (GetParams()->get_int_param("active"))
+  {
+    worker->AddSteppingAction(new PHG4ConeSteppingAction(m_Detector));
+  }
+}
+
 //_______________________________________________________________________
 PHG4Detector *PHG4ConeSubsystem::GetDetector() const
 {
@@ -13,6 +13,7 @@ class PHG4ConeDetector;
 class PHG4Detector;
 class PHG4DisplayAction;
 class PHG4SteppingAction;
+class PHG4WorkerEventAction;
 
 class PHG4ConeSubsystem : public PHG4DetectorSubsystem
 {
@@ -42,6 +43,10 @@ class PHG4ConeSubsystem : public PHG4DetectorSubsystem
   PHG4Detector* GetDetector() const override;
   PHG4SteppingAction* GetSteppingAction() const override { return m_SteppingAction; };
 
+  //! multithreading support, each worker thread gets its own stepping action
+  bool SupportsMultiThreading() const override { return true; }
+  void CreateWorkerActions(PHG4WorkerEventAction* worker) override;
+
   PHG4DisplayAction* GetDisplayAction() const override { return m_DisplayAction; }
   void set_color(const double red, const double green, const double blue, const double alpha = 1.)
   {
@@ -11,6 +11,7 @@
 #include <g4main/PHG4HitContainer.h>
 #include <g4main/PHG4SteppingAction.h>  // for PHG4SteppingAction
 #include <g4main/PHG4Utils.h>
+#include <g4main/PHG4WorkerEventAction.h>
 
 #include <phool/PHCompositeNode.h>
 #include <phool/PHIODataNode.h>    // for PHIODataNode
@@ -128,19 +129,35 @@ int PHG4CylinderSubsystem::InitRunSubsystem(PHCompositeNode *topNode)
     }
     PHG4CylinderGeom *mygeom = new PHG4CylinderGeomv1(GetParams()->get_double_param("radius"), GetParams()->get_double_param("place_z") - detlength / 2., GetParams()->get_double_param("place_z") + detlength / 2., GetParams()->get_double_param("thickness"));
     geo->AddLayerGeom(GetLayer(), mygeom);
-    auto *tmp = new PHG4CylinderSteppingAction(this, m_Detector, GetParams());
-    tmp->HitNodeName(nodename);
-    m_SteppingAction = tmp;
+    m_HitNodeName = nodename;
   }
-  else if (GetParams()->get_int_param("blackhole"))
+  m_SteppingAction = CreateSteppingAction();
+  return 0;
+}
+
+//_______________________________________________________________________
+PHG4SteppingAction *PHG4CylinderSubsystem::CreateSteppingAction()
+{
+  if (!GetParams()->get_int_param("active") && !GetParams()->get_int_param("blackhole"))
   {
-    m_SteppingAction = new PHG4CylinderSteppingAction(this, m_Detector, GetParams());
+    return nullptr;
   }
-  if (m_SteppingAction)
+  auto *action = new PHG4CylinderSteppingAction(this, m_Detector, GetParams());
+  if (GetParams()->get_int_param("active"))
   {
-    (dynamic_cast<PHG4CylinderSteppingAction *>(m_SteppingAction))->SaveAllHits(m_SaveAllHitsFlag);
+    action->HitNodeName(m_HitNodeName);
+  }
+  action->SaveAllHits(m_SaveAllHitsFlag);
+  return action;
+}
+
+//_______________________________________________________________________
+void PHG4CylinderSubsystem::CreateWorkerActions(PHG4WorkerEventAction *worker)
+{
+  if (PHG4SteppingAction *action = CreateSteppingAction())
+  {
+    worker->AddSteppingAction(action);
   }
-  return 0;
 }
 
 //_______________________________________________________________________
@@ -13,6 +13,7 @@ class PHG4CylinderDetector;
 class PHG4Detector;
 class PHG4DisplayAction;
 class PHG4SteppingAction;
+class PHG4WorkerEventAction;
 
 class PHG4CylinderSubsystem : public PHG4DetectorSubsystem
 {
@@ -45,6 +46,10 @@ class PHG4CylinderSubsystem : public PHG4DetectorSubsystem
   PHG4Detector* GetDetector() const override;
   PHG4SteppingAction* GetSteppingAction() const override { return m_SteppingAction; }
 
+  //! multithreading support, each worker thread gets its own stepping action
+  bool SupportsMultiThreading() const override { return true; }
+  void CreateWorkerActions(PHG4WorkerEventAction* worker) override;
+
   PHG4DisplayAction* GetDisplayAction() const override { return m_DisplayAction; }
   void set_color(const double red, const double green, const double blue, const double alpha = 1.)
   {
@@ -66,6 +71,9 @@ class PHG4CylinderSubsystem : public PHG4DetectorSubsystem
  private:
   void SetDefaultParameters() override;
 
+  //! create the stepping action for active or black hole cylinders, nullptr otherwise
+  PHG4SteppingAction* CreateSteppingAction();
+
   //! detector geometry
   /*! derives from PHG4Detector */
   PHG4CylinderDetector* m_Detector{nullptr};
@@ -79,6 +87,10 @@ class PHG4CylinderSubsystem : public PHG4DetectorSubsystem
   PHG4DisplayAction* m_DisplayAction{nullptr};
 
   bool m_SaveAllHitsFlag = false;
+
+  //! g4hit node name of active cylinders
+  std::string m_HitNodeName;
+
   //! Color setting if we want to override the default
   std::array<double, 4> m_ColorArray{};
 };
@@ -0,0 +1,233 @@
+/**
+ * @file g4detectors/PHG4RecoMTTest.cc
+ * @brief check that the multithreaded mode of PHG4Reco gives the same output as the sequential mode
+ *
+ * usage: PHG4RecoMTTest [events]
+ *
+ * A simple setup of cylinders and blocks, with truth, is simulated with a fixed seed. Two
+ * generators with their own vertex give the primary particles. The truth particles, vertices
+ * and g4hits of each event are written to a text file, with full precision, and compared between:
+ * - a sequential job with one sub-event and a multithreaded job with one sub-event
+ * - multithreaded jobs with 16 sub-events and 1, 2 and 4 threads
+ *
+ * Only one geant run manager can exist per process, so each job runs in its own process,
+ * started by this program with: PHG4RecoMTTest --run <threads, 0 is sequential> <sub-events> <output file> <events>
+ */
+#include "PHG4BlockSubsystem.h"
+#include "PHG4CylinderSubsystem.h"
+
+#include <g4main/PHG4Hit.h>
+#include <g4main/PHG4HitContainer.h>
+#include <g4main/PHG4Particle.h>
+#include <g4main/PHG4Reco.h>
+#include <g4main/PHG4SimpleEventGenerator.h>
+#include <g4main/PHG4TruthInfoContainer.h>
+#include <g4main/PHG4VtxPoint.h>
+
+#include <fun4all/Fun4AllDummyInputManager.h>
+#include <fun4all/Fun4AllReturnCodes.h>
+#include <fun4all/Fun4AllServer.h>
+#include <fun4all/SubsysReco.h>
+
+#include <phool/PHCompositeNode.h>
+#include <phool/getClass.h>
+#include <phool/recoConsts.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+  const std::vector<std::string> hit_node_names = {"G4HIT_CYLINDER", "G4HIT_BLOCK"};
+
+  // writes the geant output of each event
+  class OutputDump : public SubsysReco
+  {
+   public:
+    explicit OutputDump(const std::string& filename)
+      : SubsysReco("OutputDump")
+      , m_out(filename)
+    {
+      m_out << std::hexfloat;
+    }
+
+    int process_event(PHCompositeNode* topNode) override
+    {
+      m_out << "event " << m_nevents++ << "\n";
+      if (auto* truthinfo = findNode::getClass<PHG4TruthInfoContainer>(topNode, "G4TruthInfo"))
+      {
+        for (const auto& [id, particle] : truthinfo->GetMap())
+        {
+          m_out << "particle " << id << " " << particle->get_pid()
+                << " " << particle->get_parent_id() << " " << particle->get_primary_id() << " " << particle->get_vtx_id()
+                << " " << particle->get_px() << " " << particle->get_py() << " " << particle->get_pz() << " " << particle->get_e() << "\n";
+        }
+        for (const auto& [id, vertex] : truthinfo->GetVtxMap())
+        {
+          m_out << "vertex " << id << " " << vertex->get_x() << " " << vertex->get_y() << " " << vertex->get_z()
+                << " " << vertex->get_t() << " " << vertex->get_process() << "\n";
+        }
+      }
+      for (const auto& name : hit_node_names)
+      {
+        auto* hits = findNode::getClass<PHG4HitContainer>(topNode, name);
+        if (!hits)
+        {
+          continue;
+        }
+        const auto range = hits->getHits();
+        for (auto iter = range.first; iter != range.second; ++iter)
+        {
+          const auto* hit = iter->second;
+          m_out << name << " " << iter->first << " " << hit->get_trkid() << " " << hit->get_edep();
+          for (int i = 0; i < 2; ++i)
+          {
+            m_out << " " << hit->get_x(i) << " " << hit->get_y(i) << " " << hit->get_z(i) << " " << hit->get_t(i);
+          }
+          m_out << "\n";
+        }
+      }
+      return Fun4AllReturnCodes::EVENT_OK;
+    }
+
+   private:
+    std::ofstream m_out;
+    int m_nevents = 0;
+  };
+
+  // one job, in this process
+  int run(const unsigned int nthreads, const unsigned int nsubevents, const std::string& filename, const int nevents)
+  {
+    recoConsts::instance()->set_IntFlag("RANDOMSEED", 12345);
+
+    Fun4AllServer* se = Fun4AllServer::instance();
+
+    // two vertices with a few tens of particles each
+    for (int i = 0; i < 2; ++i)
+    {
+      auto* generator = new PHG4SimpleEventGenerator("GENERATOR" + std::to_string(i));
+      generator->add_particles("pi-", 20);
+      generator->add_particles("e+", 5);
+      generator->set_vertex_distribution_function(PHG4SimpleEventGenerator::Gaus, PHG4SimpleEventGenerator::Gaus, PHG4SimpleEventGenerator::Gaus);
+      generator->set_vertex_distribution_mean(0, 0, i ? 5 : -5);
+      generator->set_vertex_distribution_width(0.01, 0.01, 5);
+      generator->set_eta_range(-1, 1);
+      generator->set_phi_range(-M_PI, M_PI);
+      generator->set_pt_range(0.5, 5);
+      se->registerSubsystem(generator);
+    }
+
+    auto* g4Reco = new PHG4Reco();
+    g4Reco->set_field(1.4);
+    if (nthreads > 0)
+    {
+      g4Reco->setMultiThreaded(nthreads);
+    }
+    g4Reco->setSubEvents(nsubevents);
+
+    double radius = 5;
+    for (int layer = 0; layer < 4; ++layer)
+    {
+      auto* cylinder = new PHG4CylinderSubsystem("CYLINDER", layer);
+      cylinder->set_double_param("radius", radius);
+      cylinder->set_double_param("thickness", 1);
+      cylinder->set_double_param("length", 100);
+      cylinder->set_string_param("material", "G4_Si");
+      cylinder->SuperDetector("CYLINDER");
+      cylinder->SetActive();
+      g4Reco->registerSubsystem(cylinder);
+      radius += 10;
+    }
+
+    for (int layer = 0; layer < 2; ++layer)
+    {
+      auto* block = new PHG4BlockSubsystem("BLOCK", layer);
+      block->set_double_param("size_x", 20);
+      block->set_double_param("size_y", 20);
+      block->set_double_param("size_z", 20);
+      block->set_double_param("place_x", layer ? -60 : 60);
+      block->set_string_param("material", "G4_Fe");
+      block->SuperDetector("BLOCK");
+      block->SetActive();
+      g4Reco->registerSubsystem(block);
+    }
+    se->registerSubsystem(g4Reco);
+
+    se->registerSubsystem(new OutputDump(filename));
+
+    auto* in = new Fun4AllDummyInputManager("JADE");
+    se->registerInputManager(in);
+
+    se->run(nevents);
+    se->End();
+    delete se;
+    return 0;
+  }
+
+  std::string read_file(const std::string& filename)
+  {
+    std::ifstream in(filename);
+    std::stringstream content;
+    content << in.rdbuf();
+    return content.str();
+  }
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  if (argc > 5 && std::string(argv[1]) == "--run")
+  {
+    return run(std::stoul(argv[2]), std::stoul(argv[3]), argv[4], std::stoi(argv[5]));
+  }
+  const int nevents = (argc > 1) ? std::stoi(argv[1]) : 5;
+
+  // start a job in its own process and return its output
+  const auto job = [&](const unsigned int nthreads, const unsigned int nsubevents)
+  {
+    const auto filename = (std::filesystem::temp_directory_path() /
+                           ("PHG4RecoMTTest_" + std::to_string(nthreads) + "threads_" + std::to_string(nsubevents) + "subevents.txt"))
+                              .string();
+    const std::string command = std::string(argv[0]) + " --run " + std::to_string(nthreads) + " " + std::to_string(nsubevents) + " " + filename + " " + std::to_string(nevents);
+    if (std::system(command.c_str()) != 0)
+    {
+      std::cout << "PHG4RecoMTTest - failed: " << command << std::endl;
+      return std::string();
+    }
+    auto output = read_file(filename);
+    std::filesystem::remove(filename);
+    return output;
+  };
+
+  int failures = 0;
+  const auto check = [&failures](const std::string& reference, const std::string& output, const std::string& what)
+  {
+    if (reference.empty() || output != reference)
+    {
+      std::cout << "PHG4RecoMTTest - " << what << ": output differs" << std::endl;
+      ++failures;
+    }
+  };
+
+  // a sequential job is a multithreaded one with a single sub-event
+  check(job(0, 1), job(1, 1), "sequential vs multithreaded with one sub-event");
+
+  // the output does not depend on the number of threads
+  const auto reference = job(1, 16);
+  for (const unsigned int nthreads : {2U, 4U})
+  {
+    check(reference, job(nthreads, 16), std::to_string(nthreads) + " threads vs 1 thread with 16 sub-events");
+  }
+
+  if (failures > 0)
+  {
+    return 1;
+  }
+  std::cout << "PHG4RecoMTTest - all checks passed" << std::endl;
+  return 0;
+}
@@ -1,6 +1,7 @@
 #include "SvtxClusterEval.h"
 
 #include "SvtxHitEval.h"
+#include "SvtxTruthAssocTable.h"
 #include "SvtxTruthEval.h"
 
 #include <trackbase/TrkrCluster.h>
@@ -344,6 +345,16 @@ std::set<PHG4Hit*> SvtxClusterEval::all_truth_hits(TrkrDefs::cluskey cluster_key
     return std::set<PHG4Hit*>();
   }
 
+  if (use_assoc_table())
+  {
+    std::set<PHG4Hit*> truth_hits;
+    for (const auto& entry : _assoc_table->g4hits_from_cluster(cluster_key))
+    {
+      truth_hits.insert(entry.g4hit);
+    }
+    return truth_hits;
+  }
+
   if (_do_cache)
   {
     std::map<TrkrDefs::cluskey, std::set<PHG4Hit*>>::iterator iter =
@@ -786,6 +797,16 @@ std::set<PHG4Particle*> SvtxClusterEval::all_truth_particles(TrkrDefs::cluskey c
     return std::set<PHG4Particle*>();
   }
 
+  if (use_assoc_table())
+  {
+    std::set<PHG4Particle*> truth_particles;
+    for (const auto& entry : _assoc_table->particles_from_cluster(cluster_key))
+    {
+      truth_particles.insert(entry.particle);
+    }
+    return truth_particles;
+  }
+
   if (_do_cache)
   {
     std::map<TrkrDefs::cluskey, std::set<PHG4Particle*>>::iterator iter =
@@ -937,6 +958,17 @@ std::set<TrkrDefs::cluskey> SvtxClusterEval::all_clusters_from(PHG4Particle* tru
     ++_errors;
     return std::set<TrkrDefs::cluskey>();
   }
+
+  if (use_assoc_table())
+  {
+    std::set<TrkrDefs::cluskey> clusters;
+    for (const auto& entry : _assoc_table->clusters_from_particle(truthparticle->get_track_id()))
+    {
+      clusters.insert(entry.cluster_key);
+    }
+    return clusters;
+  }
+
   // check if cache is filled, if not fill it.
   //   if(_cache_all_clusters_from_particle.count(truthparticle)==0){
   if (_cache_all_clusters_from_particle.empty())
@@ -1019,6 +1051,16 @@ std::set<TrkrDefs::cluskey> SvtxClusterEval::all_clusters_from(PHG4Hit* truthhit
     return std::set<TrkrDefs::cluskey>();
   }
 
+  if (use_assoc_table())
+  {
+    std::set<TrkrDefs::cluskey> clusters;
+    for (const auto& entry : _assoc_table->clusters_from_g4hit(truthhit))
+    {
+      clusters.insert(entry.cluster_key);
+    }
+    return clusters;
+  }
+
   // one time, fill cache of g4hit/cluster pairs
   if (_cache_all_clusters_from_g4hit.empty())
   {
@@ -1278,6 +1320,18 @@ float SvtxClusterEval::get_energy_contribution(TrkrDefs::cluskey cluster_key, PH
     return std::numeric_limits<float>::quiet_NaN();
   }
 
+  if (use_assoc_table())
+  {
+    for (const auto& entry : _assoc_table->particles_from_cluster(cluster_key))
+    {
+      if (entry.track_id == particle->get_track_id())
+      {
+        return entry.energy;
+      }
+    }
+    return 0;
+  }
+
   if (_do_cache)
   {
     std::map<std::pair<TrkrDefs::cluskey, PHG4Particle*>, float>::iterator iter =
@@ -1381,6 +1435,7 @@ void SvtxClusterEval::get_node_pointers(PHCompositeNode* topNode)
   _g4hits_mvtx = findNode::getClass<PHG4HitContainer>(topNode, "G4HIT_MVTX");
   _g4hits_mms = findNode::getClass<PHG4HitContainer>(topNode, "G4HIT_MICROMEGAS");
   _tgeometry = findNode::getClass<ActsGeometry>(topNode, "ActsGeometry");
+  _assoc_table = findNode::getClass<SvtxTruthAssocTable>(topNode, "SvtxTruthAssocTable");
 
   return;
 }
@@ -1420,6 +1475,11 @@ void SvtxClusterEval::fill_cluster_layer_map()
   return;
 }
 
+bool SvtxClusterEval::use_assoc_table() const
+{
+  return _use_assoc_table && _assoc_table && _assoc_table->processed();
+}
+
 bool SvtxClusterEval::has_node_pointers()
 {
   if (_strict)
@@ -22,6 +22,7 @@ class TrkrCluster;
 class TrkrClusterContainer;
 class TrkrClusterHitAssoc;
 class TrkrHitTruthAssoc;
+class SvtxTruthAssocTable;
 class SvtxTruthEval;
 
 typedef std::multimap<float, TrkrDefs::cluskey> innerMap;
@@ -38,6 +39,12 @@ class SvtxClusterEval
     _do_cache = do_cache;
     _hiteval.do_caching(do_cache);
   }
+  //! read associations from the SvtxTruthAssocTable node when filled, rather than from caches
+  void set_use_assoc_table(bool use_assoc_table)
+  {
+    _use_assoc_table = use_assoc_table;
+    get_truth_eval()->set_use_assoc_table(use_assoc_table);
+  }
   void set_strict(bool strict)
   {
     _strict = strict;
@@ -90,6 +97,9 @@ class SvtxClusterEval
   //  void fill_g4hit_layer_map();
   bool has_node_pointers();
 
+  //! true if associations are to be read from the SvtxTruthAssocTable
+  bool use_assoc_table() const;
+
   //! Fast approximation of atan2() for cluster searching
   //! From https://www.dsprelated.com/showarticle/1052.php
   float fast_approx_atan2(float y, float x);
@@ -105,6 +115,7 @@ class SvtxClusterEval
   PHG4HitContainer* _g4hits_mvtx {nullptr};
   PHG4HitContainer* _g4hits_mms {nullptr};
   ActsGeometry* _tgeometry {nullptr};
+  const SvtxTruthAssocTable* _assoc_table {nullptr};
 
   bool _strict = false;
   int _verbosity = 0;
@@ -112,6 +123,8 @@ class SvtxClusterEval
 
   Acts::Vector3 getGlobalPosition(TrkrDefs::cluskey cluster_key, TrkrCluster* cluster);
 
+  bool _use_assoc_table = true;
+
   bool _do_cache = true;
   std::map<TrkrDefs::cluskey, std::set<PHG4Hit*>> _cache_all_truth_hits;
   std::map<TrkrDefs::cluskey, std::map<TrkrDefs::cluskey, std::shared_ptr<TrkrCluster>>> _cache_all_truth_clusters;
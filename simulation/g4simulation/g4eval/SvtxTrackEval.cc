@@ -1,6 +1,7 @@
 #include "SvtxTrackEval.h"
 
 #include "SvtxClusterEval.h"
+#include "SvtxTruthAssocTable.h"
 #include "SvtxTruthEval.h"
 
 #include <g4main/PHG4Hit.h>
@@ -166,6 +167,13 @@ std::set<PHG4Particle*> SvtxTrackEval::all_truth_particles(SvtxTrack* track)
     unsigned int track_id = fastsim_track->get_truth_track_id();
     truth_particles.insert(get_truth_eval()->get_particle(track_id));
   }
+  else if (use_assoc_table())
+  {
+    for (const auto& entry : _assoc_table->particles_from_track(track->get_id()))
+    {
+      truth_particles.insert(entry.particle);
+    }
+  }
   else
   {
     // loop over all clusters...
@@ -306,6 +314,19 @@ std::set<SvtxTrack*> SvtxTrackEval::all_tracks_from(PHG4Particle* truthparticle)
     return returnset;
   }
 
+  if (use_assoc_table())
+  {
+    std::set<SvtxTrack*> tracks;
+    for (const auto& entry : _assoc_table->tracks_from_particle(truthparticle->get_track_id()))
+    {
+      if (SvtxTrack* track = _trackmap->get(entry.track_key))
+      {
+        tracks.insert(track);
+      }
+    }
+    return tracks;
+  }
+
   if (_do_cache)
   {
     std::map<PHG4Particle*, std::set<SvtxTrack*> >::iterator iter =
@@ -751,33 +772,49 @@ void SvtxTrackEval::calc_cluster_contribution(SvtxTrack* track, PHG4Particle* pa
 
   unsigned int nclusters = 0;
   unsigned int nwrong = 0;
-  // loop over all clusters
-  std::vector<TrkrDefs::cluskey> cluster_keys = get_track_ckeys(track);
-  for (const auto& cluster_key : cluster_keys)
+  if (use_assoc_table())
   {
-    //    if (_strict)
-    //    {
-    //      assert(cluster_key);
-    //    }
-    //    else if (!cluster_key)
-    //    {
-    //      ++_errors;
-    //      continue;
-    //    }
-    int matched = 0;
-    // loop over all particles
-    std::set<PHG4Particle*> particles = _clustereval.all_truth_particles(cluster_key);
-    for (auto* candidate : particles)
+    // clusters not associated to the particle are wrong
+    for (const auto& entry : _assoc_table->particles_from_track(track->get_id()))
     {
-      if (get_truth_eval()->are_same_particle(candidate, particle))
+      if (entry.track_id == particle->get_track_id())
       {
-        ++nclusters;
-        matched = 1;
+        nclusters = entry.nclusters;
+        break;
       }
     }
-    if (matched == 0)
+    nwrong = get_track_ckeys(track).size() - nclusters;
+  }
+  else
+  {
+    // loop over all clusters
+    std::vector<TrkrDefs::cluskey> cluster_keys = get_track_ckeys(track);
+    for (const auto& cluster_key : cluster_keys)
     {
-      nwrong++;
+      //    if (_strict)
+      //    {
+      //      assert(cluster_key);
+      //    }
+      //    else if (!cluster_key)
+      //    {
+      //      ++_errors;
+      //      continue;
+      //    }
+      int matched = 0;
+      // loop over all particles
+      std::set<PHG4Particle*> particles = _clustereval.all_truth_particles(cluster_key);
+      for (auto* candidate : particles)
+      {
+        if (get_truth_eval()->are_same_particle(candidate, particle))
+        {
+          ++nclusters;
+          matched = 1;
+        }
+      }
+      if (matched == 0)
+      {
+        nwrong++;
+      }
     }
   }
 
@@ -957,9 +994,18 @@ void SvtxTrackEval::get_node_pointers(PHCompositeNode* topNode)
 
   _truthinfo = findNode::getClass<PHG4TruthInfoContainer>(topNode, "G4TruthInfo");
 
+  _assoc_table = findNode::getClass<SvtxTruthAssocTable>(topNode, "SvtxTruthAssocTable");
+
   return;
 }
 
+bool SvtxTrackEval::use_assoc_table() const
+{
+  // the track tables are only valid for the track map they were filled from
+  return _use_assoc_table && _assoc_table && _assoc_table->processed() &&
+         _trackmap && _assoc_table->track_map() == _trackmap;
+}
+
 bool SvtxTrackEval::has_node_pointers()
 {
   // need things off of the DST...
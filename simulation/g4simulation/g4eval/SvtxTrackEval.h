@@ -18,6 +18,7 @@ class PHG4Particle;
 class SvtxHitEval;
 class SvtxTrack;
 class SvtxTrackMap;
+class SvtxTruthAssocTable;
 class SvtxTruthEval;
 class PHG4ParticleSvtxMap;
 class SvtxPHG4ParticleMap;
@@ -35,6 +36,12 @@ class SvtxTrackEval
     _do_cache = do_cache;
     _clustereval.do_caching(do_cache);
   }
+  //! read associations from the SvtxTruthAssocTable node when filled, rather than from caches
+  void set_use_assoc_table(bool use_assoc_table)
+  {
+    _use_assoc_table = use_assoc_table;
+    _clustereval.set_use_assoc_table(use_assoc_table);
+  }
   void set_strict(bool strict)
   {
     _strict = strict;
@@ -80,6 +87,9 @@ class SvtxTrackEval
   void get_node_pointers(PHCompositeNode* topNode);
   bool has_node_pointers();
 
+  //! true if associations are to be read from the SvtxTruthAssocTable
+  bool use_assoc_table() const;
+
   std::vector<TrkrDefs::cluskey> get_track_ckeys(SvtxTrack* track);
 
   SvtxClusterEval _clustereval;
@@ -87,11 +97,14 @@ class SvtxTrackEval
   PHG4TruthInfoContainer* _truthinfo = nullptr;
   const PHG4ParticleSvtxMap* _truthRecoMap = nullptr;
   const SvtxPHG4ParticleMap* _recoTruthMap = nullptr;
+  const SvtxTruthAssocTable* _assoc_table = nullptr;
 
   bool _strict = false;
   int _verbosity = 0;
   unsigned int _errors = 0;
 
+  bool _use_assoc_table = true;
+
   bool _do_cache = true;
   bool _cache_track_from_cluster_exists = false;
   std::map<SvtxTrack*, std::set<PHG4Hit*> > _cache_all_truth_hits;
@@ -0,0 +1,136 @@
+#include "SvtxTruthAssocTable.h"
+
+#include <algorithm>
+#include <functional>
+#include <tuple>
+
+namespace
+{
+  //! contiguous range of the entries of a sorted vector whose projection matches key
+  template <class T, class Key, class Projection>
+  std::span<const T> equal_span(const std::vector<T>& entries, const Key& key, Projection projection)
+  {
+    const auto range = std::ranges::equal_range(entries, key, std::ranges::less(), projection);
+    return {range.begin(), range.end()};
+  }
+}  // namespace
+
+//_____________________________________________________________________
+void SvtxTruthAssocTable::clear()
+{
+  m_processed = false;
+  m_track_map = nullptr;
+  m_cluster_g4hits.clear();
+  m_g4hit_clusters.clear();
+  m_cluster_particles.clear();
+  m_particle_clusters.clear();
+  m_track_particles.clear();
+  m_particle_tracks.clear();
+  m_particle_g4hits.clear();
+}
+
+//_____________________________________________________________________
+void SvtxTruthAssocTable::set_cluster_g4hits(std::vector<ClusterG4Hit>&& entries)
+{
+  // pointers are compared with std::ranges::less, which is the ordering of std::set<PHG4Hit*>
+  const auto by_cluster = [](const ClusterG4Hit& first, const ClusterG4Hit& second)
+  {
+    if (first.cluster_key != second.cluster_key)
+    {
+      return first.cluster_key < second.cluster_key;
+    }
+    return std::ranges::less()(first.g4hit, second.g4hit);
+  };
+  const auto same = [](const ClusterG4Hit& first, const ClusterG4Hit& second)
+  { return first.cluster_key == second.cluster_key && first.g4hit == second.g4hit; };
+
+  m_cluster_g4hits = std::move(entries);
+  std::sort(m_cluster_g4hits.begin(), m_cluster_g4hits.end(), by_cluster);
+  m_cluster_g4hits.erase(std::unique(m_cluster_g4hits.begin(), m_cluster_g4hits.end(), same), m_cluster_g4hits.end());
+
+  // stable sort keeps clusters ordered within each g4hit
+  m_g4hit_clusters = m_cluster_g4hits;
+  std::ranges::stable_sort(m_g4hit_clusters, std::ranges::less(), &ClusterG4Hit::g4hit);
+}
+
+//_____________________________________________________________________
+void SvtxTruthAssocTable::set_cluster_particles(std::vector<ClusterParticle>&& entries)
+{
+  m_cluster_particles = std::move(entries);
+  std::sort(m_cluster_particles.begin(), m_cluster_particles.end(),
+            [](const ClusterParticle& first, const ClusterParticle& second)
+            { return std::tie(first.cluster_key, first.track_id) < std::tie(second.cluster_key, second.track_id); });
+
+  m_particle_clusters = m_cluster_particles;
+  std::ranges::stable_sort(m_particle_clusters, std::ranges::less(), &ClusterParticle::track_id);
+}
+
+//_____________________________________________________________________
+void SvtxTruthAssocTable::set_track_particles(const SvtxTrackMap* track_map, std::vector<TrackParticle>&& entries)
+{
+  m_track_map = track_map;
+  m_track_particles = std::move(entries);
+  std::sort(m_track_particles.begin(), m_track_particles.end(),
+            [](const TrackParticle& first, const TrackParticle& second)
+            { return std::tie(first.track_key, first.track_id) < std::tie(second.track_key, second.track_id); });
+
+  m_particle_tracks = m_track_particles;
+  std::ranges::stable_sort(m_particle_tracks, std::ranges::less(), &TrackParticle::track_id);
+}
+
+//_____________________________________________________________________
+void SvtxTruthAssocTable::set_particle_g4hits(std::vector<ParticleG4Hit>&& entries)
+{
+  m_particle_g4hits = std::move(entries);
+  std::sort(m_particle_g4hits.begin(), m_particle_g4hits.end(),
+            [](const ParticleG4Hit& first, const ParticleG4Hit& second)
+            {
+              if (first.track_id != second.track_id)
+              {
+                return first.track_id < second.track_id;
+              }
+              return std::ranges::less()(first.g4hit, second.g4hit);
+            });
+}
+
+//_____________________________________________________________________
+std::span<const SvtxTruthAssocTable::ClusterG4Hit> SvtxTruthAssocTable::g4hits_from_cluster(TrkrDefs::cluskey cluster_key) const
+{
+  return equal_span(m_cluster_g4hits, cluster_key, &ClusterG4Hit::cluster_key);
+}
+
+//_____________________________________________________________________
+std::span<const SvtxTruthAssocTable::ClusterG4Hit> SvtxTruthAssocTable::clusters_from_g4hit(const PHG4Hit* g4hit) const
+{
+  return equal_span(m_g4hit_clusters, g4hit, [](const ClusterG4Hit& entry) -> const PHG4Hit* { return entry.g4hit; });
+}
+
+//_____________________________________________________________________
+std::span<const SvtxTruthAssocTable::ClusterParticle> SvtxTruthAssocTable::particles_from_cluster(TrkrDefs::cluskey cluster_key) const
+{
+  return equal_span(m_cluster_particles, cluster_key, &ClusterParticle::cluster_key);
+}
+
+//_____________________________________________________________________
+std::span<const SvtxTruthAssocTable::ClusterParticle> SvtxTruthAssocTable::clusters_from_particle(int track_id) const
+{
+  return equal_span(m_particle_clusters, track_id, &ClusterParticle::track_id);
+}
+
+//_____________________________________________________________________
+std::span<const SvtxTruthAssocTable::TrackParticle> SvtxTruthAssocTable::particles_from_track(unsigned int track_key) const
+{
+  return equal_span(m_track_particles, track_key, &TrackParticle::track_key);
+}
+
+//_____________________________________________________________________
+std::span<const SvtxTruthAssocTable::TrackParticle> SvtxTruthAssocTable::tracks_from_particle(int track_id) const
+{
+  return equal_span(m_particle_tracks, track_id, &TrackParticle::track_id);
+}
+
+//_____________________________________________________________________
+std::span<const SvtxTruthAssocTable::ParticleG4Hit> SvtxTruthAssocTable::g4hits_from_particle(int track_id) const
+{
+  return equal_span(m_particle_g4hits, track_id, &ParticleG4Hit::track_id);
+}
@@ -0,0 +1,127 @@
+#ifndef G4EVAL_SVTXTRUTHASSOCTABLE_H
+#define G4EVAL_SVTXTRUTHASSOCTABLE_H
+
+#include <trackbase/TrkrDefs.h>
+
+#include <span>
+#include <vector>
+
+class PHG4Hit;
+class PHG4Particle;
+class SvtxTrackMap;
+
+/*!
+ * flat truth/reco association tables of an event, filled once per event by SvtxTruthAssocTableEval
+ * and used by SvtxTruthEval, SvtxClusterEval and SvtxTrackEval in place of their lazy caches.
+ *
+ * Each association is stored twice, as vectors sorted by either side, so that all lookups
+ * are binary searches returning contiguous ranges. The table is transient, it is not written to DST.
+ */
+class SvtxTruthAssocTable
+{
+ public:
+  //! reco cluster to g4hit association
+  struct ClusterG4Hit
+  {
+    TrkrDefs::cluskey cluster_key{0};
+    PHG4Hit* g4hit{nullptr};
+  };
+
+  //! reco cluster to particle association
+  struct ClusterParticle
+  {
+    TrkrDefs::cluskey cluster_key{0};
+    int track_id{0};
+    PHG4Particle* particle{nullptr};
+
+    //! sum of the particle g4hit energies in the cluster
+    float energy{0};
+
+    //! particle energy over the energy of all g4hits in the cluster
+    float fraction{0};
+  };
+
+  //! reco track to particle association
+  struct TrackParticle
+  {
+    unsigned int track_key{0};
+    int track_id{0};
+    PHG4Particle* particle{nullptr};
+
+    //! number of track clusters associated to the particle
+    unsigned int nclusters{0};
+  };
+
+  //! particle to tracking g4hit association
+  struct ParticleG4Hit
+  {
+    int track_id{0};
+    PHG4Hit* g4hit{nullptr};
+  };
+
+  //! true once the tables have been filled for the current event
+  bool processed() const { return m_processed; }
+  void setProcessed(bool value) { m_processed = value; }
+
+  //! clear all tables, and mark unprocessed
+  void clear();
+
+  //!@name filling. Entries need not be ordered, duplicated cluster to g4hit entries are removed
+  //@{
+  void set_cluster_g4hits(std::vector<ClusterG4Hit>&&);
+  void set_cluster_particles(std::vector<ClusterParticle>&&);
+  void set_track_particles(const SvtxTrackMap*, std::vector<TrackParticle>&&);
+  void set_particle_g4hits(std::vector<ParticleG4Hit>&&);
+  //@}
+
+  //!@name lookups
+  //@{
+  //! track map the track tables were filled from. Track keys are only meaningful for this map
+  const SvtxTrackMap* track_map() const { return m_track_map; }
+
+  //! g4hits of a cluster, ordered by address
+  std::span<const ClusterG4Hit> g4hits_from_cluster(TrkrDefs::cluskey) const;
+
+  //! clusters of a g4hit, ordered by cluster key
+  std::span<const ClusterG4Hit> clusters_from_g4hit(const PHG4Hit*) const;
+
+  //! particles of a cluster, ordered by particle track id
+  std::span<const ClusterParticle> particles_from_cluster(TrkrDefs::cluskey) const;
+
+  //! clusters of a particle track id, ordered by cluster key
+  std::span<const ClusterParticle> clusters_from_particle(int track_id) const;
+
+  //! particles of a track, ordered by particle track id
+  std::span<const TrackParticle> particles_from_track(unsigned int track_key) const;
+
+  //! tracks of a particle track id, ordered by track key
+  std::span<const TrackParticle> tracks_from_particle(int track_id) const;
+
+  //! g4hits of a particle track id, ordered by address
+  std::span<const ParticleG4Hit> g4hits_from_particle(int track_id) const;
+
+  //! all cluster to g4hit entries, ordered by cluster key
+  const std::vector<ClusterG4Hit>& cluster_g4hits() const { return m_cluster_g4hits; }
+
+  //! all cluster to particle entries, ordered by cluster key
+  const std::vector<ClusterParticle>& cluster_particles() const { return m_cluster_particles; }
+
+  //! all track to particle entries, ordered by track key
+  const std::vector<TrackParticle>& track_particles() const { return m_track_particles; }
+  //@}
+
+ private:
+  bool m_processed = false;
+
+  const SvtxTrackMap* m_track_map = nullptr;
+
+  std::vector<ClusterG4Hit> m_cluster_g4hits;
+  std::vector<ClusterG4Hit> m_g4hit_clusters;
+  std::vector<ClusterParticle> m_cluster_particles;
+  std::vector<ClusterParticle> m_particle_clusters;
+  std::vector<TrackParticle> m_track_particles;
+  std::vector<TrackParticle> m_particle_tracks;
+  std::vector<ParticleG4Hit> m_particle_g4hits;
+};
+
+#endif  // G4EVAL_SVTXTRUTHASSOCTABLE_H
@@ -0,0 +1,455 @@
+#include "SvtxTruthAssocTableEval.h"
+
+#include "SvtxClusterEval.h"
+#include "SvtxEvalStack.h"
+#include "SvtxTrackEval.h"
+#include "SvtxTruthAssocTable.h"
+#include "SvtxTruthEval.h"
+
+#include <fun4all/Fun4AllReturnCodes.h>
+#include <phool/PHCompositeNode.h>
+#include <phool/PHDataNode.h>
+#include <phool/PHNode.h>
+#include <phool/PHNodeIterator.h>
+#include <phool/getClass.h>
+#include <phool/phool.h>
+
+#include <g4main/PHG4Hit.h>
+#include <g4main/PHG4HitContainer.h>
+#include <g4main/PHG4Particle.h>
+#include <g4main/PHG4TruthInfoContainer.h>
+
+#include <trackbase/MvtxDefs.h>
+#include <trackbase/TrkrClusterContainer.h>
+#include <trackbase/TrkrClusterHitAssoc.h>
+#include <trackbase/TrkrDefs.h>
+#include <trackbase/TrkrHitTruthAssoc.h>
+
+#include <trackbase_historic/SvtxTrack.h>
+#include <trackbase_historic/SvtxTrackMap.h>
+#include <trackbase_historic/TrackSeed.h>
+
+#include <algorithm>
+#include <iostream>
+#include <set>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace
+{
+  //! cluster container, selected as in SvtxClusterEval
+  TrkrClusterContainer *get_cluster_map(PHCompositeNode *topNode)
+  {
+    auto *clustermap = findNode::getClass<TrkrClusterContainer>(topNode, "CORRECTED_TRKR_CLUSTER");
+    if (!clustermap || clustermap->size() == 0)
+    {
+      clustermap = findNode::getClass<TrkrClusterContainer>(topNode, "TRKR_CLUSTER");
+    }
+    return clustermap;
+  }
+
+  //! hit to g4hit associations of a hitset, sorted by hit key
+  using HitTruthList = std::vector<std::pair<TrkrDefs::hitkey, PHG4HitDefs::keytype>>;
+  void load_hit_truth(const TrkrHitTruthAssoc *hit_truth_map, TrkrDefs::hitsetkey hitsetkey, HitTruthList &list)
+  {
+    list.clear();
+    const auto range = hit_truth_map->getHitSetG4Hits(hitsetkey);
+    for (auto iter = range.first; iter != range.second; ++iter)
+    {
+      list.push_back(iter->second);
+    }
+
+    // stable sort keeps the g4hits of a hit in association order
+    std::ranges::stable_sort(list, std::ranges::less(), &HitTruthList::value_type::first);
+  }
+
+  //! g4hits associated to a hit key
+  std::span<const HitTruthList::value_type> find_hit_truth(const HitTruthList &list, TrkrDefs::hitkey hitkey)
+  {
+    const auto range = std::ranges::equal_range(list, hitkey, std::ranges::less(), &HitTruthList::value_type::first);
+    return {range.begin(), range.end()};
+  }
+
+}  // namespace
+
+//____________________________________________________________________________..
+SvtxTruthAssocTableEval::SvtxTruthAssocTableEval(const std::string &name)
+  : SubsysReco(name)
+{
+}
+
+//____________________________________________________________________________..
+SvtxTruthAssocTableEval::~SvtxTruthAssocTableEval() = default;
+
+//____________________________________________________________________________..
+int SvtxTruthAssocTableEval::InitRun(PHCompositeNode *topNode)
+{
+  return createNodes(topNode);
+}
+
+//____________________________________________________________________________..
+int SvtxTruthAssocTableEval::process_event(PHCompositeNode *topNode)
+{
+  fillTables(topNode);
+
+  if (m_checkEquivalence)
+  {
+    checkEquivalence(topNode);
+  }
+
+  return Fun4AllReturnCodes::EVENT_OK;
+}
+
+//____________________________________________________________________________..
+int SvtxTruthAssocTableEval::ResetEvent(PHCompositeNode * /*unused*/)
+{
+  // tables are only valid for the event they were filled for
+  if (m_table)
+  {
+    m_table->clear();
+  }
+  return Fun4AllReturnCodes::EVENT_OK;
+}
+
+//____________________________________________________________________________..
+int SvtxTruthAssocTableEval::End(PHCompositeNode * /*unused*/)
+{
+  if (m_checkEquivalence)
+  {
+    std::cout << "SvtxTruthAssocTableEval::End - equivalence checks: " << m_nchecks << " mismatches: " << m_nmismatches << std::endl;
+  }
+  return Fun4AllReturnCodes::EVENT_OK;
+}
+
+//____________________________________________________________________________..
+void SvtxTruthAssocTableEval::fillTables(PHCompositeNode *topNode)
+{
+  m_table->clear();
+
+  auto *clustermap = get_cluster_map(topNode);
+  auto *cluster_hit_map = findNode::getClass<TrkrClusterHitAssoc>(topNode, "TRKR_CLUSTERHITASSOC");
+  auto *hit_truth_map = findNode::getClass<TrkrHitTruthAssoc>(topNode, "TRKR_HITTRUTHASSOC");
+  auto *truthinfo = findNode::getClass<PHG4TruthInfoContainer>(topNode, "G4TruthInfo");
+  if (!clustermap || !cluster_hit_map || !hit_truth_map || !truthinfo)
+  {
+    // the evaluators fall back to their own caches
+    if (Verbosity() > 0)
+    {
+      std::cout << PHWHERE << " missing cluster or truth nodes, tables not filled" << std::endl;
+    }
+    return;
+  }
+
+  auto *g4hits_tpc = findNode::getClass<PHG4HitContainer>(topNode, "G4HIT_TPC");
+  auto *g4hits_intt = findNode::getClass<PHG4HitContainer>(topNode, "G4HIT_INTT");
+  auto *g4hits_mvtx = findNode::getClass<PHG4HitContainer>(topNode, "G4HIT_MVTX");
+  auto *g4hits_mms = findNode::getClass<PHG4HitContainer>(topNode, "G4HIT_MICROMEGAS");
+
+  // cluster to g4hit, reading the hit to truth associations once per hitset
+  std::vector<SvtxTruthAssocTable::ClusterG4Hit> cluster_g4hits;
+  HitTruthList hit_truth;
+  HitTruthList bare_hit_truth;
+  for (const auto &hitsetkey : clustermap->getHitSetKeys())
+  {
+    PHG4HitContainer *g4hits = nullptr;
+    switch (TrkrDefs::getTrkrId(hitsetkey))
+    {
+    case TrkrDefs::tpcId:
+      g4hits = g4hits_tpc;
+      break;
+    case TrkrDefs::inttId:
+      g4hits = g4hits_intt;
+      break;
+    case TrkrDefs::mvtxId:
+      g4hits = g4hits_mvtx;
+      break;
+    case TrkrDefs::micromegasId:
+      g4hits = g4hits_mms;
+      break;
+    default:
+      break;
+    }
+    if (!g4hits)
+    {
+      continue;
+    }
+
+    load_hit_truth(hit_truth_map, hitsetkey, hit_truth);
+
+    // mvtx special case, as in TrkrHitTruthAssoc::getG4Hits: hits without association are looked for in the bare hitset
+    const auto layer = TrkrDefs::getLayer(hitsetkey);
+    bool bare_loaded = false;
+
+    const auto range = clustermap->getClusters(hitsetkey);
+    for (auto clusiter = range.first; clusiter != range.second; ++clusiter)
+    {
+      const auto cluster_key = clusiter->first;
+      const auto hitrange = cluster_hit_map->getHits(cluster_key);
+      for (auto hititer = hitrange.first; hititer != hitrange.second; ++hititer)
+      {
+        auto associations = find_hit_truth(hit_truth, hititer->second);
+        if (associations.empty() && layer < 3)
+        {
+          if (!bare_loaded)
+          {
+            const TrkrDefs::hitsetkey bare_hitsetkey = MvtxDefs::genHitSetKey(layer, MvtxDefs::getStaveId(hitsetkey), MvtxDefs::getChipId(hitsetkey), 0);
+            load_hit_truth(hit_truth_map, bare_hitsetkey, bare_hit_truth);
+            bare_loaded = true;
+          }
+          associations = find_hit_truth(bare_hit_truth, hititer->second);
+        }
+
+        for (const auto &association : associations)
+        {
+          PHG4Hit *g4hit = g4hits->findHit(association.second);
+          if (g4hit)
+          {
+            cluster_g4hits.push_back({cluster_key, g4hit});
+          }
+        }
+      }
+    }
+  }
+  m_table->set_cluster_g4hits(std::move(cluster_g4hits));
+
+  /*
+   * cluster to particle, with energies summed in g4hit address order
+   * as SvtxClusterEval::get_energy_contribution does, so that they are identical
+   */
+  std::vector<SvtxTruthAssocTable::ClusterParticle> cluster_particles;
+  const auto &all_cluster_g4hits = m_table->cluster_g4hits();
+  for (auto first = all_cluster_g4hits.begin(); first != all_cluster_g4hits.end();)
+  {
+    const auto cluster_key = first->cluster_key;
+    const auto last = std::find_if(first, all_cluster_g4hits.end(), [cluster_key](const auto &entry)
+                                   { return entry.cluster_key != cluster_key; });
+
+    const auto offset = cluster_particles.size();
+    float total_energy = 0;
+    for (auto iter = first; iter != last; ++iter)
+    {
+      total_energy += iter->g4hit->get_edep();
+
+      const int track_id = iter->g4hit->get_trkid();
+      auto particle_iter = std::find_if(cluster_particles.begin() + offset, cluster_particles.end(), [track_id](const auto &entry)
+                                        { return entry.track_id == track_id; });
+      if (particle_iter == cluster_particles.end())
+      {
+        PHG4Particle *particle = truthinfo->GetParticle(track_id);
+        if (!particle)
+        {
+          continue;
+        }
+        cluster_particles.push_back({cluster_key, track_id, particle, 0, 0});
+        particle_iter = cluster_particles.end() - 1;
+      }
+      particle_iter->energy += iter->g4hit->get_edep();
+    }
+
+    for (auto iter = cluster_particles.begin() + offset; iter != cluster_particles.end(); ++iter)
+    {
+      iter->fraction = (total_energy > 0) ? iter->energy / total_energy : 0;
+    }
+    first = last;
+  }
+  m_table->set_cluster_particles(std::move(cluster_particles));
+
+  // track to particle, counting track clusters as SvtxTrackEval::calc_cluster_contribution
+  auto *trackmap = findNode::getClass<SvtxTrackMap>(topNode, m_trackNodeName);
+  if (trackmap)
+  {
+    std::vector<SvtxTruthAssocTable::TrackParticle> track_particles;
+    for (const auto &[key, track] : *trackmap)
+    {
+      const auto offset = track_particles.size();
+      const auto add_cluster_contributions = [&](const TrackSeed *seed)
+      {
+        if (!seed)
+        {
+          return;
+        }
+
+        for (auto clusiter = seed->begin_cluster_keys(); clusiter != seed->end_cluster_keys(); ++clusiter)
+        {
+          for (const auto &entry : m_table->particles_from_cluster(*clusiter))
+          {
+            const auto particle_iter = std::find_if(track_particles.begin() + offset, track_particles.end(), [&entry](const auto &candidate)
+                                                    { return candidate.track_id == entry.track_id; });
+            if (particle_iter == track_particles.end())
+            {
+              track_particles.push_back({key, entry.track_id, entry.particle, 1});
+            }
+            else
+            {
+              ++particle_iter->nclusters;
+            }
+          }
+        }
+      };
+
+      add_cluster_contributions(track->get_silicon_seed());
+      add_cluster_contributions(track->get_tpc_seed());
+    }
+    m_table->set_track_particles(trackmap, std::move(track_particles));
+  }
+
+  // particle to g4hit
+  std::vector<SvtxTruthAssocTable::ParticleG4Hit> particle_g4hits;
+  for (auto *container : {g4hits_tpc, g4hits_intt, g4hits_mvtx, g4hits_mms})
+  {
+    if (!container)
+    {
+      continue;
+    }
+    const auto range = container->getHits();
+    for (auto iter = range.first; iter != range.second; ++iter)
+    {
+      particle_g4hits.push_back({iter->second->get_trkid(), iter->second});
+    }
+  }
+  m_table->set_particle_g4hits(std::move(particle_g4hits));
+
+  m_table->setProcessed(true);
+
+  if (Verbosity() > 1)
+  {
+    std::cout << "SvtxTruthAssocTableEval::fillTables -"
+              << " cluster/g4hit: " << m_table->cluster_g4hits().size()
+              << " cluster/particle: " << m_table->cluster_particles().size()
+              << " track/particle: " << m_table->track_particles().size()
+              << std::endl;
+  }
+}
+
+//____________________________________________________________________________..
+void SvtxTruthAssocTableEval::checkEquivalence(PHCompositeNode *topNode)
+{
+  // evaluators with and without the tables
+  for (auto *stack : {&m_referenceEvalStack, &m_tableEvalStack})
+  {
+    if (!*stack)
+    {
+      *stack = std::make_unique<SvtxEvalStack>(topNode);
+      (*stack)->set_strict(false);
+      (*stack)->set_track_nodename(m_trackNodeName);
+    }
+    (*stack)->next_event(topNode);
+  }
+  m_referenceEvalStack->get_track_eval()->set_use_assoc_table(false);
+
+  const auto check = [this](bool same, const std::string &what, unsigned long long key)
+  {
+    ++m_nchecks;
+    if (!same)
+    {
+      ++m_nmismatches;
+      if (Verbosity() > 0)
+      {
+        std::cout << "SvtxTruthAssocTableEval::checkEquivalence - " << what << " differs for " << key << std::endl;
+      }
+    }
+  };
+
+  // clusters
+  auto *reference_clustereval = m_referenceEvalStack->get_cluster_eval();
+  auto *table_clustereval = m_tableEvalStack->get_cluster_eval();
+  std::set<PHG4Particle *> particles;
+  std::set<PHG4Hit *> g4hits;
+  if (auto *clustermap = get_cluster_map(topNode))
+  {
+    for (const auto &hitsetkey : clustermap->getHitSetKeys())
+    {
+      const auto range = clustermap->getClusters(hitsetkey);
+      for (auto iter = range.first; iter != range.second; ++iter)
+      {
+        const auto cluster_key = iter->first;
+        const auto cluster_g4hits = reference_clustereval->all_truth_hits(cluster_key);
+        check(cluster_g4hits == table_clustereval->all_truth_hits(cluster_key), "all_truth_hits(cluster)", cluster_key);
+        g4hits.insert(cluster_g4hits.begin(), cluster_g4hits.end());
+
+        const auto cluster_particles = reference_clustereval->all_truth_particles(cluster_key);
+        check(cluster_particles == table_clustereval->all_truth_particles(cluster_key), "all_truth_particles(cluster)", cluster_key);
+        for (auto *particle : cluster_particles)
+        {
+          check(reference_clustereval->get_energy_contribution(cluster_key, particle) == table_clustereval->get_energy_contribution(cluster_key, particle), "get_energy_contribution(cluster, particle)", cluster_key);
+        }
+        check(reference_clustereval->max_truth_particle_by_energy(cluster_key) == table_clustereval->max_truth_particle_by_energy(cluster_key), "max_truth_particle_by_energy", cluster_key);
+        particles.insert(cluster_particles.begin(), cluster_particles.end());
+      }
+    }
+  }
+
+  for (auto *g4hit : g4hits)
+  {
+    check(reference_clustereval->all_clusters_from(g4hit) == table_clustereval->all_clusters_from(g4hit), "all_clusters_from(g4hit)", g4hit->get_hit_id());
+    check(reference_clustereval->best_cluster_from(g4hit) == table_clustereval->best_cluster_from(g4hit), "best_cluster_from(g4hit)", g4hit->get_hit_id());
+  }
+
+  auto *reference_trutheval = m_referenceEvalStack->get_truth_eval();
+  auto *table_trutheval = m_tableEvalStack->get_truth_eval();
+  for (auto *particle : particles)
+  {
+    check(reference_clustereval->all_clusters_from(particle) == table_clustereval->all_clusters_from(particle), "all_clusters_from(particle)", particle->get_track_id());
+    check(reference_trutheval->all_truth_hits(particle) == table_trutheval->all_truth_hits(particle), "all_truth_hits(particle)", particle->get_track_id());
+  }
+
+  // tracks
+  auto *trackmap = findNode::getClass<SvtxTrackMap>(topNode, m_trackNodeName);
+  if (!trackmap)
+  {
+    return;
+  }
+
+  auto *reference_trackeval = m_referenceEvalStack->get_track_eval();
+  auto *table_trackeval = m_tableEvalStack->get_track_eval();
+  std::set<PHG4Particle *> track_particles;
+  for (const auto &[key, track] : *trackmap)
+  {
+    const auto truth_particles = reference_trackeval->all_truth_particles(track);
+    check(truth_particles == table_trackeval->all_truth_particles(track), "all_truth_particles(track)", key);
+    for (auto *particle : truth_particles)
+    {
+      check(reference_trackeval->get_nclusters_contribution(track, particle) == table_trackeval->get_nclusters_contribution(track, particle), "get_nclusters_contribution", key);
+      check(reference_trackeval->get_nwrongclusters_contribution(track, particle) == table_trackeval->get_nwrongclusters_contribution(track, particle), "get_nwrongclusters_contribution", key);
+    }
+    check(reference_trackeval->max_truth_particle_by_nclusters(track) == table_trackeval->max_truth_particle_by_nclusters(track), "max_truth_particle_by_nclusters", key);
+    track_particles.insert(truth_particles.begin(), truth_particles.end());
+  }
+
+  for (auto *particle : track_particles)
+  {
+    check(reference_trackeval->all_tracks_from(particle) == table_trackeval->all_tracks_from(particle), "all_tracks_from(particle)", particle->get_track_id());
+    check(reference_trackeval->best_track_from(particle) == table_trackeval->best_track_from(particle), "best_track_from(particle)", particle->get_track_id());
+  }
+}
+
+//____________________________________________________________________________..
+int SvtxTruthAssocTableEval::createNodes(PHCompositeNode *topNode)
+{
+  PHNodeIterator iter(topNode);
+
+  PHCompositeNode *dstNode = dynamic_cast<PHCompositeNode *>(iter.findFirst("PHCompositeNode", "DST"));
+  if (!dstNode)
+  {
+    std::cout << PHWHERE << " DST node is missing, quitting" << std::endl;
+    return Fun4AllReturnCodes::ABORTRUN;
+  }
+
+  PHCompositeNode *svtxNode = dynamic_cast<PHCompositeNode *>(iter.findFirst("PHCompositeNode", "SVTX"));
+  if (!svtxNode)
+  {
+    svtxNode = new PHCompositeNode("SVTX");
+    dstNode->addNode(svtxNode);
+  }
+
+  // transient node, not written out
+  m_table = findNode::getClass<SvtxTruthAssocTable>(topNode, "SvtxTruthAssocTable");
+  if (!m_table)
+  {
+    m_table = new SvtxTruthAssocTable;
+    svtxNode->addNode(new PHDataNode<SvtxTruthAssocTable>(m_table, "SvtxTruthAssocTable"));
+  }
+
+  return Fun4AllReturnCodes::EVENT_OK;
+}
@@ -0,0 +1,69 @@
+#ifndef SVTXTRUTHASSOCTABLEEVAL_H
+#define SVTXTRUTHASSOCTABLEEVAL_H
+
+#include <fun4all/SubsysReco.h>
+
+#include <memory>
+#include <string>
+
+class PHCompositeNode;
+class SvtxEvalStack;
+class SvtxTruthAssocTable;
+
+/*!
+ * fills the SvtxTruthAssocTable node once per event: cluster to g4hit, cluster to particle
+ * with energy fractions, track to particle and particle to g4hit associations.
+ * Hit to truth associations are read once per hitset, rather than once per query.
+ * Must run before the modules using SvtxEvalStack, which then read the tables in place of their caches.
+ */
+class SvtxTruthAssocTableEval : public SubsysReco
+{
+ public:
+  SvtxTruthAssocTableEval(const std::string &name = "SvtxTruthAssocTableEval");
+
+  ~SvtxTruthAssocTableEval() override;
+
+  int InitRun(PHCompositeNode *topNode) override;
+  int process_event(PHCompositeNode *topNode) override;
+  int ResetEvent(PHCompositeNode *topNode) override;
+  int End(PHCompositeNode *topNode) override;
+
+  void set_track_nodename(const std::string &name) { m_trackNodeName = name; }
+
+  //! compare, for every cluster, track and associated particle, the eval answers with and without the tables
+  /*! this is slow, and meant for validation only */
+  void set_check_equivalence(bool value) { m_checkEquivalence = value; }
+
+  //!@name equivalence check results, summed over all events
+  //@{
+  unsigned long get_nchecks() const { return m_nchecks; }
+  unsigned long get_nmismatches() const { return m_nmismatches; }
+  //@}
+
+ private:
+  int createNodes(PHCompositeNode *topNode);
+
+  void fillTables(PHCompositeNode *topNode);
+
+  void checkEquivalence(PHCompositeNode *topNode);
+
+  std::string m_trackNodeName = "SvtxTrackMap";
+
+  bool m_checkEquivalence = false;
+
+  SvtxTruthAssocTable *m_table = nullptr;
+
+  //!@name evaluators used for the equivalence check, with and without the tables
+  //@{
+  std::unique_ptr<SvtxEvalStack> m_referenceEvalStack;
+  std::unique_ptr<SvtxEvalStack> m_tableEvalStack;
+  //@}
+
+  //!@name equivalence check counters
+  //@{
+  unsigned long m_nchecks = 0;
+  unsigned long m_nmismatches = 0;
+  //@}
+};
+
+#endif  // SVTXTRUTHASSOCTABLEEVAL_H
@@ -0,0 +1,381 @@
+/**
+ * @file g4eval/SvtxTruthAssocTableTest.cc
+ * @brief check that the Svtx evaluators give the same answers with and without the SvtxTruthAssocTable
+ *
+ * usage: SvtxTruthAssocTableTest
+ *
+ * A small event is built in memory: particles and g4hits in the MVTX, INTT and TPC, clusters
+ * and their hits, hit to g4hit associations (for MVTX partly only in the bare, strobe 0,
+ * hitset), and two track maps with different content for the same track keys.
+ * SvtxTruthAssocTableEval fills the tables from SvtxTrackMap, with its own equivalence check
+ * enabled. Every cluster, g4hit, particle and track query of an SvtxEvalStack reading the
+ * tables is then compared to one which does not, for SvtxTrackMap and for the other track
+ * map, whose tracks must not be looked up in the tables.
+ */
+#include "SvtxClusterEval.h"
+#include "SvtxEvalStack.h"
+#include "SvtxTrackEval.h"
+#include "SvtxTruthAssocTable.h"
+#include "SvtxTruthAssocTableEval.h"
+#include "SvtxTruthEval.h"
+
+#include <g4main/PHG4Hit.h>
+#include <g4main/PHG4HitContainer.h>
+#include <g4main/PHG4Hitv1.h>
+#include <g4main/PHG4Particle.h>
+#include <g4main/PHG4Particlev2.h>
+#include <g4main/PHG4TruthInfoContainer.h>
+#include <g4main/PHG4VtxPointv1.h>
+
+#include <trackbase/InttDefs.h>
+#include <trackbase/MvtxDefs.h>
+#include <trackbase/TpcDefs.h>
+#include <trackbase/TrkrClusterContainerv4.h>
+#include <trackbase/TrkrClusterHitAssocv3.h>
+#include <trackbase/TrkrClusterv5.h>
+#include <trackbase/TrkrDefs.h>
+#include <trackbase/TrkrHitTruthAssocv1.h>
+
+#include <trackbase_historic/SvtxTrackMap_v2.h>
+#include <trackbase_historic/SvtxTrack_v4.h>
+#include <trackbase_historic/TrackSeed_v2.h>
+
+#include <fun4all/Fun4AllReturnCodes.h>
+
+#include <phool/PHCompositeNode.h>
+#include <phool/PHIODataNode.h>
+#include <phool/PHNodeIterator.h>
+#include <phool/PHObject.h>
+#include <phool/getClass.h>
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+  const std::string default_track_map = "SvtxTrackMap";
+  const std::string other_track_map = "SvtxSiliconMMTrackMap";
+
+  //! hit of a cluster, and the g4hits associated to it in the hitset and in the bare (strobe 0) mvtx hitset
+  struct TestHit
+  {
+    TrkrDefs::hitkey hitkey{0};
+    std::vector<PHG4Hit*> g4hits;
+    std::vector<PHG4Hit*> bare_g4hits;
+  };
+
+  //! in memory event, the track seeds are referenced by the tracks and must outlive them
+  class TestEvent
+  {
+   public:
+    TestEvent()
+      : m_topNode(std::make_unique<PHCompositeNode>("TOP"))
+    {
+      m_topNode->addNode(new PHCompositeNode("DST"));
+      fill();
+    }
+
+    PHCompositeNode* topNode() const { return m_topNode.get(); }
+
+   private:
+    PHCompositeNode* dst_node() const
+    {
+      PHNodeIterator iter(m_topNode.get());
+      return dynamic_cast<PHCompositeNode*>(iter.findFirst("PHCompositeNode", "DST"));
+    }
+
+    template <class T>
+    T* add_node(T* object, const std::string& name)
+    {
+      dst_node()->addNode(new PHIODataNode<PHObject>(object, name, "PHObject"));
+      return object;
+    }
+
+    PHG4Hit* add_g4hit(PHG4HitContainer* container, const unsigned int layer, const int track_id, const float edep)
+    {
+      auto* g4hit = new PHG4Hitv1;
+      g4hit->set_layer(layer);
+      g4hit->set_trkid(track_id);
+      g4hit->set_edep(edep);
+      g4hit->set_x(0, static_cast<float>(layer));
+      g4hit->set_x(1, static_cast<float>(layer));
+      return container->AddHit(layer, g4hit)->second;
+    }
+
+    void add_cluster(const TrkrDefs::cluskey cluster_key, const std::vector<TestHit>& hits)
+    {
+      const auto hitsetkey = TrkrDefs::getHitSetKeyFromClusKey(cluster_key);
+      m_clusters->addClusterSpecifyKey(cluster_key, new TrkrClusterv5);
+      for (const auto& hit : hits)
+      {
+        m_cluster_hits->addAssoc(cluster_key, hit.hitkey);
+        for (auto* g4hit : hit.g4hits)
+        {
+          m_hit_truth->addAssoc(hitsetkey, hit.hitkey, g4hit->get_hit_id());
+        }
+        for (auto* g4hit : hit.bare_g4hits)
+        {
+          const auto bare_hitsetkey = MvtxDefs::genHitSetKey(TrkrDefs::getLayer(hitsetkey), MvtxDefs::getStaveId(hitsetkey), MvtxDefs::getChipId(hitsetkey), 0);
+          m_hit_truth->addAssoc(bare_hitsetkey, hit.hitkey, g4hit->get_hit_id());
+        }
+      }
+    }
+
+    TrackSeed* make_seed(const std::vector<TrkrDefs::cluskey>& cluster_keys)
+    {
+      m_seeds.push_back(std::make_unique<TrackSeed_v2>());
+      for (const auto& cluster_key : cluster_keys)
+      {
+        m_seeds.back()->insert_cluster_key(cluster_key);
+      }
+      return m_seeds.back().get();
+    }
+
+    void add_track(SvtxTrackMap* trackmap, const unsigned int key, const std::vector<TrkrDefs::cluskey>& silicon, const std::vector<TrkrDefs::cluskey>& tpc)
+    {
+      SvtxTrack_v4 track;
+      track.set_silicon_seed(silicon.empty() ? nullptr : make_seed(silicon));
+      track.set_tpc_seed(tpc.empty() ? nullptr : make_seed(tpc));
+      trackmap->insertWithKey(&track, key);
+    }
+
+    void fill()
+    {
+      auto* truthinfo = add_node(new PHG4TruthInfoContainer, "G4TruthInfo");
+      truthinfo->AddVertex(1, new PHG4VtxPointv1(0, 0, 0, 0, 1));
+      for (int track_id = 1; track_id <= 3; ++track_id)
+      {
+        auto* particle = new PHG4Particlev2("pi+", 211, track_id, 0.5, 1);
+        particle->set_track_id(track_id);
+        particle->set_vtx_id(1);
+        particle->set_primary_id(track_id);
+        truthinfo->AddParticle(track_id, particle);
+      }
+
+      auto* g4hits_mvtx = add_node(new PHG4HitContainer("G4HIT_MVTX"), "G4HIT_MVTX");
+      auto* g4hits_intt = add_node(new PHG4HitContainer("G4HIT_INTT"), "G4HIT_INTT");
+      auto* g4hits_tpc = add_node(new PHG4HitContainer("G4HIT_TPC"), "G4HIT_TPC");
+      m_clusters = add_node(new TrkrClusterContainerv4, "TRKR_CLUSTER");
+      m_cluster_hits = add_node(new TrkrClusterHitAssocv3, "TRKR_CLUSTERHITASSOC");
+      m_hit_truth = add_node(new TrkrHitTruthAssocv1, "TRKR_HITTRUTHASSOC");
+
+      // mvtx, strobe 1. Some hits are only associated in the bare hitset
+      auto* m1 = add_g4hit(g4hits_mvtx, 0, 1, 0.5);
+      auto* m2 = add_g4hit(g4hits_mvtx, 0, 1, 0.25);
+      auto* m3 = add_g4hit(g4hits_mvtx, 0, 2, 0.75);
+      auto* m4 = add_g4hit(g4hits_mvtx, 0, 3, 0.125);
+      const auto mvtx_c0 = MvtxDefs::genClusKey(0, 1, 2, 1, 0);
+      const auto mvtx_c1 = MvtxDefs::genClusKey(0, 1, 2, 1, 1);
+      add_cluster(mvtx_c0, {{MvtxDefs::genHitKey(10, 20), {m1}, {}}, {MvtxDefs::genHitKey(11, 20), {}, {m2}}});
+      add_cluster(mvtx_c1, {{MvtxDefs::genHitKey(30, 40), {}, {m3, m4}}});
+
+      // intt, one hit shared by two particles
+      auto* i1 = add_g4hit(g4hits_intt, 3, 1, 1.5);
+      auto* i2 = add_g4hit(g4hits_intt, 3, 2, 2.5);
+      auto* i3 = add_g4hit(g4hits_intt, 3, 1, 0.5);
+      auto* i4 = add_g4hit(g4hits_intt, 3, 3, 1);
+      const auto intt_c0 = InttDefs::genClusKey(3, 0, 5, 0, 0);
+      const auto intt_c1 = InttDefs::genClusKey(3, 0, 5, 0, 1);
+      add_cluster(intt_c0, {{InttDefs::genHitKey(1, 2), {i1}, {}}, {InttDefs::genHitKey(2, 2), {i2, i3}, {}}});
+      add_cluster(intt_c1, {{InttDefs::genHitKey(7, 2), {i4}, {}}});
+
+      // tpc, with one g4hit in two clusters, a cluster without truth and a g4hit without cluster
+      auto* t1 = add_g4hit(g4hits_tpc, 10, 1, 3);
+      auto* t2 = add_g4hit(g4hits_tpc, 10, 1, 1);
+      auto* t3 = add_g4hit(g4hits_tpc, 10, 2, 2);
+      auto* t4 = add_g4hit(g4hits_tpc, 10, 2, 4);
+      auto* t5 = add_g4hit(g4hits_tpc, 10, 3, 5);
+      add_g4hit(g4hits_tpc, 10, 3, 6);
+      const auto tpc_c0 = TpcDefs::genClusKey(10, 3, 1, 0);
+      const auto tpc_c1 = TpcDefs::genClusKey(10, 3, 1, 1);
+      const auto tpc_c2 = TpcDefs::genClusKey(10, 3, 1, 2);
+      const auto tpc_c3 = TpcDefs::genClusKey(10, 3, 1, 3);
+      add_cluster(tpc_c0, {{TpcDefs::genHitKey(5, 100), {t1, t2}, {}}, {TpcDefs::genHitKey(6, 100), {t3}, {}}});
+      add_cluster(tpc_c1, {{TpcDefs::genHitKey(20, 200), {t4}, {}}, {TpcDefs::genHitKey(21, 200), {t3}, {}}});
+      add_cluster(tpc_c2, {{TpcDefs::genHitKey(40, 300), {t5}, {}}});
+      add_cluster(tpc_c3, {{TpcDefs::genHitKey(60, 400), {}, {}}});
+
+      // the same track keys, with different clusters, in the two maps
+      auto* trackmap = add_node(new SvtxTrackMap_v2, default_track_map);
+      add_track(trackmap, 0, {mvtx_c0, intt_c0}, {tpc_c0, tpc_c1});
+      add_track(trackmap, 1, {mvtx_c1, intt_c1}, {tpc_c2, tpc_c3});
+      add_track(trackmap, 2, {}, {tpc_c1});
+
+      auto* other_trackmap = add_node(new SvtxTrackMap_v2, other_track_map);
+      add_track(other_trackmap, 0, {mvtx_c1}, {tpc_c2});
+      add_track(other_trackmap, 1, {mvtx_c0, intt_c1}, {});
+      add_track(other_trackmap, 7, {intt_c0}, {tpc_c0, tpc_c3});
+    }
+
+    std::unique_ptr<PHCompositeNode> m_topNode;
+    std::vector<std::unique_ptr<TrackSeed_v2>> m_seeds;
+    TrkrClusterContainer* m_clusters{nullptr};
+    TrkrClusterHitAssoc* m_cluster_hits{nullptr};
+    TrkrHitTruthAssoc* m_hit_truth{nullptr};
+  };
+
+  //! counts the compared queries and reports the differences
+  class Comparison
+  {
+   public:
+    explicit Comparison(std::string label)
+      : m_label(std::move(label))
+    {
+    }
+
+    void check(const bool same, const std::string& what, const uint64_t key)
+    {
+      ++m_nchecks;
+      if (!same)
+      {
+        ++m_nmismatches;
+        std::cout << "SvtxTruthAssocTableTest - " << m_label << ": " << what << " differs for " << key << std::endl;
+      }
+    }
+
+    unsigned int nchecks() const { return m_nchecks; }
+    unsigned int nmismatches() const { return m_nmismatches; }
+
+   private:
+    std::string m_label;
+    unsigned int m_nchecks{0};
+    unsigned int m_nmismatches{0};
+  };
+
+  std::unique_ptr<SvtxEvalStack> make_eval_stack(PHCompositeNode* topNode, const std::string& trackmapname, const bool use_assoc_table)
+  {
+    auto stack = std::make_unique<SvtxEvalStack>(topNode);
+    stack->set_strict(false);
+    stack->set_track_nodename(trackmapname);
+    stack->next_event(topNode);
+    stack->get_track_eval()->set_use_assoc_table(use_assoc_table);
+    return stack;
+  }
+
+  //! compare all cluster, g4hit, particle and track queries with and without the tables
+  bool compare_evals(PHCompositeNode* topNode, const std::string& trackmapname)
+  {
+    auto reference = make_eval_stack(topNode, trackmapname, false);
+    auto table = make_eval_stack(topNode, trackmapname, true);
+    Comparison comparison(trackmapname);
+
+    auto* truthinfo = findNode::getClass<PHG4TruthInfoContainer>(topNode, "G4TruthInfo");
+    std::vector<PHG4Particle*> particles;
+    const auto particle_range = truthinfo->GetParticleRange();
+    for (auto iter = particle_range.first; iter != particle_range.second; ++iter)
+    {
+      particles.push_back(iter->second);
+    }
+
+    // clusters
+    auto* reference_clustereval = reference->get_cluster_eval();
+    auto* table_clustereval = table->get_cluster_eval();
+    auto* clustermap = findNode::getClass<TrkrClusterContainer>(topNode, "TRKR_CLUSTER");
+    for (const auto& hitsetkey : clustermap->getHitSetKeys())
+    {
+      const auto range = clustermap->getClusters(hitsetkey);
+      for (auto iter = range.first; iter != range.second; ++iter)
+      {
+        const auto cluster_key = iter->first;
+        comparison.check(reference_clustereval->all_truth_hits(cluster_key) == table_clustereval->all_truth_hits(cluster_key), "all_truth_hits(cluster)", cluster_key);
+        comparison.check(reference_clustereval->all_truth_particles(cluster_key) == table_clustereval->all_truth_particles(cluster_key), "all_truth_particles(cluster)", cluster_key);
+        comparison.check(reference_clustereval->max_truth_particle_by_energy(cluster_key) == table_clustereval->max_truth_particle_by_energy(cluster_key), "max_truth_particle_by_energy", cluster_key);
+        for (auto* particle : particles)
+        {
+          comparison.check(reference_clustereval->get_energy_contribution(cluster_key, particle) == table_clustereval->get_energy_contribution(cluster_key, particle), "get_energy_contribution(cluster, particle)", cluster_key);
+        }
+      }
+    }
+
+    // g4hits
+    for (const auto& name : {"G4HIT_MVTX", "G4HIT_INTT", "G4HIT_TPC"})
+    {
+      const auto range = findNode::getClass<PHG4HitContainer>(topNode, name)->getHits();
+      for (auto iter = range.first; iter != range.second; ++iter)
+      {
+        auto* g4hit = iter->second;
+        comparison.check(reference_clustereval->all_clusters_from(g4hit) == table_clustereval->all_clusters_from(g4hit), "all_clusters_from(g4hit)", g4hit->get_hit_id());
+        comparison.check(reference_clustereval->best_cluster_from(g4hit) == table_clustereval->best_cluster_from(g4hit), "best_cluster_from(g4hit)", g4hit->get_hit_id());
+      }
+    }
+
+    // particles
+    auto* reference_trutheval = reference->get_truth_eval();
+    auto* table_trutheval = table->get_truth_eval();
+    auto* reference_trackeval = reference->get_track_eval();
+    auto* table_trackeval = table->get_track_eval();
+    for (auto* particle : particles)
+    {
+      const auto track_id = particle->get_track_id();
+      comparison.check(reference_clustereval->all_clusters_from(particle) == table_clustereval->all_clusters_from(particle), "all_clusters_from(particle)", track_id);
+      comparison.check(reference_trutheval->all_truth_hits(particle) == table_trutheval->all_truth_hits(particle), "all_truth_hits(particle)", track_id);
+      comparison.check(reference_trackeval->all_tracks_from(particle) == table_trackeval->all_tracks_from(particle), "all_tracks_from(particle)", track_id);
+      comparison.check(reference_trackeval->best_track_from(particle) == table_trackeval->best_track_from(particle), "best_track_from(particle)", track_id);
+    }
+
+    // tracks
+    for (const auto& [key, track] : *findNode::getClass<SvtxTrackMap>(topNode, trackmapname))
+    {
+      comparison.check(reference_trackeval->all_truth_particles(track) == table_trackeval->all_truth_particles(track), "all_truth_particles(track)", key);
+      comparison.check(reference_trackeval->max_truth_particle_by_nclusters(track) == table_trackeval->max_truth_particle_by_nclusters(track), "max_truth_particle_by_nclusters", key);
+      for (auto* particle : particles)
+      {
+        comparison.check(reference_trackeval->get_nclusters_contribution(track, particle) == table_trackeval->get_nclusters_contribution(track, particle), "get_nclusters_contribution", key);
+        comparison.check(reference_trackeval->get_nwrongclusters_contribution(track, particle) == table_trackeval->get_nwrongclusters_contribution(track, particle), "get_nwrongclusters_contribution", key);
+      }
+    }
+
+    std::cout << "SvtxTruthAssocTableTest - " << trackmapname << ": " << comparison.nchecks() << " queries compared, "
+              << comparison.nmismatches() << " differ" << std::endl;
+    return comparison.nchecks() > 0 && comparison.nmismatches() == 0;
+  }
+}  // namespace
+
+int main()
+{
+  TestEvent event;
+  PHCompositeNode* topNode = event.topNode();
+
+  SvtxTruthAssocTableEval tableEval;
+  tableEval.set_check_equivalence(true);
+  if (tableEval.InitRun(topNode) != Fun4AllReturnCodes::EVENT_OK || tableEval.process_event(topNode) != Fun4AllReturnCodes::EVENT_OK)
+  {
+    std::cout << "SvtxTruthAssocTableTest - SvtxTruthAssocTableEval failed" << std::endl;
+    return 1;
+  }
+
+  // the tables must be filled, from the default track map, for the comparison to mean anything
+  auto* table = findNode::getClass<SvtxTruthAssocTable>(topNode, "SvtxTruthAssocTable");
+  if (!table || !table->processed() || table->cluster_particles().empty() || table->track_particles().empty() ||
+      table->track_map() != findNode::getClass<SvtxTrackMap>(topNode, default_track_map))
+  {
+    std::cout << "SvtxTruthAssocTableTest - tables not filled from " << default_track_map << std::endl;
+    return 1;
+  }
+
+  bool success = true;
+  if (tableEval.get_nchecks() == 0 || tableEval.get_nmismatches() != 0)
+  {
+    std::cout << "SvtxTruthAssocTableTest - SvtxTruthAssocTableEval equivalence check: " << tableEval.get_nchecks()
+              << " queries compared, " << tableEval.get_nmismatches() << " differ" << std::endl;
+    success = false;
+  }
+
+  for (const auto& trackmapname : {default_track_map, other_track_map})
+  {
+    success = compare_evals(topNode, trackmapname) && success;
+  }
+
+  if (!success)
+  {
+    std::cout << "SvtxTruthAssocTableTest - FAILED" << std::endl;
+    return 1;
+  }
+  std::cout << "SvtxTruthAssocTableTest - all checks passed" << std::endl;
+  return 0;
+}
@@ -1,6 +1,7 @@
 #include "SvtxTruthEval.h"
 
 #include "BaseTruthEval.h"
+#include "SvtxTruthAssocTable.h"
 
 #include <g4main/PHG4Hit.h>
 #include <g4main/PHG4HitContainer.h>
@@ -173,6 +174,17 @@ std::set<PHG4Hit*> SvtxTruthEval::all_truth_hits(PHG4Particle* particle)
     ++_errors;
     return std::set<PHG4Hit*>();
   }
+
+  if (_use_assoc_table && _assoc_table && _assoc_table->processed())
+  {
+    std::set<PHG4Hit*> truth_hits;
+    for (const auto& entry : _assoc_table->g4hits_from_particle(particle->get_track_id()))
+    {
+      truth_hits.insert(entry.g4hit);
+    }
+    return truth_hits;
+  }
+
   //  if( _cache_all_truth_hits_g4particle.count(particle)==0){
   if (_cache_all_truth_hits_g4particle.empty())
   {
@@ -1199,6 +1211,7 @@ void SvtxTruthEval::get_node_pointers(PHCompositeNode* topNode)
 {
   _tgeometry = findNode::getClass<ActsGeometry>(topNode, "ActsGeometry");
   _truthinfo = findNode::getClass<PHG4TruthInfoContainer>(topNode, "G4TruthInfo");
+  _assoc_table = findNode::getClass<SvtxTruthAssocTable>(topNode, "SvtxTruthAssocTable");
 
   _g4hits_mms = findNode::getClass<PHG4HitContainer>(topNode, "G4HIT_MICROMEGAS");
   _g4hits_svtx = findNode::getClass<PHG4HitContainer>(topNode, "G4HIT_TPC");
@@ -17,6 +17,7 @@ class PHG4VtxPoint;
 class TrkrCluster;
 class ActsGeometry;
 class PHParametersContainer;
+class SvtxTruthAssocTable;
 
 #include <map>
 #include <memory>
@@ -31,6 +32,8 @@ class SvtxTruthEval
 
   void next_event(PHCompositeNode* topNode);
   void do_caching(bool do_cache) { _do_cache = do_cache; }
+  //! read associations from the SvtxTruthAssocTable node when filled, rather than from caches
+  void set_use_assoc_table(bool use_assoc_table) { _use_assoc_table = use_assoc_table; }
   void set_strict(bool strict)
   {
     _strict = strict;
@@ -94,6 +97,7 @@ class SvtxTruthEval
   PHG4CylinderGeomContainer* _mvtx_geom_container{};
   PHG4CylinderGeomContainer* _mms_geom_container{};
   ActsGeometry* _tgeometry = nullptr;
+  const SvtxTruthAssocTable* _assoc_table = nullptr;
 
   bool _strict = false;
   int _verbosity = 0;
@@ -107,6 +111,8 @@ class SvtxTruthEval
 
   std::multimap<TrkrDefs::cluskey, PHG4Hit*> _truth_cluster_truth_hit_map;
 
+  bool _use_assoc_table = true;
+
   bool _do_cache = true;
   std::set<PHG4Hit*> _cache_all_truth_hits;
   std::map<PHG4Particle*, std::set<PHG4Hit*>> _cache_all_truth_hits_g4particle;
@@ -574,7 +574,7 @@ int PHG4InttHitReco::process_event(PHCompositeNode *topNode)
       {
         // Otherwise, create a new one
         hit = new TrkrHitv2();
-        hitsetit->second->addHitSpecificKey(hitkey, hit);
+        hit = hitsetit->second->addHitSpecificKey(hitkey, hit)->second;
       }
 
       // Either way, add the energy to it
@@ -704,7 +704,7 @@ void PHG4InttHitReco::addtruthhitset(
   {
     // create a new one
     hit = new TrkrHitv2();
-    hitsetit->second->addHitSpecificKey(hitkey, hit);
+    hit = hitsetit->second->addHitSpecificKey(hitkey, hit)->second;
   }
   // Either way, add the energy to it  -- adc values will be added at digitization
   hit->addEnergy(neffelectrons);
@@ -11,6 +11,7 @@
 #include <g4main/PHG4DisplayAction.h>  // for PHG4DisplayAction
 #include <g4main/PHG4HitContainer.h>
 #include <g4main/PHG4SteppingAction.h>  // for PHG4SteppingAction
+#include <g4main/PHG4WorkerEventAction.h>
 
 #include <phool/PHCompositeNode.h>
 #include <phool/PHIODataNode.h>    // for PHIODataNode
@@ -126,21 +127,41 @@ int PHG4InttSubsystem::InitRunSubsystem(PHCompositeNode *topNode)
         DetNode->addNode(new PHIODataNode<PHObject>(g4_hits, nodename, "PHObject"));
       }
     }
-    // create stepping action
-    m_SteppingAction = new PHG4InttSteppingAction(m_Detector, GetParamsContainer(), layer_begin_end);
-    m_SteppingAction->Verbosity(Verbosity());
-    m_SteppingAction->SetHitNodeName("G4HIT", m_HitNodeName);
-    m_SteppingAction->SetHitNodeName("G4HIT_ABSORBER", m_AbsorberNodeName);
   }
-  else
+  m_ActiveFlag = active;
+  m_BlackHoleFlag = blackhole;
+
+  // create stepping action
+  m_SteppingAction = CreateSteppingAction();
+
+  return 0;
+}
+
+//_______________________________________________________________________
+PHG4SteppingAction *PHG4InttSubsystem::CreateSteppingAction()
+{
+  if (!m_ActiveFlag && !m_BlackHoleFlag)
   {
-    if (blackhole)
-    {
-      m_SteppingAction = new PHG4InttSteppingAction(m_Detector, GetParamsContainer(), layer_begin_end);
-    }
+    return nullptr;
   }
+  const auto layer_begin_end = std::make_pair(m_LayerConfigVector.cbegin(), m_LayerConfigVector.cend());
+  auto *action = new PHG4InttSteppingAction(m_Detector, GetParamsContainer(), layer_begin_end);
+  if (m_ActiveFlag)
+  {
+    action->Verbosity(Verbosity());
+    action->SetHitNodeName("G4HIT", m_HitNodeName);
+    action->SetHitNodeName("G4HIT_ABSORBER", m_AbsorberNodeName);
+  }
+  return action;
+}
 
-  return 0;
+//_______________________________________________________________________
+void PHG4InttSubsystem::CreateWorkerActions(PHG4WorkerEventAction *worker)
+{
+  if (PHG4SteppingAction *action = CreateSteppingAction())
+  {
+    worker->AddSteppingAction(action);
+  }
 }
 
 //_______________________________________________________________________
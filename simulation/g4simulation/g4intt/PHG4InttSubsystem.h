@@ -14,6 +14,7 @@ class PHG4Detector;
 class PHG4DisplayAction;
 class PHG4InttDetector;
 class PHG4SteppingAction;
+class PHG4WorkerEventAction;
 
 class PHG4InttSubsystem : public PHG4DetectorGroupSubsystem
 {
@@ -47,6 +48,10 @@ class PHG4InttSubsystem : public PHG4DetectorGroupSubsystem
 
   PHG4SteppingAction *GetSteppingAction(void) const override { return m_SteppingAction; }
 
+  //! multithreading support, each worker thread gets its own stepping action
+  bool SupportsMultiThreading() const override { return true; }
+  void CreateWorkerActions(PHG4WorkerEventAction *worker) override;
+
   PHG4DisplayAction *GetDisplayAction() const override { return m_DisplayAction; }
 
   void SetSurveyGeometry(bool b) { m_UseSurveyGeometry = b; }
@@ -56,6 +61,9 @@ class PHG4InttSubsystem : public PHG4DetectorGroupSubsystem
  private:
   void SetDefaultParameters() override;
 
+  //! create the stepping action for active or black hole layers, nullptr otherwise
+  PHG4SteppingAction *CreateSteppingAction();
+
   //! detector geometry
   /*! defives from PHG4Detector */
   PHG4InttDetector *m_Detector = nullptr;
@@ -73,6 +81,8 @@ class PHG4InttSubsystem : public PHG4DetectorGroupSubsystem
 
   std::string m_HitNodeName;
   std::string m_AbsorberNodeName;
+  bool m_ActiveFlag = false;
+  bool m_BlackHoleFlag = false;
 
   //! whether to use the survey geometry
   bool m_UseSurveyGeometry = true;
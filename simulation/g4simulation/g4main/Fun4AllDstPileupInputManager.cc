@@ -136,11 +136,12 @@ int Fun4AllDstPileupInputManager::fileopen(const std::string &filenam)
 //_____________________________________________________________________________
 int Fun4AllDstPileupInputManager::run(const int nevents)
 {
+  // background events from a hit library do not need the input files
   if (nevents == 0)
   {
-    return runOne(nevents);
+    return m_library ? 0 : runOne(nevents);
   }
-  if (nevents > 1)
+  if (nevents > 1 && !m_library)
   {
     const auto result = runOne(nevents - 1);
     if (result != 0)
@@ -169,6 +170,11 @@ int Fun4AllDstPileupInputManager::run(const int nevents)
   Fun4AllDstPileupMerger merger;
   merger.copyDetectorActiveCrossings(m_DetectorTiming);
   merger.load_nodes(m_dstNode);
+  if (m_library)
+  {
+    merger.set_copy_truth(m_copy_background_truth);
+    merger.load_library(m_dstNode, *m_library);
+  }
 
   // generate background collisions
   const double mu = m_collision_rate * m_time_between_crossings * 1e-9;
@@ -181,6 +187,17 @@ int Fun4AllDstPileupInputManager::run(const int nevents)
     const int ncollisions = gsl_ran_poisson(m_rng.get(), mu);
     for (int icollision = 0; icollision < ncollisions; ++icollision)
     {
+      if (m_library)
+      {
+        if (Verbosity() > 0)
+        {
+          std::cout << "Fun4AllDstPileupInputManager::run - merged library event " << m_library_event << " time: " << crossing_time << std::endl;
+        }
+        merger.copy_background_event(*m_library, m_library_event, crossing_time);
+        m_library_event = (m_library_event + 1) % m_library->nevents();
+        continue;
+      }
+
       // read one event
       const auto result = runOne(1);
       if (result != 0)
@@ -200,6 +217,21 @@ int Fun4AllDstPileupInputManager::run(const int nevents)
   return 0;
 }
 
+//_____________________________________________________________________________
+void Fun4AllDstPileupInputManager::setBackgroundHitLibrary(const std::string &filename)
+{
+  m_library = std::make_unique<PHG4BackgroundHitLibrary>(filename);
+  if (!m_library->isValid() || m_library->nevents() == 0)
+  {
+    std::cout << PHWHERE << " " << Name() << ": no background event in " << filename << ", using input files" << std::endl;
+    m_library.reset();
+    return;
+  }
+
+  // start from a random event, so that jobs sharing a library do not merge the same events
+  m_library_event = gsl_rng_uniform_int(m_rng.get(), m_library->nevents());
+}
+
 //_____________________________________________________________________________
 int Fun4AllDstPileupInputManager::fileclose()
 {
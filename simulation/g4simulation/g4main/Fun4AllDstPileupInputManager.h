@@ -8,6 +8,8 @@
  * \author Hugo Pereira Da Costa <hugo.pereira-da-costa@cea.fr>
  */
 
+#include "PHG4BackgroundHitLibrary.h"
+
 #include <fun4all/Fun4AllInputManager.h>
 #include <fun4all/Fun4AllReturnCodes.h>  // for SYNC_NOOBJECT, SYNC_OK
 
@@ -66,6 +68,15 @@ class Fun4AllDstPileupInputManager : public Fun4AllInputManager
 
   void setDetectorActiveCrossings(const std::string &name, const int min, const int max);
 
+  //! merge background events from a hit library (see PHG4BackgroundHitLibraryWriter) rather than from the input files
+  void setBackgroundHitLibrary(const std::string &filename);
+
+  //! copy truth information of the background hit library events
+  void setCopyBackgroundTruth(bool value)
+  {
+    m_copy_background_truth = value;
+  }
+
  private:
   //! loads one event on internal DST node
   int runOne(const int nevents = 0);
@@ -122,6 +133,16 @@ class Fun4AllDstPileupInputManager : public Fun4AllInputManager
   std::unique_ptr<gsl_rng, Deleter> m_rng;
 
   std::map<std::string, std::pair<double, double>> m_DetectorTiming;
+
+  //!@name background hit library
+  //@{
+  std::unique_ptr<PHG4BackgroundHitLibrary> m_library;
+
+  //! next library event to merge
+  std::size_t m_library_event{0};
+
+  bool m_copy_background_truth{true};
+  //@}
 };
 
 #endif /* G4MAIN_FUN4ALLDSTPILEUPINPUTMANAGER_H_ */
@@ -5,6 +5,7 @@
 
 #include "Fun4AllDstPileupMerger.h"
 
+#include "PHG4BackgroundHitLibrary.h"
 #include "PHG4Hit.h"  // for PHG4Hit
 #include "PHG4HitContainer.h"
 #include "PHG4Hitv1.h"
@@ -29,10 +30,12 @@
 
 #include <HepMC/GenEvent.h>
 
+#include <algorithm>
 #include <iostream>
 #include <iterator>
 #include <limits>
 #include <utility>
+#include <vector>
 
 // convenient aliases for deep copying nodes
 namespace
@@ -78,6 +81,56 @@ namespace
     ContainerMap m_containers;
   };
 
+  //! conversion from library truth ids to destination ids
+  /*!
+   * library events store primaries by increasing id, then secondaries by decreasing id,
+   * which is also the order in which destination ids are assigned. Conversions are thus
+   * added in order, and looked up with a binary search rather than stored in a map
+   */
+  class IdConversion
+  {
+   public:
+    //! id pair alias
+    using IdPair = std::pair<int, int>;
+
+    explicit IdConversion(std::size_t size)
+    {
+      m_primaries.reserve(size);
+      m_secondaries.reserve(size);
+    }
+
+    //! add conversion
+    void add(int source, int destination)
+    {
+      (source > 0 ? m_primaries : m_secondaries).emplace_back(source, destination);
+    }
+
+    //! destination id, zero if not found
+    int find(int source) const
+    {
+      if (source > 0)
+      {
+        const auto iter = std::lower_bound(m_primaries.begin(), m_primaries.end(), source,
+                                           [](const IdPair &pair, int id) { return pair.first < id; });
+        return (iter != m_primaries.end() && iter->first == source) ? iter->second : 0;
+      }
+
+      const auto iter = std::lower_bound(m_secondaries.begin(), m_secondaries.end(), source,
+                                         [](const IdPair &pair, int id) { return pair.first > id; });
+      return (iter != m_secondaries.end() && iter->first == source) ? iter->second : 0;
+    }
+
+    //! primary conversions, by increasing source id
+    const std::vector<IdPair> &primaries() const
+    {
+      return m_primaries;
+    }
+
+   private:
+    std::vector<IdPair> m_primaries;
+    std::vector<IdPair> m_secondaries;
+  };
+
 }  // namespace
 
 //_____________________________________________________________________________
@@ -435,3 +488,216 @@ void Fun4AllDstPileupMerger::copy_background_event(PHCompositeNode *dstNode, dou
     }
   }
 }
+
+//_____________________________________________________________________________
+void Fun4AllDstPileupMerger::load_library(PHCompositeNode *dstNode, const PHG4BackgroundHitLibrary &library)
+{
+  m_library_detectors.clear();
+  for (const auto &name : library.detectors())
+  {
+    LibraryDetector detector;
+
+    // destination container
+    const auto iter = m_g4hitscontainers.find(name);
+    if (iter != m_g4hitscontainers.end())
+    {
+      detector.container = iter->second;
+    }
+    else
+    {
+      std::cout << "Fun4AllDstPileupMerger::load_library - creating node " << name << std::endl;
+      detector.container = new PHG4HitContainer(name);
+      dstNode->addNode(new PHIODataNode<PHObject>(detector.container, name, "PHObject"));
+      m_g4hitscontainers.insert(std::make_pair(name, detector.container));
+    }
+
+    // active time window
+    const auto detiter = m_DetectorTiming.find(name);
+    if (detiter != m_DetectorTiming.end())
+    {
+      detector.tmin = detiter->second.first;
+      detector.tmax = detiter->second.second;
+    }
+    else
+    {
+      detector.tmin = std::numeric_limits<double>::lowest();
+      detector.tmax = std::numeric_limits<double>::max();
+    }
+
+    m_library_detectors.push_back(detector);
+  }
+}
+
+//_____________________________________________________________________________
+void Fun4AllDstPileupMerger::copy_background_event(const PHG4BackgroundHitLibrary &library, std::size_t ievent, double delta_t) const
+{
+  // truth records are only accessed when copied
+  const bool copy_truth = m_copy_truth && m_g4truthinfo;
+  const auto event = library.event(ievent, copy_truth);
+  if (!event.header)
+  {
+    return;
+  }
+
+  if (event.header->ndetectors > m_library_detectors.size())
+  {
+    std::cout << "Fun4AllDstPileupMerger::copy_background_event - library not loaded" << std::endl;
+    return;
+  }
+
+  // library events have no HepMC record
+  const int new_embed_id = -1;
+
+  // keep track of the correspondance between source index and destination index for vertices and tracks
+  IdConversion vtxid_map(event.header->nvertices);
+  IdConversion trkid_map(event.header->nparticles);
+
+  // convert id, keep source id if not found
+  const auto convert = [](const IdConversion &conversion, int id, const std::string &type)
+  {
+    const int converted = conversion.find(id);
+    if (converted == 0)
+    {
+      std::cout << "Fun4AllDstPileupMerger::copy_background_event - " << type << " id " << id << " not found in map" << std::endl;
+      return id;
+    }
+    return converted;
+  };
+
+  if (copy_truth)
+  {
+    {
+      // vertices. Primaries come first
+      auto primary_key = m_g4truthinfo->maxvtxindex();
+      auto secondary_key = m_g4truthinfo->minvtxindex();
+      for (uint32_t i = 0; i < event.header->nvertices; ++i)
+      {
+        const auto &source = event.vertices[i];
+        const int key = (source.id > 0) ? ++primary_key : --secondary_key;
+        m_g4truthinfo->AddVertex(key, new PHG4VtxPoint_t(source.x, source.y, source.z, source.t + delta_t, key));
+        vtxid_map.add(source.id, key);
+      }
+    }
+
+    {
+      /*
+       * particles. Primaries come first, and secondaries are stored
+       * so that the parent of a particle has already been converted
+       */
+      auto primary_key = m_g4truthinfo->maxtrkindex();
+      auto secondary_key = m_g4truthinfo->mintrkindex();
+      for (uint32_t i = 0; i < event.header->nparticles; ++i)
+      {
+        const auto &source = event.particles[i];
+        auto *dest = new PHG4Particle_t;
+        PHG4BackgroundHitLibrary::fill_particle(source, dest);
+        dest->set_name(library.particle_name(source.name));
+        if (source.track_id > 0)
+        {
+          m_g4truthinfo->AddParticle(++primary_key, dest);
+          dest->set_track_id(primary_key);
+
+          // set parent to zero and primary to itself
+          dest->set_parent_id(0);
+          dest->set_primary_id(primary_key);
+        }
+        else
+        {
+          m_g4truthinfo->AddParticle(--secondary_key, dest);
+          dest->set_track_id(secondary_key);
+          dest->set_parent_id(convert(trkid_map, source.parent_id, "track"));
+          dest->set_primary_id(convert(trkid_map, source.primary_id, "track"));
+        }
+        dest->set_vtx_id(convert(vtxid_map, source.vtx_id, "vertex"));
+        trkid_map.add(source.track_id, dest->get_track_id());
+      }
+    }
+
+    // sPHENIX primary particles
+    for (uint32_t i = 0; i < event.header->nsphenix_primaries; ++i)
+    {
+      const auto &source = event.sphenix_primaries[i];
+      const int track_id = trkid_map.find(source.track_id);
+      if (track_id == 0)  // guard against missing track id in map
+      {
+        std::cout << __PRETTY_FUNCTION__ << " - " << __LINE__ << " - track id " << source.track_id << " not found in map" << std::endl;
+        continue;
+      }
+
+      auto *dest = new PHG4Particle_t;
+      PHG4BackgroundHitLibrary::fill_particle(source, dest);
+      dest->set_name(library.particle_name(source.name));
+      dest->set_track_id(track_id);
+      dest->set_parent_id(source.parent_id == 0 ? 0 : convert(trkid_map, source.parent_id, "track"));
+      dest->set_primary_id(convert(trkid_map, source.primary_id, "track"));
+      dest->set_vtx_id(convert(vtxid_map, source.vtx_id, "vertex"));
+      m_g4truthinfo->AddsPHENIXPrimaryParticle(dest->get_track_id(), dest);
+    }
+
+    // vertex and track embed flags
+    /* embed flag is stored only for primary vertices and tracks, consistently with PHG4TruthEventAction */
+    for (const auto &pair : vtxid_map.primaries())
+    {
+      m_g4truthinfo->AddEmbededVtxId(pair.second, new_embed_id);
+    }
+    for (const auto &pair : trkid_map.primaries())
+    {
+      m_g4truthinfo->AddEmbededTrkId(pair.second, new_embed_id);
+    }
+  }
+
+  // copy g4hits, detector by detector
+  const auto *hits = event.hits;
+  const auto *properties = event.properties;
+  for (uint32_t idet = 0; idet < event.header->ndetectors; ++idet)
+  {
+    const auto &block = event.detectors[idet];
+    const auto &detector = m_library_detectors[idet];
+    const auto *const first_hit = hits;
+    const auto *const first_property = properties;
+    hits += block.nhits;
+    properties += block.nproperties;
+
+    // apply special cuts for selected detectors
+    if (delta_t < detector.tmin || delta_t > detector.tmax)
+    {
+      continue;
+    }
+
+    uint32_t nproperties = 0;
+    for (uint32_t i = 0; i < block.nhits; ++i)
+    {
+      const auto &source = first_hit[i];
+
+      // properties must stay within the detector block
+      if (source.nproperties > block.nproperties - nproperties)
+      {
+        std::cout << "Fun4AllDstPileupMerger::copy_background_event - inconsistent hit properties in " << library.detectors()[idet] << std::endl;
+        break;
+      }
+
+      auto *newHit = new PHG4Hit_t;
+      PHG4BackgroundHitLibrary::fill_hit(source, first_property + nproperties, newHit);
+      nproperties += source.nproperties;
+
+      // shift time
+      newHit->set_t(0, source.t[0] + delta_t);
+      newHit->set_t(1, source.t[1] + delta_t);
+
+      // update track id. Without truth information, the hit is not associated to any particle
+      newHit->set_trkid(copy_truth ? convert(trkid_map, source.trkid, "track") : 0);
+
+      // reset shower ids, showers from the background events are not copied
+      newHit->set_shower_id(std::numeric_limits<int>::min());
+
+      // generate a new key for the hit, not conflicting with the hits from the 'main' event
+      detector.container->AddHit(source.detid, newHit);
+    }
+
+    // layers
+    for (const auto layer : library.layers(idet))
+    {
+      detector.container->AddLayer(layer);
+    }
+  }
+}
@@ -8,11 +8,14 @@
  * \author Hugo Pereira Da Costa <hugo.pereira-da-costa@cea.fr>
  */
 
+#include <cstddef>
 #include <map>
 #include <string>
 #include <utility>  // for pair
+#include <vector>
 
 class PHCompositeNode;
+class PHG4BackgroundHitLibrary;
 class PHG4HitContainer;
 class PHG4TruthInfoContainer;
 class PHHepMCGenEventMap;
@@ -39,7 +42,24 @@ class Fun4AllDstPileupMerger final
 
   void copyDetectorActiveCrossings(const std::map<std::string, std::pair<double, double>> &dmap) { m_DetectorTiming = dmap; }
 
+  //! match library detectors to destination containers, creating the missing ones under composite. Must be called after load_nodes
+  void load_library(PHCompositeNode *, const PHG4BackgroundHitLibrary &);
+
+  //! time-shift and copy content of a library event to destination. Hits are created directly from the mapped records
+  void copy_background_event(const PHG4BackgroundHitLibrary &, std::size_t ievent, double delta_t) const;
+
+  //! copy library truth information. Merged hits have no track id otherwise
+  void set_copy_truth(bool value) { m_copy_truth = value; }
+
  private:
+  //! destination container and active time window of a library detector
+  struct LibraryDetector
+  {
+    PHG4HitContainer *container{nullptr};
+    double tmin{0};
+    double tmax{0};
+  };
+
   //! hepmc
   PHHepMCGenEventMap *m_geneventmap{nullptr};
 
@@ -50,6 +70,11 @@ class Fun4AllDstPileupMerger final
   std::map<std::string, PHG4HitContainer *> m_g4hitscontainers;
 
   std::map<std::string, std::pair<double, double>> m_DetectorTiming;
+
+  //! library detectors, indexed as in the library
+  std::vector<LibraryDetector> m_library_detectors;
+
+  bool m_copy_truth{true};
 };
 
 #endif
@@ -63,11 +63,11 @@
 //
 //  Constructors:
 
-G4TBMagneticFieldSetup::G4TBMagneticFieldSetup(PHField* phfield)
+G4TBMagneticFieldSetup::G4TBMagneticFieldSetup(PHField* phfield, const bool nocache)
 {
   assert(phfield);
 
-  fEMfield = new PHG4MagneticField(phfield);
+  fEMfield = new PHG4MagneticField(phfield, nocache);
   fFieldMessenger = new G4TBFieldMessenger(this);
   fEquation = new G4Mag_UsualEqRhs(fEMfield);
   fMinStep = 0.005 * mm;  // minimal step of 5 microns
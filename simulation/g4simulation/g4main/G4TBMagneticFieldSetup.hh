@@ -51,7 +51,8 @@ class PHField;
 class G4TBMagneticFieldSetup
 {
  public:
-  G4TBMagneticFieldSetup(PHField* phfield);
+  //! nocache is used for the thread local field setup of geant worker threads, which share phfield
+  G4TBMagneticFieldSetup(PHField* phfield, const bool nocache = false);
   //  G4TBMagneticFieldSetup(const float magfield) ;
   //  G4TBMagneticFieldSetup(const std::string &fieldmapfile, const int mapdim, const float magfield_rescale = 1.0) ;
   // G4TBMagneticFieldSetup contains pointer to memory
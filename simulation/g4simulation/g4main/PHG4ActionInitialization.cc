@@ -0,0 +1,61 @@
+#include "PHG4ActionInitialization.h"
+
+#include "PHG4PhenixStackingAction.h"
+#include "PHG4PhenixSteppingAction.h"
+#include "PHG4PhenixTrackingAction.h"
+#include "PHG4PrimaryGeneratorAction.h"
+#include "PHG4Subsystem.h"
+#include "PHG4WorkerEventAction.h"
+
+PHG4ActionInitialization::PHG4ActionInitialization(const std::list<PHG4Subsystem *> &subsystems, PHG4SubEventMerger *merger, const bool disableUserActions)
+  : m_SubsystemList(subsystems)
+  , m_Merger(merger)
+  , m_DisableUserActions(disableUserActions)
+{
+}
+
+void PHG4ActionInitialization::Build() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+
+  PHG4PrimaryGeneratorAction *generator = new PHG4PrimaryGeneratorAction();
+  generator->SetInEvent(m_InEvent);
+  generator->SetSubEvents(m_SubEvents);
+  generator->SetSeeds(m_Seeds);
+  m_GeneratorActions.push_back(generator);
+  SetUserAction(generator);
+
+  if (m_DisableUserActions)
+  {
+    return;
+  }
+
+  // the main actions of the thread, the subsystem actions are added by the subsystems
+  PHG4PhenixSteppingAction *stepping = new PHG4PhenixSteppingAction();
+  PHG4PhenixTrackingAction *tracking = new PHG4PhenixTrackingAction();
+  PHG4PhenixStackingAction *stacking = new PHG4PhenixStackingAction();
+  PHG4WorkerEventAction *worker = new PHG4WorkerEventAction(m_Merger, stepping, tracking, stacking);
+  for (PHG4Subsystem *g4sub : m_SubsystemList)
+  {
+    g4sub->CreateWorkerActions(worker);
+  }
+
+  SetUserAction(worker);
+  SetUserAction(stacking);
+  SetUserAction(stepping);
+  SetUserAction(tracking);
+}
+
+void PHG4ActionInitialization::SetInEvent(PHG4InEvent *ineve, const int nsub, const std::vector<long> &seeds)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_InEvent = ineve;
+  m_SubEvents = nsub;
+  m_Seeds = seeds;
+  for (PHG4PrimaryGeneratorAction *generator : m_GeneratorActions)
+  {
+    generator->SetInEvent(ineve);
+    generator->SetSubEvents(nsub);
+    generator->SetSeeds(seeds);
+  }
+}
@@ -0,0 +1,53 @@
+// Tell emacs that this is a C++ source
+//  -*- C++ -*-.
+#ifndef G4MAIN_PHG4ACTIONINITIALIZATION_H
+#define G4MAIN_PHG4ACTIONINITIALIZATION_H
+
+#include <Geant4/G4VUserActionInitialization.hh>
+
+#include <list>
+#include <mutex>
+#include <vector>
+
+class PHG4InEvent;
+class PHG4PrimaryGeneratorAction;
+class PHG4SubEventMerger;
+class PHG4Subsystem;
+
+//! creates the user actions of the geant worker threads in the multithreaded mode of PHG4Reco
+/**
+ * Geant calls Build() once in each worker thread. It creates the primary generator and
+ * the main actions of the thread, and lets each subsystem add its own worker actions.
+ * Build() is serialized, since subsystems and the time server are not thread safe.
+ */
+class PHG4ActionInitialization : public G4VUserActionInitialization
+{
+ public:
+  PHG4ActionInitialization(const std::list<PHG4Subsystem *> &subsystems, PHG4SubEventMerger *merger, const bool disableUserActions);
+
+  ~PHG4ActionInitialization() override = default;
+
+  void Build() const override;
+
+  //! pass the input event to the primary generators of all worker threads, split in nsub sub-events
+  //! with their random seeds (two per sub-event). Must be called before BeamOn(nsub)
+  void SetInEvent(PHG4InEvent *ineve, const int nsub, const std::vector<long> &seeds);
+
+ private:
+  const std::list<PHG4Subsystem *> &m_SubsystemList;
+  PHG4SubEventMerger *m_Merger{nullptr};
+  bool m_DisableUserActions{false};
+
+  //! protects Build() and the generator list
+  mutable std::mutex m_Mutex;
+
+  //! primary generators of the worker threads, owned by geant
+  mutable std::vector<PHG4PrimaryGeneratorAction *> m_GeneratorActions;
+
+  //! current input, for workers started during a run
+  PHG4InEvent *m_InEvent{nullptr};
+  int m_SubEvents{1};
+  std::vector<long> m_Seeds;
+};
+
+#endif
@@ -0,0 +1,332 @@
+/*!
+ * \file PHG4BackgroundHitLibrary.cc
+ * \brief memory mapped library of background events, for pileup merging
+ */
+
+#include "PHG4BackgroundHitLibrary.h"
+
+#include "PHG4Hit.h"
+#include "PHG4Particle.h"
+
+#include <phool/phool.h>  // for PHWHERE
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+namespace
+{
+  // records are read in place. Their sizes keep all records of an event aligned
+  static_assert(sizeof(PHG4BackgroundHitLibrary::Header) % alignof(uint64_t) == 0);
+  static_assert(sizeof(PHG4BackgroundHitLibrary::EventHeader) % alignof(uint64_t) == 0);
+  static_assert(sizeof(PHG4BackgroundHitLibrary::DetectorBlock) % alignof(uint64_t) == 0);
+  static_assert(sizeof(PHG4BackgroundHitLibrary::HitRecord) % alignof(uint64_t) == 0);
+  static_assert(sizeof(PHG4BackgroundHitLibrary::PropertyRecord) % alignof(uint64_t) == 0);
+  static_assert(sizeof(PHG4BackgroundHitLibrary::VertexRecord) % alignof(uint64_t) == 0);
+  static_assert(sizeof(PHG4BackgroundHitLibrary::ParticleRecord) % alignof(uint64_t) == 0);
+
+  //! sequential reader of the detector and name tables, with bound checks
+  class TableReader
+  {
+   public:
+    TableReader(const char *begin, const char *end)
+      : m_current(begin)
+      , m_end(end)
+    {
+    }
+
+    bool read(uint32_t &value)
+    {
+      if (m_end - m_current < static_cast<std::ptrdiff_t>(sizeof(value)))
+      {
+        return false;
+      }
+      std::memcpy(&value, m_current, sizeof(value));
+      m_current += sizeof(value);
+      return true;
+    }
+
+    bool read(std::string &value)
+    {
+      uint32_t length = 0;
+      if (!read(length) || m_end - m_current < static_cast<std::ptrdiff_t>(length))
+      {
+        return false;
+      }
+      value.assign(m_current, length);
+      m_current += length;
+      return true;
+    }
+
+   private:
+    const char *m_current{nullptr};
+    const char *m_end{nullptr};
+  };
+}  // namespace
+
+//_____________________________________________________________________________
+PHG4BackgroundHitLibrary::PHG4BackgroundHitLibrary(const std::string &filename)
+  : m_Filename(filename)
+{
+  const int fd = open(m_Filename.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    std::cout << PHWHERE << " could not open " << m_Filename << std::endl;
+    return;
+  }
+  struct stat status{};
+  if (fstat(fd, &status) != 0 || status.st_size < static_cast<off_t>(sizeof(Header)))
+  {
+    std::cout << PHWHERE << " " << m_Filename << " is too short for a background hit library" << std::endl;
+    close(fd);
+    return;
+  }
+  m_MappingSize = status.st_size;
+  // shared read only mapping, the pages are shared by all processes using this file
+  void *mapping = mmap(nullptr, m_MappingSize, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED)
+  {
+    std::cout << PHWHERE << " could not map " << m_Filename << std::endl;
+    return;
+  }
+  const char *base = static_cast<const char *>(mapping);
+
+  Header header;
+  std::memcpy(&header, base, sizeof(Header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0)
+  {
+    std::cout << PHWHERE << " " << m_Filename << " is not a background hit library" << std::endl;
+    munmap(mapping, m_MappingSize);
+    return;
+  }
+  if (header.version != kVersion)
+  {
+    std::cout << PHWHERE << " " << m_Filename << " has version " << header.version
+              << ", this version reads version " << kVersion << " only" << std::endl;
+    munmap(mapping, m_MappingSize);
+    return;
+  }
+  if (header.file_size != m_MappingSize ||
+      header.index_offset < sizeof(Header) ||
+      header.index_offset % alignof(uint64_t) != 0 ||
+      header.detector_offset < header.index_offset ||
+      header.nevents >= (header.detector_offset - header.index_offset) / sizeof(uint64_t) ||
+      header.detector_offset > header.name_offset ||
+      header.name_offset > m_MappingSize)
+  {
+    std::cout << PHWHERE << " " << m_Filename << " has an inconsistent header" << std::endl;
+    munmap(mapping, m_MappingSize);
+    return;
+  }
+
+  // event index. Events must be ordered, aligned and hold at least their headers
+  m_EventOffset.resize(header.nevents + 1);
+  std::memcpy(m_EventOffset.data(), base + header.index_offset, m_EventOffset.size() * sizeof(uint64_t));
+  bool consistent = m_EventOffset.front() >= sizeof(Header) && m_EventOffset.back() <= header.index_offset;
+  for (std::size_t i = 0; consistent && i < header.nevents; ++i)
+  {
+    consistent = m_EventOffset[i] % alignof(uint64_t) == 0 && m_EventOffset[i] + sizeof(EventHeader) <= m_EventOffset[i + 1];
+  }
+
+  // detector table
+  TableReader detector_table(base + header.detector_offset, base + header.name_offset);
+  m_Detectors.resize(header.ndetectors);
+  m_Layers.resize(header.ndetectors);
+  for (uint32_t i = 0; consistent && i < header.ndetectors; ++i)
+  {
+    uint32_t nlayers = 0;
+    consistent = detector_table.read(m_Detectors[i]) && detector_table.read(nlayers);
+    for (uint32_t j = 0; consistent && j < nlayers; ++j)
+    {
+      uint32_t layer = 0;
+      consistent = detector_table.read(layer);
+      m_Layers[i].push_back(layer);
+    }
+  }
+
+  // particle names
+  TableReader name_table(base + header.name_offset, base + m_MappingSize);
+  uint32_t nnames = 0;
+  consistent = consistent && name_table.read(nnames);
+  for (uint32_t i = 0; consistent && i < nnames; ++i)
+  {
+    std::string name;
+    consistent = name_table.read(name);
+    m_ParticleNames.push_back(std::move(name));
+  }
+
+  if (!consistent)
+  {
+    std::cout << PHWHERE << " " << m_Filename << " has inconsistent tables" << std::endl;
+    m_EventOffset.clear();
+    munmap(mapping, m_MappingSize);
+    return;
+  }
+
+  m_Mapping = mapping;
+  std::cout << "PHG4BackgroundHitLibrary: mapped " << nevents() << " events with " << m_Detectors.size()
+            << " detectors from " << m_Filename << std::endl;
+}
+
+//_____________________________________________________________________________
+PHG4BackgroundHitLibrary::~PHG4BackgroundHitLibrary()
+{
+  if (m_Mapping)
+  {
+    munmap(m_Mapping, m_MappingSize);
+  }
+}
+
+//_____________________________________________________________________________
+PHG4BackgroundHitLibrary::Event PHG4BackgroundHitLibrary::event(const std::size_t ievent, const bool truth) const
+{
+  /*
+   * the content of the event is only checked against the event size, which
+   * is enough for all accesses to stay within the mapping
+   */
+  const char *begin = static_cast<const char *>(m_Mapping) + m_EventOffset[ievent];
+  const std::size_t size = m_EventOffset[ievent + 1] - m_EventOffset[ievent];
+
+  Event event;
+  event.header = reinterpret_cast<const EventHeader *>(begin);
+  event.detectors = reinterpret_cast<const DetectorBlock *>(begin + sizeof(EventHeader));
+
+  uint64_t nhits = 0;
+  uint64_t nproperties = 0;
+  std::size_t position = sizeof(EventHeader) + static_cast<uint64_t>(event.header->ndetectors) * sizeof(DetectorBlock);
+  if (event.header->ndetectors > m_Detectors.size() || position > size)
+  {
+    std::cout << PHWHERE << " " << m_Filename << " event " << ievent << " is inconsistent, skipped" << std::endl;
+    return Event();
+  }
+  for (uint32_t i = 0; i < event.header->ndetectors; ++i)
+  {
+    nhits += event.detectors[i].nhits;
+    nproperties += event.detectors[i].nproperties;
+  }
+
+  event.hits = reinterpret_cast<const HitRecord *>(begin + position);
+  position += nhits * sizeof(HitRecord);
+  event.properties = reinterpret_cast<const PropertyRecord *>(begin + position);
+  position += nproperties * sizeof(PropertyRecord);
+  event.vertices = reinterpret_cast<const VertexRecord *>(begin + position);
+  position += static_cast<uint64_t>(event.header->nvertices) * sizeof(VertexRecord);
+  event.particles = reinterpret_cast<const ParticleRecord *>(begin + position);
+  position += static_cast<uint64_t>(event.header->nparticles) * sizeof(ParticleRecord);
+  event.sphenix_primaries = reinterpret_cast<const ParticleRecord *>(begin + position);
+  position += static_cast<uint64_t>(event.header->nsphenix_primaries) * sizeof(ParticleRecord);
+  if (position != size)
+  {
+    std::cout << PHWHERE << " " << m_Filename << " event " << ievent << " is inconsistent, skipped" << std::endl;
+    return Event();
+  }
+
+  if (!truth)
+  {
+    event.vertices = nullptr;
+    event.particles = nullptr;
+    event.sphenix_primaries = nullptr;
+    return event;
+  }
+
+  // particle names are indices in the name table
+  const auto valid_name = [this](const ParticleRecord &record)
+  { return record.name < m_ParticleNames.size(); };
+  if (!std::all_of(event.particles, event.particles + event.header->nparticles, valid_name) ||
+      !std::all_of(event.sphenix_primaries, event.sphenix_primaries + event.header->nsphenix_primaries, valid_name))
+  {
+    std::cout << PHWHERE << " " << m_Filename << " event " << ievent << " has an invalid particle name, skipped" << std::endl;
+    return Event();
+  }
+  return event;
+}
+
+//_____________________________________________________________________________
+void PHG4BackgroundHitLibrary::fill_record(const PHG4Hit *hit, HitRecord &record, std::vector<PropertyRecord> &properties)
+{
+  for (int i = 0; i < 2; i++)
+  {
+    record.x[i] = hit->get_x(i);
+    record.y[i] = hit->get_y(i);
+    record.z[i] = hit->get_z(i);
+    record.t[i] = hit->get_t(i);
+  }
+  record.edep = hit->get_edep();
+  record.trkid = hit->get_trkid();
+  record.detid = hit->get_detid();
+  record.nproperties = 0;
+
+  // generic copy of all properties, as in PHG4Hit::CopyFrom
+  for (unsigned char ic = 0; ic < std::numeric_limits<unsigned char>::max(); ic++)
+  {
+    const auto prop_id = static_cast<PHG4Hit::PROPERTY>(ic);
+    if (hit->has_property(prop_id))
+    {
+      properties.push_back({ic, hit->get_property_nocheck(prop_id)});
+      ++record.nproperties;
+    }
+  }
+}
+
+//_____________________________________________________________________________
+void PHG4BackgroundHitLibrary::fill_hit(const HitRecord &record, const PropertyRecord *properties, PHG4Hit *hit)
+{
+  for (int i = 0; i < 2; i++)
+  {
+    hit->set_x(i, record.x[i]);
+    hit->set_y(i, record.y[i]);
+    hit->set_z(i, record.z[i]);
+    hit->set_t(i, record.t[i]);
+  }
+  hit->set_edep(record.edep);
+  hit->set_trkid(record.trkid);
+  for (uint32_t i = 0; i < record.nproperties; ++i)
+  {
+    hit->set_property_nocheck(static_cast<PHG4Hit::PROPERTY>(properties[i].id), properties[i].value);
+  }
+}
+
+//_____________________________________________________________________________
+void PHG4BackgroundHitLibrary::fill_record(const PHG4Particle *particle, ParticleRecord &record)
+{
+  record.px = particle->get_px();
+  record.py = particle->get_py();
+  record.pz = particle->get_pz();
+  record.e = particle->get_e();
+  record.ion_charge = particle->get_IonCharge();
+  record.excit_energy = particle->get_ExcitEnergy();
+  record.track_id = particle->get_track_id();
+  record.vtx_id = particle->get_vtx_id();
+  record.parent_id = particle->get_parent_id();
+  record.primary_id = particle->get_primary_id();
+  record.pid = particle->get_pid();
+  record.barcode = particle->get_barcode();
+  record.A = particle->get_A();
+  record.Z = particle->get_Z();
+}
+
+//_____________________________________________________________________________
+void PHG4BackgroundHitLibrary::fill_particle(const ParticleRecord &record, PHG4Particle *particle)
+{
+  particle->set_px(record.px);
+  particle->set_py(record.py);
+  particle->set_pz(record.pz);
+  particle->set_e(record.e);
+  particle->set_IonCharge(record.ion_charge);
+  particle->set_ExcitEnergy(record.excit_energy);
+  particle->set_track_id(record.track_id);
+  particle->set_vtx_id(record.vtx_id);
+  particle->set_parent_id(record.parent_id);
+  particle->set_primary_id(record.primary_id);
+  particle->set_pid(record.pid);
+  particle->set_barcode(record.barcode);
+  particle->set_A(record.A);
+  particle->set_Z(record.Z);
+}
@@ -0,0 +1,194 @@
+// Tell emacs that this is a C++ source
+//  -*- C++ -*-.
+#ifndef G4MAIN_PHG4BACKGROUNDHITLIBRARY_H
+#define G4MAIN_PHG4BACKGROUNDHITLIBRARY_H
+
+/*!
+ * \file PHG4BackgroundHitLibrary.h
+ * \brief memory mapped library of background events, for pileup merging
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class PHG4Hit;
+class PHG4Particle;
+
+/*!
+ * read only access to a background hit library, written by PHG4BackgroundHitLibraryWriter
+ * and merged by Fun4AllDstPileupMerger.
+ *
+ * The file holds a Header, the events one after the other, the event index, the
+ * detector table (g4hit node names and layers) and the particle names.
+ * Each event holds an EventHeader, one DetectorBlock per detector, then the hits of
+ * all detectors in detector order, their properties, and the truth records: vertices
+ * and particles (primaries by increasing id, then secondaries by decreasing id) and
+ * the sPHENIX primary particles. All records are plain structures, read in place.
+ *
+ * The file is mapped read only and shared, so that all jobs on a node reading the same
+ * library use a single page cached copy. Pages are only read when accessed, so that the
+ * truth records cost nothing when they are not merged.
+ */
+class PHG4BackgroundHitLibrary
+{
+ public:
+  //! file header
+  struct Header
+  {
+    char magic[8]{};
+    uint32_t version{0};
+    uint32_t ndetectors{0};
+    uint64_t nevents{0};
+    //! position of the event index (nevents+1 event positions), in bytes from the start of the file
+    uint64_t index_offset{0};
+    //! position of the detector table
+    uint64_t detector_offset{0};
+    //! position of the particle name table
+    uint64_t name_offset{0};
+    uint64_t file_size{0};
+  };
+
+  //! event header, followed by ndetectors DetectorBlock
+  struct EventHeader
+  {
+    uint32_t ndetectors{0};
+    uint32_t nvertices{0};
+    uint32_t nparticles{0};
+    uint32_t nsphenix_primaries{0};
+  };
+
+  //! hits and properties of one detector in an event
+  struct DetectorBlock
+  {
+    uint32_t nhits{0};
+    uint32_t nproperties{0};
+  };
+
+  //! g4hit, followed in the property records by its nproperties properties
+  struct HitRecord
+  {
+    float x[2]{};
+    float y[2]{};
+    float z[2]{};
+    float t[2]{};
+    float edep{0};
+    int32_t trkid{0};
+    int32_t detid{0};
+    uint32_t nproperties{0};
+  };
+
+  //! g4hit property, in its 32 bit storage
+  struct PropertyRecord
+  {
+    uint32_t id{0};
+    uint32_t value{0};
+  };
+
+  struct VertexRecord
+  {
+    double x{0};
+    double y{0};
+    double z{0};
+    double t{0};
+    int32_t id{0};
+    int32_t padding{0};
+  };
+
+  struct ParticleRecord
+  {
+    double px{0};
+    double py{0};
+    double pz{0};
+    double e{0};
+    double ion_charge{0};
+    double excit_energy{0};
+    int32_t track_id{0};
+    int32_t vtx_id{0};
+    int32_t parent_id{0};
+    int32_t primary_id{0};
+    int32_t pid{0};
+    int32_t barcode{0};
+    int32_t A{0};
+    int32_t Z{0};
+    //! index in the particle name table
+    uint32_t name{0};
+    uint32_t padding{0};
+  };
+
+  //! records of one event, pointing into the mapped file
+  struct Event
+  {
+    const EventHeader *header{nullptr};
+    const DetectorBlock *detectors{nullptr};
+    const HitRecord *hits{nullptr};
+    const PropertyRecord *properties{nullptr};
+    const VertexRecord *vertices{nullptr};
+    const ParticleRecord *particles{nullptr};
+    const ParticleRecord *sphenix_primaries{nullptr};
+  };
+
+  //! file identification, the version is checked on reading
+  static constexpr char kMagic[8] = {'P', 'H', 'G', '4', 'B', 'K', 'G', '\0'};
+  static constexpr uint32_t kVersion = 1;
+
+  //! map library. Check isValid() before use
+  explicit PHG4BackgroundHitLibrary(const std::string &filename);
+
+  ~PHG4BackgroundHitLibrary();
+
+  // the mapping is owned
+  PHG4BackgroundHitLibrary(const PHG4BackgroundHitLibrary &) = delete;
+  PHG4BackgroundHitLibrary &operator=(const PHG4BackgroundHitLibrary &) = delete;
+
+  bool isValid() const { return m_Mapping != nullptr; }
+
+  std::size_t nevents() const { return m_EventOffset.empty() ? 0 : m_EventOffset.size() - 1; }
+
+  //! g4hit node names, indexed as the detector blocks of events
+  const std::vector<std::string> &detectors() const { return m_Detectors; }
+
+  //! layers of a detector, from all events
+  const std::vector<unsigned int> &layers(const std::size_t detector) const { return m_Layers[detector]; }
+
+  //! particle name, index must be below the size of the name table. It is checked by event()
+  const std::string &particle_name(const uint32_t index) const { return m_ParticleNames[index]; }
+
+  //! records of an event, or an empty event if it is inconsistent.
+  /*!
+   * With truth, the particle name indices are checked. Without, the truth records
+   * are not accessed and their pointers are null, so that their pages are not read.
+   */
+  Event event(const std::size_t ievent, const bool truth = true) const;
+
+  //!@name conversion between g4 objects and records
+  //@{
+  //! fill hit record, and append the hit properties
+  static void fill_record(const PHG4Hit *hit, HitRecord &record, std::vector<PropertyRecord> &properties);
+
+  //! set hit content, but for the hit id, from record and its properties
+  static void fill_hit(const HitRecord &record, const PropertyRecord *properties, PHG4Hit *hit);
+
+  //! fill particle record, but for the name
+  static void fill_record(const PHG4Particle *particle, ParticleRecord &record);
+
+  //! set particle content, but for the name, from record
+  static void fill_particle(const ParticleRecord &record, PHG4Particle *particle);
+  //@}
+
+ private:
+  std::string m_Filename;
+
+  std::vector<std::string> m_Detectors;
+  std::vector<std::vector<unsigned int>> m_Layers;
+  std::vector<std::string> m_ParticleNames;
+
+  //! position of each event, plus the end of the last event
+  std::vector<uint64_t> m_EventOffset;
+
+  void *m_Mapping{nullptr};
+  std::size_t m_MappingSize{0};
+};
+
+#endif
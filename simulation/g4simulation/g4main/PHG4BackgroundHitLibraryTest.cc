@@ -0,0 +1,355 @@
+/**
+ * @file g4main/PHG4BackgroundHitLibraryTest.cc
+ * @brief check that merging a background hit library event gives the same output as merging the DST event
+ *
+ * usage: PHG4BackgroundHitLibraryTest
+ *
+ * A background event with truth (primary and secondary vertices and particles, sPHENIX
+ * primaries) and hits in two detectors, with properties, is written to a library by
+ * PHG4BackgroundHitLibraryWriter and read back with PHG4BackgroundHitLibrary.
+ * It is merged, for several time offsets, into two copies of a main event: one from the
+ * DST nodes, one from the library. Both merged events are written to text, with full
+ * precision, and must be identical. One detector has an active time window, so that
+ * hits are dropped for some of the offsets.
+ *
+ * The particle name index of the library event is then set out of range. The event
+ * must be rejected with truth, and still readable without.
+ */
+#include "Fun4AllDstPileupMerger.h"
+#include "PHG4BackgroundHitLibrary.h"
+#include "PHG4BackgroundHitLibraryWriter.h"
+#include "PHG4Hit.h"
+#include "PHG4HitContainer.h"
+#include "PHG4Hitv1.h"
+#include "PHG4Particle.h"
+#include "PHG4Particlev2.h"
+#include "PHG4TruthInfoContainer.h"
+#include "PHG4VtxPoint.h"
+#include "PHG4VtxPointv1.h"
+
+#include <fun4all/Fun4AllReturnCodes.h>
+
+#include <phool/PHCompositeNode.h>
+#include <phool/PHIODataNode.h>
+#include <phool/PHNodeIterator.h>
+#include <phool/PHObject.h>
+#include <phool/getClass.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+  const std::vector<std::string> hit_node_names = {"G4HIT_CYLINDER", "G4HIT_BLOCK"};
+
+  // top node with a DST node
+  std::unique_ptr<PHCompositeNode> make_top_node()
+  {
+    auto topNode = std::make_unique<PHCompositeNode>("TOP");
+    topNode->addNode(new PHCompositeNode("DST"));
+    return topNode;
+  }
+
+  PHCompositeNode* dst_node(PHCompositeNode* topNode)
+  {
+    PHNodeIterator iter(topNode);
+    return dynamic_cast<PHCompositeNode*>(iter.findFirst("PHCompositeNode", "DST"));
+  }
+
+  /*
+   * fill the DST node with an event: two primary vertices, a secondary vertex, three primary
+   * and two secondary particles, and hits from all of them. Values are exact in float, as the
+   * library stores the hits in single precision. The offset changes the content between events
+   */
+  void fill_event(PHCompositeNode* dstNode, const double offset)
+  {
+    auto* truthinfo = new PHG4TruthInfoContainer;
+    dstNode->addNode(new PHIODataNode<PHObject>(truthinfo, "G4TruthInfo", "PHObject"));
+
+    truthinfo->AddVertex(1, new PHG4VtxPointv1(0.25, -0.5, 1 + offset, 0.125, 1));
+    truthinfo->AddVertex(2, new PHG4VtxPointv1(-0.25, 0.5, -2 + offset, 0.375, 2));
+    truthinfo->AddVertex(-1, new PHG4VtxPointv1(10.5, 3.25, 4 + offset, 1.5, -1));
+
+    const auto add_particle = [truthinfo, offset](const std::string& name, int pid, int track_id, int vtx_id, int parent_id, int primary_id)
+    {
+      auto* particle = new PHG4Particlev2(name, pid, 0.5 * track_id, 1.25 + offset, -2.5);
+      particle->set_e(4 + offset);
+      particle->set_track_id(track_id);
+      particle->set_vtx_id(vtx_id);
+      particle->set_parent_id(parent_id);
+      particle->set_primary_id(primary_id);
+      particle->set_barcode(10 + track_id);
+      truthinfo->AddParticle(track_id, particle);
+      return particle;
+    };
+
+    add_particle("pi+", 211, 1, 1, 0, 1);
+    add_particle("e-", 11, 2, 1, 0, 2);
+    add_particle("proton", 2212, 3, 2, 0, 3);
+    add_particle("gamma", 22, -1, -1, 1, 1);
+    add_particle("e-", 11, -2, -1, -1, 1);
+
+    // sPHENIX primaries, copies of the primary particles
+    for (const int track_id : {1, 3})
+    {
+      truthinfo->AddsPHENIXPrimaryParticle(track_id, new PHG4Particlev2(truthinfo->GetParticle(track_id)));
+    }
+
+    const auto add_hit = [offset](PHG4HitContainer* container, unsigned int layer, int trkid, double t)
+    {
+      auto* hit = new PHG4Hitv1;
+      for (int i = 0; i < 2; ++i)
+      {
+        hit->set_x(i, 1.5 + i + offset);
+        hit->set_y(i, -2.25 - i);
+        hit->set_z(i, 3.75 + 2 * i);
+        hit->set_t(i, t + 0.5 * i);
+      }
+      hit->set_edep(0.015625 * (layer + 1));
+      hit->set_trkid(trkid);
+      hit->set_shower_id(trkid);
+      container->AddHit(layer, hit);
+      return hit;
+    };
+
+    auto* cylinder = new PHG4HitContainer(hit_node_names[0]);
+    dstNode->addNode(new PHIODataNode<PHObject>(cylinder, hit_node_names[0], "PHObject"));
+    for (unsigned int layer = 0; layer < 3; ++layer)
+    {
+      cylinder->AddLayer(layer);
+      auto* hit = add_hit(cylinder, layer, 1, 0.25 * layer);
+      hit->set_property(PHG4Hit::prop_eion, static_cast<float>(0.0078125 * layer));
+      hit->set_property(PHG4Hit::prop_layer, layer);
+      add_hit(cylinder, layer, -1, 2 + layer);
+    }
+
+    auto* block = new PHG4HitContainer(hit_node_names[1]);
+    dstNode->addNode(new PHIODataNode<PHObject>(block, hit_node_names[1], "PHObject"));
+    block->AddLayer(7);
+    add_hit(block, 7, 3, 5)->set_property(PHG4Hit::prop_light_yield, 0.75F);
+    add_hit(block, 7, -2, 6);
+  }
+
+  // text of the truth and hits of the DST node, with full precision
+  std::string dump(PHCompositeNode* dstNode)
+  {
+    std::ostringstream out;
+    out << std::hexfloat;
+    if (auto* truthinfo = findNode::getClass<PHG4TruthInfoContainer>(dstNode, "G4TruthInfo"))
+    {
+      const auto dump_particle = [&out](const PHG4Particle* particle)
+      {
+        out << particle->get_track_id() << " " << particle->get_name() << " " << particle->get_pid()
+            << " " << particle->get_parent_id() << " " << particle->get_primary_id() << " " << particle->get_vtx_id()
+            << " " << particle->get_barcode() << " " << particle->get_px() << " " << particle->get_py()
+            << " " << particle->get_pz() << " " << particle->get_e() << "\n";
+      };
+
+      for (const auto& [id, particle] : truthinfo->GetMap())
+      {
+        out << "particle " << id << " ";
+        dump_particle(particle);
+      }
+      const auto range = truthinfo->GetSPHENIXPrimaryParticleRange();
+      for (auto iter = range.first; iter != range.second; ++iter)
+      {
+        out << "sphenix primary " << iter->first << " ";
+        dump_particle(iter->second);
+      }
+      for (const auto& [id, vertex] : truthinfo->GetVtxMap())
+      {
+        out << "vertex " << id << " " << vertex->get_id() << " " << vertex->get_x() << " " << vertex->get_y()
+            << " " << vertex->get_z() << " " << vertex->get_t() << "\n";
+      }
+      {
+        const auto flags = truthinfo->GetEmbeddedTrkIds();
+        for (auto iter = flags.first; iter != flags.second; ++iter)
+        {
+          out << "track embed " << iter->first << " " << iter->second << "\n";
+        }
+      }
+      {
+        const auto flags = truthinfo->GetEmbeddedVtxIds();
+        for (auto iter = flags.first; iter != flags.second; ++iter)
+        {
+          out << "vertex embed " << iter->first << " " << iter->second << "\n";
+        }
+      }
+    }
+
+    for (const auto& name : hit_node_names)
+    {
+      auto* hits = findNode::getClass<PHG4HitContainer>(dstNode, name);
+      if (!hits)
+      {
+        continue;
+      }
+      const auto range = hits->getHits();
+      for (auto iter = range.first; iter != range.second; ++iter)
+      {
+        const auto* hit = iter->second;
+        out << name << " " << iter->first << " " << hit->get_trkid() << " " << hit->get_shower_id() << " " << hit->get_edep();
+        for (int i = 0; i < 2; ++i)
+        {
+          out << " " << hit->get_x(i) << " " << hit->get_y(i) << " " << hit->get_z(i) << " " << hit->get_t(i);
+        }
+        for (const auto prop_id : {PHG4Hit::prop_eion, PHG4Hit::prop_light_yield})
+        {
+          if (hit->has_property(prop_id))
+          {
+            out << " property " << prop_id << " " << hit->get_property_float(prop_id);
+          }
+        }
+        if (hit->has_property(PHG4Hit::prop_layer))
+        {
+          out << " property " << PHG4Hit::prop_layer << " " << hit->get_property_uint(PHG4Hit::prop_layer);
+        }
+        out << "\n";
+      }
+      const auto layers = hits->getLayers();
+      for (auto iter = layers.first; iter != layers.second; ++iter)
+      {
+        out << name << " layer " << *iter << "\n";
+      }
+    }
+    return out.str();
+  }
+
+  // set the name index of the first library particle out of range
+  bool corrupt_particle_name(const std::string& filename)
+  {
+    std::fstream file(filename, std::ios::binary | std::ios::in | std::ios::out);
+    PHG4BackgroundHitLibrary::Header header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+    uint64_t event_offset = 0;
+    file.seekg(header.index_offset);
+    file.read(reinterpret_cast<char*>(&event_offset), sizeof(event_offset));
+
+    PHG4BackgroundHitLibrary::EventHeader event_header;
+    file.seekg(event_offset);
+    file.read(reinterpret_cast<char*>(&event_header), sizeof(event_header));
+    std::vector<PHG4BackgroundHitLibrary::DetectorBlock> blocks(event_header.ndetectors);
+    file.read(reinterpret_cast<char*>(blocks.data()), blocks.size() * sizeof(PHG4BackgroundHitLibrary::DetectorBlock));
+    if (!file || event_header.nparticles == 0)
+    {
+      return false;
+    }
+
+    uint64_t position = file.tellg();
+    for (const auto& block : blocks)
+    {
+      position += block.nhits * sizeof(PHG4BackgroundHitLibrary::HitRecord) + block.nproperties * sizeof(PHG4BackgroundHitLibrary::PropertyRecord);
+    }
+    position += event_header.nvertices * sizeof(PHG4BackgroundHitLibrary::VertexRecord);
+    position += offsetof(PHG4BackgroundHitLibrary::ParticleRecord, name);
+
+    const uint32_t name = 1000;
+    file.seekp(position);
+    file.write(reinterpret_cast<const char*>(&name), sizeof(name));
+    return static_cast<bool>(file);
+  }
+}  // namespace
+
+int main()
+{
+  const auto filename = (std::filesystem::temp_directory_path() / "PHG4BackgroundHitLibraryTest.lib").string();
+
+  // background event, written to the library
+  auto backgroundNode = make_top_node();
+  fill_event(dst_node(backgroundNode.get()), 100);
+  {
+    PHG4BackgroundHitLibraryWriter writer("PHG4BACKGROUNDHITLIBRARYWRITER", filename);
+    if (writer.InitRun(backgroundNode.get()) != Fun4AllReturnCodes::EVENT_OK ||
+        writer.process_event(backgroundNode.get()) != Fun4AllReturnCodes::EVENT_OK ||
+        writer.End(backgroundNode.get()) != Fun4AllReturnCodes::EVENT_OK)
+    {
+      std::cout << "PHG4BackgroundHitLibraryTest - could not write " << filename << std::endl;
+      return 1;
+    }
+  }
+
+  int failures = 0;
+  const auto check = [&failures](bool value, const std::string& what)
+  {
+    if (!value)
+    {
+      std::cout << "PHG4BackgroundHitLibraryTest - " << what << " failed" << std::endl;
+      ++failures;
+    }
+  };
+
+  {
+    PHG4BackgroundHitLibrary library(filename);
+    check(library.isValid() && library.nevents() == 1, "library reading");
+    if (!library.isValid())
+    {
+      return 1;
+    }
+
+    // the block detector is only active around the trigger
+    const std::map<std::string, std::pair<double, double>> timing = {{hit_node_names[1], {-100, 100}}};
+    for (const double delta_t : {0., 62.5, -250.})
+    {
+      auto dstMergedNode = make_top_node();
+      fill_event(dst_node(dstMergedNode.get()), 0);
+      Fun4AllDstPileupMerger dst_merger;
+      dst_merger.copyDetectorActiveCrossings(timing);
+      dst_merger.load_nodes(dst_node(dstMergedNode.get()));
+      dst_merger.copy_background_event(dst_node(backgroundNode.get()), delta_t);
+
+      auto libraryMergedNode = make_top_node();
+      fill_event(dst_node(libraryMergedNode.get()), 0);
+      Fun4AllDstPileupMerger library_merger;
+      library_merger.copyDetectorActiveCrossings(timing);
+      library_merger.load_nodes(dst_node(libraryMergedNode.get()));
+      library_merger.load_library(dst_node(libraryMergedNode.get()), library);
+      library_merger.copy_background_event(library, 0, delta_t);
+
+      const auto reference = dump(dst_node(dstMergedNode.get()));
+      const auto output = dump(dst_node(libraryMergedNode.get()));
+      if (output != reference)
+      {
+        std::cout << "PHG4BackgroundHitLibraryTest - delta_t " << delta_t << " DST merge:\n"
+                  << reference << "library merge:\n"
+                  << output;
+      }
+      check(output == reference, "merge with delta_t " + std::to_string(delta_t));
+    }
+  }
+
+  // out of range particle name
+  check(corrupt_particle_name(filename), "library corruption");
+  {
+    PHG4BackgroundHitLibrary library(filename);
+    check(library.isValid() && !library.event(0).header, "invalid particle name rejection");
+    check(library.isValid() && library.event(0, false).header, "event reading without truth");
+
+    auto mergedNode = make_top_node();
+    fill_event(dst_node(mergedNode.get()), 0);
+    const auto reference = dump(dst_node(mergedNode.get()));
+    Fun4AllDstPileupMerger merger;
+    merger.load_nodes(dst_node(mergedNode.get()));
+    merger.load_library(dst_node(mergedNode.get()), library);
+    merger.copy_background_event(library, 0, 0);
+    check(dump(dst_node(mergedNode.get())) == reference, "invalid event merge");
+  }
+
+  std::filesystem::remove(filename);
+
+  if (failures > 0)
+  {
+    return 1;
+  }
+  std::cout << "PHG4BackgroundHitLibraryTest - all checks passed" << std::endl;
+  return 0;
+}
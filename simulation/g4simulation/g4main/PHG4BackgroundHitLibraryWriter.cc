@@ -0,0 +1,353 @@
+/*!
+ * \file PHG4BackgroundHitLibraryWriter.cc
+ * \brief writes the g4hits and truth information of processed events to a background hit library
+ */
+
+#include "PHG4BackgroundHitLibraryWriter.h"
+
+#include "PHG4Hit.h"
+#include "PHG4HitContainer.h"
+#include "PHG4Particle.h"
+#include "PHG4TruthInfoContainer.h"
+#include "PHG4VtxPoint.h"
+
+#include <fun4all/Fun4AllReturnCodes.h>
+
+#include <phool/PHCompositeNode.h>
+#include <phool/PHIODataNode.h>
+#include <phool/PHNode.h>
+#include <phool/PHNodeIterator.h>
+#include <phool/PHNodeOperation.h>
+#include <phool/getClass.h>
+#include <phool/phool.h>  // for PHWHERE
+
+#include <TObject.h>
+
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <utility>
+
+namespace
+{
+  //! utility class to find all PHG4Hit container nodes from the DST node
+  class FindG4HitContainer : public PHNodeOperation
+  {
+   public:
+    //! container map alias
+    using ContainerMap = std::map<std::string, PHG4HitContainer *>;
+
+    //! get container map
+    const ContainerMap &containers() const
+    {
+      return m_containers;
+    }
+
+   protected:
+    //! iterator action
+    void perform(PHNode *node) override
+    {
+      // check type name. Only load PHIODataNode
+      if (node->getType() != "PHIODataNode")
+      {
+        return;
+      }
+
+      // cast to IODataNode and check data
+      auto *ionode = static_cast<PHIODataNode<TObject> *>(node);
+      auto *data = dynamic_cast<PHG4HitContainer *>(ionode->getData());
+      if (data)
+      {
+        m_containers.insert(std::make_pair(node->getName(), data));
+      }
+    }
+
+   private:
+    //! container map
+    ContainerMap m_containers;
+  };
+
+  //! vertex record
+  PHG4BackgroundHitLibrary::VertexRecord vertex_record(const PHG4VtxPoint *vertex)
+  {
+    PHG4BackgroundHitLibrary::VertexRecord record;
+    record.x = vertex->get_x();
+    record.y = vertex->get_y();
+    record.z = vertex->get_z();
+    record.t = vertex->get_t();
+    record.id = vertex->get_id();
+    return record;
+  }
+
+}  // namespace
+
+//_____________________________________________________________________________
+PHG4BackgroundHitLibraryWriter::PHG4BackgroundHitLibraryWriter(const std::string &name, const std::string &filename)
+  : SubsysReco(name)
+  , m_filename(filename)
+{
+}
+
+//_____________________________________________________________________________
+int PHG4BackgroundHitLibraryWriter::InitRun(PHCompositeNode * /*topNode*/)
+{
+  // events of all runs go to the same library
+  if (m_file.is_open())
+  {
+    return Fun4AllReturnCodes::EVENT_OK;
+  }
+
+  m_file.open(m_filename, std::ios::binary | std::ios::trunc);
+  if (!m_file)
+  {
+    std::cout << PHWHERE << " could not open " << m_filename << std::endl;
+    return Fun4AllReturnCodes::ABORTRUN;
+  }
+
+  // placeholder header, rewritten in End
+  const PHG4BackgroundHitLibrary::Header header;
+  write(&header, sizeof(header));
+  return Fun4AllReturnCodes::EVENT_OK;
+}
+
+//_____________________________________________________________________________
+int PHG4BackgroundHitLibraryWriter::process_event(PHCompositeNode *topNode)
+{
+  PHNodeIterator iter(topNode);
+  auto *dstNode = dynamic_cast<PHCompositeNode *>(iter.findFirst("PHCompositeNode", "DST"));
+  if (!dstNode)
+  {
+    std::cout << PHWHERE << " DST node not found" << std::endl;
+    return Fun4AllReturnCodes::ABORTRUN;
+  }
+
+  // find all G4Hit containers under dstNode, and register new detectors
+  FindG4HitContainer nodeFinder;
+  PHNodeIterator(dstNode).forEach(nodeFinder);
+  std::vector<const PHG4HitContainer *> containers(m_detectors.size(), nullptr);
+  for (const auto &[name, container] : nodeFinder.containers())
+  {
+    auto detector = std::find(m_detectors.begin(), m_detectors.end(), name);
+    if (detector == m_detectors.end())
+    {
+      m_detectors.push_back(name);
+      m_layers.emplace_back();
+      containers.push_back(container);
+    }
+    else
+    {
+      containers[std::distance(m_detectors.begin(), detector)] = container;
+    }
+  }
+
+  // hits, grouped by detector
+  m_blocks.assign(m_detectors.size(), {});
+  m_hits.clear();
+  m_properties.clear();
+  for (std::size_t i = 0; i < containers.size(); ++i)
+  {
+    const auto *container = containers[i];
+    if (!container)
+    {
+      continue;
+    }
+
+    const auto nproperties = m_properties.size();
+    const auto range = container->getHits();
+    for (auto hiter = range.first; hiter != range.second; ++hiter)
+    {
+      PHG4BackgroundHitLibrary::HitRecord record;
+      PHG4BackgroundHitLibrary::fill_record(hiter->second, record, m_properties);
+      m_hits.push_back(record);
+      ++m_blocks[i].nhits;
+    }
+    m_blocks[i].nproperties = m_properties.size() - nproperties;
+
+    const auto layers = container->getLayers();
+    m_layers[i].insert(layers.first, layers.second);
+  }
+
+  // truth, vertices and particles ordered as they are merged
+  m_vertices.clear();
+  m_particles.clear();
+  m_sphenix_primaries.clear();
+  auto *truthinfo = findNode::getClass<PHG4TruthInfoContainer>(dstNode, "G4TruthInfo");
+  if (m_write_truth && truthinfo)
+  {
+    {
+      const auto range = truthinfo->GetPrimaryVtxRange();
+      for (auto viter = range.first; viter != range.second; ++viter)
+      {
+        m_vertices.push_back(vertex_record(viter->second));
+      }
+    }
+
+    {
+      const auto range = truthinfo->GetSecondaryVtxRange();
+      for (
+          auto viter = std::reverse_iterator<PHG4TruthInfoContainer::ConstVtxIterator>(range.second);
+          viter != std::reverse_iterator<PHG4TruthInfoContainer::ConstVtxIterator>(range.first);
+          ++viter)
+      {
+        m_vertices.push_back(vertex_record(viter->second));
+      }
+    }
+
+    const auto particle_record = [this](const PHG4Particle *particle)
+    {
+      PHG4BackgroundHitLibrary::ParticleRecord record;
+      PHG4BackgroundHitLibrary::fill_record(particle, record);
+      record.name = particle_name_index(particle->get_name());
+      return record;
+    };
+
+    {
+      const auto range = truthinfo->GetPrimaryParticleRange();
+      for (auto piter = range.first; piter != range.second; ++piter)
+      {
+        m_particles.push_back(particle_record(piter->second));
+      }
+    }
+
+    {
+      const auto range = truthinfo->GetSecondaryParticleRange();
+      for (
+          auto piter = std::reverse_iterator<PHG4TruthInfoContainer::ConstIterator>(range.second);
+          piter != std::reverse_iterator<PHG4TruthInfoContainer::ConstIterator>(range.first);
+          ++piter)
+      {
+        m_particles.push_back(particle_record(piter->second));
+      }
+    }
+
+    {
+      const auto range = truthinfo->GetSPHENIXPrimaryParticleRange();
+      for (auto piter = range.first; piter != range.second; ++piter)
+      {
+        if (piter->second)
+        {
+          m_sphenix_primaries.push_back(particle_record(piter->second));
+        }
+      }
+    }
+  }
+
+  // write event
+  PHG4BackgroundHitLibrary::EventHeader header;
+  header.ndetectors = m_blocks.size();
+  header.nvertices = m_vertices.size();
+  header.nparticles = m_particles.size();
+  header.nsphenix_primaries = m_sphenix_primaries.size();
+
+  m_event_offset.push_back(m_position);
+  write(&header, sizeof(header));
+  write(m_blocks);
+  write(m_hits);
+  write(m_properties);
+  write(m_vertices);
+  write(m_particles);
+  write(m_sphenix_primaries);
+
+  if (!m_file)
+  {
+    std::cout << PHWHERE << " error writing " << m_filename << std::endl;
+    return Fun4AllReturnCodes::ABORTRUN;
+  }
+
+  if (Verbosity() > 1)
+  {
+    std::cout << "PHG4BackgroundHitLibraryWriter::process_event - event " << m_event_offset.size() - 1
+              << " hits: " << m_hits.size() << " particles: " << m_particles.size() << std::endl;
+  }
+
+  return Fun4AllReturnCodes::EVENT_OK;
+}
+
+//_____________________________________________________________________________
+int PHG4BackgroundHitLibraryWriter::End(PHCompositeNode * /*topNode*/)
+{
+  if (!m_file.is_open())
+  {
+    return Fun4AllReturnCodes::EVENT_OK;
+  }
+
+  PHG4BackgroundHitLibrary::Header header;
+  std::copy(std::begin(PHG4BackgroundHitLibrary::kMagic), std::end(PHG4BackgroundHitLibrary::kMagic), header.magic);
+  header.version = PHG4BackgroundHitLibrary::kVersion;
+  header.ndetectors = m_detectors.size();
+  header.nevents = m_event_offset.size();
+
+  // event index, with the end of the last event
+  align();
+  header.index_offset = m_position;
+  m_event_offset.push_back(header.index_offset);
+  write(m_event_offset);
+
+  const auto write_string = [this](const std::string &value)
+  {
+    const uint32_t length = value.size();
+    write(&length, sizeof(length));
+    write(value.data(), length);
+  };
+
+  // detector table
+  header.detector_offset = m_position;
+  for (std::size_t i = 0; i < m_detectors.size(); ++i)
+  {
+    write_string(m_detectors[i]);
+    const uint32_t nlayers = m_layers[i].size();
+    write(&nlayers, sizeof(nlayers));
+    for (const uint32_t layer : m_layers[i])
+    {
+      write(&layer, sizeof(layer));
+    }
+  }
+
+  // particle names
+  header.name_offset = m_position;
+  const uint32_t nnames = m_particle_names.size();
+  write(&nnames, sizeof(nnames));
+  for (const auto &name : m_particle_names)
+  {
+    write_string(name);
+  }
+
+  header.file_size = m_position;
+  m_file.seekp(0);
+  m_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  m_file.close();
+  if (m_file.fail())
+  {
+    std::cout << PHWHERE << " error writing " << m_filename << std::endl;
+    return Fun4AllReturnCodes::ABORTRUN;
+  }
+
+  std::cout << "PHG4BackgroundHitLibraryWriter::End - wrote " << header.nevents << " events with "
+            << header.ndetectors << " detectors to " << m_filename << std::endl;
+  return Fun4AllReturnCodes::EVENT_OK;
+}
+
+//_____________________________________________________________________________
+void PHG4BackgroundHitLibraryWriter::write(const void *data, std::size_t size)
+{
+  m_file.write(static_cast<const char *>(data), size);
+  m_position += size;
+}
+
+//_____________________________________________________________________________
+void PHG4BackgroundHitLibraryWriter::align()
+{
+  static constexpr char padding[alignof(uint64_t)] = {};
+  write(padding, (alignof(uint64_t) - m_position % alignof(uint64_t)) % alignof(uint64_t));
+}
+
+//_____________________________________________________________________________
+uint32_t PHG4BackgroundHitLibraryWriter::particle_name_index(const std::string &name)
+{
+  const auto [iter, inserted] = m_particle_name_index.try_emplace(name, m_particle_names.size());
+  if (inserted)
+  {
+    m_particle_names.push_back(name);
+  }
+  return iter->second;
+}
@@ -0,0 +1,97 @@
+// Tell emacs that this is a C++ source
+//  -*- C++ -*-.
+#ifndef G4MAIN_PHG4BACKGROUNDHITLIBRARYWRITER_H
+#define G4MAIN_PHG4BACKGROUNDHITLIBRARYWRITER_H
+
+/*!
+ * \file PHG4BackgroundHitLibraryWriter.h
+ * \brief writes the g4hits and truth information of processed events to a background hit library
+ */
+
+#include "PHG4BackgroundHitLibrary.h"
+
+#include <fun4all/SubsysReco.h>
+
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+class PHCompositeNode;
+
+/*!
+ * writes all g4hit containers found under the DST node, and the G4TruthInfo content,
+ * to a PHG4BackgroundHitLibrary file, one library event per processed event.
+ * The library is completed in End, and is read by Fun4AllDstPileupInputManager
+ * in place of background DSTs
+ */
+class PHG4BackgroundHitLibraryWriter : public SubsysReco
+{
+ public:
+  PHG4BackgroundHitLibraryWriter(const std::string &name = "PHG4BACKGROUNDHITLIBRARYWRITER", const std::string &filename = "background_hits.lib");
+
+  ~PHG4BackgroundHitLibraryWriter() override = default;
+
+  int InitRun(PHCompositeNode *) override;
+
+  int process_event(PHCompositeNode *) override;
+
+  int End(PHCompositeNode *) override;
+
+  //! output file
+  void set_filename(const std::string &filename) { m_filename = filename; }
+
+  //! also write truth information. Without it the library hits cannot be associated to particles
+  void set_write_truth(bool value) { m_write_truth = value; }
+
+ private:
+  //! write bytes to output, and keep track of the position
+  void write(const void *data, std::size_t size);
+
+  //! write a vector of records
+  template <class T>
+  void write(const std::vector<T> &records)
+  {
+    write(records.data(), records.size() * sizeof(T));
+  }
+
+  //! pad output to 8 bytes
+  void align();
+
+  //! index of a particle name in the name table
+  uint32_t particle_name_index(const std::string &);
+
+  std::string m_filename;
+
+  bool m_write_truth{true};
+
+  std::ofstream m_file;
+
+  //! current output position
+  uint64_t m_position{0};
+
+  //! position of each written event
+  std::vector<uint64_t> m_event_offset;
+
+  //! g4hit node names, in order of first appearance, and their layers
+  std::vector<std::string> m_detectors;
+  std::vector<std::set<unsigned int>> m_layers;
+
+  //! particle names, and their index
+  std::vector<std::string> m_particle_names;
+  std::map<std::string, uint32_t> m_particle_name_index;
+
+  //!@name event buffers, kept between events to limit reallocations
+  //@{
+  std::vector<PHG4BackgroundHitLibrary::DetectorBlock> m_blocks;
+  std::vector<PHG4BackgroundHitLibrary::HitRecord> m_hits;
+  std::vector<PHG4BackgroundHitLibrary::PropertyRecord> m_properties;
+  std::vector<PHG4BackgroundHitLibrary::VertexRecord> m_vertices;
+  std::vector<PHG4BackgroundHitLibrary::ParticleRecord> m_particles;
+  std::vector<PHG4BackgroundHitLibrary::ParticleRecord> m_sphenix_primaries;
+  //@}
+};
+
+#endif
@@ -197,6 +197,9 @@ class PHG4Hit : public PHObject
   static std::string get_property_type(const PROPERTY_TYPE prop_type);
 
  protected:
+  //! copies properties to and from its compact records
+  friend class PHG4BackgroundHitLibrary;
+
   virtual unsigned int get_property_nocheck(const PROPERTY /*prop_id*/) const { return std::numeric_limits<unsigned int>::max(); }
   virtual void set_property_nocheck(const PROPERTY /*prop_id*/, const unsigned int) { return; }
   ClassDefOverride(PHG4Hit, 1)
@@ -14,8 +14,9 @@
 
 #include <cassert>
 
-PHG4MagneticField::PHG4MagneticField(const PHField* field)
+PHG4MagneticField::PHG4MagneticField(const PHField* field, const bool nocache)
   : field_(field)
+  , nocache_(nocache)
 {
   assert(field_);
 }
@@ -24,5 +25,12 @@ void PHG4MagneticField::GetFieldValue(const double Point[4], double* Bfield) con
 {
   assert(field_);
 
-  field_->GetFieldValue(Point, Bfield);
+  if (nocache_)
+  {
+    field_->GetFieldValue_nocache(Point, Bfield);
+  }
+  else
+  {
+    field_->GetFieldValue(Point, Bfield);
+  }
 }
@@ -23,7 +23,8 @@ class PHField;
 class PHG4MagneticField : public G4MagneticField
 {
  public:
-  PHG4MagneticField(const PHField* field);
+  //! with nocache, the field is read with PHField::GetFieldValue_nocache, for geant worker threads
+  PHG4MagneticField(const PHField* field, const bool nocache = false);
   ~PHG4MagneticField() override = default;
 
   const PHField* get_field() const
@@ -40,6 +41,7 @@ class PHG4MagneticField : public G4MagneticField
 
  private:
   const PHField* field_;
+  bool nocache_{false};
 };
 
 #endif /* SIMULATION_CORESOFTWARE_SIMULATION_G4SIMULATION_G4MAIN_PHG4MAGNETICFIELD_H_ */
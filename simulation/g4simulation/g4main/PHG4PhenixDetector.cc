@@ -1,5 +1,6 @@
 #include "PHG4PhenixDetector.h"
 
+#include "G4TBMagneticFieldSetup.hh"
 #include "PHG4Detector.h"
 #include "PHG4DisplayAction.h"  // for PHG4DisplayAction
 #include "PHG4PhenixDisplayAction.h"
@@ -21,14 +22,22 @@
 #include <Geant4/G4String.hh>  // for G4String
 #include <Geant4/G4SystemOfUnits.hh>
 #include <Geant4/G4ThreeVector.hh>  // for G4ThreeVector
+#include <Geant4/G4Threading.hh>
 #include <Geant4/G4Tubs.hh>
 #include <Geant4/G4VSolid.hh>  // for G4GeometryType, G4VSolid
 
 #include <cmath>
 #include <cstdlib>  // for exit
 #include <iostream>
+#include <memory>
 #include <vector>  // for vector
 
+namespace
+{
+  // field setup of the geant worker thread, the master one is owned by PHG4Reco
+  thread_local std::unique_ptr<G4TBMagneticFieldSetup> worker_field_setup;
+}  // namespace
+
 //____________________________________________________________________________
 PHG4PhenixDetector::PHG4PhenixDetector(PHG4Reco *subsys)
   : m_DisplayAction(dynamic_cast<PHG4PhenixDisplayAction *>(subsys->GetDisplayAction()))
@@ -129,3 +138,12 @@ G4VPhysicalVolume *PHG4PhenixDetector::Construct()
 
   return physiWorld;
 }
+
+//_______________________________________________________________________________________________
+void PHG4PhenixDetector::ConstructSDandField()
+{
+  if (m_Field && G4Threading::IsWorkerThread())
+  {
+    worker_field_setup = std::make_unique<G4TBMagneticFieldSetup>(m_Field, true);
+  }
+}
@@ -11,6 +11,7 @@
 
 class G4LogicalVolume;
 class G4VPhysicalVolume;
+class PHField;
 class PHG4Detector;
 class PHG4PhenixDisplayAction;
 class PHG4Reco;
@@ -37,6 +38,12 @@ class PHG4PhenixDetector : public G4VUserDetectorConstruction
   //! this is called by geant to actually construct all detectors
   G4VPhysicalVolume* Construct() override;
 
+  //! this is called by geant in each thread. Field managers are thread local, worker threads get their own field setup
+  void ConstructSDandField() override;
+
+  //! field shared by the field setups of the worker threads
+  void SetField(PHField* field) { m_Field = field; }
+
   G4double GetWorldSizeX() const { return WorldSizeX; }
 
   G4double GetWorldSizeY() const { return WorldSizeY; }
@@ -55,6 +62,8 @@ class PHG4PhenixDetector : public G4VUserDetectorConstruction
 
   int m_Verbosity{0};
 
+  PHField* m_Field{nullptr};
+
   //! list of detectors to be constructed
 
   std::list<PHG4Detector*> m_DetectorList;
@@ -17,10 +17,14 @@
 #include <Geant4/G4SystemOfUnits.hh>
 #include <Geant4/G4ThreeVector.hh>
 #include <Geant4/G4Types.hh>  // for G4double
+#include <Geant4/Randomize.hh>  // for G4Random
 
 #include <cmath>  // for sqrt
+#include <cstddef>
 #include <cstdlib>
 #include <iostream>
+#include <iterator>  // for distance
+#include <limits>
 #include <map>
 #include <string>   // for operator<<
 #include <utility>  // for pair
@@ -31,20 +35,56 @@ void PHG4PrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent)
   {
     return;
   }
+  const int subevent = anEvent->GetEventID();
+  if (subevent >= 0 && 2 * static_cast<std::size_t>(subevent) + 1 < m_Seeds.size())
+  {
+    // zero terminated list of seeds
+    long seeds[3] = {m_Seeds[2 * subevent], m_Seeds[2 * subevent + 1], 0};
+    G4Random::setTheSeeds(seeds);
+  }
   std::map<int, PHG4VtxPoint*>::const_iterator vtxiter;
   std::multimap<int, PHG4Particle*>::const_iterator particle_iter;
   std::pair<std::map<int, PHG4VtxPoint*>::const_iterator, std::map<int, PHG4VtxPoint*>::const_iterator> vtxbegin_end = inEvent->GetVertices();
 
+  // with sub-events, only the particles in [first, last) of all vertices are handed to this event
+  int first = 0;
+  int last = std::numeric_limits<int>::max();
+  if (m_SubEvents > 1)
+  {
+    int nparticles = 0;
+    for (vtxiter = vtxbegin_end.first; vtxiter != vtxbegin_end.second; ++vtxiter)
+    {
+      const auto particlebegin_end = inEvent->GetParticles(vtxiter->first);
+      nparticles += std::distance(particlebegin_end.first, particlebegin_end.second);
+    }
+    first = static_cast<int>(static_cast<long>(nparticles) * subevent / m_SubEvents);
+    last = static_cast<int>(static_cast<long>(nparticles) * (subevent + 1) / m_SubEvents);
+  }
+  int particle_index = 0;
+
   for (vtxiter = vtxbegin_end.first; vtxiter != vtxbegin_end.second; ++vtxiter)
   {
+    std::pair<std::multimap<int, PHG4Particle*>::const_iterator, std::multimap<int, PHG4Particle*>::const_iterator> particlebegin_end = inEvent->GetParticles(vtxiter->first);
+    const int nvtxparticles = std::distance(particlebegin_end.first, particlebegin_end.second);
+    if (m_SubEvents > 1 && (particle_index + nvtxparticles <= first || particle_index >= last))
+    {
+      // no particle of this vertex in this sub-event
+      particle_index += nvtxparticles;
+      continue;
+    }
     //       std::cout << "vtx number: " << vtxiter->first << std::endl;
     //       (*vtxiter->second).identify();
     // expected units are cm !
     G4ThreeVector position((*vtxiter->second).get_x() * cm, (*vtxiter->second).get_y() * cm, (*vtxiter->second).get_z() * cm);
     G4PrimaryVertex* vertex = new G4PrimaryVertex(position, (*vtxiter->second).get_t() * nanosecond);
-    std::pair<std::multimap<int, PHG4Particle*>::const_iterator, std::multimap<int, PHG4Particle*>::const_iterator> particlebegin_end = inEvent->GetParticles(vtxiter->first);
     for (particle_iter = particlebegin_end.first; particle_iter != particlebegin_end.second; ++particle_iter)
     {
+      const int index = particle_index++;
+      if (index < first || index >= last)
+      {
+        continue;
+      }
+
       // std::cout << "PHG4PrimaryGeneratorAction: dealing with" << std::endl;
       //  (particle_iter->second)->identify();
 
@@ -153,6 +193,7 @@ void PHG4PrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent)
       {
         PHG4UserPrimaryParticleInformation* userdata = new PHG4UserPrimaryParticleInformation(inEvent->isEmbeded(particle_iter->second));
         userdata->set_user_barcode((*particle_iter->second).get_barcode());
+        userdata->set_input_vtx_id(vtxiter->first);
         g4part->SetUserInformation(userdata);
         vertex->SetPrimary(g4part);
       }
@@ -5,6 +5,8 @@
 
 #include <Geant4/G4VUserPrimaryGeneratorAction.hh>
 
+#include <vector>
+
 class G4Event;
 class PHG4InEvent;
 
@@ -29,6 +31,16 @@ class PHG4PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
     inEvent = inevt;
   }
 
+  //! split the primary particles in nsub contiguous blocks, one per geant event of the run.
+  //! Used in the multithreaded mode of PHG4Reco, where the event id is the sub-event
+  void SetSubEvents(const int nsub) { m_SubEvents = nsub; }
+  int GetSubEvents() const { return m_SubEvents; }
+
+  //! random seeds of the sub-events, two per sub-event. When set, the geant engine of the
+  //! thread is reseeded with the seeds of the sub-event before its primaries are generated,
+  //! so that the sub-event does not depend on the thread it runs in
+  void SetSeeds(const std::vector<long>& seeds) { m_Seeds = seeds; }
+
   //! Set/Get verbosity
   void Verbosity(const int val) { verbosity = val; }
   int Verbosity() const { return verbosity; }
@@ -39,6 +51,12 @@ class PHG4PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
  private:
   //! temporary pointer to input event on node tree
   PHG4InEvent* inEvent;
+
+  //! number of sub-events the input event is split in
+  int m_SubEvents{1};
+
+  //! seeds of the sub-events
+  std::vector<long> m_Seeds;
 };
 
 #endif  // PHG4PrimaryGeneratorAction_H__
@@ -2,6 +2,7 @@
 
 #include "Fun4AllMessenger.h"
 #include "G4TBMagneticFieldSetup.hh"
+#include "PHG4ActionInitialization.h"
 #include "PHG4DisplayAction.h"
 #include "PHG4InEvent.h"
 #include "PHG4PhenixDetector.h"
@@ -11,10 +12,12 @@
 #include "PHG4PhenixSteppingAction.h"
 #include "PHG4PhenixTrackingAction.h"
 #include "PHG4PrimaryGeneratorAction.h"
+#include "PHG4SubEventMerger.h"
 #include "PHG4Subsystem.h"
 #include "PHG4TrackingAction.h"
 #include "PHG4UIsession.h"
 #include "PHG4Utils.h"
+#include "PHG4WorkerInitialization.h"
 
 #include <g4decayer/EDecayType.hh>
 #include <g4decayer/P6DExtDecayerPhysics.hh>
@@ -34,6 +37,7 @@
 
 #include <fun4all/Fun4AllReturnCodes.h>
 #include <fun4all/Fun4AllServer.h>
+#include <fun4all/Fun4AllTaskScheduler.h>
 #include <fun4all/SubsysReco.h>  // for SubsysReco
 
 #include <phool/PHCompositeNode.h>
@@ -57,6 +61,7 @@
 #include <Geant4/G4HadronicProcessStore.hh>
 #include <Geant4/G4IonisParamMat.hh>  // for G4IonisParamMat
 #include <Geant4/G4LossTableManager.hh>
+#include <Geant4/G4MTRunManager.hh>
 #include <Geant4/G4Material.hh>
 #include <Geant4/G4NistManager.hh>
 #include <Geant4/G4OpAbsorption.hh>
@@ -74,6 +79,7 @@
 #include <Geant4/G4StepLimiterPhysics.hh>
 #include <Geant4/G4String.hh>  // for G4String
 #include <Geant4/G4SystemOfUnits.hh>
+#include <Geant4/G4TaskRunManager.hh>
 #include <Geant4/G4Types.hh>  // for G4double, G4int
 #include <Geant4/G4UIExecutive.hh>
 #include <Geant4/G4UImanager.hh>
@@ -96,12 +102,17 @@
 #include <Geant4/QGSP_INCLXX.hh>
 #include <Geant4/QGSP_INCLXX_HP.hh>
 
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
 #include <exception>  // for exception
 #include <filesystem>
 #include <iostream>  // for operator<<, endl
+#include <iterator>  // for distance
+#include <limits>
 #include <memory>
+#include <string>
+#include <vector>
 
 class G4EmSaturation;
 class G4TrackingManager;
@@ -126,6 +137,16 @@ PHG4Reco::~PHG4Reco()
   // they are non zero is not needed
   delete m_Field;
   delete m_RunManager;
+  if (m_MultiThreaded)
+  {
+    // the main actions are not registered to geant in multithreaded mode, it does not delete them
+    delete m_EventAction;
+    delete m_StackingAction;
+    delete m_SteppingAction;
+    delete m_TrackingAction;
+    delete m_GeneratorAction;
+  }
+  delete m_SubEventMerger;
   delete m_UISession;
   delete m_VisManager;
   delete m_Fun4AllMessenger;
@@ -163,7 +184,66 @@ int PHG4Reco::Init(PHCompositeNode *topNode)
     uimanager->SetCoutDestination(m_UISession);
   }
 
-  m_RunManager = new G4RunManager();
+#ifndef G4MULTITHREADED
+  if (m_MultiThreaded)
+  {
+    std::cout << "PHG4Reco::Init - geant is built without multithreading, running sequentially" << std::endl;
+    m_MultiThreaded = false;
+  }
+#endif
+  if (m_MultiThreaded)
+  {
+    std::vector<std::string> unsupported;
+    for (PHG4Subsystem *g4sub : m_SubsystemList)
+    {
+      if (!g4sub->SupportsMultiThreading())
+      {
+        unsupported.push_back(g4sub->Name());
+      }
+    }
+    if (!unsupported.empty())
+    {
+      std::cout << "PHG4Reco::Init - running geant sequentially, these subsystems do not support multithreading:";
+      for (const auto &name : unsupported)
+      {
+        std::cout << " " << name;
+      }
+      std::cout << std::endl;
+      m_MultiThreaded = false;
+    }
+  }
+
+#ifdef G4MULTITHREADED
+  if (m_MultiThreaded)
+  {
+    if (m_NumThreads == 0)
+    {
+      m_NumThreads = Fun4AllServer::instance()->TaskScheduler()->NumThreads();
+    }
+    m_NumThreads = std::max(m_NumThreads, 1U);
+    if (m_SubEvents == 0)
+    {
+      m_SubEvents = 16;
+    }
+    std::cout << "PHG4Reco::Init - running geant with " << m_NumThreads << " threads and " << m_SubEvents << " sub-events" << std::endl;
+#if G4VERSION_NUMBER >= 1100
+    G4TaskRunManager *runmanager = new G4TaskRunManager();
+#else
+    G4MTRunManager *runmanager = new G4MTRunManager();
+#endif
+    runmanager->SetNumberOfThreads(m_NumThreads);
+    // the master draws the seeds of each geant event, i.e. sub-event, in event order
+    runmanager->SetSeedOncePerCommunication(0);
+    m_RunManager = runmanager;
+    // the master engine is set up by the run manager
+    G4Seed(iseed);
+  }
+  else
+#endif
+  {
+    m_RunManager = new G4RunManager();
+  }
+  m_SubEventSeedEngine.seed(iseed);
 
   DefineMaterials();
   // create physics processes
@@ -396,6 +476,11 @@ int PHG4Reco::InitRun(PHCompositeNode *topNode)
     }
   }
   m_RunManager->SetUserInitialization(m_Detector);
+  if (m_MultiThreaded)
+  {
+    // worker threads create their own field setup, using the same field map
+    m_Detector->SetField(PHFieldUtility::GetFieldMapNode(nullptr, topNode));
+  }
 
   if (m_disableUserActions)
   {
@@ -417,7 +502,8 @@ int PHG4Reco::InitRun(PHCompositeNode *topNode)
     }
   }
 
-  if (!m_disableUserActions)
+  // in multithreaded mode, the worker actions are created by PHG4ActionInitialization
+  if (!m_disableUserActions && !m_MultiThreaded)
   {
     m_RunManager->SetUserAction(m_EventAction);
   }
@@ -437,7 +523,7 @@ int PHG4Reco::InitRun(PHCompositeNode *topNode)
     }
   }
 
-  if (!m_disableUserActions)
+  if (!m_disableUserActions && !m_MultiThreaded)
   {
     m_RunManager->SetUserAction(m_StackingAction);
   }
@@ -458,7 +544,7 @@ int PHG4Reco::InitRun(PHCompositeNode *topNode)
     }
   }
 
-  if (!m_disableUserActions)
+  if (!m_disableUserActions && !m_MultiThreaded)
   {
     m_RunManager->SetUserAction(m_SteppingAction);
   }
@@ -480,11 +566,21 @@ int PHG4Reco::InitRun(PHCompositeNode *topNode)
     }
   }
 
-  if (!m_disableUserActions)
+  if (!m_disableUserActions && !m_MultiThreaded)
   {
     m_RunManager->SetUserAction(m_TrackingAction);
   }
 
+  if (m_MultiThreaded)
+  {
+    m_SubEventMerger = new PHG4SubEventMerger();
+    m_SubEventMerger->load_nodes(topNode);
+    // the run manager takes ownership
+    m_ActionInitialization = new PHG4ActionInitialization(m_SubsystemList, m_SubEventMerger, m_disableUserActions);
+    m_RunManager->SetUserInitialization(m_ActionInitialization);
+    m_RunManager->SetUserInitialization(new PHG4WorkerInitialization(this));
+  }
+
   // initialize
   m_RunManager->Initialize();
 
@@ -496,6 +592,60 @@ int PHG4Reco::InitRun(PHCompositeNode *topNode)
   }
 #endif
 
+  // add cerenkov and optical photon processes. Worker threads add them at their first run
+  AddUserProcesses();
+
+  // needs large amount of memory which kills central hijing events
+  // store generated trajectories
+  // if( G4TrackingManager* trackingManager = G4EventManager::GetEventManager()->GetTrackingManager() ){
+  //  trackingManager->SetStoreTrajectory( true );
+  //}
+
+  // quiet some G4 print-outs (EM and Hadronic settings during first event)
+  G4HadronicProcessStore::Instance()->SetVerbose(0);
+  G4LossTableManager::Instance()->SetVerbose(1);
+
+  if ((Verbosity() < 1) && (m_UISession))
+  {
+    m_UISession->Verbosity(1);  // let messages after setup come through
+  }
+
+  // Geometry export to DST
+  if (m_SaveDstGeometryFlag)
+  {
+    const std::string filename = PHGeomUtility::GenerateGeometryFileName("gdml");
+    std::cout << "PHG4Reco::InitRun - export geometry to DST via tmp file " << filename << std::endl;
+
+    Dump_GDML(filename);
+
+    PHGeomUtility::ImportGeomFile(topNode, filename);
+
+    PHGeomUtility::RemoveGeometryFile(filename);
+  }
+
+  if (Verbosity() > 0)
+  {
+    std::cout << "===========================================================================" << std::endl;
+  }
+
+  // dump geometry to root file
+  if (m_ExportGeometry)
+  {
+    std::cout << "PHG4Reco::InitRun - writing geometry to " << m_ExportGeomFilename << std::endl;
+    PHGeomUtility::ExportGeomtry(topNode, m_ExportGeomFilename);
+  }
+
+  if (PHRandomSeed::Verbosity() >= 2)
+  {
+    // at high verbosity, to save the random number to file
+    G4RunManager::GetRunManager()->SetRandomNumberStore(true);
+  }
+  return 0;
+}
+
+//________________________________________________________________
+void PHG4Reco::AddUserProcesses()
+{
   // add cerenkov and optical photon processes
   // std::cout << std::endl << "Ignore the next message - we implemented this correctly" << std::endl;
   G4Cerenkov *theCerenkovProcess = new G4Cerenkov("Cerenkov");
@@ -557,53 +707,6 @@ int PHG4Reco::InitRun(PHCompositeNode *topNode)
   pmanager->AddDiscreteProcess(new G4OpWLS());
   pmanager->AddDiscreteProcess(new G4PhotoElectricEffect());
   // pmanager->DumpInfo();
-
-  // needs large amount of memory which kills central hijing events
-  // store generated trajectories
-  // if( G4TrackingManager* trackingManager = G4EventManager::GetEventManager()->GetTrackingManager() ){
-  //  trackingManager->SetStoreTrajectory( true );
-  //}
-
-  // quiet some G4 print-outs (EM and Hadronic settings during first event)
-  G4HadronicProcessStore::Instance()->SetVerbose(0);
-  G4LossTableManager::Instance()->SetVerbose(1);
-
-  if ((Verbosity() < 1) && (m_UISession))
-  {
-    m_UISession->Verbosity(1);  // let messages after setup come through
-  }
-
-  // Geometry export to DST
-  if (m_SaveDstGeometryFlag)
-  {
-    const std::string filename = PHGeomUtility::GenerateGeometryFileName("gdml");
-    std::cout << "PHG4Reco::InitRun - export geometry to DST via tmp file " << filename << std::endl;
-
-    Dump_GDML(filename);
-
-    PHGeomUtility::ImportGeomFile(topNode, filename);
-
-    PHGeomUtility::RemoveGeometryFile(filename);
-  }
-
-  if (Verbosity() > 0)
-  {
-    std::cout << "===========================================================================" << std::endl;
-  }
-
-  // dump geometry to root file
-  if (m_ExportGeometry)
-  {
-    std::cout << "PHG4Reco::InitRun - writing geometry to " << m_ExportGeomFilename << std::endl;
-    PHGeomUtility::ExportGeomtry(topNode, m_ExportGeomFilename);
-  }
-
-  if (PHRandomSeed::Verbosity() >= 2)
-  {
-    // at high verbosity, to save the random number to file
-    G4RunManager::GetRunManager()->SetRandomNumberStore(true);
-  }
-  return 0;
 }
 
 //________________________________________________________________
@@ -694,7 +797,25 @@ int PHG4Reco::process_event(PHCompositeNode *topNode)
               << "run one event :" << std::endl;
     ineve->identify();
   }
-  m_RunManager->BeamOn(1);
+  if (m_MultiThreaded)
+  {
+    // split the primary particles in sub-events, which the worker threads process in parallel
+    const auto particles = ineve->GetParticles();
+    const unsigned int nparticles = std::distance(particles.first, particles.second);
+    const unsigned int nsubevents = std::max(std::min(m_SubEvents, nparticles), 1U);
+    m_ActionInitialization->SetInEvent(ineve, nsubevents, SubEventSeeds(nsubevents));
+    m_SubEventMerger->prepare(nsubevents);
+    m_RunManager->BeamOn(nsubevents);
+    m_SubEventMerger->merge();
+  }
+  else
+  {
+    if (m_SubEvents > 0)
+    {
+      m_GeneratorAction->SetSeeds(SubEventSeeds(1));
+    }
+    m_RunManager->BeamOn(1);
+  }
 
   for (PHG4Subsystem *g4sub : m_SubsystemList)
   {
@@ -758,7 +879,11 @@ int PHG4Reco::setupInputEventNodeReader(PHCompositeNode *topNode)
   {
     m_GeneratorAction = new PHG4PrimaryGeneratorAction();
   }
-  m_RunManager->SetUserAction(m_GeneratorAction);
+  // in multithreaded mode, each worker thread has its own generator
+  if (!m_MultiThreaded)
+  {
+    m_RunManager->SetUserAction(m_GeneratorAction);
+  }
   return 0;
 }
 
@@ -768,6 +893,20 @@ void PHG4Reco::set_rapidity_coverage(const double eta)
   PHG4Utils::SetPseudoRapidityCoverage(eta);
 }
 
+//_________________________________________________________________
+std::vector<long> PHG4Reco::SubEventSeeds(const unsigned int nsubevents)
+{
+  // geant seed lists are zero terminated, seeds must not be zero
+  std::uniform_int_distribution<long> distribution(1, std::numeric_limits<int>::max());
+  std::vector<long> seeds(2 * nsubevents);
+  for (auto &seed : seeds)
+  {
+    seed = distribution(m_SubEventSeedEngine);
+  }
+  return seeds;
+}
+
+//_________________________________________________________________
 void PHG4Reco::G4Seed(const unsigned int i)
 {
   CLHEP::HepRandom::setTheSeed(i);
@@ -10,7 +10,9 @@
 #include <phfield/PHFieldConfig.h>
 
 #include <list>
+#include <random>
 #include <string>  // for string
+#include <vector>
 
 // Forward declerations
 class G4RunManager;
@@ -19,6 +21,7 @@ class G4UImanager;
 class G4UImessenger;
 class G4VisManager;
 class PHCompositeNode;
+class PHG4ActionInitialization;
 class PHG4DisplayAction;
 class PHG4PhenixDetector;
 class PHG4PhenixEventAction;
@@ -26,6 +29,7 @@ class PHG4PhenixStackingAction;
 class PHG4PhenixSteppingAction;
 class PHG4PhenixTrackingAction;
 class PHG4PrimaryGeneratorAction;
+class PHG4SubEventMerger;
 class PHG4Subsystem;
 class PHG4UIsession;
 
@@ -138,6 +142,37 @@ class PHG4Reco : public SubsysReco
 
   //! disable event/track/stepping actions to reduce resource consumption for G4 running only. E.g. dose analysis
   void setDisableUserActions(bool b = true) { m_disableUserActions = b; }
+
+  //! run geant multithreaded. Must be called before Init.
+  /*!
+    Each event is split in sub-events (see setSubEvents), with contiguous blocks of primary particles,
+    which are simulated in parallel by the geant worker threads. Their output is merged back in
+    sub-event order, so results depend on the number of sub-events but not on the number of threads.
+    All registered subsystems must support it (PHG4Subsystem::SupportsMultiThreading), otherwise
+    geant runs sequentially and Init lists the subsystems which do not. So far the truth, cylinder,
+    cone, block, MVTX, INTT, TPC, TPC end cap and Micromegas subsystems support it; the calorimeters
+    (Spacal, inner and outer HCal), ZDC, EPD, BBC and the other detector subsystems do not.
+    \param nthreads number of worker threads, 0 uses the number of threads of the Fun4All task scheduler
+  */
+  void setMultiThreaded(const unsigned int nthreads = 0)
+  {
+    m_MultiThreaded = true;
+    m_NumThreads = nthreads;
+  }
+
+  //! number of sub-events each event is split in, in multithreaded mode. Must be called before Init.
+  /*!
+    Default is 16, or the number of primary particles if lower. Each sub-event gets its own random
+    seeds, drawn in event order from the PHG4Reco seed. In sequential mode events are not split,
+    but setting it reseeds geant at each event the same way, so that a sequential job gives the
+    same output as a multithreaded one with a single sub-event.
+  */
+  void setSubEvents(const unsigned int nsub) { m_SubEvents = nsub; }
+
+  bool isMultiThreaded() const { return m_MultiThreaded; }
+
+  //! add cerenkov, scintillation, optical photon and subsystem processes to the particles of the calling thread
+  void AddUserProcesses();
   void ApplyDisplayAction();
 
   void CustomizeEvtGenDecay(const std::string &DecayFile)
@@ -152,6 +187,9 @@ class PHG4Reco : public SubsysReco
   void DefineMaterials();
   void DefineRegions();
 
+  //! draw the random seeds of the next nsubevents sub-events, two per sub-event
+  std::vector<long> SubEventSeeds(const unsigned int nsubevents);
+
   float m_MagneticField{std::numeric_limits<float>::signaling_NaN()};
   float m_MagneticFieldRescale = 1.0;
   double m_WorldSize[3]{1000., 1000., 1000.};
@@ -187,6 +225,12 @@ class PHG4Reco : public SubsysReco
   //! event generator (read from PHG4INEVENT node)
   PHG4PrimaryGeneratorAction *m_GeneratorAction{nullptr};
 
+  //! creates the actions of the worker threads in multithreaded mode
+  PHG4ActionInitialization *m_ActionInitialization{nullptr};
+
+  //! copies the output of the sub-events to the node tree in multithreaded mode
+  PHG4SubEventMerger *m_SubEventMerger{nullptr};
+
   //! list of subsystems
   std::list<PHG4Subsystem *> m_SubsystemList;
 
@@ -220,6 +264,15 @@ class PHG4Reco : public SubsysReco
 
   bool m_SaveDstGeometryFlag{true};
   bool m_disableUserActions{false};
+
+  bool m_MultiThreaded{false};
+  unsigned int m_NumThreads{0};
+
+  //! 0 means the default in multithreaded mode and no reseeding in sequential mode
+  unsigned int m_SubEvents{0};
+
+  //! seeds of the sub-events
+  std::mt19937_64 m_SubEventSeedEngine;
 };
 
 #endif
@@ -0,0 +1,355 @@
+/*!
+ * \file PHG4SubEventMerger.cc
+ */
+
+#include "PHG4SubEventMerger.h"
+
+#include "PHG4Hit.h"
+#include "PHG4HitContainer.h"
+#include "PHG4HitDefs.h"
+#include "PHG4Hitv1.h"
+#include "PHG4Particle.h"
+#include "PHG4Shower.h"
+#include "PHG4TruthInfoContainer.h"
+#include "PHG4VtxPoint.h"
+#include "PHG4VtxPointv2.h"
+
+#include <phool/PHCompositeNode.h>
+#include <phool/PHIODataNode.h>
+#include <phool/PHNode.h>
+#include <phool/PHNodeIterator.h>
+#include <phool/PHNodeOperation.h>
+#include <phool/PHObject.h>
+#include <phool/getClass.h>
+
+#include <TObject.h>
+
+#include <iostream>
+#include <limits>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <utility>
+
+namespace
+{
+  using PHG4Hit_t = PHG4Hitv1;
+  using PHG4VtxPoint_t = PHG4VtxPointv2;
+
+  //! utility class to find all PHG4Hit container nodes from the DST node
+  class FindG4HitContainer : public PHNodeOperation
+  {
+   public:
+    //! container list alias
+    using ContainerList = std::vector<std::pair<std::string, PHG4HitContainer *>>;
+
+    //! get containers, in node tree order
+    const ContainerList &containers() const
+    {
+      return m_containers;
+    }
+
+   protected:
+    //! iterator action
+    void perform(PHNode *node) override
+    {
+      // check type name. Only load PHIODataNode
+      if (node->getType() != "PHIODataNode")
+      {
+        return;
+      }
+
+      // cast to IODataNode and check data
+      auto *ionode = static_cast<PHIODataNode<TObject> *>(node);
+      auto *data = dynamic_cast<PHG4HitContainer *>(ionode->getData());
+      if (data)
+      {
+        m_containers.emplace_back(node->getName(), data);
+      }
+    }
+
+   private:
+    //! container list
+    ContainerList m_containers;
+  };
+
+  //! replace the content of a worker node by a new object, returns the old one
+  template <class T>
+  T *swap_data(PHCompositeNode *topNode, const std::string &name, T *replacement)
+  {
+    auto *node = dynamic_cast<PHIODataNode<PHObject> *>(PHNodeIterator(topNode).findFirst("PHIODataNode", name));
+    if (!node)
+    {
+      std::cout << "PHG4SubEventMerger::store - node " << name << " not found" << std::endl;
+      delete replacement;
+      return nullptr;
+    }
+    auto *data = dynamic_cast<T *>(node->getData());
+    node->setData(replacement);
+    return data;
+  }
+}  // namespace
+
+//_____________________________________________________________________________
+PHG4SubEventMerger::~PHG4SubEventMerger() = default;
+
+//_____________________________________________________________________________
+void PHG4SubEventMerger::load_nodes(PHCompositeNode *topNode)
+{
+  PHCompositeNode *dstNode = dynamic_cast<PHCompositeNode *>(PHNodeIterator(topNode).findFirst("PHCompositeNode", "DST"));
+  if (!dstNode)
+  {
+    std::cout << "PHG4SubEventMerger::load_nodes - DST node missing" << std::endl;
+    return;
+  }
+
+  // find all G4Hit containers under dstNode
+  FindG4HitContainer nodeFinder;
+  PHNodeIterator(dstNode).forEach(nodeFinder);
+  m_g4hitscontainers = nodeFinder.containers();
+
+  // g4 truth info, only present with PHG4TruthSubsystem
+  m_g4truthinfo = findNode::getClass<PHG4TruthInfoContainer>(dstNode, "G4TruthInfo");
+}
+
+//_____________________________________________________________________________
+PHCompositeNode *PHG4SubEventMerger::create_worker_nodes() const
+{
+  auto *topNode = new PHCompositeNode("TOP");
+  auto *dstNode = new PHCompositeNode("DST");
+  topNode->addNode(dstNode);
+  if (m_g4truthinfo)
+  {
+    dstNode->addNode(new PHIODataNode<PHObject>(new PHG4TruthInfoContainer(), "G4TruthInfo", "PHObject"));
+  }
+  for (const auto &[name, container] : m_g4hitscontainers)
+  {
+    auto *newcontainer = new PHG4HitContainer(name);
+    newcontainer->SetID(container->GetID());
+    dstNode->addNode(new PHIODataNode<PHObject>(newcontainer, name, "PHObject"));
+  }
+  return topNode;
+}
+
+//_____________________________________________________________________________
+void PHG4SubEventMerger::prepare(const unsigned int nsubevents)
+{
+  m_subevents.clear();
+  m_subevents.resize(nsubevents);
+}
+
+//_____________________________________________________________________________
+void PHG4SubEventMerger::store(const unsigned int subevent, PHCompositeNode *topNode, VertexSources &&vertex_sources)
+{
+  if (subevent >= m_subevents.size())
+  {
+    std::cout << "PHG4SubEventMerger::store - invalid sub-event " << subevent << ", output dropped" << std::endl;
+    return;
+  }
+
+  // the worker actions pick up the new containers at the beginning of the next sub-event
+  auto &slot = m_subevents[subevent];
+  if (m_g4truthinfo)
+  {
+    slot.truthinfo.reset(swap_data(topNode, "G4TruthInfo", new PHG4TruthInfoContainer()));
+  }
+  slot.vertex_sources = std::move(vertex_sources);
+  slot.g4hitscontainers.clear();
+  for (const auto &[name, container] : m_g4hitscontainers)
+  {
+    auto *newcontainer = new PHG4HitContainer(name);
+    newcontainer->SetID(container->GetID());
+    slot.g4hitscontainers.emplace_back(swap_data(topNode, name, newcontainer));
+  }
+}
+
+//_____________________________________________________________________________
+void PHG4SubEventMerger::merge()
+{
+  // merged id of the primary vertices already copied, by input vertex id,
+  // to merge the ones of primary particles split across sub-events
+  std::map<int, int> primary_vertices;
+
+  for (auto &slot : m_subevents)
+  {
+    // source ids start from +/-1 in each sub-event. They are shifted after the ones in use
+    int trkid_primary_offset = 0;
+    int trkid_secondary_offset = 0;
+    int vtxid_secondary_offset = 0;
+    std::unordered_map<int, int> vtxid_map;
+    if (m_g4truthinfo && slot.truthinfo)
+    {
+      trkid_primary_offset = m_g4truthinfo->maxtrkindex();
+      trkid_secondary_offset = m_g4truthinfo->mintrkindex();
+      vtxid_secondary_offset = m_g4truthinfo->minvtxindex();
+
+      // vertices
+      int maxvtxindex = m_g4truthinfo->maxvtxindex();
+      for (const auto &[id, source] : slot.truthinfo->GetVtxMap())
+      {
+        if (id > 0)
+        {
+          // input vertices at the same position share a truth vertex, which may already be
+          // copied from another sub-event under any of them
+          const auto sources = slot.vertex_sources.equal_range(id);
+          int newid = 0;
+          for (auto iter = sources.first; iter != sources.second && !newid; ++iter)
+          {
+            const auto found = primary_vertices.find(iter->second);
+            if (found != primary_vertices.end())
+            {
+              newid = found->second;
+            }
+          }
+          const bool copied = (newid != 0);
+          if (!copied)
+          {
+            newid = ++maxvtxindex;
+          }
+          for (auto iter = sources.first; iter != sources.second; ++iter)
+          {
+            primary_vertices.emplace(iter->second, newid);
+          }
+          vtxid_map[id] = newid;
+          if (copied)
+          {
+            continue;
+          }
+        }
+        else
+        {
+          vtxid_map[id] = id + vtxid_secondary_offset;
+        }
+        auto *newVertex = new PHG4VtxPoint_t(source);
+        newVertex->set_id(vtxid_map[id]);
+        m_g4truthinfo->AddVertex(newVertex->get_id(), newVertex);
+      }
+    }
+
+    // note : 0 (no parent) and unset ids are kept
+    const auto trkid = [trkid_primary_offset, trkid_secondary_offset](const int id)
+    {
+      if (id == 0 || id == std::numeric_limits<int>::min())
+      {
+        return id;
+      }
+      return id > 0 ? id + trkid_primary_offset : id + trkid_secondary_offset;
+    };
+    const auto vtxid = [&vtxid_map](const int id)
+    {
+      const auto iter = vtxid_map.find(id);
+      return iter == vtxid_map.end() ? id : iter->second;
+    };
+
+    // g4hits. Keep track of the new keys, per container id, for the showers
+    std::map<int, std::unordered_map<PHG4HitDefs::keytype, PHG4HitDefs::keytype>> hitkey_map;
+    for (std::size_t i = 0; i < slot.g4hitscontainers.size(); ++i)
+    {
+      const auto &source = slot.g4hitscontainers[i];
+      auto *destination = m_g4hitscontainers[i].second;
+      if (!source)
+      {
+        continue;
+      }
+
+      auto &keys = hitkey_map[source->GetID()];
+      const auto range = source->getHits();
+      for (auto iter = range.first; iter != range.second; ++iter)
+      {
+        const auto &sourceHit = iter->second;
+        auto *newHit = new PHG4Hit_t(sourceHit);
+        if (slot.truthinfo)
+        {
+          newHit->set_trkid(trkid(sourceHit->get_trkid()));
+          newHit->set_shower_id(trkid(sourceHit->get_shower_id()));
+        }
+
+        // this will generate a new key for the hit and assign it to the hit
+        keys[iter->first] = destination->AddHit(newHit->get_detid(), newHit)->first;
+      }
+
+      const auto layers = source->getLayers();
+      for (auto iter = layers.first; iter != layers.second; ++iter)
+      {
+        destination->AddLayer(*iter);
+      }
+    }
+
+    if (!m_g4truthinfo || !slot.truthinfo)
+    {
+      continue;
+    }
+
+    // particles
+    const auto copy_particle = [&](const PHG4Particle *source)
+    {
+      auto *newParticle = static_cast<PHG4Particle *>(source->CloneMe());
+      newParticle->set_track_id(trkid(source->get_track_id()));
+      newParticle->set_parent_id(trkid(source->get_parent_id()));
+      newParticle->set_primary_id(trkid(source->get_primary_id()));
+      newParticle->set_vtx_id(vtxid(source->get_vtx_id()));
+      return newParticle;
+    };
+    for (const auto &[id, source] : slot.truthinfo->GetMap())
+    {
+      auto *newParticle = copy_particle(source);
+      m_g4truthinfo->AddParticle(newParticle->get_track_id(), newParticle);
+    }
+    for (const auto &[id, source] : slot.truthinfo->GetSPHENIXPrimaryParticleMap())
+    {
+      auto *newParticle = copy_particle(source);
+      m_g4truthinfo->AddsPHENIXPrimaryParticle(newParticle->get_track_id(), newParticle);
+    }
+
+    // showers
+    for (const auto &[id, source] : slot.truthinfo->GetShowerMap())
+    {
+      auto *newShower = source->CloneMe();
+      newShower->set_id(trkid(source->get_id()));
+      newShower->set_parent_particle_id(trkid(source->get_parent_particle_id()));
+      newShower->set_parent_shower_id(trkid(source->get_parent_shower_id()));
+
+      newShower->clear_g4particle_id();
+      for (const int particle_id : source->g4particle_ids())
+      {
+        newShower->add_g4particle_id(trkid(particle_id));
+      }
+
+      newShower->clear_g4vertex_id();
+      for (const int vertex_id : source->g4vertex_ids())
+      {
+        newShower->add_g4vertex_id(vtxid(vertex_id));
+      }
+
+      newShower->clear_g4hit_id();
+      for (const auto &[volume, hitkeys] : source->g4hit_ids())
+      {
+        const auto &keys = hitkey_map[volume];
+        for (const auto &key : hitkeys)
+        {
+          const auto keyiter = keys.find(key);
+          if (keyiter != keys.end())
+          {
+            newShower->add_g4hit_id(volume, keyiter->second);
+          }
+        }
+      }
+      m_g4truthinfo->AddShower(newShower->get_id(), newShower);
+    }
+
+    // embedding flags
+    const auto trkids = slot.truthinfo->GetEmbeddedTrkIds();
+    for (auto iter = trkids.first; iter != trkids.second; ++iter)
+    {
+      m_g4truthinfo->AddEmbededTrkId(trkid(iter->first), iter->second);
+    }
+    const auto vtxids = slot.truthinfo->GetEmbeddedVtxIds();
+    for (auto iter = vtxids.first; iter != vtxids.second; ++iter)
+    {
+      m_g4truthinfo->AddEmbededVtxId(vtxid(iter->first), iter->second);
+    }
+  }
+
+  // release the sub-event containers
+  m_subevents.clear();
+}
@@ -0,0 +1,87 @@
+// Tell emacs that this is a C++ source
+//  -*- C++ -*-.
+#ifndef G4MAIN_PHG4SUBEVENTMERGER_H
+#define G4MAIN_PHG4SUBEVENTMERGER_H
+
+/*!
+ * \file PHG4SubEventMerger.h
+ */
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>  // for pair
+#include <vector>
+
+class PHCompositeNode;
+class PHG4HitContainer;
+class PHG4TruthInfoContainer;
+
+/*!
+ * collects the output of the geant sub-events in the multithreaded mode of PHG4Reco
+ * and copies it to the main node tree.
+ *
+ * Each worker thread writes to its own node tree, with a G4TruthInfo and the g4hit
+ * containers of the main node tree. At the end of a sub-event, the containers are moved
+ * to the slot of the sub-event and replaced by empty ones. Once all sub-events are done,
+ * the slots are copied in sub-event order, with track, vertex and shower ids shifted
+ * after the ones already in use, the same way a new geant event would number them.
+ * Truth vertices of primary particles which were split across sub-events are merged back,
+ * using the PHG4InEvent vertex the primary particles come from.
+ * The output does therefore not depend on which thread processed which sub-event.
+ */
+class PHG4SubEventMerger final
+{
+ public:
+  //! constructor
+  PHG4SubEventMerger() = default;
+
+  //! destructor
+  ~PHG4SubEventMerger();
+
+  // no copy
+  PHG4SubEventMerger(const PHG4SubEventMerger &) = delete;
+  PHG4SubEventMerger &operator=(const PHG4SubEventMerger &) = delete;
+
+  //! load destination nodes from composite
+  void load_nodes(PHCompositeNode *);
+
+  //! create the node tree of a worker thread, with empty containers. Caller assumes ownership
+  PHCompositeNode *create_worker_nodes() const;
+
+  //! reset the slots for a run of nsubevents sub-events
+  void prepare(const unsigned int nsubevents);
+
+  //! truth vertex id of primary particles in a sub-event, and the PHG4InEvent vertex id they come from
+  using VertexSources = std::multimap<int, int>;
+
+  //! move the output of a sub-event from the worker node tree to its slot. Called from the worker threads
+  void store(const unsigned int subevent, PHCompositeNode *, VertexSources &&);
+
+  //! copy the content of all slots to destination, in sub-event order
+  void merge();
+
+ private:
+  //! output of one sub-event
+  struct SubEvent
+  {
+    std::unique_ptr<PHG4TruthInfoContainer> truthinfo;
+
+    //! input vertex ids of the primary truth vertices
+    VertexSources vertex_sources;
+
+    //! same order as m_g4hitscontainers
+    std::vector<std::unique_ptr<PHG4HitContainer>> g4hitscontainers;
+  };
+
+  //! truth information
+  PHG4TruthInfoContainer *m_g4truthinfo{nullptr};
+
+  //! destination g4hit containers and their node names
+  std::vector<std::pair<std::string, PHG4HitContainer *>> m_g4hitscontainers;
+
+  //! one slot per sub-event. Each slot is only written by the thread which processed the sub-event
+  std::vector<SubEvent> m_subevents;
+};
+
+#endif
@@ -18,6 +18,7 @@ class PHG4EventAction;
 class PHG4StackingAction;
 class PHG4SteppingAction;
 class PHG4TrackingAction;
+class PHG4WorkerEventAction;
 
 class PHG4Subsystem : public SubsysReco
 {
@@ -90,6 +91,15 @@ class PHG4Subsystem : public SubsysReco
   // define materials used in detector
   virtual void DefineMaterials() {}
 
+  //! subsystems which can run in the multithreaded mode of PHG4Reco need to implement
+  //! CreateWorkerActions and return true
+  virtual bool SupportsMultiThreading() const { return false; }
+
+  //! create the actions of one geant worker thread and register them to the worker event action.
+  //! They write to the node tree of the worker, which has the same node names as the main one.
+  //! Called once per worker thread, serialized between threads
+  virtual void CreateWorkerActions(PHG4WorkerEventAction * /*worker*/) {}
+
  private:
   PHG4Subsystem *m_MyMotherSubsystem = nullptr;
   G4LogicalVolume *m_MyLogicalVolume = nullptr;
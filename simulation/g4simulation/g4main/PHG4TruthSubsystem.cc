@@ -4,6 +4,7 @@
 #include "PHG4TruthEventAction.h"
 #include "PHG4TruthInfoContainer.h"
 #include "PHG4TruthTrackingAction.h"
+#include "PHG4WorkerEventAction.h"
 
 #include <fun4all/Fun4AllReturnCodes.h>
 
@@ -143,6 +144,14 @@ int PHG4TruthSubsystem::ResetEvent(PHCompositeNode* topNode)
   return 0;
 }
 
+//_______________________________________________________________________
+void PHG4TruthSubsystem::CreateWorkerActions(PHG4WorkerEventAction* worker)
+{
+  PHG4TruthEventAction* eventAction = new PHG4TruthEventAction();
+  worker->AddEventAction(eventAction);
+  worker->AddTrackingAction(new PHG4TruthTrackingAction(eventAction));
+}
+
 //_______________________________________________________________________
 PHG4EventAction* PHG4TruthSubsystem::GetEventAction() const
 {
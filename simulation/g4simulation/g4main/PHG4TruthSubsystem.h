@@ -40,6 +40,10 @@ class PHG4TruthSubsystem : public PHG4Subsystem
   PHG4EventAction *GetEventAction() const override;
   PHG4TrackingAction *GetTrackingAction() const override;
 
+  //! multithreading support
+  bool SupportsMultiThreading() const override { return true; }
+  void CreateWorkerActions(PHG4WorkerEventAction *worker) override;
+
   //! only save the G4 truth information that is associated with the embedded particle
   void SetSaveOnlyEmbeded(bool b = true) { m_SaveOnlyEmbededFlag = b; };
 
@@ -5,6 +5,7 @@
 
 #include <Geant4/G4VUserPrimaryParticleInformation.hh>
 #include <iostream>
+#include <limits>
 
 class PHG4UserPrimaryParticleInformation : public G4VUserPrimaryParticleInformation
 {
@@ -34,11 +35,16 @@ class PHG4UserPrimaryParticleInformation : public G4VUserPrimaryParticleInformat
   void set_user_barcode(int bcd) { barcode = bcd; }
   int get_user_barcode() const { return barcode; }
 
+  //! id of the PHG4InEvent vertex this particle comes from
+  void set_input_vtx_id(int val) { inputvtxid = val; }
+  int get_input_vtx_id() const { return inputvtxid; }
+
  private:
   int embed;
   int usertrackid;
   int uservtxid;
   int barcode;
+  int inputvtxid{std::numeric_limits<int>::min()};
 };
 
 #endif
@@ -0,0 +1,130 @@
+#include "PHG4WorkerEventAction.h"
+
+#include "PHG4EventAction.h"
+#include "PHG4PhenixStackingAction.h"
+#include "PHG4PhenixSteppingAction.h"
+#include "PHG4PhenixTrackingAction.h"
+#include "PHG4StackingAction.h"
+#include "PHG4SteppingAction.h"
+#include "PHG4SubEventMerger.h"
+#include "PHG4TrackingAction.h"
+#include "PHG4UserPrimaryParticleInformation.h"
+
+#include <phool/PHCompositeNode.h>
+
+#include <Geant4/G4Event.hh>
+#include <Geant4/G4EventManager.hh>
+#include <Geant4/G4PrimaryParticle.hh>
+#include <Geant4/G4PrimaryVertex.hh>
+#include <Geant4/G4Types.hh>  // for G4int
+
+#include <algorithm>
+#include <utility>
+
+class G4TrackingManager;
+
+PHG4WorkerEventAction::PHG4WorkerEventAction(PHG4SubEventMerger *merger, PHG4PhenixSteppingAction *stepping, PHG4PhenixTrackingAction *tracking, PHG4PhenixStackingAction *stacking)
+  : m_Merger(merger)
+  , m_TopNode(merger->create_worker_nodes())
+  , m_SteppingAction(stepping)
+  , m_TrackingAction(tracking)
+  , m_StackingAction(stacking)
+{
+}
+
+// the actions are deleted by the composite actions, the base class deletes the event actions
+PHG4WorkerEventAction::~PHG4WorkerEventAction() = default;
+
+void PHG4WorkerEventAction::AddEventAction(PHG4EventAction *action)
+{
+  AddAction(action);
+  m_EventActions.push_back(action);
+}
+
+void PHG4WorkerEventAction::AddSteppingAction(PHG4SteppingAction *action)
+{
+  m_SteppingAction->AddAction(action);
+  m_SteppingActions.push_back(action);
+}
+
+void PHG4WorkerEventAction::AddTrackingAction(PHG4TrackingAction *action)
+{
+  m_TrackingAction->AddAction(action);
+  m_TrackingActions.push_back(action);
+
+  // make the tracking manager of this thread accessible within the user tracking action
+  if (G4TrackingManager *trackingManager = G4EventManager::GetEventManager()->GetTrackingManager())
+  {
+    action->SetTrackingManagerPointer(trackingManager);
+  }
+}
+
+void PHG4WorkerEventAction::AddStackingAction(PHG4StackingAction *action)
+{
+  m_StackingAction->AddAction(action);
+  m_StackingActions.push_back(action);
+}
+
+//_________________________________________________________________
+void PHG4WorkerEventAction::BeginOfEventAction(const G4Event *event)
+{
+  // the output containers are replaced after each sub-event
+  PHCompositeNode *topNode = m_TopNode.get();
+  for (PHG4EventAction *action : m_EventActions)
+  {
+    action->SetInterfacePointers(topNode);
+  }
+  for (PHG4SteppingAction *action : m_SteppingActions)
+  {
+    action->SetInterfacePointers(topNode);
+  }
+  for (PHG4TrackingAction *action : m_TrackingActions)
+  {
+    action->SetInterfacePointers(topNode);
+  }
+  for (PHG4StackingAction *action : m_StackingActions)
+  {
+    action->SetInterfacePointers(topNode);
+  }
+  PHG4PhenixEventAction::BeginOfEventAction(event);
+}
+
+//_________________________________________________________________
+void PHG4WorkerEventAction::EndOfEventAction(const G4Event *event)
+{
+  PHG4PhenixEventAction::EndOfEventAction(event);
+
+  PHCompositeNode *topNode = m_TopNode.get();
+  for (PHG4EventAction *action : m_EventActions)
+  {
+    action->ResetEvent(topNode);
+  }
+  for (PHG4TrackingAction *action : m_TrackingActions)
+  {
+    action->ResetEvent(topNode);
+  }
+
+  // input vertex of the primary particles, set by the generator, and their truth vertex, set by the truth tracking action
+  PHG4SubEventMerger::VertexSources vertex_sources;
+  for (G4int ivtx = 0; ivtx < event->GetNumberOfPrimaryVertex(); ++ivtx)
+  {
+    G4PrimaryVertex *vertex = event->GetPrimaryVertex(ivtx);
+    for (G4int ipart = 0; ipart < vertex->GetNumberOfParticle(); ++ipart)
+    {
+      const auto *userdata = dynamic_cast<const PHG4UserPrimaryParticleInformation *>(vertex->GetPrimary(ipart)->GetUserInformation());
+      if (!userdata || userdata->get_user_vtx_id() <= 0)
+      {
+        continue;
+      }
+      const int vtxid = userdata->get_user_vtx_id();
+      const int inputvtxid = userdata->get_input_vtx_id();
+      const auto range = vertex_sources.equal_range(vtxid);
+      if (std::none_of(range.first, range.second, [inputvtxid](const auto &entry)
+                       { return entry.second == inputvtxid; }))
+      {
+        vertex_sources.emplace(vtxid, inputvtxid);
+      }
+    }
+  }
+  m_Merger->store(event->GetEventID(), topNode, std::move(vertex_sources));
+}
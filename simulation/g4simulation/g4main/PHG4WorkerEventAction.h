@@ -0,0 +1,65 @@
+// Tell emacs that this is a C++ source
+//  -*- C++ -*-.
+#ifndef G4MAIN_PHG4WORKEREVENTACTION_H
+#define G4MAIN_PHG4WORKEREVENTACTION_H
+
+#include "PHG4PhenixEventAction.h"
+
+#include <memory>
+#include <vector>
+
+class G4Event;
+class PHCompositeNode;
+class PHG4EventAction;
+class PHG4PhenixStackingAction;
+class PHG4PhenixSteppingAction;
+class PHG4PhenixTrackingAction;
+class PHG4StackingAction;
+class PHG4SteppingAction;
+class PHG4SubEventMerger;
+class PHG4TrackingAction;
+
+//! main event action of one geant worker thread in the multithreaded mode of PHG4Reco
+/**
+ * The subsystem actions of a worker are registered here by PHG4Subsystem::CreateWorkerActions
+ * and write to the node tree of the worker, which is owned by this class. At the beginning of
+ * each sub-event the actions get their node pointers, at the end the output containers are handed
+ * over to the PHG4SubEventMerger, which copies them to the main node tree after the run.
+ */
+class PHG4WorkerEventAction : public PHG4PhenixEventAction
+{
+ public:
+  //! the composite actions are owned by geant, the worker node tree is created by the merger
+  PHG4WorkerEventAction(PHG4SubEventMerger *merger, PHG4PhenixSteppingAction *stepping, PHG4PhenixTrackingAction *tracking, PHG4PhenixStackingAction *stacking);
+
+  ~PHG4WorkerEventAction() override;
+
+  //! register subsystem actions of this thread. They are owned by the corresponding composite action
+  void AddEventAction(PHG4EventAction *action);
+  void AddSteppingAction(PHG4SteppingAction *action);
+  void AddTrackingAction(PHG4TrackingAction *action);
+  void AddStackingAction(PHG4StackingAction *action);
+
+  void BeginOfEventAction(const G4Event *) override;
+
+  void EndOfEventAction(const G4Event *) override;
+
+  //! node tree of this worker thread
+  PHCompositeNode *topNode() const { return m_TopNode.get(); }
+
+ private:
+  PHG4SubEventMerger *m_Merger{nullptr};
+  std::unique_ptr<PHCompositeNode> m_TopNode;
+
+  PHG4PhenixSteppingAction *m_SteppingAction{nullptr};
+  PHG4PhenixTrackingAction *m_TrackingAction{nullptr};
+  PHG4PhenixStackingAction *m_StackingAction{nullptr};
+
+  //! registered actions, to set their node pointers and reset them
+  std::vector<PHG4EventAction *> m_EventActions;
+  std::vector<PHG4SteppingAction *> m_SteppingActions;
+  std::vector<PHG4TrackingAction *> m_TrackingActions;
+  std::vector<PHG4StackingAction *> m_StackingActions;
+};
+
+#endif
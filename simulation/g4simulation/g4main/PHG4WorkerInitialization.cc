@@ -0,0 +1,19 @@
+#include "PHG4WorkerInitialization.h"
+
+#include "PHG4Reco.h"
+
+namespace
+{
+  // processes are added at the first run of each worker thread
+  thread_local bool processes_added = false;
+}  // namespace
+
+void PHG4WorkerInitialization::WorkerRunStart() const
+{
+  if (processes_added)
+  {
+    return;
+  }
+  processes_added = true;
+  m_Reco->AddUserProcesses();
+}
@@ -0,0 +1,32 @@
+// Tell emacs that this is a C++ source
+//  -*- C++ -*-.
+#ifndef G4MAIN_PHG4WORKERINITIALIZATION_H
+#define G4MAIN_PHG4WORKERINITIALIZATION_H
+
+#include <Geant4/G4UserWorkerInitialization.hh>
+
+class PHG4Reco;
+
+//! adds the PHG4Reco user processes to the particles of each geant worker thread
+/**
+ * Process managers are thread local. The processes which PHG4Reco adds on the master
+ * after the initialization have to be added in every worker as well, before its
+ * physics tables are built at the start of its first run.
+ */
+class PHG4WorkerInitialization : public G4UserWorkerInitialization
+{
+ public:
+  explicit PHG4WorkerInitialization(PHG4Reco *reco)
+    : m_Reco(reco)
+  {
+  }
+
+  ~PHG4WorkerInitialization() override = default;
+
+  void WorkerRunStart() const override;
+
+ private:
+  PHG4Reco *m_Reco{nullptr};
+};
+
+#endif
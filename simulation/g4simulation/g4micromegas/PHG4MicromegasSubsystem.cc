@@ -13,6 +13,7 @@
 
 #include <g4main/PHG4HitContainer.h>
 #include <g4main/PHG4SteppingAction.h>
+#include <g4main/PHG4WorkerEventAction.h>
 
 #include <phool/PHCompositeNode.h>
 #include <phool/PHIODataNode.h>
@@ -99,6 +100,18 @@ int PHG4MicromegasSubsystem::InitRunSubsystem(PHCompositeNode *topNode)
   return 0;
 }
 
+//_______________________________________________________________________
+void PHG4MicromegasSubsystem::CreateWorkerActions(PHG4WorkerEventAction *worker)
+{
+  if (GetParams()->get_int_param("active"))
+  {
+    auto *action = new PHG4MicromegasSteppingAction(m_Detector, GetParams());
+    action->SetHitNodeName("G4HIT", m_HitNodeName);
+    action->SetHitNodeName("G4HIT_SUPPORT", m_SupportNodeName);
+    worker->AddSteppingAction(action);
+  }
+}
+
 //_______________________________________________________________________
 int PHG4MicromegasSubsystem::process_event(PHCompositeNode *topNode)
 {
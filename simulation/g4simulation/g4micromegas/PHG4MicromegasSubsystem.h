@@ -19,6 +19,7 @@ class PHG4MicromegasDetector;
 class PHG4DisplayAction;
 class PHG4MicromegasSteppingAction;
 class PHG4SteppingAction;
+class PHG4WorkerEventAction;
 
 /*!
  * \brief Detector Subsystem module
@@ -52,6 +53,10 @@ class PHG4MicromegasSubsystem : public PHG4DetectorSubsystem
   PHG4SteppingAction* GetSteppingAction() const override { return m_SteppingAction; }
   //@}
 
+  //! multithreading support, each worker thread gets its own stepping action
+  bool SupportsMultiThreading() const override { return true; }
+  void CreateWorkerActions(PHG4WorkerEventAction* worker) override;
+
   //! Print info (from SubsysReco)
   void Print(const std::string& what = "ALL") const override;
 
@@ -15,6 +15,7 @@
 #include <g4main/PHG4DisplayAction.h>  // for PHG4DisplayAction
 #include <g4main/PHG4HitContainer.h>
 #include <g4main/PHG4SteppingAction.h>  // for PHG4SteppingAction
+#include <g4main/PHG4WorkerEventAction.h>
 
 #include <phool/PHCompositeNode.h>
 #include <phool/PHIODataNode.h>    // for PHIODataNode
@@ -147,21 +148,40 @@ int PHG4MvtxSubsystem::InitRunSubsystem(PHCompositeNode* topNode)
         detNode->addNode(new PHIODataNode<PHObject>(g4_hits, nodename, "PHObject"));
       }
     }
+  }
+  m_ActiveFlag = active;
+  m_BlackHoleFlag = blackhole;
+
+  // create stepping action
+  m_SteppingAction = CreateSteppingAction();
+  return 0;
+}
 
-    // create stepping action
-    m_SteppingAction = new PHG4MvtxSteppingAction(m_Detector, GetParamsContainer());
-    m_SteppingAction->SetHitNodeName("G4HIT", m_HitNodeName);
-    m_SteppingAction->SetHitNodeName("G4HIT_SUPPORT", m_SupportNodeName);
-    m_SteppingAction->Verbosity(Verbosity());
+//_______________________________________________________________________
+PHG4SteppingAction* PHG4MvtxSubsystem::CreateSteppingAction()
+{
+  if (m_ActiveFlag)
+  {
+    auto* action = new PHG4MvtxSteppingAction(m_Detector, GetParamsContainer());
+    action->SetHitNodeName("G4HIT", m_HitNodeName);
+    action->SetHitNodeName("G4HIT_SUPPORT", m_SupportNodeName);
+    action->Verbosity(Verbosity());
+    return action;
   }
-  else
+  if (m_BlackHoleFlag)
   {
-    if (blackhole)
-    {
-      m_SteppingAction = new PHG4MvtxSteppingAction(m_Detector, GetParamsContainer());
-    }
+    return new PHG4MvtxSteppingAction(m_Detector, GetParamsContainer());
+  }
+  return nullptr;
+}
+
+//_______________________________________________________________________
+void PHG4MvtxSubsystem::CreateWorkerActions(PHG4WorkerEventAction* worker)
+{
+  if (PHG4SteppingAction* action = CreateSteppingAction())
+  {
+    worker->AddSteppingAction(action);
   }
-  return 0;
 }
 
 //_______________________________________________________________________
@@ -13,6 +13,7 @@ class PHG4Detector;
 class PHG4DisplayAction;
 class PHG4MvtxDetector;
 class PHG4SteppingAction;
+class PHG4WorkerEventAction;
 
 class PHG4MvtxSubsystem : public PHG4DetectorGroupSubsystem
 {
@@ -43,6 +44,10 @@ class PHG4MvtxSubsystem : public PHG4DetectorGroupSubsystem
   PHG4Detector* GetDetector(void) const override;
   PHG4SteppingAction* GetSteppingAction(void) const override { return m_SteppingAction; }
 
+  //! multithreading support, each worker thread gets its own stepping action
+  bool SupportsMultiThreading() const override { return true; }
+  void CreateWorkerActions(PHG4WorkerEventAction* worker) override;
+
   PHG4DisplayAction* GetDisplayAction() const override { return m_DisplayAction; }
 
   void Apply_Misalignment(bool b) { m_ApplyMisalignment = b; }
@@ -50,6 +55,10 @@ class PHG4MvtxSubsystem : public PHG4DetectorGroupSubsystem
 
  private:
   void SetDefaultParameters() override;
+
+  //! create the stepping action for active or black hole layers, nullptr otherwise
+  PHG4SteppingAction* CreateSteppingAction();
+
   static double radii2Turbo(double rMin, double rMid, double rMax, double sensW)
   {
     // compute turbo angle from radii and sensor width
@@ -73,6 +82,8 @@ class PHG4MvtxSubsystem : public PHG4DetectorGroupSubsystem
   std::string detector_type;
   std::string m_HitNodeName;
   std::string m_SupportNodeName;
+  bool m_ActiveFlag{false};
+  bool m_BlackHoleFlag{false};
   std::string m_misalignmentFile = "";
   bool m_ApplyMisalignment{false};
 };
@@ -501,7 +501,7 @@ void PHG4TpcDigitizer::DigitizeCylinderCells(PHCompositeNode *topNode)
                   auto hitset_iter = trkrhitsetcontainer->findOrAddHitSet(hitsetkey);
 
                   hit = new TrkrHitv2();
-                  hitset_iter->second->addHitSpecificKey(hitkey, hit);
+                  hit = hitset_iter->second->addHitSpecificKey(hitkey, hit)->second;
 
                   if (Verbosity() > 2)
                   {
@@ -0,0 +1,179 @@
+#include "PHG4TpcDriftBatch.h"
+
+#include "PHG4TpcDistortion.h"
+
+#include <fun4all/Fun4AllServer.h>
+#include <fun4all/Fun4AllTaskScheduler.h>
+
+#include <cmath>
+
+namespace
+{
+  template <class T>
+  constexpr T square(const T &x)
+  {
+    return x * x;
+  }
+
+  constexpr uint64_t golden_gamma = 0x9e3779b97f4a7c15ULL;
+
+  //! splitmix64 output function
+  constexpr uint64_t mix(uint64_t x)
+  {
+    x = (x ^ (x >> 30U)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27U)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31U);
+  }
+
+  //! n-th number of the splitmix64 sequence starting at key, uniform in [0,1)
+  inline double uniform(uint64_t key, uint64_t n)
+  {
+    return static_cast<double>(mix(key + (n + 1) * golden_gamma) >> 11U) * 0x1.0p-53;
+  }
+
+  //! random numbers used per electron
+  constexpr uint64_t words_per_electron = 4;
+}  // namespace
+
+//_____________________________________________________________
+void PHG4TpcDriftBatch::clear()
+{
+  m_keys.clear();
+  m_entry.clear();
+  m_exit.clear();
+  m_t_entry.clear();
+  m_t_exit.clear();
+  m_offset.assign(1, 0);
+}
+
+//_____________________________________________________________
+void PHG4TpcDriftBatch::add_hit(uint64_t key, const std::array<double, 3> &entry, const std::array<double, 3> &exit,
+                                double t_entry, double t_exit, unsigned int n_electrons)
+{
+  m_keys.push_back(key);
+  m_entry.push_back(entry);
+  m_exit.push_back(exit);
+  m_t_entry.push_back(t_entry);
+  m_t_exit.push_back(t_exit);
+  m_offset.push_back(m_offset.back() + n_electrons);
+}
+
+//_____________________________________________________________
+void PHG4TpcDriftBatch::drift(int event)
+{
+  const std::size_t n_electrons = m_offset.back();
+  for (auto *array : {&m_x_start, &m_y_start, &m_z_start, &m_t_start, &m_x_final, &m_y_final, &m_z_final, &m_t_final, &m_rad_final})
+  {
+    array->resize(n_electrons);
+  }
+  m_status.resize(n_electrons);
+
+  const uint64_t event_key = mix(m_seed + mix(static_cast<uint64_t>(event) + golden_gamma));
+  Fun4AllServer::instance()->TaskScheduler()->parallel_for(0, n_hits(), [this, event_key](std::size_t hit)
+                                                           { drift_hit(hit, event_key); });
+}
+
+//_____________________________________________________________
+double PHG4TpcDriftBatch::t_sigma(std::size_t i) const
+{
+  return m_parameters.diffusion_long * std::sqrt(m_parameters.tpc_length / 2. - std::abs(m_z_start[i])) / m_parameters.drift_velocity;
+}
+
+//_____________________________________________________________
+void PHG4TpcDriftBatch::drift_hit(std::size_t hit, uint64_t event_key)
+{
+  const uint64_t key = mix(event_key ^ m_keys[hit]);
+  const std::size_t first = m_offset[hit];
+  const std::size_t last = m_offset[hit + 1];
+
+  const auto &entry = m_entry[hit];
+  const auto &exit = m_exit[hit];
+  const double t_entry = m_t_entry[hit];
+  const double t_exit = m_t_exit[hit];
+
+  const double half_length = m_parameters.tpc_length / 2.;
+  const double velocity = m_parameters.drift_velocity;
+  const double diffusion_trans2 = square(m_parameters.diffusion_trans);
+  const double diffusion_time2 = square(m_parameters.diffusion_long / velocity);
+  const double smear_trans2 = square(m_parameters.added_smear_sigma_trans);
+  const double smear_time2 = square(m_parameters.added_smear_sigma_long / velocity);
+
+  // start point, flat along the path, diffusion and smearing
+  for (std::size_t i = first; i < last; ++i)
+  {
+    const uint64_t n = (i - first) * words_per_electron;
+    const double f = uniform(key, n);
+    const double u1 = 1. - uniform(key, n + 1);  // in (0,1] for the logarithm
+    const double u2 = uniform(key, n + 2);
+    const double ranphi = -M_PI + 2 * M_PI * uniform(key, n + 3);
+
+    // Box-Muller, one gaussian for each direction
+    const double gauss_norm = std::sqrt(-2. * std::log(u1));
+    const double gauss_trans = gauss_norm * std::cos(2 * M_PI * u2);
+    const double gauss_long = gauss_norm * std::sin(2 * M_PI * u2);
+
+    const double x_start = entry[0] + f * (exit[0] - entry[0]);
+    const double y_start = entry[1] + f * (exit[1] - entry[1]);
+    const double z_start = entry[2] + f * (exit[2] - entry[2]);
+    const double t_start = t_entry + f * (t_exit - t_entry);
+
+    const double drift_length = half_length - std::abs(z_start);
+    const double rantrans = gauss_trans * std::sqrt(diffusion_trans2 * drift_length + smear_trans2);
+    const double rantime = gauss_long * std::sqrt(diffusion_time2 * drift_length + smear_time2);
+    const double t_final = t_start + drift_length / velocity + rantime;
+
+    const double x_final = x_start + rantrans * std::cos(ranphi);
+    const double y_final = y_start + rantrans * std::sin(ranphi);
+
+    m_x_start[i] = x_start;
+    m_y_start[i] = y_start;
+    m_z_start[i] = z_start;
+    m_t_start[i] = t_start;
+    m_x_final[i] = x_final;
+    m_y_final[i] = y_final;
+    m_z_final[i] = (z_start < 0) ? -half_length + t_final * velocity : half_length - t_final * velocity;
+    m_t_final[i] = t_final;
+    m_rad_final[i] = std::sqrt(square(x_final) + square(y_final));
+    m_status[i] = (t_final < m_parameters.min_time || t_final > m_parameters.max_time) ? OutOfTime : Accepted;
+  }
+
+  // distortions, at the start point
+  if (m_distortion)
+  {
+    for (std::size_t i = first; i < last; ++i)
+    {
+      if (m_status[i] != Accepted)
+      {
+        continue;
+      }
+
+      const double radstart = std::sqrt(square(m_x_start[i]) + square(m_y_start[i]));
+      const double phistart = std::atan2(m_y_start[i], m_x_start[i]);
+      const double z_start = m_z_start[i];
+      if (m_distortion->get_reaches_readout(radstart, phistart, z_start) < m_parameters.threshold_reaches_readout)
+      {
+        m_status[i] = NotReachingReadout;
+        continue;
+      }
+
+      const double rad_final = m_rad_final[i] + m_distortion->get_r_distortion(radstart, phistart, z_start);
+      const double phi_final = std::atan2(m_y_final[i], m_x_final[i]) + m_distortion->get_rphi_distortion(radstart, phistart, z_start) / radstart;
+      const double z_final = m_z_final[i] + m_distortion->get_z_distortion(radstart, phistart, z_start);
+
+      m_rad_final[i] = rad_final;
+      m_x_final[i] = rad_final * std::cos(phi_final);
+      m_y_final[i] = rad_final * std::sin(phi_final);
+      m_z_final[i] = z_final;
+      m_t_final[i] = (z_start < 0) ? (z_final + half_length) / velocity : (half_length - z_final) / velocity;
+    }
+  }
+
+  // acceptance. Electrons from just inside the first active layer can still contribute, so leave a little margin
+  const double min_radius = m_parameters.min_active_radius - 2.0;
+  const double max_radius = m_parameters.max_active_radius + 1.0;
+  for (std::size_t i = first; i < last; ++i)
+  {
+    const bool outside = m_rad_final[i] < min_radius || m_rad_final[i] > max_radius;
+    m_status[i] = (m_status[i] == Accepted && outside) ? OutOfAcceptance : m_status[i];
+  }
+}
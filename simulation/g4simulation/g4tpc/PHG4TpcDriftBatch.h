@@ -0,0 +1,128 @@
+// Tell emacs that this is a C++ source
+// -*- C++ -*-.
+#ifndef G4TPC_PHG4TPCDRIFTBATCH_H
+#define G4TPC_PHG4TPCDRIFTBATCH_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class PHG4TpcDistortion;
+
+//! drifts the ionisation electrons of many g4hits at once, for PHG4TpcElectronDrift
+/*!
+ * Hits are added with their entry and exit points in TPC envelope coordinates and
+ * their number of electrons. drift() then generates, diffuses and distorts all
+ * electrons, stored as structure of arrays, with one loop per step. Hits are spread
+ * over the threads of the Fun4AllTaskScheduler.
+ *
+ * Random numbers come from a counter based generator: the values used by an electron
+ * only depend on the seed, the event, the g4hit key and the electron index, so that
+ * the result does not depend on the number of threads nor on how hits are batched.
+ * The distributions are the same as for the electron by electron drift, with the two
+ * gaussian smearings in each direction combined into a single gaussian.
+ */
+class PHG4TpcDriftBatch
+{
+ public:
+  //! drift parameters, same meaning as in PHG4TpcElectronDrift
+  struct Parameters
+  {
+    double diffusion_trans = 0;
+    double diffusion_long = 0;
+    double added_smear_sigma_trans = 0;
+    double added_smear_sigma_long = 0;
+    double tpc_length = 0;
+    double drift_velocity = 0;
+    double min_time = 0;
+    double max_time = 0;
+    double min_active_radius = 0;
+    double max_active_radius = 0;
+    double threshold_reaches_readout = 0;
+  };
+
+  //! electron status after drift. Only accepted electrons go to the pad plane
+  enum Status : uint8_t
+  {
+    Accepted = 0,
+    OutOfTime,
+    NotReachingReadout,
+    OutOfAcceptance
+  };
+
+  void set_parameters(const Parameters &parameters) { m_parameters = parameters; }
+
+  //! distortions, applied when not null
+  void set_distortion(const PHG4TpcDistortion *distortion) { m_distortion = distortion; }
+
+  void set_seed(uint64_t seed) { m_seed = seed; }
+
+  //! remove all hits, keeping the storage
+  void clear();
+
+  //! add a hit, with entry and exit points in TPC envelope coordinates
+  void add_hit(uint64_t key, const std::array<double, 3> &entry, const std::array<double, 3> &exit,
+               double t_entry, double t_exit, unsigned int n_electrons);
+
+  //! generate and drift the electrons of all hits
+  void drift(int event);
+
+  //!@name accessors
+  //@{
+  std::size_t n_hits() const { return m_keys.size(); }
+  unsigned int n_electrons(std::size_t hit) const { return m_offset[hit + 1] - m_offset[hit]; }
+
+  //! electron index range of a given hit
+  std::size_t begin(std::size_t hit) const { return m_offset[hit]; }
+  std::size_t end(std::size_t hit) const { return m_offset[hit + 1]; }
+
+  Status status(std::size_t i) const { return m_status[i]; }
+  unsigned int side(std::size_t i) const { return m_z_start[i] > 0 ? 1 : 0; }
+  double z_start(std::size_t i) const { return m_z_start[i]; }
+  double t_start(std::size_t i) const { return m_t_start[i]; }
+  double x_final(std::size_t i) const { return m_x_final[i]; }
+  double y_final(std::size_t i) const { return m_y_final[i]; }
+  double z_final(std::size_t i) const { return m_z_final[i]; }
+  double t_final(std::size_t i) const { return m_t_final[i]; }
+  double rad_final(std::size_t i) const { return m_rad_final[i]; }
+
+  //! longitudinal diffusion in time, without added smearing
+  double t_sigma(std::size_t i) const;
+  //@}
+
+ private:
+  //! drift the electrons of one hit. Hits only write to their own electron range
+  void drift_hit(std::size_t hit, uint64_t event_key);
+
+  Parameters m_parameters;
+  const PHG4TpcDistortion *m_distortion{nullptr};
+  uint64_t m_seed{0};
+
+  //!@name hits
+  //@{
+  std::vector<uint64_t> m_keys;
+  std::vector<std::array<double, 3>> m_entry;
+  std::vector<std::array<double, 3>> m_exit;
+  std::vector<double> m_t_entry;
+  std::vector<double> m_t_exit;
+  //! first electron of each hit, plus the total number of electrons
+  std::vector<std::size_t> m_offset{0};
+  //@}
+
+  //!@name electrons
+  //@{
+  std::vector<double> m_x_start;
+  std::vector<double> m_y_start;
+  std::vector<double> m_z_start;
+  std::vector<double> m_t_start;
+  std::vector<double> m_x_final;
+  std::vector<double> m_y_final;
+  std::vector<double> m_z_final;
+  std::vector<double> m_t_final;
+  std::vector<double> m_rad_final;
+  std::vector<Status> m_status;
+  //@}
+};
+
+#endif  // G4TPC_PHG4TPCDRIFTBATCH_H
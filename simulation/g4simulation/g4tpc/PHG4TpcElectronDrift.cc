@@ -3,6 +3,7 @@
 
 #include "PHG4TpcElectronDrift.h"
 #include "PHG4TpcDistortion.h"
+#include "PHG4TpcDriftBatch.h"
 #include "PHG4TpcPadPlane.h"  // for PHG4TpcPadPlane
 #include "TpcClusterBuilder.h"
 
@@ -82,6 +83,7 @@ PHG4TpcElectronDrift::PHG4TpcElectronDrift(const std::string &name)
   , PHParameterInterface(name)
   , temp_hitsetcontainer(new TrkrHitSetContainerv1)
   , single_hitsetcontainer(new TrkrHitSetContainerv1)
+  , m_driftBatch(new PHG4TpcDriftBatch)
 {
   InitializeParameters();
   RandomGenerator.reset(gsl_rng_alloc(gsl_rng_mt19937));
@@ -450,6 +452,31 @@ int PHG4TpcElectronDrift::process_event(PHCompositeNode *topNode)
 
   int trkid = -1;
 
+  // in batched mode, the electrons of the next m_drift_batch_size g4hits are drifted
+  // together each time the loop reaches the end of the current batch. The QA histograms
+  // need intermediate quantities, only available from the electron by electron drift
+  const bool batched_drift = m_batched_drift && !do_ElectronDriftQAHistos;
+  if (batched_drift)
+  {
+    PHG4TpcDriftBatch::Parameters parameters;
+    parameters.diffusion_trans = diffusion_trans;
+    parameters.diffusion_long = diffusion_long;
+    parameters.added_smear_sigma_trans = added_smear_sigma_trans;
+    parameters.added_smear_sigma_long = added_smear_sigma_long;
+    parameters.tpc_length = tpc_length;
+    parameters.drift_velocity = layergeom->get_drift_velocity_sim();
+    parameters.min_time = min_time;
+    parameters.max_time = max_time;
+    parameters.min_active_radius = min_active_radius;
+    parameters.max_active_radius = max_active_radius;
+    parameters.threshold_reaches_readout = thresholdforreachesreadout;
+    m_driftBatch->set_parameters(parameters);
+    m_driftBatch->set_distortion(m_distortionMap.get());
+    m_driftBatch->set_seed(m_seed);
+  }
+  auto batch_end = hit_begin_end.first;
+  std::size_t batch_hit = 0;
+
   PHG4Hit *prior_g4hit = nullptr;  // used to check for jumps in g4hits;
   // if there is a big jump (such as crossing into the INTT area or out of the TPC)
   // then cluster the truth clusters before adding a new hit. This prevents
@@ -459,6 +486,12 @@ int PHG4TpcElectronDrift::process_event(PHCompositeNode *topNode)
     count_g4hits++;
     dump_counter++;
 
+    if (batched_drift && hiter == batch_end)
+    {
+      batch_end = drift_batch(hiter, hit_begin_end.second);
+      batch_hit = 0;
+    }
+
     const double t0 = std::fmax(hiter->second->get_t(0), hiter->second->get_t(1));
     if (t0 > max_time)
     {
@@ -523,7 +556,7 @@ int PHG4TpcElectronDrift::process_event(PHCompositeNode *topNode)
     // drifted electrons, then copy to the node tree later
 
     double eion = hiter->second->get_eion();
-    unsigned int n_electrons = gsl_ran_poisson(RandomGenerator.get(), eion * electrons_per_gev);
+    const unsigned int n_electrons = batched_drift ? m_driftBatch->n_electrons(batch_hit++) : gsl_ran_poisson(RandomGenerator.get(), eion * electrons_per_gev);
     //    count_electrons += n_electrons;
 
     if (Verbosity() > 100)
@@ -556,167 +589,177 @@ int PHG4TpcElectronDrift::process_event(PHCompositeNode *topNode)
 
     int notReachingReadout = 0;
     //    int notInAcceptance = 0;
-    for (unsigned int i = 0; i < n_electrons; i++)
+    if (batched_drift)
     {
-      // We choose the electron starting position at random from a flat
-      // distribution along the path length the parameter t is the fraction of
-      // the distance along the path betwen entry and exit points, it has
-      // values between 0 and 1
-      const double f = gsl_ran_flat(RandomGenerator.get(), 0.0, 1.0);
-
-      const double x_start_glob = hiter->second->get_x(0) + f * (hiter->second->get_x(1) - hiter->second->get_x(0));
-      const double y_start_glob = hiter->second->get_y(0) + f * (hiter->second->get_y(1) - hiter->second->get_y(0));
-      const double z_start_glob = hiter->second->get_z(0) + f * (hiter->second->get_z(1) - hiter->second->get_z(0));
-      const double t_start = hiter->second->get_t(0) + f * (hiter->second->get_t(1) - hiter->second->get_t(0));
-
-      Acts::Vector3 start_glob(x_start_glob, y_start_glob, z_start_glob);
-      Acts::Vector3 start = m_tGeometry->transformTpcWorldToEnvelope(start_glob); // we drift in tpc envelope coords, where E is in the z direction
-
-      const double x_start = start.x();
-      const double y_start = start.y();
-      const double z_start = start.z();
-      /*
-      std::cout << " xg " << x_start_glob << " x " << x_start
-		<<" yg " << y_start_glob << " y " << y_start
-		<<" zg " << z_start_glob << " z " << z_start << std::endl;
-      */
-      unsigned int side = 0;
-      if (z_start > 0)
-      {
-        side = 1;
-      }
-
-      const double r_sigma = diffusion_trans * sqrt(tpc_length / 2. - std::abs(z_start));
-      const double rantrans =
-          gsl_ran_gaussian(RandomGenerator.get(), r_sigma) +
-          gsl_ran_gaussian(RandomGenerator.get(), added_smear_sigma_trans);
-
-      const double t_path = (tpc_length / 2. - std::abs(z_start)) / layergeom->get_drift_velocity_sim();
-      const double t_sigma = diffusion_long * sqrt(tpc_length / 2. - std::abs(z_start)) / layergeom->get_drift_velocity_sim();
-      const double rantime =
-          gsl_ran_gaussian(RandomGenerator.get(), t_sigma) +
-	gsl_ran_gaussian(RandomGenerator.get(), added_smear_sigma_long) / layergeom->get_drift_velocity_sim();
-      double t_final = t_start + t_path + rantime;
-
-      if (t_final < min_time || t_final > max_time)
-      {
-        continue;
-      }
-
-      double z_final;
-      if (z_start < 0)
-      {
-        z_final = -tpc_length / 2. + t_final * layergeom->get_drift_velocity_sim();
-      }
-      else
+      map_batch_electrons(batch_hit - 1, hiter, ihit);
+    }
+    else
+    {
+      for (unsigned int i = 0; i < n_electrons; i++)
       {
-        z_final = tpc_length / 2. - t_final * layergeom->get_drift_velocity_sim();
-      }
-
-      const double radstart = std::sqrt(square(x_start) + square(y_start));
-      const double phistart = std::atan2(y_start, x_start);
-      const double ranphi = gsl_ran_flat(RandomGenerator.get(), -M_PI, M_PI);
-
-      double x_final = x_start + rantrans * std::cos(ranphi);  // Initialize these to be only diffused first, will be overwritten if doing SC distortion
-      double y_final = y_start + rantrans * std::sin(ranphi);
+        // We choose the electron starting position at random from a flat
+        // distribution along the path length the parameter t is the fraction of
+        // the distance along the path betwen entry and exit points, it has
+        // values between 0 and 1
+        const double f = gsl_ran_flat(RandomGenerator.get(), 0.0, 1.0);
+
+        const double x_start_glob = hiter->second->get_x(0) + f * (hiter->second->get_x(1) - hiter->second->get_x(0));
+        const double y_start_glob = hiter->second->get_y(0) + f * (hiter->second->get_y(1) - hiter->second->get_y(0));
+        const double z_start_glob = hiter->second->get_z(0) + f * (hiter->second->get_z(1) - hiter->second->get_z(0));
+        const double t_start = hiter->second->get_t(0) + f * (hiter->second->get_t(1) - hiter->second->get_t(0));
+
+        Acts::Vector3 start_glob(x_start_glob, y_start_glob, z_start_glob);
+        Acts::Vector3 start = m_tGeometry->transformTpcWorldToEnvelope(start_glob); // we drift in tpc envelope coords, where E is in the z direction
+
+        const double x_start = start.x();
+        const double y_start = start.y();
+        const double z_start = start.z();
+        /*
+        std::cout << " xg " << x_start_glob << " x " << x_start
+  		<<" yg " << y_start_glob << " y " << y_start
+  		<<" zg " << z_start_glob << " z " << z_start << std::endl;
+        */
+        unsigned int side = 0;
+        if (z_start > 0)
+        {
+          side = 1;
+        }
 
-      double rad_final = sqrt(square(x_final) + square(y_final));
-      double phi_final = atan2(y_final, x_final);
+        const double r_sigma = diffusion_trans * sqrt(tpc_length / 2. - std::abs(z_start));
+        const double rantrans =
+            gsl_ran_gaussian(RandomGenerator.get(), r_sigma) +
+            gsl_ran_gaussian(RandomGenerator.get(), added_smear_sigma_trans);
 
-      if (do_ElectronDriftQAHistos)
-      {
-        z_startmap->Fill(z_start, radstart);                   // map of starting location in Z vs. R
-        deltaphinodist->Fill(phistart, rantrans / rad_final);  // delta phi no distortion, just diffusion+smear
-        deltarnodist->Fill(radstart, rantrans);                // delta r no distortion, just diffusion+smear
-      }
+        const double t_path = (tpc_length / 2. - std::abs(z_start)) / layergeom->get_drift_velocity_sim();
+        const double t_sigma = diffusion_long * sqrt(tpc_length / 2. - std::abs(z_start)) / layergeom->get_drift_velocity_sim();
+        const double rantime =
+            gsl_ran_gaussian(RandomGenerator.get(), t_sigma) +
+  	gsl_ran_gaussian(RandomGenerator.get(), added_smear_sigma_long) / layergeom->get_drift_velocity_sim();
+        double t_final = t_start + t_path + rantime;
 
-      if (m_distortionMap)
-      {
-        // zhangcanyu
-        const double reaches = m_distortionMap->get_reaches_readout(radstart, phistart, z_start);
-        if (reaches < thresholdforreachesreadout)
+        if (t_final < min_time || t_final > max_time)
         {
-          notReachingReadout++;
           continue;
         }
 
-        const double r_distortion = m_distortionMap->get_r_distortion(radstart, phistart, z_start);
-        const double phi_distortion = m_distortionMap->get_rphi_distortion(radstart, phistart, z_start) / radstart;
-        const double z_distortion = m_distortionMap->get_z_distortion(radstart, phistart, z_start);
-
-        rad_final += r_distortion;
-        phi_final += phi_distortion;
-        z_final += z_distortion;
+        double z_final;
         if (z_start < 0)
         {
-          t_final = (z_final + tpc_length / 2.0) / layergeom->get_drift_velocity_sim();
+          z_final = -tpc_length / 2. + t_final * layergeom->get_drift_velocity_sim();
         }
         else
         {
-          t_final = (tpc_length / 2.0 - z_final) / layergeom->get_drift_velocity_sim();
+          z_final = tpc_length / 2. - t_final * layergeom->get_drift_velocity_sim();
         }
 
-        x_final = rad_final * std::cos(phi_final);
-        y_final = rad_final * std::sin(phi_final);
+        const double radstart = std::sqrt(square(x_start) + square(y_start));
+        const double phistart = std::atan2(y_start, x_start);
+        const double ranphi = gsl_ran_flat(RandomGenerator.get(), -M_PI, M_PI);
 
-        //	if(i < 1)
-        //{std::cout << " electron " << i << " r_distortion " << r_distortion << " phi_distortion " << phi_distortion << " rad_final " << rad_final << " phi_final " << phi_final << " r*dphi distortion " << rad_final * phi_distortion << " z_distortion " << z_distortion << std::endl;}
+        double x_final = x_start + rantrans * std::cos(ranphi);  // Initialize these to be only diffused first, will be overwritten if doing SC distortion
+        double y_final = y_start + rantrans * std::sin(ranphi);
+
+        double rad_final = sqrt(square(x_final) + square(y_final));
+        double phi_final = atan2(y_final, x_final);
 
         if (do_ElectronDriftQAHistos)
         {
-          const double phi_final_nodiff = phistart + phi_distortion;
-          const double rad_final_nodiff = radstart + r_distortion;
-          deltarnodiff->Fill(radstart, rad_final_nodiff - radstart);    // delta r no diffusion, just distortion
-          deltaphinodiff->Fill(phistart, phi_final_nodiff - phistart);  // delta phi no diffusion, just distortion
-          deltaphivsRnodiff->Fill(radstart, phi_final_nodiff - phistart);
-          deltaRphinodiff->Fill(radstart, rad_final_nodiff * phi_final_nodiff - radstart * phistart);
-
-          // Fill Diagnostic plots, written into ElectronDriftQA.root
-          hitmapstart->Fill(x_start, y_start);  // G4Hit starting positions
-          hitmapend->Fill(x_final, y_final);    // INcludes diffusion and distortion
-          hitmapstart_z->Fill(z_start, radstart);
-          hitmapend_z->Fill(z_final, rad_final);
-          deltar->Fill(radstart, rad_final - radstart);    // total delta r
-          deltaphi->Fill(phistart, phi_final - phistart);  // total delta phi
-          deltaz->Fill(z_start, z_distortion);             // map of distortion in Z (time)
+          z_startmap->Fill(z_start, radstart);                   // map of starting location in Z vs. R
+          deltaphinodist->Fill(phistart, rantrans / rad_final);  // delta phi no distortion, just diffusion+smear
+          deltarnodist->Fill(radstart, rantrans);                // delta r no distortion, just diffusion+smear
         }
-      }
 
-      // remove electrons outside of our acceptance. Careful though, electrons from just inside 30 cm can contribute in the 1st active layer readout, so leave a little margin
-      if (rad_final < min_active_radius - 2.0 || rad_final > max_active_radius + 1.0)
-      {
-        //        notInAcceptance++;
-        continue;
-      }
+        if (m_distortionMap)
+        {
+          // zhangcanyu
+          const double reaches = m_distortionMap->get_reaches_readout(radstart, phistart, z_start);
+          if (reaches < thresholdforreachesreadout)
+          {
+            notReachingReadout++;
+            continue;
+          }
 
-      if (Verbosity() > 1000)
-      //      if(i < 1)
-      {
-        std::cout << "electron " << i << " g4hitid " << hiter->first << " f " << f << std::endl;
-        std::cout << "radstart " << radstart << " x_start: " << x_start
-                  << ", y_start: " << y_start
-                  << ",z_start: " << z_start
-                  << " t_start " << t_start
-                  << " t_path " << t_path
-                  << " t_sigma " << t_sigma
-                  << " rantime " << rantime
-                  << std::endl;
-
-        std::cout << "       rad_final " << rad_final << " x_final " << x_final
-                  << " y_final " << y_final
-                  << " z_final " << z_final << " t_final " << t_final
-                  << " zdiff " << z_final - z_start << std::endl;
-      }
+          const double r_distortion = m_distortionMap->get_r_distortion(radstart, phistart, z_start);
+          const double phi_distortion = m_distortionMap->get_rphi_distortion(radstart, phistart, z_start) / radstart;
+          const double z_distortion = m_distortionMap->get_z_distortion(radstart, phistart, z_start);
 
-      if (Verbosity() > 0)
-      {
-        assert(nt);
-        nt->Fill(ihit, t_start, t_final, t_sigma, rad_final, z_start, z_final);
-      }
-      padplane->MapToPadPlane(truth_clusterer, single_hitsetcontainer.get(),
-                              temp_hitsetcontainer.get(), hittruthassoc, x_final, y_final, t_final,
-                              side, hiter, ntpad, nthit);
-    }  // end loop over electrons for this g4hit
+          rad_final += r_distortion;
+          phi_final += phi_distortion;
+          z_final += z_distortion;
+          if (z_start < 0)
+          {
+            t_final = (z_final + tpc_length / 2.0) / layergeom->get_drift_velocity_sim();
+          }
+          else
+          {
+            t_final = (tpc_length / 2.0 - z_final) / layergeom->get_drift_velocity_sim();
+          }
+
+          x_final = rad_final * std::cos(phi_final);
+          y_final = rad_final * std::sin(phi_final);
+
+          //	if(i < 1)
+          //{std::cout << " electron " << i << " r_distortion " << r_distortion << " phi_distortion " << phi_distortion << " rad_final " << rad_final << " phi_final " << phi_final << " r*dphi distortion " << rad_final * phi_distortion << " z_distortion " << z_distortion << std::endl;}
+
+          if (do_ElectronDriftQAHistos)
+          {
+            const double phi_final_nodiff = phistart + phi_distortion;
+            const double rad_final_nodiff = radstart + r_distortion;
+            deltarnodiff->Fill(radstart, rad_final_nodiff - radstart);    // delta r no diffusion, just distortion
+            deltaphinodiff->Fill(phistart, phi_final_nodiff - phistart);  // delta phi no diffusion, just distortion
+            deltaphivsRnodiff->Fill(radstart, phi_final_nodiff - phistart);
+            deltaRphinodiff->Fill(radstart, rad_final_nodiff * phi_final_nodiff - radstart * phistart);
+
+            // Fill Diagnostic plots, written into ElectronDriftQA.root
+            hitmapstart->Fill(x_start, y_start);  // G4Hit starting positions
+            hitmapend->Fill(x_final, y_final);    // INcludes diffusion and distortion
+            hitmapstart_z->Fill(z_start, radstart);
+            hitmapend_z->Fill(z_final, rad_final);
+            deltar->Fill(radstart, rad_final - radstart);    // total delta r
+            deltaphi->Fill(phistart, phi_final - phistart);  // total delta phi
+            deltaz->Fill(z_start, z_distortion);             // map of distortion in Z (time)
+          }
+        }
+
+        // remove electrons outside of our acceptance. Careful though, electrons from just inside 30 cm can contribute in the 1st active layer readout, so leave a little margin
+        if (rad_final < min_active_radius - 2.0 || rad_final > max_active_radius + 1.0)
+        {
+          //        notInAcceptance++;
+          continue;
+        }
+
+        if (Verbosity() > 1000)
+        //      if(i < 1)
+        {
+          std::cout << "electron " << i << " g4hitid " << hiter->first << " f " << f << std::endl;
+          std::cout << "radstart " << radstart << " x_start: " << x_start
+                    << ", y_start: " << y_start
+                    << ",z_start: " << z_start
+                    << " t_start " << t_start
+                    << " t_path " << t_path
+                    << " t_sigma " << t_sigma
+                    << " rantime " << rantime
+                    << std::endl;
+
+          std::cout << "       rad_final " << rad_final << " x_final " << x_final
+                    << " y_final " << y_final
+                    << " z_final " << z_final << " t_final " << t_final
+                    << " zdiff " << z_final - z_start << std::endl;
+        }
+
+        if (Verbosity() > 0)
+        {
+          assert(nt);
+          nt->Fill(ihit, t_start, t_final, t_sigma, rad_final, z_start, z_final);
+        }
+        padplane->MapToPadPlane(truth_clusterer, single_hitsetcontainer.get(),
+                                temp_hitsetcontainer.get(), hittruthassoc, x_final, y_final, t_final,
+                                side, hiter, ntpad, nthit);
+      }  // end loop over electrons for this g4hit
+    }
+
+    // readouts which buffer the charge of the g4hit create their hits now
+    padplane->FlushHits(truth_clusterer, single_hitsetcontainer.get(), temp_hitsetcontainer.get());
 
     if (do_ElectronDriftQAHistos)
     {
@@ -808,7 +851,7 @@ int PHG4TpcElectronDrift::process_event(PHCompositeNode *topNode)
           {
             // Otherwise, create a new one
             node_hit = new TrkrHitv2();
-            node_hitsetit->second->addHitSpecificKey(temp_hitkey, node_hit);
+            node_hit = node_hitsetit->second->addHitSpecificKey(temp_hitkey, node_hit)->second;
           }
 
           // Either way, add the energy to it
@@ -903,6 +946,71 @@ int PHG4TpcElectronDrift::process_event(PHCompositeNode *topNode)
   return Fun4AllReturnCodes::EVENT_OK;
 }
 
+//_____________________________________________________________
+PHG4HitContainer::ConstIterator PHG4TpcElectronDrift::drift_batch(PHG4HitContainer::ConstIterator begin, PHG4HitContainer::ConstIterator end)
+{
+  m_driftBatch->clear();
+  auto hiter = begin;
+  for (unsigned int count = 0; hiter != end && count < m_drift_batch_size; ++hiter, ++count)
+  {
+    const PHG4Hit *hit = hiter->second;
+    if (std::fmax(hit->get_t(0), hit->get_t(1)) > max_time)
+    {
+      continue;
+    }
+
+    // the number of electrons is drawn in g4hit order, independently of the batch size
+    const unsigned int n_electrons = gsl_ran_poisson(RandomGenerator.get(), hit->get_eion() * electrons_per_gev);
+
+    // the world to envelope transformation is affine, so that the end points can be transformed
+    // once, instead of the start point of every electron
+    const Acts::Vector3 entry = m_tGeometry->transformTpcWorldToEnvelope(Acts::Vector3(hit->get_x(0), hit->get_y(0), hit->get_z(0)));
+    const Acts::Vector3 exit = m_tGeometry->transformTpcWorldToEnvelope(Acts::Vector3(hit->get_x(1), hit->get_y(1), hit->get_z(1)));
+    m_driftBatch->add_hit(hiter->first, {entry.x(), entry.y(), entry.z()}, {exit.x(), exit.y(), exit.z()},
+                          hit->get_t(0), hit->get_t(1), n_electrons);
+  }
+
+  m_driftBatch->drift(event_num);
+  return hiter;
+}
+
+//_____________________________________________________________
+void PHG4TpcElectronDrift::map_batch_electrons(std::size_t hit, PHG4HitContainer::ConstIterator hiter, double ihit)
+{
+  // pad plane mapping fills shared containers and the truth clusters, so it stays sequential, in electron order
+  for (std::size_t i = m_driftBatch->begin(hit); i < m_driftBatch->end(hit); ++i)
+  {
+    if (m_driftBatch->status(i) != PHG4TpcDriftBatch::Accepted)
+    {
+      continue;
+    }
+
+    if (Verbosity() > 1000)
+    {
+      std::cout << "electron " << i - m_driftBatch->begin(hit) << " g4hitid " << hiter->first << std::endl;
+      std::cout << "z_start " << m_driftBatch->z_start(i)
+                << " t_start " << m_driftBatch->t_start(i)
+                << " t_sigma " << m_driftBatch->t_sigma(i)
+                << std::endl;
+
+      std::cout << "       rad_final " << m_driftBatch->rad_final(i) << " x_final " << m_driftBatch->x_final(i)
+                << " y_final " << m_driftBatch->y_final(i)
+                << " z_final " << m_driftBatch->z_final(i) << " t_final " << m_driftBatch->t_final(i)
+                << " zdiff " << m_driftBatch->z_final(i) - m_driftBatch->z_start(i) << std::endl;
+    }
+
+    if (Verbosity() > 0)
+    {
+      assert(nt);
+      nt->Fill(ihit, m_driftBatch->t_start(i), m_driftBatch->t_final(i), m_driftBatch->t_sigma(i),
+               m_driftBatch->rad_final(i), m_driftBatch->z_start(i), m_driftBatch->z_final(i));
+    }
+    padplane->MapToPadPlane(truth_clusterer, single_hitsetcontainer.get(),
+                            temp_hitsetcontainer.get(), hittruthassoc, m_driftBatch->x_final(i), m_driftBatch->y_final(i), m_driftBatch->t_final(i),
+                            m_driftBatch->side(i), hiter, ntpad, nthit);
+  }
+}
+
 int PHG4TpcElectronDrift::End(PHCompositeNode * /*topNode*/)
 {
   if (Verbosity() > 0)
@@ -947,6 +1055,7 @@ int PHG4TpcElectronDrift::End(PHCompositeNode * /*topNode*/)
 void PHG4TpcElectronDrift::set_seed(const unsigned int seed)
 {
   gsl_rng_set(RandomGenerator.get(), seed);
+  m_seed = seed;
 }
 
 void PHG4TpcElectronDrift::SetDefaultParameters()
@@ -15,8 +15,10 @@
 
 #include <gsl/gsl_rng.h>
 
+#include <algorithm>
 #include <array>
 #include <cmath>
+#include <cstddef>
 #include <fstream>
 #include <limits>
 #include <memory>
@@ -24,6 +26,7 @@
 
 class PHG4TpcPadPlane;
 class PHG4TpcDistortion;
+class PHG4TpcDriftBatch;
 class PHCompositeNode;
 class TH1;
 class TH2;
@@ -84,9 +87,22 @@ class PHG4TpcElectronDrift : public SubsysReco, public PHParameterInterface
   void set_zero_bfield_flag(bool flag) { zero_bfield = flag; };
   void set_zero_bfield_diffusion_factor(double f) { zero_bfield_diffusion_factor = f; };
   void use_PDG_gas_params() { m_use_PDG_gas_params = true; }
+
+  //! drift the electrons of many g4hits at once, in parallel. See PHG4TpcDriftBatch
+  void set_batched_drift(bool flag) { m_batched_drift = flag; }
+
+  //! number of g4hits drifted together in batched mode, at least one
+  void set_drift_batch_size(unsigned int n) { m_drift_batch_size = std::max(1U, n); }
+
   ClusHitsVerbosev1 *mClusHitsVerbose{nullptr};
 
  private:
+  //! drift the electrons of the g4hits from begin, up to the batch size. Returns the end of the batch
+  PHG4HitContainer::ConstIterator drift_batch(PHG4HitContainer::ConstIterator begin, PHG4HitContainer::ConstIterator end);
+
+  //! send the accepted electrons of a batch hit to the pad plane
+  void map_batch_electrons(std::size_t hit, PHG4HitContainer::ConstIterator hiter, double ihit);
+
   TrkrHitSetContainer *hitsetcontainer{nullptr};
   TrkrHitTruthAssoc *hittruthassoc{nullptr};
   TrkrTruthTrackContainer *truthtracks{nullptr};
@@ -143,11 +159,16 @@ class PHG4TpcElectronDrift : public SubsysReco, public PHParameterInterface
   bool do_getReachReadout{false};
   bool zero_bfield{false};
   bool m_use_PDG_gas_params{false};
+  bool m_batched_drift{false};
+
+  unsigned int m_drift_batch_size{2000};
+  unsigned int m_seed{0};
 
   std::unique_ptr<TrkrHitSetContainer> temp_hitsetcontainer;
   std::unique_ptr<TrkrHitSetContainer> single_hitsetcontainer;
   std::unique_ptr<PHG4TpcPadPlane> padplane;
   std::unique_ptr<PHG4TpcDistortion> m_distortionMap;
+  std::unique_ptr<PHG4TpcDriftBatch> m_driftBatch;
   std::unique_ptr<TFile> m_outf;
   std::unique_ptr<TFile> EDrift_outf;
 
@@ -0,0 +1,429 @@
+/**
+ * @file g4tpc/PHG4TpcElectronDriftBenchmark.cc
+ * @brief compare the batched electron drift with the electron by electron drift of PHG4TpcElectronDrift
+ *
+ * usage: PHG4TpcElectronDriftBenchmark [events] [max threads]
+ *
+ * PHG4TpcElectronDrift needs the full tracking geometry, so the two drifts are run here
+ * on g4hits already in TPC envelope coordinates, with the default drift parameters and
+ * no distortions. Hits are spread over the whole TPC, in radius beyond the acceptance
+ * and in time beyond the readout window. The electron by electron drift is the loop of
+ * PHG4TpcElectronDrift::process_event, with the same gsl generator and the same draws.
+ * The batched drift is PHG4TpcDriftBatch, as used with set_batched_drift(true).
+ *
+ * Both drifts use other random numbers, so they are compared statistically:
+ * - the fraction of electrons out of time, out of acceptance and accepted
+ * - the transverse diffusion, as the squared displacement over its expected variance
+ * - the drift time, as the time residual over its expected width (mean and rms)
+ * Differences must be within 5 standard deviations.
+ * The batched drift must also be identical for 1, 2, 4 ... up to max threads, and when
+ * the hits of an event are split in several batches.
+ */
+#include "PHG4TpcDriftBatch.h"
+
+#include <fun4all/Fun4AllServer.h>
+
+#include <gsl/gsl_randist.h>
+#include <gsl/gsl_rng.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+  template <class T>
+  constexpr T square(const T& x)
+  {
+    return x * x;
+  }
+
+  // note : units are cm and ns
+  struct G4Hit
+  {
+    uint64_t key = 0;
+    std::array<double, 3> entry = {};
+    std::array<double, 3> exit = {};
+    double t_entry = 0;
+    double t_exit = 0;
+    unsigned int n_electrons = 0;
+  };
+
+  struct Electron
+  {
+    PHG4TpcDriftBatch::Status status = PHG4TpcDriftBatch::Accepted;
+    double z_start = 0;
+    double t_start = 0;
+
+    // only set for electrons in time
+    double x_final = std::numeric_limits<double>::quiet_NaN();
+    double y_final = std::numeric_limits<double>::quiet_NaN();
+    double t_final = 0;
+  };
+
+  // default PHG4TpcElectronDrift parameters and TPC geometry, with the smearing used in older productions
+  PHG4TpcDriftBatch::Parameters make_parameters(bool smear)
+  {
+    constexpr double max_drift_length = 102.325;
+    constexpr double cm_halfwidth = 0.28;
+    constexpr double extended_readout_time = 0;
+
+    PHG4TpcDriftBatch::Parameters parameters;
+    parameters.diffusion_trans = 0.005313;
+    parameters.diffusion_long = 0.014596;
+    parameters.added_smear_sigma_trans = smear ? 0.085 : 0;
+    parameters.added_smear_sigma_long = smear ? 0.105 : 0;
+    parameters.tpc_length = 2 * (max_drift_length + cm_halfwidth);
+    parameters.drift_velocity = 0.008;
+    parameters.min_time = 0;
+    parameters.max_time = max_drift_length / parameters.drift_velocity + extended_readout_time;
+    parameters.min_active_radius = 30;
+    parameters.max_active_radius = 78;
+    parameters.threshold_reaches_readout = 0.5;
+    return parameters;
+  }
+
+  // g4hits of about a cm, uniform in the TPC volume and extending beyond the acceptance, with about 30 electrons each
+  std::vector<G4Hit> make_hits(std::mt19937_64& rng, int n_hits)
+  {
+    std::uniform_real_distribution<double> radius(25, 82);
+    std::uniform_real_distribution<double> phi(-M_PI, M_PI);
+    std::uniform_real_distribution<double> z(-102, 102);
+    std::uniform_real_distribution<double> time(0, 2000);
+    std::uniform_real_distribution<double> step(-0.5, 0.5);
+    std::poisson_distribution<unsigned int> electrons(30);
+
+    std::vector<G4Hit> hits(n_hits);
+    uint64_t key = 0;
+    for (auto& hit : hits)
+    {
+      const double r = radius(rng);
+      const double p = phi(rng);
+      hit.key = key++;
+      hit.entry = {r * std::cos(p), r * std::sin(p), z(rng)};
+      hit.exit = {hit.entry[0] + step(rng), hit.entry[1] + step(rng), hit.entry[2] + step(rng)};
+      hit.t_entry = time(rng);
+      hit.t_exit = hit.t_entry + 0.1;
+      hit.n_electrons = electrons(rng);
+    }
+    return hits;
+  }
+
+  // same loop as the electron by electron drift of PHG4TpcElectronDrift::process_event
+  std::vector<Electron> drift_electron_by_electron(gsl_rng* rng, const PHG4TpcDriftBatch::Parameters& parameters, const std::vector<G4Hit>& hits)
+  {
+    const double tpc_length = parameters.tpc_length;
+    const double velocity = parameters.drift_velocity;
+
+    std::vector<Electron> electrons;
+    for (const auto& hit : hits)
+    {
+      for (unsigned int i = 0; i < hit.n_electrons; ++i)
+      {
+        Electron electron;
+        const double f = gsl_ran_flat(rng, 0.0, 1.0);
+        const double x_start = hit.entry[0] + f * (hit.exit[0] - hit.entry[0]);
+        const double y_start = hit.entry[1] + f * (hit.exit[1] - hit.entry[1]);
+        electron.z_start = hit.entry[2] + f * (hit.exit[2] - hit.entry[2]);
+        electron.t_start = hit.t_entry + f * (hit.t_exit - hit.t_entry);
+
+        const double r_sigma = parameters.diffusion_trans * std::sqrt(tpc_length / 2. - std::abs(electron.z_start));
+        const double rantrans =
+            gsl_ran_gaussian(rng, r_sigma) +
+            gsl_ran_gaussian(rng, parameters.added_smear_sigma_trans);
+
+        const double t_path = (tpc_length / 2. - std::abs(electron.z_start)) / velocity;
+        const double t_sigma = parameters.diffusion_long * std::sqrt(tpc_length / 2. - std::abs(electron.z_start)) / velocity;
+        const double rantime =
+            gsl_ran_gaussian(rng, t_sigma) +
+            gsl_ran_gaussian(rng, parameters.added_smear_sigma_long) / velocity;
+        electron.t_final = electron.t_start + t_path + rantime;
+
+        if (electron.t_final < parameters.min_time || electron.t_final > parameters.max_time)
+        {
+          electron.status = PHG4TpcDriftBatch::OutOfTime;
+          electrons.push_back(electron);
+          continue;
+        }
+
+        const double ranphi = gsl_ran_flat(rng, -M_PI, M_PI);
+        electron.x_final = x_start + rantrans * std::cos(ranphi);
+        electron.y_final = y_start + rantrans * std::sin(ranphi);
+
+        const double rad_final = std::sqrt(square(electron.x_final) + square(electron.y_final));
+        if (rad_final < parameters.min_active_radius - 2.0 || rad_final > parameters.max_active_radius + 1.0)
+        {
+          electron.status = PHG4TpcDriftBatch::OutOfAcceptance;
+        }
+        electrons.push_back(electron);
+      }
+    }
+    return electrons;
+  }
+
+  void add_hits(PHG4TpcDriftBatch& batch, const std::vector<G4Hit>& hits, std::size_t begin, std::size_t end)
+  {
+    for (std::size_t i = begin; i < end; ++i)
+    {
+      const auto& hit = hits[i];
+      batch.add_hit(hit.key, hit.entry, hit.exit, hit.t_entry, hit.t_exit, hit.n_electrons);
+    }
+  }
+
+  void append_electrons(const PHG4TpcDriftBatch& batch, std::vector<Electron>& electrons)
+  {
+    for (std::size_t hit = 0; hit < batch.n_hits(); ++hit)
+    {
+      for (std::size_t i = batch.begin(hit); i < batch.end(hit); ++i)
+      {
+        Electron electron;
+        electron.status = batch.status(i);
+        electron.z_start = batch.z_start(i);
+        electron.t_start = batch.t_start(i);
+        electron.t_final = batch.t_final(i);
+        if (electron.status != PHG4TpcDriftBatch::OutOfTime)
+        {
+          electron.x_final = batch.x_final(i);
+          electron.y_final = batch.y_final(i);
+        }
+        electrons.push_back(electron);
+      }
+    }
+  }
+
+  // batched drift of all hits of an event, in batches of batch_size hits
+  std::vector<Electron> drift_batched(PHG4TpcDriftBatch& batch, int event, const std::vector<G4Hit>& hits, std::size_t batch_size)
+  {
+    std::vector<Electron> electrons;
+    for (std::size_t begin = 0; begin < hits.size(); begin += batch_size)
+    {
+      batch.clear();
+      add_hits(batch, hits, begin, std::min(begin + batch_size, hits.size()));
+      batch.drift(event);
+      append_electrons(batch, electrons);
+    }
+    return electrons;
+  }
+
+  bool identical(const std::vector<Electron>& first, const std::vector<Electron>& second)
+  {
+    if (first.size() != second.size())
+    {
+      return false;
+    }
+    for (std::size_t i = 0; i < first.size(); ++i)
+    {
+      const auto& a = first[i];
+      const auto& b = second[i];
+      if (a.status != b.status || a.z_start != b.z_start || a.t_start != b.t_start || a.t_final != b.t_final)
+      {
+        return false;
+      }
+      if (a.status != PHG4TpcDriftBatch::OutOfTime && (a.x_final != b.x_final || a.y_final != b.y_final))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // running mean and rms
+  class Moments
+  {
+   public:
+    void fill(double value)
+    {
+      ++m_n;
+      m_sum += value;
+      m_sum2 += value * value;
+    }
+    double n() const { return m_n; }
+    double mean() const { return m_n ? m_sum / m_n : 0; }
+    double rms() const { return m_n ? std::sqrt(std::max(0., m_sum2 / m_n - square(mean()))) : 0; }
+    double mean_error() const { return m_n ? rms() / std::sqrt(m_n) : 0; }
+    double rms_error() const { return m_n ? rms() / std::sqrt(2 * m_n) : 0; }
+
+   private:
+    double m_n = 0;
+    double m_sum = 0;
+    double m_sum2 = 0;
+  };
+
+  struct Distributions
+  {
+    //! electrons per status
+    std::array<double, 4> status = {};
+    double n_electrons = 0;
+
+    //! squared transverse displacement over its variance, expected mean is 1
+    Moments diffusion;
+
+    //! time residual over its expected width, expected mean is 0 and rms is 1
+    Moments time;
+
+    double fraction(unsigned int i) const { return n_electrons ? status[i] / n_electrons : 0; }
+    double fraction_error(unsigned int i) const { return n_electrons ? std::sqrt(fraction(i) * (1 - fraction(i)) / n_electrons) : 0; }
+  };
+
+  void fill(Distributions& distributions, const PHG4TpcDriftBatch::Parameters& parameters, const std::vector<G4Hit>& hits, const std::vector<Electron>& electrons)
+  {
+    // electrons are in hit order. The transverse start point is recomputed from the hit and the start time
+    std::size_t i = 0;
+    for (const auto& hit : hits)
+    {
+      for (unsigned int ielectron = 0; ielectron < hit.n_electrons; ++ielectron, ++i)
+      {
+        const auto& electron = electrons[i];
+        const double drift_length = parameters.tpc_length / 2. - std::abs(electron.z_start);
+        const double sigma_time = std::sqrt(square(parameters.diffusion_long / parameters.drift_velocity) * drift_length + square(parameters.added_smear_sigma_long / parameters.drift_velocity));
+        distributions.time.fill((electron.t_final - electron.t_start - drift_length / parameters.drift_velocity) / sigma_time);
+
+        ++distributions.n_electrons;
+        ++distributions.status[electron.status];
+        if (electron.status == PHG4TpcDriftBatch::OutOfTime)
+        {
+          continue;
+        }
+
+        // fraction along the hit, from the drift time start
+        const double f = (hit.t_exit > hit.t_entry) ? (electron.t_start - hit.t_entry) / (hit.t_exit - hit.t_entry) : 0;
+        const double x_start = hit.entry[0] + f * (hit.exit[0] - hit.entry[0]);
+        const double y_start = hit.entry[1] + f * (hit.exit[1] - hit.entry[1]);
+        const double sigma2_trans = square(parameters.diffusion_trans) * drift_length + square(parameters.added_smear_sigma_trans);
+        distributions.diffusion.fill((square(electron.x_final - x_start) + square(electron.y_final - y_start)) / sigma2_trans);
+      }
+    }
+  }
+
+  // number of standard deviations between two values
+  double pull(double a, double a_error, double b, double b_error)
+  {
+    const double error = std::sqrt(square(a_error) + square(b_error));
+    return error > 0 ? std::abs(a - b) / error : (a == b ? 0 : std::numeric_limits<double>::infinity());
+  }
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  const int nevents = (argc > 1) ? std::stoi(argv[1]) : 5;
+  const unsigned int max_threads = (argc > 2) ? std::stoul(argv[2]) : std::max(1U, std::thread::hardware_concurrency());
+  constexpr int n_hits = 20000;
+  constexpr unsigned int seed = 12345;
+  constexpr double max_pull = 5;
+
+  // 2, 4 ... up to max threads
+  std::vector<unsigned int> thread_counts;
+  for (unsigned int nthreads = 2; nthreads < max_threads; nthreads *= 2)
+  {
+    thread_counts.push_back(nthreads);
+  }
+  if (max_threads > 1)
+  {
+    thread_counts.push_back(max_threads);
+  }
+
+  Fun4AllServer* se = Fun4AllServer::instance();
+
+  std::cout << "PHG4TpcElectronDriftBenchmark - " << nevents << " events of " << n_hits << " g4hits per configuration, times in ms per event" << std::endl;
+
+  bool success = true;
+  for (const bool smear : {false, true})
+  {
+    const auto parameters = make_parameters(smear);
+    const std::string configuration = smear ? "added smearing" : "diffusion only";
+
+    std::unique_ptr<gsl_rng, decltype(&gsl_rng_free)> gsl(gsl_rng_alloc(gsl_rng_mt19937), &gsl_rng_free);
+    gsl_rng_set(gsl.get(), seed);
+
+    PHG4TpcDriftBatch batch;
+    batch.set_parameters(parameters);
+    batch.set_seed(seed);
+
+    Distributions reference;
+    Distributions batched;
+    double reference_time = 0;
+    double batched_time = 0;
+    double parallel_time = 0;
+    std::mt19937_64 rng(seed);
+    for (int event = 0; event < nevents; ++event)
+    {
+      const auto hits = make_hits(rng, n_hits);
+
+      auto start = std::chrono::high_resolution_clock::now();
+      const auto reference_electrons = drift_electron_by_electron(gsl.get(), parameters, hits);
+      reference_time += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+      fill(reference, parameters, hits, reference_electrons);
+
+      // batched drift, one thread then more, with all hits in one batch, then in batches of 2000 hits as in PHG4TpcElectronDrift
+      se->SetNumThreads(1);
+      start = std::chrono::high_resolution_clock::now();
+      const auto batched_electrons = drift_batched(batch, event, hits, hits.size());
+      batched_time += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+      fill(batched, parameters, hits, batched_electrons);
+
+      for (const unsigned int nthreads : thread_counts)
+      {
+        se->SetNumThreads(nthreads);
+        start = std::chrono::high_resolution_clock::now();
+        const auto electrons = drift_batched(batch, event, hits, hits.size());
+        if (nthreads == max_threads)
+        {
+          parallel_time += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        }
+        if (!identical(electrons, batched_electrons))
+        {
+          std::cout << "PHG4TpcElectronDriftBenchmark - " << configuration << ", event " << event << ": " << nthreads << " threads output differs from 1 thread" << std::endl;
+          success = false;
+        }
+      }
+
+      if (!identical(drift_batched(batch, event, hits, 2000), batched_electrons))
+      {
+        std::cout << "PHG4TpcElectronDriftBenchmark - " << configuration << ", event " << event << ": output depends on the batch size" << std::endl;
+        success = false;
+      }
+    }
+
+    std::cout << configuration << " - electron by electron: " << reference_time / nevents
+              << " batched: " << batched_time / nevents << " batched, " << max_threads << " threads: " << parallel_time / nevents << std::endl;
+
+    // distributions
+    const auto compare = [&](const std::string& what, double a, double a_error, double b, double b_error)
+    {
+      const double difference = pull(a, a_error, b, b_error);
+      std::cout << "  " << what << " electron by electron: " << a << " batched: " << b << " (" << difference << " sigma)" << std::endl;
+      if (difference > max_pull)
+      {
+        std::cout << "PHG4TpcElectronDriftBenchmark - " << configuration << ": " << what << " differs" << std::endl;
+        success = false;
+      }
+    };
+    const std::array<std::string, 4> status_names = {"accepted fraction", "out of time fraction", "not reaching readout fraction", "out of acceptance fraction"};
+    for (unsigned int i = 0; i < status_names.size(); ++i)
+    {
+      compare(status_names[i], reference.fraction(i), reference.fraction_error(i), batched.fraction(i), batched.fraction_error(i));
+    }
+    compare("transverse diffusion", reference.diffusion.mean(), reference.diffusion.mean_error(), batched.diffusion.mean(), batched.diffusion.mean_error());
+    compare("time residual mean", reference.time.mean(), reference.time.mean_error(), batched.time.mean(), batched.time.mean_error());
+    compare("time residual rms", reference.time.rms(), reference.time.rms_error(), batched.time.rms(), batched.time.rms_error());
+  }
+
+  delete se;
+
+  if (!success)
+  {
+    std::cout << "PHG4TpcElectronDriftBenchmark - batched and electron by electron drifts differ" << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -11,6 +11,7 @@
 #include <g4main/PHG4DisplayAction.h>  // for PHG4DisplayAction
 #include <g4main/PHG4HitContainer.h>
 #include <g4main/PHG4SteppingAction.h>
+#include <g4main/PHG4WorkerEventAction.h>
 
 #include <phool/PHCompositeNode.h>
 #include <phool/PHIODataNode.h>
@@ -84,6 +85,17 @@ int PHG4TpcEndCapSubsystem::InitRunSubsystem(PHCompositeNode *topNode)
   }
   return 0;
 }
+//_______________________________________________________________________
+void PHG4TpcEndCapSubsystem::CreateWorkerActions(PHG4WorkerEventAction *worker)
+{
+  if (GetParams()->get_int_param("active"))
+  {
+    auto *action = new PHG4TpcEndCapSteppingAction(m_Detector, GetParams());
+    action->SetHitNodeName("G4HIT", m_HitNodeName);
+    worker->AddSteppingAction(action);
+  }
+}
+
 //_______________________________________________________________________
 int PHG4TpcEndCapSubsystem::process_event(PHCompositeNode *topNode)
 {
@@ -12,6 +12,7 @@ class PHG4Detector;
 class PHG4TpcEndCapDetector;
 class PHG4SteppingAction;
 class PHG4DisplayAction;
+class PHG4WorkerEventAction;
 
 /**
  * \brief Detector Subsystem module
@@ -48,6 +49,11 @@ class PHG4TpcEndCapSubsystem : public PHG4DetectorSubsystem
   PHG4Detector* GetDetector() const override;
 
   PHG4SteppingAction* GetSteppingAction() const override { return m_SteppingAction; }
+
+  //! multithreading support, each worker thread gets its own stepping action
+  bool SupportsMultiThreading() const override { return true; }
+  void CreateWorkerActions(PHG4WorkerEventAction* worker) override;
+
   //! Print info (from SubsysReco)
   void Print(const std::string& what = "ALL") const override;
 
@@ -70,6 +70,12 @@ namespace
     return std::exp(-square(x / sigma) / 2) / (sigma * std::sqrt(2 * M_PI));
   }
 
+  //! charge fraction on a pad of triangular response from -pitch to +pitch, for a gaussian cloud of width sigma at x_loc from the pad center
+  inline double pad_overlap(const double x_loc, const double pitch, const double sigma)
+  {
+    return (pitch - x_loc) * (std::erf(x_loc / (M_SQRT2 * sigma)) - std::erf((x_loc - pitch) / (M_SQRT2 * sigma))) / (pitch * 2) + (pitch + x_loc) * (std::erf((x_loc + pitch) / (M_SQRT2 * sigma)) - std::erf(x_loc / (M_SQRT2 * sigma))) / (pitch * 2) + (gaus(x_loc - pitch, sigma) - gaus(x_loc, sigma)) * square(sigma) / pitch + (gaus(x_loc + pitch, sigma) - gaus(x_loc, sigma)) * square(sigma) / pitch;
+  }
+
   constexpr unsigned int print_layer = 18;
 
 }  // namespace
@@ -210,6 +216,10 @@ int PHG4TpcPadPlaneReadout::InitRun(PHCompositeNode *topNode)
       }
     }
   }
+  if (m_useResponseTables)
+  {
+    makeResponseTables();
+  }
   if (m_maskDeadChannels)
   {
     makeChannelMask(m_deadChannelMap, m_deadChannelMapName, "TotalDeadChannels");
@@ -402,83 +412,91 @@ void PHG4TpcPadPlaneReadout::MapToPadPlane(
   // amplify the single electron in the gem stack
   //===============================
 
-  double nelec = getSingleEGEMAmplification();
   // Applying weight with respect to the rad_gem and phi after electrons are redistributed
   double phi_gain = phi;
   if (phi < 0)
   {
     phi_gain += 2 * M_PI;
   }
-  double gain_weight = 1.0;
-  if (m_flagToUseGain == 1)
+  double nelec = 0;
+  if (m_useResponseTables)
   {
-    gain_weight = h_gain[side]->GetBinContent(h_gain[side]->FindBin(rad_gem * 10, phi_gain));  // rad_gem in cm -> *10 to get mm
-    nelec = nelec * gain_weight;
+    nelec = getTabulatedGEMAmplification(side, rad_gem, phi_gain);
   }
-
-  if (m_use_module_gain_weights)
+  else
   {
-    double phistep = 30.0;
-    int sector = 0;
-
-    if ((phi_gain * 180.0 / M_PI) >= 15 && (phi_gain * 180.0 / M_PI) < 345)
+    nelec = getSingleEGEMAmplification();
+    double gain_weight = 1.0;
+    if (m_flagToUseGain == 1)
     {
-      sector = 1 + (int) ((phi_gain * 180.0 / M_PI - 15) / phistep);
-    }
-    else
-    {
-      sector = 0;
+      gain_weight = h_gain[side]->GetBinContent(h_gain[side]->FindBin(rad_gem * 10, phi_gain));  // rad_gem in cm -> *10 to get mm
+      nelec = nelec * gain_weight;
     }
 
-    int this_region = -1;
-    for (int iregion = 0; iregion < 3; ++iregion)
+    if (m_use_module_gain_weights)
     {
-      if (rad_gem < MaxRadius[iregion] && rad_gem > MinRadius[iregion])
+      double phistep = 30.0;
+      int sector = 0;
+
+      if ((phi_gain * 180.0 / M_PI) >= 15 && (phi_gain * 180.0 / M_PI) < 345)
       {
-        this_region = iregion;
+        sector = 1 + (int) ((phi_gain * 180.0 / M_PI - 15) / phistep);
+      }
+      else
+      {
+        sector = 0;
       }
-    }
-    if (this_region > -1)
-    {
-      gain_weight = m_module_gain_weight[side][this_region][sector];
-    }
-    // regenerate nelec with the new distribution
-    //    double original_nelec = nelec;
-    nelec = getSingleEGEMAmplification(gain_weight);
-    //  std::cout << " side " << side << " this_region " << this_region
-    //	<<  " sector " << sector << " original nelec "
-    //	<< original_nelec << " new nelec " << nelec << std::endl;
-  }
-
-  if (m_useLangau)
-  {
-    double phistep = 30.0;
-    int sector = 0;
 
-    if ((phi_gain * 180.0 / M_PI) >= 15 && (phi_gain * 180.0 / M_PI) < 345)
-    {
-      sector = 1 + (int) ((phi_gain * 180.0 / M_PI - 15) / phistep);
-    }
-    else
-    {
-      sector = 0;
+      int this_region = -1;
+      for (int iregion = 0; iregion < 3; ++iregion)
+      {
+        if (rad_gem < MaxRadius[iregion] && rad_gem > MinRadius[iregion])
+        {
+          this_region = iregion;
+        }
+      }
+      if (this_region > -1)
+      {
+        gain_weight = m_module_gain_weight[side][this_region][sector];
+      }
+      // regenerate nelec with the new distribution
+      //    double original_nelec = nelec;
+      nelec = getSingleEGEMAmplification(gain_weight);
+      //  std::cout << " side " << side << " this_region " << this_region
+      //	<<  " sector " << sector << " original nelec "
+      //	<< original_nelec << " new nelec " << nelec << std::endl;
     }
 
-    int this_region = -1;
-    for (int iregion = 0; iregion < 3; ++iregion)
+    if (m_useLangau)
     {
-      if (rad_gem < MaxRadius[iregion] && rad_gem > MinRadius[iregion])
+      double phistep = 30.0;
+      int sector = 0;
+
+      if ((phi_gain * 180.0 / M_PI) >= 15 && (phi_gain * 180.0 / M_PI) < 345)
       {
-        this_region = iregion;
+        sector = 1 + (int) ((phi_gain * 180.0 / M_PI - 15) / phistep);
+      }
+      else
+      {
+        sector = 0;
+      }
+
+      int this_region = -1;
+      for (int iregion = 0; iregion < 3; ++iregion)
+      {
+        if (rad_gem < MaxRadius[iregion] && rad_gem > MinRadius[iregion])
+        {
+          this_region = iregion;
+        }
+      }
+      if (this_region > -1)
+      {
+        nelec = getSingleEGEMAmplification(flangau[side][this_region][sector]);
+      }
+      else
+      {
+        nelec = getSingleEGEMAmplification();
       }
-    }
-    if (this_region > -1)
-    {
-      nelec = getSingleEGEMAmplification(flangau[side][this_region][sector]);
-    }
-    else
-    {
-      nelec = getSingleEGEMAmplification();
     }
   }
 
@@ -498,8 +516,10 @@ void PHG4TpcPadPlaneReadout::MapToPadPlane(
               << std::endl;
   }
 
-  std::vector<int> pad_phibin;
-  std::vector<double> pad_phibin_share;
+  auto &pad_phibin = m_pad_phibin;
+  auto &pad_phibin_share = m_pad_phibin_share;
+  pad_phibin.clear();
+  pad_phibin_share.clear();
 
   populate_zigzag_phibins(side, layernum, phi, sigmaT, pad_phibin, pad_phibin_share);
   /* if (pad_phibin.size() == 0) { */
@@ -528,8 +548,10 @@ void PHG4TpcPadPlaneReadout::MapToPadPlane(
 		<< " with t_gem " << t_gem << " SAMPA peaking time  " << Ts << std::endl;
     }
 
-  std::vector<int> adc_tbin;
-  std::vector<double> adc_tbin_share;
+  auto &adc_tbin = m_adc_tbin;
+  auto &adc_tbin_share = m_adc_tbin_share;
+  adc_tbin.clear();
+  adc_tbin_share.clear();
   sampaTimeDistribution(t_gem, adc_tbin, adc_tbin_share);
 
   /* if (adc_tbin.size() == 0)  { */
@@ -620,9 +642,19 @@ void PHG4TpcPadPlaneReadout::MapToPadPlane(
       unsigned int pads_per_sector = phibins / 12;
       unsigned int sector = pad_num / pads_per_sector;
       TrkrDefs::hitsetkey hitsetkey = TpcDefs::genHitSetKey(layernum, sector, side);
-      // Use existing hitset or add new one if needed
-      TrkrHitSetContainer::Iterator hitsetit = hitsetcontainer->findOrAddHitSet(hitsetkey);
-      TrkrHitSetContainer::Iterator single_hitsetit = single_hitsetcontainer->findOrAddHitSet(hitsetkey);
+      // Use existing hitset or add new one if needed. When accumulating, this is done once per g4hit by moduleBuffer
+      TrkrHitSetContainer::Iterator hitsetit;
+      TrkrHitSetContainer::Iterator single_hitsetit;
+      ModuleBuffer *buffer = nullptr;
+      if (m_accumulateHits)
+      {
+        buffer = &moduleBuffer(single_hitsetcontainer, hitsetcontainer, hitsetkey, pads_per_sector, sector, tbins);
+      }
+      else
+      {
+        hitsetit = hitsetcontainer->findOrAddHitSet(hitsetkey);
+        single_hitsetit = single_hitsetcontainer->findOrAddHitSet(hitsetkey);
+      }
       TrkrDefs::hitkey hitkey;
 
       if (m_maskDeadChannels)
@@ -643,6 +675,21 @@ void PHG4TpcPadPlaneReadout::MapToPadPlane(
           continue;
         }
       }
+      if (buffer)
+      {
+        // same ADC count as TrkrHitv2::addEnergy, summed over the electrons of the g4hit
+        const double ein = neffelectrons * TrkrDefs::EdepScaleFactor;
+        const unsigned int cell = ((unsigned int) pad_num - buffer->first_pad) * buffer->ntbins + (unsigned int) tbin_num;
+        if (buffer->adc[cell] == 0)
+        {
+          // hits are created even when nothing is added to them
+          buffer->cells.push_back(cell);
+          buffer->adc[cell] = 1;
+        }
+        buffer->adc[cell] += (ein < USHRT_MAX) ? (unsigned short) (ein) : USHRT_MAX;
+        continue;
+      }
+
       // generate the key for this hit, requires tbin and phibin
       hitkey = TpcDefs::genHitKey((unsigned int) pad_num, (unsigned int) tbin_num);
 
@@ -653,7 +700,7 @@ void PHG4TpcPadPlaneReadout::MapToPadPlane(
       {
         // create a new one
         hit = new TrkrHitv2();
-        hitsetit->second->addHitSpecificKey(hitkey, hit);
+        hit = hitsetit->second->addHitSpecificKey(hitkey, hit)->second;
       }
       // Either way, add the energy to it  -- adc values will be added at digitization
       hit->addEnergy(neffelectrons);
@@ -668,7 +715,7 @@ void PHG4TpcPadPlaneReadout::MapToPadPlane(
       {
         // create a new one
         single_hit = new TrkrHitv2();
-        single_hitsetit->second->addHitSpecificKey(hitkey, single_hit);
+        single_hit = single_hitsetit->second->addHitSpecificKey(hitkey, single_hit)->second;
       }
       // Either way, add the energy to it  -- adc values will be added at digitization
       single_hit->addEnergy(neffelectrons);
@@ -896,8 +943,7 @@ void PHG4TpcPadPlaneReadout::populate_zigzag_phibins(const unsigned int side, co
     this corresponds to integrating the charge distribution Gaussian function (centered on rphi and of width cloud_sig_rp),
     convoluted with a strip response function, which is triangular from -pitch to +pitch, with a maximum of 1. at stript center
     */
-    overlap[ipad] =
-        (pitch - x_loc) * (std::erf(x_loc / (M_SQRT2 * sigma)) - std::erf((x_loc - pitch) / (M_SQRT2 * sigma))) / (pitch * 2) + (pitch + x_loc) * (std::erf((x_loc + pitch) / (M_SQRT2 * sigma)) - std::erf(x_loc / (M_SQRT2 * sigma))) / (pitch * 2) + (gaus(x_loc - pitch, sigma) - gaus(x_loc, sigma)) * square(sigma) / pitch + (gaus(x_loc + pitch, sigma) - gaus(x_loc, sigma)) * square(sigma) / pitch;
+    overlap[ipad] = m_useResponseTables ? m_padResponse[layernum](x_loc) : pad_overlap(x_loc, pitch, sigma);
   }
 
   // now we have the overlap for each pad
@@ -1034,12 +1080,29 @@ void PHG4TpcPadPlaneReadout::sampaTimeDistribution(double tzero,  std::vector<in
 {
   // tzero is the arrival time of the electron at the GEM
   // Ts is the sampa peaking time
-  // Assume the response is over after 8 clock cycles (400 ns)
-  int nclocks = 8;
+  int nclocks = NSampaClocks;
 
   double tstepsize = LayerGeom->get_zstep();
   int tbinzero = LayerGeom->get_zbin(tzero);
 
+  if (m_useResponseTables)
+  {
+    const double delta = tzero - (LayerGeom->get_zcenter(tbinzero) - tstepsize / 2.0);
+    adc_tbin.push_back(tbinzero);
+    adc_tbin_share.push_back(m_timeResponse[0](delta));
+    for (int iclock = 1; iclock < nclocks; ++iclock)
+    {
+      const int tbin = tbinzero + iclock;
+      if (tbin < 0 || tbin > LayerGeom->get_zbins())
+      {
+        continue;
+      }
+      adc_tbin.push_back(tbin);
+      adc_tbin_share.push_back(m_timeResponse[iclock](delta));
+    }
+    return;
+  }
+
   // the first clock bin is a special case
   double tfirst_end = LayerGeom->get_zcenter(tbinzero) + tstepsize/2.0;
   double vfirst_end =  sampaShapingResponseFunction(tzero, tfirst_end); 
@@ -1103,3 +1166,222 @@ double PHG4TpcPadPlaneReadout::sampaShapingResponseFunction(double tzero, double
 
     return v;
   }
+
+double PHG4TpcPadPlaneReadout::sampaClockIntegral(double delta, int iclock) const
+{
+  // same integration as sampaTimeDistribution, with times relative to the electron arrival
+  const double tstepsize = GeomContainer->GetLayerCellGeom(20)->get_zstep();
+  if (iclock == 0)
+  {
+    // the first clock bin is a special case
+    const double tfirst_end = tstepsize - delta;
+    return (sampaShapingResponseFunction(0, tfirst_end) / 2.0) * tfirst_end;
+  }
+
+  const int nsamples = 6;
+  const double sample_step = tstepsize / (double) nsamples;
+  const double tlow = iclock * tstepsize - delta;
+  double sintegral = 0;
+  for (int isample = 0; isample < nsamples; ++isample)
+  {
+    const double tnow = tlow + (double) isample * sample_step + sample_step / 2.0;
+    sintegral += sampaShapingResponseFunction(0, tnow) * sample_step;
+  }
+  return sintegral;
+}
+
+void PHG4TpcPadPlaneReadout::makeResponseTables()
+{
+  // pad response, per layer since the pad pitch depends on the radius. It is symmetric and negligible beyond the pad pitch plus _nsigmas
+  static constexpr unsigned int npad_points = 1024;
+  m_padResponse.clear();
+  const auto layerrange = GeomContainer->get_begin_end();
+  for (auto layeriter = layerrange.first; layeriter != layerrange.second; ++layeriter)
+  {
+    const auto *layergeom = layeriter->second;
+    const double pitch = layergeom->get_phistep() * layergeom->get_radius();
+    const double sigma = sigmaT;
+    const double xmax = pitch + _nsigmas * sigma;
+    const PHG4TpcResponseTable table(-xmax, xmax, 2 * npad_points + 1, [pitch, sigma](double x_loc)
+                                     { return pad_overlap(x_loc, pitch, sigma); });
+
+    const auto layer = static_cast<std::size_t>(layergeom->get_layer());
+    if (m_padResponse.size() <= layer)
+    {
+      m_padResponse.resize(layer + 1);
+    }
+    m_padResponse[layer] = table;
+  }
+
+  // SAMPA response per clock, versus the electron arrival time in its time bin. The time geometry is the same for all layers.
+  // Arrival times just outside of the bin, from rounding, get the response at the bin edge
+  static constexpr unsigned int ntime_points = 512;
+  const double tstepsize = GeomContainer->GetLayerCellGeom(20)->get_zstep();
+  for (int iclock = 0; iclock < NSampaClocks; ++iclock)
+  {
+    m_timeResponse[iclock] = PHG4TpcResponseTable(0, tstepsize, ntime_points, [this, iclock](double delta)
+                                                  { return sampaClockIntegral(delta, iclock); }, PHG4TpcResponseTable::Clamp);
+  }
+
+  // Polya distribution of unit mean, the tail beyond 30 is negligible
+  const double theta = polyaTheta;
+  m_polyaSampler = PHG4TpcInverseCdfSampler(0, 30, 30000, [theta](double y)
+                                            { return std::pow((1 + theta) * y, theta) * std::exp(-(1 + theta) * y); });
+
+  if (m_useLangau)
+  {
+    for (int side = 0; side < 2; ++side)
+    {
+      for (int region = 0; region < 3; ++region)
+      {
+        for (int sector = 0; sector < 12; ++sector)
+        {
+          TF1 *f = flangau[side][region][sector];
+          m_langauSampler[side][region][sector] = PHG4TpcInverseCdfSampler(0, 5000, 1000, [f](double x)
+                                                                          { return f->Eval(x); });
+        }
+      }
+    }
+  }
+
+  if (Verbosity())
+  {
+    std::cout << "PHG4TpcPadPlaneReadout::makeResponseTables - pad response for " << std::distance(layerrange.first, layerrange.second)
+              << " layers, " << NSampaClocks << " SAMPA clocks" << std::endl;
+  }
+}
+
+double PHG4TpcPadPlaneReadout::getTabulatedGEMAmplification(const double q_bar)
+{
+  if (!m_usePolya)
+  {
+    return gsl_ran_exponential(RandomGenerator, q_bar);
+  }
+
+  // same truncation at 5000 electrons as the sampled Polya distribution
+  const double u = gsl_rng_uniform(RandomGenerator) * m_polyaSampler.cdf(5000 / q_bar);
+  return q_bar * m_polyaSampler.quantile(u);
+}
+
+double PHG4TpcPadPlaneReadout::getTabulatedGEMAmplification(const unsigned int side, const double rad_gem, const double phi_gain)
+{
+  const double phistep = 30.0;
+  int sector = 0;
+  if ((phi_gain * 180.0 / M_PI) >= 15 && (phi_gain * 180.0 / M_PI) < 345)
+  {
+    sector = 1 + (int) ((phi_gain * 180.0 / M_PI - 15) / phistep);
+  }
+
+  int this_region = -1;
+  for (int iregion = 0; iregion < 3; ++iregion)
+  {
+    if (rad_gem < MaxRadius[iregion] && rad_gem > MinRadius[iregion])
+    {
+      this_region = iregion;
+    }
+  }
+
+  // the Langau gain replaces all others
+  if (m_useLangau)
+  {
+    if (this_region > -1)
+    {
+      return m_langauSampler[side][this_region][sector].quantile(gsl_rng_uniform(RandomGenerator));
+    }
+    return getTabulatedGEMAmplification(averageGEMGain);
+  }
+
+  double gain_weight = 1.0;
+  if (m_flagToUseGain == 1)
+  {
+    gain_weight = h_gain[side]->GetBinContent(h_gain[side]->FindBin(rad_gem * 10, phi_gain));  // rad_gem in cm -> *10 to get mm
+  }
+
+  // module weights change the mean of the distribution, instead of scaling the sampled gain
+  if (m_use_module_gain_weights)
+  {
+    if (this_region > -1)
+    {
+      gain_weight = m_module_gain_weight[side][this_region][sector];
+    }
+    return getTabulatedGEMAmplification(averageGEMGain * gain_weight);
+  }
+
+  return getTabulatedGEMAmplification(averageGEMGain) * gain_weight;
+}
+
+PHG4TpcPadPlaneReadout::ModuleBuffer &PHG4TpcPadPlaneReadout::moduleBuffer(TrkrHitSetContainer *single_hitsetcontainer, TrkrHitSetContainer *hitsetcontainer, TrkrDefs::hitsetkey hitsetkey, unsigned int pads_per_sector, unsigned int sector, int tbins)
+{
+  // a g4hit only touches a few modules
+  for (std::size_t i = 0; i < m_usedModuleBuffers; ++i)
+  {
+    if (m_moduleBuffers[i].hitsetkey == hitsetkey)
+    {
+      return m_moduleBuffers[i];
+    }
+  }
+
+  // hitsets are created on first use, as when filling hits electron by electron
+  hitsetcontainer->findOrAddHitSet(hitsetkey);
+  single_hitsetcontainer->findOrAddHitSet(hitsetkey);
+
+  if (m_usedModuleBuffers == m_moduleBuffers.size())
+  {
+    m_moduleBuffers.emplace_back();
+  }
+  auto &buffer = m_moduleBuffers[m_usedModuleBuffers++];
+  buffer.hitsetkey = hitsetkey;
+  buffer.first_pad = sector * pads_per_sector;
+
+  // time bins go up to tbins included
+  buffer.ntbins = tbins + 1;
+  const std::size_t size = pads_per_sector * buffer.ntbins;
+  if (buffer.adc.size() < size)
+  {
+    buffer.adc.resize(size, 0);
+  }
+  return buffer;
+}
+
+void PHG4TpcPadPlaneReadout::FlushHits(TpcClusterBuilder &tpc_truth_clusterer, TrkrHitSetContainer *single_hitsetcontainer, TrkrHitSetContainer *hitsetcontainer)
+{
+  for (std::size_t i = 0; i < m_usedModuleBuffers; ++i)
+  {
+    auto &buffer = m_moduleBuffers[i];
+    TrkrHitSetContainer::Iterator hitsetit = hitsetcontainer->findOrAddHitSet(buffer.hitsetkey);
+    TrkrHitSetContainer::Iterator single_hitsetit = single_hitsetcontainer->findOrAddHitSet(buffer.hitsetkey);
+    for (const auto cell : buffer.cells)
+    {
+      const unsigned int pad_num = buffer.first_pad + cell / buffer.ntbins;
+      const unsigned int tbin_num = cell % buffer.ntbins;
+      const TrkrDefs::hitkey hitkey = TpcDefs::genHitKey(pad_num, tbin_num);
+
+      // energy that corresponds exactly to the summed ADC counts
+      const double energy = (buffer.adc[cell] - 1) / TrkrDefs::EdepScaleFactor;
+      buffer.adc[cell] = 0;
+
+      TrkrHit *hit = hitsetit->second->getHit(hitkey);
+      if (!hit)
+      {
+        hit = hitsetit->second->addHitSpecificKey(hitkey, new TrkrHitv2())->second;
+      }
+      hit->addEnergy(energy);
+
+      tpc_truth_clusterer.addhitset(buffer.hitsetkey, hitkey, energy);
+
+      TrkrHit *single_hit = single_hitsetit->second->getHit(hitkey);
+      if (!single_hit)
+      {
+        single_hit = single_hitsetit->second->addHitSpecificKey(hitkey, new TrkrHitv2())->second;
+      }
+      single_hit->addEnergy(energy);
+    }
+    buffer.cells.clear();
+  }
+  m_usedModuleBuffers = 0;
+}
+
+void PHG4TpcPadPlaneReadout::set_seed(const unsigned int iseed)
+{
+  gsl_rng_set(RandomGenerator, iseed);
+}
@@ -2,6 +2,7 @@
 #define G4TPC_PHG4TPCPADPLANEREADOUT_H
 
 #include "PHG4TpcPadPlane.h"
+#include "PHG4TpcResponseTable.h"
 #include "TpcClusterBuilder.h"
 
 #include <g4main/PHG4HitContainer.h>
@@ -11,6 +12,7 @@
 #include <array>
 #include <climits>
 #include <cmath>
+#include <cstddef>
 #include <string>  // for string
 #include <vector>
 #include <map>
@@ -43,11 +45,30 @@ class PHG4TpcPadPlaneReadout : public PHG4TpcPadPlane
   void SetUseLangauGEMGain(const int flagLangau) { m_useLangau = flagLangau; }
   void SetLangauParsFileName(const std::string &name) { m_tpc_langau_pars_file = name; }
 
+  //! random seed
+  void set_seed(const unsigned int iseed);
+
+  /*!
+   * use precomputed pad and time response tables, and tabulated inverse cumulatives
+   * for the Polya and Langau GEM gains, instead of evaluating them for each electron.
+   * Tables are built at InitRun
+   */
+  void SetUseResponseTables(const bool flag) { m_useResponseTables = flag; }
+
+  /*!
+   * accumulate the charge of all electrons of a g4hit in dense per module buffers,
+   * and create the hits once per g4hit in FlushHits(). The ADC counts are the same
+   * as with hits created electron by electron
+   */
+  void SetAccumulateHits(const bool flag) { m_accumulateHits = flag; }
+
   // otherwise warning of inconsistent overload since only one MapToPadPlane methow is overridden
   using PHG4TpcPadPlane::MapToPadPlane;
 
   void MapToPadPlane(TpcClusterBuilder &tpc_truth_clusterer, TrkrHitSetContainer *single_hitsetcontainer, TrkrHitSetContainer *hitsetcontainer, TrkrHitTruthAssoc * /*hittruthassoc*/, const double x_gem, const double y_gem, const double t_gem, const unsigned int side, PHG4HitContainer::ConstIterator hiter, TNtuple * /*ntpad*/, TNtuple * /*nthit*/) override;
 
+  void FlushHits(TpcClusterBuilder &tpc_truth_clusterer, TrkrHitSetContainer *single_hitsetcontainer, TrkrHitSetContainer *hitsetcontainer) override;
+
   void SetDefaultParameters() override;
   void UpdateInternalParameters() override;
  
@@ -77,6 +98,27 @@ class PHG4TpcPadPlaneReadout : public PHG4TpcPadPlane
 
   void makeChannelMask(hitMaskTpc& aMask, const std::string& dbName, const std::string& totalChannelsToMask);
 
+  //! integral of the SAMPA response over a clock, for an electron arriving delta after the start of its time bin
+  double sampaClockIntegral(double delta, int iclock) const;
+
+  //! build pad and time response tables and gain samplers
+  void makeResponseTables();
+
+  //! charge of the electrons of the current g4hit in one readout module, dense in pads and time bins
+  struct ModuleBuffer
+  {
+    TrkrDefs::hitsetkey hitsetkey{0};
+    unsigned int first_pad{0};
+    unsigned int ntbins{0};
+    //! ADC counts plus one, zero for cells not hit. Indexed by (pad - first_pad) * ntbins + tbin
+    std::vector<unsigned int> adc;
+    //! filled cells, in filling order
+    std::vector<unsigned int> cells;
+  };
+
+  //! buffer for a given module, created on first use in the current g4hit
+  ModuleBuffer &moduleBuffer(TrkrHitSetContainer *single_hitsetcontainer, TrkrHitSetContainer *hitsetcontainer, TrkrDefs::hitsetkey hitsetkey, unsigned int pads_per_sector, unsigned int sector, int tbins);
+
   PHG4TpcGeomContainer *GeomContainer = nullptr;
   PHG4TpcGeom *LayerGeom = nullptr;
 
@@ -108,6 +150,9 @@ class PHG4TpcPadPlaneReadout : public PHG4TpcPadPlane
 
   double Ts {55.0}; // SAMPA v5 peaking time
 
+  // Assume the SAMPA response is over after 8 clock cycles (400 ns)
+  static constexpr int NSampaClocks {8};
+
   double averageGEMGain {std::numeric_limits<double>::quiet_NaN()};
   double polyaTheta {std::numeric_limits<double>::quiet_NaN()};
 
@@ -120,6 +165,10 @@ class PHG4TpcPadPlaneReadout : public PHG4TpcPadPlane
   static double getSingleEGEMAmplification(TF1 *f);
   bool m_usePolya {false};
 
+  // gain from the tabulated distributions, with the same precedence between gain options
+  double getTabulatedGEMAmplification(const unsigned int side, const double rad_gem, const double phi_gain);
+  double getTabulatedGEMAmplification(const double q_bar);
+
   bool m_useLangau {false};
   std::string m_tpc_langau_pars_file;
 
@@ -137,6 +186,31 @@ class PHG4TpcPadPlaneReadout : public PHG4TpcPadPlane
 
   TF1 *flangau[2][3][12] {{{nullptr}}};
 
+  bool m_useResponseTables {false};
+  bool m_accumulateHits {false};
+
+  //! pad response versus distance between pad center and electron in r.phi, per layer
+  std::vector<PHG4TpcResponseTable> m_padResponse;
+
+  //! SAMPA integral per clock versus electron arrival time in its time bin
+  std::array<PHG4TpcResponseTable, NSampaClocks> m_timeResponse;
+
+  //! Polya distribution with unit mean
+  PHG4TpcInverseCdfSampler m_polyaSampler;
+
+  //! Langau distributions per side, region and sector
+  PHG4TpcInverseCdfSampler m_langauSampler[2][3][12];
+
+  //! buffers used in the current g4hit come first
+  std::vector<ModuleBuffer> m_moduleBuffers;
+  std::size_t m_usedModuleBuffers {0};
+
+  //! pad and time bins of the current electron, reused between electrons
+  std::vector<int> m_pad_phibin;
+  std::vector<double> m_pad_phibin_share;
+  std::vector<int> m_adc_tbin;
+  std::vector<double> m_adc_tbin_share;
+
   hitMaskTpc m_deadChannelMap;
   hitMaskTpc m_hotChannelMap; 
 
@@ -0,0 +1,305 @@
+/**
+ * @file g4tpc/PHG4TpcPadPlaneReadoutBenchmark.cc
+ * @brief compare the electron by electron pad plane readout with accumulated hits and response tables
+ *
+ * usage: PHG4TpcPadPlaneReadoutBenchmark [events per configuration]
+ *
+ * The TPC geometry is built with the default number of layers, pads and time bins, with
+ * evenly spaced layers. Events are made of g4hits with a few tens of electrons each, spread
+ * in radius over the layer and diffused in phi and time, as they reach the GEMs.
+ * The same electrons go through three readouts with the same seed:
+ * - the original readout, which creates hits electron by electron
+ * - a readout which accumulates the charge of each g4hit before creating hits. Hits must be identical
+ * - a readout which also uses pad and time response tables and tabulated gain distributions.
+ *   The total charge must agree within statistics, and two runs must give identical hits
+ */
+#include "PHG4TpcPadPlaneReadout.h"
+#include "TpcClusterBuilder.h"
+
+#include <g4detectors/PHG4CellDefs.h>
+#include <g4detectors/PHG4TpcGeomContainer.h>
+#include <g4detectors/PHG4TpcGeomv2.h>
+
+#include <g4main/PHG4HitContainer.h>
+#include <g4main/PHG4Hitv1.h>
+
+#include <trackbase/TrkrDefs.h>
+#include <trackbase/TrkrHit.h>
+#include <trackbase/TrkrHitSet.h>
+#include <trackbase/TrkrHitSetContainerv1.h>
+
+#include <phool/PHCompositeNode.h>
+#include <phool/PHIODataNode.h>
+#include <phool/PHObject.h>
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+  // note : units are cm and ns
+  struct Configuration
+  {
+    bool polya = false;
+    int g4hits = 1000;
+  };
+
+  struct Electron
+  {
+    double x = 0;
+    double y = 0;
+    double t = 0;
+    unsigned int side = 0;
+  };
+
+  // electrons of one g4hit
+  using G4Hit = std::vector<Electron>;
+
+  // hits of the main hitset container as (hitsetkey, hitkey, adc), in container order
+  using Result = std::vector<std::array<uint64_t, 3>>;
+
+  // default TPC parameters from PHG4TpcSubsystem and PHG4TpcPadPlaneReadout
+  constexpr std::array<double, 3> min_radius = {31.105, 41.153, 58.367};
+  constexpr std::array<double, 3> max_radius = {40.249, 57.475, 75.911};
+  constexpr std::array<int, 3> phibins = {1128, 1536, 2304};
+  constexpr std::array<double, 3> sector_phi = {0.5024, 0.5087, 0.5097};
+  constexpr int layers_per_region = 16;
+  constexpr int min_layer = 7;
+  constexpr double adc_clock = 53.326184;
+  constexpr double max_drift_length = 102.325;
+  constexpr double drift_velocity = 0.008;
+  constexpr double extended_readout_time = 24800;
+
+  PHG4TpcGeomContainer* make_geometry()
+  {
+    const int ntbins = (int) ((extended_readout_time + 2. * max_drift_length / drift_velocity) / adc_clock) + 1;
+
+    auto* container = new PHG4TpcGeomContainer;
+    for (int region = 0; region < 3; ++region)
+    {
+      // sectors are centered on the same phi on both sides
+      std::array<std::vector<double>, 2> sector_min_phi;
+      std::array<std::vector<double>, 2> sector_max_phi;
+      std::array<std::vector<double>, 2> sector_bias;
+      for (int side = 0; side < 2; ++side)
+      {
+        for (int sector = 0; sector < 12; ++sector)
+        {
+          const double center = M_PI - 2 * M_PI / 12 * (sector + 0.5);
+          sector_min_phi[side].push_back(center - sector_phi[region] / 2);
+          sector_max_phi[side].push_back(center + sector_phi[region] / 2);
+          sector_bias[side].push_back(0);
+        }
+      }
+
+      const double thickness = (max_radius[region] - min_radius[region]) / layers_per_region;
+      for (int i = 0; i < layers_per_region; ++i)
+      {
+        auto* layergeom = new PHG4TpcGeomv2;
+        layergeom->set_layer(min_layer + region * layers_per_region + i);
+        layergeom->set_thickness(thickness);
+        layergeom->set_radius(min_radius[region] + (i + 0.5) * thickness);
+        layergeom->set_binning(PHG4CellDefs::sizebinning);
+        layergeom->set_zbins(ntbins);
+        layergeom->set_zmin(0);
+        layergeom->set_zstep(adc_clock);
+        layergeom->set_phibins(phibins[region]);
+        layergeom->set_phistep(sector_phi[region] / (phibins[region] / 12));
+        layergeom->set_r_bias(sector_bias);
+        layergeom->set_phi_bias(sector_bias);
+        layergeom->set_sector_min_phi(sector_min_phi);
+        layergeom->set_sector_max_phi(sector_max_phi);
+        layergeom->set_max_driftlength(max_drift_length);
+        layergeom->set_adc_clock(adc_clock);
+        layergeom->set_extended_readout_time(extended_readout_time);
+        layergeom->set_drift_velocity_sim(drift_velocity);
+        container->AddLayerCellGeom(layergeom);
+      }
+    }
+    return container;
+  }
+
+  std::vector<G4Hit> generate(std::mt19937_64& rng, const Configuration& config)
+  {
+    std::normal_distribution<double> gauss(0, 1);
+    std::uniform_real_distribution<double> uniform(0, 1);
+    std::uniform_int_distribution<int> region_distribution(0, 2);
+    std::uniform_int_distribution<int> layer_distribution(0, layers_per_region - 1);
+    std::uniform_int_distribution<int> electron_distribution(20, 80);
+
+    std::vector<G4Hit> g4hits(config.g4hits);
+    for (auto& g4hit : g4hits)
+    {
+      const int region = region_distribution(rng);
+      const double thickness = (max_radius[region] - min_radius[region]) / layers_per_region;
+      const double radius = min_radius[region] + (layer_distribution(rng) + 0.5) * thickness;
+      const double phi = 2 * M_PI * uniform(rng) - M_PI;
+      const double t = 100 + 12000 * uniform(rng);
+      const unsigned int side = (uniform(rng) < 0.5) ? 0 : 1;
+
+      // transverse diffusion of about 600 microns, longitudinal of about 5 ns
+      g4hit.resize(electron_distribution(rng));
+      for (auto& electron : g4hit)
+      {
+        const double r = radius + thickness * (uniform(rng) - 0.5);
+        const double phi_electron = phi + 0.06 * gauss(rng) / r;
+        electron.x = r * std::cos(phi_electron);
+        electron.y = r * std::sin(phi_electron);
+        electron.t = t + 5 * gauss(rng);
+        electron.side = side;
+      }
+    }
+    return g4hits;
+  }
+
+  class Readout
+  {
+   public:
+    Readout(const std::string& name, PHCompositeNode* topNode, const Configuration& config, bool accumulate, bool tables)
+      : m_readout(name)
+    {
+      m_readout.SetUsePolyaGEMGain(config.polya);
+      m_readout.SetAccumulateHits(accumulate);
+      m_readout.SetUseResponseTables(tables);
+      m_readout.InitRun(topNode);
+    }
+
+    Result process(const std::vector<G4Hit>& g4hits, unsigned int seed, double& time)
+    {
+      m_readout.set_seed(seed);
+      m_hitsetcontainer.Reset();
+      m_single_hitsetcontainer.Reset();
+
+      PHG4HitContainer g4hitcontainer("G4HIT_TPC");
+      for (std::size_t i = 0; i < g4hits.size(); ++i)
+      {
+        g4hitcontainer.AddHit(0, new PHG4Hitv1);
+      }
+
+      const auto start = std::chrono::high_resolution_clock::now();
+      auto hiter = g4hitcontainer.getHits().first;
+      for (const auto& g4hit : g4hits)
+      {
+        for (const auto& electron : g4hit)
+        {
+          m_readout.MapToPadPlane(m_truth_clusterer, &m_single_hitsetcontainer, &m_hitsetcontainer, nullptr,
+                                  electron.x, electron.y, electron.t, electron.side, hiter, nullptr, nullptr);
+        }
+        m_readout.FlushHits(m_truth_clusterer, &m_single_hitsetcontainer, &m_hitsetcontainer);
+        ++hiter;
+      }
+      time += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+      Result result;
+      const auto hitsetrange = m_hitsetcontainer.getHitSets();
+      for (auto hitsetiter = hitsetrange.first; hitsetiter != hitsetrange.second; ++hitsetiter)
+      {
+        const auto hitrange = hitsetiter->second->getHits();
+        for (auto hititer = hitrange.first; hititer != hitrange.second; ++hititer)
+        {
+          result.push_back({hitsetiter->first, hititer->first, hititer->second->getAdc()});
+        }
+      }
+      return result;
+    }
+
+   private:
+    PHG4TpcPadPlaneReadout m_readout;
+    TpcClusterBuilder m_truth_clusterer;
+    TrkrHitSetContainerv1 m_hitsetcontainer;
+    TrkrHitSetContainerv1 m_single_hitsetcontainer;
+  };
+
+  uint64_t total_adc(const Result& result)
+  {
+    uint64_t total = 0;
+    for (const auto& hit : result)
+    {
+      total += hit[2];
+    }
+    return total;
+  }
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  const int nevents = (argc > 1) ? std::stoi(argv[1]) : 5;
+
+  // node tree with the TPC geometry, and the parameter nodes filled by the readout
+  PHCompositeNode topNode("TOP");
+  auto* runNode = new PHCompositeNode("RUN");
+  topNode.addNode(runNode);
+  topNode.addNode(new PHCompositeNode("PAR"));
+  runNode->addNode(new PHIODataNode<PHObject>(make_geometry(), "TPCGEOMCONTAINER", "PHObject"));
+
+  std::cout << "PHG4TpcPadPlaneReadoutBenchmark - " << nevents << " events per configuration, times in ms per event" << std::endl;
+  std::cout << "gain  g4hits  original  accumulate  tables  speedup  hits  adc difference" << std::endl;
+
+  bool identical = true;
+  std::mt19937_64 rng(12345);
+  for (const auto& config : {Configuration{false, 1000}, Configuration{false, 10000}, Configuration{true, 1000}, Configuration{true, 10000}})
+  {
+    Readout original("PHG4TpcPadPlaneReadoutOriginal", &topNode, config, false, false);
+    Readout accumulate("PHG4TpcPadPlaneReadoutAccumulate", &topNode, config, true, false);
+    Readout tables("PHG4TpcPadPlaneReadoutTables", &topNode, config, true, true);
+
+    double original_time = 0;
+    double accumulate_time = 0;
+    double tables_time = 0;
+    double repeat_time = 0;
+    std::size_t nhits = 0;
+    uint64_t original_adc = 0;
+    uint64_t tables_adc = 0;
+    for (int event_i = 0; event_i < nevents; event_i++)
+    {
+      const auto g4hits = generate(rng, config);
+      const unsigned int seed = rng();
+      const auto original_result = original.process(g4hits, seed, original_time);
+      const auto accumulate_result = accumulate.process(g4hits, seed, accumulate_time);
+      const auto tables_result = tables.process(g4hits, seed, tables_time);
+      const auto repeat_result = tables.process(g4hits, seed, repeat_time);
+      nhits += original_result.size();
+      original_adc += total_adc(original_result);
+      tables_adc += total_adc(tables_result);
+
+      if (accumulate_result != original_result)
+      {
+        std::cout << "PHG4TpcPadPlaneReadoutBenchmark - " << (config.polya ? "polya" : "exponential") << " gain, "
+                  << config.g4hits << " g4hits, event " << event_i << ": accumulated hits differ" << std::endl;
+        identical = false;
+      }
+      if (repeat_result != tables_result)
+      {
+        std::cout << "PHG4TpcPadPlaneReadoutBenchmark - " << (config.polya ? "polya" : "exponential") << " gain, "
+                  << config.g4hits << " g4hits, event " << event_i << ": tables are not reproducible" << std::endl;
+        identical = false;
+      }
+    }
+
+    // tabulated gains and responses are not bit identical, but the total charge must agree within statistics
+    const double adc_difference = ((double) tables_adc - (double) original_adc) / original_adc;
+    if (std::abs(adc_difference) > 0.01)
+    {
+      std::cout << "PHG4TpcPadPlaneReadoutBenchmark - " << (config.polya ? "polya" : "exponential") << " gain, "
+                << config.g4hits << " g4hits: total adc differs by " << adc_difference << std::endl;
+      identical = false;
+    }
+
+    std::cout << (config.polya ? "polya" : "exponential") << "  " << config.g4hits
+              << "  " << original_time / nevents << "  " << accumulate_time / nevents << "  " << tables_time / nevents
+              << "  " << original_time / tables_time << "  " << nhits / nevents << "  " << adc_difference << std::endl;
+  }
+
+  if (!identical)
+  {
+    std::cout << "PHG4TpcPadPlaneReadoutBenchmark - results differ" << std::endl;
+    return 1;
+  }
+  return 0;
+}
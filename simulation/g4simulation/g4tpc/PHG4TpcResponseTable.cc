@@ -0,0 +1,86 @@
+#include "PHG4TpcResponseTable.h"
+
+#include <algorithm>
+#include <cmath>
+
+//_____________________________________________________________
+PHG4TpcResponseTable::PHG4TpcResponseTable(double xmin, double xmax, unsigned int npoints, const std::function<double(double)> &function, Outside outside)
+  : m_xmin(xmin)
+  , m_step((xmax - xmin) / (npoints - 1))
+  , m_outside(outside)
+{
+  m_values.reserve(npoints);
+  for (unsigned int i = 0; i < npoints; ++i)
+  {
+    m_values.push_back(function(xmin + i * m_step));
+  }
+}
+
+//_____________________________________________________________
+double PHG4TpcResponseTable::operator()(double x) const
+{
+  double position = (x - m_xmin) / m_step;
+  if (!(position >= 0) || position > m_values.size() - 1)
+  {
+    if (m_outside == Zero || std::isnan(position))
+    {
+      return 0;
+    }
+    position = std::clamp<double>(position, 0, m_values.size() - 1);
+  }
+
+  const auto i = std::min<std::size_t>(position, m_values.size() - 2);
+  const double fraction = position - i;
+  return m_values[i] + fraction * (m_values[i + 1] - m_values[i]);
+}
+
+//_____________________________________________________________
+PHG4TpcInverseCdfSampler::PHG4TpcInverseCdfSampler(double xmin, double xmax, unsigned int nbins, const std::function<double(double)> &pdf)
+  : m_xmin(xmin)
+  , m_step((xmax - xmin) / nbins)
+{
+  m_cdf.reserve(nbins + 1);
+  m_cdf.push_back(0);
+  double previous = std::max(0., pdf(xmin));
+  for (unsigned int i = 1; i <= nbins; ++i)
+  {
+    const double current = std::max(0., pdf(xmin + i * m_step));
+    m_cdf.push_back(m_cdf.back() + (previous + current) / 2);
+    previous = current;
+  }
+
+  const double norm = m_cdf.back();
+  for (auto &value : m_cdf)
+  {
+    value /= norm;
+  }
+}
+
+//_____________________________________________________________
+double PHG4TpcInverseCdfSampler::cdf(double x) const
+{
+  const double position = (x - m_xmin) / m_step;
+  if (position <= 0)
+  {
+    return 0;
+  }
+  if (position >= m_cdf.size() - 1)
+  {
+    return 1;
+  }
+
+  const auto i = static_cast<std::size_t>(position);
+  const double fraction = position - i;
+  return m_cdf[i] + fraction * (m_cdf[i + 1] - m_cdf[i]);
+}
+
+//_____________________________________________________________
+double PHG4TpcInverseCdfSampler::quantile(double u) const
+{
+  // first bin whose upper edge is above u. The pdf is flat within a bin
+  const auto upper = std::upper_bound(m_cdf.begin() + 1, m_cdf.end() - 1, u);
+  const auto i = static_cast<std::size_t>(upper - m_cdf.begin()) - 1;
+  const double width = m_cdf[i + 1] - m_cdf[i];
+  const double fraction = (width > 0) ? std::clamp((u - m_cdf[i]) / width, 0., 1.) : 0.;
+  return m_xmin + (i + fraction) * m_step;
+}
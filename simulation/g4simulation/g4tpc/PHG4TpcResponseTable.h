@@ -0,0 +1,72 @@
+// Tell emacs that this is a C++ source
+// -*- C++ -*-.
+#ifndef G4TPC_PHG4TPCRESPONSETABLE_H
+#define G4TPC_PHG4TPCRESPONSETABLE_H
+
+#include <functional>
+#include <vector>
+
+//! function tabulated on a regular grid and linearly interpolated
+/*!
+ * used by PHG4TpcPadPlaneReadout to replace the pad and SAMPA time responses,
+ * which are evaluated for every electron, by table lookups.
+ * Outside of the grid, the table returns zero, or the value at the closest end
+ * of the grid for functions which are only ever evaluated on the grid range
+ */
+class PHG4TpcResponseTable
+{
+ public:
+  PHG4TpcResponseTable() = default;
+
+  //! behavior outside of the grid
+  enum Outside
+  {
+    //! return zero
+    Zero,
+    //! clamp x to the grid range, e.g. for positions within a time bin, which can be just outside from rounding
+    Clamp
+  };
+
+  //! tabulate function on npoints from xmin to xmax
+  PHG4TpcResponseTable(double xmin, double xmax, unsigned int npoints, const std::function<double(double)> &function, Outside outside = Zero);
+
+  double operator()(double x) const;
+
+  bool empty() const { return m_values.empty(); }
+
+ private:
+  double m_xmin{0};
+  double m_step{1};
+  Outside m_outside{Zero};
+  std::vector<double> m_values;
+};
+
+//! samples a distribution through its tabulated inverse cumulative
+/*!
+ * The cumulative is integrated with the trapezoidal rule on a regular grid and inverted
+ * with a binary search, so that each sample costs a single uniform random number.
+ * Used by PHG4TpcPadPlaneReadout for the GEM gain distributions.
+ */
+class PHG4TpcInverseCdfSampler
+{
+ public:
+  PHG4TpcInverseCdfSampler() = default;
+
+  //! tabulate the cumulative of pdf on nbins from xmin to xmax. The pdf needs not be normalized
+  PHG4TpcInverseCdfSampler(double xmin, double xmax, unsigned int nbins, const std::function<double(double)> &pdf);
+
+  //! normalized cumulative probability at x
+  double cdf(double x) const;
+
+  //! value at which the cumulative probability is u, for u in [0,1]
+  double quantile(double u) const;
+
+  bool empty() const { return m_cdf.empty(); }
+
+ private:
+  double m_xmin{0};
+  double m_step{1};
+  std::vector<double> m_cdf;
+};
+
+#endif  // G4TPC_PHG4TPCRESPONSETABLE_H
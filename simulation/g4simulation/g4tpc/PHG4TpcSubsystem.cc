@@ -10,6 +10,7 @@
 #include <g4main/PHG4DisplayAction.h>  // for PHG4DisplayAction
 #include <g4main/PHG4HitContainer.h>
 #include <g4main/PHG4SteppingAction.h>  // for PHG4SteppingAction
+#include <g4main/PHG4WorkerEventAction.h>
 
 #include <phool/PHCompositeNode.h>
 #include <phool/PHIODataNode.h>    // for PHIODataNode
@@ -86,21 +87,38 @@ int PHG4TpcSubsystem::InitRunSubsystem(PHCompositeNode *topNode)
         DetNode->addNode(new PHIODataNode<PHObject>(g4_hits, nodename, "PHObject"));
       }
     }
+  }
 
-    // create stepping action
-    m_SteppingAction = new PHG4TpcSteppingAction(m_Detector, GetParams());
-    m_SteppingAction->SetHitNodeName("G4HIT", m_HitNodeName);
-    m_SteppingAction->SetHitNodeName("G4HIT_ABSORBER", m_AbsorberNodeName);
+  // create stepping action
+  m_SteppingAction = CreateSteppingAction();
+  return 0;
+}
+
+//_______________________________________________________________________
+PHG4SteppingAction *PHG4TpcSubsystem::CreateSteppingAction()
+{
+  if (GetParams()->get_int_param("active"))
+  {
+    auto *action = new PHG4TpcSteppingAction(m_Detector, GetParams());
+    action->SetHitNodeName("G4HIT", m_HitNodeName);
+    action->SetHitNodeName("G4HIT_ABSORBER", m_AbsorberNodeName);
+    return action;
   }
-  else
+  // if this is a black hole it does not have to be active
+  if (GetParams()->get_int_param("blackhole"))
   {
-    // if this is a black hole it does not have to be active
-    if (GetParams()->get_int_param("blackhole"))
-    {
-      m_SteppingAction = new PHG4TpcSteppingAction(m_Detector, GetParams());
-    }
+    return new PHG4TpcSteppingAction(m_Detector, GetParams());
+  }
+  return nullptr;
+}
+
+//_______________________________________________________________________
+void PHG4TpcSubsystem::CreateWorkerActions(PHG4WorkerEventAction *worker)
+{
+  if (PHG4SteppingAction *action = CreateSteppingAction())
+  {
+    worker->AddSteppingAction(action);
   }
-  return 0;
 }
 
 //_______________________________________________________________________
@@ -11,6 +11,7 @@ class PHCompositeNode;
 class PHG4Detector;
 class PHG4DisplayAction;
 class PHG4SteppingAction;
+class PHG4WorkerEventAction;
 class PHG4TpcDetector;
 
 class PHG4TpcSubsystem : public PHG4DetectorSubsystem
@@ -45,11 +46,18 @@ class PHG4TpcSubsystem : public PHG4DetectorSubsystem
 
   PHG4SteppingAction *GetSteppingAction(void) const override { return m_SteppingAction; }
 
+  //! multithreading support, each worker thread gets its own stepping action
+  bool SupportsMultiThreading() const override { return true; }
+  void CreateWorkerActions(PHG4WorkerEventAction *worker) override;
+
   PHG4DisplayAction *GetDisplayAction() const override { return m_DisplayAction; }
 
  private:
   void SetDefaultParameters() override;
 
+  //! create the stepping action for an active or black hole tpc, nullptr otherwise
+  PHG4SteppingAction *CreateSteppingAction();
+
   //! detector geometry
   /*! derives from PHG4Detector */
   PHG4TpcDetector *m_Detector{nullptr};